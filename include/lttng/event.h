@@ -1640,6 +1640,76 @@ LTTNG_EXPORT extern int lttng_list_events(struct lttng_handle *handle,
 					  const char *channel_name,
 					  struct lttng_event **event_rules);
 
+/*!
+@brief
+    Sets \lt_p{*event_rules} to, at most, \lt_p{max_count} descriptors
+    of the \lt_obj_rers of the \lt_obj_channel named
+    \lt_p{channel_name} within the recording session handle
+    \lt_p{handle}, starting with the descriptor at index \lt_p{offset}.
+
+@ingroup api_channel
+
+Use this function instead of lttng_list_events() to page through the
+recording event rules of a channel without holding all their
+descriptors in memory. Call it with an offset of&nbsp;0, then with an
+offset increased by the number of descriptors you got, until this
+function returns fewer than \lt_p{max_count} descriptors.
+
+The recording event rules which are created or destroyed while you page
+through them may be listed twice or not at all.
+
+If the session daemon doesn't support paginated listings, this function
+sets \lt_p{*event_rules} to all the descriptors, which can be more than
+\lt_p{max_count}, when \lt_p{offset} is&nbsp;0, and returns&nbsp;0
+otherwise.
+
+@param[in] handle
+    Recording session handle which contains the name of the
+    recording session and the summary
+    of the \lt_obj_domain which own the channel (named
+    \lt_p{channel_name}) of which to get the recording event rule
+    descriptors.
+@param[in] channel_name
+    Name of the channel, within \lt_p{handle}, of which to get the
+    recording event rule descriptors.
+@param[in] offset
+    Index of the first recording event rule descriptor to get.
+@param[in] max_count
+    Maximum number of recording event rule descriptors to get.
+@param[out] event_rules
+    @parblock
+    <strong>On success</strong>, this function sets \lt_p{*event_rules}
+    to the recording event rule descriptors.
+
+    Free \lt_p{*event_rules} with <code>free()</code>.
+    @endparblock
+
+@returns
+    The number of items in \lt_p{*event_rules} on success, or a
+    \em negative #lttng_error_code enumerator otherwise.
+
+@pre
+     @lt_pre_conn
+     @lt_pre_not_null{handle}
+     @lt_pre_valid_c_str{handle->session_name}
+     @lt_pre_sess_exists{handle->session_name}
+     - \lt_p{handle->domain} is valid as per the documentation of
+       #lttng_domain.
+     @lt_pre_not_null{channel_name}
+     - \lt_p{channel_name} names an existing channel within the recording
+       session and tracing domain of \lt_p{handle}.
+     - \lt_p{max_count}&nbsp;>&nbsp;0.
+     @lt_pre_not_null{event_rules}
+
+@sa lttng_list_events() --
+    Get all the descriptors of the recording event rules of a channel.
+*/
+LTTNG_EXPORT extern int lttng_list_events_page(struct lttng_handle *handle,
+					       const char *channel_name,
+					       unsigned int offset,
+					       unsigned int max_count,
+					       struct lttng_event **event_rules);
+
 /*!
 @brief
     Creates and returns an empty recording event rule descriptor.
@@ -54,6 +54,8 @@ struct health_state {
 
 enum health_cmd {
 	HEALTH_CMD_CHECK = 0,
+	/* Only handled by the session daemon. */
+	HEALTH_CMD_GET_CLIENT_COMMAND_METRICS = 1,
 };
 
 struct health_comm_msg {
@@ -64,6 +66,23 @@ struct health_comm_reply {
 	uint64_t ret_code; /* bitmask of threads in bad health */
 } LTTNG_PACKED;
 
+/*
+ * Reply to HEALTH_CMD_GET_CLIENT_COMMAND_METRICS. Durations are expressed
+ * in microseconds and accumulated since the launch of the session daemon.
+ */
+struct health_comm_client_command_metrics_reply {
+	uint32_t worker_count;
+	/* Commands received but not yet picked up by a worker. */
+	uint32_t queued_count;
+	/* Commands being processed by a worker. */
+	uint32_t active_count;
+	uint64_t completed_count;
+	uint64_t total_queue_wait_us;
+	uint64_t max_queue_wait_us;
+	uint64_t total_processing_us;
+	uint64_t max_processing_us;
+} LTTNG_PACKED;
+
 /* Declare TLS health state. */
 extern thread_local struct health_state health_state;
 
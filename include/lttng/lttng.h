@@ -160,6 +160,92 @@ the current Unix tracing group (initially \c tracing) of the library.
 */
 LTTNG_EXPORT extern int lttng_set_tracing_group(const char *group);
 
+/*!
+@struct lttng_session_daemon_connection
+
+@brief
+    Persistent session daemon connection (opaque type).
+
+@ingroup api_gen
+*/
+struct lttng_session_daemon_connection;
+
+/*!
+@brief
+    Creates a persistent
+    \ref api-gen-sessiond-conn "session daemon connection".
+
+@ingroup api_gen
+
+By default, each liblttng-ctl function which needs a session daemon
+connects to it and disconnects once its command completes. Once a
+thread sets a persistent session daemon connection with
+lttng_set_session_daemon_connection(), the functions it calls keep
+reusing a single connection to the session daemon instead.
+
+Multiple threads may set the same persistent session daemon connection:
+their commands are then sent on the same connection without waiting for
+the replies to the commands of the other threads.
+
+This function doesn't connect to the session daemon: liblttng-ctl
+connects when a thread sends its first command, and connects again
+after the connection fails.
+
+@returns
+    Persistent session daemon connection on success, or \c NULL on
+    error.
+
+@sa lttng_session_daemon_connection_destroy() --
+    Destroys a persistent session daemon connection.
+*/
+LTTNG_EXPORT extern struct lttng_session_daemon_connection *
+lttng_session_daemon_connection_create(void);
+
+/*!
+@brief
+    Destroys the persistent session daemon connection
+    \lt_p{connection}, closing its connection to the session daemon.
+
+@ingroup api_gen
+
+@param[in] connection
+    @parblock
+    Persistent session daemon connection to destroy.
+
+    May be \c NULL.
+    @endparblock
+
+@pre
+    - No thread uses \lt_p{connection}.
+*/
+LTTNG_EXPORT extern void
+lttng_session_daemon_connection_destroy(struct lttng_session_daemon_connection *connection);
+
+/*!
+@brief
+    Sets the persistent session daemon connection which the liblttng-ctl
+    functions use, for the calling thread, to \lt_p{connection}.
+
+@ingroup api_gen
+
+The lttng_destroy_session_ext() and lttng_clear_session() functions
+always use their own connection.
+
+@param[in] connection
+    @parblock
+    Persistent session daemon connection to use, or \c NULL to make
+    each liblttng-ctl function which needs a session daemon use its own
+    connection (default).
+
+    The calling thread doesn't own \lt_p{connection}.
+    @endparblock
+
+@sa lttng_session_daemon_connection_create() --
+    Creates a persistent session daemon connection.
+*/
+LTTNG_EXPORT extern void
+lttng_set_session_daemon_connection(struct lttng_session_daemon_connection *connection);
+
 /*
  * This call registers an "outside consumer" for a session and an lttng domain.
  * No consumer will be spawned and all fds/commands will go through the socket
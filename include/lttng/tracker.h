@@ -83,6 +83,7 @@ enum lttng_process_attr_tracker_handle_status {
 };
 
 enum lttng_process_attr_values_status {
+	LTTNG_PROCESS_ATTR_VALUES_STATUS_ERROR = -3,
 	LTTNG_PROCESS_ATTR_VALUES_STATUS_INVALID_TYPE = -2,
 	LTTNG_PROCESS_ATTR_VALUES_STATUS_INVALID = -1,
 	LTTNG_PROCESS_ATTR_VALUES_STATUS_OK = 0,
@@ -465,6 +466,136 @@ lttng_process_attr_tracker_handle_get_inclusion_set(
 	struct lttng_process_attr_tracker_handle *tracker_handle,
 	const struct lttng_process_attr_values **values);
 
+/*
+ * Add a set of values to a process attribute tracker's inclusion set.
+ *
+ * The update is atomic: either all the values are added, or the inclusion set
+ * is left unchanged. Values that are already part of the inclusion set are
+ * ignored.
+ *
+ * If `added_values` is not NULL, it is set to the values that were not
+ * already part of the inclusion set on success. The caller owns the returned
+ * values and must destroy them using `lttng_process_attr_values_destroy`.
+ *
+ * Returns LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK on success,
+ * LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_INVALID_TRACKING_POLICY if the
+ * tracker's policy is not LTTNG_POLICY_INCLUDE_SET,
+ * LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_USER_NOT_FOUND or
+ * LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_GROUP_NOT_FOUND if a user or group
+ * name can't be resolved, and LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_INVALID
+ * if an invalid argument was provided.
+ */
+LTTNG_EXPORT extern enum lttng_process_attr_tracker_handle_status
+lttng_process_attr_tracker_handle_add_values(
+	const struct lttng_process_attr_tracker_handle *tracker_handle,
+	const struct lttng_process_attr_values *values,
+	struct lttng_process_attr_values **added_values);
+
+/*
+ * Remove a set of values from a process attribute tracker's inclusion set.
+ *
+ * The update is atomic: either all the values are removed, or the inclusion
+ * set is left unchanged. Values that are not part of the inclusion set are
+ * ignored.
+ *
+ * If `removed_values` is not NULL, it is set to the values that were part of
+ * the inclusion set on success. The caller owns the returned values and must
+ * destroy them using `lttng_process_attr_values_destroy`.
+ *
+ * Returns LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK on success,
+ * LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_INVALID_TRACKING_POLICY if the
+ * tracker's policy is not LTTNG_POLICY_INCLUDE_SET, and
+ * LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_INVALID if an invalid argument was
+ * provided.
+ */
+LTTNG_EXPORT extern enum lttng_process_attr_tracker_handle_status
+lttng_process_attr_tracker_handle_remove_values(
+	const struct lttng_process_attr_tracker_handle *tracker_handle,
+	const struct lttng_process_attr_values *values,
+	struct lttng_process_attr_values **removed_values);
+
+/*
+ * Replace the inclusion set of a process attribute tracker.
+ *
+ * The update is atomic and only the difference between the current and the
+ * new inclusion sets is applied to the tracers.
+ *
+ * Returns LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK on success,
+ * LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_INVALID_TRACKING_POLICY if the
+ * tracker's policy is not LTTNG_POLICY_INCLUDE_SET,
+ * LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_USER_NOT_FOUND or
+ * LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_GROUP_NOT_FOUND if a user or group
+ * name can't be resolved, and LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_INVALID
+ * if an invalid argument was provided.
+ */
+LTTNG_EXPORT extern enum lttng_process_attr_tracker_handle_status
+lttng_process_attr_tracker_handle_set_inclusion_set(
+	const struct lttng_process_attr_tracker_handle *tracker_handle,
+	const struct lttng_process_attr_values *values);
+
+/*
+ * Create an empty set of process attribute values.
+ *
+ * Returns a new set of values on success, NULL on error.
+ */
+LTTNG_EXPORT extern struct lttng_process_attr_values *lttng_process_attr_values_create(void);
+
+/* Destroy a set of process attribute values. */
+LTTNG_EXPORT extern void
+lttng_process_attr_values_destroy(struct lttng_process_attr_values *values);
+
+/*
+ * Add a process ID to a set of process attribute values.
+ *
+ * Returns LTTNG_PROCESS_ATTR_VALUES_STATUS_OK on success,
+ * LTTNG_PROCESS_ATTR_VALUES_STATUS_INVALID if an invalid argument is provided,
+ * and LTTNG_PROCESS_ATTR_VALUES_STATUS_ERROR on allocation failure.
+ */
+LTTNG_EXPORT extern enum lttng_process_attr_values_status
+lttng_process_attr_values_add_pid(struct lttng_process_attr_values *values, pid_t pid);
+
+/*
+ * Add a user ID to a set of process attribute values.
+ *
+ * Returns LTTNG_PROCESS_ATTR_VALUES_STATUS_OK on success,
+ * LTTNG_PROCESS_ATTR_VALUES_STATUS_INVALID if an invalid argument is provided,
+ * and LTTNG_PROCESS_ATTR_VALUES_STATUS_ERROR on allocation failure.
+ */
+LTTNG_EXPORT extern enum lttng_process_attr_values_status
+lttng_process_attr_values_add_uid(struct lttng_process_attr_values *values, uid_t uid);
+
+/*
+ * Add a user name to a set of process attribute values.
+ *
+ * Returns LTTNG_PROCESS_ATTR_VALUES_STATUS_OK on success,
+ * LTTNG_PROCESS_ATTR_VALUES_STATUS_INVALID if an invalid argument is provided,
+ * and LTTNG_PROCESS_ATTR_VALUES_STATUS_ERROR on allocation failure.
+ */
+LTTNG_EXPORT extern enum lttng_process_attr_values_status
+lttng_process_attr_values_add_user_name(struct lttng_process_attr_values *values,
+					const char *user_name);
+
+/*
+ * Add a group ID to a set of process attribute values.
+ *
+ * Returns LTTNG_PROCESS_ATTR_VALUES_STATUS_OK on success,
+ * LTTNG_PROCESS_ATTR_VALUES_STATUS_INVALID if an invalid argument is provided,
+ * and LTTNG_PROCESS_ATTR_VALUES_STATUS_ERROR on allocation failure.
+ */
+LTTNG_EXPORT extern enum lttng_process_attr_values_status
+lttng_process_attr_values_add_gid(struct lttng_process_attr_values *values, gid_t gid);
+
+/*
+ * Add a group name to a set of process attribute values.
+ *
+ * Returns LTTNG_PROCESS_ATTR_VALUES_STATUS_OK on success,
+ * LTTNG_PROCESS_ATTR_VALUES_STATUS_INVALID if an invalid argument is provided,
+ * and LTTNG_PROCESS_ATTR_VALUES_STATUS_ERROR on allocation failure.
+ */
+LTTNG_EXPORT extern enum lttng_process_attr_values_status
+lttng_process_attr_values_add_group_name(struct lttng_process_attr_values *values,
+					 const char *group_name);
+
 /*
  * Get the count of values within a set of process attribute values.
  *
@@ -13,6 +13,8 @@
 
 #include <lttng/lttng.h>
 
+#include <algorithm>
+#include <atomic>
 #include <ctype.h>
 #include <dirent.h>
 #include <fcntl.h>
@@ -23,16 +25,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <string>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <sys/wait.h>
+#include <system_error>
+#include <thread>
 #include <unistd.h>
+#include <vector>
 #include <version.hpp>
 
 #define COPY_BUFLEN	      4096
 #define RB_CRASH_DUMP_ABI_LEN 32
 
+/* Number of segments written to an output file by a single writev() call. */
+#define CRASH_WRITE_IOV_COUNT 64
+/* Maximal number of files extracted concurrently. */
+#define MAX_EXTRACT_WORKERS 16
+
 #define RB_CRASH_DUMP_ABI_MAGIC_LEN 16
 
 /*
@@ -172,6 +184,27 @@ struct lttng_crash_layout {
 	uint64_t num_subbuf; /* Number of sub-buffers for writer */
 	uint32_t mode; /* Buffer mode: 0: overwrite, 1: discard */
 };
+
+/*
+ * Writes the packets of a crash buffer file, mapped read-only, to its output
+ * file.
+ *
+ * Packets are written in place from the mapping of the source file, in
+ * batches of vectored writes, or copied in-kernel when the file systems
+ * allow it. Only the headers of partially committed packets, which must be
+ * patched, are copied in memory.
+ */
+struct crash_data_writer {
+	int fd_src;
+	int fd_dest;
+	const char *map;
+	struct iovec iov[CRASH_WRITE_IOV_COUNT];
+	int iov_count;
+	/* Patched packet headers referred to by `iov`, freed once written. */
+	char *patched_headers[CRASH_WRITE_IOV_COUNT];
+	int patched_header_count;
+	bool copy_file_range_unsupported;
+};
 } /* namespace */
 
 /* Variables */
@@ -617,13 +650,154 @@ static inline uint64_t subbuffer_id_get_index(uint32_t mode, uint64_t id, unsign
 		return id;
 }
 
-static int
-copy_crash_subbuf(const struct lttng_crash_layout *layout, int fd_dest, char *buf, uint64_t offset)
+static int crash_writer_flush(struct crash_data_writer *writer)
+{
+	int ret = 0, i;
+	struct iovec *iov = writer->iov;
+	int iov_count = writer->iov_count;
+
+	while (iov_count > 0) {
+		ssize_t writelen;
+
+		writelen = writev(writer->fd_dest, iov, iov_count);
+		if (writelen < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			PERROR("Error writing to output file");
+			ret = -1;
+			goto end;
+		}
+
+		/* Skip the segments which were completely written. */
+		while (iov_count > 0 && (size_t) writelen >= iov->iov_len) {
+			writelen -= iov->iov_len;
+			iov++;
+			iov_count--;
+		}
+
+		if (iov_count > 0) {
+			iov->iov_base = (char *) iov->iov_base + writelen;
+			iov->iov_len -= writelen;
+		}
+	}
+
+end:
+	for (i = 0; i < writer->patched_header_count; i++) {
+		free(writer->patched_headers[i]);
+	}
+
+	writer->iov_count = 0;
+	writer->patched_header_count = 0;
+	return ret;
+}
+
+/*
+ * Queue `len` bytes at `ptr` to be written to the output file. `ptr` must
+ * remain valid until the writer is flushed.
+ */
+static int crash_writer_append(struct crash_data_writer *writer, const char *ptr, size_t len)
+{
+	if (!len) {
+		return 0;
+	}
+
+	if (writer->iov_count == CRASH_WRITE_IOV_COUNT) {
+		const int ret = crash_writer_flush(writer);
+
+		if (ret) {
+			return ret;
+		}
+	}
+
+	writer->iov[writer->iov_count].iov_base = (void *) ptr;
+	writer->iov[writer->iov_count].iov_len = len;
+	writer->iov_count++;
+	return 0;
+}
+
+/*
+ * Queue a patched packet header to be written to the output file. The writer
+ * takes ownership of `header` in all cases.
+ */
+static int crash_writer_append_patched(struct crash_data_writer *writer, char *header, size_t len)
+{
+	int ret;
+
+	if (writer->iov_count == CRASH_WRITE_IOV_COUNT) {
+		ret = crash_writer_flush(writer);
+		if (ret) {
+			free(header);
+			return ret;
+		}
+	}
+
+	writer->patched_headers[writer->patched_header_count++] = header;
+	return crash_writer_append(writer, header, len);
+}
+
+/*
+ * Copy `len` bytes of the source file, starting at `src_offset`, to the
+ * output file.
+ */
+static int crash_writer_copy(struct crash_data_writer *writer, uint64_t src_offset, size_t len)
+{
+#ifdef HAVE_COPY_FILE_RANGE
+	if (!writer->copy_file_range_unsupported && len) {
+		loff_t copy_offset = src_offset;
+		int ret;
+
+		/* Preserve the order of the packets in the output file. */
+		ret = crash_writer_flush(writer);
+		if (ret) {
+			return ret;
+		}
+
+		while (len) {
+			const ssize_t copied = copy_file_range(
+				writer->fd_src, &copy_offset, writer->fd_dest, nullptr, len, 0);
+
+			if (copied > 0) {
+				len -= copied;
+				continue;
+			}
+
+			if (copied < 0 && errno == EINTR) {
+				continue;
+			}
+
+			if (copied < 0 && errno != ENOSYS && errno != EXDEV && errno != EINVAL &&
+			    errno != EOPNOTSUPP) {
+				PERROR("Error copying to output file");
+				return -1;
+			}
+
+			/*
+			 * The file systems do not support in-kernel copies; write the
+			 * rest of this file's packets from the mapping.
+			 */
+			DBG("copy_file_range() unsupported, falling back to writes");
+			writer->copy_file_range_unsupported = true;
+			break;
+		}
+
+		src_offset = copy_offset;
+	}
+#endif /* HAVE_COPY_FILE_RANGE */
+
+	return crash_writer_append(writer, writer->map + src_offset, len);
+}
+
+static int copy_crash_subbuf(const struct lttng_crash_layout *layout,
+			     struct crash_data_writer *writer,
+			     const char *buf,
+			     uint64_t offset)
 {
 	uint64_t buf_size, subbuf_size, num_subbuf, sbidx, id, sb_bindex, rpages_offset, p_offset,
 		seq_cc, committed, commit_count_mask, consumed_cur, packet_size;
-	char *subbuf_ptr;
-	ssize_t writelen;
+	const char *subbuf_ptr;
+	int ret;
 
 	/*
 	 * Get the current subbuffer by applying the proper mask to
@@ -691,6 +865,12 @@ copy_crash_subbuf(const struct lttng_crash_layout *layout, int fd_dest, char *bu
 	p_offset = crash_get_field(layout, buf + rpages_offset, sb_backend_p_offset);
 	subbuf_ptr = buf + p_offset;
 
+	if (p_offset > layout->mmap_length || subbuf_size > layout->mmap_length - p_offset) {
+		ERR("Sub-buffer at offset %" PRIu64 " is out of the bounds of the crash record",
+		    p_offset);
+		return -1;
+	}
+
 	if (committed == subbuf_size) {
 		/*
 		 * Packet header can be used.
@@ -706,39 +886,71 @@ copy_crash_subbuf(const struct lttng_crash_layout *layout, int fd_dest, char *bu
 		} else {
 			packet_size = subbuf_size;
 		}
+
+		if (packet_size > subbuf_size) {
+			ERR("Invalid packet size: packet_size=%" PRIu64 ", subbuf_size=%" PRIu64,
+			    packet_size,
+			    subbuf_size);
+			return -1;
+		}
+
+		/*
+		 * Copy packet into fd_dest.
+		 */
+		ret = crash_writer_copy(writer, p_offset, packet_size);
 	} else {
 		uint64_t patch_size;
+		size_t header_size, patched_size;
+		char *header;
 
 		/*
 		 * Find where to patch the sub-buffer header with actual
 		 * readable data len and packet len, derived from seq
-		 * cc. Patch it in our in-memory copy.
+		 * cc. Patch it in a copy of the header since the source
+		 * file is mapped read-only.
 		 */
+		header_size = std::max(layout->offset.content_size + layout->length.content_size,
+				       layout->offset.packet_size + layout->length.packet_size);
+		header_size = std::min<uint64_t>(header_size, subbuf_size);
+		header = calloc<char>(header_size);
+		if (!header) {
+			PERROR("Error allocating packet header");
+			return -1;
+		}
+		memcpy(header, subbuf_ptr, header_size);
+
 		patch_size = committed * CHAR_BIT;
 		if (layout->reverse_byte_order) {
 			patch_size = bswap_64(patch_size);
 		}
 		if (layout->length.content_size) {
-			memcpy(subbuf_ptr + layout->offset.content_size,
+			memcpy(header + layout->offset.content_size,
 			       &patch_size,
 			       layout->length.content_size);
 		}
 		if (layout->length.packet_size) {
-			memcpy(subbuf_ptr + layout->offset.packet_size,
+			memcpy(header + layout->offset.packet_size,
 			       &patch_size,
 			       layout->length.packet_size);
 		}
 		packet_size = committed;
+
+		/*
+		 * Copy packet into fd_dest: the patched header, then the rest
+		 * of the committed data.
+		 */
+		patched_size = std::min<uint64_t>(header_size, packet_size);
+		ret = crash_writer_append_patched(writer, header, patched_size);
+		if (!ret) {
+			ret = crash_writer_copy(
+				writer, p_offset + patched_size, packet_size - patched_size);
+		}
 	}
 
-	/*
-	 * Copy packet into fd_dest.
-	 */
-	writelen = lttng_write(fd_dest, subbuf_ptr, packet_size);
-	if (writelen < packet_size) {
-		PERROR("Error writing to output file");
-		return -1;
+	if (ret) {
+		return ret;
 	}
+
 	DBG("Copied %" PRIu64 " bytes of data", packet_size);
 	return 0;
 
@@ -749,29 +961,40 @@ nodata:
 static int copy_crash_data(const struct lttng_crash_layout *layout, int fd_dest, int fd_src)
 {
 	char *buf;
-	int ret = 0, has_data = 0;
+	int ret = 0, has_data = 0, flushret;
 	struct stat statbuf;
 	size_t src_file_len;
 	uint64_t prod_offset, consumed_offset;
 	uint64_t offset, subbuf_size;
-	ssize_t readlen;
+	struct crash_data_writer writer = {};
 
 	ret = fstat(fd_src, &statbuf);
 	if (ret) {
 		return ret;
 	}
 	src_file_len = layout->mmap_length;
-	buf = calloc<char>(src_file_len);
-	if (!buf) {
+	if (statbuf.st_size < 0 || (uint64_t) statbuf.st_size < src_file_len) {
+		ERR("Crash record truncated: file length of %" PRIi64
+		    " bytes is shorter than the record length of %" PRIu64 " bytes",
+		    (int64_t) statbuf.st_size,
+		    layout->mmap_length);
 		return -1;
 	}
-	readlen = lttng_read(fd_src, buf, src_file_len);
-	if (readlen < 0) {
-		PERROR("Error reading input file");
-		ret = -1;
-		goto end;
+
+	/*
+	 * Map the file read-only rather than reading it in memory: only the
+	 * pages of the packets which are written are accessed.
+	 */
+	buf = (char *) mmap(nullptr, src_file_len, PROT_READ, MAP_PRIVATE, fd_src, 0);
+	if (buf == MAP_FAILED) {
+		PERROR("Error mapping input file");
+		return -1;
 	}
 
+	writer.fd_src = fd_src;
+	writer.fd_dest = fd_dest;
+	writer.map = buf;
+
 	prod_offset = crash_get_field(layout, buf, prod_offset);
 	DBG("prod_offset: 0x%" PRIx64, prod_offset);
 	consumed_offset = crash_get_field(layout, buf, consumed_offset);
@@ -779,7 +1002,7 @@ static int copy_crash_data(const struct lttng_crash_layout *layout, int fd_dest,
 	subbuf_size = layout->subbuf_size;
 
 	for (offset = consumed_offset; offset < prod_offset; offset += subbuf_size) {
-		ret = copy_crash_subbuf(layout, fd_dest, buf, offset);
+		ret = copy_crash_subbuf(layout, &writer, buf, offset);
 		if (!ret) {
 			has_data = 1;
 		}
@@ -788,7 +1011,13 @@ static int copy_crash_data(const struct lttng_crash_layout *layout, int fd_dest,
 		}
 	}
 end:
-	free(buf);
+	flushret = crash_writer_flush(&writer);
+	if (flushret && (!ret || ret == -ENODATA)) {
+		ret = flushret;
+	}
+	if (munmap(buf, src_file_len)) {
+		PERROR("munmap");
+	}
 	if (ret && ret != -ENODATA) {
 		return ret;
 	}
@@ -856,11 +1085,59 @@ end:
 	return ret;
 }
 
+/*
+ * Extract files of `input_files`, taking the next one to extract from
+ * `next_file`, until all files are extracted or an error is reported through
+ * `error`.
+ */
+static void extract_files_worker(int output_dir_fd,
+				 int input_dir_fd,
+				 const std::vector<std::string>& input_files,
+				 std::atomic<size_t>& next_file,
+				 std::atomic<int>& error)
+{
+	while (!error.load()) {
+		const size_t file_index = next_file.fetch_add(1);
+		const char *file_name;
+		int ret;
+
+		if (file_index >= input_files.size()) {
+			break;
+		}
+
+		file_name = input_files[file_index].c_str();
+		ret = extract_file(output_dir_fd, file_name, input_dir_fd, file_name);
+		if (ret == -ENODATA) {
+			DBG("No data in file '%s', skipping", file_name);
+		} else if (ret < 0) {
+			int no_error = 0;
+
+			error.compare_exchange_strong(no_error, ret);
+		} else if (ret > 0) {
+			DBG("Skipping file '%s'", file_name);
+		}
+	}
+}
+
+static unsigned int get_extract_worker_count(size_t file_count)
+{
+	const long online_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int worker_count = online_cpus > 0 ? (unsigned int) online_cpus : 1;
+
+	worker_count = std::min(worker_count, (unsigned int) MAX_EXTRACT_WORKERS);
+	return (unsigned int) std::max<size_t>(std::min<size_t>(worker_count, file_count), 1);
+}
+
 static int extract_all_files(const char *output_path, const char *input_path)
 {
 	DIR *input_dir, *output_dir;
 	int input_dir_fd, output_dir_fd, ret = 0, closeret;
 	struct dirent *entry; /* input */
+	std::vector<std::string> input_files;
+	std::vector<std::thread> workers;
+	std::atomic<size_t> next_file{ 0 };
+	std::atomic<int> error{ 0 };
+	unsigned int worker_count, i;
 
 	/* Open input directory */
 	input_dir = opendir(input_path);
@@ -886,22 +1163,49 @@ static int extract_all_files(const char *output_path, const char *input_path)
 		return -1;
 	}
 
-	while ((entry = readdir(input_dir))) {
-		if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
-			continue;
-		ret = extract_file(output_dir_fd, entry->d_name, input_dir_fd, entry->d_name);
-		if (ret == -ENODATA) {
-			DBG("No data in file '%s', skipping", entry->d_name);
-			ret = 0;
-			continue;
-		} else if (ret < 0) {
+	try {
+		while ((entry = readdir(input_dir))) {
+			if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+				continue;
+			input_files.emplace_back(entry->d_name);
+		}
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to allocate the list of files of '%s'", input_path);
+		ret = -1;
+		goto end;
+	}
+
+	/*
+	 * The per-CPU buffer files are independent: extract them concurrently.
+	 * The calling thread takes part in the extraction. Failing to launch a
+	 * worker only reduces the concurrency.
+	 */
+	worker_count = get_extract_worker_count(input_files.size());
+	DBG("Extracting %zu files of '%s' with %u workers",
+	    input_files.size(),
+	    input_path,
+	    worker_count);
+	for (i = 1; i < worker_count; i++) {
+		try {
+			workers.emplace_back(extract_files_worker,
+					     output_dir_fd,
+					     input_dir_fd,
+					     std::cref(input_files),
+					     std::ref(next_file),
+					     std::ref(error));
+		} catch (const std::exception& ex) {
+			WARN("Failed to launch extraction worker: %s", ex.what());
 			break;
-		} else if (ret > 0) {
-			DBG("Skipping file '%s'", entry->d_name);
-			ret = 0;
-			continue;
 		}
 	}
+
+	extract_files_worker(output_dir_fd, input_dir_fd, input_files, next_file, error);
+	for (auto& worker : workers) {
+		worker.join();
+	}
+
+	ret = error.load();
+end:
 	closeret = closedir(output_dir);
 	if (closeret) {
 		PERROR("closedir");
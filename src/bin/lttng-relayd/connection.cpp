@@ -114,6 +114,7 @@ static void rcu_free_connection(struct rcu_head *head)
 	}
 	if (conn->type == RELAY_CONTROL) {
 		lttng_dynamic_buffer_reset(&conn->protocol.ctrl.reception_buffer);
+		delete conn->protocol.ctrl.metadata_fragment_store;
 	}
 	free(conn);
 }
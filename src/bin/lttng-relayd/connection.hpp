@@ -14,6 +14,7 @@
 
 #include <common/dynamic-buffer.hpp>
 #include <common/hashtable/hashtable.hpp>
+#include <common/sessiond-comm/relayd-metadata-fragments.hpp>
 #include <common/sessiond-comm/relayd.hpp>
 #include <common/sessiond-comm/sessiond-comm.hpp>
 
@@ -125,6 +126,11 @@ struct relay_connection {
 				struct ctrl_connection_state_receive_payload receive_payload;
 			} state;
 			struct lttng_dynamic_buffer reception_buffer;
+			/*
+			 * Allocated on reception of the first metadata packet
+			 * sent as fragments.
+			 */
+			lttng::relayd::metadata_fragment_store *metadata_fragment_store;
 		} ctrl;
 	} protocol;
 };
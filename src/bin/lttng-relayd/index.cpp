@@ -10,6 +10,7 @@
 #define _LGPL_SOURCE
 
 #include "connection.hpp"
+#include "ctf-trace.hpp"
 #include "index.hpp"
 #include "lttng-relayd.hpp"
 #include "stream.hpp"
@@ -19,88 +20,263 @@
 #include <common/urcu.hpp>
 #include <common/utils.hpp>
 
+#include <memory>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+/* Number of index objects allocated at once by the pool of a stream. */
+constexpr size_t index_slab_size = 64;
+/* Number of slots of the ring of a stream; powers of two. */
+constexpr size_t index_ring_initial_size = 64;
+constexpr size_t index_ring_max_size = 4096;
+} /* namespace */
+
+struct relay_index_table {
+	/* Indexes in flight, at the slot of their sequence number modulo the ring size. */
+	std::vector<struct relay_index *> ring;
+	/* Indexes in flight colliding with another index of the ring at its maximal size. */
+	std::unordered_map<uint64_t, struct relay_index *> overflow;
+	/* Storage of all the index objects of the stream. */
+	std::vector<std::unique_ptr<struct relay_index[]>> slabs;
+	struct relay_index *free_list = nullptr;
+};
+
+struct relay_index_table *relay_index_table_create()
+{
+	struct relay_index_table *table = nullptr;
+
+	try {
+		table = new relay_index_table;
+		table->ring.resize(index_ring_initial_size, nullptr);
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to allocate relay index table");
+		delete table;
+		table = nullptr;
+	}
+
+	return table;
+}
+
+void relay_index_table_destroy(struct relay_index_table *table)
+{
+	if (!table) {
+		return;
+	}
+
+	for (const auto& slab : table->slabs) {
+		for (size_t i = 0; i < index_slab_size; i++) {
+			pthread_mutex_destroy(&slab[i].lock);
+		}
+	}
+
+	delete table;
+}
+
+namespace {
 /*
- * Allocate a new relay index object. Pass the stream in which it is
- * contained as parameter. The sequence number will be used as the hash
- * table key.
+ * Take an index object from the pool of the stream, allocating a new slab
+ * when the pool is empty.
  *
  * Called with stream mutex held.
- * Return allocated object or else NULL on error.
  */
-static struct relay_index *relay_index_create(struct relay_stream *stream, uint64_t net_seq_num)
+struct relay_index *index_pool_take(struct relay_index_table *table)
 {
 	struct relay_index *index;
 
-	DBG2("Creating relay index for stream id %" PRIu64 " and seqnum %" PRIu64,
-	     stream->stream_handle,
-	     net_seq_num);
+	if (!table->free_list) {
+		try {
+			std::unique_ptr<struct relay_index[]> slab(
+				new struct relay_index[index_slab_size]());
 
-	index = zmalloc<relay_index>();
-	if (!index) {
-		PERROR("Relay index zmalloc");
-		goto end;
+			table->slabs.push_back(std::move(slab));
+		} catch (const std::bad_alloc&) {
+			return nullptr;
+		}
+
+		for (size_t i = 0; i < index_slab_size; i++) {
+			struct relay_index *slab_index = &table->slabs.back()[i];
+
+			pthread_mutex_init(&slab_index->lock, nullptr);
+			slab_index->next_free = table->free_list;
+			table->free_list = slab_index;
+		}
 	}
-	if (!stream_get(stream)) {
-		ERR("Cannot get stream");
-		free(index);
-		index = nullptr;
-		goto end;
+
+	index = table->free_list;
+	table->free_list = index->next_free;
+	index->next_free = nullptr;
+	return index;
+}
+
+/* Called with stream mutex held. */
+void index_pool_put(struct relay_index_table *table, struct relay_index *index)
+{
+	index->next_free = table->free_list;
+	table->free_list = index;
+}
+
+struct relay_index **index_table_slot(struct relay_index_table *table, uint64_t net_seq_num)
+{
+	return &table->ring[net_seq_num & (table->ring.size() - 1)];
+}
+
+struct relay_index *index_table_find(struct relay_index_table *table, uint64_t net_seq_num)
+{
+	struct relay_index *index = *index_table_slot(table, net_seq_num);
+
+	if (index && index->net_seq_num == net_seq_num) {
+		return index;
 	}
-	index->stream = stream;
 
-	lttng_ht_node_init_u64(&index->index_n, net_seq_num);
-	pthread_mutex_init(&index->lock, nullptr);
-	urcu_ref_init(&index->ref);
+	if (table->overflow.empty()) {
+		return nullptr;
+	}
 
-end:
-	return index;
+	const auto it = table->overflow.find(net_seq_num);
+	return it == table->overflow.end() ? nullptr : it->second;
+}
+
+/*
+ * Double the size of the ring. The indexes of the ring don't collide in the
+ * new ring since their slots were distinct modulo the previous size.
+ */
+void index_table_grow_ring(struct relay_index_table *table)
+{
+	std::vector<struct relay_index *> ring(table->ring.size() * 2, nullptr);
+
+	for (auto *index : table->ring) {
+		if (index) {
+			ring[index->net_seq_num & (ring.size() - 1)] = index;
+		}
+	}
+
+	table->ring = std::move(ring);
 }
 
 /*
- * Add unique relay index to the given hash table. In case of a collision, the
- * already existing object is put in the given _index variable.
+ * Add an index which isn't in the table yet.
  *
- * RCU read side lock MUST be acquired.
+ * Called with stream mutex held.
+ * Return 0 on success, -1 on allocation failure.
  */
-static struct relay_index *relay_index_add_unique(struct relay_stream *stream,
-						  struct relay_index *index)
+int index_table_add(struct relay_index_table *table, struct relay_index *index)
 {
-	struct cds_lfht_node *node_ptr;
-	struct relay_index *_index;
+	try {
+		while (*index_table_slot(table, index->net_seq_num)) {
+			if (table->ring.size() >= index_ring_max_size) {
+				table->overflow.emplace(index->net_seq_num, index);
+				return 0;
+			}
 
-	ASSERT_RCU_READ_LOCKED();
+			index_table_grow_ring(table);
+		}
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to add relay index to the index table");
+		return -1;
+	}
 
-	DBG2("Adding relay index with stream id %" PRIu64 " and seqnum %" PRIu64,
-	     stream->stream_handle,
-	     index->index_n.key);
-
-	node_ptr = cds_lfht_add_unique(stream->indexes_ht->ht,
-				       stream->indexes_ht->hash_fct(&index->index_n.key,
-								    lttng_ht_seed),
-				       stream->indexes_ht->match_fct,
-				       &index->index_n.key,
-				       &index->index_n.node);
-	if (node_ptr != &index->index_n.node) {
-		_index = lttng_ht_node_container_of(node_ptr, &relay_index::index_n);
-	} else {
-		_index = nullptr;
+	*index_table_slot(table, index->net_seq_num) = index;
+	return 0;
+}
+
+/* Called with stream mutex held. */
+void index_table_remove(struct relay_index_table *table, struct relay_index *index)
+{
+	struct relay_index **slot = index_table_slot(table, index->net_seq_num);
+
+	if (*slot == index) {
+		*slot = nullptr;
+		return;
 	}
-	return _index;
+
+	const auto removed_count = table->overflow.erase(index->net_seq_num);
+	LTTNG_ASSERT(removed_count == 1);
 }
 
 /*
- * Should be called with RCU read-side lock held.
+ * Call `visitor` on every index of the table until it returns a non-zero
+ * value, which is then returned. The visitor may release the index it is
+ * passed, but no other index.
+ *
+ * Called with stream mutex held.
  */
-static bool relay_index_get(struct relay_index *index)
+template <typename VisitorType>
+int index_table_for_each(struct relay_index_table *table, VisitorType visitor)
 {
-	ASSERT_RCU_READ_LOCKED();
+	/*
+	 * Releasing the last index may put the last reference to the stream:
+	 * the table is only destroyed after a grace period.
+	 */
+	const lttng::urcu::read_lock_guard read_lock;
 
-	DBG2("index get for stream id %" PRIu64 " and seqnum %" PRIu64 " refcount %d",
-	     index->stream->stream_handle,
-	     index->index_n.key,
-	     (int) index->ref.refcount);
+	for (size_t i = 0; i < table->ring.size(); i++) {
+		if (!table->ring[i]) {
+			continue;
+		}
+
+		const auto ret = visitor(table->ring[i]);
+		if (ret) {
+			return ret;
+		}
+	}
+
+	for (auto it = table->overflow.begin(); it != table->overflow.end();) {
+		/* Advance before the visited index is possibly removed. */
+		struct relay_index *index = (it++)->second;
 
-	return urcu_ref_get_unless_zero(&index->ref);
+		const auto ret = visitor(index);
+		if (ret) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+} /* namespace */
+
+/*
+ * Allocate a new relay index object from the pool of the stream in which
+ * it is contained. The sequence number will be used as the index table
+ * key.
+ *
+ * Called with stream mutex held.
+ * Return allocated object or else NULL on error.
+ */
+static struct relay_index *relay_index_create(struct relay_stream *stream, uint64_t net_seq_num)
+{
+	struct relay_index *index;
+
+	DBG2("Creating relay index for stream id %" PRIu64 " and seqnum %" PRIu64,
+	     stream->stream_handle,
+	     net_seq_num);
+
+	index = index_pool_take(stream->indexes);
+	if (!index) {
+		ERR("Failed to allocate relay index");
+		goto end;
+	}
+	if (!stream_get(stream)) {
+		ERR("Cannot get stream");
+		index_pool_put(stream->indexes, index);
+		index = nullptr;
+		goto end;
+	}
+	index->stream = stream;
+
+	/* The object may have been used by a previous index of the stream. */
+	index->index_file = nullptr;
+	index->index_data = {};
+	index->total_size = 0;
+	index->has_index_data = false;
+	index->flushed = false;
+	index->in_index_table = false;
+	index->net_seq_num = net_seq_num;
+	urcu_ref_init(&index->ref);
+
+end:
+	return index;
 }
 
 /*
@@ -113,22 +289,16 @@ static bool relay_index_get(struct relay_index *index)
 struct relay_index *relay_index_get_by_id_or_create(struct relay_stream *stream,
 						    uint64_t net_seq_num)
 {
-	struct lttng_ht_node_u64 *node;
-	struct lttng_ht_iter iter;
-	struct relay_index *index = nullptr;
+	struct relay_index *index;
+
+	ASSERT_LOCKED(stream->lock);
 
 	DBG3("Finding index for stream id %" PRIu64 " and seq_num %" PRIu64,
 	     stream->stream_handle,
 	     net_seq_num);
 
-	const lttng::urcu::read_lock_guard read_lock;
-	lttng_ht_lookup(stream->indexes_ht, &net_seq_num, &iter);
-	node = lttng_ht_iter_get_node<lttng_ht_node_u64>(&iter);
-	if (node) {
-		index = lttng::utils::container_of(node, &relay_index::index_n);
-	} else {
-		struct relay_index *oldindex;
-
+	index = index_table_find(stream->indexes, net_seq_num);
+	if (!index) {
 		index = relay_index_create(stream, net_seq_num);
 		if (!index) {
 			ERR("Cannot create index for stream id %" PRIu64 " and seq_num %" PRIu64,
@@ -136,21 +306,16 @@ struct relay_index *relay_index_get_by_id_or_create(struct relay_stream *stream,
 			    net_seq_num);
 			goto end;
 		}
-		oldindex = relay_index_add_unique(stream, index);
-		if (oldindex) {
-			/* Added concurrently, keep old. */
+		if (index_table_add(stream->indexes, index)) {
 			relay_index_put(index);
-			index = oldindex;
-			if (!relay_index_get(index)) {
-				index = nullptr;
-			}
-		} else {
-			stream->indexes_in_flight++;
-			index->in_hash_table = true;
+			index = nullptr;
+			goto end;
 		}
+		stream->indexes_in_flight++;
+		index->in_index_table = true;
 	}
 end:
-	DBG2("Index %sfound or created in HT for stream ID %" PRIu64 " and seqnum %" PRIu64,
+	DBG2("Index %sfound or created in table for stream ID %" PRIu64 " and seqnum %" PRIu64,
 	     (index == NULL) ? "NOT " : "",
 	     stream->stream_handle,
 	     net_seq_num);
@@ -198,42 +363,26 @@ end:
 	return ret;
 }
 
-static void index_destroy(struct relay_index *index)
-{
-	free(index);
-}
-
-static void index_destroy_rcu(struct rcu_head *rcu_head)
-{
-	struct relay_index *index = lttng::utils::container_of(rcu_head, &relay_index::rcu_node);
-
-	index_destroy(index);
-}
-
 /* Stream lock must be held by the caller. */
 static void index_release(struct urcu_ref *ref)
 {
 	struct relay_index *index = lttng::utils::container_of(ref, &relay_index::ref);
 	struct relay_stream *stream = index->stream;
-	int ret;
-	struct lttng_ht_iter iter;
 
 	if (index->index_file) {
 		lttng_index_file_put(index->index_file);
 		index->index_file = nullptr;
 	}
-	if (index->in_hash_table) {
-		/* Delete index from hash table. */
-		iter.iter.node = &index->index_n.node;
-		ret = lttng_ht_del(stream->indexes_ht, &iter);
-		LTTNG_ASSERT(!ret);
+	if (index->in_index_table) {
+		index_table_remove(stream->indexes, index);
+		index->in_index_table = false;
 		stream->indexes_in_flight--;
 	}
 
-	stream_put(index->stream);
 	index->stream = nullptr;
-
-	call_rcu(&index->rcu_node, index_destroy_rcu);
+	/* The pool is owned by the stream: recycle the object before putting it. */
+	index_pool_put(stream->indexes, index);
+	stream_put(stream);
 }
 
 /*
@@ -245,15 +394,12 @@ void relay_index_put(struct relay_index *index)
 {
 	DBG2("index put for stream id %" PRIu64 " and seqnum %" PRIu64 " refcount %d",
 	     index->stream->stream_handle,
-	     index->index_n.key,
+	     index->net_seq_num,
 	     (int) index->ref.refcount);
 	/*
-	 * Ensure existence of index->lock for index unlock.
-	 */
-	const lttng::urcu::read_lock_guard read_lock;
-	/*
-	 * Index lock ensures that concurrent test and update of stream
-	 * ref is atomic.
+	 * Index objects are only recycled under the stream lock and freed
+	 * with their stream, so they outlive any user holding the stream
+	 * lock.
 	 */
 	LTTNG_ASSERT(index->ref.refcount != 0);
 	urcu_ref_put(&index->ref, index_release);
@@ -283,7 +429,7 @@ int relay_index_try_flush(struct relay_index *index)
 
 	DBG2("Writing index for stream ID %" PRIu64 " and seq num %" PRIu64,
 	     index->stream->stream_handle,
-	     index->index_n.key);
+	     index->net_seq_num);
 	flushed = true;
 	index->flushed = true;
 	ret = lttng_index_file_write(index->index_file, &index->index_data);
@@ -303,23 +449,18 @@ skip:
  */
 void relay_index_close_all(struct relay_stream *stream)
 {
-	for (auto *index :
-	     lttng::urcu::lfht_iteration_adapter<relay_index,
-						 decltype(relay_index::index_n),
-						 &relay_index::index_n>(*stream->indexes_ht->ht)) {
+	index_table_for_each(stream->indexes, [](struct relay_index *index) {
 		/* Put self-ref from index. */
 		relay_index_put(index);
-	}
+		return 0;
+	});
 }
 
 void relay_index_close_partial_fd(struct relay_stream *stream)
 {
-	for (auto *index :
-	     lttng::urcu::lfht_iteration_adapter<relay_index,
-						 decltype(relay_index::index_n),
-						 &relay_index::index_n>(*stream->indexes_ht->ht)) {
+	index_table_for_each(stream->indexes, [](struct relay_index *index) {
 		if (!index->index_file) {
-			continue;
+			return 0;
 		}
 		/*
 		 * Partial index has its index_file: we have only
@@ -327,21 +468,20 @@ void relay_index_close_partial_fd(struct relay_stream *stream)
 		 * Put self-ref from index.
 		 */
 		relay_index_put(index);
-	}
+		return 0;
+	});
 }
 
 uint64_t relay_index_find_last(struct relay_stream *stream)
 {
 	uint64_t net_seq_num = -1ULL;
 
-	for (auto *index :
-	     lttng::urcu::lfht_iteration_adapter<relay_index,
-						 decltype(relay_index::index_n),
-						 &relay_index::index_n>(*stream->indexes_ht->ht)) {
-		if (net_seq_num == -1ULL || index->index_n.key > net_seq_num) {
-			net_seq_num = index->index_n.key;
+	index_table_for_each(stream->indexes, [&net_seq_num](struct relay_index *index) {
+		if (net_seq_num == -1ULL || index->net_seq_num > net_seq_num) {
+			net_seq_num = index->net_seq_num;
 		}
-	}
+		return 0;
+	});
 
 	return net_seq_num;
 }
@@ -382,18 +522,26 @@ end:
  */
 int relay_index_switch_all_files(struct relay_stream *stream)
 {
-	for (auto *index :
-	     lttng::urcu::lfht_iteration_adapter<relay_index,
-						 decltype(relay_index::index_n),
-						 &relay_index::index_n>(*stream->indexes_ht->ht)) {
-		const auto ret = relay_index_switch_file(
+	return index_table_for_each(stream->indexes, [stream](struct relay_index *index) {
+		return relay_index_switch_file(
 			index, stream->index_file, stream->pos_after_last_complete_data_index);
-		if (ret) {
-			return ret;
-		}
-	}
+	});
+}
 
-	return 0;
+/* Stream lock must be held. */
+void relay_index_print_all(struct relay_stream *stream)
+{
+	index_table_for_each(stream->indexes, [stream](struct relay_index *index) {
+		DBG("index %p net_seq_num %" PRIu64 " refcount %ld"
+		    " stream %" PRIu64 " trace %" PRIu64 " session %" PRIu64,
+		    index,
+		    index->net_seq_num,
+		    stream->ref.refcount,
+		    index->stream->stream_handle,
+		    index->stream->trace->id,
+		    index->stream->trace->session->id);
+		return 0;
+	});
 }
 
 /*
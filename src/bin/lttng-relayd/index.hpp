@@ -10,13 +10,14 @@
  *
  */
 
-#include <common/hashtable/hashtable.hpp>
 #include <common/index/index.hpp>
 
 #include <inttypes.h>
 #include <pthread.h>
+#include <urcu/ref.h>
 
 struct relay_stream;
+struct relay_index_table;
 struct relay_connection;
 struct lttcomm_relayd_index;
 
@@ -41,17 +42,33 @@ struct relay_index {
 
 	bool has_index_data;
 	bool flushed;
-	bool in_hash_table;
+	bool in_index_table;
 
 	/*
-	 * Node within indexes_ht that corresponds to this struct
-	 * relay_index. Indexed by net_seq_num, which is unique for this
-	 * index across the stream.
+	 * Key of this index within the index table of the stream, unique for
+	 * this index across the stream.
 	 */
-	struct lttng_ht_node_u64 index_n;
-	struct rcu_head rcu_node; /* For call_rcu teardown. */
+	uint64_t net_seq_num;
+	/* Next free index object of the stream's pool. */
+	struct relay_index *next_free;
 };
 
+/*
+ * Indexes in flight of a stream, protected by the stream lock.
+ *
+ * Every packet of a stream has an index object, created by whichever of the
+ * data and control connections first receives its information and released
+ * once flushed. The index objects are allocated in slabs owned by the stream
+ * and recycled, once released, through a free list.
+ *
+ * Since the data and control information of the packets arrive nearly in
+ * order, the indexes are found in a ring indexed by their sequence number.
+ * The ring grows, up to a maximal size, when two indexes in flight share a
+ * slot; the indexes that still collide are kept in an overflow map.
+ */
+struct relay_index_table *relay_index_table_create();
+void relay_index_table_destroy(struct relay_index_table *table);
+
 struct relay_index *relay_index_get_by_id_or_create(struct relay_stream *stream,
 						    uint64_t net_seq_num);
 void relay_index_put(struct relay_index *index);
@@ -65,6 +82,7 @@ void relay_index_close_all(struct relay_stream *stream);
 void relay_index_close_partial_fd(struct relay_stream *stream);
 uint64_t relay_index_find_last(struct relay_stream *stream);
 int relay_index_switch_all_files(struct relay_stream *stream);
+void relay_index_print_all(struct relay_stream *stream);
 int relay_index_set_control_data(struct relay_index *index,
 				 const struct lttcomm_relayd_index *data,
 				 unsigned int minor_version);
@@ -0,0 +1,361 @@
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ */
+
+#define _LGPL_SOURCE
+#include "live-session-list.hpp"
+#include "session.hpp"
+
+#include <common/common.hpp>
+#include <common/compat/endian.hpp>
+#include <common/urcu.hpp>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string.h>
+#include <urcu.h>
+#include <urcu/uatomic.h>
+
+/*
+ * Maximal number of session removals kept to answer "changes since"
+ * requests. A viewer requesting the changes since an older version receives
+ * the full list of sessions.
+ */
+#define LIVE_SESSION_LIST_MAX_REMOVALS 4096
+
+namespace {
+struct listed_session {
+	/* In the byte order of the live protocol. */
+	struct lttng_viewer_session descriptor;
+	/* Version of the list at which the descriptor was last modified. */
+	uint64_t modification_version;
+};
+
+struct session_removal {
+	uint64_t version;
+	uint64_t session_id;
+};
+
+/* Immutable once published. */
+struct session_list_snapshot {
+	uint64_t version;
+	/* Oldest version from which the changes can be computed. */
+	uint64_t history_start_version;
+	std::vector<struct lttng_viewer_session> sessions;
+	/* Modification version of each entry of `sessions`. */
+	std::vector<uint64_t> modification_versions;
+	/* Ordered by version; shared by the snapshots until a session is removed. */
+	std::shared_ptr<const std::vector<session_removal>> removals;
+	struct rcu_head rcu_node;
+};
+
+/* Protected by `list_lock`. */
+struct {
+	std::map<uint64_t, listed_session> sessions;
+	std::deque<session_removal> removals;
+	/* Copy of `removals` shared by the snapshots, reset when they change. */
+	std::shared_ptr<const std::vector<session_removal>> published_removals;
+	uint64_t version;
+	uint64_t history_start_version;
+	bool destroyed;
+} the_list;
+
+std::mutex list_lock;
+
+/* Published snapshot, RCU-protected. */
+session_list_snapshot *the_snapshot;
+
+/*
+ * Set when the version of the list is newer than the one of the published
+ * snapshot. Readers only take `list_lock` to publish a snapshot when it is
+ * set.
+ */
+int snapshot_is_stale = 1;
+
+void destroy_snapshot_rcu(struct rcu_head *head)
+{
+	auto *snapshot = lttng::utils::container_of(head, &session_list_snapshot::rcu_node);
+
+	delete snapshot;
+}
+
+/*
+ * Publish a snapshot of the list to the viewer threads.
+ *
+ * On allocation failure, the previous snapshot remains published and stale
+ * so that the next reader attempts to publish it again.
+ *
+ * Must be called with `list_lock` held.
+ */
+void publish_snapshot()
+{
+	session_list_snapshot *previous_snapshot;
+	session_list_snapshot *snapshot = nullptr;
+
+	try {
+		if (!the_list.published_removals) {
+			the_list.published_removals =
+				std::make_shared<const std::vector<session_removal>>(
+					the_list.removals.begin(), the_list.removals.end());
+		}
+
+		snapshot = new session_list_snapshot;
+		snapshot->version = the_list.version;
+		snapshot->history_start_version = the_list.history_start_version;
+		snapshot->sessions.reserve(the_list.sessions.size());
+		snapshot->modification_versions.reserve(the_list.sessions.size());
+		for (const auto& entry : the_list.sessions) {
+			snapshot->sessions.emplace_back(entry.second.descriptor);
+			snapshot->modification_versions.emplace_back(
+				entry.second.modification_version);
+		}
+
+		snapshot->removals = the_list.published_removals;
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to allocate a snapshot of the live session list");
+		delete snapshot;
+		return;
+	}
+
+	previous_snapshot = rcu_xchg_pointer(&the_snapshot, snapshot);
+	if (previous_snapshot) {
+		call_rcu(&previous_snapshot->rcu_node, destroy_snapshot_rcu);
+	}
+
+	uatomic_set(&snapshot_is_stale, 0);
+}
+
+/*
+ * The updates of the list only mark the snapshot as stale. The first reader
+ * of a stale snapshot publishes an up-to-date one, so that a burst of updates
+ * results in a single copy of the list.
+ */
+int refresh_snapshot()
+{
+	if (!uatomic_read(&snapshot_is_stale)) {
+		return 0;
+	}
+
+	const std::lock_guard<std::mutex> lock(list_lock);
+
+	if (the_list.destroyed) {
+		return -1;
+	}
+
+	if (uatomic_read(&snapshot_is_stale)) {
+		publish_snapshot();
+	}
+
+	return uatomic_read(&snapshot_is_stale) ? -1 : 0;
+}
+
+/* Must be called with `list_lock` held. */
+void mark_list_changed(uint64_t session_id, listed_session *session)
+{
+	the_list.version++;
+	if (session) {
+		session->modification_version = the_list.version;
+	} else {
+		the_list.removals.push_back({ the_list.version, session_id });
+		the_list.published_removals.reset();
+		if (the_list.removals.size() > LIVE_SESSION_LIST_MAX_REMOVALS) {
+			/* Changes spanning the dropped removal can no longer be computed. */
+			the_list.history_start_version = the_list.removals.front().version;
+			the_list.removals.pop_front();
+		}
+	}
+
+	uatomic_set(&snapshot_is_stale, 1);
+}
+
+template <typename UpdateFunction>
+void update_session(uint64_t session_id, UpdateFunction update)
+{
+	const std::lock_guard<std::mutex> lock(list_lock);
+	auto it = the_list.sessions.find(session_id);
+
+	if (it == the_list.sessions.end()) {
+		return;
+	}
+
+	if (!update(it->second.descriptor)) {
+		/* Unchanged. */
+		return;
+	}
+
+	mark_list_changed(session_id, &it->second);
+}
+} /* namespace */
+
+void live_session_list_add(const struct relay_session *session)
+{
+	listed_session listed = {};
+
+	if (lttng_strncpy(listed.descriptor.session_name,
+			  session->session_name,
+			  sizeof(listed.descriptor.session_name)) ||
+	    lttng_strncpy(listed.descriptor.hostname,
+			  session->hostname,
+			  sizeof(listed.descriptor.hostname))) {
+		WARN("Session name or hostname exceeds the length supported by the live protocol: session id = %" PRIu64,
+		     session->id);
+		return;
+	}
+
+	listed.descriptor.id = htobe64(session->id);
+	listed.descriptor.live_timer = htobe32(session->live_timer);
+	listed.descriptor.clients = htobe32(session->viewer_attached ? 1 : 0);
+	listed.descriptor.streams = htobe32(session->stream_count);
+
+	const std::lock_guard<std::mutex> lock(list_lock);
+	try {
+		auto it = the_list.sessions.emplace(session->id, listed).first;
+
+		mark_list_changed(session->id, &it->second);
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to add session to the live session list: session id = %" PRIu64,
+		    session->id);
+	}
+}
+
+void live_session_list_remove(uint64_t session_id)
+{
+	const std::lock_guard<std::mutex> lock(list_lock);
+
+	if (!the_list.sessions.erase(session_id)) {
+		return;
+	}
+
+	try {
+		mark_list_changed(session_id, nullptr);
+	} catch (const std::bad_alloc&) {
+		/* The removal can't be reported as a change; force a full resync. */
+		the_list.history_start_version = the_list.version;
+		the_list.removals.clear();
+		the_list.published_removals.reset();
+		uatomic_set(&snapshot_is_stale, 1);
+	}
+}
+
+void live_session_list_set_stream_count(uint64_t session_id, uint32_t stream_count)
+{
+	update_session(session_id, [stream_count](struct lttng_viewer_session& descriptor) {
+		const uint32_t streams = htobe32(stream_count);
+
+		if (descriptor.streams == streams) {
+			return false;
+		}
+
+		descriptor.streams = streams;
+		return true;
+	});
+}
+
+void live_session_list_set_viewer_attached(uint64_t session_id, bool viewer_attached)
+{
+	update_session(session_id, [viewer_attached](struct lttng_viewer_session& descriptor) {
+		const uint32_t clients = htobe32(viewer_attached ? 1 : 0);
+
+		if (descriptor.clients == clients) {
+			return false;
+		}
+
+		descriptor.clients = clients;
+		return true;
+	});
+}
+
+int live_session_list_get(struct live_session_list_copy *copy)
+{
+	if (refresh_snapshot()) {
+		return -1;
+	}
+
+	try {
+		const lttng::urcu::read_lock_guard read_lock;
+		const auto *snapshot = rcu_dereference(the_snapshot);
+
+		if (!snapshot) {
+			/* The list was destroyed. */
+			return -1;
+		}
+
+		copy->version = snapshot->version;
+		copy->is_full = true;
+		copy->sessions = snapshot->sessions;
+		copy->removed_session_ids.clear();
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to copy the live session list");
+		return -1;
+	}
+
+	return 0;
+}
+
+int live_session_list_get_changes(uint64_t since_version, struct live_session_list_copy *copy)
+{
+	if (refresh_snapshot()) {
+		return -1;
+	}
+
+	try {
+		const lttng::urcu::read_lock_guard read_lock;
+		const auto *snapshot = rcu_dereference(the_snapshot);
+
+		if (!snapshot) {
+			/* The list was destroyed. */
+			return -1;
+		}
+
+		copy->version = snapshot->version;
+		copy->sessions.clear();
+		copy->removed_session_ids.clear();
+		if (since_version == 0 || since_version > snapshot->version ||
+		    since_version < snapshot->history_start_version) {
+			/* Unknown version: the viewer must resynchronize. */
+			copy->is_full = true;
+			copy->sessions = snapshot->sessions;
+			return 0;
+		}
+
+		copy->is_full = false;
+		for (size_t i = 0; i < snapshot->sessions.size(); i++) {
+			if (snapshot->modification_versions[i] > since_version) {
+				copy->sessions.emplace_back(snapshot->sessions[i]);
+			}
+		}
+
+		for (auto it = snapshot->removals->rbegin();
+		     it != snapshot->removals->rend() && it->version > since_version;
+		     ++it) {
+			copy->removed_session_ids.emplace_back(htobe64(it->session_id));
+		}
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to copy the changes of the live session list");
+		return -1;
+	}
+
+	return 0;
+}
+
+void live_session_list_destroy()
+{
+	const std::lock_guard<std::mutex> lock(list_lock);
+	auto *snapshot = rcu_xchg_pointer(&the_snapshot, nullptr);
+
+	/* Readers must not publish a new snapshot. */
+	the_list.destroyed = true;
+	if (snapshot) {
+		call_rcu(&snapshot->rcu_node, destroy_snapshot_rcu);
+	}
+
+	the_list.sessions.clear();
+	the_list.removals.clear();
+	the_list.published_removals.reset();
+}
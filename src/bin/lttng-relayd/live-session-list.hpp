@@ -0,0 +1,70 @@
+#ifndef _LIVE_SESSION_LIST_H
+#define _LIVE_SESSION_LIST_H
+
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ */
+
+#include "lttng-viewer-abi.hpp"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <vector>
+
+struct relay_session;
+
+/*
+ * The live session list maintains the descriptors of the sessions that are
+ * listed to live viewers.
+ *
+ * Every update of a descriptor (session creation and closure, stream count
+ * and viewer attachment changes) increments the version of the list. The
+ * first viewer listing the sessions at a newer version than the one of the
+ * published RCU-protected snapshot publishes a new snapshot. Hence, listing
+ * the sessions mostly takes no lock and never walks the session hash table.
+ *
+ * The descriptors are kept in the byte order of the live protocol.
+ */
+
+struct live_session_list_copy {
+	/* Version of the list at the time of the copy. */
+	uint64_t version;
+	/*
+	 * Set when the changes since the requested version can't be
+	 * computed; `sessions` then holds all the listed sessions.
+	 */
+	bool is_full;
+	/* In the byte order of the live protocol. */
+	std::vector<struct lttng_viewer_session> sessions;
+	/* In the byte order of the live protocol. */
+	std::vector<uint64_t> removed_session_ids;
+};
+
+/*
+ * The updates of a session's descriptor must be serialized by the caller
+ * (e.g. under the lock protecting the attribute that changed) so that they
+ * are applied in order. Updates of unlisted sessions are ignored.
+ */
+void live_session_list_add(const struct relay_session *session);
+void live_session_list_remove(uint64_t session_id);
+void live_session_list_set_stream_count(uint64_t session_id, uint32_t stream_count);
+void live_session_list_set_viewer_attached(uint64_t session_id, bool viewer_attached);
+
+/* Copy all the listed sessions. Returns 0 on success, -1 on error. */
+int live_session_list_get(struct live_session_list_copy *copy);
+
+/*
+ * Copy the sessions that were added or modified, and the identifiers of the
+ * sessions that were removed, since `since_version`. A `since_version` of 0
+ * requests all the listed sessions.
+ *
+ * Returns 0 on success, -1 on error.
+ */
+int live_session_list_get_changes(uint64_t since_version, struct live_session_list_copy *copy);
+
+void live_session_list_destroy();
+
+#endif /* _LIVE_SESSION_LIST_H */
@@ -12,6 +12,7 @@
 #include "connection.hpp"
 #include "ctf-trace.hpp"
 #include "health-relayd.hpp"
+#include "live-session-list.hpp"
 #include "live.hpp"
 #include "lttng-relayd.hpp"
 #include "session.hpp"
@@ -65,8 +66,6 @@
 #include <urcu/rculist.h>
 #include <urcu/uatomic.h>
 
-#define SESSION_BUF_DEFAULT_COUNT 16
-
 static struct lttng_uri *live_uri;
 
 /*
@@ -114,6 +113,8 @@ static const char *lttng_viewer_command_str(lttng_viewer_command cmd)
 		return "CREATE_SESSION";
 	case LTTNG_VIEWER_DETACH_SESSION:
 		return "DETACH_SESSION";
+	case LTTNG_VIEWER_LIST_SESSIONS_CHANGES:
+		return "LIST_SESSIONS_CHANGES";
 	default:
 		abort();
 	}
@@ -1192,107 +1193,112 @@ end:
 
 /*
  * Send the viewer the list of current sessions.
- * We need to create a copy of the hash table content because otherwise
- * we cannot assume the number of entries stays the same between getting
- * the number of HT elements and iteration over the HT.
+ *
+ * The sessions are copied from the published snapshot of the live session
+ * list; the sessions themselves are not locked.
  *
  * Return 0 on success or else a negative value.
  */
 static int viewer_list_sessions(struct relay_connection *conn)
 {
-	int ret = 0;
+	int ret;
 	struct lttng_viewer_list_sessions session_list;
-	struct lttng_viewer_session *send_session_buf = nullptr;
-	uint32_t buf_count = SESSION_BUF_DEFAULT_COUNT;
-	uint32_t count = 0;
+	struct live_session_list_copy copy;
 
-	send_session_buf = calloc<lttng_viewer_session>(SESSION_BUF_DEFAULT_COUNT);
-	if (!send_session_buf) {
+	ret = live_session_list_get(&copy);
+	if (ret < 0) {
 		return -1;
 	}
 
-	for (auto *session :
-	     lttng::urcu::lfht_iteration_adapter<relay_session,
-						 decltype(relay_session::session_n),
-						 &relay_session::session_n>(*sessions_ht->ht)) {
-		struct lttng_viewer_session *send_session;
+	session_list.sessions_count = htobe32((uint32_t) copy.sessions.size());
 
-		health_code_update();
+	health_code_update();
 
-		pthread_mutex_lock(&session->lock);
-		if (session->connection_closed) {
-			/* Skip closed session */
-			goto next_session;
-		}
+	ret = send_response(conn->sock, &session_list, sizeof(session_list));
+	if (ret < 0) {
+		return ret;
+	}
 
-		if (count >= buf_count) {
-			struct lttng_viewer_session *newbuf;
-			const uint32_t new_buf_count = buf_count << 1;
+	health_code_update();
 
-			newbuf = (lttng_viewer_session *) realloc(
-				send_session_buf, new_buf_count * sizeof(*send_session_buf));
-			if (!newbuf) {
-				ret = -1;
-				goto break_loop;
-			}
-			send_session_buf = newbuf;
-			buf_count = new_buf_count;
-		}
-		send_session = &send_session_buf[count];
-		if (lttng_strncpy(send_session->session_name,
-				  session->session_name,
-				  sizeof(send_session->session_name))) {
-			ret = -1;
-			goto break_loop;
-		}
-		if (lttng_strncpy(send_session->hostname,
-				  session->hostname,
-				  sizeof(send_session->hostname))) {
-			ret = -1;
-			goto break_loop;
-		}
-		send_session->id = htobe64(session->id);
-		send_session->live_timer = htobe32(session->live_timer);
-		if (session->viewer_attached) {
-			send_session->clients = htobe32(1);
-		} else {
-			send_session->clients = htobe32(0);
+	if (!copy.sessions.empty()) {
+		ret = send_response(conn->sock,
+				    copy.sessions.data(),
+				    copy.sessions.size() * sizeof(copy.sessions[0]));
+		if (ret < 0) {
+			return ret;
 		}
-		send_session->streams = htobe32(session->stream_count);
-		count++;
-	next_session:
-		pthread_mutex_unlock(&session->lock);
-		continue;
-	break_loop:
-		pthread_mutex_unlock(&session->lock);
-		break;
 	}
 
-	if (ret < 0) {
-		goto end_free;
-	}
+	health_code_update();
+
+	return 0;
+}
 
-	session_list.sessions_count = htobe32(count);
+/*
+ * Send the viewer the sessions that changed since the version it last
+ * listed, as well as the identifiers of the sessions that were removed.
+ *
+ * Return 0 on success or else a negative value.
+ */
+static int viewer_list_sessions_changes(struct relay_connection *conn)
+{
+	int ret;
+	struct lttng_viewer_list_sessions_changes_request request;
+	struct lttng_viewer_list_sessions_changes_response response;
+	struct live_session_list_copy copy;
 
 	health_code_update();
 
-	ret = send_response(conn->sock, &session_list, sizeof(session_list));
+	ret = recv_request(conn->sock, &request, sizeof(request));
 	if (ret < 0) {
-		goto end_free;
+		return ret;
 	}
 
 	health_code_update();
 
-	ret = send_response(conn->sock, send_session_buf, count * sizeof(*send_session_buf));
+	memset(&response, 0, sizeof(response));
+	ret = live_session_list_get_changes(be64toh(request.since_version), &copy);
 	if (ret < 0) {
-		goto end_free;
+		response.status = htobe32(LTTNG_VIEWER_LIST_SESSIONS_CHANGES_ERR);
+		return send_response(conn->sock, &response, sizeof(response)) < 0 ? -1 : 0;
 	}
+
+	response.status = htobe32(copy.is_full ? LTTNG_VIEWER_LIST_SESSIONS_CHANGES_FULL :
+						 LTTNG_VIEWER_LIST_SESSIONS_CHANGES_OK);
+	response.version = htobe64(copy.version);
+	response.sessions_count = htobe32((uint32_t) copy.sessions.size());
+	response.removed_sessions_count = htobe32((uint32_t) copy.removed_session_ids.size());
+
+	ret = send_response(conn->sock, &response, sizeof(response));
+	if (ret < 0) {
+		return ret;
+	}
+
 	health_code_update();
 
-	ret = 0;
-end_free:
-	free(send_session_buf);
-	return ret;
+	if (!copy.sessions.empty()) {
+		ret = send_response(conn->sock,
+				    copy.sessions.data(),
+				    copy.sessions.size() * sizeof(copy.sessions[0]));
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	if (!copy.removed_session_ids.empty()) {
+		ret = send_response(conn->sock,
+				    copy.removed_session_ids.data(),
+				    copy.removed_session_ids.size() *
+					    sizeof(copy.removed_session_ids[0]));
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	health_code_update();
+
+	return 0;
 }
 
 /*
@@ -2721,6 +2727,20 @@ static int process_control(struct lttng_viewer_cmd *recv_hdr, struct relay_conne
 	case LTTNG_VIEWER_LIST_SESSIONS:
 		ret = viewer_list_sessions(conn);
 		break;
+	case LTTNG_VIEWER_LIST_SESSIONS_CHANGES:
+		if (conn->minor < 15) {
+			ERR("Viewer on connection %d requested %s command with protocol %u.%u",
+			    conn->sock->fd,
+			    lttng_viewer_command_str(cmd),
+			    conn->major,
+			    conn->minor);
+			live_relay_unknown_command(conn);
+			ret = -1;
+			goto end;
+		}
+
+		ret = viewer_list_sessions_changes(conn);
+		break;
 	case LTTNG_VIEWER_ATTACH_SESSION:
 		ret = viewer_attach_session(conn);
 		break;
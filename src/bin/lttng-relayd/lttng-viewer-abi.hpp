@@ -36,6 +36,8 @@ enum lttng_viewer_command {
 	LTTNG_VIEWER_GET_NEW_STREAMS = 7,
 	LTTNG_VIEWER_CREATE_SESSION = 8,
 	LTTNG_VIEWER_DETACH_SESSION = 9,
+	/* Only available to viewers that negotiated protocol 2.15 or later. */
+	LTTNG_VIEWER_LIST_SESSIONS_CHANGES = 10,
 };
 
 enum lttng_viewer_attach_return_code {
@@ -99,6 +101,14 @@ enum lttng_viewer_detach_session_return_code {
 	LTTNG_VIEWER_DETACH_SESSION_ERR = 3,
 };
 
+enum lttng_viewer_list_sessions_changes_return_code {
+	/* The changes since the requested version are sent. */
+	LTTNG_VIEWER_LIST_SESSIONS_CHANGES_OK = 1,
+	/* All the sessions are sent; the viewer must resynchronize its list. */
+	LTTNG_VIEWER_LIST_SESSIONS_CHANGES_FULL = 2,
+	LTTNG_VIEWER_LIST_SESSIONS_CHANGES_ERR = 3,
+};
+
 struct lttng_viewer_session {
 	uint64_t id;
 	uint32_t live_timer;
@@ -141,6 +151,30 @@ struct lttng_viewer_list_sessions {
 	char session_list[]; /* struct lttng_viewer_session */
 } LTTNG_PACKED;
 
+/*
+ * LTTNG_VIEWER_LIST_SESSIONS_CHANGES payload.
+ */
+struct lttng_viewer_list_sessions_changes_request {
+	/* Version returned by a previous request, 0 to list all the sessions. */
+	uint64_t since_version;
+} LTTNG_PACKED;
+
+struct lttng_viewer_list_sessions_changes_response {
+	/* enum lttng_viewer_list_sessions_changes_return_code */
+	uint32_t status;
+	/* Version of the session list described by this response. */
+	uint64_t version;
+	/* Sessions added or modified since the requested version. */
+	uint32_t sessions_count;
+	/* Sessions removed since the requested version. */
+	uint32_t removed_sessions_count;
+	/*
+	 * `sessions_count` struct lttng_viewer_session followed by
+	 * `removed_sessions_count` uint64_t session ids.
+	 */
+	char session_list[];
+} LTTNG_PACKED;
+
 /*
  * LTTNG_VIEWER_ATTACH_SESSION payload.
  */
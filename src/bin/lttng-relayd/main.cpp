@@ -15,10 +15,12 @@
 #include "ctf-trace.hpp"
 #include "health-relayd.hpp"
 #include "index.hpp"
+#include "live-session-list.hpp"
 #include "live.hpp"
 #include "lttng-relayd.hpp"
 #include "session.hpp"
 #include "sessiond-trace-chunks.hpp"
+#include "stream-file-preparation.hpp"
 #include "stream.hpp"
 #include "tcp_keep_alive.hpp"
 #include "testpoint.hpp"
@@ -62,6 +64,9 @@
 #include <grp.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <new>
 #include <pthread.h>
 #include <signal.h>
 #include <stdio.h>
@@ -73,6 +78,7 @@
 #include <sys/resource.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/ioctl.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -99,7 +105,8 @@ enum relay_connection_status {
 /* command line options */
 char *opt_output_path, *opt_working_directory, *opt_pid_file = nullptr;
 static int opt_daemon, opt_background, opt_print_version,
-	opt_allow_clear = 1, opt_dynamic_port_allocation = 0, opt_sig_parent = 0;
+	opt_allow_clear = 1, opt_dynamic_port_allocation = 0, opt_sig_parent = 0,
+	opt_metadata_fragments = 0;
 enum relay_group_output_by opt_group_output_by = RELAYD_GROUP_OUTPUT_BY_UNKNOWN;
 
 /* Argument variables */
@@ -117,6 +124,13 @@ static int lttng_relay_ready = NR_LTTNG_RELAY_READY;
 /* Size of receive buffer. */
 #define RECV_DATA_BUFFER_SIZE 65536
 
+/*
+ * Maximal number of reception steps (command header or payload) performed on
+ * a control connection per wake-up of the worker thread. Bounds the time a
+ * peer pipelining commands can monopolize the thread.
+ */
+#define CTRL_CONNECTION_MAX_BATCHED_RECEPTIONS 128
+
 static int recv_child_signal; /* Set to 1 when a SIGUSR1 signal is received. */
 static pid_t child_ppid; /* Internal parent PID use with daemonize. */
 
@@ -267,6 +281,7 @@ static struct option long_options[] = {
 	},
 	{ "disallow-clear", 0, nullptr, 'x' },
 	{ "dynamic-port-allocation", 0, nullptr, '\0' },
+	{ "metadata-fragments", 0, nullptr, '\0' },
 	{ "sig-parent", 0, nullptr, 'S' },
 	{
 		nullptr,
@@ -327,6 +342,8 @@ static int set_option(int opt, const char *arg, const char *optname)
 			lttng_opt_fd_pool_size = (unsigned int) v;
 		} else if (!strcmp(optname, "dynamic-port-allocation")) {
 			opt_dynamic_port_allocation = 1;
+		} else if (!strcmp(optname, "metadata-fragments")) {
+			opt_metadata_fragments = 1;
 		} else {
 			fprintf(stderr, "unknown option %s", optname);
 			if (arg) {
@@ -756,6 +773,21 @@ static int set_options(int argc, char **argv)
 			opt_allow_clear = !ret;
 		}
 	}
+	if (!opt_metadata_fragments) {
+		/* Check if env variable exists. */
+		const char *value =
+			lttng_secure_getenv(DEFAULT_LTTNG_RELAYD_METADATA_FRAGMENTS_ENV);
+		if (value) {
+			ret = config_parse_value(value);
+			if (ret < 0) {
+				ERR("Invalid value for %s specified",
+				    DEFAULT_LTTNG_RELAYD_METADATA_FRAGMENTS_ENV);
+				retval = -1;
+				goto exit;
+			}
+			opt_metadata_fragments = ret;
+		}
+	}
 
 exit:
 	free(config_path);
@@ -795,6 +827,7 @@ static void relayd_cleanup()
 
 	DBG("Cleaning up");
 
+	stream_file_preparation_stop();
 	if (viewer_streams_ht)
 		lttng_ht_destroy(viewer_streams_ht);
 	if (viewer_sessions_ht) {
@@ -804,6 +837,7 @@ static void relayd_cleanup()
 		lttng_ht_destroy(relay_streams_ht);
 	if (sessions_ht)
 		lttng_ht_destroy(sessions_ht);
+	live_session_list_destroy();
 	free(opt_output_path);
 	free(opt_working_directory);
 
@@ -2112,6 +2146,80 @@ end:
 	return ret;
 }
 
+/*
+ * relay_recv_metadata_fragments: receive a metadata packet sent as fragments.
+ */
+static int relay_recv_metadata_fragments(const struct lttcomm_relayd_hdr *recv_hdr
+					 __attribute__((unused)),
+					 struct relay_connection *conn,
+					 const struct lttng_buffer_view *payload)
+{
+	int ret = 0;
+	struct relay_session *session = conn->session;
+	struct relay_stream *metadata_stream;
+	uint64_t stream_id;
+	uint32_t padding_size;
+	struct lttng_dynamic_buffer packet;
+	struct lttng_buffer_view packet_view;
+
+	lttng_dynamic_buffer_init(&packet);
+
+	if (!session) {
+		ERR("Metadata sent before version check");
+		ret = -1;
+		goto end;
+	}
+
+	if (!opt_metadata_fragments) {
+		ERR("Metadata fragments received but not accepted by this relay daemon");
+		ret = -1;
+		goto end;
+	}
+
+	if (!conn->protocol.ctrl.metadata_fragment_store) {
+		conn->protocol.ctrl.metadata_fragment_store =
+			new (std::nothrow) lttng::relayd::metadata_fragment_store;
+		if (!conn->protocol.ctrl.metadata_fragment_store) {
+			ERR("Failed to allocate metadata fragment store");
+			ret = -1;
+			goto end;
+		}
+	}
+
+	/*
+	 * A decoding error leaves the fragment store out of sync with the
+	 * peer's; the connection is closed on error.
+	 */
+	ret = lttng::relayd::decode_metadata_packet(*conn->protocol.ctrl.metadata_fragment_store,
+						    *payload,
+						    stream_id,
+						    padding_size,
+						    packet);
+	if (ret) {
+		ret = -1;
+		goto end;
+	}
+
+	metadata_stream = stream_get_by_id(stream_id);
+	if (!metadata_stream) {
+		ret = -1;
+		goto end;
+	}
+
+	packet_view = lttng_buffer_view_from_dynamic_buffer(&packet, 0, packet.size);
+	pthread_mutex_lock(&metadata_stream->lock);
+	ret = stream_write(metadata_stream, &packet_view, padding_size);
+	pthread_mutex_unlock(&metadata_stream->lock);
+	if (ret) {
+		ret = -1;
+	}
+
+	stream_put(metadata_stream);
+end:
+	lttng_dynamic_buffer_reset(&packet);
+	return ret;
+}
+
 /*
  * relay_send_version: send relayd version number
  */
@@ -3417,6 +3525,9 @@ static int relay_get_configuration(const struct lttcomm_relayd_hdr *recv_hdr
 	if (opt_allow_clear) {
 		result_flags |= LTTCOMM_RELAYD_CONFIGURATION_FLAG_CLEAR_ALLOWED;
 	}
+	if (opt_metadata_fragments) {
+		result_flags |= LTTCOMM_RELAYD_CONFIGURATION_FLAG_METADATA_FRAGMENTS;
+	}
 	ret = 0;
 reply:
 	reply.generic.ret_code =
@@ -3454,6 +3565,9 @@ static int relay_process_control_command(struct relay_connection *conn,
 	case RELAYD_SEND_METADATA:
 		ret = relay_recv_metadata(header, conn, payload);
 		break;
+	case RELAYD_SEND_METADATA_FRAGMENTS:
+		ret = relay_recv_metadata_fragments(header, conn, payload);
+		break;
 	case RELAYD_VERSION:
 		ret = relay_send_version(header, conn, payload);
 		break;
@@ -3648,11 +3762,12 @@ relay_process_control_receive_header(struct relay_connection *conn)
 	memcpy(&conn->protocol.ctrl.state.receive_payload.header, &header, sizeof(header));
 
 	DBG("Done receiving control command header: fd = %i, cmd = %s, cmd_version = %" PRIu32
-	    ", payload size = %" PRIu64 " bytes",
+	    ", payload size = %" PRIu64 " bytes, circuit id = %" PRIu64,
 	    conn->sock->fd,
 	    lttcomm_relayd_command_str((enum lttcomm_relayd_command) header.cmd),
 	    header.cmd_version,
-	    header.data_size);
+	    header.data_size,
+	    header.circuit_id);
 
 	if (header.data_size > DEFAULT_NETWORK_RELAYD_CTRL_MAX_PAYLOAD_SIZE) {
 		ERR("Command header indicates a payload (%" PRIu64
@@ -3681,10 +3796,7 @@ end:
 	return status;
 }
 
-/*
- * Process the commands received on the control socket
- */
-static enum relay_connection_status relay_process_control(struct relay_connection *conn)
+static enum relay_connection_status relay_process_control_step(struct relay_connection *conn)
 {
 	enum relay_connection_status status;
 
@@ -3703,6 +3815,78 @@ static enum relay_connection_status relay_process_control(struct relay_connectio
 	return status;
 }
 
+/*
+ * Return true if data is ready to be received on the control connection's
+ * socket.
+ */
+static bool control_connection_has_pending_input(const struct relay_connection *conn)
+{
+	int available = 0;
+
+	if (ioctl(conn->sock->fd, FIONREAD, &available) < 0) {
+		return false;
+	}
+
+	return available > 0;
+}
+
+/*
+ * Hold back (or release) the partial frames of the replies sent on a control
+ * connection's socket. Failing to do so only affects the number of segments
+ * used to send the replies.
+ */
+static void control_connection_set_cork(const struct relay_connection *conn, bool cork)
+{
+#ifdef TCP_CORK
+	const int value = cork ? 1 : 0;
+
+	if (setsockopt(conn->sock->fd, IPPROTO_TCP, TCP_CORK, &value, sizeof(value)) < 0) {
+		PERROR("Failed to %s control connection socket: fd = %i",
+		       cork ? "cork" : "uncork",
+		       conn->sock->fd);
+	}
+#else
+	(void) conn;
+	(void) cork;
+#endif
+}
+
+/*
+ * Process the commands received on the control socket
+ *
+ * Peers can pipeline commands (e.g. indexes or data pending queries) without
+ * waiting for their reply. All commands already received are processed on a
+ * single wake-up and the socket is corked while doing so to coalesce their
+ * replies in as few segments as possible.
+ */
+static enum relay_connection_status relay_process_control(struct relay_connection *conn)
+{
+	enum relay_connection_status status;
+	unsigned int reception_count = 0;
+	bool corked = false;
+
+	while (true) {
+		status = relay_process_control_step(conn);
+		reception_count++;
+		if (status != RELAY_CONNECTION_STATUS_OK ||
+		    reception_count >= CTRL_CONNECTION_MAX_BATCHED_RECEPTIONS ||
+		    !control_connection_has_pending_input(conn)) {
+			break;
+		}
+
+		if (!corked) {
+			control_connection_set_cork(conn, true);
+			corked = true;
+		}
+	}
+
+	if (corked && status == RELAY_CONNECTION_STATUS_OK) {
+		control_connection_set_cork(conn, false);
+	}
+
+	return status;
+}
+
 static enum relay_connection_status relay_process_data_receive_header(struct relay_connection *conn)
 {
 	int ret;
@@ -4429,6 +4613,7 @@ int main(int argc, char **argv)
 	}
 
 	DBG("Clear command %s", opt_allow_clear ? "allowed" : "disallowed");
+	DBG("Metadata fragments %s", opt_metadata_fragments ? "accepted" : "not accepted");
 
 	/* Try to create directory if -o, --output is specified. */
 	if (opt_output_path) {
@@ -9,6 +9,7 @@
 
 #define _LGPL_SOURCE
 #include "ctf-trace.hpp"
+#include "live-session-list.hpp"
 #include "lttng-relayd.hpp"
 #include "session.hpp"
 #include "sessiond-trace-chunks.hpp"
@@ -429,6 +430,7 @@ struct relay_session *session_create(const char *session_name,
 	}
 
 	lttng_ht_add_unique_u64(sessions_ht, &session->session_n);
+	live_session_list_add(session);
 	return session;
 
 error:
@@ -586,6 +588,8 @@ static void destroy_session(struct relay_session *session)
 
 	ret = session_delete(session);
 	LTTNG_ASSERT(!ret);
+	/* No-op if the session was closed. */
+	live_session_list_remove(session->id);
 	lttng_trace_chunk_put(session->current_trace_chunk);
 	session->current_trace_chunk = nullptr;
 	lttng_trace_chunk_put(session->pending_closure_trace_chunk);
@@ -623,6 +627,7 @@ int session_close(struct relay_session *session)
 	    session->id,
 	    session->connection_closed);
 	session->connection_closed = true;
+	live_session_list_remove(session->id);
 	pthread_mutex_unlock(&session->lock);
 
 	for (auto *trace :
@@ -0,0 +1,263 @@
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ */
+
+#define _LGPL_SOURCE
+#include "stream-file-preparation.hpp"
+
+#include <common/common.hpp>
+#include <common/fs-handle.hpp>
+#include <common/trace-chunk.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <urcu.h>
+
+namespace {
+class preparation_request {
+public:
+	preparation_request(lttng_trace_chunk *chunk,
+			    const char *path,
+			    uint64_t tracefile_index,
+			    mode_t mode) :
+		_chunk(chunk), _path(path), _tracefile_index(tracefile_index), _mode(mode)
+	{
+		const auto acquired_reference = lttng_trace_chunk_get(_chunk);
+
+		LTTNG_ASSERT(acquired_reference);
+	}
+
+	preparation_request(const preparation_request&) = delete;
+	preparation_request(preparation_request&&) = delete;
+	preparation_request& operator=(const preparation_request&) = delete;
+	preparation_request& operator=(preparation_request&&) = delete;
+
+	~preparation_request()
+	{
+		_release();
+	}
+
+	/* Called by the preparation thread. */
+	void open() noexcept
+	{
+		const std::lock_guard<std::mutex> lock(_lock);
+		enum lttng_trace_chunk_status status;
+
+		if (_canceled) {
+			return;
+		}
+
+		/*
+		 * Open an existing file first to only remove the file created
+		 * here if it ends up unused.
+		 */
+		DBG("Preparing stream file \"%s\"", _path.c_str());
+		status = lttng_trace_chunk_open_fs_handle(
+			_chunk, _path.c_str(), O_RDWR, _mode, &_handle, true);
+		if (status == LTTNG_TRACE_CHUNK_STATUS_NO_FILE) {
+			status = lttng_trace_chunk_open_fs_handle(
+				_chunk, _path.c_str(), O_RDWR | O_CREAT, _mode, &_handle, false);
+			_created = status == LTTNG_TRACE_CHUNK_STATUS_OK;
+		}
+
+		if (status != LTTNG_TRACE_CHUNK_STATUS_OK) {
+			/* Reported by the rotation which opens the file itself. */
+			DBG("Failed to prepare stream file \"%s\"", _path.c_str());
+			_handle = nullptr;
+		}
+	}
+
+	fs_handle *take(const lttng_trace_chunk *chunk, uint64_t tracefile_index) noexcept
+	{
+		const std::lock_guard<std::mutex> lock(_lock);
+		fs_handle *handle = nullptr;
+
+		_canceled = true;
+		if (!_handle || _chunk != chunk || _tracefile_index != tracefile_index) {
+			goto end;
+		}
+
+		/* The file may exist if the trace chunk's directory was reused. */
+		if (fs_handle_truncate(_handle, 0)) {
+			PERROR("Failed to truncate prepared stream file \"%s\"", _path.c_str());
+			goto end;
+		}
+
+		handle = _handle;
+		_handle = nullptr;
+		_created = false;
+	end:
+		_release();
+		return handle;
+	}
+
+	void discard() noexcept
+	{
+		const std::lock_guard<std::mutex> lock(_lock);
+
+		_canceled = true;
+		_release();
+	}
+
+private:
+	/*
+	 * Close the file if it was not taken and remove it if it was created
+	 * by the preparation to not leave an empty tracefile behind.
+	 *
+	 * The request's lock must be held, unless it is being destroyed.
+	 */
+	void _release() noexcept
+	{
+		if (!_chunk) {
+			return;
+		}
+
+		if (_handle && fs_handle_close(_handle)) {
+			ERR("Failed to close prepared stream file \"%s\"", _path.c_str());
+		}
+
+		_handle = nullptr;
+		if (_created && lttng_trace_chunk_unlink_file(_chunk, _path.c_str())) {
+			ERR("Failed to remove unused prepared stream file \"%s\"", _path.c_str());
+		}
+
+		_created = false;
+		lttng_trace_chunk_put(_chunk);
+		_chunk = nullptr;
+	}
+
+	std::mutex _lock;
+	lttng_trace_chunk *_chunk;
+	const std::string _path;
+	const uint64_t _tracefile_index;
+	const mode_t _mode;
+
+	/* Protected by _lock. */
+	bool _canceled = false;
+	bool _created = false;
+	fs_handle *_handle = nullptr;
+};
+
+/* Requests waiting to be handled by the preparation thread. */
+struct {
+	std::mutex lock;
+	std::condition_variable cond;
+	std::deque<std::shared_ptr<preparation_request>> pending;
+	std::thread thread;
+	bool stopped = false;
+} preparation_queue;
+
+void preparation_thread_run()
+{
+	rcu_register_thread();
+
+	while (true) {
+		std::shared_ptr<preparation_request> request;
+
+		{
+			std::unique_lock<std::mutex> lock(preparation_queue.lock);
+
+			preparation_queue.cond.wait(lock, []() {
+				return preparation_queue.stopped ||
+					!preparation_queue.pending.empty();
+			});
+			if (preparation_queue.stopped) {
+				break;
+			}
+
+			request = std::move(preparation_queue.pending.front());
+			preparation_queue.pending.pop_front();
+		}
+
+		request->open();
+	}
+
+	rcu_unregister_thread();
+}
+} /* namespace */
+
+struct stream_file_preparation {
+	std::shared_ptr<preparation_request> request;
+};
+
+struct stream_file_preparation *stream_file_preparation_create(struct lttng_trace_chunk *chunk,
+							       const char *path,
+							       uint64_t tracefile_index,
+							       mode_t mode)
+{
+	stream_file_preparation *preparation = nullptr;
+
+	try {
+		const std::lock_guard<std::mutex> lock(preparation_queue.lock);
+
+		if (preparation_queue.stopped) {
+			return nullptr;
+		}
+
+		if (!preparation_queue.thread.joinable()) {
+			preparation_queue.thread = std::thread(preparation_thread_run);
+		}
+
+		preparation = new stream_file_preparation;
+		preparation->request = std::make_shared<preparation_request>(
+			chunk, path, tracefile_index, mode);
+		preparation_queue.pending.emplace_back(preparation->request);
+	} catch (const std::exception& ex) {
+		/* Not fatal: the rotation opens the file itself. */
+		DBG("Failed to start the preparation of stream file: path=`%s`, error=`%s`",
+		    path,
+		    ex.what());
+		delete preparation;
+		return nullptr;
+	}
+
+	preparation_queue.cond.notify_one();
+	return preparation;
+}
+
+struct fs_handle *stream_file_preparation_take(struct stream_file_preparation *preparation,
+					       const struct lttng_trace_chunk *chunk,
+					       uint64_t tracefile_index)
+{
+	fs_handle *handle;
+
+	LTTNG_ASSERT(preparation);
+
+	handle = preparation->request->take(chunk, tracefile_index);
+	delete preparation;
+	return handle;
+}
+
+void stream_file_preparation_destroy(struct stream_file_preparation *preparation)
+{
+	if (!preparation) {
+		return;
+	}
+
+	preparation->request->discard();
+	delete preparation;
+}
+
+void stream_file_preparation_stop()
+{
+	{
+		const std::lock_guard<std::mutex> lock(preparation_queue.lock);
+
+		preparation_queue.stopped = true;
+		preparation_queue.pending.clear();
+	}
+
+	preparation_queue.cond.notify_one();
+	if (preparation_queue.thread.joinable()) {
+		preparation_queue.thread.join();
+	}
+}
@@ -0,0 +1,65 @@
+#ifndef _STREAM_FILE_PREPARATION_H
+#define _STREAM_FILE_PREPARATION_H
+
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ */
+
+#include <inttypes.h>
+#include <sys/types.h>
+
+struct fs_handle;
+struct lttng_trace_chunk;
+
+/*
+ * Opens the data file of the next tracefile of a stream in the background,
+ * ahead of its next size-based tracefile rotation. The rotation then swaps
+ * the file handles rather than creating and opening the file on the data
+ * reception path.
+ *
+ * The files are opened through the trace chunk, and hence through the
+ * fd-tracker, by a dedicated thread.
+ */
+struct stream_file_preparation;
+
+/*
+ * Start opening `path` within `chunk` in the background. The file is created
+ * if it doesn't exist, but is not truncated.
+ *
+ * Returns nullptr if the preparation can't be started: the rotation then
+ * opens the file itself.
+ */
+struct stream_file_preparation *stream_file_preparation_create(struct lttng_trace_chunk *chunk,
+							       const char *path,
+							       uint64_t tracefile_index,
+							       mode_t mode);
+
+/*
+ * Take the file prepared for tracefile `tracefile_index` within `chunk`,
+ * truncated, and destroy the preparation.
+ *
+ * Only waits if the file is being opened. A preparation which didn't start
+ * yet is canceled and nothing is taken.
+ *
+ * Returns nullptr if no such file is prepared: the caller must open it.
+ */
+struct fs_handle *stream_file_preparation_take(struct stream_file_preparation *preparation,
+					       const struct lttng_trace_chunk *chunk,
+					       uint64_t tracefile_index);
+
+/*
+ * Close the prepared file, removing it if it was created by the
+ * preparation, and destroy the preparation.
+ */
+void stream_file_preparation_destroy(struct stream_file_preparation *preparation);
+
+/*
+ * Stop the thread opening the prepared files. The preparations created
+ * afterwards are never started.
+ */
+void stream_file_preparation_stop();
+
+#endif /* _STREAM_FILE_PREPARATION_H */
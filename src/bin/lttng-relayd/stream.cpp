@@ -10,7 +10,9 @@
 
 #define _LGPL_SOURCE
 #include "index.hpp"
+#include "live-session-list.hpp"
 #include "lttng-relayd.hpp"
+#include "stream-file-preparation.hpp"
 #include "stream.hpp"
 #include "viewer-stream.hpp"
 
@@ -28,6 +30,7 @@
 #include <urcu/rculist.h>
 
 #define FILE_IO_STACK_BUFFER_SIZE 65536
+#define STREAM_FILE_MODE	  (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP)
 
 /* Should be called with RCU read-side lock held. */
 bool stream_get(struct relay_stream *stream)
@@ -85,7 +88,6 @@ static int stream_create_data_output_file_from_trace_chunk(struct relay_stream *
 	char stream_path[LTTNG_PATH_MAX];
 	enum lttng_trace_chunk_status status;
 	const int flags = O_RDWR | O_CREAT | O_TRUNC;
-	const mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP;
 
 	ASSERT_LOCKED(stream->lock);
 
@@ -125,7 +127,7 @@ static int stream_create_data_output_file_from_trace_chunk(struct relay_stream *
 	}
 
 	status = lttng_trace_chunk_open_fs_handle(
-		trace_chunk, stream_path, flags, mode, out_file, false);
+		trace_chunk, stream_path, flags, STREAM_FILE_MODE, out_file, false);
 	if (status != LTTNG_TRACE_CHUNK_STATUS_OK) {
 		ERR("Failed to open stream file \"%s\"", stream->channel_name);
 		ret = -1;
@@ -135,6 +137,80 @@ end:
 	return ret;
 }
 
+/* Close the data file prepared for the next tracefile, if any. */
+static void stream_discard_next_data_file(struct relay_stream *stream)
+{
+	ASSERT_LOCKED(stream->lock);
+
+	stream_file_preparation_destroy(stream->next_file);
+	stream->next_file = nullptr;
+}
+
+/*
+ * Start opening the data file of the next tracefile in the current trace
+ * chunk, ahead of the next size-based tracefile rotation.
+ *
+ * The tracefiles replacing existing ones, once the tracefiles wrapped around,
+ * are not prepared: live viewers may read the replaced file until the
+ * rotation unlinks it.
+ */
+static void stream_prepare_next_data_file(struct relay_stream *stream)
+{
+	int ret;
+	uint64_t next_tracefile_index;
+	char stream_path[LTTNG_PATH_MAX];
+
+	stream_discard_next_data_file(stream);
+
+	if (stream->tracefile_size == 0 || stream->tracefile_wrapped_around ||
+	    !stream->trace_chunk) {
+		return;
+	}
+
+	next_tracefile_index = stream->tracefile_current_index + 1;
+	if (stream->tracefile_count > 0) {
+		next_tracefile_index %= stream->tracefile_count;
+	}
+
+	if (next_tracefile_index <= stream->tracefile_current_index) {
+		return;
+	}
+
+	ret = utils_stream_file_path(stream->path_name,
+				     stream->channel_name,
+				     stream->tracefile_size,
+				     next_tracefile_index,
+				     nullptr,
+				     stream_path,
+				     sizeof(stream_path));
+	if (ret < 0) {
+		return;
+	}
+
+	stream->next_file = stream_file_preparation_create(
+		stream->trace_chunk, stream_path, next_tracefile_index, STREAM_FILE_MODE);
+}
+
+/*
+ * Take the data file prepared for the current tracefile. Returns nullptr if
+ * it was not prepared.
+ */
+static struct fs_handle *stream_take_next_data_file(struct relay_stream *stream)
+{
+	struct fs_handle *file;
+
+	ASSERT_LOCKED(stream->lock);
+
+	if (!stream->next_file) {
+		return nullptr;
+	}
+
+	file = stream_file_preparation_take(
+		stream->next_file, stream->trace_chunk, stream->tracefile_current_index);
+	stream->next_file = nullptr;
+	return file;
+}
+
 static int stream_rotate_data_file(struct relay_stream *stream)
 {
 	int ret = 0;
@@ -148,6 +224,9 @@ static int stream_rotate_data_file(struct relay_stream *stream)
 		stream->file = nullptr;
 	}
 
+	/* The next tracefile is only prepared within the current trace chunk. */
+	stream_discard_next_data_file(stream);
+
 	stream->tracefile_wrapped_around = false;
 	stream->tracefile_current_index = 0;
 
@@ -559,6 +638,11 @@ static int stream_set_trace_chunk(struct relay_stream *stream, struct lttng_trac
 		stream->file = nullptr;
 	}
 	ret = stream_create_data_output_file_from_trace_chunk(stream, chunk, false, &stream->file);
+	if (ret) {
+		goto end;
+	}
+
+	stream_prepare_next_data_file(stream);
 end:
 	return ret;
 }
@@ -614,9 +698,9 @@ struct relay_stream *stream_create(struct ctf_trace *trace,
 		goto end;
 	}
 
-	stream->indexes_ht = lttng_ht_new(0, LTTNG_HT_TYPE_U64);
-	if (!stream->indexes_ht) {
-		ERR("Cannot created indexes_ht");
+	stream->indexes = relay_index_table_create();
+	if (!stream->indexes) {
+		ERR("Cannot create index table");
 		ret = -1;
 		goto end;
 	}
@@ -647,6 +731,7 @@ struct relay_stream *stream_create(struct ctf_trace *trace,
 	pthread_mutex_lock(&session->recv_list_lock);
 	cds_list_add_rcu(&stream->recv_node, &session->recv_list);
 	session->stream_count++;
+	live_session_list_set_stream_count(session->id, session->stream_count);
 	pthread_mutex_unlock(&session->recv_list_lock);
 
 	/*
@@ -667,6 +752,8 @@ end:
 			fs_handle_close(stream->file);
 			stream->file = nullptr;
 		}
+		stream_file_preparation_destroy(stream->next_file);
+		stream->next_file = nullptr;
 		stream_put(stream);
 		stream = nullptr;
 	}
@@ -740,14 +827,8 @@ static void stream_unpublish(struct relay_stream *stream)
 
 static void stream_destroy(struct relay_stream *stream)
 {
-	if (stream->indexes_ht) {
-		/*
-		 * Calling lttng_ht_destroy in call_rcu worker thread so
-		 * we don't hold the RCU read-side lock while calling
-		 * it.
-		 */
-		lttng_ht_destroy(stream->indexes_ht);
-	}
+	/* All the indexes of the stream, which hold a reference to it, are released. */
+	relay_index_table_destroy(stream->indexes);
 	if (stream->tfa) {
 		tracefile_array_destroy(stream->tfa);
 	}
@@ -778,6 +859,7 @@ static void stream_release(struct urcu_ref *ref)
 
 	pthread_mutex_lock(&session->recv_list_lock);
 	session->stream_count--;
+	live_session_list_set_stream_count(session->id, session->stream_count);
 	if (stream->in_recv_list) {
 		cds_list_del_rcu(&stream->recv_node);
 		stream->in_recv_list = false;
@@ -790,6 +872,8 @@ static void stream_release(struct urcu_ref *ref)
 		fs_handle_close(stream->file);
 		stream->file = nullptr;
 	}
+	stream_file_preparation_destroy(stream->next_file);
+	stream->next_file = nullptr;
 	if (stream->index_file) {
 		lttng_index_file_put(stream->index_file);
 		stream->index_file = nullptr;
@@ -973,6 +1057,7 @@ void try_stream_close(struct relay_stream *stream)
 		fs_handle_close(stream->file);
 		stream->file = nullptr;
 	}
+	stream_discard_next_data_file(stream);
 	if (stream->index_file) {
 		lttng_index_file_put(stream->index_file);
 		stream->index_file = nullptr;
@@ -1030,14 +1115,20 @@ int stream_init_packet(struct relay_stream *stream, size_t packet_size, bool *fi
 			fs_handle_close(stream->file);
 			stream->file = nullptr;
 		}
-		ret = stream_create_data_output_file_from_trace_chunk(
-			stream, stream->trace_chunk, false, &stream->file);
-		if (ret) {
-			ERR("Failed to perform trace file rotation of stream %" PRIu64,
-			    stream->stream_handle);
-			goto end;
+
+		stream->file = stream_take_next_data_file(stream);
+		if (!stream->file) {
+			ret = stream_create_data_output_file_from_trace_chunk(
+				stream, stream->trace_chunk, false, &stream->file);
+			if (ret) {
+				ERR("Failed to perform trace file rotation of stream %" PRIu64,
+				    stream->stream_handle);
+				goto end;
+			}
 		}
 
+		stream_prepare_next_data_file(stream);
+
 		/*
 		 * Reset current size because we just performed a stream
 		 * rotation.
@@ -1246,8 +1337,21 @@ int stream_add_index(struct relay_stream *stream, const struct lttcomm_relayd_in
 		/*
 		 * Only flag a stream inactive when it has already
 		 * received data and no indexes are in flight.
+		 *
+		 * Consumers send batched beacons without holding the
+		 * stream's lock: a beacon sampled before the stream's
+		 * latest packet may be received after its index and no
+		 * longer describes the end of the stream's data.
 		 */
-		if (stream->index_received_seqcount > 0 && stream->indexes_in_flight == 0) {
+		if (stream->prev_index_seq != -1ULL &&
+		    index_info->net_seq_num < stream->prev_index_seq) {
+			DBG("Ignoring stale live beacon for stream %" PRIu64
+			    " (beacon net seq num = %" PRIu64 ", prev index seq = %" PRIu64 ")",
+			    stream->stream_handle,
+			    index_info->net_seq_num,
+			    stream->prev_index_seq);
+		} else if (stream->index_received_seqcount > 0 &&
+			   stream->indexes_in_flight == 0) {
 			stream->beacon_ts_end = index_info->timestamp_end;
 		}
 		ret = 0;
@@ -1308,25 +1412,17 @@ end:
 
 static void print_stream_indexes(struct relay_stream *stream)
 {
-	for (auto *index :
-	     lttng::urcu::lfht_iteration_adapter<relay_index,
-						 decltype(relay_index::index_n),
-						 &relay_index::index_n>(*stream->indexes_ht->ht)) {
-		DBG("index %p net_seq_num %" PRIu64 " refcount %ld"
-		    " stream %" PRIu64 " trace %" PRIu64 " session %" PRIu64,
-		    index,
-		    index->index_n.key,
-		    stream->ref.refcount,
-		    index->stream->stream_handle,
-		    index->stream->trace->id,
-		    index->stream->trace->session->id);
-	}
+	pthread_mutex_lock(&stream->lock);
+	relay_index_print_all(stream);
+	pthread_mutex_unlock(&stream->lock);
 }
 
 int stream_reset_file(struct relay_stream *stream)
 {
 	ASSERT_LOCKED(stream->lock);
 
+	stream_discard_next_data_file(stream);
+
 	if (stream->file) {
 		int ret;
 
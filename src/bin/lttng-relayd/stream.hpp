@@ -24,6 +24,8 @@
 #include <urcu/list.h>
 
 struct lttcomm_relayd_index;
+struct relay_index_table;
+struct stream_file_preparation;
 
 struct relay_stream_rotation {
 	/*
@@ -68,6 +70,11 @@ struct relay_stream {
 	uint64_t last_net_seq_num;
 
 	struct fs_handle *file;
+	/*
+	 * Data file of the next tracefile, opened in the background ahead of
+	 * the next size-based tracefile rotation. Protected by the stream lock.
+	 */
+	struct stream_file_preparation *next_file;
 	/* index file on which to write the index data. */
 	struct lttng_index_file *index_file;
 
@@ -121,11 +128,12 @@ struct relay_stream {
 	bool close_requested; /* Close command has been received. */
 
 	/*
-	 * Counts number of indexes in indexes_ht. Redundant info.
+	 * Counts number of indexes in the index table. Redundant info.
 	 * Protected by stream lock.
 	 */
 	int indexes_in_flight;
-	struct lttng_ht *indexes_ht;
+	/* Protected by stream lock. */
+	struct relay_index_table *indexes;
 
 	/*
 	 * If the stream is inactive, this field is updated with the
@@ -9,6 +9,7 @@
 
 #define _LGPL_SOURCE
 #include "ctf-trace.hpp"
+#include "live-session-list.hpp"
 #include "live.hpp"
 #include "lttng-relayd.hpp"
 #include "session.hpp"
@@ -90,6 +91,7 @@ enum lttng_viewer_attach_return_code viewer_session_attach(struct relay_viewer_s
 		int ret;
 
 		session->viewer_attached = true;
+		live_session_list_set_viewer_attached(session->id, true);
 
 		ret = viewer_session_set_trace_chunk_copy(vsession, session->current_trace_chunk);
 		if (ret) {
@@ -166,6 +168,7 @@ static int viewer_session_detach(struct relay_viewer_session *vsession,
 		ret = -1;
 	} else {
 		session->viewer_attached = false;
+		live_session_list_set_viewer_attached(session->id, false);
 	}
 
 	if (!ret) {
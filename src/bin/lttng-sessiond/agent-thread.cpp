@@ -33,6 +33,7 @@ struct thread_notifiers {
 struct agent_app_id {
 	pid_t pid;
 	enum lttng_domain_type domain;
+	unsigned int protocol_minor_version;
 };
 
 struct agent_protocol_version {
@@ -228,13 +229,14 @@ static const char *domain_type_str(enum lttng_domain_type domain_type)
 static bool is_agent_protocol_version_supported(const struct agent_protocol_version *version)
 {
 	const bool is_supported = version->major == AGENT_MAJOR_VERSION &&
-		version->minor == AGENT_MINOR_VERSION;
+		version->minor <= AGENT_MINOR_VERSION;
 
 	if (!is_supported) {
-		WARN("Refusing agent connection: unsupported protocol version %ui.%ui, expected %i.%i",
+		WARN("Refusing agent connection: unsupported protocol version %ui.%ui, expected %i.0 to %i.%i",
 		     version->major,
 		     version->minor,
 		     AGENT_MAJOR_VERSION,
+		     AGENT_MAJOR_VERSION,
 		     AGENT_MINOR_VERSION);
 	}
 
@@ -295,11 +297,14 @@ static int accept_agent_connection(struct lttcomm_sock *reg_sock,
 	*agent_app_id = (struct agent_app_id){
 		.pid = (pid_t) be32toh(msg.pid),
 		.domain = (lttng_domain_type) be32toh(msg.domain),
+		.protocol_minor_version = agent_version.minor,
 	};
 
-	DBG2("New registration for agent application: pid = %ld, domain = %s, socket fd = %d",
+	DBG2("New registration for agent application: pid = %ld, domain = %s, protocol version = %u.%u, socket fd = %d",
 	     (long) agent_app_id->pid,
 	     domain_type_str(agent_app_id->domain),
+	     agent_version.major,
+	     agent_version.minor,
 	     new_sock->fd);
 
 	*agent_app_socket = new_sock;
@@ -458,8 +463,10 @@ static void *thread_agent_management(void *data)
 				 * new_app_socket's ownership has been
 				 * transferred to the new agent app.
 				 */
-				new_app = agent_create_app(
-					new_app_id.pid, new_app_id.domain, new_app_socket);
+				new_app = agent_create_app(new_app_id.pid,
+							   new_app_id.domain,
+							   new_app_id.protocol_minor_version,
+							   new_app_socket);
 				if (!new_app) {
 					new_app_socket->ops->close(new_app_socket);
 					continue;
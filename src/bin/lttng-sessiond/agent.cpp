@@ -30,6 +30,7 @@
 
 #include <urcu/rculist.h>
 #include <urcu/uatomic.h>
+#include <vector>
 
 using event_rule_logging_get_name_pattern =
 	enum lttng_event_rule_status (*)(const struct lttng_event_rule *, const char **);
@@ -385,136 +386,208 @@ error:
 }
 
 /*
- * Internal enable agent event on a agent application. This function
- * communicates with the agent to enable a given event.
+ * Receive the generic reply to a single-entry command from an agent
+ * application.
  *
- * Return LTTNG_OK on success or else a LTTNG_ERR* code.
+ * Return LTTNG_OK on success or else a LTTNG_ERR* code. `io_error` is returned
+ * on communication errors and `unknown_name_error` when the agent reports an
+ * unknown name.
  */
-static int enable_event(const struct agent_app *app, struct agent_event *event)
+static int recv_generic_reply(const struct agent_app *app,
+			      enum lttng_error_code unknown_name_error,
+			      enum lttng_error_code io_error)
 {
 	int ret;
-	char *bytes_to_send;
-	uint64_t data_size;
-	size_t filter_expression_length;
 	uint32_t reply_ret_code;
-	struct lttcomm_agent_enable_event msg;
 	struct lttcomm_agent_generic_reply reply;
 
-	LTTNG_ASSERT(app);
-	LTTNG_ASSERT(app->sock);
-	LTTNG_ASSERT(event);
+	ret = recv_reply(app->sock, &reply, sizeof(reply));
+	if (ret < 0) {
+		return io_error;
+	}
 
-	DBG2("Agent enabling event %s for app pid: %d and socket %d",
-	     event->name,
-	     app->pid,
-	     app->sock->fd);
+	reply_ret_code = be32toh(reply.ret_code);
+	log_reply_code(reply_ret_code);
+	switch (reply_ret_code) {
+	case AGENT_RET_CODE_SUCCESS:
+		return LTTNG_OK;
+	case AGENT_RET_CODE_UNKNOWN_NAME:
+		return unknown_name_error;
+	default:
+		return LTTNG_ERR_UNK;
+	}
+}
+
+/*
+ * Append the enable command payload of an event to `payload`: the fixed-size
+ * struct followed by the variable-length filter expression (+1 for the ending
+ * \0).
+ *
+ * Return LTTNG_OK on success or else a LTTNG_ERR* code.
+ */
+static int append_enable_event_payload(struct lttng_dynamic_buffer *payload,
+				       const struct agent_event *event)
+{
+	size_t filter_expression_length;
+	struct lttcomm_agent_enable_event msg;
 
-	/*
-	 * Calculate the payload's size, which is the fixed-size struct followed
-	 * by the variable-length filter expression (+1 for the ending \0).
-	 */
 	if (!event->filter_expression) {
 		filter_expression_length = 0;
 	} else {
 		filter_expression_length = strlen(event->filter_expression) + 1;
 	}
-	data_size = sizeof(msg) + filter_expression_length;
 
 	memset(&msg, 0, sizeof(msg));
 	msg.loglevel_value = htobe32(event->loglevel_value);
 	msg.loglevel_type = htobe32(event->loglevel_type);
 	if (lttng_strncpy(msg.name, event->name, sizeof(msg.name))) {
-		ret = LTTNG_ERR_INVALID;
-		goto error;
+		return LTTNG_ERR_INVALID;
 	}
 	msg.filter_expression_length = htobe32(filter_expression_length);
 
-	ret = send_header(app->sock, data_size, AGENT_CMD_ENABLE, 0);
-	if (ret < 0) {
-		goto error_io;
+	if (lttng_dynamic_buffer_append(payload, &msg, sizeof(msg))) {
+		return LTTNG_ERR_NOMEM;
 	}
 
-	bytes_to_send = calloc<char>(data_size);
-	if (!bytes_to_send) {
-		ret = LTTNG_ERR_NOMEM;
-		goto error;
+	if (filter_expression_length > 0 &&
+	    lttng_dynamic_buffer_append(
+		    payload, event->filter_expression, filter_expression_length)) {
+		return LTTNG_ERR_NOMEM;
 	}
 
-	memcpy(bytes_to_send, &msg, sizeof(msg));
-	if (filter_expression_length > 0) {
-		memcpy(bytes_to_send + sizeof(msg),
-		       event->filter_expression,
-		       filter_expression_length);
+	return LTTNG_OK;
+}
+
+/*
+ * Append a Pascal-style string to `payload`. Size is a 32-bit big endian
+ * integer.
+ */
+static int append_pstring(struct lttng_dynamic_buffer *payload, const char *str, uint32_t len)
+{
+	const uint32_t len_be = htobe32(len);
+
+	if (lttng_dynamic_buffer_append(payload, &len_be, sizeof(len_be)) ||
+	    lttng_dynamic_buffer_append(payload, str, len)) {
+		return LTTNG_ERR_NOMEM;
 	}
 
-	ret = send_payload(app->sock, bytes_to_send, data_size);
-	free(bytes_to_send);
-	if (ret < 0) {
-		goto error_io;
+	return LTTNG_OK;
+}
+
+/*
+ * Append the payload of an application context command to `payload`. It
+ * consists of the size (u32, BE) of the provider name, the NULL-terminated
+ * provider name string, the size (u32, BE) of the context name, followed by
+ * the NULL-terminated context name string.
+ *
+ * Return LTTNG_OK on success or else a LTTNG_ERR* code.
+ */
+static int append_app_context_payload(struct lttng_dynamic_buffer *payload,
+				      const struct agent_app_ctx *ctx)
+{
+	int ret;
+	const size_t app_ctx_provider_name_len = strlen(ctx->provider_name) + 1;
+	const size_t app_ctx_name_len = strlen(ctx->ctx_name) + 1;
+
+	if (app_ctx_provider_name_len > UINT32_MAX || app_ctx_name_len > UINT32_MAX) {
+		ERR("Application context name > MAX_UINT32");
+		return LTTNG_ERR_INVALID;
 	}
 
-	ret = recv_reply(app->sock, &reply, sizeof(reply));
-	if (ret < 0) {
-		goto error_io;
+	ret = append_pstring(payload, ctx->provider_name, (uint32_t) app_ctx_provider_name_len);
+	if (ret != LTTNG_OK) {
+		return ret;
 	}
 
-	reply_ret_code = be32toh(reply.ret_code);
-	log_reply_code(reply_ret_code);
-	switch (reply_ret_code) {
-	case AGENT_RET_CODE_SUCCESS:
-		break;
-	case AGENT_RET_CODE_UNKNOWN_NAME:
-		ret = LTTNG_ERR_UST_EVENT_NOT_FOUND;
-		goto error;
-	default:
-		ret = LTTNG_ERR_UNK;
-		goto error;
+	return append_pstring(payload, ctx->ctx_name, (uint32_t) app_ctx_name_len);
+}
+
+/*
+ * Send a command header and its payload to an agent application.
+ *
+ * Return LTTNG_OK on success or else `io_error`.
+ */
+static int send_command(const struct agent_app *app,
+			enum lttcomm_agent_command cmd,
+			const struct lttng_dynamic_buffer *payload,
+			enum lttng_error_code io_error)
+{
+	int ret;
+
+	ret = send_header(app->sock, payload->size, cmd, 0);
+	if (ret < 0) {
+		return io_error;
 	}
 
-	return LTTNG_OK;
+	if (payload->size == 0) {
+		return LTTNG_OK;
+	}
 
-error_io:
-	ret = LTTNG_ERR_UST_ENABLE_FAIL;
-error:
-	return ret;
+	ret = send_payload(app->sock, payload->data, payload->size);
+	return ret < 0 ? io_error : LTTNG_OK;
 }
 
 /*
- * Send Pascal-style string. Size is sent as a 32-bit big endian integer.
+ * Send the command enabling a given event to an agent application without
+ * waiting for its reply.
+ *
+ * Return LTTNG_OK on success or else a LTTNG_ERR* code.
  */
-static int send_pstring(struct lttcomm_sock *sock, const char *str, uint32_t len)
+static int send_enable_event(const struct agent_app *app, const struct agent_event *event)
 {
 	int ret;
-	uint32_t len_be;
+	struct lttng_dynamic_buffer payload;
 
-	len_be = htobe32(len);
-	ret = send_payload(sock, &len_be, sizeof(len_be));
-	if (ret) {
-		goto end;
-	}
+	LTTNG_ASSERT(app);
+	LTTNG_ASSERT(app->sock);
+	LTTNG_ASSERT(event);
+
+	DBG2("Agent enabling event %s for app pid: %d and socket %d",
+	     event->name,
+	     app->pid,
+	     app->sock->fd);
 
-	ret = send_payload(sock, str, len);
-	if (ret) {
+	lttng_dynamic_buffer_init(&payload);
+	ret = append_enable_event_payload(&payload, event);
+	if (ret != LTTNG_OK) {
 		goto end;
 	}
+
+	ret = send_command(app, AGENT_CMD_ENABLE, &payload, LTTNG_ERR_UST_ENABLE_FAIL);
 end:
+	lttng_dynamic_buffer_reset(&payload);
 	return ret;
 }
 
 /*
- * Internal enable application context on an agent application. This function
- * communicates with the agent to enable a given application context.
+ * Internal enable agent event on a agent application. This function
+ * communicates with the agent to enable a given event.
  *
  * Return LTTNG_OK on success or else a LTTNG_ERR* code.
  */
-static int app_context_op(const struct agent_app *app,
-			  const struct agent_app_ctx *ctx,
-			  enum lttcomm_agent_command cmd)
+static int enable_event(const struct agent_app *app, const struct agent_event *event)
+{
+	const int ret = send_enable_event(app, event);
+
+	if (ret != LTTNG_OK) {
+		return ret;
+	}
+
+	return recv_generic_reply(app, LTTNG_ERR_UST_EVENT_NOT_FOUND, LTTNG_ERR_UST_ENABLE_FAIL);
+}
+
+/*
+ * Send the command enabling or disabling a given application context to an
+ * agent application without waiting for its reply.
+ *
+ * Return LTTNG_OK on success or else a LTTNG_ERR* code.
+ */
+static int send_app_context_op(const struct agent_app *app,
+			       const struct agent_app_ctx *ctx,
+			       enum lttcomm_agent_command cmd)
 {
 	int ret;
-	uint32_t reply_ret_code;
-	struct lttcomm_agent_generic_reply reply;
-	size_t app_ctx_provider_name_len, app_ctx_name_len, data_size;
+	struct lttng_dynamic_buffer payload;
 
 	LTTNG_ASSERT(app);
 	LTTNG_ASSERT(app->sock);
@@ -528,74 +601,48 @@ static int app_context_op(const struct agent_app *app,
 	     app->pid,
 	     app->sock->fd);
 
-	/*
-	 * Calculate the payload's size, which consists of the size (u32, BE)
-	 * of the provider name, the NULL-terminated provider name string, the
-	 * size (u32, BE) of the context name, followed by the NULL-terminated
-	 * context name string.
-	 */
-	app_ctx_provider_name_len = strlen(ctx->provider_name) + 1;
-	app_ctx_name_len = strlen(ctx->ctx_name) + 1;
-	data_size =
-		sizeof(uint32_t) + app_ctx_provider_name_len + sizeof(uint32_t) + app_ctx_name_len;
-
-	ret = send_header(app->sock, data_size, cmd, 0);
-	if (ret < 0) {
-		goto error_io;
-	}
-
-	if (app_ctx_provider_name_len > UINT32_MAX || app_ctx_name_len > UINT32_MAX) {
-		ERR("Application context name > MAX_UINT32");
-		ret = LTTNG_ERR_INVALID;
-		goto error;
-	}
-
-	ret = send_pstring(app->sock, ctx->provider_name, (uint32_t) app_ctx_provider_name_len);
-	if (ret < 0) {
-		goto error_io;
+	lttng_dynamic_buffer_init(&payload);
+	ret = append_app_context_payload(&payload, ctx);
+	if (ret != LTTNG_OK) {
+		goto end;
 	}
 
-	ret = send_pstring(app->sock, ctx->ctx_name, (uint32_t) app_ctx_name_len);
-	if (ret < 0) {
-		goto error_io;
-	}
+	ret = send_command(app, cmd, &payload, LTTNG_ERR_UST_ENABLE_FAIL);
+end:
+	lttng_dynamic_buffer_reset(&payload);
+	return ret;
+}
 
-	ret = recv_reply(app->sock, &reply, sizeof(reply));
-	if (ret < 0) {
-		goto error_io;
-	}
+/*
+ * Internal enable application context on an agent application. This function
+ * communicates with the agent to enable a given application context.
+ *
+ * Return LTTNG_OK on success or else a LTTNG_ERR* code.
+ */
+static int app_context_op(const struct agent_app *app,
+			  const struct agent_app_ctx *ctx,
+			  enum lttcomm_agent_command cmd)
+{
+	const int ret = send_app_context_op(app, ctx, cmd);
 
-	reply_ret_code = be32toh(reply.ret_code);
-	log_reply_code(reply_ret_code);
-	switch (reply_ret_code) {
-	case AGENT_RET_CODE_SUCCESS:
-		break;
-	default:
-		ret = LTTNG_ERR_UNK;
-		goto error;
+	if (ret != LTTNG_OK) {
+		return ret;
 	}
 
-	return LTTNG_OK;
-
-error_io:
-	ret = LTTNG_ERR_UST_ENABLE_FAIL;
-error:
-	return ret;
+	return recv_generic_reply(app, LTTNG_ERR_UNK, LTTNG_ERR_UST_ENABLE_FAIL);
 }
 
 /*
- * Internal disable agent event call on a agent application. This function
- * communicates with the agent to disable a given event.
+ * Send the command disabling a given event to an agent application without
+ * waiting for its reply.
  *
  * Return LTTNG_OK on success or else a LTTNG_ERR* code.
  */
-static int disable_event(struct agent_app *app, struct agent_event *event)
+static int send_disable_event(const struct agent_app *app, const struct agent_event *event)
 {
 	int ret;
-	uint64_t data_size;
-	uint32_t reply_ret_code;
 	struct lttcomm_agent_disable_event msg;
-	struct lttcomm_agent_generic_reply reply;
+	struct lttng_dynamic_buffer payload;
 
 	LTTNG_ASSERT(app);
 	LTTNG_ASSERT(app->sock);
@@ -606,47 +653,112 @@ static int disable_event(struct agent_app *app, struct agent_event *event)
 	     app->pid,
 	     app->sock->fd);
 
-	data_size = sizeof(msg);
 	memset(&msg, 0, sizeof(msg));
 	if (lttng_strncpy(msg.name, event->name, sizeof(msg.name))) {
-		ret = LTTNG_ERR_INVALID;
-		goto error;
+		return LTTNG_ERR_INVALID;
 	}
 
-	ret = send_header(app->sock, data_size, AGENT_CMD_DISABLE, 0);
-	if (ret < 0) {
-		goto error_io;
+	lttng_dynamic_buffer_init(&payload);
+	if (lttng_dynamic_buffer_append(&payload, &msg, sizeof(msg))) {
+		ret = LTTNG_ERR_NOMEM;
+		goto end;
 	}
 
-	ret = send_payload(app->sock, &msg, sizeof(msg));
-	if (ret < 0) {
-		goto error_io;
+	ret = send_command(app, AGENT_CMD_DISABLE, &payload, LTTNG_ERR_UST_DISABLE_FAIL);
+end:
+	lttng_dynamic_buffer_reset(&payload);
+	return ret;
+}
+
+/*
+ * Send a bulk command made of `entry_count` entries, already serialized in
+ * `entries`, to an agent application without waiting for its reply.
+ *
+ * Return LTTNG_OK on success or else a LTTNG_ERR* code.
+ */
+static int send_bulk_command(const struct agent_app *app,
+			     enum lttcomm_agent_command cmd,
+			     uint32_t entry_count,
+			     const struct lttng_dynamic_buffer *entries)
+{
+	int ret;
+	struct lttng_dynamic_buffer payload;
+	struct lttcomm_agent_bulk_hdr bulk_hdr = {};
+
+	LTTNG_ASSERT(app->protocol_minor_version >= AGENT_BULK_COMMANDS_MINOR_VERSION);
+
+	DBG2("Agent sending bulk command %d with %" PRIu32
+	     " entries to app pid: %d and socket %d",
+	     (int) cmd,
+	     entry_count,
+	     app->pid,
+	     app->sock->fd);
+
+	bulk_hdr.entry_count = htobe32(entry_count);
+	lttng_dynamic_buffer_init(&payload);
+	if (lttng_dynamic_buffer_append(&payload, &bulk_hdr, sizeof(bulk_hdr)) ||
+	    lttng_dynamic_buffer_append_buffer(&payload, entries)) {
+		ret = LTTNG_ERR_NOMEM;
+		goto end;
 	}
 
-	ret = recv_reply(app->sock, &reply, sizeof(reply));
+	ret = send_command(app, cmd, &payload, LTTNG_ERR_UST_ENABLE_FAIL);
+end:
+	lttng_dynamic_buffer_reset(&payload);
+	return ret;
+}
+
+/*
+ * Receive the reply to a bulk command of `entry_count` entries. The return
+ * code of every entry is returned through `entry_ret_codes`.
+ *
+ * Return LTTNG_OK on success or else a LTTNG_ERR* code.
+ */
+static int recv_bulk_reply(const struct agent_app *app,
+			   uint32_t entry_count,
+			   std::vector<uint32_t>& entry_ret_codes)
+{
+	int ret;
+	uint32_t reply_ret_code;
+	struct lttcomm_agent_bulk_reply_hdr reply_hdr;
+
+	entry_ret_codes.clear();
+	ret = recv_reply(app->sock, &reply_hdr, sizeof(reply_hdr));
 	if (ret < 0) {
-		goto error_io;
+		return LTTNG_ERR_UST_ENABLE_FAIL;
 	}
 
-	reply_ret_code = be32toh(reply.ret_code);
+	reply_ret_code = be32toh(reply_hdr.ret_code);
 	log_reply_code(reply_ret_code);
-	switch (reply_ret_code) {
-	case AGENT_RET_CODE_SUCCESS:
-		break;
-	case AGENT_RET_CODE_UNKNOWN_NAME:
-		ret = LTTNG_ERR_UST_EVENT_NOT_FOUND;
-		goto error;
-	default:
-		ret = LTTNG_ERR_UNK;
-		goto error;
+	if (be32toh(reply_hdr.entry_count) != entry_count) {
+		ERR("Agent bulk reply entry count mismatch: expected = %" PRIu32
+		    ", received = %" PRIu32 ", app pid = %d",
+		    entry_count,
+		    be32toh(reply_hdr.entry_count),
+		    app->pid);
+		return LTTNG_ERR_UST_ENABLE_FAIL;
+	}
+
+	try {
+		entry_ret_codes.resize(entry_count);
+	} catch (const std::bad_alloc&) {
+		return LTTNG_ERR_NOMEM;
+	}
+
+	if (entry_count > 0) {
+		ret = recv_reply(app->sock,
+				 entry_ret_codes.data(),
+				 entry_count * sizeof(entry_ret_codes[0]));
+		if (ret < 0) {
+			return LTTNG_ERR_UST_ENABLE_FAIL;
+		}
 	}
 
-	return LTTNG_OK;
+	for (auto& entry_ret_code : entry_ret_codes) {
+		entry_ret_code = be32toh(entry_ret_code);
+	}
 
-error_io:
-	ret = LTTNG_ERR_UST_DISABLE_FAIL;
-error:
-	return ret;
+	return reply_ret_code == AGENT_RET_CODE_SUCCESS ? LTTNG_OK : LTTNG_ERR_UNK;
 }
 
 /*
@@ -665,16 +777,24 @@ int agent_send_registration_done(struct agent_app *app)
 }
 
 /*
- * Enable agent event on every agent applications registered with the session
- * daemon.
+ * Send a command to every agent application of a domain before collecting
+ * their replies so that the round trips to the agents overlap rather than
+ * add up.
  *
- * Return LTTNG_OK on success or else a LTTNG_ERR* code.
+ * Sending stops at the first error, but the replies to the commands already
+ * in flight are always consumed to keep the agent sockets in sync.
+ *
+ * Return LTTNG_OK on success or else the first LTTNG_ERR* code encountered.
  */
-int agent_enable_event(struct agent_event *event, enum lttng_domain_type domain)
+template <typename SendCommandFunctionType, typename RecvReplyFunctionType>
+static int broadcast_command(enum lttng_domain_type domain,
+			     SendCommandFunctionType send_command_function,
+			     RecvReplyFunctionType recv_reply_function)
 {
-	int ret;
-
-	LTTNG_ASSERT(event);
+	int ret = LTTNG_OK;
+	std::vector<const struct agent_app *> pending_apps;
+	/* Applications are reclaimed through call_rcu. */
+	const lttng::urcu::read_lock_guard read_lock;
 
 	for (auto *app : lttng::urcu::
 		     lfht_iteration_adapter<agent_app, decltype(agent_app::node), &agent_app::node>(
@@ -683,13 +803,56 @@ int agent_enable_event(struct agent_event *event, enum lttng_domain_type domain)
 			continue;
 		}
 
-		/* Enable event on agent application through TCP socket. */
-		ret = enable_event(app, event);
+		ret = send_command_function(app);
 		if (ret != LTTNG_OK) {
-			goto error;
+			break;
+		}
+
+		try {
+			pending_apps.push_back(app);
+		} catch (const std::bad_alloc&) {
+			/* Consume the reply right away to keep the socket in sync. */
+			(void) recv_reply_function(app);
+			ret = LTTNG_ERR_NOMEM;
+			break;
+		}
+	}
+
+	for (const auto *app : pending_apps) {
+		const int reply_ret = recv_reply_function(app);
+
+		if (reply_ret != LTTNG_OK && ret == LTTNG_OK) {
+			ret = reply_ret;
 		}
 	}
 
+	return ret;
+}
+
+/*
+ * Enable agent event on every agent applications registered with the session
+ * daemon.
+ *
+ * Return LTTNG_OK on success or else a LTTNG_ERR* code.
+ */
+int agent_enable_event(struct agent_event *event, enum lttng_domain_type domain)
+{
+	int ret;
+
+	LTTNG_ASSERT(event);
+
+	/* Enable event on agent applications through their TCP socket. */
+	ret = broadcast_command(
+		domain,
+		[event](const struct agent_app *app) { return send_enable_event(app, event); },
+		[](const struct agent_app *app) {
+			return recv_generic_reply(
+				app, LTTNG_ERR_UST_EVENT_NOT_FOUND, LTTNG_ERR_UST_ENABLE_FAIL);
+		});
+	if (ret != LTTNG_OK) {
+		goto error;
+	}
+
 	event->enabled_count++;
 	ret = LTTNG_OK;
 
@@ -737,6 +900,7 @@ end:
 int agent_enable_context(const struct lttng_event_context *ctx, enum lttng_domain_type domain)
 {
 	int ret;
+	struct agent_app_ctx *agent_ctx;
 
 	LTTNG_ASSERT(ctx);
 	if (ctx->ctx != LTTNG_EVENT_CONTEXT_APP_CONTEXT) {
@@ -744,32 +908,23 @@ int agent_enable_context(const struct lttng_event_context *ctx, enum lttng_domai
 		goto error;
 	}
 
-	for (auto *app : lttng::urcu::
-		     lfht_iteration_adapter<agent_app, decltype(agent_app::node), &agent_app::node>(
-			     *the_agent_apps_ht_by_sock->ht)) {
-		struct agent_app_ctx *agent_ctx;
-
-		if (app->domain != domain) {
-			continue;
-		}
-
-		agent_ctx = create_app_ctx(ctx);
-		if (!agent_ctx) {
-			ret = LTTNG_ERR_NOMEM;
-			goto error_unlock;
-		}
-
-		/* Enable event on agent application through TCP socket. */
-		ret = app_context_op(app, agent_ctx, AGENT_CMD_APP_CTX_ENABLE);
-		destroy_app_ctx(agent_ctx);
-		if (ret != LTTNG_OK) {
-			goto error_unlock;
-		}
+	agent_ctx = create_app_ctx(ctx);
+	if (!agent_ctx) {
+		ret = LTTNG_ERR_NOMEM;
+		goto error;
 	}
 
-	ret = LTTNG_OK;
+	/* Enable context on agent applications through their TCP socket. */
+	ret = broadcast_command(
+		domain,
+		[agent_ctx](const struct agent_app *app) {
+			return send_app_context_op(app, agent_ctx, AGENT_CMD_APP_CTX_ENABLE);
+		},
+		[](const struct agent_app *app) {
+			return recv_generic_reply(app, LTTNG_ERR_UNK, LTTNG_ERR_UST_ENABLE_FAIL);
+		});
+	destroy_app_ctx(agent_ctx);
 
-error_unlock:
 error:
 	return ret;
 }
@@ -799,18 +954,16 @@ int agent_disable_event(struct agent_event *event, enum lttng_domain_type domain
 		goto end;
 	}
 
-	for (auto *app : lttng::urcu::
-		     lfht_iteration_adapter<agent_app, decltype(agent_app::node), &agent_app::node>(
-			     *the_agent_apps_ht_by_sock->ht)) {
-		if (app->domain != domain) {
-			continue;
-		}
-
-		/* Enable event on agent application through TCP socket. */
-		ret = disable_event(app, event);
-		if (ret != LTTNG_OK) {
-			goto error;
-		}
+	/* Disable event on agent applications through their TCP socket. */
+	ret = broadcast_command(
+		domain,
+		[event](const struct agent_app *app) { return send_disable_event(app, event); },
+		[](const struct agent_app *app) {
+			return recv_generic_reply(
+				app, LTTNG_ERR_UST_EVENT_NOT_FOUND, LTTNG_ERR_UST_DISABLE_FAIL);
+		});
+	if (ret != LTTNG_OK) {
+		goto error;
 	}
 
 	/* event->enabled_count is now 0. */
@@ -829,24 +982,19 @@ end:
  */
 static int disable_context(struct agent_app_ctx *ctx, enum lttng_domain_type domain)
 {
-	int ret = LTTNG_OK;
+	int ret;
 
 	LTTNG_ASSERT(ctx);
 	DBG2("Disabling agent application context %s:%s", ctx->provider_name, ctx->ctx_name);
 
-	for (auto *app : lttng::urcu::
-		     lfht_iteration_adapter<agent_app, decltype(agent_app::node), &agent_app::node>(
-			     *the_agent_apps_ht_by_sock->ht)) {
-		if (app->domain != domain) {
-			continue;
-		}
-
-		ret = app_context_op(app, ctx, AGENT_CMD_APP_CTX_DISABLE);
-		if (ret != LTTNG_OK) {
-			goto end;
-		}
-	}
-end:
+	ret = broadcast_command(
+		domain,
+		[ctx](const struct agent_app *app) {
+			return send_app_context_op(app, ctx, AGENT_CMD_APP_CTX_DISABLE);
+		},
+		[](const struct agent_app *app) {
+			return recv_generic_reply(app, LTTNG_ERR_UNK, LTTNG_ERR_UST_ENABLE_FAIL);
+		});
 	return ret;
 }
 
@@ -935,8 +1083,10 @@ error:
  *
  * Return newly allocated object or else NULL on error.
  */
-struct agent_app *
-agent_create_app(pid_t pid, enum lttng_domain_type domain, struct lttcomm_sock *sock)
+struct agent_app *agent_create_app(pid_t pid,
+				   enum lttng_domain_type domain,
+				   unsigned int protocol_minor_version,
+				   struct lttcomm_sock *sock)
 {
 	struct agent_app *app;
 
@@ -950,6 +1100,7 @@ agent_create_app(pid_t pid, enum lttng_domain_type domain, struct lttcomm_sock *
 
 	app->pid = pid;
 	app->domain = domain;
+	app->protocol_minor_version = protocol_minor_version;
 	app->sock = sock;
 	lttng_ht_node_init_ulong(&app->node, (unsigned long) app->sock->fd);
 
@@ -1476,6 +1627,137 @@ void agent_app_ht_clean()
 	lttng_ht_destroy(the_agent_apps_ht_by_sock);
 }
 
+/*
+ * Update an agent application implementing the bulk commands. All the enabled
+ * events and the application contexts are sent in two pipelined bulk commands
+ * so that the whole configuration is reconciled in a single round trip.
+ *
+ * Return LTTNG_OK on success or else a LTTNG_ERR* code.
+ */
+static int update_bulk(const struct agent *agt, const struct agent_app *app)
+{
+	int ret = LTTNG_OK;
+	struct agent_app_ctx *ctx;
+	bool events_sent = false, contexts_sent = false;
+	std::vector<const struct agent_event *> events;
+	std::vector<const struct agent_app_ctx *> contexts;
+	std::vector<uint32_t> entry_ret_codes;
+	struct lttng_dynamic_buffer events_payload, contexts_payload;
+
+	lttng_dynamic_buffer_init(&events_payload);
+	lttng_dynamic_buffer_init(&contexts_payload);
+
+	for (auto *event :
+	     lttng::urcu::lfht_iteration_adapter<agent_event,
+						 decltype(agent_event::node),
+						 &agent_event::node>(*agt->events->ht)) {
+		/* Skip event if disabled. */
+		if (!AGENT_EVENT_IS_ENABLED(event)) {
+			continue;
+		}
+
+		ret = append_enable_event_payload(&events_payload, event);
+		if (ret != LTTNG_OK) {
+			DBG2("Agent update unable to serialize event %s for app pid: %d sock %d",
+			     event->name,
+			     app->pid,
+			     app->sock->fd);
+			goto end;
+		}
+
+		try {
+			events.push_back(event);
+		} catch (const std::bad_alloc&) {
+			ret = LTTNG_ERR_NOMEM;
+			goto end;
+		}
+	}
+
+	cds_list_for_each_entry_rcu(ctx, &agt->app_ctx_list, list_node)
+	{
+		ret = append_app_context_payload(&contexts_payload, ctx);
+		if (ret != LTTNG_OK) {
+			DBG2("Agent update unable to serialize application context %s:%s for app pid: %d sock %d",
+			     ctx->provider_name,
+			     ctx->ctx_name,
+			     app->pid,
+			     app->sock->fd);
+			goto end;
+		}
+
+		try {
+			contexts.push_back(ctx);
+		} catch (const std::bad_alloc&) {
+			ret = LTTNG_ERR_NOMEM;
+			goto end;
+		}
+	}
+
+	if (!events.empty()) {
+		ret = send_bulk_command(
+			app, AGENT_CMD_ENABLE_BULK, (uint32_t) events.size(), &events_payload);
+		events_sent = ret == LTTNG_OK;
+	}
+
+	if (!contexts.empty()) {
+		ret = send_bulk_command(app,
+					AGENT_CMD_APP_CTX_ENABLE_BULK,
+					(uint32_t) contexts.size(),
+					&contexts_payload);
+		contexts_sent = ret == LTTNG_OK;
+	}
+
+	/* Both commands are in flight; collect their replies in order. */
+	if (events_sent) {
+		ret = recv_bulk_reply(app, (uint32_t) events.size(), entry_ret_codes);
+		if (ret != LTTNG_OK && entry_ret_codes.size() != events.size()) {
+			DBG2("Agent update unable to enable events on app pid: %d sock %d",
+			     app->pid,
+			     app->sock->fd);
+			goto end;
+		}
+
+		for (size_t i = 0; i < events.size(); i++) {
+			if (entry_ret_codes[i] == AGENT_RET_CODE_SUCCESS) {
+				continue;
+			}
+
+			/* Failing entries don't prevent the others from being enabled. */
+			DBG2("Agent update unable to enable event %s on app pid: %d sock %d",
+			     events[i]->name,
+			     app->pid,
+			     app->sock->fd);
+		}
+	}
+
+	if (contexts_sent) {
+		ret = recv_bulk_reply(app, (uint32_t) contexts.size(), entry_ret_codes);
+		if (ret != LTTNG_OK && entry_ret_codes.size() != contexts.size()) {
+			DBG2("Agent update unable to add application contexts on app pid: %d sock %d",
+			     app->pid,
+			     app->sock->fd);
+			goto end;
+		}
+
+		for (size_t i = 0; i < contexts.size(); i++) {
+			if (entry_ret_codes[i] == AGENT_RET_CODE_SUCCESS) {
+				continue;
+			}
+
+			DBG2("Agent update unable to add application context %s:%s on app pid: %d sock %d",
+			     contexts[i]->provider_name,
+			     contexts[i]->ctx_name,
+			     app->pid,
+			     app->sock->fd);
+		}
+	}
+
+end:
+	lttng_dynamic_buffer_reset(&events_payload);
+	lttng_dynamic_buffer_reset(&contexts_payload);
+	return ret;
+}
+
 /*
  * Update a agent application (given socket) using the given agent.
  *
@@ -1492,6 +1774,18 @@ void agent_update(const struct agent *agt, const struct agent_app *app)
 
 	DBG("Agent updating app: pid = %ld", (long) app->pid);
 
+	if (app->protocol_minor_version >= AGENT_BULK_COMMANDS_MINOR_VERSION) {
+		ret = update_bulk(agt, app);
+		if (ret != LTTNG_OK) {
+			DBG2("Agent update unable to update app pid: %d sock %d: %s",
+			     app->pid,
+			     app->sock->fd,
+			     lttng_strerror(-ret));
+		}
+
+		return;
+	}
+
 	/*
 	 * We are in the registration path thus if the application is gone,
 	 * there is a serious code flow error.
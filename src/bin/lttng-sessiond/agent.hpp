@@ -16,9 +16,15 @@
 #include <inttypes.h>
 #include <urcu/urcu.h>
 
-/* Agent protocol version that is verified during the agent registration. */
+/*
+ * Agent protocol version that is verified during the agent registration.
+ * Agents implementing any minor version up to AGENT_MINOR_VERSION are accepted.
+ */
 #define AGENT_MAJOR_VERSION 2
-#define AGENT_MINOR_VERSION 0
+#define AGENT_MINOR_VERSION 1
+
+/* Minor protocol version from which agents understand the bulk commands. */
+#define AGENT_BULK_COMMANDS_MINOR_VERSION 1
 
 /*
  * Hash table that contains the agent app created upon registration indexed by
@@ -63,6 +69,9 @@ struct agent_app {
 	/* Domain of the application. */
 	enum lttng_domain_type domain;
 
+	/* Minor version of the protocol implemented by the agent. */
+	unsigned int protocol_minor_version;
+
 	/*
 	 * AGENT TCP socket that was created upon registration.
 	 */
@@ -168,8 +177,10 @@ int agent_enable_context(const struct lttng_event_context *ctx, enum lttng_domai
 int agent_add_context(const struct lttng_event_context *ctx, struct agent *agt);
 
 /* Agent app API. */
-struct agent_app *
-agent_create_app(pid_t pid, enum lttng_domain_type domain, struct lttcomm_sock *sock);
+struct agent_app *agent_create_app(pid_t pid,
+				   enum lttng_domain_type domain,
+				   unsigned int protocol_minor_version,
+				   struct lttcomm_sock *sock);
 void agent_add_app(struct agent_app *app);
 void agent_delete_app(struct agent_app *app);
 struct agent_app *agent_find_app_by_sock(int sock);
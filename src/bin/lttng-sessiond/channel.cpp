@@ -306,11 +306,12 @@ enum lttng_error_code channel_ust_enable(struct ltt_ust_session *usess,
 		DBG2("Channel %s enabled successfully", uchan->name);
 	}
 
-	if (!usess->active) {
+	if (!usess->active || ust_app_defer_session_update(usess)) {
 		/*
 		 * The channel will be activated against the apps
-		 * when the session is started as part of the
-		 * application channel "synchronize" operation.
+		 * when the session is started, or when its pending
+		 * changes are applied, as part of the application
+		 * channel "synchronize" operation.
 		 */
 		goto end;
 	}
@@ -413,7 +414,11 @@ enum lttng_error_code channel_ust_create(struct ltt_ust_session *usess,
 		goto error;
 	}
 
-	if (attr->attr.output != LTTNG_EVENT_MMAP) {
+	/*
+	 * The tracer always maps the buffers; the consumer daemon either copies
+	 * the sub-buffers or vmsplices their pages.
+	 */
+	if (attr->attr.output != LTTNG_EVENT_MMAP && attr->attr.output != LTTNG_EVENT_SPLICE) {
 		ret_code = LTTNG_ERR_NOT_SUPPORTED;
 		goto error;
 	}
@@ -531,10 +536,10 @@ int channel_ust_disable(struct ltt_ust_session *usess, struct ltt_ust_channel *u
 	uchan->enabled = false;
 
 	/*
-	 * If session is inactive we don't notify the tracer right away. We
-	 * wait for the next synchronization.
+	 * If session is inactive, or if the changes are deferred, we don't
+	 * notify the tracer right away. We wait for the next synchronization.
 	 */
-	if (!usess->active) {
+	if (!usess->active || ust_app_defer_session_update(usess)) {
 		goto end;
 	}
 
@@ -584,7 +589,7 @@ struct lttng_channel *trace_ust_channel_to_lttng_channel(const struct ltt_ust_ch
 	 */
 	switch (uchan->attr.output) {
 	case LTTNG_UST_ABI_MMAP:
-		channel->attr.output = LTTNG_EVENT_MMAP;
+		channel->attr.output = uchan->splice_output ? LTTNG_EVENT_SPLICE : LTTNG_EVENT_MMAP;
 		break;
 	default:
 		/*
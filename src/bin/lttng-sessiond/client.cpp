@@ -30,6 +30,7 @@
 #include <common/fd-handle.hpp>
 #include <common/payload-view.hpp>
 #include <common/payload.hpp>
+#include <common/pipe.hpp>
 #include <common/pthread-lock.hpp>
 #include <common/scope-exit.hpp>
 #include <common/sessiond-comm/sessiond-comm.hpp>
@@ -45,16 +46,28 @@
 #include <lttng/session-internal.hpp>
 #include <lttng/userspace-probe-internal.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <fcntl.h>
+#include <memory>
+#include <mutex>
 #include <pthread.h>
 #include <signal.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string>
 #include <sys/stat.h>
+#include <thread>
 #include <unistd.h>
+#include <unordered_set>
+#include <vector>
 
 namespace ls = lttng::sessiond;
 
+#define CLIENT_MAX_WORKER_COUNT 64
+
 namespace {
 bool is_root;
 
@@ -63,6 +76,79 @@ struct thread_state {
 	bool running;
 	int client_sock;
 } thread_state;
+
+struct payload_deleter {
+	void operator()(lttng_payload *payload) const
+	{
+		lttng_payload_reset(payload);
+		delete payload;
+	}
+};
+
+/* A client command waiting to be processed by a worker. */
+struct client_command_job {
+	int sock = -1;
+	struct lttcomm_session_msg lsm;
+	lttng_sock_cred creds;
+	/*
+	 * Set for the commands of connections using the compact framing, which
+	 * are kept open once the command is processed.
+	 */
+	bool compact = false;
+	/*
+	 * Set for the jobs receiving the next command of a polled compact
+	 * connection, so as not to block the client thread on a stalled
+	 * client. The received command is then queued as a job of its own.
+	 */
+	bool receive = false;
+	/* Size of the payload and number of fds of a compact command. */
+	uint32_t payload_size = 0;
+	uint32_t fd_count = 0;
+	/* Payload of a compact command, received before its processing. */
+	std::unique_ptr<lttng_payload, payload_deleter> payload;
+	/*
+	 * Ordered commands sharing an ordering key are processed one at a
+	 * time, in the order in which they were received.
+	 */
+	bool ordered = true;
+	std::string ordering_key;
+	std::chrono::steady_clock::time_point enqueue_time;
+};
+
+struct client_worker_pool {
+	std::mutex lock;
+	std::condition_variable job_available;
+	std::deque<client_command_job> queue;
+	/* Ordering keys of the commands being processed by a worker. */
+	std::unordered_set<std::string> active_keys;
+	std::vector<std::thread> workers;
+	bool quit = false;
+	/*
+	 * Compact connections whose command was processed, handed back to the
+	 * client thread through `idle_connection_pipe` to receive their next
+	 * command.
+	 */
+	std::vector<int> idle_connections;
+	struct lttng_pipe *idle_connection_pipe = nullptr;
+} worker_pool;
+
+/* Sampled through the health socket; see client_get_command_metrics(). */
+struct client_command_stats {
+	std::atomic<unsigned int> worker_count{ 0 };
+	std::atomic<unsigned int> queued_count{ 0 };
+	std::atomic<unsigned int> active_count{ 0 };
+	std::atomic<uint64_t> completed_count{ 0 };
+	std::atomic<uint64_t> total_queue_wait_us{ 0 };
+	std::atomic<uint64_t> max_queue_wait_us{ 0 };
+	std::atomic<uint64_t> total_processing_us{ 0 };
+	std::atomic<uint64_t> max_processing_us{ 0 };
+} command_stats;
+
+/*
+ * Serializes the lazy initialization of the kernel tracer since read-only
+ * kernel domain commands can be processed concurrently with other commands.
+ */
+std::mutex kernel_tracer_init_lock;
 } /* namespace */
 
 static void set_thread_status(bool running)
@@ -583,19 +669,18 @@ error_create:
 /*
  * Count number of session permitted by uid/gid.
  */
-static unsigned int lttng_sessions_count(uid_t uid, gid_t gid __attribute__((unused)))
+static unsigned int lttng_sessions_count(const std::vector<ltt_session::ref>& session_refs,
+					 uid_t uid,
+					 gid_t gid __attribute__((unused)))
 {
 	unsigned int i = 0;
-	const struct ltt_session_list *session_list = session_get_list();
 
 	DBG("Counting number of available session for UID %d", uid);
-	for (auto *raw_session_ptr :
-	     lttng::urcu::list_iteration_adapter<ltt_session, &ltt_session::list>(
-		     session_list->head)) {
-		auto session = [raw_session_ptr]() {
-			session_get(raw_session_ptr);
-			raw_session_ptr->lock();
-			return ltt_session::make_locked_ref(*raw_session_ptr);
+	for (const auto& session_ref : session_refs) {
+		auto session = [&session_ref]() {
+			session_get(&session_ref.get());
+			session_ref->lock();
+			return ltt_session::make_locked_ref(session_ref.get());
 		}();
 
 		/* Only count the sessions the user can control. */
@@ -626,7 +711,8 @@ receive_lttng_trigger(struct command_ctx *cmd_ctx, int sock, int *sock_error)
 		LTTNG_THROW_CTL("Failed to allocate buffer for trigger receptio", LTTNG_ERR_NOMEM);
 	}
 
-	sock_recv_len = lttcomm_recv_unix_sock(sock, trigger_payload.buffer.data, trigger_len);
+	sock_recv_len =
+		command_ctx_recv_payload(cmd_ctx, sock, trigger_payload.buffer.data, trigger_len);
 	if (sock_recv_len < 0 || sock_recv_len != trigger_len) {
 		*sock_error = 1;
 		LTTNG_THROW_PROTOCOL_ERROR("Failed to receive trigger in command payload");
@@ -634,8 +720,8 @@ receive_lttng_trigger(struct command_ctx *cmd_ctx, int sock, int *sock_error)
 
 	/* Receive fds, if any. */
 	if (cmd_ctx->lsm.fd_count > 0) {
-		sock_recv_len = lttcomm_recv_payload_fds_unix_sock(
-			sock, cmd_ctx->lsm.fd_count, &trigger_payload);
+		sock_recv_len = command_ctx_recv_payload_fds(
+			cmd_ctx, sock, cmd_ctx->lsm.fd_count, &trigger_payload);
 		if (sock_recv_len > 0 && sock_recv_len != cmd_ctx->lsm.fd_count * sizeof(int)) {
 			*sock_error = 1;
 			LTTNG_THROW_PROTOCOL_ERROR(fmt::format(
@@ -692,7 +778,8 @@ static enum lttng_error_code receive_lttng_error_query(struct command_ctx *cmd_c
 		goto end;
 	}
 
-	sock_recv_len = lttcomm_recv_unix_sock(sock, query_payload.buffer.data, query_len);
+	sock_recv_len =
+		command_ctx_recv_payload(cmd_ctx, sock, query_payload.buffer.data, query_len);
 	if (sock_recv_len < 0 || sock_recv_len != query_len) {
 		ERR("Failed to receive error query in command payload");
 		*sock_error = 1;
@@ -702,8 +789,8 @@ static enum lttng_error_code receive_lttng_error_query(struct command_ctx *cmd_c
 
 	/* Receive fds, if any. */
 	if (cmd_ctx->lsm.fd_count > 0) {
-		sock_recv_len = lttcomm_recv_payload_fds_unix_sock(
-			sock, cmd_ctx->lsm.fd_count, &query_payload);
+		sock_recv_len = command_ctx_recv_payload_fds(
+			cmd_ctx, sock, cmd_ctx->lsm.fd_count, &query_payload);
 		if (sock_recv_len > 0 && sock_recv_len != cmd_ctx->lsm.fd_count * sizeof(int)) {
 			ERR("Failed to receive all file descriptors for error query in command payload: expected fd count = %u, ret = %d",
 			    cmd_ctx->lsm.fd_count,
@@ -775,7 +862,8 @@ static enum lttng_error_code receive_lttng_event(struct command_ctx *cmd_ctx,
 		goto end;
 	}
 
-	sock_recv_len = lttcomm_recv_unix_sock(sock, event_payload.buffer.data, event_len);
+	sock_recv_len =
+		command_ctx_recv_payload(cmd_ctx, sock, event_payload.buffer.data, event_len);
 	if (sock_recv_len < 0 || sock_recv_len != event_len) {
 		ERR("Failed to receive event in command payload");
 		*sock_error = 1;
@@ -785,8 +873,8 @@ static enum lttng_error_code receive_lttng_event(struct command_ctx *cmd_ctx,
 
 	/* Receive fds, if any. */
 	if (cmd_ctx->lsm.fd_count > 0) {
-		sock_recv_len = lttcomm_recv_payload_fds_unix_sock(
-			sock, cmd_ctx->lsm.fd_count, &event_payload);
+		sock_recv_len = command_ctx_recv_payload_fds(
+			cmd_ctx, sock, cmd_ctx->lsm.fd_count, &event_payload);
 		if (sock_recv_len > 0 && sock_recv_len != cmd_ctx->lsm.fd_count * sizeof(int)) {
 			ERR("Failed to receive all file descriptors for event in command payload: expected fd count = %u, ret = %d",
 			    cmd_ctx->lsm.fd_count,
@@ -869,7 +957,7 @@ end:
 }
 
 static enum lttng_error_code
-receive_lttng_event_context(const struct command_ctx *cmd_ctx,
+receive_lttng_event_context(struct command_ctx *cmd_ctx,
 			    int sock,
 			    int *sock_error,
 			    struct lttng_event_context **out_event_context)
@@ -889,8 +977,8 @@ receive_lttng_event_context(const struct command_ctx *cmd_ctx,
 		goto end;
 	}
 
-	sock_recv_len =
-		lttcomm_recv_unix_sock(sock, event_context_payload.buffer.data, event_context_len);
+	sock_recv_len = command_ctx_recv_payload(
+		cmd_ctx, sock, event_context_payload.buffer.data, event_context_len);
 	if (sock_recv_len < 0 || sock_recv_len != event_context_len) {
 		ERR("Failed to receive event context in command payload");
 		*sock_error = 1;
@@ -994,6 +1082,86 @@ static void command_ctx_set_status_code(command_ctx& cmd_ctx, enum lttng_error_c
 	((struct lttcomm_lttng_msg *) (cmd_ctx.reply_payload.buffer.data))->ret_code = status_code;
 }
 
+ssize_t command_ctx_recv_payload(struct command_ctx *cmd_ctx, int sock, void *buf, size_t len)
+{
+	if (!cmd_ctx->command_payload) {
+		return lttcomm_recv_unix_sock(sock, buf, len);
+	}
+
+	if (len > cmd_ctx->command_payload->buffer.size - cmd_ctx->command_payload_position) {
+		/* As if the client shut the connection down before the end of the payload. */
+		return 0;
+	}
+
+	memcpy(buf, cmd_ctx->command_payload->buffer.data + cmd_ctx->command_payload_position, len);
+	cmd_ctx->command_payload_position += len;
+	return len;
+}
+
+ssize_t command_ctx_recv_payload_fds(struct command_ctx *cmd_ctx,
+				     int sock,
+				     size_t nb_fd,
+				     struct lttng_payload *payload)
+{
+	if (!cmd_ctx->command_payload) {
+		return lttcomm_recv_payload_fds_unix_sock(sock, nb_fd, payload);
+	}
+
+	const size_t fd_count =
+		lttng_dynamic_pointer_array_get_count(&cmd_ctx->command_payload->_fd_handles);
+
+	if (nb_fd > fd_count - cmd_ctx->command_payload_fd_position) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < nb_fd; i++) {
+		auto *handle = (fd_handle *) lttng_dynamic_pointer_array_get_pointer(
+			&cmd_ctx->command_payload->_fd_handles,
+			cmd_ctx->command_payload_fd_position);
+
+		if (lttng_payload_push_fd_handle(payload, handle)) {
+			return -1;
+		}
+
+		cmd_ctx->command_payload_fd_position++;
+	}
+
+	return nb_fd * sizeof(int);
+}
+
+/*
+ * Commands which only query the state of the session daemon. They are
+ * dispatched as soon as a worker is available, regardless of the other
+ * commands of their target session, so that a long-running command
+ * (snapshot, rotation, destruction, etc.) doesn't delay them. They only
+ * hold the session list lock in shared mode.
+ */
+static bool command_is_read_only(const struct lttcomm_session_msg& lsm)
+{
+	switch (lsm.cmd_type) {
+	case LTTCOMM_SESSIOND_COMMAND_LIST_SYSCALLS:
+	case LTTCOMM_SESSIOND_COMMAND_LIST_CHANNELS:
+	case LTTCOMM_SESSIOND_COMMAND_LIST_DOMAINS:
+	case LTTCOMM_SESSIOND_COMMAND_LIST_EVENTS:
+	case LTTCOMM_SESSIOND_COMMAND_LIST_EVENTS_PAGE:
+	case LTTCOMM_SESSIOND_COMMAND_LIST_SESSIONS:
+	case LTTCOMM_SESSIOND_COMMAND_LIST_TRACEPOINTS:
+	case LTTCOMM_SESSIOND_COMMAND_LIST_TRACEPOINT_FIELDS:
+	case LTTCOMM_SESSIOND_COMMAND_DATA_PENDING:
+	case LTTCOMM_SESSIOND_COMMAND_SNAPSHOT_LIST_OUTPUT:
+	case LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_GET_POLICY:
+	case LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_GET_INCLUSION_SET:
+	case LTTCOMM_SESSIOND_COMMAND_ROTATION_GET_INFO:
+	case LTTCOMM_SESSIOND_COMMAND_SESSION_LIST_ROTATION_SCHEDULES:
+	case LTTCOMM_SESSIOND_COMMAND_LIST_TRIGGERS:
+	case LTTCOMM_SESSIOND_COMMAND_EXECUTE_ERROR_QUERY:
+	case LTTCOMM_SESSIOND_COMMAND_KERNEL_TRACER_STATUS:
+		return true;
+	default:
+		return false;
+	}
+}
+
 /*
  * Process the command requested by the lttng client within the command
  * context structure. This function make sure that the return structure (llm)
@@ -1103,10 +1271,13 @@ static int process_client_msg(struct command_ctx *cmd_ctx, int *sock, int *sock_
 	case LTTCOMM_SESSIOND_COMMAND_LIST_DOMAINS:
 	case LTTCOMM_SESSIOND_COMMAND_LIST_CHANNELS:
 	case LTTCOMM_SESSIOND_COMMAND_LIST_EVENTS:
+	case LTTCOMM_SESSIOND_COMMAND_LIST_EVENTS_PAGE:
 	case LTTCOMM_SESSIOND_COMMAND_LIST_SYSCALLS:
 	case LTTCOMM_SESSIOND_COMMAND_SESSION_LIST_ROTATION_SCHEDULES:
 	case LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_GET_POLICY:
 	case LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_GET_INCLUSION_SET:
+	case LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_ADD_INCLUDE_VALUES:
+	case LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_REMOVE_INCLUDE_VALUES:
 	case LTTCOMM_SESSIOND_COMMAND_DATA_PENDING:
 	case LTTCOMM_SESSIOND_COMMAND_ROTATE_SESSION:
 	case LTTCOMM_SESSIOND_COMMAND_ROTATION_GET_INFO:
@@ -1121,17 +1292,27 @@ static int process_client_msg(struct command_ctx *cmd_ctx, int *sock, int *sock_
 
 	/*
 	 * The list lock is only acquired when processing a command that is applied
-	 * against a session. As such, a unique_lock that holds the list lock is move()'d to
-	 * list_lock during the execution of those commands. The list lock is then released
-	 * as the instance leaves this scope.
+	 * against a session or that needs exclusive access to the session list. As
+	 * such, a lock that holds the list lock is move()'d to list_lock (exclusive
+	 * mode) or shared_list_lock (shared mode) during the execution of those
+	 * commands. The list lock is then released as the instance leaves this scope.
 	 *
-	 * Mind the order of the declaration of list_lock vs target_session:
+	 * Read-only commands applied against a session only hold the list lock in
+	 * shared mode: they run concurrently with each other and with session
+	 * listings. The commands that change the state of a session keep holding
+	 * the list lock exclusively since the command handlers (cmd_*) rely on it
+	 * to serialize them against the commands targeting other sessions and
+	 * against the threads that operate on multiple sessions (e.g. the rotation
+	 * thread or the dispatch thread).
+	 *
+	 * Mind the order of the declaration of the list locks vs target_session:
 	 * the session list lock must always be released _after_ the release of
 	 * a session's reference (the destruction of a ref/locked_ref) to ensure
 	 * since the reference's release may unpublish the session from the list of
 	 * sessions.
 	 */
-	std::unique_lock<std::mutex> list_lock;
+	std::unique_lock<lttng::pthread::rw_mutex> list_lock;
+	lttng::pthread::shared_lock shared_list_lock;
 	/*
 	 * A locked_ref is typically "never null" (hence its name). However, due to the
 	 * structure of this function, target_session remains unset for commands that don't
@@ -1163,11 +1344,15 @@ static int process_client_msg(struct command_ctx *cmd_ctx, int *sock, int *sock_
 
 		DBG("Getting session %s by name", cmd_ctx->lsm.session.name);
 		/*
-		 * We keep the session list lock across _all_ commands
-		 * for now, because the per-session lock does not
-		 * handle teardown properly.
+		 * The session list lock is held for the duration of the command
+		 * since releasing the session's reference may unpublish it from
+		 * the session list.
 		 */
-		list_lock = lttng::sessiond::lock_session_list();
+		if (command_is_read_only(cmd_ctx->lsm)) {
+			shared_list_lock = lttng::sessiond::lock_session_list_shared();
+		} else {
+			list_lock = lttng::sessiond::lock_session_list();
+		}
 		try {
 			target_session.emplace(
 				ltt_session::find_locked_session(cmd_ctx->lsm.session.name));
@@ -1233,11 +1418,15 @@ static int process_client_msg(struct command_ctx *cmd_ctx, int *sock, int *sock_
 		}
 
 		/* Kernel tracer check */
-		if (!kernel_tracer_is_initialized()) {
-			/* Basically, load kernel tracer modules */
-			ret = init_kernel_tracer();
-			if (ret != 0) {
-				goto error;
+		{
+			const std::lock_guard<std::mutex> init_lock(kernel_tracer_init_lock);
+
+			if (!kernel_tracer_is_initialized()) {
+				/* Basically, load kernel tracer modules */
+				ret = init_kernel_tracer();
+				if (ret != 0) {
+					goto error;
+				}
 			}
 		}
 
@@ -1540,7 +1729,7 @@ skip_domain:
 				goto error_add_remove_tracker_value;
 			}
 
-			ret = lttcomm_recv_unix_sock(*sock, payload.data, name_len);
+			ret = command_ctx_recv_payload(cmd_ctx, *sock, payload.data, name_len);
 			if (ret <= 0) {
 				ERR("Failed to receive payload of %s process attribute tracker value argument",
 				    add_value ? "add" : "remove");
@@ -1585,6 +1774,107 @@ skip_domain:
 		lttng_dynamic_buffer_reset(&payload);
 		break;
 	}
+	case LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_ADD_INCLUDE_VALUES:
+	case LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_REMOVE_INCLUDE_VALUES:
+	case LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_SET_INCLUDE_VALUES:
+	{
+		struct lttng_dynamic_buffer payload;
+		struct lttng_dynamic_buffer reply;
+		struct lttng_buffer_view payload_view;
+		struct lttng_process_attr_values *values = nullptr;
+		struct lttng_process_attr_values *changed_values = nullptr;
+		enum process_attr_tracker_inclusion_set_operation operation;
+		const size_t values_len =
+			cmd_ctx->lsm.u.process_attr_tracker_update_include_values.values_len;
+		const enum lttng_domain_type domain_type =
+			(enum lttng_domain_type) cmd_ctx->lsm.domain.type;
+		const enum lttng_process_attr process_attr =
+			(enum lttng_process_attr) cmd_ctx->lsm.u
+				.process_attr_tracker_update_include_values.process_attr;
+		ssize_t consumed_size;
+
+		switch (cmd_ctx->lsm.cmd_type) {
+		case LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_ADD_INCLUDE_VALUES:
+			operation = PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_ADD;
+			break;
+		case LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_REMOVE_INCLUDE_VALUES:
+			operation = PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_REMOVE;
+			break;
+		default:
+			operation = PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_REPLACE;
+			break;
+		}
+
+		lttng_dynamic_buffer_init(&payload);
+		lttng_dynamic_buffer_init(&reply);
+		if (values_len == 0) {
+			ret = LTTNG_ERR_INVALID;
+			goto error_update_tracker_values;
+		}
+
+		ret = lttng_dynamic_buffer_set_size(&payload, values_len);
+		if (ret) {
+			ERR("Failed to allocate buffer to receive process attribute tracker values: length = %zu",
+			    values_len);
+			ret = LTTNG_ERR_NOMEM;
+			goto error_update_tracker_values;
+		}
+
+		ret = command_ctx_recv_payload(cmd_ctx, *sock, payload.data, values_len);
+		if (ret <= 0) {
+			ERR("Failed to receive process attribute tracker values");
+			*sock_error = 1;
+			ret = LTTNG_ERR_INVALID_PROTOCOL;
+			goto error_update_tracker_values;
+		}
+
+		/*
+		 * The values are validated against the domain and process
+		 * attribute of the tracker as they are deserialized.
+		 */
+		payload_view = lttng_buffer_view_from_dynamic_buffer(&payload, 0, values_len);
+		consumed_size = lttng_process_attr_values_create_from_buffer(
+			domain_type, process_attr, &payload_view, &values);
+		if (consumed_size < 0 || (size_t) consumed_size != values_len) {
+			ret = LTTNG_ERR_INVALID;
+			goto error_update_tracker_values;
+		}
+
+		ret = cmd_process_attr_tracker_inclusion_set_update(
+			*target_session,
+			domain_type,
+			process_attr,
+			operation,
+			values,
+			operation == PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_ADD ?
+				&changed_values :
+				nullptr,
+			operation == PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_REMOVE ?
+				&changed_values :
+				nullptr);
+		if (ret != LTTNG_OK) {
+			goto error_update_tracker_values;
+		}
+
+		if (changed_values) {
+			/* Reply with the values that were effectively added or removed. */
+			ret = lttng_process_attr_values_serialize(changed_values, &reply);
+			if (ret < 0) {
+				ret = LTTNG_ERR_NOMEM;
+				goto error_update_tracker_values;
+			}
+
+			setup_lttng_msg_no_cmd_header(cmd_ctx, reply.data, reply.size);
+		}
+
+		ret = LTTNG_OK;
+	error_update_tracker_values:
+		lttng_process_attr_values_destroy(values);
+		lttng_process_attr_values_destroy(changed_values);
+		lttng_dynamic_buffer_reset(&payload);
+		lttng_dynamic_buffer_reset(&reply);
+		break;
+	}
 	case LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_GET_POLICY:
 	{
 		enum lttng_tracking_policy tracking_policy;
@@ -1796,7 +2086,7 @@ skip_domain:
 
 		/* Receive variable len data */
 		DBG("Receiving %zu URI(s) from client ...", nb_uri);
-		ret = lttcomm_recv_unix_sock(*sock, uris, len);
+		ret = command_ctx_recv_payload(cmd_ctx, *sock, uris, len);
 		if (ret <= 0) {
 			DBG("No URIs received from client... continuing");
 			*sock_error = 1;
@@ -1885,11 +2175,15 @@ skip_domain:
 		break;
 	}
 	case LTTCOMM_SESSIOND_COMMAND_LIST_EVENTS:
+	case LTTCOMM_SESSIOND_COMMAND_LIST_EVENTS_PAGE:
 	{
 		enum lttng_error_code ret_code;
 		size_t original_payload_size;
 		size_t payload_size;
 		const size_t command_header_size = sizeof(struct lttcomm_list_command_header);
+		/* A regular listing ignores the window fields. */
+		const bool is_paged = cmd_ctx->lsm.cmd_type ==
+			LTTCOMM_SESSIOND_COMMAND_LIST_EVENTS_PAGE;
 
 		setup_empty_lttng_msg(cmd_ctx);
 
@@ -1898,6 +2192,8 @@ skip_domain:
 		ret_code = cmd_list_events(cmd_ctx->lsm.domain.type,
 					   *target_session,
 					   cmd_ctx->lsm.u.list.channel_name,
+					   is_paged ? cmd_ctx->lsm.u.list.offset : 0,
+					   is_paged ? cmd_ctx->lsm.u.list.max_count : 0,
 					   &cmd_ctx->reply_payload);
 		if (ret_code != LTTNG_OK) {
 			ret = (int) ret_code;
@@ -1917,8 +2213,15 @@ skip_domain:
 		lttng_session *sessions_payload = nullptr;
 		size_t payload_len = 0;
 
-		list_lock = lttng::sessiond::lock_session_list();
-		nr_sessions = lttng_sessions_count(LTTNG_SOCK_GET_UID_CRED(&cmd_ctx->creds),
+		/*
+		 * Sessions can be destroyed by workers running commands against them
+		 * while the list is only locked in shared mode. The sessions are
+		 * sampled once to count and list the same set of sessions.
+		 */
+		shared_list_lock = lttng::sessiond::lock_session_list_shared();
+		const auto session_refs = session_get_list_references();
+		nr_sessions = lttng_sessions_count(session_refs,
+						   LTTNG_SOCK_GET_UID_CRED(&cmd_ctx->creds),
 						   LTTNG_SOCK_GET_GID_CRED(&cmd_ctx->creds));
 
 		if (nr_sessions > 0) {
@@ -1931,10 +2234,26 @@ skip_domain:
 					payload_len);
 			}
 
-			cmd_list_lttng_sessions(sessions_payload,
-						nr_sessions,
-						LTTNG_SOCK_GET_UID_CRED(&cmd_ctx->creds),
-						LTTNG_SOCK_GET_GID_CRED(&cmd_ctx->creds));
+			const auto nr_listed_sessions =
+				cmd_list_lttng_sessions(sessions_payload,
+							nr_sessions,
+							session_refs,
+							LTTNG_SOCK_GET_UID_CRED(&cmd_ctx->creds),
+							LTTNG_SOCK_GET_GID_CRED(&cmd_ctx->creds));
+			if (nr_listed_sessions != nr_sessions) {
+				/*
+				 * Sessions destroyed since they were counted are not
+				 * listed: move the extended infos right after the
+				 * listed sessions.
+				 */
+				memmove(&sessions_payload[nr_listed_sessions],
+					&sessions_payload[nr_sessions],
+					sizeof(struct lttng_session_extended) *
+						nr_listed_sessions);
+				payload_len = (sizeof(struct lttng_session) * nr_listed_sessions) +
+					(sizeof(struct lttng_session_extended) *
+					 nr_listed_sessions);
+			}
 		}
 
 		setup_lttng_msg_no_cmd_header(cmd_ctx, sessions_payload, payload_len);
@@ -2441,24 +2760,680 @@ static void log_nested_exceptions(const ExceptionType& ex, unsigned int level =
 }
 
 /*
- * This thread manage all clients request using the unix client socket for
- * communication.
+ * Returns the ordering key of a command that must be serialized with
+ * respect to other commands.
+ */
+static std::string command_ordering_key(const struct lttcomm_session_msg& lsm)
+{
+	switch (lsm.cmd_type) {
+	case LTTCOMM_SESSIOND_COMMAND_CREATE_SESSION_EXT:
+	case LTTCOMM_SESSIOND_COMMAND_SAVE_SESSION:
+	case LTTCOMM_SESSIOND_COMMAND_REGISTER_TRIGGER:
+	case LTTCOMM_SESSIOND_COMMAND_UNREGISTER_TRIGGER:
+		/* Commands that alter the global state of the session daemon. */
+		return "daemon";
+	default:
+		return std::string("session:") +
+			std::string(lsm.session.name,
+				    strnlen(lsm.session.name, sizeof(lsm.session.name)));
+	}
+}
+
+static uint64_t elapsed_us(std::chrono::steady_clock::time_point since)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		       std::chrono::steady_clock::now() - since)
+		.count();
+}
+
+static void update_maximum(std::atomic<uint64_t>& maximum, uint64_t value)
+{
+	uint64_t current = maximum.load(std::memory_order_relaxed);
+
+	while (value > current &&
+	       !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+	}
+}
+
+/*
+ * Process a client command and send the reply. The command context is
+ * owned by the calling worker and reused across commands.
+ *
+ * Returns the client's socket if `keep_connection` is set and the connection
+ * can receive another command, or -1 once the socket is closed or owned by a
+ * deferred reply.
+ */
+static int process_client_command(struct command_ctx& cmd_ctx, int sock, bool keep_connection)
+{
+	int ret, sock_error;
+	const struct cmd_completion_handler *cmd_completion_handler;
+
+	lttng_payload_clear(&cmd_ctx.reply_payload);
+	cmd_ctx.lttng_msg_size = 0;
+
+	// TODO: Validate cmd_ctx including sanity check for
+	// security purpose.
+
+	rcu_thread_online();
+	/*
+	 * This function dispatch the work to the kernel or userspace tracer
+	 * libs and fill the lttcomm_lttng_msg data structure of all the needed
+	 * informations for the client. The command context struct contains
+	 * everything this function may needs.
+	 */
+	try {
+		ret = process_client_msg(&cmd_ctx, &sock, &sock_error);
+		rcu_thread_offline();
+	} catch (const std::bad_alloc& ex) {
+		log_nested_exceptions(ex);
+		ret = LTTNG_ERR_NOMEM;
+	} catch (const lttng::ctl::error& ex) {
+		log_nested_exceptions(ex);
+		ret = ex.code();
+	} catch (const lttng::invalid_argument_error& ex) {
+		log_nested_exceptions(ex);
+		ret = LTTNG_ERR_INVALID;
+	} catch (const lttng::sessiond::exceptions::session_not_found_error& ex) {
+		log_nested_exceptions(ex);
+		ret = LTTNG_ERR_SESS_NOT_FOUND;
+	} catch (const lttng::sessiond::exceptions::channel_not_found_error& ex) {
+		log_nested_exceptions(ex);
+		ret = LTTNG_ERR_CHAN_NOT_FOUND;
+	} catch (const lttng::runtime_error& ex) {
+		log_nested_exceptions(ex);
+		ret = LTTNG_ERR_UNK;
+	} catch (const std::exception& ex) {
+		log_nested_exceptions(ex);
+		ret = LTTNG_ERR_UNK;
+	}
+
+	if (ret < LTTNG_OK || ret >= LTTNG_ERR_NR) {
+		WARN("Command returned an invalid status code, returning unknown error: "
+		     "command type = %s (%d), ret = %d",
+		     lttcomm_sessiond_command_is_valid(
+			     (lttcomm_sessiond_command) cmd_ctx.lsm.cmd_type) ?
+			     lttcomm_sessiond_command_str(
+				     (lttcomm_sessiond_command) cmd_ctx.lsm.cmd_type) :
+			     "unknown",
+		     cmd_ctx.lsm.cmd_type,
+		     ret);
+		ret = LTTNG_ERR_UNK;
+	}
+
+	if (ret != LTTNG_OK) {
+		/*
+		 * Reset the payload contents as the command may have left them in an
+		 * inconsistent state.
+		 */
+		setup_empty_lttng_msg(&cmd_ctx);
+	}
+
+	command_ctx_set_status_code(cmd_ctx, static_cast<lttng_error_code>(ret));
+
+	cmd_completion_handler = cmd_pop_completion_handler();
+	if (cmd_completion_handler) {
+		enum lttng_error_code completion_code;
+
+		completion_code = cmd_completion_handler->run(cmd_completion_handler->data);
+		if (completion_code != LTTNG_OK) {
+			/* No reply is sent to the client. */
+			keep_connection = false;
+			goto end;
+		}
+	}
+
+	health_code_update();
+
+	if (sock >= 0) {
+		struct lttng_payload_view view =
+			lttng_payload_view_from_payload(&cmd_ctx.reply_payload, 0, -1);
+		struct lttcomm_lttng_msg *llm = (typeof(llm)) cmd_ctx.reply_payload.buffer.data;
+
+		LTTNG_ASSERT(cmd_ctx.reply_payload.buffer.size >= sizeof(*llm));
+		LTTNG_ASSERT(cmd_ctx.lttng_msg_size == cmd_ctx.reply_payload.buffer.size);
+
+		llm->fd_count = lttng_payload_view_get_fd_handle_count(&view);
+
+		DBG("Sending response (size: %d, retcode: %s (%d))",
+		    cmd_ctx.lttng_msg_size,
+		    lttng_strerror(-llm->ret_code),
+		    llm->ret_code);
+		ret = send_unix_sock(sock, &view);
+		if (ret < 0) {
+			ERR("Failed to send data back to client");
+			keep_connection = false;
+		}
+	}
+
+end:
+	/* End of transmission */
+	if (sock >= 0 && !keep_connection) {
+		ret = close(sock);
+		if (ret) {
+			PERROR("close");
+		}
+
+		sock = -1;
+	}
+
+	health_code_update();
+	return sock;
+}
+
+/*
+ * Wait for a command that can be processed immediately: either a read-only
+ * command or the oldest queued command of an ordering key that is not being
+ * processed by another worker.
+ *
+ * Returns false when the workers must quit.
+ */
+static bool dequeue_client_command_job(client_command_job& job)
+{
+	std::unique_lock<std::mutex> lock(worker_pool.lock);
+
+	while (true) {
+		if (worker_pool.quit) {
+			return false;
+		}
+
+		for (auto it = worker_pool.queue.begin(); it != worker_pool.queue.end(); ++it) {
+			if (it->ordered && worker_pool.active_keys.count(it->ordering_key)) {
+				continue;
+			}
+
+			if (it->ordered) {
+				worker_pool.active_keys.insert(it->ordering_key);
+			}
+
+			job = std::move(*it);
+			worker_pool.queue.erase(it);
+			command_stats.queued_count--;
+			return true;
+		}
+
+		health_poll_entry();
+		worker_pool.job_available.wait(lock);
+		health_poll_exit();
+	}
+}
+
+static void complete_client_command_job(const client_command_job& job)
+{
+	if (!job.ordered) {
+		return;
+	}
+
+	{
+		const std::lock_guard<std::mutex> lock(worker_pool.lock);
+
+		worker_pool.active_keys.erase(job.ordering_key);
+	}
+
+	/* Commands of the same key may now be dispatched to another worker. */
+	worker_pool.job_available.notify_one();
+}
+
+static void close_client_connection(int sock)
+{
+	if (close(sock)) {
+		PERROR("Failed to close client connection");
+	}
+}
+
+/*
+ * Receive the payload and fds of a compact command, following its header.
+ *
+ * Returns 0 on success, -1 if the connection must be closed.
+ */
+static int receive_compact_client_command_payload(client_command_job& job)
+{
+	ssize_t ret;
+
+	job.payload.reset(new (std::nothrow) lttng_payload);
+	if (!job.payload) {
+		return -1;
+	}
+
+	lttng_payload_init(job.payload.get());
+	if (job.payload_size > 0) {
+		if (lttng_dynamic_buffer_set_size(&job.payload->buffer, job.payload_size)) {
+			return -1;
+		}
+
+		ret = lttcomm_recv_unix_sock(job.sock, job.payload->buffer.data, job.payload_size);
+		if (ret != (ssize_t) job.payload_size) {
+			DBG("Incomplete recv() of compact command payload from client");
+			return -1;
+		}
+	}
+
+	if (job.fd_count > 0) {
+		ret = lttcomm_recv_payload_fds_unix_sock(job.sock, job.fd_count, job.payload.get());
+		if (ret != (ssize_t) (job.fd_count * sizeof(int))) {
+			DBG("Failed to receive the fds of compact command from client");
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/* Hand a compact connection back to the client thread. */
+static void return_idle_client_connection(int sock)
+{
+	const char dummy = 0;
+
+	try {
+		const std::lock_guard<std::mutex> lock(worker_pool.lock);
+
+		worker_pool.idle_connections.emplace_back(sock);
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to return idle client connection: out of memory");
+		if (close(sock)) {
+			PERROR("close");
+		}
+
+		return;
+	}
+
+	if (lttng_pipe_write(worker_pool.idle_connection_pipe, &dummy, sizeof(dummy)) !=
+	    sizeof(dummy)) {
+		ERR("Failed to notify the client thread of an idle client connection");
+	}
+}
+
+static void enqueue_client_command_job(client_command_job job)
+{
+	/* The command of a receiving job is unknown until it is received. */
+	job.ordered = !job.receive && !command_is_read_only(job.lsm);
+	if (job.ordered) {
+		job.ordering_key = command_ordering_key(job.lsm);
+	}
+
+	job.enqueue_time = std::chrono::steady_clock::now();
+
+	{
+		const std::lock_guard<std::mutex> lock(worker_pool.lock);
+
+		worker_pool.queue.emplace_back(std::move(job));
+		command_stats.queued_count++;
+	}
+
+	worker_pool.job_available.notify_one();
+}
+
+/*
+ * Reply to a compact framing negotiation. The connection then uses the compact
+ * framing.
+ */
+static int send_compact_framing_negotiation_reply(int sock)
+{
+	lttcomm_lttng_msg llm{};
+
+	llm.cmd_type = LTTCOMM_SESSIOND_COMMAND_NEGOTIATE_COMPACT_FRAMING;
+	llm.ret_code = LTTNG_OK;
+	if (lttcomm_send_unix_sock(sock, &llm, sizeof(llm)) != sizeof(llm)) {
+		ERR("Failed to reply to compact framing negotiation of client");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Receive the header and attributes of the next command of a compact
+ * connection. Its payload and fds follow them.
+ *
+ * Returns 0 on success, -1 if the connection must be closed.
+ */
+static int receive_compact_client_command(int sock, client_command_job& job)
+{
+	struct lttcomm_session_compact_msg header;
+	struct lttng_dynamic_buffer attributes;
+	ssize_t ret;
+
+	lttng_dynamic_buffer_init(&attributes);
+	const auto reset_attributes = lttng::make_scope_exit(
+		[&attributes]() noexcept { lttng_dynamic_buffer_reset(&attributes); });
+
+	ret = lttcomm_recv_creds_unix_sock(sock, &header, sizeof(header), &job.creds);
+	if (ret == 0) {
+		DBG("Client closed compact connection");
+		return -1;
+	} else if (ret != sizeof(header)) {
+		DBG("Incomplete recv() of compact command header from client");
+		return -1;
+	}
+
+	if (header.magic != LTTCOMM_SESSIOND_COMPACT_MAGIC ||
+	    header.attributes_size > LTTCOMM_SESSIOND_COMPACT_MAX_ATTRIBUTES_SIZE ||
+	    header.payload_size > LTTCOMM_SESSIOND_COMPACT_MAX_PAYLOAD_SIZE ||
+	    header.fd_count > LTTCOMM_MAX_SEND_FDS) {
+		ERR("Invalid compact command header received from client: magic = %#" PRIx32
+		    ", attributes size = %" PRIu32 ", payload size = %" PRIu32
+		    ", fd count = %" PRIu32,
+		    header.magic,
+		    header.attributes_size,
+		    header.payload_size,
+		    header.fd_count);
+		return -1;
+	}
+
+	if (header.attributes_size > 0) {
+		if (lttng_dynamic_buffer_set_size(&attributes, header.attributes_size)) {
+			return -1;
+		}
+
+		ret = lttcomm_recv_unix_sock(sock, attributes.data, attributes.size);
+		if (ret != (ssize_t) attributes.size) {
+			DBG("Incomplete recv() of compact command attributes from client");
+			return -1;
+		}
+	}
+
+	const auto attributes_view = lttng_buffer_view_from_dynamic_buffer(&attributes, 0, -1);
+	if (lttcomm_session_msg_from_compact(&header, &attributes_view, &job.lsm)) {
+		return -1;
+	}
+
+	job.payload_size = header.payload_size;
+	job.fd_count = header.fd_count;
+	job.compact = true;
+	return 0;
+}
+
+/*
+ * Dispatch a received command to the workers. The job owns the client's
+ * socket.
+ */
+static void dispatch_client_command(client_command_job job)
+{
+	const int sock = job.sock;
+
+	try {
+		enqueue_client_command_job(std::move(job));
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to queue client command: out of memory");
+		close_client_connection(sock);
+	}
+}
+
+/*
+ * Receive the next command of a polled compact connection and queue it. The
+ * job owns the client's socket.
+ */
+static void receive_polled_client_command(client_command_job job)
+{
+	const int sock = job.sock;
+
+	job.receive = false;
+	job.creds.uid = UINT32_MAX;
+	job.creds.gid = UINT32_MAX;
+	job.creds.pid = 0;
+	if (receive_compact_client_command(sock, job)) {
+		close_client_connection(sock);
+		return;
+	}
+
+	if (job.lsm.cmd_type == LTTCOMM_SESSIOND_COMMAND_NEGOTIATE_COMPACT_FRAMING) {
+		/* Already negotiated; no other command of the connection is in flight. */
+		if (job.payload_size > 0 || job.fd_count > 0) {
+			ERR("Compact framing negotiation of client has an unexpected payload");
+			close_client_connection(sock);
+		} else if (send_compact_framing_negotiation_reply(sock)) {
+			close_client_connection(sock);
+		} else {
+			return_idle_client_connection(sock);
+		}
+
+		return;
+	}
+
+	if (receive_compact_client_command_payload(job)) {
+		close_client_connection(sock);
+		return;
+	}
+
+	dispatch_client_command(std::move(job));
+}
+
+static void client_worker_thread(unsigned int worker_id)
+{
+	struct command_ctx cmd_ctx = {};
+
+	DBG("[thread] Client command worker %u started", worker_id);
+
+	lttng_payload_init(&cmd_ctx.reply_payload);
+	rcu_register_thread();
+	health_register(the_health_sessiond, HEALTH_SESSIOND_TYPE_CMD);
+	health_code_update();
+
+	while (true) {
+		client_command_job job;
+
+		if (!dequeue_client_command_job(job)) {
+			break;
+		}
+
+		if (job.receive) {
+			receive_polled_client_command(std::move(job));
+			continue;
+		}
+
+		const auto queue_wait_us = elapsed_us(job.enqueue_time);
+		const auto processing_start = std::chrono::steady_clock::now();
+
+		command_stats.active_count++;
+		command_stats.total_queue_wait_us += queue_wait_us;
+		update_maximum(command_stats.max_queue_wait_us, queue_wait_us);
+
+		cmd_ctx.lsm = job.lsm;
+		cmd_ctx.creds = job.creds;
+		cmd_ctx.command_payload = job.payload.get();
+		cmd_ctx.command_payload_position = 0;
+		cmd_ctx.command_payload_fd_position = 0;
+		const auto idle_sock = process_client_command(cmd_ctx, job.sock, job.compact);
+		cmd_ctx.command_payload = nullptr;
+		/* Close the fds which were not consumed by the command. */
+		job.payload.reset();
+		complete_client_command_job(job);
+		if (idle_sock >= 0) {
+			return_idle_client_connection(idle_sock);
+		}
+
+		const auto processing_us = elapsed_us(processing_start);
+
+		command_stats.active_count--;
+		command_stats.completed_count++;
+		command_stats.total_processing_us += processing_us;
+		update_maximum(command_stats.max_processing_us, processing_us);
+
+		/* Unknown commands are rejected, but still reach this point. */
+		const auto cmd_type = (lttcomm_sessiond_command) cmd_ctx.lsm.cmd_type;
+
+		DBG_FMT("Client command processed: name=`{}`, id={}, worker_id={}, queue_wait_us={}, processing_us={}",
+			lttcomm_sessiond_command_is_valid(cmd_type) ?
+				lttcomm_sessiond_command_str(cmd_type) :
+				"unknown",
+			(uint32_t) cmd_type,
+			worker_id,
+			queue_wait_us,
+			processing_us);
+	}
+
+	health_unregister(the_health_sessiond);
+	lttng_payload_reset(&cmd_ctx.reply_payload);
+	rcu_unregister_thread();
+	DBG("Client command worker %u dying", worker_id);
+}
+
+static bool launch_client_workers()
+{
+	const auto worker_count =
+		(unsigned int) utils_get_positive_env_value(DEFAULT_CLIENT_WORKER_COUNT_ENV,
+							    DEFAULT_CLIENT_WORKER_COUNT,
+							    CLIENT_MAX_WORKER_COUNT);
+
+	DBG("Launching %u client command workers", worker_count);
+	worker_pool.quit = false;
+	try {
+		for (unsigned int i = 0; i < worker_count; i++) {
+			worker_pool.workers.emplace_back(client_worker_thread, i);
+		}
+	} catch (const std::system_error& ex) {
+		ERR_FMT("Failed to launch client command worker: {}", ex.what());
+		if (worker_pool.workers.empty()) {
+			return false;
+		}
+	}
+
+	command_stats.worker_count = worker_pool.workers.size();
+	return true;
+}
+
+/*
+ * Stop the workers once they are done with the command they are processing.
+ * Clients of the commands still queued are disconnected.
+ */
+static void stop_client_workers()
+{
+	{
+		const std::lock_guard<std::mutex> lock(worker_pool.lock);
+
+		worker_pool.quit = true;
+	}
+
+	worker_pool.job_available.notify_all();
+	for (auto& worker : worker_pool.workers) {
+		worker.join();
+	}
+
+	worker_pool.workers.clear();
+	command_stats.worker_count = 0;
+
+	for (const auto& job : worker_pool.queue) {
+		if (close(job.sock)) {
+			PERROR("Failed to close client socket of unprocessed command");
+		}
+	}
+
+	worker_pool.queue.clear();
+	worker_pool.active_keys.clear();
+	command_stats.queued_count = 0;
+
+	for (const auto sock : worker_pool.idle_connections) {
+		if (close(sock)) {
+			PERROR("Failed to close idle client connection");
+		}
+	}
+
+	worker_pool.idle_connections.clear();
+}
+
+namespace {
+/* Compact connections polled by the client thread for their next command. */
+using polled_connection_set = std::unordered_set<int>;
+} /* namespace */
+
+/* Poll a compact connection for its next command. Closes it on error. */
+static void poll_client_connection(struct lttng_poll_event *events,
+				   polled_connection_set& connections,
+				   int sock)
+{
+	try {
+		connections.insert(sock);
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to poll client connection: out of memory");
+		close_client_connection(sock);
+		return;
+	}
+
+	if (lttng_poll_add(events, sock, LPOLLIN | LPOLLRDHUP)) {
+		ERR("Failed to poll client connection");
+		connections.erase(sock);
+		close_client_connection(sock);
+	}
+}
+
+static void unpoll_client_connection(struct lttng_poll_event *events,
+				     polled_connection_set& connections,
+				     int sock)
+{
+	(void) lttng_poll_del(events, sock);
+	connections.erase(sock);
+}
+
+/*
+ * Hand a polled compact connection which has a command to receive to the
+ * workers.
+ */
+static void handle_client_connection_event(struct lttng_poll_event *events,
+					   polled_connection_set& connections,
+					   int sock,
+					   uint32_t revents)
+{
+	client_command_job job;
+
+	/* The commands of a connection are processed one at a time. */
+	unpoll_client_connection(events, connections, sock);
+	if (!(revents & LPOLLIN)) {
+		DBG("Client compact connection hung up");
+		close_client_connection(sock);
+		return;
+	}
+
+	job.sock = sock;
+	job.receive = true;
+	dispatch_client_command(std::move(job));
+}
+
+/* Poll the compact connections handed back by the workers. */
+static int poll_idle_client_connections(struct lttng_poll_event *events,
+					polled_connection_set& connections)
+{
+	std::vector<int> idle_connections;
+	char dummy;
+
+	if (lttng_pipe_read(worker_pool.idle_connection_pipe, &dummy, sizeof(dummy)) !=
+	    sizeof(dummy)) {
+		ERR("Failed to read idle client connection notification");
+		return -1;
+	}
+
+	{
+		const std::lock_guard<std::mutex> lock(worker_pool.lock);
+
+		idle_connections.swap(worker_pool.idle_connections);
+	}
+
+	for (const auto sock : idle_connections) {
+		poll_client_connection(events, connections, sock);
+	}
+
+	return 0;
+}
+
+/*
+ * This thread accepts the clients' connections and receives their command
+ * header before handing them off to the pool of client command workers.
+ *
+ * Connections using the compact framing are polled for their next command
+ * once their previous command is processed. The workers receive it.
  */
 static void *thread_manage_clients(void *data)
 {
 	int sock = -1, ret, i, err = -1;
-	int sock_error;
 	uint32_t nb_fd;
 	struct lttng_poll_event events;
 	const int client_sock = thread_state.client_sock;
 	struct lttng_pipe *quit_pipe = (lttng_pipe *) data;
 	const int thread_quit_pipe_fd = lttng_pipe_get_readfd(quit_pipe);
-	struct command_ctx cmd_ctx = {};
+	int idle_connection_pipe_fd = -1;
+	bool workers_launched = false;
+	polled_connection_set polled_connections;
 
 	DBG("[thread] Manage client started");
 
-	lttng_payload_init(&cmd_ctx.reply_payload);
-
 	is_root = (getuid() == 0);
 
 	pthread_cleanup_push(thread_init_cleanup, nullptr);
@@ -2475,10 +3450,11 @@ static void *thread_manage_clients(void *data)
 	}
 
 	/*
-	 * Pass 2 as size here for the thread quit pipe and client_sock. Nothing
-	 * more will be added to this poll set.
+	 * Pass 3 as size here for the thread quit pipe, the idle connection
+	 * pipe and client_sock. The compact connections are added to this
+	 * poll set once their previous command is processed.
 	 */
-	ret = lttng_poll_create(&events, 2, LTTNG_CLOEXEC);
+	ret = lttng_poll_create(&events, 3, LTTNG_CLOEXEC);
 	if (ret < 0) {
 		goto error_create_poll;
 	}
@@ -2495,6 +3471,22 @@ static void *thread_manage_clients(void *data)
 		goto error;
 	}
 
+	worker_pool.idle_connection_pipe = lttng_pipe_open(FD_CLOEXEC);
+	if (!worker_pool.idle_connection_pipe) {
+		goto error;
+	}
+
+	idle_connection_pipe_fd = lttng_pipe_get_readfd(worker_pool.idle_connection_pipe);
+	ret = lttng_poll_add(&events, idle_connection_pipe_fd, LPOLLIN);
+	if (ret < 0) {
+		goto error;
+	}
+
+	workers_launched = launch_client_workers();
+	if (!workers_launched) {
+		goto error;
+	}
+
 	/* Set state as running. */
 	set_thread_status(true);
 	pthread_cleanup_pop(0);
@@ -2511,13 +3503,12 @@ static void *thread_manage_clients(void *data)
 	health_code_update();
 
 	while (true) {
-		const struct cmd_completion_handler *cmd_completion_handler;
+		client_command_job job;
+		bool accept_pending = false;
 
-		cmd_ctx.creds.uid = UINT32_MAX;
-		cmd_ctx.creds.gid = UINT32_MAX;
-		cmd_ctx.creds.pid = 0;
-		lttng_payload_clear(&cmd_ctx.reply_payload);
-		cmd_ctx.lttng_msg_size = 0;
+		job.creds.uid = UINT32_MAX;
+		job.creds.gid = UINT32_MAX;
+		job.creds.pid = 0;
 
 		DBG("Accepting client command ...");
 
@@ -2552,8 +3543,25 @@ static void *thread_manage_clients(void *data)
 				goto exit;
 			}
 
+			if (pollfd == idle_connection_pipe_fd) {
+				if (!(revents & LPOLLIN) ||
+				    poll_idle_client_connections(&events, polled_connections)) {
+					ERR("Idle client connection pipe error");
+					goto error;
+				}
+
+				continue;
+			}
+
+			if (pollfd != client_sock) {
+				handle_client_connection_event(
+					&events, polled_connections, pollfd, revents);
+				continue;
+			}
+
 			/* Event on the registration socket */
 			if (revents & LPOLLIN) {
+				accept_pending = true;
 				continue;
 			} else if (revents & (LPOLLERR | LPOLLHUP | LPOLLRDHUP)) {
 				ERR("Client socket poll error");
@@ -2564,6 +3572,10 @@ static void *thread_manage_clients(void *data)
 			}
 		}
 
+		if (!accept_pending) {
+			continue;
+		}
+
 		DBG("Wait for client response");
 
 		health_code_update();
@@ -2594,7 +3606,7 @@ static void *thread_manage_clients(void *data)
 		 */
 		DBG("Receiving data from client ...");
 		ret = lttcomm_recv_creds_unix_sock(
-			sock, &cmd_ctx.lsm, sizeof(struct lttcomm_session_msg), &cmd_ctx.creds);
+			sock, &job.lsm, sizeof(struct lttcomm_session_msg), &job.creds);
 		if (ret != sizeof(struct lttcomm_session_msg)) {
 			DBG("Incomplete recv() from client... continuing");
 			ret = close(sock);
@@ -2607,101 +3619,22 @@ static void *thread_manage_clients(void *data)
 
 		health_code_update();
 
-		// TODO: Validate cmd_ctx including sanity check for
-		// security purpose.
-
-		rcu_thread_online();
-		/*
-		 * This function dispatch the work to the kernel or userspace tracer
-		 * libs and fill the lttcomm_lttng_msg data structure of all the needed
-		 * informations for the client. The command context struct contains
-		 * everything this function may needs.
-		 */
-		try {
-			ret = process_client_msg(&cmd_ctx, &sock, &sock_error);
-			rcu_thread_offline();
-		} catch (const std::bad_alloc& ex) {
-			log_nested_exceptions(ex);
-			ret = LTTNG_ERR_NOMEM;
-		} catch (const lttng::ctl::error& ex) {
-			log_nested_exceptions(ex);
-			ret = ex.code();
-		} catch (const lttng::invalid_argument_error& ex) {
-			log_nested_exceptions(ex);
-			ret = LTTNG_ERR_INVALID;
-		} catch (const lttng::sessiond::exceptions::session_not_found_error& ex) {
-			log_nested_exceptions(ex);
-			ret = LTTNG_ERR_SESS_NOT_FOUND;
-		} catch (const lttng::sessiond::exceptions::channel_not_found_error& ex) {
-			log_nested_exceptions(ex);
-			ret = LTTNG_ERR_CHAN_NOT_FOUND;
-		} catch (const lttng::runtime_error& ex) {
-			log_nested_exceptions(ex);
-			ret = LTTNG_ERR_UNK;
-		} catch (const std::exception& ex) {
-			log_nested_exceptions(ex);
-			ret = LTTNG_ERR_UNK;
-		}
-
-		if (ret < LTTNG_OK || ret >= LTTNG_ERR_NR) {
-			WARN("Command returned an invalid status code, returning unknown error: "
-			     "command type = %s (%d), ret = %d",
-			     lttcomm_sessiond_command_str(
-				     (lttcomm_sessiond_command) cmd_ctx.lsm.cmd_type),
-			     cmd_ctx.lsm.cmd_type,
-			     ret);
-			ret = LTTNG_ERR_UNK;
-		}
-
-		if (ret != LTTNG_OK) {
-			/*
-			 * Reset the payload contents as the command may have left them in an
-			 * inconsistent state.
-			 */
-			setup_empty_lttng_msg(&cmd_ctx);
-		}
-
-		command_ctx_set_status_code(cmd_ctx, static_cast<lttng_error_code>(ret));
-
-		cmd_completion_handler = cmd_pop_completion_handler();
-		if (cmd_completion_handler) {
-			enum lttng_error_code completion_code;
-
-			completion_code = cmd_completion_handler->run(cmd_completion_handler->data);
-			if (completion_code != LTTNG_OK) {
-				continue;
-			}
-		}
-
-		health_code_update();
-
-		if (sock >= 0) {
-			struct lttng_payload_view view =
-				lttng_payload_view_from_payload(&cmd_ctx.reply_payload, 0, -1);
-			struct lttcomm_lttng_msg *llm =
-				(typeof(llm)) cmd_ctx.reply_payload.buffer.data;
-
-			LTTNG_ASSERT(cmd_ctx.reply_payload.buffer.size >= sizeof(*llm));
-			LTTNG_ASSERT(cmd_ctx.lttng_msg_size == cmd_ctx.reply_payload.buffer.size);
-
-			llm->fd_count = lttng_payload_view_get_fd_handle_count(&view);
-
-			DBG("Sending response (size: %d, retcode: %s (%d))",
-			    cmd_ctx.lttng_msg_size,
-			    lttng_strerror(-llm->ret_code),
-			    llm->ret_code);
-			ret = send_unix_sock(sock, &view);
-			if (ret < 0) {
-				ERR("Failed to send data back to client");
+		if (job.lsm.cmd_type == LTTCOMM_SESSIOND_COMMAND_NEGOTIATE_COMPACT_FRAMING) {
+			DBG("Client connection switching to the compact framing");
+			if (send_compact_framing_negotiation_reply(sock)) {
+				close_client_connection(sock);
+			} else {
+				poll_client_connection(&events, polled_connections, sock);
 			}
 
-			/* End of transmission */
-			ret = close(sock);
-			if (ret) {
-				PERROR("close");
-			}
+			sock = -1;
+			continue;
 		}
+
+		/* The worker processing the command owns the socket. */
+		job.sock = sock;
 		sock = -1;
+		dispatch_client_command(std::move(job));
 
 		health_code_update();
 	}
@@ -2715,6 +3648,17 @@ error:
 		}
 	}
 
+	if (workers_launched) {
+		stop_client_workers();
+	}
+
+	for (const auto polled_sock : polled_connections) {
+		close_client_connection(polled_sock);
+	}
+
+	polled_connections.clear();
+	lttng_pipe_destroy(worker_pool.idle_connection_pipe);
+	worker_pool.idle_connection_pipe = nullptr;
 	lttng_poll_clean(&events);
 
 error_listen:
@@ -2733,11 +3677,22 @@ error_create_poll:
 	health_unregister(the_health_sessiond);
 
 	DBG("Client thread dying");
-	lttng_payload_reset(&cmd_ctx.reply_payload);
 	rcu_unregister_thread();
 	return nullptr;
 }
 
+void client_get_command_metrics(struct client_command_metrics *metrics)
+{
+	metrics->worker_count = command_stats.worker_count;
+	metrics->queued_count = command_stats.queued_count;
+	metrics->active_count = command_stats.active_count;
+	metrics->completed_count = command_stats.completed_count;
+	metrics->total_queue_wait_us = command_stats.total_queue_wait_us;
+	metrics->max_queue_wait_us = command_stats.max_queue_wait_us;
+	metrics->total_processing_us = command_stats.total_processing_us;
+	metrics->max_processing_us = command_stats.max_processing_us;
+}
+
 static bool shutdown_client_thread(void *thread_data)
 {
 	struct lttng_pipe *client_quit_pipe = (lttng_pipe *) thread_data;
@@ -12,6 +12,23 @@
 
 #include "thread.hpp"
 
+#include <stdint.h>
+
+/* Snapshot of the client command processing statistics. */
+struct client_command_metrics {
+	unsigned int worker_count;
+	unsigned int queued_count;
+	unsigned int active_count;
+	uint64_t completed_count;
+	uint64_t total_queue_wait_us;
+	uint64_t max_queue_wait_us;
+	uint64_t total_processing_us;
+	uint64_t max_processing_us;
+};
+
 struct lttng_thread *launch_client_thread();
 
+/* Safe to call from any thread, even if the client thread is not running. */
+void client_get_command_metrics(struct client_command_metrics *metrics);
+
 #endif /* CLIENT_SESSIOND_H */
@@ -103,11 +103,17 @@ struct cmd_destroy_session_reply_context {
  * when a session that has a non-default shm_path is being destroyed.
  *
  * See comment in cmd_destroy_session() for the rationale.
+ *
+ * Client commands are processed by a pool of worker threads: the handler
+ * (and the completion handler pointer below) are per-thread so that a
+ * destruction doesn't clobber the completion of another worker's command.
  */
 struct destroy_completion_handler {
 	struct cmd_completion_handler handler;
 	char shm_path[member_sizeof(struct ltt_session, shm_path)];
-} destroy_completion_handler = {
+};
+
+thread_local struct destroy_completion_handler destroy_completion_handler = {
 	.handler = { .run = wait_on_path, .data = destroy_completion_handler.shm_path },
 	.shm_path = { 0 },
 };
@@ -120,9 +126,42 @@ struct destroy_completion_handler {
  */
 pthread_mutex_t relayd_net_seq_idx_lock = PTHREAD_MUTEX_INITIALIZER;
 uint64_t relayd_net_seq_idx;
+
+/*
+ * Window of a listing sent back to a client which pages through the
+ * entries of a large listing.
+ */
+struct list_window {
+	list_window(uint32_t offset_, uint32_t max_count_) :
+		offset(offset_), max_count(max_count_)
+	{
+	}
+
+	/*
+	 * Called for each listed entry, in iteration order. Returns true if
+	 * the entry is part of the window and must be serialized.
+	 */
+	bool visit() noexcept
+	{
+		const auto entry_index = index++;
+
+		return entry_index >= offset &&
+			(max_count == 0 || entry_index - offset < max_count);
+	}
+
+	bool is_full() const noexcept
+	{
+		return max_count != 0 && index >= (uint64_t) offset + max_count;
+	}
+
+	const uint32_t offset;
+	/* 0 means that the listing is not bounded. */
+	const uint32_t max_count;
+	uint64_t index = 0;
+};
 } /* namespace */
 
-static struct cmd_completion_handler *current_completion_handler;
+static thread_local struct cmd_completion_handler *current_completion_handler;
 static int validate_ust_event_name(const char *);
 static int cmd_enable_event_internal(ltt_session::locked_ref& session,
 				     const struct lttng_domain *domain,
@@ -319,6 +358,7 @@ end:
  * Return number of events in list on success or else a negative value.
  */
 static enum lttng_error_code list_lttng_agent_events(struct agent *agt,
+						     list_window& window,
 						     struct lttng_payload *reply_payload,
 						     unsigned int *nb_events)
 {
@@ -343,12 +383,18 @@ static enum lttng_error_code list_lttng_agent_events(struct agent *agt,
 		goto error;
 	}
 
-	local_nb_events = (unsigned int) agent_event_count;
-
 	for (auto *event :
 	     lttng::urcu::lfht_iteration_adapter<agent_event,
 						 decltype(agent_event::node),
 						 &agent_event::node>(*agt->events->ht)) {
+		if (window.is_full()) {
+			break;
+		}
+
+		if (!window.visit()) {
+			continue;
+		}
+
 		struct lttng_event *tmp_event = lttng_event_create();
 
 		if (!tmp_event) {
@@ -374,6 +420,8 @@ static enum lttng_error_code list_lttng_agent_events(struct agent *agt,
 			ret_code = LTTNG_ERR_FATAL;
 			goto error;
 		}
+
+		local_nb_events++;
 	}
 end:
 	ret_code = LTTNG_OK;
@@ -387,6 +435,7 @@ error:
  */
 static enum lttng_error_code list_lttng_ust_global_events(char *channel_name,
 							  struct ltt_ust_domain_global *ust_global,
+							  list_window& window,
 							  struct lttng_payload *reply_payload,
 							  unsigned int *nb_events)
 {
@@ -426,9 +475,7 @@ static enum lttng_error_code list_lttng_ust_global_events(char *channel_name,
 		goto error;
 	}
 
-	local_nb_events = (unsigned int) channel_event_count;
-
-	DBG3("Listing UST global %d events", *nb_events);
+	DBG3("Listing UST global %lu events", channel_event_count);
 
 	for (auto *uevent :
 	     lttng::urcu::lfht_iteration_adapter<ltt_ust_event,
@@ -438,7 +485,14 @@ static enum lttng_error_code list_lttng_ust_global_events(char *channel_name,
 
 		if (uevent->internal) {
 			/* This event should remain hidden from clients */
-			local_nb_events--;
+			continue;
+		}
+
+		if (window.is_full()) {
+			break;
+		}
+
+		if (!window.visit()) {
 			continue;
 		}
 
@@ -513,6 +567,8 @@ static enum lttng_error_code list_lttng_ust_global_events(char *channel_name,
 			ret_code = LTTNG_ERR_FATAL;
 			goto error;
 		}
+
+		local_nb_events++;
 	}
 
 end:
@@ -528,6 +584,7 @@ error:
  */
 static enum lttng_error_code list_lttng_kernel_events(char *channel_name,
 						      struct ltt_kernel_session *kernel_session,
+						      list_window& window,
 						      struct lttng_payload *reply_payload,
 						      unsigned int *nb_events)
 {
@@ -543,11 +600,11 @@ static enum lttng_error_code list_lttng_kernel_events(char *channel_name,
 		goto end;
 	}
 
-	*nb_events = kchan->event_count;
+	*nb_events = 0;
 
 	DBG("Listing events for channel %s", kchan->channel->name);
 
-	if (*nb_events == 0) {
+	if (kchan->event_count == 0) {
 		ret_code = LTTNG_OK;
 		goto end;
 	}
@@ -556,6 +613,14 @@ static enum lttng_error_code list_lttng_kernel_events(char *channel_name,
 	for (auto event :
 	     lttng::urcu::list_iteration_adapter<ltt_kernel_event, &ltt_kernel_event::list>(
 		     kchan->events_list.head)) {
+		if (window.is_full()) {
+			break;
+		}
+
+		if (!window.visit()) {
+			continue;
+		}
+
 		struct lttng_event *tmp_event = lttng_event_create();
 
 		if (!tmp_event) {
@@ -638,6 +703,8 @@ static enum lttng_error_code list_lttng_kernel_events(char *channel_name,
 			ret_code = LTTNG_ERR_FATAL;
 			goto end;
 		}
+
+		(*nb_events)++;
 	}
 
 	ret_code = LTTNG_OK;
@@ -1249,6 +1316,48 @@ get_domain_class_from_ctl_domain_type(enum lttng_domain_type domain_type)
 			domain_type));
 	}
 }
+
+/*
+ * Apply the pending changes of the configuration of the user space domain of
+ * a session to the applications, before an operation which relies on the
+ * applications having the session's configuration.
+ */
+void apply_pending_ust_app_changes(const ltt_session::locked_ref& session) noexcept
+{
+	unsigned int failed_app_count;
+
+	if (!session->ust_session) {
+		return;
+	}
+
+	failed_app_count = ust_app_apply_pending_session_update(session->ust_session);
+	if (failed_app_count) {
+		ERR("Failed to apply the pending changes of session \"%s\" to %u application(s)",
+		    session->name,
+		    failed_app_count);
+	}
+}
+
+/*
+ * Arm the application synchronization timer of a session if changes of the
+ * configuration of its user space domain are pending.
+ */
+void schedule_ust_app_synchronization(const ltt_session::locked_ref& session) noexcept
+{
+	struct ltt_ust_session *usess = session->ust_session;
+
+	/* The changes made while the session is inactive are applied when it is started. */
+	if (!usess || !usess->active || !usess->app_sync_pending ||
+	    session->app_sync_timer_enabled) {
+		return;
+	}
+
+	if (timer_session_app_sync_timer_start(session, the_config.app_sync_delay * 1000)) {
+		ERR("Failed to start the application synchronization timer of session \"%s\", synchronizing the applications immediately",
+		    session->name);
+		apply_pending_ust_app_changes(session);
+	}
+}
 } /* namespace */
 
 /*
@@ -1265,6 +1374,8 @@ int cmd_disable_channel(const ltt_session::locked_ref& session,
 	auto& channel_config = target_domain.get_channel(channel_name);
 
 	const lttng::urcu::read_lock_guard read_lock;
+	const auto schedule_app_sync = lttng::make_scope_exit(
+		[&session]() noexcept { schedule_ust_app_synchronization(session); });
 
 	switch (domain) {
 	case LTTNG_DOMAIN_KERNEL:
@@ -1330,7 +1441,8 @@ int cmd_enable_channel(command_ctx *cmd_ctx, ltt_session::locked_ref& session, i
 		return LTTNG_ERR_NOMEM;
 	}
 
-	const auto sock_recv_len = lttcomm_recv_unix_sock(sock, channel_buffer.data, channel_len);
+	const auto sock_recv_len =
+		command_ctx_recv_payload(cmd_ctx, sock, channel_buffer.data, channel_len);
 	if (sock_recv_len < 0 || sock_recv_len != channel_len) {
 		ERR("Failed to receive \"enable channel\" command payload");
 		return LTTNG_ERR_INVALID;
@@ -1375,6 +1487,8 @@ static enum lttng_error_code cmd_enable_channel_internal(ltt_session::locked_ref
 	LTTNG_ASSERT(domain);
 
 	const lttng::urcu::read_lock_guard read_lock;
+	const auto schedule_app_sync = lttng::make_scope_exit(
+		[&session]() noexcept { schedule_ust_app_synchronization(session); });
 
 	auto new_channel_attr = lttng::make_unique_wrapper<lttng_channel, lttng_channel_destroy>(
 		lttng_channel_copy(&channel_attr));
@@ -1680,8 +1794,13 @@ static enum lttng_error_code cmd_enable_channel_internal(ltt_session::locked_ref
 			channel_attr.attr.tracefile_count) :
 		nonstd::nullopt;
 
-	/* Validate consumption backend (mmap or splice). */
+	/*
+	 * Validate consumption backend (mmap or splice). The sub-buffers of
+	 * user space channels are vmsplice'd by the consumer daemon; this is
+	 * not supported by the agent domains.
+	 */
 	if (target_domain.domain_class_ != ls::domain_class::KERNEL_SPACE &&
+	    target_domain.domain_class_ != ls::domain_class::USER_SPACE &&
 	    channel_attr.attr.output != LTTNG_EVENT_MMAP) {
 		LTTNG_THROW_UNSUPPORTED_ERROR(fmt::format(
 			"Buffer consumption back-end is unsupported by this domain: domain={}, backend=SPLICE",
@@ -1878,6 +1997,50 @@ end:
 	return ret_code;
 }
 
+enum lttng_error_code cmd_process_attr_tracker_inclusion_set_update(
+	const ltt_session::locked_ref& session,
+	enum lttng_domain_type domain,
+	enum lttng_process_attr process_attr,
+	enum process_attr_tracker_inclusion_set_operation operation,
+	const struct lttng_process_attr_values *values,
+	struct lttng_process_attr_values **added_values,
+	struct lttng_process_attr_values **removed_values)
+{
+	enum lttng_error_code ret_code = LTTNG_OK;
+
+	switch (domain) {
+	case LTTNG_DOMAIN_KERNEL:
+		if (!session->kernel_session) {
+			ret_code = LTTNG_ERR_INVALID;
+			goto end;
+		}
+		ret_code = kernel_process_attr_tracker_inclusion_set_update(session->kernel_session,
+									   process_attr,
+									   operation,
+									   values,
+									   added_values,
+									   removed_values);
+		break;
+	case LTTNG_DOMAIN_UST:
+		if (!session->ust_session) {
+			ret_code = LTTNG_ERR_INVALID;
+			goto end;
+		}
+		ret_code = trace_ust_process_attr_tracker_inclusion_set_update(session->ust_session,
+									      process_attr,
+									      operation,
+									      values,
+									      added_values,
+									      removed_values);
+		break;
+	default:
+		ret_code = LTTNG_ERR_UNSUPPORTED_DOMAIN;
+		break;
+	}
+end:
+	return ret_code;
+}
+
 enum lttng_error_code
 cmd_process_attr_tracker_get_inclusion_set(const ltt_session::locked_ref& session,
 					   enum lttng_domain_type domain,
@@ -2015,6 +2178,9 @@ lttng_error_code cmd_disable_event(struct command_ctx *cmd_ctx,
 
 	DBG("Disable event command for event \'%s\'", event->name);
 
+	const auto schedule_app_sync = lttng::make_scope_exit(
+		[&locked_session]() noexcept { schedule_ust_app_synchronization(locked_session); });
+
 	const auto filter_expression =
 		lttng::make_unique_wrapper<char, lttng::memory::free>(raw_filter_expression);
 	const auto bytecode =
@@ -2429,6 +2595,8 @@ static lttng_error_code _cmd_enable_event(ltt_session::locked_ref& locked_sessio
 	int ret = 0, channel_created = 0;
 	struct lttng_channel *attr = nullptr;
 	ltt_session& session = *locked_session;
+	const auto schedule_app_sync = lttng::make_scope_exit(
+		[&locked_session]() noexcept { schedule_ust_app_synchronization(locked_session); });
 
 	LTTNG_ASSERT(event);
 	LTTNG_ASSERT(channel_name);
@@ -3262,6 +3430,9 @@ int cmd_stop_trace(const ltt_session::locked_ref& session)
 	}
 
 	if (usess && usess->active) {
+		/* The changes made up to the stop are part of the trace. */
+		apply_pending_ust_app_changes(session);
+
 		ret = ust_app_stop_trace_all(usess);
 		if (ret < 0) {
 			ret = LTTNG_ERR_UST_STOP_FAIL;
@@ -3638,7 +3809,7 @@ enum lttng_error_code cmd_create_session(struct command_ctx *cmd_ctx,
 		goto error;
 	}
 
-	ret = lttcomm_recv_unix_sock(sock, payload.data, payload.size);
+	ret = command_ctx_recv_payload(cmd_ctx, sock, payload.data, payload.size);
 	if (ret <= 0) {
 		ERR("Reception of session descriptor failed, aborting.");
 		ret_code = LTTNG_ERR_SESSION_FAIL;
@@ -3816,6 +3987,14 @@ int cmd_destroy_session(const ltt_session::locked_ref& session, int *sock_fd)
 		}
 	}
 
+	if (session->app_sync_timer_enabled) {
+		if (timer_session_app_sync_timer_stop(session)) {
+			ERR("Failed to stop the \"application synchronization\" timer of session %s",
+			    session->name);
+			destruction_last_error = LTTNG_ERR_TIMER_STOP_ERROR;
+		}
+	}
+
 	if (session->rotate_size) {
 		try {
 			the_rotation_thread_handle->unsubscribe_session_consumed_size_rotation(
@@ -4236,10 +4415,16 @@ end:
 
 /*
  * Command LTTNG_LIST_EVENTS processed by the client thread.
+ *
+ * Only the events in the window [offset, offset + max_count) of the
+ * listing are serialized; a `max_count` of 0 lists all the events
+ * starting at `offset`.
  */
 enum lttng_error_code cmd_list_events(enum lttng_domain_type domain,
 				      const ltt_session::locked_ref& session,
 				      char *channel_name,
+				      uint32_t offset,
+				      uint32_t max_count,
 				      struct lttng_payload *reply_payload)
 {
 	int buffer_resize_ret;
@@ -4247,6 +4432,7 @@ enum lttng_error_code cmd_list_events(enum lttng_domain_type domain,
 	struct lttcomm_list_command_header reply_command_header = {};
 	size_t reply_command_header_offset;
 	unsigned int nb_events = 0;
+	list_window window(offset, max_count);
 
 	assert(reply_payload);
 
@@ -4263,8 +4449,11 @@ enum lttng_error_code cmd_list_events(enum lttng_domain_type domain,
 	switch (domain) {
 	case LTTNG_DOMAIN_KERNEL:
 		if (session->kernel_session != nullptr) {
-			ret_code = list_lttng_kernel_events(
-				channel_name, session->kernel_session, reply_payload, &nb_events);
+			ret_code = list_lttng_kernel_events(channel_name,
+							    session->kernel_session,
+							    window,
+							    reply_payload,
+							    &nb_events);
 		}
 
 		break;
@@ -4274,6 +4463,7 @@ enum lttng_error_code cmd_list_events(enum lttng_domain_type domain,
 			ret_code =
 				list_lttng_ust_global_events(channel_name,
 							     &session->ust_session->domain_global,
+							     window,
 							     reply_payload,
 							     &nb_events);
 		}
@@ -4291,7 +4481,7 @@ enum lttng_error_code cmd_list_events(enum lttng_domain_type domain,
 				     *session->ust_session->agents->ht)) {
 				if (agt->domain == domain) {
 					ret_code = list_lttng_agent_events(
-						agt, reply_payload, &nb_events);
+						agt, window, reply_payload, &nb_events);
 					break;
 				}
 			}
@@ -4321,16 +4511,21 @@ end:
  * Using the session list, filled a lttng_session array to send back to the
  * client for session listing.
  *
- * The session list lock MUST be acquired before calling this function.
+ * The session list lock MUST be acquired, in shared or exclusive mode, before
+ * calling this function and `session_refs` must have been sampled using
+ * session_get_list_references() while holding it.
+ *
+ * Returns the number of sessions listed, which can be lower than
+ * `session_count` if sessions were destroyed concurrently.
  */
-void cmd_list_lttng_sessions(struct lttng_session *sessions,
-			     size_t session_count,
-			     uid_t uid,
-			     gid_t gid)
+unsigned int cmd_list_lttng_sessions(struct lttng_session *sessions,
+				     size_t session_count,
+				     const std::vector<ltt_session::ref>& session_refs,
+				     uid_t uid,
+				     gid_t gid)
 {
 	int ret;
 	unsigned int i = 0;
-	struct ltt_session_list *list = session_get_list();
 	struct lttng_session_extended *extended = (typeof(extended)) (&sessions[session_count]);
 
 	DBG("Getting all available session for UID %d GID %d", uid, gid);
@@ -4338,12 +4533,15 @@ void cmd_list_lttng_sessions(struct lttng_session *sessions,
 	 * Iterate over session list and append data after the control struct in
 	 * the buffer.
 	 */
-	for (auto raw_session_ptr :
-	     lttng::urcu::list_iteration_adapter<ltt_session, &ltt_session::list>(list->head)) {
-		auto session = [raw_session_ptr]() {
-			session_get(raw_session_ptr);
-			raw_session_ptr->lock();
-			return ltt_session::make_locked_ref(*raw_session_ptr);
+	for (const auto& session_ref : session_refs) {
+		if (i == session_count) {
+			break;
+		}
+
+		auto session = [&session_ref]() {
+			session_get(&session_ref.get());
+			session_ref->lock();
+			return ltt_session::make_locked_ref(session_ref.get());
 		}();
 
 		/*
@@ -4382,6 +4580,8 @@ void cmd_list_lttng_sessions(struct lttng_session *sessions,
 		strncpy(extended[i].shm_path.value, session->shm_path, LTTNG_PATH_MAX);
 		i++;
 	}
+
+	return i;
 }
 
 /*
@@ -5685,6 +5885,9 @@ int cmd_snapshot_record(const ltt_session::locked_ref& session,
 		goto error;
 	}
 
+	/* The changes made up to the snapshot are part of it. */
+	apply_pending_ust_app_changes(session);
+
 	/* Use temporary output for the session. */
 	if (*output->ctrl_url != '\0') {
 		tmp_output = snapshot_output_alloc();
@@ -5872,6 +6075,9 @@ int cmd_rotate_session(const ltt_session::locked_ref& session,
 		goto end;
 	}
 
+	/* The changes made up to the rotation are part of the archived chunk. */
+	apply_pending_ust_app_changes(session);
+
 	if (session->active) {
 		new_trace_chunk =
 			session_create_new_trace_chunk(session, nullptr, nullptr, nullptr);
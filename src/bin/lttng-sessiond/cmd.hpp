@@ -14,6 +14,7 @@
 #include "lttng/tracker.h"
 #include "session.hpp"
 #include "snapshot-output.hpp"
+#include "tracker.hpp"
 
 #include <common/ctl/memory.hpp>
 #include <common/tracker.hpp>
@@ -79,6 +80,14 @@ cmd_process_attr_tracker_inclusion_set_remove_value(const ltt_session::locked_re
 						    enum lttng_domain_type domain,
 						    enum lttng_process_attr process_attr,
 						    const struct process_attr_value *value);
+enum lttng_error_code cmd_process_attr_tracker_inclusion_set_update(
+	const ltt_session::locked_ref& session,
+	enum lttng_domain_type domain,
+	enum lttng_process_attr process_attr,
+	enum process_attr_tracker_inclusion_set_operation operation,
+	const struct lttng_process_attr_values *values,
+	struct lttng_process_attr_values **added_values,
+	struct lttng_process_attr_values **removed_values);
 enum lttng_error_code
 cmd_process_attr_tracker_get_inclusion_set(const ltt_session::locked_ref& session,
 					   enum lttng_domain_type domain,
@@ -130,11 +139,17 @@ ssize_t cmd_list_domains(const ltt_session::locked_ref& session, struct lttng_do
 enum lttng_error_code cmd_list_events(enum lttng_domain_type domain,
 				      const ltt_session::locked_ref& session,
 				      char *channel_name,
+				      uint32_t offset,
+				      uint32_t max_count,
 				      struct lttng_payload *payload);
 enum lttng_error_code cmd_list_channels(enum lttng_domain_type domain,
 					const ltt_session::locked_ref& session,
 					struct lttng_payload *payload);
-void cmd_list_lttng_sessions(lttng_session *sessions, size_t session_count, uid_t uid, gid_t gid);
+unsigned int cmd_list_lttng_sessions(lttng_session *sessions,
+				     size_t session_count,
+				     const std::vector<ltt_session::ref>& session_refs,
+				     uid_t uid,
+				     gid_t gid);
 enum lttng_error_code cmd_list_tracepoint_fields(enum lttng_domain_type domain,
 						 struct lttng_payload *reply);
 enum lttng_error_code cmd_list_tracepoints(enum lttng_domain_type domain,
@@ -307,6 +307,70 @@ void consumer_output_send_destroy_relayd(struct consumer_output *consumer)
 	}
 }
 
+/*
+ * Make a consumer socket use the command sockets of a consumer daemon in turn.
+ * The consumer socket remains indexed by the main command socket in its
+ * consumer output.
+ */
+static void assign_command_socket(struct consumer_data *data, struct consumer_socket *socket)
+{
+	unsigned int index;
+
+	pthread_mutex_lock(&data->lock);
+	index = data->next_cmd_sock_index;
+	data->next_cmd_sock_index = (index + 1) % DEFAULT_CONSUMERD_COMMAND_SOCKET_COUNT;
+	pthread_mutex_unlock(&data->lock);
+
+	/* Index 0 is the main command socket. */
+	if (index == 0 || data->additional_cmd_socks[index - 1] < 0) {
+		return;
+	}
+
+	socket->fd_ptr = &data->additional_cmd_socks[index - 1];
+	socket->lock = &data->additional_cmd_sock_locks[index - 1];
+}
+
+/*
+ * Connect the additional command sockets of a consumer daemon. Failing to
+ * connect one is not fatal: the sessions then use the other command sockets.
+ */
+void consumer_connect_additional_command_sockets(struct consumer_data *data)
+{
+	LTTNG_ASSERT(data);
+
+	for (auto& sock : data->additional_cmd_socks) {
+		sock = lttcomm_connect_unix_sock(data->cmd_unix_sock_path);
+		if (sock < 0) {
+			WARN("Failed to connect additional consumer command socket: path = `%s`",
+			     data->cmd_unix_sock_path);
+			sock = -1;
+			continue;
+		}
+
+		DBG("Consumer additional command socket ready (fd: %d)", sock);
+	}
+}
+
+/*
+ * Close the additional command sockets of a consumer daemon.
+ */
+void consumer_close_additional_command_sockets(struct consumer_data *data)
+{
+	LTTNG_ASSERT(data);
+
+	for (size_t i = 0; i < data->additional_cmd_socks.size(); i++) {
+		pthread_mutex_lock(&data->additional_cmd_sock_locks[i]);
+		if (data->additional_cmd_socks[i] >= 0) {
+			if (close(data->additional_cmd_socks[i])) {
+				PERROR("close additional consumer command socket");
+			}
+
+			data->additional_cmd_socks[i] = -1;
+		}
+		pthread_mutex_unlock(&data->additional_cmd_sock_locks[i]);
+	}
+}
+
 /*
  * From a consumer_data structure, allocate and add a consumer socket to the
  * consumer output.
@@ -340,6 +404,7 @@ int consumer_create_socket(struct consumer_data *data, struct consumer_output *o
 
 		socket->registered = 0;
 		socket->lock = &data->lock;
+		assign_command_socket(data, socket);
 		consumer_add_socket(socket, output);
 	}
 
@@ -635,8 +700,12 @@ int consumer_copy_sockets(struct consumer_output *dst, struct consumer_output *s
 	     lttng::urcu::lfht_iteration_adapter<consumer_socket,
 						 decltype(consumer_socket::node),
 						 &consumer_socket::node>(*src->socks->ht)) {
-		/* Ignore socket that are already there. */
-		auto *copy_sock = consumer_find_socket(*socket->fd_ptr, dst);
+		/*
+		 * Ignore socket that are already there. Sockets are indexed by
+		 * the main command socket of their consumer daemon, which may
+		 * not be the command socket they use.
+		 */
+		auto *copy_sock = consumer_find_socket((int) socket->node.key, dst);
 		if (copy_sock) {
 			continue;
 		}
@@ -648,6 +717,8 @@ int consumer_copy_sockets(struct consumer_output *dst, struct consumer_output *s
 			goto error;
 		}
 
+		lttng_ht_node_init_ulong(&copy_sock->node, socket->node.key);
+
 		copy_sock->registered = socket->registered;
 		/*
 		 * This is valid because this lock is shared accross all consumer
@@ -1662,6 +1733,51 @@ end:
 	return ret;
 }
 
+/*
+ * Ask the consumer the drain statistics of its data thread.
+ */
+int consumer_get_drain_statistics(struct consumer_socket *socket,
+				  struct lttcomm_consumer_drain_statistics *stats)
+{
+	int ret;
+	struct lttcomm_consumer_msg msg;
+
+	LTTNG_ASSERT(socket);
+	LTTNG_ASSERT(stats);
+
+	DBG3("Consumer get drain statistics");
+
+	memset(&msg, 0, sizeof(msg));
+	msg.cmd_type = LTTNG_CONSUMER_GET_DRAIN_STATISTICS;
+
+	pthread_mutex_lock(socket->lock);
+	ret = consumer_socket_send(socket, &msg, sizeof(msg));
+	if (ret < 0) {
+		goto end_unlock;
+	}
+
+	/*
+	 * No need for a recv reply status because the answer to the
+	 * command is the reply status message.
+	 */
+	ret = consumer_socket_recv(socket, stats, sizeof(*stats));
+	if (ret < 0) {
+		ERR("get drain statistics");
+		goto end_unlock;
+	}
+
+	ret = 0;
+	DBG("Consumer drain statistics: wake-ups = %" PRIu64 ", sub-buffers = %" PRIu64
+	    ", bytes = %" PRIu64,
+	    stats->wakeups,
+	    stats->packets,
+	    stats->bytes);
+
+end_unlock:
+	pthread_mutex_unlock(socket->lock);
+	return ret;
+}
+
 /*
  * Ask the consumer to rotate a channel.
  *
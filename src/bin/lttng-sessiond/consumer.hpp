@@ -12,11 +12,14 @@
 #include "snapshot.hpp"
 
 #include <common/consumer/consumer.hpp>
+#include <common/defaults.hpp>
 #include <common/hashtable/hashtable.hpp>
 
 #include <lttng/lttng.h>
 
 #include <algorithm>
+#include <array>
+#include <pthread.h>
 #include <urcu/ref.h>
 
 struct snapshot;
@@ -74,6 +77,10 @@ struct consumer_socket {
 struct consumer_data {
 	explicit consumer_data(lttng_consumer_type type_) : type(type_)
 	{
+		additional_cmd_socks.fill(-1);
+		for (auto& lock : additional_cmd_sock_locks) {
+			pthread_mutex_init(&lock, nullptr);
+		}
 	}
 
 	enum lttng_consumer_type type;
@@ -109,6 +116,20 @@ struct consumer_data {
 	 * operations.
 	 */
 	pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+	/*
+	 * Additional command sockets, connected after the metadata socket. The
+	 * consumer daemon handles the commands of each command socket
+	 * concurrently. A session sends all its commands on a single command
+	 * socket, chosen when the session's consumer output is created, so they
+	 * are handled in order. Each additional socket has its own lock, which
+	 * has the same purposes as `lock` for `cmd_sock`.
+	 */
+	std::array<int, DEFAULT_CONSUMERD_COMMAND_SOCKET_COUNT - 1> additional_cmd_socks;
+	std::array<pthread_mutex_t, DEFAULT_CONSUMERD_COMMAND_SOCKET_COUNT - 1>
+		additional_cmd_sock_locks;
+	/* Index of the command socket used by the next session. Protected by `lock`. */
+	unsigned int next_cmd_sock_index = 0;
 };
 
 /*
@@ -234,6 +255,8 @@ int consumer_recv_status_channel(struct consumer_socket *sock,
 				 unsigned int *stream_count);
 void consumer_output_send_destroy_relayd(struct consumer_output *consumer);
 int consumer_create_socket(struct consumer_data *data, struct consumer_output *output);
+void consumer_connect_additional_command_sockets(struct consumer_data *data);
+void consumer_close_additional_command_sockets(struct consumer_data *data);
 
 void consumer_init_ask_channel_comm_msg(struct lttcomm_consumer_msg *msg,
 					uint64_t subbuf_size,
@@ -306,6 +329,8 @@ int consumer_get_lost_packets(uint64_t session_id,
 			      uint64_t channel_key,
 			      struct consumer_output *consumer,
 			      uint64_t *lost);
+int consumer_get_drain_statistics(struct consumer_socket *socket,
+				  struct lttcomm_consumer_drain_statistics *stats);
 
 /* Snapshot command. */
 enum lttng_error_code consumer_snapshot_channel(struct consumer_socket *socket,
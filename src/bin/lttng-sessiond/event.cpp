@@ -209,7 +209,7 @@ int event_ust_enable_tracepoint(struct ltt_ust_session *usess,
 		add_unique_ust_event(uchan->events, uevent);
 	}
 
-	if (!usess->active) {
+	if (!usess->active || ust_app_defer_session_update(usess)) {
 		goto end;
 	}
 
@@ -292,7 +292,7 @@ int event_ust_disable_tracepoint(struct ltt_ust_session *usess,
 		uevent->enabled = false;
 		DBG2("Event UST %s disabled in channel %s", uevent->attr.name, uchan->name);
 
-		if (!usess->active) {
+		if (!usess->active || ust_app_defer_session_update(usess)) {
 			goto next;
 		}
 		ret = ust_app_disable_event_glb(usess, uchan, uevent);
@@ -794,7 +794,7 @@ static int event_agent_disable_one(struct ltt_ust_session *usess,
 	/* If the agent event exists, it must be available on the UST side. */
 	LTTNG_ASSERT(uevent);
 
-	if (usess->active) {
+	if (usess->active && !ust_app_defer_session_update(usess)) {
 		ret = ust_app_disable_event_glb(usess, uchan, uevent);
 		if (ret < 0 && ret != -LTTNG_UST_ERR_EXIST) {
 			ret = LTTNG_ERR_UST_DISABLE_FAIL;
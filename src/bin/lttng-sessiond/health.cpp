@@ -6,6 +6,7 @@
  *
  */
 
+#include "client.hpp"
 #include "health-sessiond.hpp"
 #include "lttng-sessiond.hpp"
 #include "thread.hpp"
@@ -49,6 +50,31 @@ static void cleanup_health_management_thread(void *data)
 	free(notifiers);
 }
 
+static void send_client_command_metrics(int sock)
+{
+	struct client_command_metrics metrics;
+	struct health_comm_client_command_metrics_reply reply = {};
+
+	client_get_command_metrics(&metrics);
+	reply.worker_count = metrics.worker_count;
+	reply.queued_count = metrics.queued_count;
+	reply.active_count = metrics.active_count;
+	reply.completed_count = metrics.completed_count;
+	reply.total_queue_wait_us = metrics.total_queue_wait_us;
+	reply.max_queue_wait_us = metrics.max_queue_wait_us;
+	reply.total_processing_us = metrics.total_processing_us;
+	reply.max_processing_us = metrics.max_processing_us;
+
+	DBG2("Client command metrics: queued = %u, active = %u, completed = %" PRIu64,
+	     reply.queued_count,
+	     reply.active_count,
+	     reply.completed_count);
+
+	if (lttcomm_send_unix_sock(sock, (void *) &reply, sizeof(reply)) < 0) {
+		ERR("Failed to send client command metrics back to client");
+	}
+}
+
 /*
  * Thread managing health check socket.
  */
@@ -201,6 +227,11 @@ static void *thread_manage_health(void *data)
 
 		rcu_thread_online();
 
+		if (msg.cmd == HEALTH_CMD_GET_CLIENT_COMMAND_METRICS) {
+			send_client_command_metrics(new_sock);
+			goto end_transmission;
+		}
+
 		memset(&reply, 0, sizeof(reply));
 		for (i = 0; i < NR_HEALTH_SESSIOND_TYPES; i++) {
 			/*
@@ -219,6 +250,7 @@ static void *thread_manage_health(void *data)
 			ERR("Failed to send health data back to client");
 		}
 
+	end_transmission:
 		/* End of transmission */
 		ret = close(new_sock);
 		if (ret) {
@@ -49,6 +49,7 @@
 #include <string.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <vector>
 
 namespace {
 /*
@@ -1235,6 +1236,184 @@ end:
 	return ret_code;
 }
 
+static int kernel_track_integral_value(struct ltt_kernel_session *session,
+				       enum lttng_process_attr process_attr,
+				       int integral_value)
+{
+	if (process_attr == LTTNG_PROCESS_ATTR_PROCESS_ID) {
+		return kernctl_track_pid(session->fd, integral_value);
+	}
+
+	return kernctl_track_id(session->fd, process_attr, integral_value);
+}
+
+static int kernel_untrack_integral_value(struct ltt_kernel_session *session,
+					 enum lttng_process_attr process_attr,
+					 int integral_value)
+{
+	if (process_attr == LTTNG_PROCESS_ATTR_PROCESS_ID) {
+		return kernctl_untrack_pid(session->fd, integral_value);
+	}
+
+	return kernctl_untrack_id(session->fd, process_attr, integral_value);
+}
+
+/*
+ * Apply an update to the inclusion set of a process attribute tracker. Only the
+ * values that are effectively added to or removed from the inclusion set are
+ * pushed to the kernel tracer.
+ *
+ * On error, the inclusion set and the kernel tracer's state are rolled back.
+ */
+enum lttng_error_code
+kernel_process_attr_tracker_inclusion_set_update(
+	struct ltt_kernel_session *session,
+	enum lttng_process_attr process_attr,
+	enum process_attr_tracker_inclusion_set_operation operation,
+	const struct lttng_process_attr_values *values,
+	struct lttng_process_attr_values **_added_values,
+	struct lttng_process_attr_values **_removed_values)
+{
+	int ret = 0;
+	enum lttng_error_code ret_code;
+	struct process_attr_tracker *tracker;
+	enum process_attr_tracker_status status;
+	struct lttng_process_attr_values *added_values = nullptr;
+	struct lttng_process_attr_values *removed_values = nullptr;
+	std::vector<int> ids_to_track, ids_to_untrack, tracked_ids, untracked_ids;
+
+	tracker = _kernel_get_process_attr_tracker(session, process_attr);
+	if (!tracker) {
+		ret_code = LTTNG_ERR_INVALID;
+		goto end;
+	}
+
+	status = process_attr_tracker_inclusion_set_update(
+		tracker, operation, values, &added_values, &removed_values);
+	switch (status) {
+	case PROCESS_ATTR_TRACKER_STATUS_OK:
+		break;
+	case PROCESS_ATTR_TRACKER_STATUS_INVALID_TRACKING_POLICY:
+		ret_code = LTTNG_ERR_PROCESS_ATTR_TRACKER_INVALID_TRACKING_POLICY;
+		goto end;
+	case PROCESS_ATTR_TRACKER_STATUS_ERROR:
+		ret_code = LTTNG_ERR_NOMEM;
+		goto end;
+	default:
+		ret_code = LTTNG_ERR_UNK;
+		goto end;
+	}
+
+	ret_code = process_attr_values_get_integral_values(
+		process_attr, removed_values, ids_to_untrack);
+	if (ret_code != LTTNG_OK) {
+		goto error;
+	}
+
+	ret_code =
+		process_attr_values_get_integral_values(process_attr, added_values, ids_to_track);
+	if (ret_code != LTTNG_OK) {
+		goto error;
+	}
+
+	try {
+		tracked_ids.reserve(ids_to_track.size());
+		untracked_ids.reserve(ids_to_untrack.size());
+	} catch (const std::bad_alloc&) {
+		ret_code = LTTNG_ERR_NOMEM;
+		goto error;
+	}
+
+	DBG("Kernel update of %s tracker for session id %" PRIu64
+	    ": tracking %zu values, untracking %zu values",
+	    lttng_process_attr_to_string(process_attr),
+	    session->id,
+	    ids_to_track.size(),
+	    ids_to_untrack.size());
+
+	/*
+	 * A value can be already (un)tracked by the kernel tracer when a user or
+	 * group name resolves to an ID that is also part of the inclusion set.
+	 */
+	for (const auto id : ids_to_untrack) {
+		ret = kernel_untrack_integral_value(session, process_attr, id);
+		if (ret == -ENOENT) {
+			continue;
+		} else if (ret) {
+			goto error_kernctl;
+		}
+
+		untracked_ids.emplace_back(id);
+	}
+
+	for (const auto id : ids_to_track) {
+		ret = kernel_track_integral_value(session, process_attr, id);
+		if (ret == -EEXIST) {
+			continue;
+		} else if (ret) {
+			goto error_kernctl;
+		}
+
+		tracked_ids.emplace_back(id);
+	}
+
+	if (_added_values) {
+		*_added_values = added_values;
+		added_values = nullptr;
+	}
+
+	if (_removed_values) {
+		*_removed_values = removed_values;
+		removed_values = nullptr;
+	}
+
+	ret_code = LTTNG_OK;
+	goto end;
+
+error_kernctl:
+	kernel_wait_quiescent();
+
+	/* kern-ctl error handling */
+	switch (-ret) {
+	case EINVAL:
+		ret_code = LTTNG_ERR_INVALID;
+		break;
+	case ENOMEM:
+		ret_code = LTTNG_ERR_NOMEM;
+		break;
+	default:
+		ret_code = LTTNG_ERR_UNK;
+		break;
+	}
+
+	for (const auto id : tracked_ids) {
+		if (kernel_untrack_integral_value(session, process_attr, id)) {
+			ERR("Failed to roll-back the tracking of kernel %s process attribute %d while handling a kern-ctl error",
+			    lttng_process_attr_to_string(process_attr),
+			    id);
+		}
+	}
+
+	for (const auto id : untracked_ids) {
+		if (kernel_track_integral_value(session, process_attr, id)) {
+			ERR("Failed to roll-back the untracking of kernel %s process attribute %d while handling a kern-ctl error",
+			    lttng_process_attr_to_string(process_attr),
+			    id);
+		}
+	}
+error:
+	status = process_attr_tracker_inclusion_set_revert_update(
+		tracker, added_values, removed_values);
+	if (status != PROCESS_ATTR_TRACKER_STATUS_OK) {
+		ERR("Failed to roll-back the update of the kernel %s process attribute tracker's inclusion set",
+		    lttng_process_attr_to_string(process_attr));
+	}
+end:
+	lttng_process_attr_values_destroy(added_values);
+	lttng_process_attr_values_destroy(removed_values);
+	return ret_code;
+}
+
 /*
  * Create kernel metadata, open from the kernel tracer and add it to the
  * kernel session.
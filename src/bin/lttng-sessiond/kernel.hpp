@@ -13,6 +13,7 @@
 #include "session.hpp"
 #include "snapshot.hpp"
 #include "trace-kernel.hpp"
+#include "tracker.hpp"
 
 /*
  * Default size for the event list when kernel_list_events is called. This size
@@ -46,6 +47,14 @@ enum lttng_error_code
 kernel_process_attr_tracker_inclusion_set_remove_value(struct ltt_kernel_session *session,
 						       enum lttng_process_attr process_attr,
 						       const struct process_attr_value *value);
+enum lttng_error_code
+kernel_process_attr_tracker_inclusion_set_update(
+	struct ltt_kernel_session *session,
+	enum lttng_process_attr process_attr,
+	enum process_attr_tracker_inclusion_set_operation operation,
+	const struct lttng_process_attr_values *values,
+	struct lttng_process_attr_values **added_values,
+	struct lttng_process_attr_values **removed_values);
 const struct process_attr_tracker *
 kernel_get_process_attr_tracker(struct ltt_kernel_session *session,
 				enum lttng_process_attr process_attr);
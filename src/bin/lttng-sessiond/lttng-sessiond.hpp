@@ -82,8 +82,27 @@ struct command_ctx {
 	/* Reply content, starts with an lttcomm_lttng_msg header. */
 	struct lttng_payload reply_payload;
 	lttng_sock_cred creds;
+	/*
+	 * Payload of a command received with the compact framing, received
+	 * before its processing. Null for the commands of the legacy framing.
+	 */
+	const struct lttng_payload *command_payload;
+	/* Bytes and fds of `command_payload` already received by the command. */
+	size_t command_payload_position;
+	size_t command_payload_fd_position;
 };
 
+/*
+ * Receive part of the payload of the command being processed, either from the
+ * client's socket or from the payload received ahead of the processing of the
+ * command. Both return like their lttcomm_*_unix_sock() counterparts.
+ */
+ssize_t command_ctx_recv_payload(struct command_ctx *cmd_ctx, int sock, void *buf, size_t len);
+ssize_t command_ctx_recv_payload_fds(struct command_ctx *cmd_ctx,
+				     int sock,
+				     size_t nb_fd,
+				     struct lttng_payload *payload);
+
 struct ust_command {
 	int sock;
 	struct ust_register_msg reg_msg;
@@ -229,6 +229,9 @@ static void close_consumer_sockets()
 			PERROR("UST consumerd64 cmd_sock close");
 		}
 	}
+	consumer_close_additional_command_sockets(&the_kconsumer_data);
+	consumer_close_additional_command_sockets(&the_ustconsumer32_data);
+	consumer_close_additional_command_sockets(&the_ustconsumer64_data);
 	if (the_kconsumer_data.channel_monitor_pipe >= 0) {
 		ret = close(the_kconsumer_data.channel_monitor_pipe);
 		if (ret < 0) {
@@ -207,6 +207,8 @@ static void *thread_consumer_management(void *data)
 	DBG("Consumer command socket ready (fd: %d)", consumer_data->cmd_sock);
 	DBG("Consumer metadata socket ready (fd: %d)", consumer_data->metadata_fd);
 
+	consumer_connect_additional_command_sockets(consumer_data);
+
 	/*
 	 * Remove the consumerd error sock since we've established a connection.
 	 */
@@ -378,6 +380,7 @@ error:
 		}
 		consumer_data->cmd_sock = -1;
 	}
+	consumer_close_additional_command_sockets(consumer_data);
 	if (consumer_data->metadata_sock.fd_ptr && *consumer_data->metadata_sock.fd_ptr >= 0) {
 		ret = close(*consumer_data->metadata_sock.fd_ptr);
 		if (ret) {
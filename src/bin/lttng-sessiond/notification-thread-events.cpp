@@ -42,12 +42,15 @@
 #include <lttng/notification/notification-internal.hpp>
 #include <lttng/trigger/trigger-internal.hpp>
 
+#include <algorithm>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <new>
 #include <time.h>
 #include <unistd.h>
 #include <urcu.h>
 #include <urcu/rculfhash.h>
+#include <vector>
 
 #define CLIENT_POLL_EVENTS_IN	  (LPOLLIN | LPOLLRDHUP)
 #define CLIENT_POLL_EVENTS_IN_OUT (CLIENT_POLL_EVENTS_IN | LPOLLOUT)
@@ -62,10 +65,22 @@ enum lttng_object_type {
 	LTTNG_OBJECT_TYPE_SESSION,
 };
 
+namespace {
+class channel_threshold_index;
+} /* namespace */
+
 struct lttng_channel_trigger_list {
 	struct channel_key channel_key;
 	/* List of struct lttng_trigger_list_element. */
 	struct cds_list_head list;
+	/*
+	 * Index of the thresholds of the triggers in `list`, built on the first
+	 * sample following a change of the list. NULL if the index could not be
+	 * built, in which case all triggers are evaluated.
+	 */
+	channel_threshold_index *threshold_index;
+	/* Set when `list` changes, causing the index to be rebuilt. */
+	bool threshold_index_stale;
 	/* Node in the channel_triggers_ht */
 	struct cds_lfht_node channel_triggers_ht_node;
 	/* call_rcu delayed reclaim. */
@@ -138,6 +153,144 @@ struct channel_state_sample {
 	/* call_rcu delayed reclaim. */
 	struct rcu_head rcu_node;
 };
+
+/*
+ * Threshold, in bytes, of a buffer usage condition applied to a channel of a
+ * given capacity.
+ */
+uint64_t get_buffer_usage_condition_threshold(const struct lttng_condition *condition,
+					      uint64_t buffer_capacity)
+{
+	const struct lttng_condition_buffer_usage *use_condition =
+		lttng::utils::container_of(condition, &lttng_condition_buffer_usage::parent);
+
+	if (use_condition->threshold_bytes.set) {
+		return use_condition->threshold_bytes.value;
+	}
+
+	/* Threshold was expressed as a ratio. */
+	return (uint64_t) (use_condition->threshold_ratio.value * (double) buffer_capacity);
+}
+
+/*
+ * Buffer usage triggers of a channel, sorted by threshold.
+ *
+ * Buffer usage conditions are edge-triggered on the highest usage of the
+ * channel's streams: a "high" condition is satisfied when the usage rises to
+ * or above its threshold and a "low" condition when it falls to or below it.
+ * Hence, the only triggers that can fire on a sample have a threshold between
+ * the previous and latest usage, which are found by binary search rather
+ * than by evaluating every trigger bound to the channel.
+ */
+class channel_threshold_index {
+public:
+	struct threshold_entry {
+		uint64_t threshold;
+		/* Position of the trigger in the channel's trigger list. */
+		unsigned int position;
+		struct lttng_trigger *trigger;
+	};
+
+	channel_threshold_index(const struct cds_list_head& trigger_list, uint64_t channel_capacity)
+	{
+		const struct lttng_trigger_list_element *element;
+		unsigned int position = 0;
+
+		cds_list_for_each_entry (element, &trigger_list, node) {
+			const auto *condition = lttng_trigger_get_const_condition(element->trigger);
+			const threshold_entry entry = {
+				get_buffer_usage_condition_threshold(condition, channel_capacity),
+				position++,
+				element->trigger,
+			};
+
+			if (lttng_condition_get_type(condition) ==
+			    LTTNG_CONDITION_TYPE_BUFFER_USAGE_LOW) {
+				_low_thresholds.emplace_back(entry);
+			} else {
+				_high_thresholds.emplace_back(entry);
+			}
+		}
+
+		std::sort(_low_thresholds.begin(), _low_thresholds.end(), _threshold_less);
+		std::sort(_high_thresholds.begin(), _high_thresholds.end(), _threshold_less);
+
+		/* Sampling never allocates. */
+		_candidates.reserve(position);
+	}
+
+	/*
+	 * Get the triggers which can fire following a change of the highest
+	 * usage of the channel from `previous_usage` (if available) to
+	 * `latest_usage`, in the order in which they appear in the channel's
+	 * trigger list.
+	 */
+	const std::vector<const threshold_entry *>&
+	candidates(const uint64_t *previous_usage, uint64_t latest_usage) noexcept
+	{
+		_candidates.clear();
+
+		/* High conditions with a threshold in (previous, latest]. */
+		auto high_begin = _high_thresholds.cbegin();
+		if (previous_usage) {
+			high_begin = _upper_bound(_high_thresholds, *previous_usage);
+		}
+
+		const auto high_end = _upper_bound(_high_thresholds, latest_usage);
+		for (auto it = high_begin; it < high_end; ++it) {
+			_candidates.emplace_back(&*it);
+		}
+
+		/* Low conditions with a threshold in [latest, previous). */
+		const auto low_begin = _lower_bound(_low_thresholds, latest_usage);
+		auto low_end = _low_thresholds.cend();
+		if (previous_usage) {
+			low_end = std::max(low_begin,
+					   _lower_bound(_low_thresholds, *previous_usage));
+		}
+
+		for (auto it = low_begin; it < low_end; ++it) {
+			_candidates.emplace_back(&*it);
+		}
+
+		std::sort(_candidates.begin(),
+			  _candidates.end(),
+			  [](const threshold_entry *a, const threshold_entry *b) {
+				  return a->position < b->position;
+			  });
+		return _candidates;
+	}
+
+private:
+
+	static bool _threshold_less(const threshold_entry& a, const threshold_entry& b) noexcept
+	{
+		return a.threshold < b.threshold ||
+			(a.threshold == b.threshold && a.position < b.position);
+	}
+
+	static std::vector<threshold_entry>::const_iterator
+	_lower_bound(const std::vector<threshold_entry>& entries, uint64_t usage) noexcept
+	{
+		return std::partition_point(
+			entries.cbegin(), entries.cend(), [usage](const threshold_entry& entry) {
+				return entry.threshold < usage;
+			});
+	}
+
+	static std::vector<threshold_entry>::const_iterator
+	_upper_bound(const std::vector<threshold_entry>& entries, uint64_t usage) noexcept
+	{
+		return std::partition_point(
+			entries.cbegin(), entries.cend(), [usage](const threshold_entry& entry) {
+				return entry.threshold <= usage;
+			});
+	}
+
+	std::vector<threshold_entry> _low_thresholds;
+	std::vector<threshold_entry> _high_thresholds;
+	std::vector<const threshold_entry *> _candidates;
+};
 } /* namespace */
 
 static unsigned long hash_channel_key(struct channel_key *key);
@@ -1743,6 +1896,7 @@ static int handle_notification_thread_command_add_channel(struct notification_th
 	CDS_INIT_LIST_HEAD(&channel_trigger_list->list);
 	cds_lfht_node_init(&channel_trigger_list->channel_triggers_ht_node);
 	cds_list_splice(&trigger_list, &channel_trigger_list->list);
+	channel_trigger_list->threshold_index_stale = true;
 
 	/* Add channel to the channel_ht which owns the channel_infos. */
 	cds_lfht_add(state->channels_ht,
@@ -1834,7 +1988,10 @@ end:
 
 static void free_channel_trigger_list_rcu(struct rcu_head *node)
 {
-	free(caa_container_of(node, struct lttng_channel_trigger_list, rcu_node));
+	auto *trigger_list = caa_container_of(node, struct lttng_channel_trigger_list, rcu_node);
+
+	delete trigger_list->threshold_index;
+	free(trigger_list);
 }
 
 static void free_channel_state_sample_rcu(struct rcu_head *node)
@@ -2485,6 +2642,7 @@ static int bind_trigger_to_matching_channels(struct lttng_trigger *trigger,
 		CDS_INIT_LIST_HEAD(&trigger_list_element->node);
 		trigger_list_element->trigger = trigger;
 		cds_list_add(&trigger_list_element->node, &trigger_list->list);
+		trigger_list->threshold_index_stale = true;
 		DBG("Newly registered trigger bound to channel \"%s\"", channel->name);
 	}
 end:
@@ -3077,6 +3235,7 @@ handle_notification_thread_command_unregister_trigger(struct notification_thread
 				DBG("Removed trigger from channel_triggers_ht");
 				cds_list_del(&trigger_element->node);
 				free(trigger_element);
+				trigger_list->threshold_index_stale = true;
 				/* A trigger can only appear once per channel */
 				break;
 			}
@@ -4174,29 +4333,9 @@ static bool evaluate_buffer_usage_condition(const struct lttng_condition *condit
 					    uint64_t buffer_capacity)
 {
 	bool result = false;
-	uint64_t threshold;
+	const uint64_t threshold =
+		get_buffer_usage_condition_threshold(condition, buffer_capacity);
 	enum lttng_condition_type condition_type;
-	const struct lttng_condition_buffer_usage *use_condition =
-		lttng::utils::container_of(condition, &lttng_condition_buffer_usage::parent);
-
-	if (use_condition->threshold_bytes.set) {
-		threshold = use_condition->threshold_bytes.value;
-	} else {
-		/*
-		 * Threshold was expressed as a ratio.
-		 *
-		 * TODO the threshold (in bytes) of conditions expressed
-		 * as a ratio of total buffer size could be cached to
-		 * forego this double-multiplication or it could be performed
-		 * as fixed-point math.
-		 *
-		 * Note that caching should accommodates the case where the
-		 * condition applies to multiple channels (i.e. don't assume
-		 * that all channels matching my_chann* have the same size...)
-		 */
-		threshold = (uint64_t) (use_condition->threshold_ratio.value *
-					(double) buffer_capacity);
-	}
 
 	condition_type = lttng_condition_get_type(condition);
 	if (condition_type == LTTNG_CONDITION_TYPE_BUFFER_USAGE_LOW) {
@@ -4792,6 +4931,109 @@ int handle_notification_thread_event_notification(struct notification_thread_sta
 	return handle_one_event_notifier_notification(state, pipe, domain);
 }
 
+/*
+ * Get the threshold index of a channel's triggers, rebuilding it if the
+ * channel's trigger list changed since it was built.
+ *
+ * Returns NULL if the index could not be built.
+ */
+static channel_threshold_index *
+get_channel_threshold_index(struct lttng_channel_trigger_list *trigger_list,
+			    const struct channel_info *channel_info)
+{
+	if (caa_likely(!trigger_list->threshold_index_stale)) {
+		return trigger_list->threshold_index;
+	}
+
+	delete trigger_list->threshold_index;
+	trigger_list->threshold_index = nullptr;
+
+	try {
+		trigger_list->threshold_index =
+			new channel_threshold_index(trigger_list->list, channel_info->capacity);
+		trigger_list->threshold_index_stale = false;
+	} catch (const std::bad_alloc&) {
+		WARN("Failed to allocate the trigger threshold index of channel: channel name = `%s`",
+		     channel_info->name);
+	}
+
+	return trigger_list->threshold_index;
+}
+
+/*
+ * Evaluate the condition of a trigger bound to a channel against its latest
+ * sample and enqueue the trigger's actions if it is satisfied.
+ *
+ * `stop` is set when the evaluation of the remaining triggers must be
+ * abandoned.
+ */
+static int handle_channel_sample_trigger(struct notification_thread_state *state,
+					 struct lttng_trigger *trigger,
+					 const struct channel_state_sample *previous_sample,
+					 const struct channel_state_sample *latest_sample,
+					 struct channel_info *channel_info,
+					 const struct lttng_credentials *channel_creds,
+					 bool *stop)
+{
+	int ret;
+	const struct lttng_condition *condition;
+	struct notification_client_list *client_list = nullptr;
+	struct lttng_evaluation *evaluation = nullptr;
+	enum action_executor_status executor_status;
+
+	condition = lttng_trigger_get_const_condition(trigger);
+	LTTNG_ASSERT(condition);
+
+	ret = evaluate_buffer_condition(
+		condition, &evaluation, state, previous_sample, latest_sample, channel_info);
+	if (caa_unlikely(ret)) {
+		*stop = true;
+		return ret;
+	}
+
+	if (caa_likely(!evaluation)) {
+		return 0;
+	}
+
+	/*
+	 * Ownership of `evaluation` transferred to the action executor
+	 * no matter the result. The callee acquires a reference to the
+	 * client list: we can release our own.
+	 */
+	client_list = get_client_list_from_condition(state, condition);
+	executor_status = action_executor_enqueue_trigger(
+		state->executor, trigger, evaluation, channel_creds, client_list);
+	notification_client_list_put(client_list);
+	evaluation = nullptr;
+	switch (executor_status) {
+	case ACTION_EXECUTOR_STATUS_OK:
+		break;
+	case ACTION_EXECUTOR_STATUS_ERROR:
+	case ACTION_EXECUTOR_STATUS_INVALID:
+		/*
+		 * TODO Add trigger identification (name/id) when
+		 * it is added to the API.
+		 */
+		ERR("Fatal error occurred while enqueuing action associated with buffer-condition trigger");
+		*stop = true;
+		return -1;
+	case ACTION_EXECUTOR_STATUS_OVERFLOW:
+		/*
+		 * TODO Add trigger identification (name/id) when
+		 * it is added to the API.
+		 *
+		 * Not a fatal error.
+		 */
+		WARN("No space left when enqueuing action associated with buffer-condition trigger");
+		*stop = true;
+		return 0;
+	default:
+		abort();
+	}
+
+	return 0;
+}
+
 int handle_notification_thread_channel_sample(struct notification_thread_state *state,
 					      int pipe,
 					      enum lttng_domain_type domain)
@@ -4810,6 +5052,8 @@ int handle_notification_thread_channel_sample(struct notification_thread_state *
 	struct lttng_credentials channel_creds = {};
 	struct lttng_credentials session_creds = {};
 	struct session_info *session;
+	channel_threshold_index *threshold_index;
+	bool stop = false;
 	const lttng::urcu::read_lock_guard read_lock;
 
 	/*
@@ -4990,67 +5234,39 @@ int handle_notification_thread_channel_sample(struct notification_thread_state *
 
 	channel_trigger_list =
 		caa_container_of(node, struct lttng_channel_trigger_list, channel_triggers_ht_node);
-	cds_list_for_each_entry (trigger_list_element, &channel_trigger_list->list, node) {
-		const struct lttng_condition *condition;
-		struct lttng_trigger *trigger;
-		struct notification_client_list *client_list = nullptr;
-		struct lttng_evaluation *evaluation = nullptr;
-		enum action_executor_status executor_status;
-
-		ret = 0;
-		trigger = trigger_list_element->trigger;
-		condition = lttng_trigger_get_const_condition(trigger);
-		LTTNG_ASSERT(condition);
-
-		ret = evaluate_buffer_condition(
-			condition,
-			&evaluation,
-			state,
-			previous_sample_available ? &channel_previous_sample : nullptr,
-			&channel_new_sample,
-			channel_info);
-		if (caa_unlikely(ret)) {
-			break;
-		}
-
-		if (caa_likely(!evaluation)) {
-			continue;
+	threshold_index = get_channel_threshold_index(channel_trigger_list, channel_info);
+	if (caa_likely(threshold_index)) {
+		/* Only evaluate the triggers of which the condition can change state. */
+		for (const auto *entry : threshold_index->candidates(
+			     previous_sample_available ?
+				     &channel_previous_sample.highest_usage :
+				     nullptr,
+			     channel_new_sample.highest_usage)) {
+			ret = handle_channel_sample_trigger(
+				state,
+				entry->trigger,
+				previous_sample_available ? &channel_previous_sample : nullptr,
+				&channel_new_sample,
+				channel_info,
+				&channel_creds,
+				&stop);
+			if (stop) {
+				break;
+			}
 		}
-
-		/*
-		 * Ownership of `evaluation` transferred to the action executor
-		 * no matter the result. The callee acquires a reference to the
-		 * client list: we can release our own.
-		 */
-		client_list = get_client_list_from_condition(state, condition);
-		executor_status = action_executor_enqueue_trigger(
-			state->executor, trigger, evaluation, &channel_creds, client_list);
-		notification_client_list_put(client_list);
-		evaluation = nullptr;
-		switch (executor_status) {
-		case ACTION_EXECUTOR_STATUS_OK:
-			break;
-		case ACTION_EXECUTOR_STATUS_ERROR:
-		case ACTION_EXECUTOR_STATUS_INVALID:
-			/*
-			 * TODO Add trigger identification (name/id) when
-			 * it is added to the API.
-			 */
-			ERR("Fatal error occurred while enqueuing action associated with buffer-condition trigger");
-			ret = -1;
-			goto end_unlock;
-		case ACTION_EXECUTOR_STATUS_OVERFLOW:
-			/*
-			 * TODO Add trigger identification (name/id) when
-			 * it is added to the API.
-			 *
-			 * Not a fatal error.
-			 */
-			WARN("No space left when enqueuing action associated with buffer-condition trigger");
-			ret = 0;
-			goto end_unlock;
-		default:
-			abort();
+	} else {
+		cds_list_for_each_entry (trigger_list_element, &channel_trigger_list->list, node) {
+			ret = handle_channel_sample_trigger(
+				state,
+				trigger_list_element->trigger,
+				previous_sample_available ? &channel_previous_sample : nullptr,
+				&channel_new_sample,
+				channel_info,
+				&channel_creds,
+				&stop);
+			if (stop) {
+				break;
+			}
 		}
 	}
 end_unlock:
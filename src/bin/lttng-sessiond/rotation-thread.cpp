@@ -15,6 +15,7 @@
 #include "session.hpp"
 #include "thread.hpp"
 #include "timer.hpp"
+#include "ust-app.hpp"
 #include "utils.hpp"
 
 #include <common/align.hpp>
@@ -86,6 +87,8 @@ const char *get_job_type_str(enum ls::rotation_thread_job_type job_type)
 		return "CHECK_PENDING_ROTATION";
 	case ls::rotation_thread_job_type::SCHEDULED_ROTATION:
 		return "SCHEDULED_ROTATION";
+	case ls::rotation_thread_job_type::APP_SYNCHRONIZATION:
+		return "APP_SYNCHRONIZATION";
 	default:
 		abort();
 	}
@@ -332,6 +335,46 @@ void launch_session_rotation(const ltt_session::locked_ref& session)
 	}
 }
 
+/*
+ * Apply the pending configuration changes of the user space domain of a
+ * session to the applications, in a single pass.
+ *
+ * Call with the session and session_list locks held.
+ */
+void synchronize_session_applications(const ltt_session::locked_ref& session)
+{
+	struct ltt_ust_session *usess = session->ust_session;
+	unsigned int failed_app_count;
+
+	/*
+	 * The application synchronization timer is launched in one-shot mode:
+	 * the timer thread can't stop the timer itself since it is involved in
+	 * the check for the timer's quiescence.
+	 */
+	if (session->app_sync_timer_enabled && timer_session_app_sync_timer_stop(session)) {
+		ERR_FMT("Failed to stop the application synchronization timer of session, applying its pending changes anyway: session_name=`{}`",
+			session->name);
+	}
+
+	/*
+	 * The changes made while the session is inactive are applied when it
+	 * is started.
+	 */
+	if (session->destroyed || !usess || !usess->active || !usess->app_sync_pending) {
+		return;
+	}
+
+	DBG_FMT("Synchronizing applications with the configuration of session: session_name=`{}`",
+		session->name);
+
+	failed_app_count = ust_app_apply_pending_session_update(usess);
+	if (failed_app_count) {
+		ERR_FMT("Failed to apply the pending changes of session to applications: session_name=`{}`, failed_app_count={}",
+			session->name,
+			failed_app_count);
+	}
+}
+
 int run_job(const rotation_thread_job& job,
 	    const ltt_session::locked_ref& session,
 	    notification_thread_handle& notification_thread_handle)
@@ -354,6 +397,9 @@ int run_job(const rotation_thread_job& job,
 	case ls::rotation_thread_job_type::CHECK_PENDING_ROTATION:
 		ret = check_session_rotation_pending(session, notification_thread_handle);
 		break;
+	case ls::rotation_thread_job_type::APP_SYNCHRONIZATION:
+		synchronize_session_applications(session);
+		break;
 	default:
 		abort();
 	}
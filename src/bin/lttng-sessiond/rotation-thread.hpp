@@ -31,7 +31,11 @@
 namespace lttng {
 namespace sessiond {
 
-enum class rotation_thread_job_type { SCHEDULED_ROTATION, CHECK_PENDING_ROTATION };
+enum class rotation_thread_job_type {
+	SCHEDULED_ROTATION,
+	CHECK_PENDING_ROTATION,
+	APP_SYNCHRONIZATION,
+};
 
 struct rotation_thread_timer_queue;
 
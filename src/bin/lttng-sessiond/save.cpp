@@ -131,7 +131,9 @@ static int save_ust_channel_attributes(struct config_writer *writer,
 				       struct lttng_ust_abi_channel_attr *attr)
 {
 	int ret;
-	struct ltt_ust_channel *channel = nullptr;
+	/* Fetch the output and monitor timer located in the parent of the attributes. */
+	const struct ltt_ust_channel *channel =
+		lttng::utils::container_of(attr, &ltt_ust_channel::attr);
 
 	ret = config_writer_write_element_string(writer,
 						 config_element_overwrite_mode,
@@ -172,9 +174,9 @@ static int save_ust_channel_attributes(struct config_writer *writer,
 
 	ret = config_writer_write_element_string(writer,
 						 config_element_output_type,
-						 attr->output == LTTNG_UST_ABI_MMAP ?
-							 config_output_type_mmap :
-							 config_output_type_splice);
+						 channel->splice_output ?
+							 config_output_type_splice :
+							 config_output_type_mmap);
 	if (ret) {
 		ret = LTTNG_ERR_SAVE_IO_FAIL;
 		goto end;
@@ -208,11 +210,6 @@ static int save_ust_channel_attributes(struct config_writer *writer,
 		goto end;
 	}
 
-	/*
-	 * Fetch the monitor timer which is located in the parent of
-	 * lttng_ust_channel_attr
-	 */
-	channel = lttng::utils::container_of(attr, &ltt_ust_channel::attr);
 	ret = config_writer_write_element_unsigned_int(
 		writer, config_element_monitor_timer_interval, channel->monitor_timer_interval);
 	if (ret) {
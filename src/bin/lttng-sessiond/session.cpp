@@ -88,6 +88,7 @@ struct ltt_session *session_find_by_name(const char *name)
 
 	DBG2("Trying to find session by name %s", name);
 
+	const std::lock_guard<std::mutex> membership_lock(the_session_list.membership_lock);
 	for (auto session : lttng::urcu::list_iteration_adapter<ltt_session, &ltt_session::list>(
 		     the_session_list.head)) {
 		if (!strncmp(session->name, name, NAME_MAX) && !session->destroyed) {
@@ -115,19 +116,27 @@ struct ltt_session *session_find_by_id(uint64_t id)
 	ASSERT_RCU_READ_LOCKED();
 	ASSERT_SESSION_LIST_LOCKED();
 
-	if (!ltt_sessions_ht_by_id) {
-		goto end;
-	}
+	{
+		const std::lock_guard<std::mutex> membership_lock(
+			the_session_list.membership_lock);
 
-	lttng_ht_lookup(ltt_sessions_ht_by_id, &id, &iter);
-	node = lttng_ht_iter_get_node<lttng_ht_node_u64>(&iter);
-	if (node == nullptr) {
-		goto end;
+		if (!ltt_sessions_ht_by_id) {
+			goto end;
+		}
+
+		lttng_ht_lookup(ltt_sessions_ht_by_id, &id, &iter);
+		node = lttng_ht_iter_get_node<lttng_ht_node_u64>(&iter);
+		if (node == nullptr) {
+			goto end;
+		}
+		ls = lttng::utils::container_of(node, &ltt_session::node);
+		if (!session_get(ls)) {
+			goto end;
+		}
 	}
-	ls = lttng::utils::container_of(node, &ltt_session::node);
 
 	DBG3("Session %" PRIu64 " found by id.", id);
-	return session_get(ls) ? ls : nullptr;
+	return ls;
 
 end:
 	DBG3("Session %" PRIu64 " NOT found by id", id);
@@ -205,13 +214,39 @@ struct ltt_session_list *session_get_list()
 /*
  * Returns once the session list is empty.
  */
-void session_list_wait_empty(std::unique_lock<std::mutex> list_lock)
+void session_list_wait_empty(std::unique_lock<lttng::pthread::rw_mutex> list_lock)
 {
 	/* Keep waiting until the session list is empty. */
 	the_session_list.removal_cond.wait(list_lock,
 					   [] { return cds_list_empty(&the_session_list.head); });
 }
 
+/*
+ * Return a reference to every session of the list that is not being released.
+ *
+ * Unlike iterating on the list directly, this is safe while the session list
+ * lock is only held in shared mode as other holders may unpublish sessions
+ * concurrently. The session locks must not be held by the caller.
+ */
+std::vector<ltt_session::ref> session_get_list_references()
+{
+	std::vector<ltt_session::ref> references;
+
+	ASSERT_SESSION_LIST_LOCKED();
+
+	const std::lock_guard<std::mutex> membership_lock(the_session_list.membership_lock);
+	for (auto session : lttng::urcu::list_iteration_adapter<ltt_session, &ltt_session::list>(
+		     the_session_list.head)) {
+		if (!session_get(session)) {
+			continue;
+		}
+
+		references.emplace_back(ltt_session::make_ref(*session));
+	}
+
+	return references;
+}
+
 /*
  * Try to acquire session list lock
  */
@@ -1069,6 +1104,9 @@ static void session_release(struct urcu_ref *ref)
 
 	if (session_published) {
 		ASSERT_SESSION_LIST_LOCKED();
+
+		const std::lock_guard<std::mutex> membership_lock(
+			the_session_list.membership_lock);
 		del_session_list(session);
 		del_session_ht(session);
 	}
@@ -1171,9 +1209,14 @@ void session_destroy(struct ltt_session *session)
 	 * Even if a session still technically exists for a little while longer,
 	 * there is no point in performing action on a "destroyed" session.
 	 */
-	iter.iter.node = &session->node_by_name.node;
-	ret = lttng_ht_del(ltt_sessions_ht_by_name, &iter);
-	LTTNG_ASSERT(!ret);
+	{
+		const std::lock_guard<std::mutex> membership_lock(
+			the_session_list.membership_lock);
+
+		iter.iter.node = &session->node_by_name.node;
+		ret = lttng_ht_del(ltt_sessions_ht_by_name, &iter);
+		LTTNG_ASSERT(!ret);
+	}
 
 	session_put(session);
 }
@@ -1604,9 +1647,14 @@ void ltt_session::_const_session_put(const ltt_session *session)
 	urcu_ref_put(&session->ref_count, session_release);
 }
 
-std::unique_lock<std::mutex> ls::lock_session_list()
+std::unique_lock<lttng::pthread::rw_mutex> ls::lock_session_list()
+{
+	return std::unique_lock<lttng::pthread::rw_mutex>(the_session_list.lock);
+}
+
+lttng::pthread::shared_lock ls::lock_session_list_shared()
 {
-	return std::unique_lock<std::mutex>(the_session_list.lock);
+	return lttng::pthread::shared_lock(the_session_list.lock);
 }
 
 lttng::sessiond::user_space_consumer_channel_keys
@@ -32,6 +32,7 @@
 #include <mutex>
 #include <stdbool.h>
 #include <urcu/list.h>
+#include <vector>
 
 #define ASSERT_SESSION_LIST_LOCKED() LTTNG_ASSERT(session_trylock_list())
 
@@ -79,13 +80,26 @@ struct ltt_session_list {
 	 * lock and release it before returning. If none of those
 	 * functions are used, the lock MUST be acquired in order to
 	 * iterate or/and do any actions on that list.
+	 *
+	 * The lock may also be held in shared mode by client command
+	 * workers while they operate on a single, locked, session. Shared
+	 * holders may unpublish sessions concurrently (see
+	 * membership_lock) and must never iterate the list directly; see
+	 * session_get_list_references().
+	 */
+	lttng::pthread::rw_mutex lock;
+	/*
+	 * Protects the list linkage and the session hash tables against
+	 * concurrent publication and unpublication when the list lock is
+	 * only held in shared mode. This lock is a leaf: no other lock
+	 * (in particular, no session lock) may be acquired while holding it.
 	 */
-	std::mutex lock;
+	std::mutex membership_lock;
 	/*
 	 * This condition variable is signaled on every removal from
 	 * the session list.
 	 */
-	std::condition_variable removal_cond;
+	std::condition_variable_any removal_cond;
 
 	/*
 	 * Session unique ID generator. The session list lock MUST be
@@ -435,6 +449,12 @@ public:
 	/* Timer to periodically rotate a session. */
 	bool rotation_schedule_timer_enabled = false;
 	timer_t rotation_schedule_timer = nullptr;
+	/*
+	 * Timer to apply the pending configuration changes of the user space
+	 * domain to the applications.
+	 */
+	bool app_sync_timer_enabled = false;
+	timer_t app_sync_timer = nullptr;
 	/* Value for periodic rotations, 0 if disabled. */
 	uint64_t rotate_timer_period = 0;
 	/* Value for size-based rotations, 0 if disabled. */
@@ -490,7 +510,8 @@ using ltt_session_clear_notifier = void (*)(const ltt_session::locked_ref&, void
 namespace lttng {
 namespace sessiond {
 
-std::unique_lock<std::mutex> lock_session_list();
+std::unique_lock<lttng::pthread::rw_mutex> lock_session_list();
+lttng::pthread::shared_lock lock_session_list_shared();
 
 namespace exceptions {
 /*
@@ -631,7 +652,8 @@ struct lttng_trace_archive_location *
 session_get_trace_archive_location(const ltt_session::locked_ref& session);
 
 struct ltt_session_list *session_get_list();
-void session_list_wait_empty(std::unique_lock<std::mutex> list_lock);
+void session_list_wait_empty(std::unique_lock<lttng::pthread::rw_mutex> list_lock);
+std::vector<ltt_session::ref> session_get_list_references();
 
 bool session_access_ok(const ltt_session::locked_ref& session, uid_t uid);
 
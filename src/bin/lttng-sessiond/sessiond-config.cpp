@@ -28,6 +28,7 @@ static struct sessiond_config sessiond_config_build_defaults = {
 	.event_notifier_buffer_size_kernel = DEFAULT_EVENT_NOTIFIER_ERROR_COUNT_MAP_SIZE,
 	.event_notifier_buffer_size_userspace = DEFAULT_EVENT_NOTIFIER_ERROR_COUNT_MAP_SIZE,
 	.app_socket_timeout = DEFAULT_APP_SOCKET_RW_TIMEOUT,
+	.app_sync_delay = DEFAULT_APP_SYNC_DELAY,
 
 	.quiet = false,
 
@@ -117,6 +118,25 @@ int sessiond_config_apply_env_config(struct sessiond_config *config)
 		config->app_socket_timeout = int_val;
 	}
 
+	env_value = getenv(DEFAULT_APP_SYNC_DELAY_ENV);
+	if (env_value) {
+		char *endptr;
+		unsigned long delay;
+
+		errno = 0;
+		delay = strtoul(env_value, &endptr, 0);
+		if (errno != 0 || endptr == env_value || *endptr != '\0' ||
+		    delay > UINT_MAX / 1000) {
+			ERR("Invalid value \"%s\" used for \"%s\" environment variable",
+			    env_value,
+			    DEFAULT_APP_SYNC_DELAY_ENV);
+			ret = -1;
+			goto end;
+		}
+
+		config->app_sync_delay = delay;
+	}
+
 	env_value = lttng_secure_getenv("LTTNG_CONSUMERD32_BIN");
 	if (env_value) {
 		config_string_set_static(&config->consumerd32_bin_path, env_value);
@@ -518,6 +538,7 @@ void sessiond_config_log(struct sessiond_config *config)
 			   config->agent_tcp_port.end);
 	}
 	DBG_NO_LOC("\tapplication socket timeout:    %i", config->app_socket_timeout);
+	DBG_NO_LOC("\tapplication sync delay:        %u ms", config->app_sync_delay);
 	DBG_NO_LOC("\tno-kernel:                     %s", config->no_kernel ? "True" : "False");
 	DBG_NO_LOC("\tbackground:                    %s", config->background ? "True" : "False");
 	DBG_NO_LOC("\tdaemonize:                     %s", config->daemonize ? "True" : "False");
@@ -34,6 +34,12 @@ struct sessiond_config {
 	int event_notifier_buffer_size_userspace;
 	/* Socket timeout for receiving and sending (in seconds). */
 	int app_socket_timeout;
+	/*
+	 * Delay (in milliseconds) after which the configuration changes of
+	 * active sessions are applied to the applications, 0 if they are
+	 * applied immediately.
+	 */
+	unsigned int app_sync_delay;
 
 	bool quiet;
 	bool no_kernel;
@@ -19,6 +19,7 @@
 #define LTTNG_SESSIOND_SIG_EXIT			  (SIGRTMIN + 11)
 #define LTTNG_SESSIOND_SIG_PENDING_ROTATION_CHECK (SIGRTMIN + 12)
 #define LTTNG_SESSIOND_SIG_SCHEDULED_ROTATION	  (SIGRTMIN + 13)
+#define LTTNG_SESSIOND_SIG_APP_SYNC		  (SIGRTMIN + 14)
 
 #define UINT_TO_PTR(value)                            \
 	({                                            \
@@ -73,6 +74,10 @@ static void setmask(sigset_t *mask)
 	if (ret) {
 		PERROR("sigaddset scheduled rotation");
 	}
+	ret = sigaddset(mask, LTTNG_SESSIOND_SIG_APP_SYNC);
+	if (ret) {
+		PERROR("sigaddset application synchronization");
+	}
 }
 
 /*
@@ -311,6 +316,68 @@ end:
 	return ret;
 }
 
+/*
+ * Call with the session and session_list locks held.
+ */
+int timer_session_app_sync_timer_start(const ltt_session::locked_ref& session,
+				       unsigned int interval_us)
+{
+	int ret;
+
+	if (!session_get(&session.get())) {
+		ret = -1;
+		goto end;
+	}
+
+	DBG("Enabling application synchronization timer on session \"%s\" (%u %s)",
+	    session->name,
+	    interval_us,
+	    USEC_UNIT);
+	/*
+	 * As for the rotation pending check timer, the timer is armed in
+	 * one-shot mode and stopped by the rotation thread when it handles
+	 * the resulting job.
+	 */
+	ret = timer_start(&session->app_sync_timer,
+			  &session.get(),
+			  interval_us,
+			  LTTNG_SESSIOND_SIG_APP_SYNC,
+			  /* one-shot */ true);
+	if (ret < 0) {
+		session_put(&session.get());
+		goto end;
+	}
+
+	session->app_sync_timer_enabled = true;
+end:
+	return ret;
+}
+
+/*
+ * Call with the session and session_list locks held.
+ */
+int timer_session_app_sync_timer_stop(const ltt_session::locked_ref& session)
+{
+	int ret;
+
+	LTTNG_ASSERT(session->app_sync_timer_enabled);
+
+	DBG("Disabling application synchronization timer on session \"%s\"", session->name);
+	ret = timer_stop(&session->app_sync_timer, LTTNG_SESSIOND_SIG_APP_SYNC);
+	if (ret < 0) {
+		ERR("Failed to stop application synchronization timer of session \"%s\"",
+		    session->name);
+		goto end;
+	}
+
+	session->app_sync_timer_enabled = false;
+	/* The timer's reference to the session can be released safely. */
+	session_put(&session.get());
+	ret = 0;
+end:
+	return ret;
+}
+
 /*
  * Block the RT signals for the entire process. It must be called from the
  * sessiond main before creating the threads
@@ -393,6 +460,11 @@ static void *thread_timer(void *data)
 			 * released since the timer is still enabled and can
 			 * still fire.
 			 */
+		} else if (signr == LTTNG_SESSIOND_SIG_APP_SYNC) {
+			rotation_thread_enqueue_job(
+				ctx->rotation_thread_job_queue,
+				lttng::sessiond::rotation_thread_job_type::APP_SYNCHRONIZATION,
+				(struct ltt_session *) info.si_value.sival_ptr);
 		} else {
 			ERR("Unexpected signal %d", info.si_signo);
 		}
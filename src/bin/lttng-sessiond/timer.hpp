@@ -33,6 +33,12 @@ int timer_session_rotation_schedule_timer_start(const ltt_session::locked_ref& s
 /* Stop a session's rotation schedule timer. */
 int timer_session_rotation_schedule_timer_stop(const ltt_session::locked_ref& session);
 
+/* Start a session's application synchronization timer (one-shot mode). */
+int timer_session_app_sync_timer_start(const ltt_session::locked_ref& session,
+				       unsigned int interval_us);
+/* Stop a session's application synchronization timer. */
+int timer_session_app_sync_timer_stop(const ltt_session::locked_ref& session);
+
 bool launch_timer_thread(struct timer_thread_parameters *timer_thread_parameters);
 
 #endif /* SESSIOND_TIMER_H */
@@ -24,6 +24,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <vector>
 
 namespace lsu = lttng::sessiond::ust;
 
@@ -364,6 +365,7 @@ struct ltt_ust_channel *trace_ust_create_channel(struct lttng_channel *chan,
 	luc->attr.switch_timer_interval = chan->attr.switch_timer_interval;
 	luc->attr.read_timer_interval = chan->attr.read_timer_interval;
 	luc->attr.output = (enum lttng_ust_abi_output) chan->attr.output;
+	luc->splice_output = chan->attr.output == LTTNG_EVENT_SPLICE;
 	luc->monitor_timer_interval =
 		((struct lttng_channel_extended *) chan->attr.extended.ptr)->monitor_timer_interval;
 	luc->attr.u.s.blocking_timeout =
@@ -748,30 +750,16 @@ error:
 	return nullptr;
 }
 
-static void destroy_id_tracker_node_rcu(struct rcu_head *head)
-{
-	auto *wrapper_node = lttng::utils::container_of(head, &lttng_ht_node_ulong::head);
-	auto *tracker_node = lttng::utils::container_of(wrapper_node, &ust_id_tracker_node::node);
-
-	free(tracker_node);
-}
-
-static void destroy_id_tracker_node(struct ust_id_tracker_node *tracker_node)
-{
-	call_rcu(&tracker_node->node.head, destroy_id_tracker_node_rcu);
-}
-
 static int init_id_tracker(struct ust_id_tracker *id_tracker)
 {
 	int ret = LTTNG_OK;
 
-	id_tracker->ht = lttng_ht_new(0, LTTNG_HT_TYPE_ULONG);
-	if (!id_tracker->ht) {
+	try {
+		id_tracker->ids = new lttng::sessiond::process_attr_id_set;
+	} catch (const std::bad_alloc&) {
 		ret = LTTNG_ERR_NOMEM;
-		goto end;
 	}
 
-end:
 	return ret;
 }
 
@@ -780,86 +768,48 @@ end:
  */
 static void fini_id_tracker(struct ust_id_tracker *id_tracker)
 {
-	if (!id_tracker->ht) {
-		return;
-	}
-
-	for (auto *tracker_node :
-	     lttng::urcu::lfht_iteration_adapter<ust_id_tracker_node,
-						 decltype(ust_id_tracker_node::node),
-						 &ust_id_tracker_node::node>(*id_tracker->ht->ht)) {
-		const int ret = cds_lfht_del(id_tracker->ht->ht, &tracker_node->node.node);
-
-		LTTNG_ASSERT(!ret);
-		destroy_id_tracker_node(tracker_node);
-	}
-
-	lttng_ht_destroy(id_tracker->ht);
-	id_tracker->ht = nullptr;
-}
-
-static struct ust_id_tracker_node *
-id_tracker_lookup(struct ust_id_tracker *id_tracker, int id, struct lttng_ht_iter *iter)
-{
-	const unsigned long _id = (unsigned long) id;
-	struct lttng_ht_node_ulong *node;
-
-	lttng_ht_lookup(id_tracker->ht, (void *) _id, iter);
-	node = lttng_ht_iter_get_node<lttng_ht_node_ulong>(iter);
-	if (node) {
-		return lttng::utils::container_of(node, &ust_id_tracker_node::node);
-	} else {
-		return nullptr;
-	}
+	delete id_tracker->ids;
+	id_tracker->ids = nullptr;
 }
 
 static int id_tracker_add_id(struct ust_id_tracker *id_tracker, int id)
 {
 	int retval = LTTNG_OK;
-	struct ust_id_tracker_node *tracker_node;
-	struct lttng_ht_iter iter;
 
 	if (id < 0) {
 		retval = LTTNG_ERR_INVALID;
 		goto end;
 	}
-	tracker_node = id_tracker_lookup(id_tracker, id, &iter);
-	if (tracker_node) {
-		/* Already exists. */
-		retval = LTTNG_ERR_PROCESS_ATTR_EXISTS;
-		goto end;
-	}
-	tracker_node = zmalloc<ust_id_tracker_node>();
-	if (!tracker_node) {
+
+	try {
+		if (!id_tracker->ids->insert((lttng::sessiond::process_attr_id_set::id) id)) {
+			/* Already exists. */
+			retval = LTTNG_ERR_PROCESS_ATTR_EXISTS;
+		}
+	} catch (const std::bad_alloc&) {
 		retval = LTTNG_ERR_NOMEM;
-		goto end;
 	}
-	lttng_ht_node_init_ulong(&tracker_node->node, (unsigned long) id);
-	lttng_ht_add_unique_ulong(id_tracker->ht, &tracker_node->node);
 end:
 	return retval;
 }
 
 static int id_tracker_del_id(struct ust_id_tracker *id_tracker, int id)
 {
-	int retval = LTTNG_OK, ret;
-	struct ust_id_tracker_node *tracker_node;
-	struct lttng_ht_iter iter;
+	int retval = LTTNG_OK;
 
 	if (id < 0) {
 		retval = LTTNG_ERR_INVALID;
 		goto end;
 	}
-	tracker_node = id_tracker_lookup(id_tracker, id, &iter);
-	if (!tracker_node) {
-		/* Not found */
-		retval = LTTNG_ERR_PROCESS_ATTR_MISSING;
-		goto end;
-	}
-	ret = lttng_ht_del(id_tracker->ht, &iter);
-	LTTNG_ASSERT(!ret);
 
-	destroy_id_tracker_node(tracker_node);
+	try {
+		if (!id_tracker->ids->erase((lttng::sessiond::process_attr_id_set::id) id)) {
+			/* Not found */
+			retval = LTTNG_ERR_PROCESS_ATTR_MISSING;
+		}
+	} catch (const std::bad_alloc&) {
+		retval = LTTNG_ERR_NOMEM;
+	}
 end:
 	return retval;
 }
@@ -910,17 +860,16 @@ int trace_ust_id_tracker_lookup(enum lttng_process_attr process_attr,
 				struct ltt_ust_session *session,
 				int id)
 {
-	struct lttng_ht_iter iter;
 	struct ust_id_tracker *id_tracker;
 
 	id_tracker = get_id_tracker(session, process_attr);
 	if (!id_tracker) {
 		abort();
 	}
-	if (!id_tracker->ht) {
+	if (!id_tracker->ids) {
 		return 1;
 	}
-	if (id_tracker_lookup(id_tracker, id, &iter)) {
+	if (id >= 0 && id_tracker->ids->contains((lttng::sessiond::process_attr_id_set::id) id)) {
 		return 1;
 	}
 	return 0;
@@ -961,7 +910,7 @@ trace_ust_process_attr_tracker_set_tracking_policy(struct ltt_ust_session *sessi
 	switch (policy) {
 	case LTTNG_TRACKING_POLICY_INCLUDE_ALL:
 		/* Track all values: destroy tracker if exists. */
-		if (id_tracker->ht) {
+		if (id_tracker->ids) {
 			fini_id_tracker(id_tracker);
 			/* Ensure all apps have session. */
 			should_update_apps = true;
@@ -1203,6 +1152,136 @@ end:
 	return ret_code;
 }
 
+/*
+ * Apply an update to the inclusion set of a process attribute tracker and
+ * synchronize the applications once for the whole update.
+ *
+ * Called with the session lock held.
+ */
+enum lttng_error_code trace_ust_process_attr_tracker_inclusion_set_update(
+	struct ltt_ust_session *session,
+	enum lttng_process_attr process_attr,
+	enum process_attr_tracker_inclusion_set_operation operation,
+	const struct lttng_process_attr_values *values,
+	struct lttng_process_attr_values **_added_values,
+	struct lttng_process_attr_values **_removed_values)
+{
+	enum lttng_error_code ret_code;
+	bool should_update_apps = false;
+	struct ust_id_tracker *id_tracker = get_id_tracker(session, process_attr);
+	struct process_attr_tracker *tracker;
+	enum process_attr_tracker_status status;
+	struct lttng_process_attr_values *added_values = nullptr;
+	struct lttng_process_attr_values *removed_values = nullptr;
+	std::vector<int> changed_ids;
+	std::size_t added_id_count;
+
+	tracker = _trace_ust_get_process_attr_tracker(session, process_attr);
+	if (!tracker) {
+		ret_code = LTTNG_ERR_INVALID;
+		goto end;
+	}
+
+	status = process_attr_tracker_inclusion_set_update(
+		tracker, operation, values, &added_values, &removed_values);
+	switch (status) {
+	case PROCESS_ATTR_TRACKER_STATUS_OK:
+		break;
+	case PROCESS_ATTR_TRACKER_STATUS_INVALID_TRACKING_POLICY:
+		ret_code = LTTNG_ERR_PROCESS_ATTR_TRACKER_INVALID_TRACKING_POLICY;
+		goto end;
+	case PROCESS_ATTR_TRACKER_STATUS_ERROR:
+		ret_code = LTTNG_ERR_NOMEM;
+		goto end;
+	default:
+		ret_code = LTTNG_ERR_UNK;
+		goto end;
+	}
+
+	ret_code = process_attr_values_get_integral_values(process_attr, added_values, changed_ids);
+	if (ret_code != LTTNG_OK) {
+		goto error;
+	}
+
+	added_id_count = changed_ids.size();
+	ret_code =
+		process_attr_values_get_integral_values(process_attr, removed_values, changed_ids);
+	if (ret_code != LTTNG_OK) {
+		goto error;
+	}
+
+	for (const auto id : changed_ids) {
+		if (id < 0) {
+			ret_code = LTTNG_ERR_INVALID;
+			goto error;
+		}
+	}
+
+	DBG("User space update of %s tracker for session id %" PRIu64
+	    ": tracking %zu values, untracking %zu values",
+	    lttng_process_attr_to_string(process_attr),
+	    session->id,
+	    added_id_count,
+	    changed_ids.size() - added_id_count);
+
+	LTTNG_ASSERT(id_tracker->ids);
+	try {
+		/* Update a copy of the IDs to leave them unchanged on error. */
+		auto ids = *id_tracker->ids;
+
+		ids.erase(std::vector<lttng::sessiond::process_attr_id_set::id>(
+			changed_ids.begin() + added_id_count, changed_ids.end()));
+		ids.insert(std::vector<lttng::sessiond::process_attr_id_set::id>(
+			changed_ids.begin(), changed_ids.begin() + added_id_count));
+		*id_tracker->ids = std::move(ids);
+	} catch (const std::bad_alloc&) {
+		ret_code = LTTNG_ERR_NOMEM;
+		goto error;
+	}
+
+	/* Add or remove the session from the affected applications. */
+	switch (process_attr) {
+	case LTTNG_PROCESS_ATTR_VIRTUAL_PROCESS_ID:
+		for (const auto id : changed_ids) {
+			if (ust_app_find_by_pid(id)) {
+				should_update_apps = true;
+				break;
+			}
+		}
+		break;
+	default:
+		should_update_apps = !changed_ids.empty();
+		break;
+	}
+
+	if (should_update_apps && session->active) {
+		ust_app_global_update_all(session);
+	}
+
+	if (_added_values) {
+		*_added_values = added_values;
+		added_values = nullptr;
+	}
+
+	if (_removed_values) {
+		*_removed_values = removed_values;
+		removed_values = nullptr;
+	}
+
+	goto end;
+error:
+	status = process_attr_tracker_inclusion_set_revert_update(
+		tracker, added_values, removed_values);
+	if (status != PROCESS_ATTR_TRACKER_STATUS_OK) {
+		ERR("Failed to roll-back the update of the user space %s process attribute tracker's inclusion set",
+		    lttng_process_attr_to_string(process_attr));
+	}
+end:
+	lttng_process_attr_values_destroy(added_values);
+	lttng_process_attr_values_destroy(removed_values);
+	return ret_code;
+}
+
 /*
  * RCU safe free context structure.
  */
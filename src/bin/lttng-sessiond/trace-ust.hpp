@@ -11,6 +11,7 @@
 
 #include "consumer.hpp"
 #include "lttng-ust-ctl.hpp"
+#include "tracker.hpp"
 
 #include <common/defaults.hpp>
 #include <common/hashtable/hashtable.hpp>
@@ -75,6 +76,11 @@ struct ltt_ust_channel {
 	uint64_t per_pid_closed_app_discarded;
 	uint64_t per_pid_closed_app_lost;
 	uint64_t monitor_timer_interval;
+	/*
+	 * The tracer always uses the mmap output; the consumer daemon vmsplices
+	 * the pages of the sub-buffers to the trace files when set.
+	 */
+	bool splice_output;
 };
 
 /* UST domain global (LTTNG_DOMAIN_UST) */
@@ -83,12 +89,9 @@ struct ltt_ust_domain_global {
 	struct cds_list_head registry_buffer_uid_list;
 };
 
-struct ust_id_tracker_node {
-	struct lttng_ht_node_ulong node;
-};
-
 struct ust_id_tracker {
-	struct lttng_ht *ht;
+	/* NULL when all values are tracked. */
+	lttng::sessiond::process_attr_id_set *ids;
 };
 
 /* UST session */
@@ -102,6 +105,11 @@ struct ltt_ust_session {
 	gid_t gid;
 	/* Is the session active meaning has is been started or stopped. */
 	bool active;
+	/*
+	 * Changes of the configuration are waiting to be applied to the
+	 * applications. See ust_app_defer_session_update().
+	 */
+	bool app_sync_pending;
 	struct consumer_output *consumer;
 	/* Sequence number for filters so the tracer knows the ordering. */
 	uint64_t filter_seq_num;
@@ -236,6 +244,13 @@ enum lttng_error_code
 trace_ust_process_attr_tracker_inclusion_set_remove_value(struct ltt_ust_session *session,
 							  enum lttng_process_attr process_attr,
 							  const struct process_attr_value *value);
+enum lttng_error_code trace_ust_process_attr_tracker_inclusion_set_update(
+	struct ltt_ust_session *session,
+	enum lttng_process_attr process_attr,
+	enum process_attr_tracker_inclusion_set_operation operation,
+	const struct lttng_process_attr_values *values,
+	struct lttng_process_attr_values **added_values,
+	struct lttng_process_attr_values **removed_values);
 const struct process_attr_tracker *
 trace_ust_get_process_attr_tracker(struct ltt_ust_session *session,
 				   enum lttng_process_attr process_attr);
@@ -385,6 +400,17 @@ static inline enum lttng_error_code trace_ust_process_attr_tracker_inclusion_set
 	return LTTNG_OK;
 }
 
+static inline enum lttng_error_code trace_ust_process_attr_tracker_inclusion_set_update(
+	struct ltt_ust_session *session __attribute__((unused)),
+	enum lttng_process_attr process_attr __attribute__((unused)),
+	enum process_attr_tracker_inclusion_set_operation operation __attribute__((unused)),
+	const struct lttng_process_attr_values *values __attribute__((unused)),
+	struct lttng_process_attr_values **added_values __attribute__((unused)),
+	struct lttng_process_attr_values **removed_values __attribute__((unused)))
+{
+	return LTTNG_ERR_UNSUPPORTED_DOMAIN;
+}
+
 static inline const struct process_attr_tracker *
 trace_ust_get_process_attr_tracker(struct ltt_ust_session *session __attribute__((unused)),
 				   enum lttng_process_attr process_attr __attribute__((unused)))
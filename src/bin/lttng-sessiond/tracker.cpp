@@ -14,109 +14,535 @@
 
 #include <common/defaults.hpp>
 #include <common/error.hpp>
-#include <common/hashtable/hashtable.hpp>
-#include <common/hashtable/utils.hpp>
 #include <common/tracker.hpp>
-#include <common/urcu.hpp>
+#include <common/utils.hpp>
 
 #include <lttng/lttng-error.h>
 
-#include <grp.h>
-#include <pwd.h>
+#include <algorithm>
+#include <iterator>
+#include <new>
+#include <string.h>
+#include <string>
 #include <sys/types.h>
-#include <unistd.h>
-#include <urcu.h>
-#include <urcu/list.h>
-#include <urcu/rculfhash.h>
+#include <utility>
+#include <vector>
 
-struct process_attr_tracker {
-	enum lttng_tracking_policy policy;
-	struct cds_lfht *inclusion_set_ht;
-};
+namespace lsn = lttng::sessiond;
+
+/*
+ * Minimal number of values for a set to be stored as a bitmap. Below it, the
+ * sorted vector is small enough for the choice of representation not to matter.
+ */
+#define PROCESS_ATTR_ID_SET_BITMAP_MIN_COUNT 64
 
 namespace {
-struct process_attr_tracker_value_node {
-	struct process_attr_value *value;
-	struct cds_lfht_node inclusion_set_ht_node;
-	struct rcu_head rcu_head;
+/* Inclusion set of a tracker, grouped by value type. */
+struct process_attr_inclusion_set {
+	lsn::process_attr_id_set pids;
+	lsn::process_attr_id_set uids;
+	lsn::process_attr_id_set gids;
+	/* Sorted in increasing order. */
+	std::vector<std::string> user_names;
+	std::vector<std::string> group_names;
+};
+
+const enum lttng_process_attr_value_type integral_value_types[] = {
+	LTTNG_PROCESS_ATTR_VALUE_TYPE_PID,
+	LTTNG_PROCESS_ATTR_VALUE_TYPE_UID,
+	LTTNG_PROCESS_ATTR_VALUE_TYPE_GID,
+};
+
+const enum lttng_process_attr_value_type name_value_types[] = {
+	LTTNG_PROCESS_ATTR_VALUE_TYPE_USER_NAME,
+	LTTNG_PROCESS_ATTR_VALUE_TYPE_GROUP_NAME,
 };
 } /* namespace */
 
-static void process_attr_tracker_value_node_rcu_free(struct rcu_head *rcu_head)
+struct process_attr_tracker {
+	enum lttng_tracking_policy policy;
+	process_attr_inclusion_set inclusion_set;
+};
+
+bool lsn::process_attr_id_set::contains(id value) const noexcept
 {
-	struct process_attr_tracker_value_node *node =
-		lttng::utils::container_of(rcu_head, &process_attr_tracker_value_node::rcu_head);
+	if (!_is_bitmap) {
+		return std::binary_search(_sorted_ids.begin(), _sorted_ids.end(), value);
+	}
 
-	free(node);
+	if (value < _bitmap_base) {
+		return false;
+	}
+
+	const auto offset = value - _bitmap_base;
+	const auto word_index = offset / 64;
+
+	if (word_index >= _bitmap.size()) {
+		return false;
+	}
+
+	return _bitmap[word_index] & (UINT64_C(1) << (offset % 64));
 }
 
-struct process_attr_tracker *process_attr_tracker_create()
+bool lsn::process_attr_id_set::insert(id value)
 {
-	struct process_attr_tracker *tracker;
+	if (!_is_bitmap) {
+		const auto it = std::lower_bound(_sorted_ids.begin(), _sorted_ids.end(), value);
 
-	tracker = zmalloc<process_attr_tracker>();
-	if (!tracker) {
-		return nullptr;
+		if (it != _sorted_ids.end() && *it == value) {
+			return false;
+		}
+
+		_sorted_ids.insert(it, value);
+		_count++;
+		_update_representation();
+		return true;
 	}
 
-	(void) process_attr_tracker_set_tracking_policy(tracker, LTTNG_TRACKING_POLICY_INCLUDE_ALL);
+	if (contains(value)) {
+		return false;
+	}
 
-	tracker->inclusion_set_ht = cds_lfht_new(
-		DEFAULT_HT_SIZE, 1, 0, CDS_LFHT_AUTO_RESIZE | CDS_LFHT_ACCOUNTING, nullptr);
-	if (!tracker->inclusion_set_ht) {
-		goto error;
+	const std::uint64_t value_word = value / 64;
+	const std::uint64_t first_word = _bitmap_base / 64;
+	const auto new_first_word = std::min(value_word, first_word);
+	const auto new_last_word = std::max(value_word, first_word + _bitmap.size() - 1);
+	const auto new_word_count = new_last_word - new_first_word + 1;
+
+	if (new_word_count > _count + 1) {
+		/* The bitmap would become larger than the equivalent sorted vector. */
+		_use_sorted_ids();
+		return insert(value);
 	}
 
-	return tracker;
-error:
-	process_attr_tracker_destroy(tracker);
-	return nullptr;
+	if (new_first_word < first_word) {
+		_bitmap.insert(_bitmap.begin(), first_word - new_first_word, 0);
+		_bitmap_base = new_first_word * 64;
+	} else if (new_word_count > _bitmap.size()) {
+		_bitmap.resize(new_word_count, 0);
+	}
+
+	const auto offset = value - _bitmap_base;
+
+	_bitmap[offset / 64] |= UINT64_C(1) << (offset % 64);
+	_count++;
+	return true;
 }
 
-static void
-process_attr_tracker_remove_value_node(struct process_attr_tracker *tracker,
-				       struct process_attr_tracker_value_node *value_node)
+bool lsn::process_attr_id_set::erase(id value)
 {
-	cds_lfht_del(tracker->inclusion_set_ht, &value_node->inclusion_set_ht_node);
-	process_attr_value_destroy(value_node->value);
-	call_rcu(&value_node->rcu_head, process_attr_tracker_value_node_rcu_free);
+	if (!_is_bitmap) {
+		const auto it = std::lower_bound(_sorted_ids.begin(), _sorted_ids.end(), value);
+
+		if (it == _sorted_ids.end() || *it != value) {
+			return false;
+		}
+
+		_sorted_ids.erase(it);
+		_count--;
+		_update_representation();
+		return true;
+	}
+
+	if (!contains(value)) {
+		return false;
+	}
+
+	const auto offset = value - _bitmap_base;
+
+	_bitmap[offset / 64] &= ~(UINT64_C(1) << (offset % 64));
+	_count--;
+	_trim_bitmap();
+	_update_representation();
+	return true;
 }
 
-static void process_attr_tracker_clear_inclusion_set(struct process_attr_tracker *tracker)
+void lsn::process_attr_id_set::insert(std::vector<id> values)
+{
+	std::sort(values.begin(), values.end());
+	values.erase(std::unique(values.begin(), values.end()), values.end());
+	if (values.empty()) {
+		return;
+	}
+
+	if (!_is_bitmap) {
+		std::vector<id> merged_ids;
+
+		merged_ids.reserve(_sorted_ids.size() + values.size());
+		std::set_union(_sorted_ids.begin(),
+			       _sorted_ids.end(),
+			       values.begin(),
+			       values.end(),
+			       std::back_inserter(merged_ids));
+		_sorted_ids = std::move(merged_ids);
+		_count = _sorted_ids.size();
+		_update_representation();
+		return;
+	}
+
+	const std::uint64_t first_word = _bitmap_base / 64;
+	const auto new_first_word = std::min<std::uint64_t>(values.front() / 64, first_word);
+	const auto new_last_word =
+		std::max<std::uint64_t>(values.back() / 64, first_word + _bitmap.size() - 1);
+	const auto new_word_count = new_last_word - new_first_word + 1;
+
+	if (new_word_count > _count + values.size()) {
+		_use_sorted_ids();
+		insert(std::move(values));
+		return;
+	}
+
+	if (new_word_count != _bitmap.size()) {
+		std::vector<std::uint64_t> bitmap(new_word_count, 0);
+
+		std::copy(_bitmap.begin(),
+			  _bitmap.end(),
+			  bitmap.begin() + (first_word - new_first_word));
+		_bitmap = std::move(bitmap);
+		_bitmap_base = new_first_word * 64;
+	}
+
+	for (const auto value : values) {
+		const auto offset = value - _bitmap_base;
+		const auto bit = UINT64_C(1) << (offset % 64);
+		auto& word = _bitmap[offset / 64];
+
+		if (!(word & bit)) {
+			word |= bit;
+			_count++;
+		}
+	}
+
+	_update_representation();
+}
+
+void lsn::process_attr_id_set::erase(const std::vector<id>& values)
 {
-	if (!tracker->inclusion_set_ht) {
+	if (!_is_bitmap) {
+		std::vector<id> erased_ids(values);
+		std::vector<id> remaining_ids;
+
+		std::sort(erased_ids.begin(), erased_ids.end());
+		remaining_ids.reserve(_sorted_ids.size());
+		std::set_difference(_sorted_ids.begin(),
+				    _sorted_ids.end(),
+				    erased_ids.begin(),
+				    erased_ids.end(),
+				    std::back_inserter(remaining_ids));
+		_sorted_ids = std::move(remaining_ids);
+		_count = _sorted_ids.size();
+		_update_representation();
 		return;
 	}
 
-	for (auto *value_node : lttng::urcu::lfht_iteration_adapter<
-		     process_attr_tracker_value_node,
-		     decltype(process_attr_tracker_value_node::inclusion_set_ht_node),
-		     &process_attr_tracker_value_node::inclusion_set_ht_node>(
-		     *tracker->inclusion_set_ht)) {
-		process_attr_tracker_remove_value_node(tracker, value_node);
+	for (const auto value : values) {
+		if (!contains(value)) {
+			continue;
+		}
+
+		const auto offset = value - _bitmap_base;
+
+		_bitmap[offset / 64] &= ~(UINT64_C(1) << (offset % 64));
+		_count--;
 	}
 
-	const auto ret = cds_lfht_destroy(tracker->inclusion_set_ht, nullptr);
-	LTTNG_ASSERT(ret == 0);
-	tracker->inclusion_set_ht = nullptr;
+	_trim_bitmap();
+	_update_representation();
 }
 
-static int process_attr_tracker_create_inclusion_set(struct process_attr_tracker *tracker)
+void lsn::process_attr_id_set::clear() noexcept
 {
-	LTTNG_ASSERT(!tracker->inclusion_set_ht);
-	tracker->inclusion_set_ht = cds_lfht_new(
-		DEFAULT_HT_SIZE, 1, 0, CDS_LFHT_AUTO_RESIZE | CDS_LFHT_ACCOUNTING, nullptr);
-	return tracker->inclusion_set_ht ? 0 : -1;
+	std::vector<id>().swap(_sorted_ids);
+	std::vector<std::uint64_t>().swap(_bitmap);
+	_bitmap_base = 0;
+	_count = 0;
+	_is_bitmap = false;
 }
 
-void process_attr_tracker_destroy(struct process_attr_tracker *tracker)
+void lsn::process_attr_id_set::_use_bitmap()
+{
+	const std::uint64_t first_word = _sorted_ids.front() / 64;
+	const std::uint64_t last_word = _sorted_ids.back() / 64;
+	std::vector<std::uint64_t> bitmap(last_word - first_word + 1, 0);
+
+	for (const auto value : _sorted_ids) {
+		const auto offset = value - first_word * 64;
+
+		bitmap[offset / 64] |= UINT64_C(1) << (offset % 64);
+	}
+
+	_bitmap = std::move(bitmap);
+	_bitmap_base = first_word * 64;
+	std::vector<id>().swap(_sorted_ids);
+	_is_bitmap = true;
+}
+
+void lsn::process_attr_id_set::_use_sorted_ids()
 {
-	if (!tracker) {
+	std::vector<id> sorted_ids;
+
+	sorted_ids.reserve(_count);
+	for_each([&sorted_ids](id value) { sorted_ids.emplace_back(value); });
+
+	_sorted_ids = std::move(sorted_ids);
+	std::vector<std::uint64_t>().swap(_bitmap);
+	_bitmap_base = 0;
+	_is_bitmap = false;
+}
+
+/*
+ * Switch to the most compact representation of the set. The hysteresis between
+ * both thresholds prevents a set that hovers around one of them from being
+ * converted back and forth.
+ */
+void lsn::process_attr_id_set::_update_representation()
+{
+	try {
+		if (!_is_bitmap) {
+			if (_count < PROCESS_ATTR_ID_SET_BITMAP_MIN_COUNT) {
+				return;
+			}
+
+			const std::uint64_t word_count =
+				_sorted_ids.back() / 64 - _sorted_ids.front() / 64 + 1;
+
+			/* Use a bitmap when it is at most half the size of the sorted vector. */
+			if (word_count * sizeof(std::uint64_t) * 2 <= _count * sizeof(id)) {
+				_use_bitmap();
+			}
+		} else if (_count < PROCESS_ATTR_ID_SET_BITMAP_MIN_COUNT / 2 ||
+			   _bitmap.size() * sizeof(std::uint64_t) > _count * sizeof(id) * 2) {
+			/* The bitmap is more than twice the size of the sorted vector. */
+			_use_sorted_ids();
+		}
+	} catch (const std::bad_alloc&) {
+		/* The set remains usable in its current representation. */
+		DBG("Failed to allocate memory to change the representation of a process attribute value set");
+	}
+}
+
+/* Remove the empty words at both ends of the bitmap. */
+void lsn::process_attr_id_set::_trim_bitmap() noexcept
+{
+	if (_count == 0) {
+		clear();
 		return;
 	}
 
-	process_attr_tracker_clear_inclusion_set(tracker);
-	free(tracker);
+	const auto first_used_word = std::find_if(
+		_bitmap.begin(), _bitmap.end(), [](std::uint64_t word) { return word != 0; });
+	const auto leading_word_count = std::distance(_bitmap.begin(), first_used_word);
+
+	_bitmap.erase(_bitmap.begin(), first_used_word);
+	_bitmap_base += leading_word_count * 64;
+
+	while (_bitmap.back() == 0) {
+		_bitmap.pop_back();
+	}
+}
+
+template <typename InclusionSetType>
+static auto get_inclusion_set_ids(InclusionSetType& inclusion_set,
+				  enum lttng_process_attr_value_type value_type)
+	-> decltype(&inclusion_set.pids)
+{
+	switch (value_type) {
+	case LTTNG_PROCESS_ATTR_VALUE_TYPE_PID:
+		return &inclusion_set.pids;
+	case LTTNG_PROCESS_ATTR_VALUE_TYPE_UID:
+		return &inclusion_set.uids;
+	case LTTNG_PROCESS_ATTR_VALUE_TYPE_GID:
+		return &inclusion_set.gids;
+	default:
+		return nullptr;
+	}
+}
+
+template <typename InclusionSetType>
+static auto get_inclusion_set_names(InclusionSetType& inclusion_set,
+				    enum lttng_process_attr_value_type value_type)
+	-> decltype(&inclusion_set.user_names)
+{
+	switch (value_type) {
+	case LTTNG_PROCESS_ATTR_VALUE_TYPE_USER_NAME:
+		return &inclusion_set.user_names;
+	case LTTNG_PROCESS_ATTR_VALUE_TYPE_GROUP_NAME:
+		return &inclusion_set.group_names;
+	default:
+		return nullptr;
+	}
+}
+
+static lsn::process_attr_id_set::id get_value_id(const struct process_attr_value *value)
+{
+	switch (value->type) {
+	case LTTNG_PROCESS_ATTR_VALUE_TYPE_PID:
+		return (lsn::process_attr_id_set::id) value->value.pid;
+	case LTTNG_PROCESS_ATTR_VALUE_TYPE_UID:
+		return (lsn::process_attr_id_set::id) value->value.uid;
+	case LTTNG_PROCESS_ATTR_VALUE_TYPE_GID:
+		return (lsn::process_attr_id_set::id) value->value.gid;
+	default:
+		abort();
+	}
+}
+
+static const char *get_value_name(const struct process_attr_value *value)
+{
+	switch (value->type) {
+	case LTTNG_PROCESS_ATTR_VALUE_TYPE_USER_NAME:
+		return value->value.user_name;
+	case LTTNG_PROCESS_ATTR_VALUE_TYPE_GROUP_NAME:
+		return value->value.group_name;
+	default:
+		abort();
+	}
+}
+
+static int append_id_value(struct lttng_process_attr_values *values,
+			   enum lttng_process_attr_value_type value_type,
+			   lsn::process_attr_id_set::id id)
+{
+	int ret;
+	struct process_attr_value *value = zmalloc<process_attr_value>();
+
+	if (!value) {
+		return -1;
+	}
+
+	value->type = value_type;
+	switch (value_type) {
+	case LTTNG_PROCESS_ATTR_VALUE_TYPE_PID:
+		value->value.pid = (pid_t) id;
+		break;
+	case LTTNG_PROCESS_ATTR_VALUE_TYPE_UID:
+		value->value.uid = (uid_t) id;
+		break;
+	case LTTNG_PROCESS_ATTR_VALUE_TYPE_GID:
+		value->value.gid = (gid_t) id;
+		break;
+	default:
+		abort();
+	}
+
+	ret = lttng_dynamic_pointer_array_add_pointer(&values->array, value);
+	if (ret) {
+		process_attr_value_destroy(value);
+	}
+
+	return ret;
+}
+
+static int append_name_value(struct lttng_process_attr_values *values,
+			     enum lttng_process_attr_value_type value_type,
+			     const std::string& name)
+{
+	int ret;
+	char *name_copy;
+	struct process_attr_value *value = zmalloc<process_attr_value>();
+
+	if (!value) {
+		return -1;
+	}
+
+	name_copy = strdup(name.c_str());
+	if (!name_copy) {
+		free(value);
+		return -1;
+	}
+
+	value->type = value_type;
+	if (value_type == LTTNG_PROCESS_ATTR_VALUE_TYPE_USER_NAME) {
+		value->value.user_name = name_copy;
+	} else {
+		value->value.group_name = name_copy;
+	}
+
+	ret = lttng_dynamic_pointer_array_add_pointer(&values->array, value);
+	if (ret) {
+		process_attr_value_destroy(value);
+	}
+
+	return ret;
+}
+
+/*
+ * Compute the values to add to and remove from `current` to apply an update
+ * of `requested` values. Both inputs are sorted and free of duplicates.
+ */
+template <typename ValueType>
+static void
+compute_inclusion_set_delta(enum process_attr_tracker_inclusion_set_operation operation,
+			    const std::vector<ValueType>& requested,
+			    const std::vector<ValueType>& current,
+			    std::vector<ValueType>& to_add,
+			    std::vector<ValueType>& to_remove)
+{
+	switch (operation) {
+	case PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_ADD:
+		std::set_difference(requested.begin(),
+				    requested.end(),
+				    current.begin(),
+				    current.end(),
+				    std::back_inserter(to_add));
+		break;
+	case PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_REMOVE:
+		std::set_intersection(requested.begin(),
+				      requested.end(),
+				      current.begin(),
+				      current.end(),
+				      std::back_inserter(to_remove));
+		break;
+	case PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_REPLACE:
+		std::set_difference(requested.begin(),
+				    requested.end(),
+				    current.begin(),
+				    current.end(),
+				    std::back_inserter(to_add));
+		std::set_difference(current.begin(),
+				    current.end(),
+				    requested.begin(),
+				    requested.end(),
+				    std::back_inserter(to_remove));
+		break;
+	default:
+		abort();
+	}
+}
+
+template <typename ValueType>
+static void sort_unique(std::vector<ValueType>& values)
+{
+	std::sort(values.begin(), values.end());
+	values.erase(std::unique(values.begin(), values.end()), values.end());
+}
+
+struct process_attr_tracker *process_attr_tracker_create()
+{
+	struct process_attr_tracker *tracker;
+
+	try {
+		tracker = new process_attr_tracker;
+	} catch (const std::bad_alloc&) {
+		return nullptr;
+	}
+
+	tracker->policy = LTTNG_TRACKING_POLICY_INCLUDE_ALL;
+	return tracker;
+}
+
+static void process_attr_tracker_clear_inclusion_set(struct process_attr_tracker *tracker)
+{
+	tracker->inclusion_set.pids.clear();
+	tracker->inclusion_set.uids.clear();
+	tracker->inclusion_set.gids.clear();
+	std::vector<std::string>().swap(tracker->inclusion_set.user_names);
+	std::vector<std::string>().swap(tracker->inclusion_set.group_names);
+}
+
+void process_attr_tracker_destroy(struct process_attr_tracker *tracker)
+{
+	delete tracker;
 }
 
 enum lttng_tracking_policy
@@ -128,124 +554,314 @@ process_attr_tracker_get_tracking_policy(const struct process_attr_tracker *trac
 int process_attr_tracker_set_tracking_policy(struct process_attr_tracker *tracker,
 					     enum lttng_tracking_policy tracking_policy)
 {
-	int ret = 0;
-
 	if (tracker->policy == tracking_policy) {
-		goto end;
+		return 0;
 	}
 
 	process_attr_tracker_clear_inclusion_set(tracker);
-	ret = process_attr_tracker_create_inclusion_set(tracker);
-	if (ret) {
-		goto end;
-	}
 	tracker->policy = tracking_policy;
-end:
-	return ret;
+	return 0;
 }
 
-static int match_inclusion_set_value(struct cds_lfht_node *node, const void *key)
+/* Protected by session mutex held by caller. */
+enum process_attr_tracker_status
+process_attr_tracker_inclusion_set_add_value(struct process_attr_tracker *tracker,
+					     const struct process_attr_value *value)
 {
-	const struct process_attr_value *value_key = (process_attr_value *) key;
-	const struct process_attr_tracker_value_node *value_node = caa_container_of(
-		node, struct process_attr_tracker_value_node, inclusion_set_ht_node);
+	if (tracker->policy != LTTNG_TRACKING_POLICY_INCLUDE_SET) {
+		return PROCESS_ATTR_TRACKER_STATUS_INVALID_TRACKING_POLICY;
+	}
+
+	try {
+		auto *ids = get_inclusion_set_ids(tracker->inclusion_set, value->type);
 
-	return process_attr_tracker_value_equal(value_node->value, value_key);
+		if (ids) {
+			return ids->insert(get_value_id(value)) ?
+				PROCESS_ATTR_TRACKER_STATUS_OK :
+				PROCESS_ATTR_TRACKER_STATUS_EXISTS;
+		}
+
+		auto& names = *get_inclusion_set_names(tracker->inclusion_set, value->type);
+		const std::string name(get_value_name(value));
+		const auto it = std::lower_bound(names.begin(), names.end(), name);
+
+		if (it != names.end() && *it == name) {
+			return PROCESS_ATTR_TRACKER_STATUS_EXISTS;
+		}
+
+		names.insert(it, name);
+	} catch (const std::bad_alloc&) {
+		return PROCESS_ATTR_TRACKER_STATUS_ERROR;
+	}
+
+	return PROCESS_ATTR_TRACKER_STATUS_OK;
 }
 
-static struct process_attr_tracker_value_node *
-process_attr_tracker_lookup(const struct process_attr_tracker *tracker,
-			    const struct process_attr_value *value)
+/* Protected by session mutex held by caller. */
+enum process_attr_tracker_status
+process_attr_tracker_inclusion_set_remove_value(struct process_attr_tracker *tracker,
+						const struct process_attr_value *value)
 {
-	struct cds_lfht_iter iter;
-	struct cds_lfht_node *node;
-
-	LTTNG_ASSERT(tracker->policy == LTTNG_TRACKING_POLICY_INCLUDE_SET);
-
-	const lttng::urcu::read_lock_guard read_lock;
-	cds_lfht_lookup(tracker->inclusion_set_ht,
-			process_attr_value_hash(value),
-			match_inclusion_set_value,
-			value,
-			&iter);
-	node = cds_lfht_iter_get_node(&iter);
-
-	return node ? lttng::utils::container_of(
-			      node, &process_attr_tracker_value_node::inclusion_set_ht_node) :
-		      nullptr;
+	if (tracker->policy != LTTNG_TRACKING_POLICY_INCLUDE_SET) {
+		return PROCESS_ATTR_TRACKER_STATUS_INVALID_TRACKING_POLICY;
+	}
+
+	try {
+		auto *ids = get_inclusion_set_ids(tracker->inclusion_set, value->type);
+
+		if (ids) {
+			return ids->erase(get_value_id(value)) ?
+				PROCESS_ATTR_TRACKER_STATUS_OK :
+				PROCESS_ATTR_TRACKER_STATUS_MISSING;
+		}
+
+		auto& names = *get_inclusion_set_names(tracker->inclusion_set, value->type);
+		const std::string name(get_value_name(value));
+		const auto it = std::lower_bound(names.begin(), names.end(), name);
+
+		if (it == names.end() || *it != name) {
+			return PROCESS_ATTR_TRACKER_STATUS_MISSING;
+		}
+
+		names.erase(it);
+	} catch (const std::bad_alloc&) {
+		return PROCESS_ATTR_TRACKER_STATUS_ERROR;
+	}
+
+	return PROCESS_ATTR_TRACKER_STATUS_OK;
 }
 
 /* Protected by session mutex held by caller. */
 enum process_attr_tracker_status
-process_attr_tracker_inclusion_set_add_value(struct process_attr_tracker *tracker,
-					     const struct process_attr_value *value)
+process_attr_tracker_inclusion_set_update(
+	struct process_attr_tracker *tracker,
+	enum process_attr_tracker_inclusion_set_operation operation,
+	const struct lttng_process_attr_values *values,
+	struct lttng_process_attr_values **_added_values,
+	struct lttng_process_attr_values **_removed_values)
 {
 	enum process_attr_tracker_status status = PROCESS_ATTR_TRACKER_STATUS_OK;
-	struct process_attr_value *value_copy = nullptr;
-	struct process_attr_tracker_value_node *value_node = nullptr;
+	const unsigned int value_count = _lttng_process_attr_values_get_count(values);
+	struct lttng_process_attr_values *added_values = lttng_process_attr_values_create();
+	struct lttng_process_attr_values *removed_values = lttng_process_attr_values_create();
 
-	const lttng::urcu::read_lock_guard read_lock;
-	if (tracker->policy != LTTNG_TRACKING_POLICY_INCLUDE_SET) {
-		status = PROCESS_ATTR_TRACKER_STATUS_INVALID_TRACKING_POLICY;
+	if (!added_values || !removed_values) {
+		status = PROCESS_ATTR_TRACKER_STATUS_ERROR;
 		goto end;
 	}
 
-	if (process_attr_tracker_lookup(tracker, value)) {
-		status = PROCESS_ATTR_TRACKER_STATUS_EXISTS;
+	if (tracker->policy != LTTNG_TRACKING_POLICY_INCLUDE_SET) {
+		status = PROCESS_ATTR_TRACKER_STATUS_INVALID_TRACKING_POLICY;
 		goto end;
 	}
 
-	value_node = zmalloc<process_attr_tracker_value_node>();
-	if (!value_node) {
-		status = PROCESS_ATTR_TRACKER_STATUS_ERROR;
-		goto end;
-	}
+	try {
+		/*
+		 * The update is applied to a copy of the inclusion set which
+		 * replaces it once all allocations have succeeded.
+		 */
+		process_attr_inclusion_set new_inclusion_set = tracker->inclusion_set;
+
+		for (const auto value_type : integral_value_types) {
+			auto& ids = *get_inclusion_set_ids(new_inclusion_set, value_type);
+			std::vector<lsn::process_attr_id_set::id> requested, current, to_add,
+				to_remove;
+
+			for (unsigned int i = 0; i < value_count; i++) {
+				const auto *value =
+					lttng_process_attr_tracker_values_get_at_index(values, i);
+
+				if (value->type == value_type) {
+					requested.emplace_back(get_value_id(value));
+				}
+			}
+
+			if (requested.empty() &&
+			    operation != PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_REPLACE) {
+				continue;
+			}
+
+			sort_unique(requested);
+			current.reserve(ids.size());
+			ids.for_each([&current](lsn::process_attr_id_set::id id) {
+				current.emplace_back(id);
+			});
+
+			compute_inclusion_set_delta(
+				operation, requested, current, to_add, to_remove);
+			for (const auto id : to_add) {
+				if (append_id_value(added_values, value_type, id)) {
+					status = PROCESS_ATTR_TRACKER_STATUS_ERROR;
+					goto end;
+				}
+			}
+
+			for (const auto id : to_remove) {
+				if (append_id_value(removed_values, value_type, id)) {
+					status = PROCESS_ATTR_TRACKER_STATUS_ERROR;
+					goto end;
+				}
+			}
+
+			ids.erase(to_remove);
+			ids.insert(std::move(to_add));
+		}
+
+		for (const auto value_type : name_value_types) {
+			auto& names = *get_inclusion_set_names(new_inclusion_set, value_type);
+			std::vector<std::string> requested, to_add, to_remove, new_names;
+
+			for (unsigned int i = 0; i < value_count; i++) {
+				const auto *value =
+					lttng_process_attr_tracker_values_get_at_index(values, i);
+
+				if (value->type == value_type) {
+					requested.emplace_back(get_value_name(value));
+				}
+			}
+
+			if (requested.empty() &&
+			    operation != PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_REPLACE) {
+				continue;
+			}
+
+			sort_unique(requested);
+			compute_inclusion_set_delta(operation, requested, names, to_add, to_remove);
+			for (const auto& name : to_add) {
+				if (append_name_value(added_values, value_type, name)) {
+					status = PROCESS_ATTR_TRACKER_STATUS_ERROR;
+					goto end;
+				}
+			}
+
+			for (const auto& name : to_remove) {
+				if (append_name_value(removed_values, value_type, name)) {
+					status = PROCESS_ATTR_TRACKER_STATUS_ERROR;
+					goto end;
+				}
+			}
+
+			new_names.reserve(names.size() + to_add.size());
+			std::set_difference(names.begin(),
+					    names.end(),
+					    to_remove.begin(),
+					    to_remove.end(),
+					    std::back_inserter(new_names));
+			names.clear();
+			std::set_union(new_names.begin(),
+				       new_names.end(),
+				       to_add.begin(),
+				       to_add.end(),
+				       std::back_inserter(names));
+		}
 
-	value_copy = process_attr_value_copy(value);
-	if (!value_copy) {
+		tracker->inclusion_set = std::move(new_inclusion_set);
+	} catch (const std::bad_alloc&) {
 		status = PROCESS_ATTR_TRACKER_STATUS_ERROR;
 		goto end;
 	}
 
-	value_node->value = value_copy;
-	cds_lfht_add(tracker->inclusion_set_ht,
-		     process_attr_value_hash(value_copy),
-		     &value_node->inclusion_set_ht_node);
-	value_copy = nullptr;
-	value_node = nullptr;
-end:
-	if (value_copy) {
-		process_attr_value_destroy(value_copy);
+	if (_added_values) {
+		*_added_values = added_values;
+		added_values = nullptr;
 	}
-	if (value_node) {
-		free(value_node);
+
+	if (_removed_values) {
+		*_removed_values = removed_values;
+		removed_values = nullptr;
 	}
+end:
+	lttng_process_attr_values_destroy(added_values);
+	lttng_process_attr_values_destroy(removed_values);
 	return status;
 }
 
 /* Protected by session mutex held by caller. */
 enum process_attr_tracker_status
-process_attr_tracker_inclusion_set_remove_value(struct process_attr_tracker *tracker,
-						const struct process_attr_value *value)
+process_attr_tracker_inclusion_set_revert_update(
+	struct process_attr_tracker *tracker,
+	const struct lttng_process_attr_values *added_values,
+	const struct lttng_process_attr_values *removed_values)
 {
-	struct process_attr_tracker_value_node *value_node;
-	enum process_attr_tracker_status status = PROCESS_ATTR_TRACKER_STATUS_OK;
+	enum process_attr_tracker_status status;
+
+	status = process_attr_tracker_inclusion_set_update(
+		tracker,
+		PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_REMOVE,
+		added_values,
+		nullptr,
+		nullptr);
+	if (status != PROCESS_ATTR_TRACKER_STATUS_OK) {
+		return status;
+	}
 
-	const lttng::urcu::read_lock_guard read_lock;
-	if (tracker->policy != LTTNG_TRACKING_POLICY_INCLUDE_SET) {
-		status = PROCESS_ATTR_TRACKER_STATUS_INVALID_TRACKING_POLICY;
-		goto end;
+	return process_attr_tracker_inclusion_set_update(
+		tracker,
+		PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_ADD,
+		removed_values,
+		nullptr,
+		nullptr);
+}
+
+enum lttng_error_code
+process_attr_values_get_integral_values(enum lttng_process_attr process_attr,
+					const struct lttng_process_attr_values *values,
+					std::vector<int>& integral_values)
+{
+	const unsigned int value_count = _lttng_process_attr_values_get_count(values);
+
+	try {
+		integral_values.reserve(integral_values.size() + value_count);
+	} catch (const std::bad_alloc&) {
+		return LTTNG_ERR_NOMEM;
 	}
 
-	value_node = process_attr_tracker_lookup(tracker, value);
-	if (!value_node) {
-		status = PROCESS_ATTR_TRACKER_STATUS_MISSING;
-		goto end;
+	for (unsigned int i = 0; i < value_count; i++) {
+		const auto *value = lttng_process_attr_tracker_values_get_at_index(values, i);
+		enum lttng_error_code ret_code;
+		int integral_value;
+
+		switch (process_attr) {
+		case LTTNG_PROCESS_ATTR_PROCESS_ID:
+		case LTTNG_PROCESS_ATTR_VIRTUAL_PROCESS_ID:
+			integral_value = (int) value->value.pid;
+			break;
+		case LTTNG_PROCESS_ATTR_USER_ID:
+		case LTTNG_PROCESS_ATTR_VIRTUAL_USER_ID:
+			if (value->type == LTTNG_PROCESS_ATTR_VALUE_TYPE_USER_NAME) {
+				uid_t uid;
+
+				ret_code = utils_user_id_from_name(value->value.user_name, &uid);
+				if (ret_code != LTTNG_OK) {
+					return ret_code;
+				}
+				integral_value = (int) uid;
+			} else {
+				integral_value = (int) value->value.uid;
+			}
+			break;
+		case LTTNG_PROCESS_ATTR_GROUP_ID:
+		case LTTNG_PROCESS_ATTR_VIRTUAL_GROUP_ID:
+			if (value->type == LTTNG_PROCESS_ATTR_VALUE_TYPE_GROUP_NAME) {
+				gid_t gid;
+
+				ret_code = utils_group_id_from_name(value->value.group_name, &gid);
+				if (ret_code != LTTNG_OK) {
+					return ret_code;
+				}
+				integral_value = (int) gid;
+			} else {
+				integral_value = (int) value->value.gid;
+			}
+			break;
+		default:
+			return LTTNG_ERR_INVALID;
+		}
+
+		integral_values.emplace_back(integral_value);
 	}
 
-	process_attr_tracker_remove_value_node(tracker, value_node);
-end:
-	return status;
+	return LTTNG_OK;
 }
 
 enum process_attr_tracker_status
@@ -254,7 +870,7 @@ process_attr_tracker_get_inclusion_set(const struct process_attr_tracker *tracke
 {
 	enum process_attr_tracker_status status = PROCESS_ATTR_TRACKER_STATUS_OK;
 	struct lttng_process_attr_values *values;
-	struct process_attr_value *new_value = nullptr;
+	const auto& inclusion_set = tracker->inclusion_set;
 
 	values = lttng_process_attr_values_create();
 	if (!values) {
@@ -267,33 +883,33 @@ process_attr_tracker_get_inclusion_set(const struct process_attr_tracker *tracke
 		goto error;
 	}
 
-	for (auto *value_node : lttng::urcu::lfht_iteration_adapter<
-		     process_attr_tracker_value_node,
-		     decltype(process_attr_tracker_value_node::inclusion_set_ht_node),
-		     &process_attr_tracker_value_node::inclusion_set_ht_node>(
-		     *tracker->inclusion_set_ht)) {
-		int ret;
+	for (const auto value_type : integral_value_types) {
+		int ret = 0;
 
-		new_value = process_attr_value_copy(value_node->value);
-		if (!new_value) {
-			status = PROCESS_ATTR_TRACKER_STATUS_ERROR;
-			goto error_unlock;
-		}
-
-		ret = lttng_dynamic_pointer_array_add_pointer(&values->array, new_value);
+		get_inclusion_set_ids(inclusion_set, value_type)
+			->for_each([values, value_type, &ret](lsn::process_attr_id_set::id id) {
+				if (!ret) {
+					ret = append_id_value(values, value_type, id);
+				}
+			});
 		if (ret) {
 			status = PROCESS_ATTR_TRACKER_STATUS_ERROR;
-			goto error_unlock;
+			goto error;
 		}
+	}
 
-		new_value = nullptr;
+	for (const auto value_type : name_value_types) {
+		for (const auto& name : *get_inclusion_set_names(inclusion_set, value_type)) {
+			if (append_name_value(values, value_type, name)) {
+				status = PROCESS_ATTR_TRACKER_STATUS_ERROR;
+				goto error;
+			}
+		}
 	}
 
 	*_values = values;
 	return status;
-error_unlock:
 error:
 	lttng_process_attr_values_destroy(values);
-	process_attr_value_destroy(new_value);
 	return status;
 }
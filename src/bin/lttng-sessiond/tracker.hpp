@@ -13,6 +13,83 @@
 
 #include <lttng/tracker.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lttng {
+namespace sessiond {
+
+/*
+ * Set of integral process attribute values (PIDs, UIDs or GIDs).
+ *
+ * Sparse sets are stored as a sorted vector of values. A set is stored as a
+ * bitmap covering the range of its values when it is dense enough for the
+ * bitmap to be smaller than the vector, which is typically the case of the
+ * PIDs of a large number of worker processes.
+ */
+class process_attr_id_set {
+public:
+	using id = std::uint32_t;
+
+	bool contains(id value) const noexcept;
+	std::size_t size() const noexcept
+	{
+		return _count;
+	}
+
+	/* Returns true if the value was not part of the set. */
+	bool insert(id value);
+	/* Returns true if the value was part of the set. */
+	bool erase(id value);
+
+	/* Insert or erase many values, in any order, at once. */
+	void insert(std::vector<id> values);
+	void erase(const std::vector<id>& values);
+
+	void clear() noexcept;
+
+	/* Visit the values of the set in increasing order. */
+	template <typename VisitorType>
+	void for_each(VisitorType&& visitor) const
+	{
+		if (!_is_bitmap) {
+			for (const auto value : _sorted_ids) {
+				visitor(value);
+			}
+
+			return;
+		}
+
+		for (std::size_t word_index = 0; word_index < _bitmap.size(); word_index++) {
+			auto word = _bitmap[word_index];
+
+			while (word) {
+				const auto bit = static_cast<unsigned int>(__builtin_ctzll(word));
+
+				visitor(static_cast<id>(_bitmap_base + word_index * 64 + bit));
+				word &= word - 1;
+			}
+		}
+	}
+
+private:
+	void _use_bitmap();
+	void _use_sorted_ids();
+	void _update_representation();
+	void _trim_bitmap() noexcept;
+
+	bool _is_bitmap = false;
+	std::size_t _count = 0;
+	std::vector<id> _sorted_ids;
+	/* Value of the first bit of the bitmap; always a multiple of 64. */
+	std::uint64_t _bitmap_base = 0;
+	std::vector<std::uint64_t> _bitmap;
+};
+
+} /* namespace sessiond */
+} /* namespace lttng */
+
 struct process_attr_tracker;
 
 enum process_attr_tracker_status {
@@ -38,6 +115,51 @@ enum process_attr_tracker_status
 process_attr_tracker_inclusion_set_remove_value(struct process_attr_tracker *tracker,
 						const struct process_attr_value *value);
 
+enum process_attr_tracker_inclusion_set_operation {
+	/* Add the values to the inclusion set. */
+	PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_ADD,
+	/* Remove the values from the inclusion set. */
+	PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_REMOVE,
+	/* Replace the contents of the inclusion set by the values. */
+	PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_REPLACE,
+};
+
+/*
+ * Apply an update to the inclusion set of a tracker.
+ *
+ * Values that are already part of the inclusion set are ignored on addition
+ * and values that are not part of the inclusion set are ignored on removal.
+ * On success, the values that were effectively added to and removed from the
+ * inclusion set are returned through `added_values` and `removed_values`,
+ * allowing the caller to only push the difference to the tracers. On error,
+ * the inclusion set is left unchanged.
+ */
+enum process_attr_tracker_status
+process_attr_tracker_inclusion_set_update(struct process_attr_tracker *tracker,
+					  enum process_attr_tracker_inclusion_set_operation operation,
+					  const struct lttng_process_attr_values *values,
+					  struct lttng_process_attr_values **added_values,
+					  struct lttng_process_attr_values **removed_values);
+
+/*
+ * Undo an update applied by process_attr_tracker_inclusion_set_update() using
+ * the values it returned.
+ */
+enum process_attr_tracker_status
+process_attr_tracker_inclusion_set_revert_update(
+	struct process_attr_tracker *tracker,
+	const struct lttng_process_attr_values *added_values,
+	const struct lttng_process_attr_values *removed_values);
+
+/*
+ * Convert process attribute values to the integral representation expected by
+ * the tracers, resolving user and group names.
+ */
+enum lttng_error_code
+process_attr_values_get_integral_values(enum lttng_process_attr process_attr,
+					const struct lttng_process_attr_values *values,
+					std::vector<int>& integral_values);
+
 enum process_attr_tracker_status
 process_attr_tracker_get_inclusion_set(const struct process_attr_tracker *tracker,
 				       struct lttng_process_attr_values **values);
@@ -2427,6 +2427,7 @@ static void shadow_copy_channel(struct ust_app_channel *ua_chan, struct ltt_ust_
 	ua_chan->attr.switch_timer_interval = uchan->attr.switch_timer_interval;
 	ua_chan->attr.read_timer_interval = uchan->attr.read_timer_interval;
 	ua_chan->monitor_timer_interval = uchan->monitor_timer_interval;
+	ua_chan->splice_output = uchan->splice_output;
 	ua_chan->attr.output = (lttng_ust_abi_output) uchan->attr.output;
 	ua_chan->attr.blocking_timeout = uchan->attr.u.s.blocking_timeout;
 	ua_chan->attr.type = static_cast<enum lttng_ust_abi_chan_type>(uchan->attr.u.s.type);
@@ -3147,6 +3148,131 @@ error:
 	return ret;
 }
 
+/*
+ * Ask the consumer to create several channels and get them, in two command
+ * exchanges regardless of the number of channels.
+ *
+ * Called with UST app session lock held.
+ *
+ * On return, `created[i]` tells whether `ua_chans[i]` was created and received.
+ * The channels which were not are destroyed on the consumer side.
+ *
+ * Return 0 on success or else a negative value.
+ */
+static int do_consumer_create_channels(struct ltt_ust_session *usess,
+				       struct ust_app_session *ua_sess,
+				       const std::vector<struct ust_app_channel *>& ua_chans,
+				       int bitness,
+				       lsu::registry_session *registry,
+				       std::vector<bool>& created)
+{
+	int ret;
+	struct consumer_socket *socket;
+	std::vector<int> statuses;
+	std::vector<struct ust_app_channel *> asked_ua_chans;
+	std::vector<unsigned int> stream_fd_counts;
+
+	LTTNG_ASSERT(usess);
+	LTTNG_ASSERT(ua_sess);
+	LTTNG_ASSERT(registry);
+
+	const lttng::urcu::read_lock_guard read_lock;
+	health_code_update();
+
+	try {
+		created.assign(ua_chans.size(), false);
+		asked_ua_chans.reserve(ua_chans.size());
+		stream_fd_counts.reserve(ua_chans.size());
+	} catch (const std::bad_alloc&) {
+		ret = -ENOMEM;
+		goto error;
+	}
+
+	/* Get the right consumer socket for the application. */
+	socket = consumer_find_socket_by_bitness(bitness, usess->consumer);
+	if (!socket) {
+		ret = -EINVAL;
+		goto error;
+	}
+
+	/* Need one fd per channel. */
+	ret = lttng_fd_get(LTTNG_FD_APPS, ua_chans.size());
+	if (ret < 0) {
+		ERR("Exhausted number of available FD upon create channel");
+		goto error;
+	}
+
+	ret = ust_consumer_ask_channels(ua_sess,
+					ua_chans,
+					usess->consumer,
+					socket,
+					registry,
+					usess->current_trace_chunk,
+					statuses);
+	if (ret < 0) {
+		lttng_fd_put(LTTNG_FD_APPS, ua_chans.size());
+		goto error;
+	}
+
+	for (size_t i = 0; i < ua_chans.size(); i++) {
+		/* It must be 2 fds per stream (2 being the default value here). */
+		const unsigned int nb_fd =
+			DEFAULT_UST_STREAM_FD_NUM * ua_chans[i]->expected_stream_count;
+
+		if (statuses[i] < 0) {
+			lttng_fd_put(LTTNG_FD_APPS, 1);
+			continue;
+		}
+
+		/* Reserve the amount of file descriptor we need. */
+		if (lttng_fd_get(LTTNG_FD_APPS, nb_fd) < 0) {
+			ERR("Exhausted number of available FD upon create channel");
+			(void) ust_consumer_destroy_channel(socket, ua_chans[i]);
+			lttng_fd_put(LTTNG_FD_APPS, 1);
+			continue;
+		}
+
+		/* Can't throw as the vectors' capacity was reserved. */
+		asked_ua_chans.emplace_back(ua_chans[i]);
+		stream_fd_counts.emplace_back(nb_fd);
+	}
+
+	health_code_update();
+
+	if (asked_ua_chans.empty()) {
+		ret = 0;
+		goto error;
+	}
+
+	/*
+	 * Now get the channels from the consumer. This call will populate the
+	 * stream list of these channels and set the ust objects.
+	 */
+	ret = ust_consumer_get_channels(socket, asked_ua_chans, statuses);
+	for (size_t i = 0, j = 0; i < ua_chans.size() && j < asked_ua_chans.size(); i++) {
+		if (ua_chans[i] != asked_ua_chans[j]) {
+			continue;
+		}
+
+		if (ret == 0 && statuses[j] == 0) {
+			created[i] = true;
+		} else {
+			lttng_fd_put(LTTNG_FD_APPS, stream_fd_counts[j]);
+			(void) ust_consumer_destroy_channel(socket, ua_chans[i]);
+			lttng_fd_put(LTTNG_FD_APPS, 1);
+		}
+
+		j++;
+	}
+
+	/* The channels that could not be received are reported by the caller. */
+	ret = 0;
+
+error:
+	health_code_update();
+	return ret;
+}
+
 /*
  * Duplicate the ust data object of the ust app stream and save it in the
  * buffer registry stream.
@@ -3607,24 +3733,33 @@ static int create_channel_per_pid(struct ust_app *app,
 	ASSERT_LOCKED(session->_lock);
 	ASSERT_SESSION_LIST_LOCKED();
 
-	/* Create and add a new channel registry to session. */
-	try {
-		registry->add_channel(ua_chan->key,
-				      ust_channel_type_to_allocation_policy(ua_chan->attr.type));
-	} catch (const std::exception& ex) {
-		ERR("Error creating the UST channel \"%s\" registry instance: %s",
-		    ua_chan->name,
-		    ex.what());
-		ret = -1;
-		goto error;
-	}
+	/*
+	 * The channel's registry and buffers already exist if the channel was
+	 * created on the consumer daemon along with the other channels of the
+	 * session (see create_ust_app_channels_per_pid()).
+	 */
+	if (!ua_chan->obj) {
+		/* Create and add a new channel registry to session. */
+		try {
+			registry->add_channel(
+				ua_chan->key,
+				ust_channel_type_to_allocation_policy(ua_chan->attr.type));
+		} catch (const std::exception& ex) {
+			ERR("Error creating the UST channel \"%s\" registry instance: %s",
+			    ua_chan->name,
+			    ex.what());
+			ret = -1;
+			goto error;
+		}
 
-	/* Create and get channel on the consumer side. */
-	ret = do_consumer_create_channel(
-		usess, &ua_sess.get(), ua_chan, app->abi.bits_per_long, registry);
-	if (ret < 0) {
-		ERR("Error creating UST channel \"%s\" on the consumer daemon", ua_chan->name);
-		goto error_remove_from_registry;
+		/* Create and get channel on the consumer side. */
+		ret = do_consumer_create_channel(
+			usess, &ua_sess.get(), ua_chan, app->abi.bits_per_long, registry);
+		if (ret < 0) {
+			ERR("Error creating UST channel \"%s\" on the consumer daemon",
+			    ua_chan->name);
+			goto error_remove_from_registry;
+		}
 	}
 
 	ret = send_channel_pid_to_ust(app, &ua_sess.get(), ua_chan);
@@ -5044,6 +5179,55 @@ static bool is_context_redundant(const struct ltt_ust_channel *uchan,
 	return false;
 }
 
+/*
+ * Create the buffers of an allocated UST app channel if needed, send them to
+ * the application, publish the channel and add its contexts.
+ *
+ * The ua_sess lock must be held by the caller. The channel is deleted on
+ * error.
+ */
+static int ust_app_channel_setup(struct ltt_ust_session *usess,
+				 const ust_app_session::locked_weak_ref& ua_sess,
+				 struct ltt_ust_channel *uchan,
+				 struct ust_app *app,
+				 struct ust_app_channel *ua_chan)
+{
+	int ret;
+
+	ret = ust_app_channel_send(app, usess, ua_sess, ua_chan);
+	if (ret) {
+		goto error;
+	}
+
+	/* Only publish the channel if successfully created on the tracer/consumer. */
+	lttng_ht_add_unique_str(ua_sess->channels, &ua_chan->node);
+
+	/* Add contexts. */
+	for (auto *uctx :
+	     lttng::urcu::list_iteration_adapter<ltt_ust_context, &ltt_ust_context::list>(
+		     uchan->ctx_list)) {
+		if (is_context_redundant(uchan, uctx)) {
+			continue;
+		}
+		ret = create_ust_app_channel_context(ua_chan, &uctx->ctx, app);
+		if (ret) {
+			goto error;
+		}
+	}
+
+error:
+	if (ret < 0) {
+		const auto registry = ust_app_get_session_registry(ua_sess->get_identifier());
+		/* The UST app session lock is held, registry shall not be null. */
+		LTTNG_ASSERT(registry);
+
+		const auto locked_registry = registry->lock();
+		delete_ust_app_channel(-1, ua_chan, app, locked_registry);
+	}
+
+	return ret;
+}
+
 /* The ua_sess lock must be held by the caller.  */
 static int ust_app_channel_create(struct ltt_ust_session *usess,
 				  const ust_app_session::locked_weak_ref& ua_sess,
@@ -5072,38 +5256,15 @@ static int ust_app_channel_create(struct ltt_ust_session *usess,
 			goto error;
 		}
 
-		ret = ust_app_channel_send(app, usess, ua_sess, ua_chan);
-		if (ret) {
+		ret = ust_app_channel_setup(usess, ua_sess, uchan, app, ua_chan);
+		if (ret < 0) {
+			ua_chan = nullptr;
 			goto error;
 		}
-
-		/* Only publish the channel if successfully created on the tracer/consumer. */
-		lttng_ht_add_unique_str(ua_sess->channels, &ua_chan->node);
-
-		/* Add contexts. */
-		for (auto *uctx :
-		     lttng::urcu::list_iteration_adapter<ltt_ust_context, &ltt_ust_context::list>(
-			     uchan->ctx_list)) {
-			if (is_context_redundant(uchan, uctx)) {
-				continue;
-			}
-			ret = create_ust_app_channel_context(ua_chan, &uctx->ctx, app);
-			if (ret) {
-				goto error;
-			}
-		}
 	}
 
 error:
-	if (ret < 0 && ua_chan) {
-		const auto registry = ust_app_get_session_registry(ua_sess->get_identifier());
-		/* The UST app session lock is held, registry shall not be null. */
-		LTTNG_ASSERT(registry);
-
-		const auto locked_registry = registry->lock();
-		delete_ust_app_channel(-1, ua_chan, app, locked_registry);
-		ua_chan = nullptr;
-	} else if (ret == 0 && _ua_chan) {
+	if (ret == 0 && _ua_chan) {
 		/*
 		 * Only return the application's channel on success. Note
 		 * that the channel can still be part of the application's
@@ -5806,6 +5967,9 @@ int ust_app_start_trace_all(struct ltt_ust_session *usess)
 	 */
 	usess->active = true;
 
+	/* The synchronization of the applications applies the pending changes. */
+	usess->app_sync_pending = false;
+
 	/*
 	 * In a start-stop-start use-case, we need to clear the quiescent state
 	 * of each channel set by the prior stop command, thus ensuring that a
@@ -6070,16 +6234,167 @@ end:
 }
 
 /*
+ * Create the channels of a per-PID application session which don't exist yet
+ * with a constant number of exchanges with the consumer daemon, rather than a
+ * few exchanges per channel, then send them to the application.
+ *
+ * The channels that could not be created on the consumer daemon are left to
+ * be created one by one, which reports the error.
+ *
+ * The ua_sess lock and the RCU read lock must be held by the caller.
+ *
+ * Return 0 on success else a negative value.
+ */
+static int create_ust_app_channels_per_pid(struct ltt_ust_session *usess,
+					   const ust_app_session::locked_weak_ref& ua_sess,
+					   struct ust_app *app)
+{
+	int ret = 0;
+	lsu::registry_session *registry;
+	std::vector<struct ltt_ust_channel *> uchans;
+	std::vector<struct ust_app_channel *> ua_chans;
+	std::vector<bool> created;
+
+	ASSERT_RCU_READ_LOCKED();
+
+	registry = ust_app_get_session_registry(ua_sess->get_identifier());
+	/* The UST app session lock is held, registry shall not be null. */
+	LTTNG_ASSERT(registry);
+
+	try {
+		for (auto *uchan :
+		     lttng::urcu::lfht_iteration_adapter<ltt_ust_channel,
+							 decltype(ltt_ust_channel::node),
+							 &ltt_ust_channel::node>(
+			     *usess->domain_global.channels->ht)) {
+			struct lttng_ht_iter iter;
+
+			if (uchans.size() == LTTCOMM_CONSUMER_MAX_CHANNEL_BATCH) {
+				break;
+			}
+
+			if (!strncmp(uchan->name, DEFAULT_METADATA_NAME, sizeof(uchan->name))) {
+				continue;
+			}
+
+			lttng_ht_lookup(ua_sess->channels, (void *) uchan->name, &iter);
+			if (lttng_ht_iter_get_node<lttng_ht_node_str>(&iter)) {
+				continue;
+			}
+
+			uchans.emplace_back(uchan);
+		}
+
+		ua_chans.reserve(uchans.size());
+	} catch (const std::bad_alloc&) {
+		/* Not fatal: the channels are created one by one. */
+		goto end;
+	}
+
+	/* A single channel is created as usual. */
+	if (uchans.size() < 2) {
+		goto end;
+	}
+
+	for (auto *uchan : uchans) {
+		struct ust_app_channel *ua_chan;
+
+		ret = ust_app_channel_allocate(
+			ua_sess,
+			uchan,
+			static_cast<enum lttng_ust_abi_chan_type>(uchan->attr.u.s.type),
+			usess,
+			&ua_chan);
+		if (ret < 0) {
+			goto error;
+		}
+
+		ua_chans.emplace_back(ua_chan);
+
+		/* Create and add a new channel registry to session. */
+		try {
+			registry->add_channel(
+				ua_chan->key,
+				ust_channel_type_to_allocation_policy(ua_chan->attr.type));
+		} catch (const std::exception& ex) {
+			ERR("Error creating the UST channel \"%s\" registry instance: %s",
+			    ua_chan->name,
+			    ex.what());
+			ret = -1;
+			goto error;
+		}
+	}
+
+	DBG("UST app creating %zu channels with per PID buffers", ua_chans.size());
+
+	ret = do_consumer_create_channels(
+		usess, &ua_sess.get(), ua_chans, app->abi.bits_per_long, registry, created);
+	if (ret < 0) {
+		ERR("Error creating UST channels on the consumer daemon");
+		goto error;
+	}
+
+	/*
+	 * Send the created channels to the application. As when the channels
+	 * are created one by one, a channel that fails is deleted and doesn't
+	 * prevent sending the other ones.
+	 */
+	for (size_t i = 0; i < ua_chans.size(); i++) {
+		int setup_ret;
+
+		if (!created[i]) {
+			const auto locked_registry = registry->lock();
+
+			delete_ust_app_channel(-1, ua_chans[i], app, locked_registry);
+			continue;
+		}
+
+		setup_ret = ust_app_channel_setup(usess, ua_sess, uchans[i], app, ua_chans[i]);
+		if (setup_ret < 0 && ret == 0) {
+			ret = setup_ret;
+		}
+	}
+
+	goto end;
+
+error:
+	/* Not published yet. */
+	for (auto *ua_chan : ua_chans) {
+		const auto locked_registry = registry->lock();
+
+		delete_ust_app_channel(-1, ua_chan, app, locked_registry);
+	}
+
+	/* The channels are created one by one instead. */
+	ret = 0;
+end:
+	return ret;
+}
+
+/*
+ * Returns 0 on success or a non-zero value if the application's channels
+ * couldn't be synchronized.
+ *
  * RCU read lock must be held by the caller.
  */
-static void ust_app_synchronize_all_channels(struct ltt_ust_session *usess,
-					     const ust_app_session::locked_weak_ref& ua_sess,
-					     struct ust_app *app)
+static int ust_app_synchronize_all_channels(struct ltt_ust_session *usess,
+					    const ust_app_session::locked_weak_ref& ua_sess,
+					    struct ust_app *app)
 {
+	int ret = 0;
+
 	LTTNG_ASSERT(usess);
 	LTTNG_ASSERT(app);
 	ASSERT_RCU_READ_LOCKED();
 
+	if (usess->buffer_type == LTTNG_BUFFER_PER_PID) {
+		ret = create_ust_app_channels_per_pid(usess, ua_sess, app);
+		if (ret) {
+			/* Tracer is probably gone or ENOMEM. */
+			goto end;
+		}
+	}
+
 	for (auto *uchan : lttng::urcu::lfht_iteration_adapter<ltt_ust_channel,
 							       decltype(ltt_ust_channel::node),
 							       &ltt_ust_channel::node>(
@@ -6093,7 +6408,7 @@ static void ust_app_synchronize_all_channels(struct ltt_ust_session *usess,
 		 * allocated (if necessary) and sent to the application, and
 		 * all enabled contexts will be added to the channel.
 		 */
-		int ret = find_or_create_ust_app_channel(usess, ua_sess, app, uchan, &ua_chan);
+		ret = find_or_create_ust_app_channel(usess, ua_sess, app, uchan, &ua_chan);
 		if (ret) {
 			/* Tracer is probably gone or ENOMEM. */
 			goto end;
@@ -6124,14 +6439,18 @@ static void ust_app_synchronize_all_channels(struct ltt_ust_session *usess,
 		}
 	}
 end:
-	return;
+	return ret;
 }
 
 /*
  * The caller must ensure that the application is compatible and is tracked
  * by the process attribute trackers.
+ *
+ * Returns 0 on success or a negative value if the application's configuration
+ * couldn't be synchronized. The first error is returned; the metadata is
+ * created even if the channels couldn't all be synchronized.
  */
-static void ust_app_synchronize(struct ltt_ust_session *usess, struct ust_app *app)
+static int ust_app_synchronize(struct ltt_ust_session *usess, struct ust_app *app)
 {
 	int ret = 0;
 	struct ust_app_session *ua_sess = nullptr;
@@ -6145,20 +6464,24 @@ static void ust_app_synchronize(struct ltt_ust_session *usess, struct ust_app *a
 	ret = find_or_create_ust_app_session(usess, app, &ua_sess, nullptr);
 	if (ret < 0) {
 		/* Tracer is probably gone or ENOMEM. */
-		return;
+		return ret;
 	}
 
 	LTTNG_ASSERT(ua_sess);
 
 	const auto locked_ua_sess = ua_sess->lock();
 	if (locked_ua_sess->deleted) {
-		return;
+		return 0;
 	}
 
 	{
 		const lttng::urcu::read_lock_guard read_lock;
 
-		ust_app_synchronize_all_channels(usess, locked_ua_sess, app);
+		/* The channels that were created still need the metadata. */
+		const int sync_ret = ust_app_synchronize_all_channels(usess, locked_ua_sess, app);
+		if (sync_ret) {
+			ret = sync_ret < 0 ? sync_ret : -1;
+		}
 
 		/*
 		 * Create the metadata for the application. This returns gracefully if a
@@ -6169,13 +6492,19 @@ static void ust_app_synchronize(struct ltt_ust_session *usess, struct ust_app *a
 		 * daemon, the consumer will use this assumption to send the
 		 * "STREAMS_SENT" message to the relay daemon.
 		 */
-		ret = create_ust_app_metadata(locked_ua_sess, app, usess->consumer);
-		if (ret < 0) {
+		const int metadata_ret =
+			create_ust_app_metadata(locked_ua_sess, app, usess->consumer);
+		if (metadata_ret < 0) {
 			ERR("Metadata creation failed for app sock %d for session id %" PRIu64,
 			    app->sock,
 			    usess->id);
+			if (!ret) {
+				ret = metadata_ret;
+			}
 		}
 	}
+
+	return ret;
 }
 
 static void ust_app_global_destroy(struct ltt_ust_session *usess, struct ust_app *app)
@@ -6192,11 +6521,16 @@ static void ust_app_global_destroy(struct ltt_ust_session *usess, struct ust_app
 /*
  * Add channels/events from UST global domain to registered apps at sock.
  *
+ * Returns 0 on success or a negative value if the application couldn't be
+ * synchronized with the session's configuration.
+ *
  * Called with session lock held.
  * Called with RCU read-side lock held.
  */
-void ust_app_global_update(struct ltt_ust_session *usess, struct ust_app *app)
+int ust_app_global_update(struct ltt_ust_session *usess, struct ust_app *app)
 {
+	int ret;
+
 	LTTNG_ASSERT(usess);
 	LTTNG_ASSERT(usess->active);
 	ASSERT_RCU_READ_LOCKED();
@@ -6204,7 +6538,7 @@ void ust_app_global_update(struct ltt_ust_session *usess, struct ust_app *app)
 	DBG2("UST app global update for app sock %d for session id %" PRIu64, app->sock, usess->id);
 
 	if (!app->compatible) {
-		return;
+		return 0;
 	}
 	if (trace_ust_id_tracker_lookup(LTTNG_PROCESS_ATTR_VIRTUAL_PROCESS_ID, usess, app->pid) &&
 	    trace_ust_id_tracker_lookup(LTTNG_PROCESS_ATTR_VIRTUAL_USER_ID, usess, app->uid) &&
@@ -6213,11 +6547,16 @@ void ust_app_global_update(struct ltt_ust_session *usess, struct ust_app *app)
 		 * Synchronize the application's internal tracing configuration
 		 * and start tracing.
 		 */
-		ust_app_synchronize(usess, app);
-		ust_app_start_trace(usess, app);
+		ret = ust_app_synchronize(usess, app);
+		if (ust_app_start_trace(usess, app) < 0 && !ret) {
+			ret = -1;
+		}
 	} else {
 		ust_app_global_destroy(usess, app);
+		ret = 0;
 	}
+
+	return ret;
 }
 
 /*
@@ -6249,16 +6588,66 @@ void ust_app_global_update_event_notifier_rules(struct ust_app *app)
 }
 
 /*
+ * Record a configuration change of an active session so that it is applied to
+ * the applications by the next synchronization pass rather than immediately.
+ * The changes made in a burst of commands are thus applied in a single pass
+ * over the applications, each receiving the difference between its
+ * configuration and that of the session.
+ *
+ * Returns true if the change is deferred, in which case the caller must not
+ * apply it to the applications itself.
+ *
  * Called with session lock held.
  */
-void ust_app_global_update_all(struct ltt_ust_session *usess)
+bool ust_app_defer_session_update(struct ltt_ust_session *usess)
 {
+	LTTNG_ASSERT(usess->active);
+
+	if (the_config.app_sync_delay == 0) {
+		return false;
+	}
+
+	usess->app_sync_pending = true;
+	return true;
+}
+
+/*
+ * Apply the changes deferred by ust_app_defer_session_update() to the
+ * applications, if any.
+ *
+ * Returns the number of applications which couldn't be synchronized.
+ *
+ * Called with session lock held.
+ */
+unsigned int ust_app_apply_pending_session_update(struct ltt_ust_session *usess)
+{
+	if (!usess->active || !usess->app_sync_pending) {
+		return 0;
+	}
+
+	const lttng::urcu::read_lock_guard read_lock;
+
+	usess->app_sync_pending = false;
+	return ust_app_global_update_all(usess);
+}
+
+/*
+ * Called with session lock held.
+ */
+unsigned int ust_app_global_update_all(struct ltt_ust_session *usess)
+{
+	unsigned int failed_app_count = 0;
+
 	/* Iterate on all apps. */
 	for (auto *app :
 	     lttng::urcu::lfht_iteration_adapter<ust_app, decltype(ust_app::pid_n), &ust_app::pid_n>(
 		     *ust_app_ht->ht)) {
-		ust_app_global_update(usess, app);
+		if (ust_app_global_update(usess, app)) {
+			failed_app_count++;
+		}
 	}
+
+	return failed_app_count;
 }
 
 void ust_app_global_update_all_event_notifier_rules()
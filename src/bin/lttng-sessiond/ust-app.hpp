@@ -179,6 +179,8 @@ struct ust_app_channel {
 	uint64_t tracefile_size;
 	uint64_t tracefile_count;
 	uint64_t monitor_timer_interval;
+	/* Consumed with the splice output (see ltt_ust_channel). */
+	bool splice_output;
 	/*
 	 * Node indexed by channel name in the channels' hash table of a session.
 	 */
@@ -488,8 +490,10 @@ int ust_app_disable_event_glb(struct ltt_ust_session *usess,
 int ust_app_add_ctx_channel_glb(struct ltt_ust_session *usess,
 				struct ltt_ust_channel *uchan,
 				struct ltt_ust_context *uctx);
-void ust_app_global_update(struct ltt_ust_session *usess, struct ust_app *app);
-void ust_app_global_update_all(struct ltt_ust_session *usess);
+bool ust_app_defer_session_update(struct ltt_ust_session *usess);
+unsigned int ust_app_apply_pending_session_update(struct ltt_ust_session *usess);
+int ust_app_global_update(struct ltt_ust_session *usess, struct ust_app *app);
+unsigned int ust_app_global_update_all(struct ltt_ust_session *usess);
 void ust_app_global_update_event_notifier_rules(struct ust_app *app);
 void ust_app_global_update_all_event_notifier_rules();
 
@@ -622,9 +626,28 @@ static inline int ust_app_ht_alloc(void)
 	return 0;
 }
 
-static inline void ust_app_global_update(struct ltt_ust_session *usess __attribute__((unused)),
-					 struct ust_app *app __attribute__((unused)))
+static inline bool ust_app_defer_session_update(struct ltt_ust_session *usess
+						__attribute__((unused)))
 {
+	return false;
+}
+
+static inline unsigned int
+ust_app_apply_pending_session_update(struct ltt_ust_session *usess __attribute__((unused)))
+{
+	return 0;
+}
+
+static inline int ust_app_global_update(struct ltt_ust_session *usess __attribute__((unused)),
+					struct ust_app *app __attribute__((unused)))
+{
+	return 0;
+}
+
+static inline unsigned int
+ust_app_global_update_all(struct ltt_ust_session *usess __attribute__((unused)))
+{
+	return 0;
 }
 
 static inline void ust_app_global_update_event_notifier_rules(struct ust_app *app
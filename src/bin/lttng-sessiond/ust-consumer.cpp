@@ -24,26 +24,26 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <vector>
 
 namespace lsu = lttng::sessiond::ust;
 
 /*
- * Send a single channel to the consumer using command ASK_CHANNEL_CREATION.
+ * Initialize the ASK_CHANNEL_CREATION message of a channel.
  *
- * Consumer socket lock MUST be acquired before calling this.
+ * Return 0 on success else a negative value.
  */
-static int ask_channel_creation(struct ust_app_session *ua_sess,
+static int init_ask_channel_msg(struct ust_app_session *ua_sess,
 				struct ust_app_channel *ua_chan,
 				struct consumer_output *consumer,
-				struct consumer_socket *socket,
 				lsu::registry_session *registry,
-				struct lttng_trace_chunk *trace_chunk)
+				struct lttng_trace_chunk *trace_chunk,
+				struct lttcomm_consumer_msg *msg)
 {
 	int ret, output;
 	uint32_t chan_id;
-	uint64_t key, chan_reg_key;
+	uint64_t chan_reg_key;
 	char *pathname = nullptr;
-	struct lttcomm_consumer_msg msg;
 	char shm_path[PATH_MAX] = "";
 	char root_shm_path[PATH_MAX] = "";
 	bool is_local_trace;
@@ -51,11 +51,9 @@ static int ask_channel_creation(struct ust_app_session *ua_sess,
 
 	LTTNG_ASSERT(ua_sess);
 	LTTNG_ASSERT(ua_chan);
-	LTTNG_ASSERT(socket);
 	LTTNG_ASSERT(consumer);
 	LTTNG_ASSERT(registry);
-
-	DBG2("Asking UST consumer for channel");
+	LTTNG_ASSERT(msg);
 
 	is_local_trace = consumer->net_seq_index == -1ULL;
 	/* Format the channel's path (relative to the current trace chunk). */
@@ -124,11 +122,12 @@ static int ask_channel_creation(struct ust_app_session *ua_sess,
 	switch (ua_chan->attr.output) {
 	case LTTNG_UST_ABI_MMAP:
 	default:
-		output = LTTNG_EVENT_MMAP;
+		/* The tracer maps the buffers in both cases. */
+		output = ua_chan->splice_output ? LTTNG_EVENT_SPLICE : LTTNG_EVENT_MMAP;
 		break;
 	}
 
-	consumer_init_ask_channel_comm_msg(&msg,
+	consumer_init_ask_channel_comm_msg(msg,
 					   ua_chan->attr.subbuf_size,
 					   ua_chan->attr.num_subbuf,
 					   ua_chan->attr.overwrite,
@@ -156,13 +155,25 @@ static int ask_channel_creation(struct ust_app_session *ua_sess,
 					   shm_path,
 					   trace_chunk,
 					   &ua_sess->effective_credentials);
+	ret = 0;
 
-	health_code_update();
+error:
+	free(pathname);
+	return ret;
+}
 
-	ret = consumer_socket_send(socket, &msg, sizeof(msg));
-	if (ret < 0) {
-		goto error;
-	}
+/*
+ * Receive the reply of the consumer to the ASK_CHANNEL_CREATION message of a
+ * channel, setting the number of streams to expect.
+ *
+ * Consumer socket lock MUST be acquired before calling this.
+ */
+static int recv_ask_channel_reply(struct consumer_socket *socket,
+				  struct ust_app_session *ua_sess,
+				  struct ust_app_channel *ua_chan)
+{
+	int ret;
+	uint64_t key;
 
 	ret = consumer_recv_status_channel(socket, &key, &ua_chan->expected_stream_count);
 	if (ret < 0) {
@@ -180,7 +191,43 @@ static int ask_channel_creation(struct ust_app_session *ua_sess,
 	     ua_chan->expected_stream_count);
 
 error:
-	free(pathname);
+	return ret;
+}
+
+/*
+ * Send a single channel to the consumer using command ASK_CHANNEL_CREATION.
+ *
+ * Consumer socket lock MUST be acquired before calling this.
+ */
+static int ask_channel_creation(struct ust_app_session *ua_sess,
+				struct ust_app_channel *ua_chan,
+				struct consumer_output *consumer,
+				struct consumer_socket *socket,
+				lsu::registry_session *registry,
+				struct lttng_trace_chunk *trace_chunk)
+{
+	int ret;
+	struct lttcomm_consumer_msg msg;
+
+	LTTNG_ASSERT(socket);
+
+	DBG2("Asking UST consumer for channel");
+
+	ret = init_ask_channel_msg(ua_sess, ua_chan, consumer, registry, trace_chunk, &msg);
+	if (ret < 0) {
+		goto error;
+	}
+
+	health_code_update();
+
+	ret = consumer_socket_send(socket, &msg, sizeof(msg));
+	if (ret < 0) {
+		goto error;
+	}
+
+	ret = recv_ask_channel_reply(socket, ua_sess, ua_chan);
+
+error:
 	health_code_update();
 	return ret;
 }
@@ -226,32 +273,106 @@ error:
 }
 
 /*
- * Send a get channel command to consumer using the given channel key.  The
- * channel object is populated and the stream list.
+ * Ask consumer to create several channels of a session in a single exchange
+ * using command ASK_CHANNELS_CREATION.
  *
- * Return 0 on success else a negative value.
+ * On return, `statuses[i]` is 0 if the channel `ua_chans[i]` was created, in
+ * which case its number of expected streams is set, or a negative value.
+ *
+ * Session list and rcu read side locks must be held by the caller.
+ *
+ * Returns 0 if the exchange was completed else a negative value.
  */
-int ust_consumer_get_channel(struct consumer_socket *socket, struct ust_app_channel *ua_chan)
+int ust_consumer_ask_channels(struct ust_app_session *ua_sess,
+			      const std::vector<struct ust_app_channel *>& ua_chans,
+			      struct consumer_output *consumer,
+			      struct consumer_socket *socket,
+			      lsu::registry_session *registry,
+			      struct lttng_trace_chunk *trace_chunk,
+			      std::vector<int>& statuses)
 {
 	int ret;
-	struct lttcomm_consumer_msg msg;
+	std::vector<struct lttcomm_consumer_msg> msgs;
 
-	LTTNG_ASSERT(ua_chan);
+	LTTNG_ASSERT(ua_sess);
+	LTTNG_ASSERT(!ua_chans.empty());
+	LTTNG_ASSERT(ua_chans.size() <= LTTCOMM_CONSUMER_MAX_CHANNEL_BATCH);
+	LTTNG_ASSERT(consumer);
 	LTTNG_ASSERT(socket);
+	LTTNG_ASSERT(registry);
 
-	memset(&msg, 0, sizeof(msg));
-	msg.cmd_type = LTTNG_CONSUMER_GET_CHANNEL;
-	msg.u.get_channel.key = ua_chan->key;
+	if (!consumer->enabled) {
+		ret = -LTTNG_ERR_NO_CONSUMER;
+		DBG3("Consumer is disabled");
+		goto error;
+	}
+
+	DBG2("Asking UST consumer for %zu channels", ua_chans.size());
+
+	try {
+		/* The batch header is followed by the message of each channel. */
+		msgs.resize(ua_chans.size() + 1);
+		statuses.assign(ua_chans.size(), -1);
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to allocate channel creation messages");
+		ret = -ENOMEM;
+		goto error;
+	}
+
+	msgs[0].cmd_type = LTTNG_CONSUMER_ASK_CHANNELS_CREATION;
+	msgs[0].u.ask_channels.count = (uint32_t) ua_chans.size();
+	for (size_t i = 0; i < ua_chans.size(); i++) {
+		ret = init_ask_channel_msg(
+			ua_sess, ua_chans[i], consumer, registry, trace_chunk, &msgs[i + 1]);
+		if (ret < 0) {
+			goto error;
+		}
+	}
 
-	pthread_mutex_lock(socket->lock);
 	health_code_update();
 
-	/* Send command and wait for OK reply. */
-	ret = consumer_send_msg(socket, &msg);
+	pthread_mutex_lock(socket->lock);
+	ret = consumer_socket_send(
+		socket, msgs.data(), msgs.size() * sizeof(struct lttcomm_consumer_msg));
 	if (ret < 0) {
-		goto error;
+		goto error_unlock;
 	}
 
+	/* The consumer replies once per channel, in order. */
+	for (size_t i = 0; i < ua_chans.size(); i++) {
+		health_code_update();
+
+		statuses[i] = recv_ask_channel_reply(socket, ua_sess, ua_chans[i]);
+		if (statuses[i] < 0 && *socket->fd_ptr < 0) {
+			ret = -1;
+			goto error_unlock;
+		}
+	}
+
+	ret = 0;
+
+error_unlock:
+	pthread_mutex_unlock(socket->lock);
+	if (ret < 0) {
+		ERR("ask_channels_creation consumer command failed");
+	}
+error:
+	health_code_update();
+	return ret;
+}
+
+/*
+ * Receive a channel object and its stream objects from the consumer once it
+ * replied to a get channel command.
+ *
+ * Consumer socket lock MUST be acquired before calling this.
+ *
+ * Return 0 on success else a negative value.
+ */
+static int recv_channel(struct consumer_socket *socket, struct ust_app_channel *ua_chan)
+{
+	int ret;
+
 	/* First, get the channel from consumer. */
 	ret = lttng_ust_ctl_recv_channel_from_consumer(*socket->fd_ptr, &ua_chan->obj);
 	if (ret < 0) {
@@ -306,10 +427,122 @@ int ust_consumer_get_channel(struct consumer_socket *socket, struct ust_app_chan
 
 	/* Wait for confirmation that we can proceed with the streams. */
 	ret = consumer_recv_status_reply(socket);
+
+error:
+	return ret;
+}
+
+/*
+ * Send a get channel command to consumer using the given channel key.  The
+ * channel object is populated and the stream list.
+ *
+ * Return 0 on success else a negative value.
+ */
+int ust_consumer_get_channel(struct consumer_socket *socket, struct ust_app_channel *ua_chan)
+{
+	int ret;
+	struct lttcomm_consumer_msg msg;
+
+	LTTNG_ASSERT(ua_chan);
+	LTTNG_ASSERT(socket);
+
+	memset(&msg, 0, sizeof(msg));
+	msg.cmd_type = LTTNG_CONSUMER_GET_CHANNEL;
+	msg.u.get_channel.key = ua_chan->key;
+
+	pthread_mutex_lock(socket->lock);
+	health_code_update();
+
+	/* Send command and wait for OK reply. */
+	ret = consumer_send_msg(socket, &msg);
+	if (ret < 0) {
+		goto error;
+	}
+
+	ret = recv_channel(socket, ua_chan);
+
+error:
+	health_code_update();
+	pthread_mutex_unlock(socket->lock);
+	return ret;
+}
+
+/*
+ * Send a GET_CHANNELS command to consumer for several channels created by
+ * the same ASK_CHANNELS_CREATION command. The channels are received
+ * back-to-back, as for successive get channel commands.
+ *
+ * On return, `statuses[i]` is 0 if the channel `ua_chans[i]` was received, in
+ * which case its object and stream list are populated, or a negative value.
+ *
+ * Returns 0 if the exchange was completed else a negative value.
+ */
+int ust_consumer_get_channels(struct consumer_socket *socket,
+			      const std::vector<struct ust_app_channel *>& ua_chans,
+			      std::vector<int>& statuses)
+{
+	int ret;
+	struct lttcomm_consumer_msg msg;
+	std::vector<uint64_t> keys;
+
+	LTTNG_ASSERT(socket);
+	LTTNG_ASSERT(!ua_chans.empty());
+	LTTNG_ASSERT(ua_chans.size() <= LTTCOMM_CONSUMER_MAX_CHANNEL_BATCH);
+
+	try {
+		statuses.assign(ua_chans.size(), -1);
+		for (const auto *ua_chan : ua_chans) {
+			keys.emplace_back(ua_chan->key);
+		}
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to allocate channel keys");
+		return -ENOMEM;
+	}
+
+	memset(&msg, 0, sizeof(msg));
+	msg.cmd_type = LTTNG_CONSUMER_GET_CHANNELS;
+	msg.u.get_channels.count = (uint32_t) keys.size();
+
+	pthread_mutex_lock(socket->lock);
+	health_code_update();
+
+	ret = consumer_socket_send(socket, &msg, sizeof(msg));
+	if (ret < 0) {
+		goto error;
+	}
+
+	ret = consumer_socket_send(socket, keys.data(), keys.size() * sizeof(uint64_t));
 	if (ret < 0) {
 		goto error;
 	}
 
+	for (size_t i = 0; i < ua_chans.size(); i++) {
+		health_code_update();
+
+		/*
+		 * Nothing else is sent for a channel when the consumer replies
+		 * with an error status.
+		 */
+		statuses[i] = consumer_recv_status_reply(socket);
+		if (statuses[i] < 0) {
+			if (*socket->fd_ptr < 0) {
+				ret = -1;
+				goto error;
+			}
+
+			continue;
+		}
+
+		/* The channel and streams can't be told apart from the next channel on error. */
+		statuses[i] = recv_channel(socket, ua_chans[i]);
+		if (statuses[i] < 0) {
+			ret = statuses[i];
+			goto error;
+		}
+	}
+
+	ret = 0;
+
 error:
 	health_code_update();
 	pthread_mutex_unlock(socket->lock);
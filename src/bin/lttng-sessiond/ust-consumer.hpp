@@ -14,6 +14,7 @@
 #include <common/trace-chunk.hpp>
 
 #include <stdint.h>
+#include <vector>
 
 namespace lttng {
 namespace sessiond {
@@ -30,8 +31,20 @@ int ust_consumer_ask_channel(struct ust_app_session *ua_sess,
 			     lttng::sessiond::ust::registry_session *registry,
 			     struct lttng_trace_chunk *trace_chunk);
 
+int ust_consumer_ask_channels(struct ust_app_session *ua_sess,
+			      const std::vector<struct ust_app_channel *>& ua_chans,
+			      struct consumer_output *consumer,
+			      struct consumer_socket *socket,
+			      lttng::sessiond::ust::registry_session *registry,
+			      struct lttng_trace_chunk *trace_chunk,
+			      std::vector<int>& statuses);
+
 int ust_consumer_get_channel(struct consumer_socket *socket, struct ust_app_channel *ua_chan);
 
+int ust_consumer_get_channels(struct consumer_socket *socket,
+			      const std::vector<struct ust_app_channel *>& ua_chans,
+			      std::vector<int>& statuses);
+
 int ust_consumer_destroy_channel(struct consumer_socket *socket, struct ust_app_channel *ua_chan);
 
 int ust_consumer_send_stream_to_ust(struct ust_app *app,
@@ -0,0 +1,401 @@
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ */
+
+#define _LGPL_SOURCE
+#include "batch.hpp"
+
+#include <common/error.hpp>
+#include <common/scope-exit.hpp>
+
+#include <ctype.h>
+#include <errno.h>
+#include <map>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+/* Maximal number of commands running in the background at once. */
+constexpr std::size_t max_background_commands = 16;
+
+struct batch_command {
+	unsigned int line = 0;
+	/* Command as written in the batch, for the reports. */
+	std::string text;
+	std::vector<std::string> words;
+	bool background = false;
+};
+
+/*
+ * Split `line` in words as a shell would, ignoring comments.
+ *
+ * Returns 0 on success, or -1 if a quote is left open.
+ */
+int split_words(const std::string& line, std::vector<std::string>& words)
+{
+	enum class quoting {
+		NONE,
+		SINGLE,
+		DOUBLE,
+	} state = quoting::NONE;
+	std::string word;
+	bool in_word = false;
+
+	for (std::size_t i = 0; i < line.size(); i++) {
+		const char c = line[i];
+
+		switch (state) {
+		case quoting::NONE:
+			if (isspace((unsigned char) c)) {
+				if (in_word) {
+					words.emplace_back(std::move(word));
+					word.clear();
+					in_word = false;
+				}
+
+				break;
+			}
+
+			if (c == '#' && !in_word) {
+				/* Comment up to the end of the line. */
+				i = line.size();
+				break;
+			}
+
+			in_word = true;
+			if (c == '\'') {
+				state = quoting::SINGLE;
+			} else if (c == '"') {
+				state = quoting::DOUBLE;
+			} else if (c == '\\') {
+				if (i + 1 < line.size()) {
+					word += line[++i];
+				}
+			} else {
+				word += c;
+			}
+
+			break;
+		case quoting::SINGLE:
+			if (c == '\'') {
+				state = quoting::NONE;
+			} else {
+				word += c;
+			}
+
+			break;
+		case quoting::DOUBLE:
+			if (c == '"') {
+				state = quoting::NONE;
+			} else if (c == '\\' && i + 1 < line.size() && strchr("\"\\$`", line[i + 1])) {
+				word += line[++i];
+			} else {
+				word += c;
+			}
+
+			break;
+		}
+	}
+
+	if (state != quoting::NONE) {
+		return -1;
+	}
+
+	if (in_word) {
+		words.emplace_back(std::move(word));
+	}
+
+	return 0;
+}
+
+class batch_runner {
+public:
+	batch_runner(bool stop_on_error, lttng::cli::batch_command_runner run_command) :
+		_stop_on_error(stop_on_error), _run_command(run_command)
+	{
+	}
+
+	batch_runner(const batch_runner&) = delete;
+	batch_runner(batch_runner&&) = delete;
+	batch_runner& operator=(const batch_runner&) = delete;
+	batch_runner& operator=(batch_runner&&) = delete;
+
+	~batch_runner()
+	{
+		wait_all();
+	}
+
+	bool failed() const noexcept
+	{
+		return _failed;
+	}
+
+	/* No command may be started anymore. */
+	bool stopped() const noexcept
+	{
+		return _failed && _stop_on_error;
+	}
+
+	void run(batch_command command)
+	{
+		pid_t pid;
+
+		/* Report the commands which completed in the background so far. */
+		while (!_background_commands.empty()) {
+			if (!_wait_any(false)) {
+				break;
+			}
+		}
+
+		while (_background_commands.size() >= max_background_commands) {
+			_wait_any(true);
+		}
+
+		if (stopped()) {
+			return;
+		}
+
+		DBG("Running batch command: line = %u, command = `%s`",
+		    command.line,
+		    command.text.c_str());
+
+		/* Don't let the child flush the output buffered so far a second time. */
+		fflush(stdout);
+		fflush(stderr);
+		pid = fork();
+		if (pid < 0) {
+			PERROR("Failed to fork batch command process: line = %u", command.line);
+			_failed = true;
+			return;
+		}
+
+		if (pid == 0) {
+			_run_child(command);
+		}
+
+		if (command.background) {
+			_background_commands.emplace(pid, std::move(command));
+			return;
+		}
+
+		_wait_command(pid, command);
+	}
+
+	void wait_all()
+	{
+		while (!_background_commands.empty()) {
+			_wait_any(true);
+		}
+	}
+
+private:
+	/* Never returns. */
+	void _run_child(batch_command& command) noexcept
+	{
+		int status;
+
+		try {
+			std::vector<char *> argv;
+
+			for (auto& word : command.words) {
+				argv.emplace_back(&word[0]);
+			}
+
+			argv.emplace_back(nullptr);
+			status = _run_command((int) command.words.size(), argv.data());
+		} catch (const std::exception& ex) {
+			ERR("Failed to run batch command: line = %u, error = `%s`",
+			    command.line,
+			    ex.what());
+			status = 1;
+		}
+
+		fflush(stdout);
+		fflush(stderr);
+
+		/*
+		 * Don't run the exit handlers of the batch process, which may
+		 * also rewind the batch file shared with it.
+		 */
+		_exit(status);
+	}
+
+	void _report(const batch_command& command, int status)
+	{
+		if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+			MSG("Batch line %u: `%s`: success", command.line, command.text.c_str());
+			return;
+		}
+
+		_failed = true;
+		if (WIFEXITED(status)) {
+			ERR("Batch line %u: `%s`: failed with exit status %d",
+			    command.line,
+			    command.text.c_str(),
+			    WEXITSTATUS(status));
+		} else if (WIFSIGNALED(status)) {
+			ERR("Batch line %u: `%s`: killed by signal %d",
+			    command.line,
+			    command.text.c_str(),
+			    WTERMSIG(status));
+		}
+	}
+
+	void _wait_command(pid_t pid, const batch_command& command)
+	{
+		int status;
+		pid_t ret;
+
+		do {
+			ret = waitpid(pid, &status, 0);
+		} while (ret < 0 && errno == EINTR);
+
+		if (ret < 0) {
+			PERROR("Failed to wait for batch command process: line = %u", command.line);
+			_failed = true;
+			return;
+		}
+
+		_report(command, status);
+	}
+
+	/* Returns false if `block` is false and no command completed. */
+	bool _wait_any(bool block)
+	{
+		int status;
+		pid_t pid;
+
+		do {
+			pid = waitpid(-1, &status, block ? 0 : WNOHANG);
+		} while (pid < 0 && errno == EINTR);
+
+		if (pid == 0) {
+			return false;
+		} else if (pid < 0) {
+			PERROR("Failed to wait for batch command processes");
+			_failed = true;
+			_background_commands.clear();
+			return false;
+		}
+
+		const auto it = _background_commands.find(pid);
+		if (it == _background_commands.end()) {
+			/* Not a batch command. */
+			return true;
+		}
+
+		_report(it->second, status);
+		_background_commands.erase(it);
+		return true;
+	}
+
+	const bool _stop_on_error;
+	const lttng::cli::batch_command_runner _run_command;
+	bool _failed = false;
+	std::map<pid_t, batch_command> _background_commands;
+};
+
+int run_batch_file(FILE *file,
+		   const char *path,
+		   bool stop_on_error,
+		   lttng::cli::batch_command_runner run_command)
+{
+	char *line = nullptr;
+	size_t line_size = 0;
+	unsigned int line_number = 0;
+	batch_runner runner(stop_on_error, run_command);
+	const auto free_line = lttng::make_scope_exit([&line]() noexcept { free(line); });
+
+	while (!runner.stopped()) {
+		batch_command command;
+		ssize_t line_len;
+
+		errno = 0;
+		line_len = getline(&line, &line_size, file);
+		if (line_len < 0) {
+			if (errno) {
+				PERROR("Failed to read batch file `%s`", path);
+				return 1;
+			}
+
+			break;
+		}
+
+		line_number++;
+		command.line = line_number;
+		command.text.assign(line, line_len);
+		while (!command.text.empty() && isspace((unsigned char) command.text.back())) {
+			command.text.pop_back();
+		}
+
+		command.text.erase(0, command.text.find_first_not_of(" \t"));
+
+		if (split_words(command.text, command.words)) {
+			ERR("Unterminated quote in batch file `%s`, line %u", path, line_number);
+			return 1;
+		}
+
+		if (!command.words.empty() && command.words.back() == "&") {
+			command.words.pop_back();
+			command.background = true;
+		}
+
+		if (command.words.empty()) {
+			if (command.background) {
+				ERR("Missing command before `&` in batch file `%s`, line %u",
+				    path,
+				    line_number);
+				return 1;
+			}
+
+			continue;
+		}
+
+		if (command.words.size() == 1 && command.words[0] == "wait" &&
+		    !command.background) {
+			runner.wait_all();
+			continue;
+		}
+
+		runner.run(std::move(command));
+	}
+
+	runner.wait_all();
+	return runner.failed() ? 1 : 0;
+}
+} /* namespace */
+
+int lttng::cli::run_batch(const char *path, bool stop_on_error, batch_command_runner run_command)
+{
+	const bool from_stdin = !strcmp(path, "-");
+	FILE *file = from_stdin ? stdin : fopen(path, "r");
+	int ret;
+
+	if (!file) {
+		PERROR("Failed to open batch file `%s`", path);
+		return 1;
+	}
+
+	try {
+		ret = run_batch_file(file, from_stdin ? "<stdin>" : path, stop_on_error, run_command);
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to allocate memory to run batch file `%s`", path);
+		ret = 1;
+	}
+
+	if (!from_stdin && fclose(file)) {
+		PERROR("Failed to close batch file `%s`", path);
+	}
+
+	return ret;
+}
@@ -0,0 +1,40 @@
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ */
+
+#ifndef LTTNG_CLI_BATCH_H
+#define LTTNG_CLI_BATCH_H
+
+namespace lttng {
+namespace cli {
+
+/* Runs a first level command and returns the exit status of `lttng`. */
+using batch_command_runner = int (*)(int argc, char **argv);
+
+/*
+ * Run the commands listed in the file at `path`, or read from the standard
+ * input if `path` is "-".
+ *
+ * Each line holds a first level command and its options, split in words as a
+ * shell would (quotes and backslashes are honored). Empty lines and comments,
+ * starting with `#`, are ignored.
+ *
+ * A command which ends with a `&` word runs in the background: the next
+ * commands don't wait for it. A `wait` line waits for all the commands
+ * running in the background.
+ *
+ * Each command runs in a child process forked from `lttng`, which saves the
+ * start-up of a new process while keeping the state of the commands
+ * independent. The result of each command is reported as it completes.
+ *
+ * Returns 0 if all the commands succeeded, or else 1.
+ */
+int run_batch(const char *path, bool stop_on_error, batch_command_runner run_command);
+
+} /* namespace cli */
+} /* namespace lttng */
+
+#endif /* LTTNG_CLI_BATCH_H */
@@ -38,6 +38,9 @@ const char *indent4 = "    ";
 const char *indent6 = "      ";
 const char *indent8 = "        ";
 
+/* Number of recording event rules fetched from the session daemon at once. */
+#define LIST_EVENTS_PAGE_SIZE 256
+
 #ifdef LTTNG_EMBED_HELP
 static const char help_msg[] =
 #include <lttng-list.1.h>
@@ -1191,72 +1194,78 @@ error:
 }
 
 /*
- * Machine interface
- * print a list of event
+ * List events of channel of session and domain.
+ *
+ * The events are fetched and printed one page at a time so that the memory
+ * usage remains bounded and the output starts early for channels having a
+ * large number of recording event rules.
  */
-static int mi_list_events(struct lttng_event *events, int count)
+static int list_events(const char *channel_name)
 {
-	int ret, i;
+	int ret = CMD_SUCCESS, count, i;
+	unsigned int offset = 0;
 
-	/* Open events element */
-	ret = mi_lttng_events_open(the_writer);
-	if (ret) {
-		goto end;
-	}
+	do {
+		struct lttng_event *events = nullptr;
 
-	for (i = 0; i < count; i++) {
-		ret = mi_lttng_event(the_writer, &events[i], 0, the_handle->domain.type);
-		if (ret) {
+		count = lttng_list_events_page(
+			the_handle, channel_name, offset, LIST_EVENTS_PAGE_SIZE, &events);
+		if (count < 0) {
+			ret = CMD_ERROR;
+			ERR("%s", lttng_strerror(count));
 			goto end;
 		}
-	}
 
-	/* Close events element */
-	ret = mi_lttng_writer_close_element(the_writer);
-
-end:
-	return ret;
-}
-
-/*
- * List events of channel of session and domain.
- */
-static int list_events(const char *channel_name)
-{
-	int ret = CMD_SUCCESS, count, i;
-	struct lttng_event *events = nullptr;
+		if (offset == 0) {
+			if (lttng_opt_mi) {
+				/* Open events element */
+				ret = mi_lttng_events_open(the_writer);
+			} else {
+				MSG("\n%sRecording event rules:", indent4);
+				if (count == 0) {
+					MSG("%sNone", indent6);
+				}
+			}
+		}
 
-	count = lttng_list_events(the_handle, channel_name, &events);
-	if (count < 0) {
-		ret = CMD_ERROR;
-		ERR("%s", lttng_strerror(count));
-		goto error;
-	}
+		for (i = 0; i < count && !ret; i++) {
+			if (lttng_opt_mi) {
+				ret = mi_lttng_event(
+					the_writer, &events[i], 0, the_handle->domain.type);
+			} else {
+				print_events(&events[i]);
+			}
+		}
 
-	if (lttng_opt_mi) {
-		/* Mi print */
-		ret = mi_list_events(events, count);
+		free(events);
 		if (ret) {
 			ret = CMD_ERROR;
 			goto end;
 		}
-	} else {
-		/* Pretty print */
-		MSG("\n%sRecording event rules:", indent4);
-		if (count == 0) {
-			MSG("%sNone\n", indent6);
+
+		if (lttng_opt_mi && mi_lttng_writer_flush(the_writer)) {
+			ret = CMD_ERROR;
 			goto end;
 		}
 
-		for (i = 0; i < count; i++) {
-			print_events(&events[i]);
-		}
+		offset += count;
+		/*
+		 * A session daemon which doesn't support paginated listings
+		 * returns all the events at once, possibly more than a page.
+		 */
+	} while (count == LIST_EVENTS_PAGE_SIZE);
 
+	if (lttng_opt_mi) {
+		/* Close events element */
+		ret = mi_lttng_writer_close_element(the_writer);
+		if (ret) {
+			ret = CMD_ERROR;
+		}
+	} else {
 		MSG("");
 	}
+
 end:
-	free(events);
-error:
 	return ret;
 }
 
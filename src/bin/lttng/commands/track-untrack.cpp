@@ -20,6 +20,7 @@
 
 #include <ctype.h>
 #include <popt.h>
+#include <set>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -28,6 +29,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <urcu/list.h>
+#include <vector>
 
 namespace {
 struct process_attr_command_args {
@@ -219,6 +221,68 @@ end:
 	return cmd_ret;
 }
 
+static enum lttng_process_attr_values_status
+add_integral_value(struct lttng_process_attr_values *values,
+		   enum lttng_process_attr process_attr,
+		   unsigned long value)
+{
+	switch (process_attr) {
+	case LTTNG_PROCESS_ATTR_PROCESS_ID:
+	case LTTNG_PROCESS_ATTR_VIRTUAL_PROCESS_ID:
+		return lttng_process_attr_values_add_pid(values, (pid_t) value);
+	case LTTNG_PROCESS_ATTR_USER_ID:
+	case LTTNG_PROCESS_ATTR_VIRTUAL_USER_ID:
+		return lttng_process_attr_values_add_uid(values, (uid_t) value);
+	case LTTNG_PROCESS_ATTR_GROUP_ID:
+	case LTTNG_PROCESS_ATTR_VIRTUAL_GROUP_ID:
+		return lttng_process_attr_values_add_gid(values, (gid_t) value);
+	default:
+		abort();
+	}
+}
+
+/* Collect the integral values of a set as 32-bit unsigned identifiers. */
+static int get_integral_values(const struct lttng_process_attr_values *values,
+			       std::set<uint32_t>& ids)
+{
+	unsigned int count, i;
+
+	if (lttng_process_attr_values_get_count(values, &count) !=
+	    LTTNG_PROCESS_ATTR_VALUES_STATUS_OK) {
+		return -1;
+	}
+
+	for (i = 0; i < count; i++) {
+		enum lttng_process_attr_values_status status;
+		pid_t pid;
+		uid_t uid;
+		gid_t gid;
+
+		switch (lttng_process_attr_values_get_type_at_index(values, i)) {
+		case LTTNG_PROCESS_ATTR_VALUE_TYPE_PID:
+			status = lttng_process_attr_values_get_pid_at_index(values, i, &pid);
+			ids.insert((uint32_t) pid);
+			break;
+		case LTTNG_PROCESS_ATTR_VALUE_TYPE_UID:
+			status = lttng_process_attr_values_get_uid_at_index(values, i, &uid);
+			ids.insert((uint32_t) uid);
+			break;
+		case LTTNG_PROCESS_ATTR_VALUE_TYPE_GID:
+			status = lttng_process_attr_values_get_gid_at_index(values, i, &gid);
+			ids.insert((uint32_t) gid);
+			break;
+		default:
+			return -1;
+		}
+
+		if (status != LTTNG_PROCESS_ATTR_VALUES_STATUS_OK) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 static enum cmd_error_code run_command_string(enum cmd_type cmd_type,
 					      const char *session_name,
 					      enum lttng_domain_type domain_type,
@@ -234,6 +298,13 @@ static enum cmd_error_code run_command_string(enum cmd_type cmd_type,
 	char *args = strdup(_args);
 	char *iter = args;
 	bool policy_set = false;
+	std::vector<const char *> value_strs;
+	struct lttng_process_attr_values *integral_values = nullptr;
+	struct lttng_process_attr_values *changed_values = nullptr;
+	bool integral_values_updated = false;
+	enum lttng_process_attr_tracker_handle_status integral_values_status =
+		LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK;
+	std::set<uint32_t> changed_ids;
 
 	if (!args) {
 		ERR("%s", lttng_strerror(-LTTNG_ERR_NOMEM));
@@ -247,7 +318,36 @@ static enum cmd_error_code run_command_string(enum cmd_type cmd_type,
 		goto end;
 	}
 
+	/*
+	 * Numerical values are added to (or removed from) the inclusion set
+	 * with a single command; the outcome of each value is then reported
+	 * from the set of values that were effectively changed.
+	 */
+	integral_values = lttng_process_attr_values_create();
+	if (!integral_values) {
+		ERR("%s", lttng_strerror(-LTTNG_ERR_NOMEM));
+		cmd_ret = CMD_FATAL;
+		goto end;
+	}
+
 	while ((one_value_str = strtok_r(iter, ",", &iter)) != nullptr) {
+		value_strs.emplace_back(one_value_str);
+		if (!isdigit(one_value_str[0])) {
+			continue;
+		}
+
+		if (add_integral_value(integral_values,
+				       process_attr,
+				       strtoul(one_value_str, nullptr, 10)) !=
+		    LTTNG_PROCESS_ATTR_VALUES_STATUS_OK) {
+			ERR("%s", lttng_strerror(-LTTNG_ERR_NOMEM));
+			cmd_ret = CMD_FATAL;
+			goto end;
+		}
+	}
+
+	for (const auto value_str : value_strs) {
+		one_value_str = value_str;
 		const bool is_numerical_argument = isdigit(one_value_str[0]);
 		enum lttng_process_attr_tracker_handle_status status;
 		enum lttng_tracking_policy policy;
@@ -283,53 +383,32 @@ static enum cmd_error_code run_command_string(enum cmd_type cmd_type,
 				}
 			}
 
-			switch (process_attr) {
-			case LTTNG_PROCESS_ATTR_PROCESS_ID:
-				status = cmd_type == CMD_TRACK ?
-					lttng_process_attr_process_id_tracker_handle_add_pid(
-						tracker_handle, (pid_t) one_value_int) :
-					lttng_process_attr_process_id_tracker_handle_remove_pid(
-						tracker_handle, (pid_t) one_value_int);
-				break;
-			case LTTNG_PROCESS_ATTR_VIRTUAL_PROCESS_ID:
-				status = cmd_type == CMD_TRACK ?
-					lttng_process_attr_virtual_process_id_tracker_handle_add_pid(
-						tracker_handle, (pid_t) one_value_int) :
-					lttng_process_attr_virtual_process_id_tracker_handle_remove_pid(
-						tracker_handle, (pid_t) one_value_int);
-				break;
-			case LTTNG_PROCESS_ATTR_USER_ID:
-				status = cmd_type == CMD_TRACK ?
-					lttng_process_attr_user_id_tracker_handle_add_uid(
-						tracker_handle, (uid_t) one_value_int) :
-					lttng_process_attr_user_id_tracker_handle_remove_uid(
-						tracker_handle, (uid_t) one_value_int);
-				break;
-			case LTTNG_PROCESS_ATTR_VIRTUAL_USER_ID:
-				status = cmd_type == CMD_TRACK ?
-					lttng_process_attr_virtual_user_id_tracker_handle_add_uid(
-						tracker_handle, (uid_t) one_value_int) :
-					lttng_process_attr_virtual_user_id_tracker_handle_remove_uid(
-						tracker_handle, (uid_t) one_value_int);
-				break;
-			case LTTNG_PROCESS_ATTR_GROUP_ID:
-				status = cmd_type == CMD_TRACK ?
-					lttng_process_attr_group_id_tracker_handle_add_gid(
-						tracker_handle, (gid_t) one_value_int) :
-					lttng_process_attr_group_id_tracker_handle_remove_gid(
-						tracker_handle, (gid_t) one_value_int);
-				break;
-			case LTTNG_PROCESS_ATTR_VIRTUAL_GROUP_ID:
-				status = cmd_type == CMD_TRACK ?
-					lttng_process_attr_virtual_group_id_tracker_handle_add_gid(
-						tracker_handle, (gid_t) one_value_int) :
-					lttng_process_attr_virtual_group_id_tracker_handle_remove_gid(
-						tracker_handle, (gid_t) one_value_int);
-				break;
-			default:
-				abort();
+			if (!integral_values_updated) {
+				integral_values_status = cmd_type == CMD_TRACK ?
+					lttng_process_attr_tracker_handle_add_values(
+						tracker_handle, integral_values, &changed_values) :
+					lttng_process_attr_tracker_handle_remove_values(
+						tracker_handle, integral_values, &changed_values);
+				if (integral_values_status ==
+					    LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK &&
+				    get_integral_values(changed_values, changed_ids)) {
+					integral_values_status =
+						LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_ERROR;
+				}
+
+				integral_values_updated = true;
 			}
 
+			if (integral_values_status != LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK) {
+				status = integral_values_status;
+			} else if (changed_ids.erase((uint32_t) one_value_int)) {
+				status = LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK;
+			} else {
+				/* Duplicates are only reported as changed once. */
+				status = cmd_type == CMD_TRACK ?
+					LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_EXISTS :
+					LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_MISSING;
+			}
 		} else {
 			if (writer) {
 				ret = mi_lttng_string_process_attribute_value(
@@ -444,6 +523,8 @@ static enum cmd_error_code run_command_string(enum cmd_type cmd_type,
 	}
 end:
 	free(args);
+	lttng_process_attr_values_destroy(integral_values);
+	lttng_process_attr_values_destroy(changed_values);
 	lttng_process_attr_tracker_handle_destroy(tracker_handle);
 	return cmd_ret;
 }
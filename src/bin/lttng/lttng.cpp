@@ -6,6 +6,7 @@
  */
 
 #define _LGPL_SOURCE
+#include "batch.hpp"
 #include "command.hpp"
 #include "version.hpp"
 
@@ -40,11 +41,16 @@ char *opt_sessiond_path;
 
 char *opt_relayd_path;
 
+static const char *opt_batch_path;
+static int opt_stop_on_error;
+
 enum {
 	OPT_RELAYD_PATH,
 	OPT_SESSION_PATH,
 	OPT_DUMP_OPTIONS,
 	OPT_DUMP_COMMANDS,
+	OPT_BATCH,
+	OPT_STOP_ON_ERROR,
 };
 
 /* Getopt options. No first level command. */
@@ -59,6 +65,8 @@ static struct option long_options[] = { { "version", 0, nullptr, 'V' },
 					{ "relayd-path", 1, nullptr, OPT_RELAYD_PATH },
 					{ "list-options", 0, nullptr, OPT_DUMP_OPTIONS },
 					{ "list-commands", 0, nullptr, OPT_DUMP_COMMANDS },
+					{ "batch", 1, nullptr, OPT_BATCH },
+					{ "stop-on-error", 0, nullptr, OPT_STOP_ON_ERROR },
 					{ nullptr, 0, nullptr, 0 } };
 
 /* First level command */
@@ -213,10 +221,51 @@ end:
 	return exists;
 }
 
+/*
+ * Run a first level command with its trailing options.
+ *
+ * Return the exit status of lttng.
+ */
+static int run_command(int argc, char **argv)
+{
+	int ret;
+
+	ret = handle_command(argc, argv);
+	switch (ret) {
+	case CMD_WARNING:
+	case CMD_ERROR:
+		break;
+	case CMD_UNDEFINED:
+		if (!command_exists(*argv)) {
+			MSG("lttng: %s is not an lttng command. See 'lttng --help'.", *argv);
+		} else {
+			ERR("Unrecognized argument used with \'%s\' command", *argv);
+		}
+		break;
+	case CMD_FATAL:
+	case CMD_UNSUPPORTED:
+		break;
+	case -1:
+		ret = 1;
+		break;
+	case 0:
+		break;
+	default:
+		if (ret < 0) {
+			ret = -ret;
+		}
+		break;
+	}
+
+	return ret;
+}
+
 static void show_basic_help()
 {
 	puts("Usage: lttng [--group=GROUP] [--mi=TYPE] [--no-sessiond | --sessiond-path=PATH]");
 	puts("             [--quiet | -v | -vv | -vvv] COMMAND [COMMAND OPTIONS]");
+	puts("       lttng [--group=GROUP] [--no-sessiond | --sessiond-path=PATH]");
+	puts("             [--quiet | -v | -vv | -vvv] --batch=FILE [--stop-on-error]");
 	puts("");
 	puts("Available commands:");
 	puts("");
@@ -351,6 +400,12 @@ static int parse_args(int argc, char **argv)
 			list_commands(commands, stdout);
 			ret = 0;
 			goto end;
+		case OPT_BATCH:
+			opt_batch_path = optarg;
+			break;
+		case OPT_STOP_ON_ERROR:
+			opt_stop_on_error = 1;
+			break;
 		default:
 			ret = 1;
 			goto error;
@@ -362,6 +417,33 @@ static int parse_args(int argc, char **argv)
 		lttng_opt_verbose = 0;
 	}
 
+	if (opt_stop_on_error && !opt_batch_path) {
+		ERR("The --stop-on-error option requires the --batch option");
+		ret = 1;
+		goto error;
+	}
+
+	if (opt_batch_path) {
+		if ((argc - optind) != 0) {
+			ERR("A command can't be specified with the --batch option");
+			ret = 1;
+			goto error;
+		}
+
+		/*
+		 * The commands running in the background would interleave
+		 * their MI documents on the standard output.
+		 */
+		if (lttng_opt_mi) {
+			ERR("The --mi option can't be used with the --batch option");
+			ret = 1;
+			goto error;
+		}
+
+		ret = lttng::cli::run_batch(opt_batch_path, opt_stop_on_error, run_command);
+		goto end;
+	}
+
 	/* No leftovers, quit */
 	if ((argc - optind) == 0) {
 		ret = 1;
@@ -372,33 +454,7 @@ static int parse_args(int argc, char **argv)
 	 * Handle leftovers which is a first level command with the trailing
 	 * options.
 	 */
-	ret = handle_command(argc - optind, argv + optind);
-	switch (ret) {
-	case CMD_WARNING:
-	case CMD_ERROR:
-		break;
-	case CMD_UNDEFINED:
-		if (!command_exists(*(argv + optind))) {
-			MSG("lttng: %s is not an lttng command. See 'lttng --help'.",
-			    *(argv + optind));
-		} else {
-			ERR("Unrecognized argument used with \'%s\' command", *(argv + optind));
-		}
-		break;
-	case CMD_FATAL:
-	case CMD_UNSUPPORTED:
-		break;
-	case -1:
-		ret = 1;
-		break;
-	case 0:
-		break;
-	default:
-		if (ret < 0) {
-			ret = -ret;
-		}
-		break;
-	}
+	ret = run_command(argc - optind, argv + optind);
 
 end:
 error:
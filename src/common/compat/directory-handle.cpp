@@ -38,6 +38,16 @@ static int _run_as_mkdir_recursive(const struct lttng_directory_handle *handle,
 				   mode_t mode,
 				   uid_t uid,
 				   gid_t gid);
+static int _run_as_mkdir_recursive_open_files(const struct lttng_directory_handle *handle,
+					      const char *directory,
+					      mode_t directory_mode,
+					      const char *const *file_names,
+					      unsigned int file_count,
+					      int flags,
+					      mode_t mode,
+					      uid_t uid,
+					      gid_t gid,
+					      int *fds);
 static int lttng_directory_handle_open(const struct lttng_directory_handle *handle,
 				       const char *filename,
 				       int flags,
@@ -296,6 +306,29 @@ static int _run_as_mkdir_recursive(const struct lttng_directory_handle *handle,
 	return run_as_mkdirat_recursive(handle->dirfd, path, mode, uid, gid);
 }
 
+static int _run_as_mkdir_recursive_open_files(const struct lttng_directory_handle *handle,
+					      const char *directory,
+					      mode_t directory_mode,
+					      const char *const *file_names,
+					      unsigned int file_count,
+					      int flags,
+					      mode_t mode,
+					      uid_t uid,
+					      gid_t gid,
+					      int *fds)
+{
+	return run_as_mkdirat_recursive_openat_batch(handle->dirfd,
+						     directory,
+						     directory_mode,
+						     file_names,
+						     file_count,
+						     flags,
+						     mode,
+						     uid,
+						     gid,
+						     fds);
+}
+
 static int _lttng_directory_handle_rename(const struct lttng_directory_handle *old_handle,
 					  const char *old_name,
 					  const struct lttng_directory_handle *new_handle,
@@ -743,6 +776,40 @@ end:
 	return ret;
 }
 
+static int _run_as_mkdir_recursive_open_files(const struct lttng_directory_handle *handle,
+					      const char *directory,
+					      mode_t directory_mode,
+					      const char *const *file_names,
+					      unsigned int file_count,
+					      int flags,
+					      mode_t mode,
+					      uid_t uid,
+					      gid_t gid,
+					      int *fds)
+{
+	int ret;
+	char fullpath[LTTNG_PATH_MAX];
+
+	ret = get_full_path(handle, directory ?: "", fullpath, sizeof(fullpath));
+	if (ret) {
+		errno = ENOMEM;
+		goto end;
+	}
+
+	ret = run_as_mkdirat_recursive_openat_batch(AT_FDCWD,
+						    fullpath,
+						    directory_mode,
+						    file_names,
+						    file_count,
+						    flags,
+						    mode,
+						    uid,
+						    gid,
+						    fds);
+end:
+	return ret;
+}
+
 static int _lttng_directory_handle_rename(const struct lttng_directory_handle *old_handle,
 					  const char *old_name,
 					  const struct lttng_directory_handle *new_handle,
@@ -1066,6 +1133,80 @@ int lttng_directory_handle_open_file(const struct lttng_directory_handle *handle
 	return lttng_directory_handle_open_file_as_user(handle, filename, flags, mode, nullptr);
 }
 
+int lttng_directory_handle_create_subdirectory_recursive_open_files_as_user(
+	const struct lttng_directory_handle *handle,
+	const char *directory,
+	mode_t directory_mode,
+	const char *const *file_names,
+	unsigned int file_count,
+	int flags,
+	mode_t mode,
+	const struct lttng_credentials *creds,
+	int *fds)
+{
+	int ret = 0, saved_errno;
+	unsigned int i, opened_count = 0;
+	struct lttng_directory_handle *directory_handle = nullptr;
+
+	if (creds) {
+		return _run_as_mkdir_recursive_open_files(handle,
+							  directory,
+							  directory_mode,
+							  file_names,
+							  file_count,
+							  flags,
+							  mode,
+							  lttng_credentials_get_uid(creds),
+							  lttng_credentials_get_gid(creds),
+							  fds);
+	}
+
+	/* Run as current user. */
+	if (directory) {
+		ret = create_directory_recursive(handle, directory, directory_mode);
+		if (ret) {
+			goto error;
+		}
+
+		directory_handle = lttng_directory_handle_create_from_handle(directory, handle);
+		if (!directory_handle) {
+			ret = -1;
+			goto error;
+		}
+	}
+
+	for (i = 0; i < file_count; i++) {
+		const int fd = lttng_directory_handle_open(
+			directory_handle ?: handle, file_names[i], flags, mode);
+
+		if (fd < 0) {
+			ret = -1;
+			goto error;
+		}
+
+		fds[opened_count++] = fd;
+	}
+
+	lttng_directory_handle_put(directory_handle);
+	return 0;
+
+error:
+	saved_errno = errno;
+
+	/* Either all files are opened or none are. */
+	for (i = 0; i < opened_count; i++) {
+		if (close(fds[i])) {
+			PERROR("Failed to close file descriptor");
+		}
+
+		fds[i] = -1;
+	}
+
+	lttng_directory_handle_put(directory_handle);
+	errno = saved_errno;
+	return ret;
+}
+
 int lttng_directory_handle_unlink_file_as_user(const struct lttng_directory_handle *handle,
 					       const char *filename,
 					       const struct lttng_credentials *creds)
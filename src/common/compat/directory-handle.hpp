@@ -159,6 +159,29 @@ int lttng_directory_handle_open_file_as_user(const struct lttng_directory_handle
 					     mode_t mode,
 					     const struct lttng_credentials *creds);
 
+/*
+ * Recursively create `directory` relative to a directory handle and open the
+ * `file_count` files named by `file_names`, relative to that directory, as a
+ * given user. `directory` may be NULL to open the files relative to the
+ * directory handle.
+ *
+ * When `creds` is set, the operation is performed in a single exchange with
+ * the run-as workers whenever the files fit in a single command.
+ *
+ * On success, `fds` holds `file_count` file descriptors owned by the caller.
+ * On failure, -1 is returned, errno is set, and no file is left open.
+ */
+int lttng_directory_handle_create_subdirectory_recursive_open_files_as_user(
+	const struct lttng_directory_handle *handle,
+	const char *directory,
+	mode_t directory_mode,
+	const char *const *file_names,
+	unsigned int file_count,
+	int flags,
+	mode_t mode,
+	const struct lttng_credentials *creds,
+	int *fds);
+
 /*
  * Unlink a file to a path relative to a directory handle.
  */
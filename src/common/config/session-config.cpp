@@ -418,6 +418,15 @@ end:
 	return ret;
 }
 
+int config_writer_flush(struct config_writer *writer)
+{
+	if (!writer) {
+		return -EINVAL;
+	}
+
+	return xmlTextWriterFlush(writer->writer) < 0 ? -EIO : 0;
+}
+
 int config_writer_open_element(struct config_writer *writer, const char *element_name)
 {
 	if (!writer || !writer->writer || !element_name || !element_name[0]) {
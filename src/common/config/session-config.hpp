@@ -47,6 +47,16 @@ struct config_writer *config_writer_create(int fd_output, int indent);
  */
 int config_writer_destroy(struct config_writer *writer);
 
+/*
+ * Write the content buffered by a configuration writer to its output.
+ *
+ * writer An instance of a configuration writer.
+ *
+ * Returns zero if the buffered content could be written. Negative values
+ * indicate an error.
+ */
+int config_writer_flush(struct config_writer *writer);
+
 /*
  * Open an element tag.
  *
@@ -20,21 +20,30 @@
 #include <common/kernel-consumer/kernel-consumer.hpp>
 #include <common/kernel-ctl/kernel-ctl.hpp>
 #include <common/macros.hpp>
+#include <common/pthread-lock.hpp>
 #include <common/relayd/relayd.hpp>
 #include <common/urcu.hpp>
 #include <common/ust-consumer/ust-consumer.hpp>
 #include <common/utils.hpp>
 
+#include <algorithm>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <new>
+#include <string>
 #include <sys/mman.h>
 #include <unistd.h>
+#include <vector>
 
 #define LTTNG_THROW_DISCARDED_EVENTS_COUNTER_OVERFLOW_ERROR(previous_value, new_value) \
 	throw discarded_events_counter_overflow_error(                                 \
 		previous_value, new_value, LTTNG_SOURCE_LOCATION())
 
 namespace {
+/* Flags and mode with which the stream files are created. */
+constexpr int stream_file_flags = O_WRONLY | O_CREAT | O_TRUNC;
+constexpr mode_t stream_file_mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP;
+
 class discarded_events_counter_overflow_error : public lttng::runtime_error {
 public:
 	explicit discarded_events_counter_overflow_error(uint64_t previous_value_,
@@ -54,6 +63,17 @@ public:
 	const std::uint64_t previous_value;
 	const std::uint64_t current_value;
 };
+
+/* Live beacon deferred until the end of the calling thread's beacon batch. */
+struct deferred_live_beacon {
+	uint64_t net_seq_idx;
+	relayd_index_entry entry;
+};
+
+thread_local bool live_beacon_batch_active;
+thread_local std::vector<deferred_live_beacon> deferred_live_beacons;
+/* Entries of the beacons sent to a given relay daemon; kept to reuse its storage. */
+thread_local std::vector<relayd_index_entry> relayd_live_beacon_entries;
 } /* namespace */
 
 struct metadata_packet_header {
@@ -282,8 +302,22 @@ static ssize_t consumer_stream_consume_splice(struct lttng_consumer_local_data *
 					      struct lttng_consumer_stream *stream,
 					      const struct stream_subbuffer *subbuffer)
 {
+	const struct lttng_buffer_view *buffer = nullptr;
+
+	if (the_consumer_data.type != LTTNG_CONSUMER_KERNEL) {
+		/*
+		 * The pages of user space sub-buffers can only be spliced to
+		 * files; streamed sub-buffers are copied to the socket.
+		 */
+		if (stream->net_seq_idx != (uint64_t) -1ULL) {
+			return consumer_stream_consume_mmap(ctx, stream, subbuffer);
+		}
+
+		buffer = &subbuffer->buffer.buffer;
+	}
+
 	const ssize_t written_bytes = lttng_consumer_on_read_subbuffer_splice(
-		ctx, stream, subbuffer->info.data.padded_subbuf_size, 0);
+		ctx, stream, buffer, subbuffer->info.data.padded_subbuf_size, 0);
 
 	if (written_bytes != subbuffer->info.data.padded_subbuf_size) {
 		DBG("Failed to write the entire padded subbuffer (written_bytes: %zd, padded subbuffer size %lu)",
@@ -942,6 +976,10 @@ void consumer_stream_close_output(struct lttng_consumer_stream *stream)
 		stream->index_file = nullptr;
 	}
 
+	if (stream->next_output_files) {
+		stream->next_output_files->discard();
+	}
+
 	lttng_trace_chunk_put(stream->trace_chunk);
 	stream->trace_chunk = nullptr;
 
@@ -1007,6 +1045,8 @@ void consumer_stream_free(struct lttng_consumer_stream *stream)
 	LTTNG_ASSERT(stream);
 
 	metadata_bucket_destroy(stream->metadata_bucket);
+	delete stream->next_output_files;
+	stream->next_output_files = nullptr;
 	call_rcu(&stream->node.head, free_stream_rcu);
 }
 
@@ -1067,6 +1107,10 @@ void consumer_stream_destroy_buffers(struct lttng_consumer_stream *stream)
 			}
 		}
 
+		if (stream->chan->output == CONSUMER_CHANNEL_SPLICE) {
+			utils_close_pipe(stream->splice_pipe);
+		}
+
 		lttng_ustconsumer_del_stream(stream);
 		break;
 	default:
@@ -1227,12 +1271,168 @@ error:
 	return ret;
 }
 
+static uint64_t next_tracefile_index(const struct lttng_consumer_stream *stream)
+{
+	uint64_t index = stream->tracefile_count_current + 1;
+
+	if (stream->chan->tracefile_count > 0) {
+		index %= stream->chan->tracefile_count;
+	}
+
+	return index;
+}
+
+/*
+ * Start opening the output files of the next tracefile of a data stream in
+ * the background so that its next size-based rotation doesn't have to.
+ */
+static void prepare_next_output_files(struct lttng_consumer_stream *stream)
+{
+	auto *scheduler = stream->chan->output_files_scheduler;
+
+	/* A single tracefile is rewritten in place. */
+	if (!scheduler || stream->metadata_flag || stream->chan->tracefile_size == 0 ||
+	    stream->chan->tracefile_count == 1) {
+		return;
+	}
+
+	if (!stream->next_output_files) {
+		stream->next_output_files =
+			new (std::nothrow) lttng::consumer::output_files_preparation(*scheduler);
+		if (!stream->next_output_files) {
+			return;
+		}
+	}
+
+	stream->next_output_files->prepare(*stream, next_tracefile_index(stream));
+}
+
+/*
+ * Switch to the output files prepared for the current tracefile of the
+ * stream, if any.
+ *
+ * Returns true if the prepared files are used.
+ */
+static bool use_prepared_output_files(struct lttng_consumer_stream *stream)
+{
+	int fd;
+	struct lttng_index_file *index_file;
+
+	if (!stream->next_output_files ||
+	    !stream->next_output_files->take(
+		    *stream, stream->tracefile_count_current, fd, index_file)) {
+		return false;
+	}
+
+	if (stream->out_fd >= 0 && close(stream->out_fd)) {
+		PERROR("Failed to close stream file \"%s\"", stream->name);
+	}
+
+	if (stream->index_file) {
+		lttng_index_file_put(stream->index_file);
+	}
+
+	stream->out_fd = fd;
+	stream->index_file = index_file;
+	stream->tracefile_size_current = 0;
+	stream->out_fd_offset = 0;
+	return true;
+}
+
+void consumer_stream_prepare_rotation_output_files(struct lttng_consumer_channel *channel)
+{
+	const auto ht = the_consumer_data.stream_per_chan_id_ht;
+	std::vector<std::string> file_paths;
+	std::vector<const char *> file_path_ptrs;
+	char path[LTTNG_PATH_MAX];
+
+	ASSERT_LOCKED(channel->lock);
+	ASSERT_RCU_READ_LOCKED();
+
+	/* Both kinds of files are created in a single batch. */
+	static_assert(stream_file_flags == LTTNG_INDEX_FILE_WRITE_FLAGS &&
+			      stream_file_mode == LTTNG_INDEX_FILE_MODE,
+		      "Stream and index files are created with the same flags and mode");
+
+	if (!channel->trace_chunk || !channel->monitor) {
+		return;
+	}
+
+	try {
+		for (auto *stream : lttng::urcu::lfht_filtered_iteration_adapter<
+			     lttng_consumer_stream,
+			     decltype(lttng_consumer_stream::node_channel_id),
+			     &lttng_consumer_stream::node_channel_id,
+			     std::uint64_t>(*ht->ht,
+					    &channel->key,
+					    ht->hash_fct(&channel->key, lttng_ht_seed),
+					    ht->match_fct)) {
+			const lttng::pthread::lock_guard stream_lock(stream->lock);
+
+			if (stream->trace_chunk == channel->trace_chunk) {
+				/* Not rotating to a new trace chunk. */
+				return;
+			}
+
+			if (stream->net_seq_idx != (uint64_t) -1ULL) {
+				continue;
+			}
+
+			/* A rotation restarts from the first tracefile of the stream. */
+			if (utils_stream_file_path(channel->pathname,
+						   stream->name,
+						   channel->tracefile_size,
+						   0,
+						   nullptr,
+						   path,
+						   sizeof(path))) {
+				return;
+			}
+
+			file_paths.emplace_back(path);
+			if (stream->metadata_flag) {
+				continue;
+			}
+
+			if (lttng_index_file_format_path(channel->pathname,
+							 stream->name,
+							 channel->tracefile_size,
+							 0,
+							 path,
+							 sizeof(path))) {
+				return;
+			}
+
+			file_paths.emplace_back(path);
+		}
+
+		for (const auto& file_path : file_paths) {
+			file_path_ptrs.emplace_back(file_path.c_str());
+		}
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to allocate the output file paths of the streams of channel \"%s\"",
+		    channel->name);
+		return;
+	}
+
+	/* On failure, the streams create their files as they complete their rotation. */
+	if (lttng_trace_chunk_prepare_files(channel->trace_chunk,
+					    channel->pathname,
+					    file_path_ptrs.data(),
+					    file_path_ptrs.size(),
+					    stream_file_flags,
+					    stream_file_mode) != LTTNG_TRACE_CHUNK_STATUS_OK) {
+		ERR("Failed to create the output files of the streams of channel \"%s\" ahead of their rotation",
+		    channel->name);
+	}
+}
+
 int consumer_stream_create_output_files(struct lttng_consumer_stream *stream, bool create_index)
 {
 	int ret;
 	enum lttng_trace_chunk_status chunk_status;
-	const int flags = O_WRONLY | O_CREAT | O_TRUNC;
-	const mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP;
+	const int flags = stream_file_flags;
+	const mode_t mode = stream_file_mode;
 	char stream_path[LTTNG_PATH_MAX];
 
 	ASSERT_LOCKED(stream->lock);
@@ -1290,6 +1490,10 @@ int consumer_stream_create_output_files(struct lttng_consumer_stream *stream, bo
 	/* Reset current size because we just perform a rotation. */
 	stream->tracefile_size_current = 0;
 	stream->out_fd_offset = 0;
+
+	if (stream->chan->tracefile_size > 0) {
+		prepare_next_output_files(stream);
+	}
 end:
 	return ret;
 }
@@ -1304,6 +1508,12 @@ int consumer_stream_rotate_output_files(struct lttng_consumer_stream *stream)
 	}
 
 	DBG("Rotating output files of stream \"%s\"", stream->name);
+	if (use_prepared_output_files(stream)) {
+		prepare_next_output_files(stream);
+		ret = 0;
+		goto end;
+	}
+
 	ret = consumer_stream_create_output_files(stream, true);
 	if (ret) {
 		goto end;
@@ -1440,5 +1650,90 @@ int consumer_stream_send_live_beacon(lttng_consumer_stream& stream,
 	index.stream_id = htobe64(stream_id);
 	index.timestamp_end = htobe64(timestamp);
 
+	if (live_beacon_batch_active && stream.net_seq_idx != (uint64_t) -1ULL) {
+		deferred_live_beacon beacon;
+
+		beacon.net_seq_idx = stream.net_seq_idx;
+		beacon.entry.index = index;
+		beacon.entry.relay_stream_id = stream.relayd_stream_id;
+		beacon.entry.net_seq_num = stream.next_net_seq_num - 1;
+
+		try {
+			relayd_live_beacon_entries.reserve(deferred_live_beacons.size() + 1);
+			deferred_live_beacons.emplace_back(beacon);
+			return 0;
+		} catch (const std::bad_alloc&) {
+			/* Fall back to sending the beacon immediately. */
+		}
+	}
+
 	return consumer_stream_write_index(stream, index);
 }
+
+void consumer_stream_begin_live_beacon_batch() noexcept
+{
+	LTTNG_ASSERT(!live_beacon_batch_active);
+	LTTNG_ASSERT(deferred_live_beacons.empty());
+
+	live_beacon_batch_active = true;
+}
+
+int consumer_stream_end_live_beacon_batch() noexcept
+{
+	int ret = 0;
+
+	LTTNG_ASSERT(live_beacon_batch_active);
+	live_beacon_batch_active = false;
+
+	/* Keep the beacons of a relay daemon in the order they were produced. */
+	std::stable_sort(deferred_live_beacons.begin(),
+			 deferred_live_beacons.end(),
+			 [](const deferred_live_beacon& a, const deferred_live_beacon& b) {
+				 return a.net_seq_idx < b.net_seq_idx;
+			 });
+
+	const lttng::urcu::read_lock_guard read_lock;
+	auto group_begin = deferred_live_beacons.begin();
+	while (group_begin != deferred_live_beacons.end()) {
+		const auto net_seq_idx = group_begin->net_seq_idx;
+		auto group_end = group_begin;
+
+		relayd_live_beacon_entries.clear();
+		for (; group_end != deferred_live_beacons.end() &&
+		     group_end->net_seq_idx == net_seq_idx;
+		     group_end++) {
+			/* Storage was reserved as the beacons were deferred. */
+			relayd_live_beacon_entries.emplace_back(group_end->entry);
+		}
+
+		group_begin = group_end;
+
+		auto *relayd = consumer_find_relayd(net_seq_idx);
+		if (!relayd) {
+			ERR("Relayd ID %" PRIu64 " unknown. Can't send %zu live beacons.",
+			    net_seq_idx,
+			    relayd_live_beacon_entries.size());
+			ret = -1;
+			continue;
+		}
+
+		pthread_mutex_lock(&relayd->ctrl_sock_mutex);
+		if (relayd_send_indexes(relayd->control_sock,
+					relayd_live_beacon_entries.data(),
+					relayd_live_beacon_entries.size()) < 0) {
+			/*
+			 * Communication error with lttng-relayd,
+			 * perform cleanup now
+			 */
+			ERR("Relayd send live beacons failed. Cleaning up relayd %" PRIu64 ".",
+			    relayd->net_seq_idx);
+			lttng_consumer_cleanup_relayd(relayd);
+			ret = -1;
+		}
+		pthread_mutex_unlock(&relayd->ctrl_sock_mutex);
+	}
+
+	deferred_live_beacons.clear();
+	relayd_live_beacon_entries.clear();
+	return ret;
+}
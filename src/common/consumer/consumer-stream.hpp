@@ -86,6 +86,16 @@ int consumer_stream_write_index(lttng_consumer_stream& stream, const ctf_packet_
 
 int consumer_stream_sync_metadata(struct lttng_consumer_local_data *ctx, uint64_t session_id);
 
+/*
+ * Create the output files of the local streams of a channel rotating to a new
+ * trace chunk in as few exchanges with the run-as workers as possible. The
+ * streams use these files once they complete their rotation.
+ *
+ * This must be called with the channel's lock and the RCU read lock held,
+ * before the rotation positions of the streams are sampled.
+ */
+void consumer_stream_prepare_rotation_output_files(struct lttng_consumer_channel *channel);
+
 /*
  * Create the output files of a local stream.
  *
@@ -152,4 +162,19 @@ int consumer_stream_send_live_beacon(lttng_consumer_stream& stream,
 				     uint64_t timestamp,
 				     uint64_t stream_id);
 
+/*
+ * Defer the live beacons sent by the calling thread to a relay daemon until
+ * consumer_stream_end_live_beacon_batch() is called. The beacons are then sent
+ * as a single batch of index commands per relay daemon.
+ *
+ * The payload of a beacon is sampled under the stream's lock, but the batch is
+ * sent without holding the locks of the streams. A beacon can thus reach the
+ * relay daemon after the index of a newer packet of its stream, in which case
+ * the relay daemon ignores it.
+ */
+void consumer_stream_begin_live_beacon_batch() noexcept;
+
+/* Send the live beacons deferred by the calling thread. Return 0 on success. */
+int consumer_stream_end_live_beacon_batch() noexcept;
+
 #endif /* LTTNG_CONSUMER_STREAM_H */
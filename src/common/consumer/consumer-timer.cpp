@@ -21,6 +21,10 @@
 #include <common/ust-consumer/ust-consumer.hpp>
 
 #include <inttypes.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
 
 namespace {
 bool is_userspace_consumer() noexcept
@@ -36,6 +40,68 @@ bool is_userspace_consumer() noexcept
 		abort();
 	}
 }
+
+/*
+ * The live and monitor timer tasks are shared by the channels of a session that
+ * use the same timer period so that a single pass handles all of them.
+ */
+template <typename TaskType>
+struct session_timer_tasks {
+	/* Session id and period (ns) of a task. */
+	using key = std::pair<std::uint64_t, lttng::scheduling::duration_ns::rep>;
+
+	/* Held while channels are added to or removed from the tasks. */
+	std::mutex lock;
+	std::map<key, std::weak_ptr<TaskType>> tasks;
+};
+
+session_timer_tasks<lttng::consumer::live_timer_task> the_live_timer_tasks;
+session_timer_tasks<lttng::consumer::monitor_timer_task> the_monitor_timer_tasks;
+
+/*
+ * Add a channel to the timer task of its session running at the given period. The task
+ * is created using `create_task` and scheduled if the session has no such task.
+ *
+ * Throws std::bad_alloc.
+ */
+template <typename TaskType, typename CreateTaskFunction>
+std::shared_ptr<TaskType> add_channel_to_session_timer_task(session_timer_tasks<TaskType>& tasks,
+							    lttng_consumer_channel& channel,
+							    lttng::scheduling::duration_ns period,
+							    lttng::scheduling::scheduler& scheduler,
+							    CreateTaskFunction create_task)
+{
+	const std::lock_guard<std::mutex> lock(tasks.lock);
+	auto& registered_task = tasks.tasks[std::make_pair(channel.session_id, period.count())];
+
+	auto task = registered_task.lock();
+	if (task) {
+		task->add_channel(channel);
+		return task;
+	}
+
+	task = create_task();
+	task->add_channel(channel);
+	scheduler.schedule(task, std::chrono::steady_clock::now() + period);
+	registered_task = task;
+	return task;
+}
+
+/* Remove a channel from its session's timer task, which is canceled if it has no channel left. */
+template <typename TaskType>
+void remove_channel_from_session_timer_task(session_timer_tasks<TaskType>& tasks,
+					    lttng_consumer_channel& channel,
+					    TaskType& task) noexcept
+{
+	const std::lock_guard<std::mutex> lock(tasks.lock);
+
+	if (task.remove_channel(channel) != 0) {
+		return;
+	}
+
+	task.cancel();
+	tasks.tasks.erase(std::make_pair(channel.session_id, task.period().count()));
+}
 } /* namespace */
 
 static int the_channel_monitor_pipe = -1;
@@ -96,12 +162,16 @@ void consumer_timer_live_start(struct lttng_consumer_channel *channel,
 	}
 
 	try {
-		channel->live_timer_task = std::make_shared<lttng::consumer::live_timer_task>(
-			std::chrono::microseconds(live_timer_interval_us), *channel);
-
-		scheduler.schedule(channel->live_timer_task,
-				   std::chrono::steady_clock::now() +
-					   std::chrono::microseconds(live_timer_interval_us));
+		channel->live_timer_task = add_channel_to_session_timer_task(
+			the_live_timer_tasks,
+			*channel,
+			std::chrono::microseconds(live_timer_interval_us),
+			scheduler,
+			[channel, live_timer_interval_us]() {
+				return std::make_shared<lttng::consumer::live_timer_task>(
+					std::chrono::microseconds(live_timer_interval_us),
+					channel->session_id);
+			});
 	} catch (const std::bad_alloc& e) {
 		ERR_FMT("Failed to allocate memory for live timer task: {}: channel_name=`{}`, key={}, session_id={}",
 			e.what(),
@@ -120,8 +190,11 @@ void consumer_timer_live_stop(struct lttng_consumer_channel *channel)
 		return;
 	}
 
-	/* Cancel the live timer task if it is scheduled. */
-	channel->live_timer_task->cancel();
+	/* Cancel the live timer task if this was the last channel using it. */
+	remove_channel_from_session_timer_task(
+		the_live_timer_tasks,
+		*channel,
+		static_cast<lttng::consumer::live_timer_task&>(*channel->live_timer_task));
 	channel->live_timer_task.reset();
 }
 
@@ -146,14 +219,17 @@ int consumer_timer_monitor_start(struct lttng_consumer_channel *channel,
 	}
 
 	try {
-		channel->monitor_timer_task = std::make_shared<lttng::consumer::monitor_timer_task>(
-			std::chrono::microseconds(monitor_timer_interval_us),
+		channel->monitor_timer_task = add_channel_to_session_timer_task(
+			the_monitor_timer_tasks,
 			*channel,
-			consumer_timer_thread_get_channel_monitor_pipe());
-
-		scheduler.schedule(channel->monitor_timer_task,
-				   std::chrono::steady_clock::now() +
-					   std::chrono::microseconds(monitor_timer_interval_us));
+			std::chrono::microseconds(monitor_timer_interval_us),
+			scheduler,
+			[channel, monitor_timer_interval_us]() {
+				return std::make_shared<lttng::consumer::monitor_timer_task>(
+					std::chrono::microseconds(monitor_timer_interval_us),
+					channel->session_id,
+					consumer_timer_thread_get_channel_monitor_pipe());
+			});
 	} catch (const std::bad_alloc& e) {
 		ERR_FMT("Failed to allocate memory for live timer task: {}: channel_name=`{}`, key={}, session_id={}",
 			e.what(),
@@ -174,12 +250,28 @@ int consumer_timer_monitor_stop(struct lttng_consumer_channel *channel)
 	LTTNG_ASSERT(channel);
 	LTTNG_ASSERT(channel->monitor_timer_task);
 
-	/* Cancel the monitor timer task if it is scheduled. */
-	channel->monitor_timer_task->cancel();
+	/* Cancel the monitor timer task if this was the last channel using it. */
+	remove_channel_from_session_timer_task(
+		the_monitor_timer_tasks,
+		*channel,
+		static_cast<lttng::consumer::monitor_timer_task&>(*channel->monitor_timer_task));
 	channel->monitor_timer_task.reset();
 	return 0;
 }
 
+/*
+ * Send a buffer statistics sample of the channel to the session daemon
+ * without waiting for the next expiration of its monitoring task.
+ */
+void consumer_timer_monitor_sample(struct lttng_consumer_channel *channel)
+{
+	LTTNG_ASSERT(channel);
+	LTTNG_ASSERT(channel->monitor_timer_task);
+
+	static_cast<lttng::consumer::monitor_timer_task&>(*channel->monitor_timer_task)
+		.sample_channel(*channel);
+}
+
 int consumer_timer_thread_get_channel_monitor_pipe()
 {
 	return uatomic_read(&the_channel_monitor_pipe);
@@ -28,6 +28,7 @@ int consumer_timer_monitor_start(struct lttng_consumer_channel *channel,
 				 unsigned int monitor_timer_interval_us,
 				 lttng::scheduling::scheduler& scheduler);
 int consumer_timer_monitor_stop(struct lttng_consumer_channel *channel);
+void consumer_timer_monitor_sample(struct lttng_consumer_channel *channel);
 
 int consumer_timer_thread_get_channel_monitor_pipe();
 int consumer_timer_thread_set_channel_monitor_pipe(int fd);
@@ -11,6 +11,7 @@
 #include <common/align.hpp>
 #include <common/common.hpp>
 #include <common/compat/endian.hpp>
+#include <common/compat/getenv.hpp>
 #include <common/compat/poll.hpp>
 #include <common/consumer/consumer-metadata-cache.hpp>
 #include <common/consumer/consumer-stream.hpp>
@@ -36,8 +37,12 @@
 #include <common/utils.hpp>
 
 #include <bin/lttng-consumerd/health-consumerd.hpp>
+#include <algorithm>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <limits.h>
+#include <memory>
+#include <new>
 #include <poll.h>
 #include <pthread.h>
 #include <signal.h>
@@ -46,8 +51,12 @@
 #include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <type_traits>
 #include <unistd.h>
+#include <vector>
+
+#define CONSUMERD_TIMER_TASK_MAX_WORKER_COUNT 64
 
 lttng_consumer_global_data the_consumer_data;
 
@@ -322,6 +331,7 @@ static void free_relayd_rcu(struct rcu_head *head)
 	(void) relayd_close(&relayd->control_sock);
 	(void) relayd_close(&relayd->data_sock);
 
+	delete relayd->metadata_fragment_store;
 	pthread_mutex_destroy(&relayd->ctrl_sock_mutex);
 	free(relayd);
 }
@@ -375,7 +385,7 @@ void consumer_del_channel(struct lttng_consumer_channel *channel)
 		 * Send a last buffer statistics sample to the session daemon
 		 * to ensure it tracks the amount of data consumed by this channel.
 		 */
-		channel->monitor_timer_task->run(std::chrono::steady_clock::now());
+		consumer_timer_monitor_sample(channel);
 		consumer_timer_monitor_stop(channel);
 	}
 
@@ -1357,6 +1367,14 @@ static void lttng_consumer_sync_trace_file(struct lttng_consumer_stream *stream,
 		outfd, orig_offset - stream->max_sb_size, stream->max_sb_size);
 }
 
+unsigned int consumer_get_timer_task_worker_count()
+{
+	return (unsigned int) utils_get_positive_env_value(
+		DEFAULT_CONSUMERD_TIMER_TASK_WORKER_COUNT_ENV,
+		DEFAULT_CONSUMERD_TIMER_TASK_WORKER_COUNT,
+		CONSUMERD_TIMER_TASK_MAX_WORKER_COUNT);
+}
+
 /*
  * Initialise the necessary environnement :
  * - create a new context
@@ -1567,6 +1585,42 @@ end:
 	return (int) ret;
 }
 
+/*
+ * Query whether the relay daemon accepts metadata packets sent as fragments
+ * the first time a metadata packet is sent to it.
+ *
+ * The control socket lock MUST be acquired.
+ *
+ * Returns 0 on success, a negative value if the relay daemon can't be reached.
+ */
+static int query_relayd_metadata_fragments_support(struct consumer_relayd_sock_pair *relayd)
+{
+	int ret;
+	uint64_t relayd_configuration_flags;
+
+	if (relayd->metadata_fragments_support_queried) {
+		return 0;
+	}
+
+	ret = relayd_get_configuration(&relayd->control_sock, 0, &relayd_configuration_flags);
+	if (ret < 0) {
+		return ret;
+	}
+
+	relayd->metadata_fragments_support_queried = true;
+	if (!(relayd_configuration_flags &
+	      LTTCOMM_RELAYD_CONFIGURATION_FLAG_METADATA_FRAGMENTS)) {
+		return 0;
+	}
+
+	/* Fall back to sending complete metadata packets on allocation failure. */
+	relayd->metadata_fragment_store = new (std::nothrow) lttng::relayd::metadata_fragment_store;
+	DBG("Relayd %" PRIu64 " metadata packets sent as fragments: %s",
+	    relayd->net_seq_idx,
+	    relayd->metadata_fragment_store ? "yes" : "no");
+	return 0;
+}
+
 /*
  * Mmap the ring buffer, read it and write the data to the tracefile. This is a
  * core function for writing trace buffers to either the local filesystem or
@@ -1625,6 +1679,33 @@ ssize_t lttng_consumer_on_read_subbuffer_mmap(struct lttng_consumer_stream *stre
 				}
 				stream->reset_metadata_flag = 0;
 			}
+
+			ret = query_relayd_metadata_fragments_support(relayd);
+			if (ret < 0) {
+				relayd_hang_up = 1;
+				goto write_error;
+			}
+
+			if (relayd->metadata_fragment_store) {
+				const auto packet = lttng_buffer_view_from_view(
+					buffer, 0, subbuf_content_size);
+
+				ret = relayd_send_metadata_fragments(
+					&relayd->control_sock,
+					*relayd->metadata_fragment_store,
+					stream->relayd_stream_id,
+					&packet,
+					padding);
+				if (ret < 0) {
+					relayd_hang_up = 1;
+					goto write_error;
+				}
+
+				ret = subbuf_content_size;
+				stream->output_written += ret;
+				goto end;
+			}
+
 			netlen += sizeof(struct lttcomm_relayd_metadata_payload);
 		}
 
@@ -1737,12 +1818,17 @@ end:
 /*
  * Splice the data from the ring buffer to the tracefile.
  *
+ * Kernel sub-buffers are spliced from the stream's file descriptor. The pages
+ * of user space sub-buffers, mapped at `buffer`, are vmsplice'd into the
+ * splice pipe.
+ *
  * It must be called with the stream lock held.
  *
  * Returns the number of bytes spliced.
  */
 ssize_t lttng_consumer_on_read_subbuffer_splice(struct lttng_consumer_local_data *ctx,
 						struct lttng_consumer_stream *stream,
+						const struct lttng_buffer_view *buffer,
 						unsigned long len,
 						unsigned long padding)
 {
@@ -1761,8 +1847,20 @@ ssize_t lttng_consumer_on_read_subbuffer_splice(struct lttng_consumer_local_data
 		break;
 	case LTTNG_CONSUMER32_UST:
 	case LTTNG_CONSUMER64_UST:
-		/* Not supported for user space tracing */
-		return -ENOSYS;
+		/*
+		 * The pipe references the pages of the sub-buffer, which is
+		 * released to the tracer once the pipe is drained. Splicing the
+		 * pipe to a file copies the pages, but a socket may still
+		 * reference them after splice() returns: only file outputs are
+		 * supported.
+		 */
+		LTTNG_ASSERT(buffer);
+		LTTNG_ASSERT(len <= buffer->size);
+		if (stream->net_seq_idx != (uint64_t) -1ULL || stream->metadata_flag) {
+			return -ENOSYS;
+		}
+
+		break;
 	default:
 		ERR("Unknown consumer_data type");
 		abort();
@@ -1849,14 +1947,36 @@ ssize_t lttng_consumer_on_read_subbuffer_splice(struct lttng_consumer_local_data
 	}
 
 	while (len > 0) {
-		DBG("splice chan to pipe offset %lu of len %lu (fd : %d, pipe: %d)",
-		    (unsigned long) offset,
-		    len,
-		    fd,
-		    splice_pipe[1]);
-		ret_splice = splice(
-			fd, &offset, splice_pipe[1], nullptr, len, SPLICE_F_MOVE | SPLICE_F_MORE);
-		DBG("splice chan to pipe, ret %zd", ret_splice);
+		if (buffer) {
+			struct iovec iov;
+
+			iov.iov_base = (void *) (buffer->data + offset);
+			iov.iov_len = len;
+			DBG("vmsplice sub-buffer to pipe offset %lu of len %lu (pipe: %d)",
+			    (unsigned long) offset,
+			    len,
+			    splice_pipe[1]);
+			/* Returns once the pipe is full; it is drained below. */
+			ret_splice = vmsplice(splice_pipe[1], &iov, 1, 0);
+			DBG("vmsplice sub-buffer to pipe, ret %zd", ret_splice);
+			if (ret_splice > 0) {
+				offset += ret_splice;
+			}
+		} else {
+			DBG("splice chan to pipe offset %lu of len %lu (fd : %d, pipe: %d)",
+			    (unsigned long) offset,
+			    len,
+			    fd,
+			    splice_pipe[1]);
+			ret_splice = splice(fd,
+					    &offset,
+					    splice_pipe[1],
+					    nullptr,
+					    len,
+					    SPLICE_F_MOVE | SPLICE_F_MORE);
+			DBG("splice chan to pipe, ret %zd", ret_splice);
+		}
+
 		if (ret_splice < 0) {
 			ret = errno;
 			written = -ret;
@@ -2481,9 +2601,120 @@ error_testpoint:
 	return nullptr;
 }
 
+namespace {
+/* Sub-buffers which may be consumed from a stream during a wake-up. */
+struct drain_budget {
+	unsigned long long packets;
+	unsigned long long bytes;
+};
+
+/* Sub-buffers consumed from a stream, or from all streams during a wake-up. */
+struct drain_usage {
+	void add(const drain_usage& other) noexcept
+	{
+		packets += other.packets;
+		bytes += other.bytes;
+		budget_exhaustions += other.budget_exhaustions;
+	}
+
+	unsigned long long packets = 0;
+	unsigned long long bytes = 0;
+	unsigned long long budget_exhaustions = 0;
+};
+
+drain_budget get_drain_budget()
+{
+	const drain_budget budget = {
+		utils_get_positive_env_value(DEFAULT_CONSUMERD_DRAIN_PACKET_BUDGET_ENV,
+					     DEFAULT_CONSUMERD_DRAIN_PACKET_BUDGET,
+					     ULLONG_MAX),
+		utils_get_positive_env_value(DEFAULT_CONSUMERD_DRAIN_BYTE_BUDGET_ENV,
+					     DEFAULT_CONSUMERD_DRAIN_BYTE_BUDGET,
+					     ULLONG_MAX),
+	};
+
+	DBG("Data stream drain budget: packets = %llu, bytes = %llu",
+	    budget.packets,
+	    budget.bytes);
+	return budget;
+}
+
+/*
+ * Consume the sub-buffers of a ready stream until it has no more data or its
+ * budget is exhausted. The sub-buffers left are consumed once the other ready
+ * streams had their turn: the stream remains readable (or flagged with data
+ * for user space streams) which wakes up the data thread again.
+ *
+ * Returns the status of the last read: the number of bytes consumed, 0, or a
+ * negative value. `usage` is set to the sub-buffers consumed.
+ */
+ssize_t drain_stream(struct lttng_consumer_stream *stream,
+		     struct lttng_consumer_local_data *ctx,
+		     const drain_budget& budget,
+		     drain_usage& usage)
+{
+	const bool is_ust_stream = the_consumer_data.type == LTTNG_CONSUMER32_UST ||
+		the_consumer_data.type == LTTNG_CONSUMER64_UST;
+	ssize_t len;
+
+	usage = {};
+	while (true) {
+		len = ctx->on_buffer_ready(stream, ctx, false);
+		if (len <= 0) {
+			break;
+		}
+
+		usage.packets++;
+		usage.bytes += len;
+		if (usage.packets >= budget.packets || usage.bytes >= budget.bytes) {
+			usage.budget_exhaustions++;
+			break;
+		}
+
+		/*
+		 * A user space stream which is not flagged with data has no
+		 * sub-buffer ready: reading it again would wait on its wait_fd.
+		 */
+		if (is_ust_stream && !stream->has_data) {
+			break;
+		}
+	}
+
+	return len;
+}
+
+/* Add the sub-buffers consumed during a wake-up to the drain statistics. */
+void account_drain_wakeup(const drain_usage& usage)
+{
+	if (usage.packets == 0) {
+		return;
+	}
+
+	DBG3("Consumed %llu sub-buffers (%llu bytes) during data thread wake-up",
+	     usage.packets,
+	     usage.bytes);
+
+	const lttng::pthread::lock_guard stats_lock(the_consumer_data.drain_stats_lock);
+	auto& stats = the_consumer_data.drain_stats;
+
+	stats.wakeups++;
+	stats.packets += usage.packets;
+	stats.bytes += usage.bytes;
+	stats.max_packets_per_wakeup =
+		std::max<uint64_t>(stats.max_packets_per_wakeup, usage.packets);
+	stats.max_bytes_per_wakeup = std::max<uint64_t>(stats.max_bytes_per_wakeup, usage.bytes);
+	stats.budget_exhaustions += usage.budget_exhaustions;
+}
+} /* namespace */
+
 /*
  * This thread polls the fds in the set to consume the data and write
  * it to tracefile if necessary.
+ *
+ * Each ready stream is drained of up to a budget of sub-buffers per wake-up.
+ * The streams are visited in a round-robin order starting at a different
+ * stream on each wake-up so that a stream with a large backlog doesn't
+ * starve the others.
  */
 void *consumer_thread_data_poll(void *data)
 {
@@ -2499,6 +2730,10 @@ void *consumer_thread_data_poll(void *data)
 	int nb_inactive_fd = 0;
 	struct lttng_consumer_local_data *ctx = (lttng_consumer_local_data *) data;
 	ssize_t len;
+	const auto budget = get_drain_budget();
+	/* Index of the first stream visited during a wake-up. */
+	int first_stream = 0;
+	drain_usage stream_usage, wakeup_usage;
 
 	rcu_register_thread();
 
@@ -2648,8 +2883,14 @@ void *consumer_thread_data_poll(void *data)
 			ctx->has_wakeup = 0;
 		}
 
+		wakeup_usage = {};
+		if (nb_fd > 0) {
+			first_stream = (first_stream + 1) % nb_fd;
+		}
+
 		/* Take care of high priority channels first. */
-		for (i = 0; i < nb_fd; i++) {
+		for (int j = 0; j < nb_fd; j++) {
+			i = (first_stream + j) % nb_fd;
 			health_code_update();
 
 			if (local_stream[i] == nullptr) {
@@ -2658,13 +2899,14 @@ void *consumer_thread_data_poll(void *data)
 			if (pollfd[i].revents & POLLPRI) {
 				DBG("Urgent read on fd %d", pollfd[i].fd);
 				high_prio = 1;
-				len = ctx->on_buffer_ready(local_stream[i], ctx, false);
+				len = drain_stream(local_stream[i], ctx, budget, stream_usage);
+				wakeup_usage.add(stream_usage);
 				/* it's ok to have an unavailable sub-buffer */
 				if (len < 0 && len != -EAGAIN && len != -ENODATA) {
 					/* Clean the stream and free it. */
 					consumer_del_stream(local_stream[i], data_ht);
 					local_stream[i] = nullptr;
-				} else if (len > 0) {
+				} else if (stream_usage.packets > 0) {
 					local_stream[i]->has_data_left_to_be_read_before_teardown =
 						1;
 				}
@@ -2676,11 +2918,13 @@ void *consumer_thread_data_poll(void *data)
 		 * for more high prio data.
 		 */
 		if (high_prio) {
+			account_drain_wakeup(wakeup_usage);
 			continue;
 		}
 
 		/* Take care of low priority channels. */
-		for (i = 0; i < nb_fd; i++) {
+		for (int j = 0; j < nb_fd; j++) {
+			i = (first_stream + j) % nb_fd;
 			health_code_update();
 
 			if (local_stream[i] == nullptr) {
@@ -2689,19 +2933,22 @@ void *consumer_thread_data_poll(void *data)
 			if ((pollfd[i].revents & POLLIN) || local_stream[i]->hangup_flush_done ||
 			    local_stream[i]->has_data) {
 				DBG("Normal read on fd %d", pollfd[i].fd);
-				len = ctx->on_buffer_ready(local_stream[i], ctx, false);
+				len = drain_stream(local_stream[i], ctx, budget, stream_usage);
+				wakeup_usage.add(stream_usage);
 				/* it's ok to have an unavailable sub-buffer */
 				if (len < 0 && len != -EAGAIN && len != -ENODATA) {
 					/* Clean the stream and free it. */
 					consumer_del_stream(local_stream[i], data_ht);
 					local_stream[i] = nullptr;
-				} else if (len > 0) {
+				} else if (stream_usage.packets > 0) {
 					local_stream[i]->has_data_left_to_be_read_before_teardown =
 						1;
 				}
 			}
 		}
 
+		account_drain_wakeup(wakeup_usage);
+
 		/* Handle hangup and errors */
 		for (i = 0; i < nb_fd; i++) {
 			health_code_update();
@@ -3127,19 +3374,195 @@ error:
 	return ret;
 }
 
+namespace {
+/*
+ * Additional command connection of the session daemon. Its commands are
+ * handled, in order, by a dedicated thread.
+ */
+struct command_worker {
+	struct lttng_consumer_local_data *ctx;
+	int sock;
+	pthread_t thread;
+};
+
+void *thread_command_worker(void *data)
+{
+	int ret, err = -1;
+	auto *worker = static_cast<command_worker *>(data);
+	struct pollfd sockpoll[2];
+
+	rcu_register_thread();
+
+	health_register(health_consumerd, HEALTH_CONSUMERD_TYPE_SESSIOND);
+
+	sockpoll[0].fd = worker->ctx->consumer_should_quit[0];
+	sockpoll[0].events = POLLIN | POLLPRI;
+	sockpoll[1].fd = worker->sock;
+	sockpoll[1].events = POLLIN | POLLPRI;
+
+	while (true) {
+		health_code_update();
+
+		health_poll_entry();
+		ret = lttng_consumer_poll_socket(sockpoll);
+		health_poll_exit();
+		if (ret) {
+			if (ret > 0) {
+				/* should exit */
+				err = 0;
+			}
+			goto end;
+		}
+
+		ret = lttng_consumer_recv_cmd(worker->ctx, worker->sock, sockpoll);
+		if (ret == 0) {
+			DBG("Additional command connection closed: sock = %d", worker->sock);
+			err = 0;
+			goto end;
+		} else if (ret < 0) {
+			/* Same outcome as an error on the main command connection. */
+			DBG("Communication interrupted on additional command socket");
+			err = 0;
+			lttng_consumer_should_exit(worker->ctx);
+			goto end;
+		}
+
+		if (CMM_LOAD_SHARED(consumer_quit)) {
+			err = 0;
+			goto end;
+		}
+	}
+
+end:
+	if (err) {
+		health_error();
+		ERR("Health error occurred in %s", __func__);
+	}
+	health_unregister(health_consumerd);
+
+	rcu_unregister_thread();
+	return nullptr;
+}
+
+/*
+ * Accept an additional command connection of the session daemon and start the
+ * thread handling its commands.
+ *
+ * Return 0 on success, else a negative value. Failing to add a connection is
+ * not fatal: the session daemon then sends its commands on the other ones.
+ */
+int add_command_worker(struct lttng_consumer_local_data *ctx,
+		       int client_socket,
+		       std::vector<std::unique_ptr<command_worker>>& workers)
+{
+	int ret, sock;
+	std::unique_ptr<command_worker> worker;
+
+	sock = lttcomm_accept_unix_sock(client_socket);
+	if (sock < 0) {
+		WARN("On accept of additional command connection");
+		return -1;
+	}
+
+	try {
+		worker.reset(new command_worker{ ctx, sock, {} });
+		workers.reserve(workers.size() + 1);
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to allocate command worker");
+		ret = -ENOMEM;
+		goto error;
+	}
+
+	ret = pthread_create(
+		&worker->thread, default_pthread_attr(), thread_command_worker, worker.get());
+	if (ret) {
+		errno = ret;
+		PERROR("pthread_create command worker");
+		ret = -1;
+		goto error;
+	}
+
+	DBG("Additional command connection ready: sock = %d", sock);
+	/* Can't throw as the capacity was reserved. */
+	workers.emplace_back(std::move(worker));
+	return 0;
+
+error:
+	if (close(sock)) {
+		PERROR("close additional command socket");
+	}
+
+	return ret;
+}
+
+void stop_command_workers(std::vector<std::unique_ptr<command_worker>>& workers)
+{
+	for (const auto& worker : workers) {
+		int ret;
+
+		/* Wake up the worker if it is waiting for a command. */
+		(void) shutdown(worker->sock, SHUT_RDWR);
+		ret = pthread_join(worker->thread, nullptr);
+		if (ret) {
+			errno = ret;
+			PERROR("pthread_join command worker");
+		}
+
+		if (close(worker->sock)) {
+			PERROR("close additional command socket");
+		}
+	}
+
+	workers.clear();
+}
+
+/*
+ * Poll the quit pipe, the main command socket and the listening socket on
+ * which the additional command connections are accepted.
+ *
+ * Return 1 if the consumer should quit, -1 on error, else 0.
+ */
+int poll_command_sockets(struct pollfd *sockpoll)
+{
+	int num_rdy;
+
+	do {
+		num_rdy = poll(sockpoll, 3, -1);
+	} while (num_rdy == -1 && errno == EINTR);
+	if (num_rdy == -1) {
+		PERROR("Poll error");
+		return -1;
+	}
+
+	if (sockpoll[0].revents & (POLLIN | POLLPRI)) {
+		DBG("consumer_should_quit wake up");
+		return 1;
+	}
+
+	return 0;
+}
+} /* namespace */
+
 /*
  * This thread listens on the consumerd socket and receives the file
  * descriptors from the session daemon.
+ *
+ * The first two connections are the main command connection and the metadata
+ * connection. The session daemon may then establish additional command
+ * connections, each handled by a command worker thread, so that the commands
+ * of sessions using different connections are handled concurrently.
  */
 void *consumer_thread_sessiond_poll(void *data)
 {
 	int sock = -1, client_socket, ret, err = -1;
 	/*
 	 * structure to poll for incoming data on communication socket avoids
-	 * making blocking sockets.
+	 * making blocking sockets. The first two entries are the quit pipe and
+	 * the command socket, as expected by lttng_consumer_poll_socket().
 	 */
-	struct pollfd consumer_sockpoll[2];
+	struct pollfd consumer_sockpoll[3];
 	struct lttng_consumer_local_data *ctx = (lttng_consumer_local_data *) data;
+	std::vector<std::unique_ptr<command_worker>> command_workers;
 
 	rcu_register_thread();
 
@@ -3209,22 +3632,18 @@ void *consumer_thread_sessiond_poll(void *data)
 		goto end;
 	}
 
-	/* This socket is not useful anymore. */
-	ret = close(client_socket);
-	if (ret < 0) {
-		PERROR("close client_socket");
-	}
-	client_socket = -1;
-
 	/* update the polling structure to poll on the established socket */
 	consumer_sockpoll[1].fd = sock;
 	consumer_sockpoll[1].events = POLLIN | POLLPRI;
+	/* Keep accepting the additional command connections. */
+	consumer_sockpoll[2].fd = client_socket;
+	consumer_sockpoll[2].events = POLLIN | POLLPRI;
 
 	while (true) {
 		health_code_update();
 
 		health_poll_entry();
-		ret = lttng_consumer_poll_socket(consumer_sockpoll);
+		ret = poll_command_sockets(consumer_sockpoll);
 		health_poll_exit();
 		if (ret) {
 			if (ret > 0) {
@@ -3233,6 +3652,15 @@ void *consumer_thread_sessiond_poll(void *data)
 			}
 			goto end;
 		}
+
+		if (consumer_sockpoll[2].revents & (POLLIN | POLLPRI)) {
+			(void) add_command_worker(ctx, client_socket, command_workers);
+		}
+
+		if (!consumer_sockpoll[1].revents) {
+			continue;
+		}
+
 		DBG("Incoming command on sock");
 		ret = lttng_consumer_recv_cmd(ctx, sock, consumer_sockpoll);
 		if (ret <= 0) {
@@ -3257,6 +3685,8 @@ void *consumer_thread_sessiond_poll(void *data)
 end:
 	DBG("Consumer thread sessiond poll exiting");
 
+	stop_command_workers(command_workers);
+
 	/*
 	 * Close metadata streams since the producer is the session daemon which
 	 * just died.
@@ -3600,6 +4030,9 @@ void consumer_add_relayd_socket(uint64_t net_seq_idx,
 		/* Copy received lttcomm socket */
 		ret = lttcomm_populate_sock_from_open_socket(
 			&relayd->control_sock.sock, fd, relayd_socket_protocol);
+		if (ret >= 0) {
+			relayd_configure_control_socket(&relayd->control_sock);
+		}
 
 		/* Assign version values. */
 		relayd->control_sock.major = relayd_version_major;
@@ -3766,29 +4199,28 @@ int consumer_data_pending(uint64_t id)
 			goto data_not_pending;
 		}
 
+		std::vector<relayd_stream_data_pending_query> queries;
+
 		for (auto *stream : lttng::urcu::lfht_filtered_iteration_adapter<
 			     lttng_consumer_stream,
 			     decltype(lttng_consumer_stream::node_session_id),
 			     &lttng_consumer_stream::node_session_id,
 			     std::uint64_t>(
 			     *ht->ht, &id, ht->hash_fct(&id, lttng_ht_seed), ht->match_fct)) {
-			if (stream->metadata_flag) {
-				ret = relayd_quiescent_control(&relayd->control_sock,
-							       stream->relayd_stream_id);
-			} else {
-				ret = relayd_data_pending(&relayd->control_sock,
-							  stream->relayd_stream_id,
-							  stream->next_net_seq_num - 1);
-			}
+			queries.push_back({ stream->relayd_stream_id,
+					    stream->next_net_seq_num - 1,
+					    (bool) stream->metadata_flag });
+		}
 
-			if (ret == 1) {
-				goto data_pending;
-			} else if (ret < 0) {
-				ERR("Relayd data pending failed. Cleaning up relayd %" PRIu64 ".",
-				    relayd->net_seq_idx);
-				lttng_consumer_cleanup_relayd(relayd);
-				goto data_not_pending;
-			}
+		ret = relayd_streams_data_pending(
+			&relayd->control_sock, queries.data(), queries.size());
+		if (ret == 1) {
+			goto data_pending;
+		} else if (ret < 0) {
+			ERR("Relayd data pending failed. Cleaning up relayd %" PRIu64 ".",
+			    relayd->net_seq_idx);
+			lttng_consumer_cleanup_relayd(relayd);
+			goto data_not_pending;
 		}
 
 		/* Send end command for data pending. */
@@ -3858,6 +4290,26 @@ int consumer_send_status_channel(int sock, struct lttng_consumer_channel *channe
 	return lttcomm_send_unix_sock(sock, &msg, sizeof(msg));
 }
 
+/*
+ * Send the drain statistics of the data thread to the sessiond daemon.
+ *
+ * Return the sendmsg() return value.
+ */
+int consumer_send_drain_statistics(int sock)
+{
+	struct lttcomm_consumer_drain_statistics stats;
+
+	LTTNG_ASSERT(sock >= 0);
+
+	{
+		const lttng::pthread::lock_guard stats_lock(the_consumer_data.drain_stats_lock);
+
+		stats = the_consumer_data.drain_stats;
+	}
+
+	return lttcomm_send_unix_sock(sock, &stats, sizeof(stats));
+}
+
 unsigned long consumer_get_consume_start_pos(unsigned long consumed_pos,
 					     unsigned long produced_pos,
 					     uint64_t nb_packets_per_stream,
@@ -3949,6 +4401,10 @@ int lttng_consumer_rotate_channel(struct lttng_consumer_channel *channel,
 		goto end;
 	}
 
+	if (is_local_trace) {
+		consumer_stream_prepare_rotation_output_files(channel);
+	}
+
 	for (auto *stream : lttng::urcu::lfht_filtered_iteration_adapter<
 		     lttng_consumer_stream,
 		     decltype(lttng_consumer_stream::node_channel_id),
@@ -4471,6 +4927,11 @@ static int rotate_local_stream(struct lttng_consumer_stream *stream)
 		stream->index_file = nullptr;
 	}
 
+	/* The next tracefile was prepared in the previous trace chunk. */
+	if (stream->next_output_files) {
+		stream->next_output_files->discard();
+	}
+
 	if (!stream->trace_chunk) {
 		goto end;
 	}
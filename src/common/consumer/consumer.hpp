@@ -12,12 +12,15 @@
 #define LIB_CONSUMER_H
 
 #include <common/buffer-view.hpp>
+#include <common/consumer/output-files-preparation.hpp>
 #include <common/credentials.hpp>
+#include <common/defaults.hpp>
 #include <common/dynamic-array.hpp>
 #include <common/hashtable/hashtable.hpp>
 #include <common/index/ctf-index.hpp>
 #include <common/pipe.hpp>
 #include <common/scheduler.hpp>
+#include <common/sessiond-comm/relayd-metadata-fragments.hpp>
 #include <common/sessiond-comm/sessiond-comm.hpp>
 #include <common/task-executor.hpp>
 #include <common/trace-chunk-registry.hpp>
@@ -71,6 +74,11 @@ enum lttng_consumer_command {
 	LTTNG_CONSUMER_TRACE_CHUNK_EXISTS,
 	LTTNG_CONSUMER_CLEAR_CHANNEL,
 	LTTNG_CONSUMER_OPEN_CHANNEL_PACKETS,
+	/* Batched forms of ASK_CHANNEL_CREATION and GET_CHANNEL. */
+	LTTNG_CONSUMER_ASK_CHANNELS_CREATION,
+	LTTNG_CONSUMER_GET_CHANNELS,
+	/* Return the drain statistics of the data thread. */
+	LTTNG_CONSUMER_GET_DRAIN_STATISTICS,
 };
 
 enum lttng_consumer_type {
@@ -247,6 +255,11 @@ struct lttng_consumer_channel {
 	/* On-disk circular buffer */
 	uint64_t tracefile_size = 0;
 	uint64_t tracefile_count = 0;
+	/*
+	 * Scheduler of the tasks opening the next tracefile of the streams
+	 * ahead of their rotation. NULL if the files are opened on rotation.
+	 */
+	lttng::scheduling::scheduler *output_files_scheduler = nullptr;
 	/*
 	 * Monitor or not the streams of this channel meaning this indicates if the
 	 * streams should be sent to the data/metadata thread or added to the no
@@ -641,6 +654,11 @@ struct lttng_consumer_stream {
 	 * Index file object of the index file for this stream.
 	 */
 	struct lttng_index_file *index_file;
+	/*
+	 * Output files of the next tracefile of the stream, opened ahead of its
+	 * next size-based rotation. NULL until the first rotation is prepared.
+	 */
+	lttng::consumer::output_files_preparation *next_output_files;
 
 	/*
 	 * Local pipe to extract data when using splice.
@@ -751,6 +769,15 @@ struct consumer_relayd_sock_pair {
 	uint64_t relayd_session_id;
 	uint64_t sessiond_session_id;
 	struct lttng_consumer_local_data *ctx;
+
+	/*
+	 * Metadata fragments sent on the control socket, allocated once the
+	 * relay daemon is known to support the RELAYD_SEND_METADATA_FRAGMENTS
+	 * command. The support is queried before sending the first metadata
+	 * packet. Both are protected by the control socket mutex.
+	 */
+	bool metadata_fragments_support_queried;
+	lttng::relayd::metadata_fragment_store *metadata_fragment_store;
 };
 
 struct protected_socket {
@@ -758,6 +785,12 @@ struct protected_socket {
 	int fd = -1;
 };
 
+/*
+ * Number of threads running the timer tasks, overridable through the
+ * environment.
+ */
+unsigned int consumer_get_timer_task_worker_count();
+
 /*
  * UST consumer local data to the program. One or more instance per
  * process.
@@ -849,7 +882,16 @@ struct lttng_consumer_local_data {
 	nonstd::optional<lttng_uuid> sessiond_uuid;
 
 	lttng::scheduling::scheduler timer_task_scheduler;
-	lttng::scheduling::task_executor timer_task_executor{ timer_task_scheduler };
+	lttng::scheduling::task_executor timer_task_executor{
+		timer_task_scheduler, consumer_get_timer_task_worker_count()
+	};
+
+	/*
+	 * Opens the output files of the streams' next tracefiles, possibly
+	 * through run-as, without delaying the timer tasks.
+	 */
+	lttng::scheduling::scheduler output_files_scheduler;
+	lttng::scheduling::task_executor output_files_executor{ output_files_scheduler };
 };
 
 /*
@@ -907,6 +949,13 @@ struct lttng_consumer_global_data {
 	 * Trace chunk registry indexed by (session_id, chunk_id).
 	 */
 	struct lttng_trace_chunk_registry *chunk_registry = nullptr;
+
+	/*
+	 * Sub-buffers consumed by the data thread, used to tune the drain
+	 * budgets. Updated by the data thread at the end of each wake-up.
+	 */
+	pthread_mutex_t drain_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+	struct lttcomm_consumer_drain_statistics drain_stats = {};
 };
 
 /*
@@ -1046,6 +1095,7 @@ ssize_t lttng_consumer_on_read_subbuffer_mmap(struct lttng_consumer_stream *stre
 					      unsigned long padding);
 ssize_t lttng_consumer_on_read_subbuffer_splice(struct lttng_consumer_local_data *ctx,
 						struct lttng_consumer_stream *stream,
+						const struct lttng_buffer_view *buffer,
 						unsigned long len,
 						unsigned long padding);
 int lttng_consumer_sample_snapshot_positions(struct lttng_consumer_stream *stream);
@@ -1080,6 +1130,7 @@ void consumer_flag_relayd_for_destroy(struct consumer_relayd_sock_pair *relayd);
 int consumer_data_pending(uint64_t id);
 int consumer_send_status_msg(int sock, int ret_code);
 int consumer_send_status_channel(int sock, struct lttng_consumer_channel *channel);
+int consumer_send_drain_statistics(int sock);
 void notify_thread_del_channel(struct lttng_consumer_local_data *ctx, uint64_t key);
 void consumer_destroy_relayd(struct consumer_relayd_sock_pair *relayd);
 unsigned long consumer_get_consume_start_pos(unsigned long consumed_pos,
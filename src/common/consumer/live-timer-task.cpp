@@ -5,9 +5,12 @@
  *
  */
 
+#include <common/consumer/consumer-stream.hpp>
 #include <common/consumer/live-timer-task.hpp>
 #include <common/urcu.hpp>
 
+#include <algorithm>
+
 namespace {
 int check_stream(lttng_consumer_stream& stream)
 {
@@ -21,50 +24,35 @@ int check_stream(lttng_consumer_stream& stream)
 	 * safely send the empty index.
 	 *
 	 * Doing a trylock and checking if waiting on metadata if
-	 * trylock fails. Bail out of the stream is indeed waiting for
-	 * metadata to be pushed. Busy wait on trylock otherwise.
+	 * trylock fails. A stream waiting for metadata to be pushed sends
+	 * the beacon itself once it is done. Any other busy stream is
+	 * skipped until the next pass rather than delaying the beacons of
+	 * the other streams of the session.
 	 */
-	for (;;) {
-		ret = pthread_mutex_trylock(&stream.lock);
-		switch (ret) {
-		case 0:
-			break; /* We have the lock. */
-		case EBUSY:
-			pthread_mutex_lock(&stream.metadata_timer_lock);
-			if (stream.waiting_on_metadata) {
-				ret = 0;
-				stream.missed_metadata_flush = true;
-				pthread_mutex_unlock(&stream.metadata_timer_lock);
-				goto end; /* Bail out. */
-			}
-			pthread_mutex_unlock(&stream.metadata_timer_lock);
-			/* Try again. */
-			caa_cpu_relax();
-			continue;
-		default:
-			ERR("Unexpected pthread_mutex_trylock error %d", ret);
-			ret = -1;
-			goto end;
+	ret = pthread_mutex_trylock(&stream.lock);
+	switch (ret) {
+	case 0:
+		break; /* We have the lock. */
+	case EBUSY:
+		pthread_mutex_lock(&stream.metadata_timer_lock);
+		if (stream.waiting_on_metadata) {
+			stream.missed_metadata_flush = true;
 		}
-		break;
+		pthread_mutex_unlock(&stream.metadata_timer_lock);
+		return 0;
+	default:
+		ERR("Unexpected pthread_mutex_trylock error %d", ret);
+		return -1;
 	}
 
+	/* The beacon is only sent once the locks of the session's streams are released. */
 	ret = stream.read_subbuffer_ops.send_live_beacon(stream);
 	pthread_mutex_unlock(&stream.lock);
-end:
 	return ret;
 }
-} /* namespace */
 
-void lttng::consumer::live_timer_task::_run(lttng::scheduling::absolute_time current_time
-					    [[maybe_unused]]) noexcept
+void check_channel_streams(lttng_consumer_channel& channel)
 {
-	LTTNG_ASSERT(!_channel.is_deleted);
-
-	if (_channel.switch_timer_error) {
-		return;
-	}
-
 	const auto *stream_per_chan_id_ht = the_consumer_data.stream_per_chan_id_ht;
 
 	for (auto *stream : lttng::urcu::lfht_filtered_iteration_adapter<
@@ -72,12 +60,54 @@ void lttng::consumer::live_timer_task::_run(lttng::scheduling::absolute_time cur
 		     decltype(lttng_consumer_stream::node_channel_id),
 		     &lttng_consumer_stream::node_channel_id,
 		     std::uint64_t>(*stream_per_chan_id_ht->ht,
-				    &_channel.key,
-				    stream_per_chan_id_ht->hash_fct(&_channel.key, lttng_ht_seed),
+				    &channel.key,
+				    stream_per_chan_id_ht->hash_fct(&channel.key, lttng_ht_seed),
 				    stream_per_chan_id_ht->match_fct)) {
 		const auto ret = check_stream(*stream);
 		if (ret < 0) {
 			return;
 		}
 	}
-}
\ No newline at end of file
+}
+} /* namespace */
+
+std::size_t lttng::consumer::live_timer_task::add_channel(lttng_consumer_channel& channel)
+{
+	const std::lock_guard<std::mutex> lock(_mutex);
+
+	_channels.emplace_back(&channel);
+	return _channels.size();
+}
+
+std::size_t
+lttng::consumer::live_timer_task::remove_channel(lttng_consumer_channel& channel) noexcept
+{
+	const std::lock_guard<std::mutex> lock(_mutex);
+
+	_channels.erase(std::remove(_channels.begin(), _channels.end(), &channel),
+			_channels.end());
+	return _channels.size();
+}
+
+void lttng::consumer::live_timer_task::_run(lttng::scheduling::absolute_time current_time
+					    [[maybe_unused]]) noexcept
+{
+	/* The beacons of all the channels of the session are sent as one batch. */
+	consumer_stream_begin_live_beacon_batch();
+
+	try {
+		for (auto *channel : _channels) {
+			LTTNG_ASSERT(!channel->is_deleted);
+
+			if (channel->switch_timer_error) {
+				continue;
+			}
+
+			check_channel_streams(*channel);
+		}
+	} catch (const std::bad_alloc& e) {
+		ERR_FMT("Failed to allocate memory during live timer pass: {}", e.what());
+	}
+
+	(void) consumer_stream_end_live_beacon_batch();
+}
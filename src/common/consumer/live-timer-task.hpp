@@ -11,6 +11,9 @@
 #include <common/consumer/consumer.hpp>
 #include <common/scheduler.hpp>
 
+#include <cstdint>
+#include <vector>
+
 namespace lttng {
 namespace consumer {
 class live_timer_task : public lttng::scheduling::periodic_task {
@@ -24,22 +27,26 @@ public:
 
 	~live_timer_task() override = default;
 
+	/*
+	 * A live timer task sends the inactivity beacons of all the channels of a session
+	 * sharing the same live timer period in one pass.
+	 */
 	explicit live_timer_task(lttng::scheduling::duration_ns period,
-				 lttng_consumer_channel& channel) noexcept :
-		periodic_task(period,
-			      fmt::format("Live: channel_name=`{}`, key={}, session_id={}",
-					  channel.name,
-					  channel.key,
-					  channel.session_id)),
-		_channel(channel)
+				 std::uint64_t session_id) noexcept :
+		periodic_task(period, fmt::format("Live: session_id={}", session_id))
 	{
 	}
 
+	/* Returns the number of channels handled by the task after the addition/removal. */
+	std::size_t add_channel(lttng_consumer_channel& channel);
+	std::size_t remove_channel(lttng_consumer_channel& channel) noexcept;
+
 protected:
 	void _run(lttng::scheduling::absolute_time current_time) noexcept override;
 
 private:
-	lttng_consumer_channel& _channel;
+	/* Protected by the task's mutex. */
+	std::vector<lttng_consumer_channel *> _channels;
 };
 } /* namespace consumer */
 } /* namespace lttng */
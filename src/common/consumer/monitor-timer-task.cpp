@@ -10,6 +10,9 @@
 #include <common/urcu.hpp>
 #include <common/ust-consumer/ust-consumer.hpp>
 
+#include <algorithm>
+#include <limits.h>
+
 namespace {
 using sample_positions_cb = int (*)(struct lttng_consumer_stream *);
 using get_consumed_cb = int (*)(struct lttng_consumer_stream *, unsigned long *);
@@ -92,24 +95,20 @@ end:
 
 	return ret;
 }
-} /* namespace */
 
-/* Sample and send channel buffering statistics to the session daemon. */
-void lttng::consumer::monitor_timer_task::_run(lttng::scheduling::absolute_time current_time
-					       [[maybe_unused]]) noexcept
+/*
+ * Sample the buffer usage of a channel. Returns 0 on success, in which case
+ * `msg` is ready to be sent to the session daemon.
+ */
+int sample_channel_usage(lttng_consumer_channel& channel,
+			 lttcomm_consumer_channel_monitor_msg& msg,
+			 uint64_t& total_consumed) noexcept
 {
 	int ret;
-	struct lttcomm_consumer_channel_monitor_msg msg = {
-		.key = _channel.key,
-		.session_id = _channel.session_id,
-		.lowest = 0,
-		.highest = 0,
-		.consumed_since_last_sample = 0,
-	};
 	sample_positions_cb sample;
 	get_consumed_cb get_consumed;
 	get_produced_cb get_produced;
-	uint64_t lowest = 0, highest = 0, total_consumed = 0;
+	uint64_t lowest = 0, highest = 0;
 
 	switch (the_consumer_data.type) {
 	case LTTNG_CONSUMER_KERNEL:
@@ -128,39 +127,129 @@ void lttng::consumer::monitor_timer_task::_run(lttng::scheduling::absolute_time
 	}
 
 	ret = sample_channel_positions(
-		_channel, &highest, &lowest, &total_consumed, sample, get_consumed, get_produced);
+		channel, &highest, &lowest, &total_consumed, sample, get_consumed, get_produced);
 	if (ret) {
-		return;
+		return ret;
 	}
 
+	msg = {};
+	msg.key = channel.key;
+	msg.session_id = channel.session_id;
 	msg.highest = highest;
 	msg.lowest = lowest;
 	msg.consumed_since_last_sample =
-		total_consumed - _channel.consumed_size_as_of_last_sample_sent;
-
-	/*
-	 * Writes performed here are assumed to be atomic which is only
-	 * guaranteed for sizes < than PIPE_BUF.
-	 */
-	LTTNG_ASSERT(sizeof(msg) <= PIPE_BUF);
-
-	do {
-		ret = write(_channel_monitor_pipe, &msg, sizeof(msg));
-	} while (ret == -1 && errno == EINTR);
-	if (ret == -1) {
-		if (errno == EAGAIN) {
-			/* Not an error, the sample is merely dropped. */
-			DBG("Channel monitor pipe is full; dropping sample for channel key = %" PRIu64,
-			    _channel.key);
-		} else {
-			PERROR("write to the channel monitor pipe");
+		total_consumed - channel.consumed_size_as_of_last_sample_sent;
+	return 0;
+}
+} /* namespace */
+
+std::size_t lttng::consumer::monitor_timer_task::add_channel(lttng_consumer_channel& channel)
+{
+	const std::lock_guard<std::mutex> lock(_mutex);
+
+	_channels.emplace_back(&channel);
+	/* Ensure a pass can't fail to allocate its samples. */
+	_samples.reserve(_channels.size());
+	_sampled_channels.reserve(_channels.size());
+	return _channels.size();
+}
+
+std::size_t
+lttng::consumer::monitor_timer_task::remove_channel(lttng_consumer_channel& channel) noexcept
+{
+	const std::lock_guard<std::mutex> lock(_mutex);
+
+	_channels.erase(std::remove(_channels.begin(), _channels.end(), &channel),
+			_channels.end());
+	return _channels.size();
+}
+
+void lttng::consumer::monitor_timer_task::sample_channel(lttng_consumer_channel& channel) noexcept
+{
+	const std::lock_guard<std::mutex> lock(_mutex);
+	lttcomm_consumer_channel_monitor_msg msg;
+	uint64_t total_consumed;
+
+	LTTNG_ASSERT(std::find(_channels.begin(), _channels.end(), &channel) != _channels.end());
+
+	if (sample_channel_usage(channel, msg, total_consumed)) {
+		return;
+	}
+
+	_samples.emplace_back(msg);
+	_sampled_channels.emplace_back(&channel, total_consumed);
+	_send_samples();
+}
+
+/*
+ * Send the samples of a pass to the session daemon. The samples are written
+ * in as few writes as possible while keeping each write smaller than PIPE_BUF
+ * so that the session daemon never observes a partial sample.
+ */
+void lttng::consumer::monitor_timer_task::_send_samples() noexcept
+{
+	constexpr std::size_t max_samples_per_write =
+		PIPE_BUF / sizeof(lttcomm_consumer_channel_monitor_msg);
+	std::size_t chunk_begin;
+
+	static_assert(max_samples_per_write > 0, "A sample must fit in an atomic pipe write");
+
+	for (chunk_begin = 0; chunk_begin < _samples.size();
+	     chunk_begin += max_samples_per_write) {
+		const auto chunk_end =
+			std::min(_samples.size(), chunk_begin + max_samples_per_write);
+		const auto chunk_size =
+			(chunk_end - chunk_begin) * sizeof(lttcomm_consumer_channel_monitor_msg);
+		ssize_t ret;
+
+		do {
+			ret = write(_channel_monitor_pipe, &_samples[chunk_begin], chunk_size);
+		} while (ret == -1 && errno == EINTR);
+		if (ret == -1) {
+			if (errno == EAGAIN) {
+				/* Not an error, the samples are merely dropped. */
+				DBG("Channel monitor pipe is full; dropping %zu samples",
+				    _samples.size() - chunk_begin);
+			} else {
+				PERROR("write to the channel monitor pipe");
+			}
+
+			break;
+		}
+
+		for (auto i = chunk_begin; i < chunk_end; i++) {
+			auto& sampled_channel = *_sampled_channels[i].first;
+
+			DBG("Sent channel monitoring sample for channel key %" PRIu64
+			    ", (highest = %" PRIu64 ", lowest = %" PRIu64 ")",
+			    sampled_channel.key,
+			    _samples[i].highest,
+			    _samples[i].lowest);
+			sampled_channel.consumed_size_as_of_last_sample_sent =
+				_sampled_channels[i].second;
+		}
+	}
+
+	_samples.clear();
+	_sampled_channels.clear();
+}
+
+/* Sample and send the buffering statistics of the session's channels to the session daemon. */
+void lttng::consumer::monitor_timer_task::_run(lttng::scheduling::absolute_time current_time
+					       [[maybe_unused]]) noexcept
+{
+	for (auto *channel : _channels) {
+		lttcomm_consumer_channel_monitor_msg msg;
+		uint64_t total_consumed;
+
+		if (sample_channel_usage(*channel, msg, total_consumed)) {
+			continue;
 		}
-	} else {
-		DBG("Sent channel monitoring sample for channel key %" PRIu64
-		    ", (highest = %" PRIu64 ", lowest = %" PRIu64 ")",
-		    _channel.key,
-		    msg.highest,
-		    msg.lowest);
-		_channel.consumed_size_as_of_last_sample_sent = total_consumed;
+
+		/* Storage was reserved as the channels were added. */
+		_samples.emplace_back(msg);
+		_sampled_channels.emplace_back(channel, total_consumed);
 	}
-}
\ No newline at end of file
+
+	_send_samples();
+}
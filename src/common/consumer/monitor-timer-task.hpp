@@ -11,6 +11,10 @@
 #include <common/consumer/consumer.hpp>
 #include <common/scheduler.hpp>
 
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 namespace lttng {
 namespace consumer {
 class monitor_timer_task : public lttng::scheduling::periodic_task {
@@ -24,26 +28,38 @@ public:
 
 	~monitor_timer_task() override = default;
 
+	/*
+	 * A monitor timer task samples all the channels of a session sharing the same
+	 * monitor timer period in one pass.
+	 */
 	explicit monitor_timer_task(lttng::scheduling::duration_ns period,
-				    lttng_consumer_channel& channel,
+				    std::uint64_t session_id,
 				    int channel_monitor_pipe) noexcept :
-		periodic_task(period,
-			      fmt::format("Monitor: channel_name=`{}`, key={}, session_id={}",
-					  channel.name,
-					  channel.key,
-					  channel.session_id)),
-		_channel(channel),
+		periodic_task(period, fmt::format("Monitor: session_id={}", session_id)),
 		_channel_monitor_pipe(channel_monitor_pipe)
 	{
 		LTTNG_ASSERT(_channel_monitor_pipe >= 0);
 	}
 
+	/* Returns the number of channels handled by the task after the addition/removal. */
+	std::size_t add_channel(lttng_consumer_channel& channel);
+	std::size_t remove_channel(lttng_consumer_channel& channel) noexcept;
+
+	/* Sample a single channel of the task and send its statistics immediately. */
+	void sample_channel(lttng_consumer_channel& channel) noexcept;
+
 protected:
 	void _run(lttng::scheduling::absolute_time current_time) noexcept override;
 
 private:
-	lttng_consumer_channel& _channel;
+	void _send_samples() noexcept;
+
 	const int _channel_monitor_pipe;
+	/* Protected by the task's mutex. */
+	std::vector<lttng_consumer_channel *> _channels;
+	/* Samples of a pass and their channel; kept to reuse their storage. */
+	std::vector<lttcomm_consumer_channel_monitor_msg> _samples;
+	std::vector<std::pair<lttng_consumer_channel *, std::uint64_t>> _sampled_channels;
 };
 } /* namespace consumer */
 } /* namespace lttng */
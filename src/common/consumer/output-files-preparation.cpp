@@ -0,0 +1,277 @@
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ */
+
+#include <common/consumer/consumer.hpp>
+#include <common/consumer/output-files-preparation.hpp>
+#include <common/error.hpp>
+#include <common/index/index.hpp>
+#include <common/trace-chunk.hpp>
+#include <common/utils.hpp>
+
+#include <lttng/constant.h>
+
+#include <fcntl.h>
+#include <new>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lttng {
+namespace consumer {
+
+class output_files_opening_task : public lttng::scheduling::task {
+public:
+	output_files_opening_task(const lttng_consumer_stream& stream, std::uint64_t tracefile_index) :
+		task(fmt::format("Open output files: stream_key={}, tracefile_index={}",
+				 stream.key,
+				 tracefile_index)),
+		_chunk(stream.trace_chunk),
+		_channel_path(stream.chan->pathname),
+		_stream_name(stream.name),
+		_tracefile_size(stream.chan->tracefile_size),
+		_tracefile_index(tracefile_index)
+	{
+		const auto acquired_reference = lttng_trace_chunk_get(_chunk);
+
+		LTTNG_ASSERT(acquired_reference);
+	}
+
+	output_files_opening_task(const output_files_opening_task&) = delete;
+	output_files_opening_task(output_files_opening_task&&) = delete;
+	output_files_opening_task& operator=(const output_files_opening_task&) = delete;
+	output_files_opening_task& operator=(output_files_opening_task&&) = delete;
+
+	~output_files_opening_task() override
+	{
+		_release();
+	}
+
+	/*
+	 * Hand over the opened files if they match. Otherwise, the task is
+	 * canceled if it didn't run yet.
+	 */
+	bool take(const lttng_trace_chunk *chunk,
+		  std::uint64_t tracefile_index,
+		  int& fd,
+		  lttng_index_file *& index_file) noexcept
+	{
+		const std::lock_guard<std::mutex> lock(_mutex);
+		bool taken = false;
+
+		_canceled = true;
+		if (!_opened || _chunk != chunk || _tracefile_index != tracefile_index) {
+			goto end;
+		}
+
+		/* Truncate the tracefile being replaced. */
+		if (_must_truncate && ftruncate(_fd, 0)) {
+			PERROR("Failed to truncate prepared stream file: stream_name=`%s`",
+			       _stream_name.c_str());
+			goto end;
+		}
+
+		if (lttng_index_file_reset(_index_file)) {
+			goto end;
+		}
+
+		fd = _fd;
+		index_file = _index_file;
+		_fd = -1;
+		_index_file = nullptr;
+		_stream_file_created = false;
+		_index_file_created = false;
+		taken = true;
+	end:
+		_release();
+		return taken;
+	}
+
+	void discard() noexcept
+	{
+		const std::lock_guard<std::mutex> lock(_mutex);
+
+		_canceled = true;
+		_release();
+	}
+
+protected:
+	void _run(lttng::scheduling::absolute_time current_time
+		  __attribute__((unused))) noexcept override
+	{
+		const mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP;
+		char stream_path[LTTNG_PATH_MAX];
+		enum lttng_trace_chunk_status chunk_status;
+		struct stat stream_file_stat;
+
+		if (utils_stream_file_path(_channel_path.c_str(),
+					   _stream_name.c_str(),
+					   _tracefile_size,
+					   _tracefile_index,
+					   nullptr,
+					   stream_path,
+					   sizeof(stream_path)) < 0) {
+			return;
+		}
+
+		_stream_path = stream_path;
+
+		/*
+		 * Open an existing file first to only remove the files created
+		 * here if they end up unused.
+		 */
+		DBG("Preparing stream output file \"%s\"", stream_path);
+		chunk_status = lttng_trace_chunk_open_file(
+			_chunk, stream_path, O_WRONLY, mode, &_fd, true);
+		if (chunk_status == LTTNG_TRACE_CHUNK_STATUS_NO_FILE) {
+			chunk_status = lttng_trace_chunk_open_file(
+				_chunk, stream_path, O_WRONLY | O_CREAT, mode, &_fd, false);
+			_stream_file_created = chunk_status == LTTNG_TRACE_CHUNK_STATUS_OK;
+		}
+
+		if (chunk_status != LTTNG_TRACE_CHUNK_STATUS_OK) {
+			/* Reported by the rotation which opens the file itself. */
+			DBG("Failed to prepare stream output file \"%s\"", stream_path);
+			_fd = -1;
+			return;
+		}
+
+		if (fstat(_fd, &stream_file_stat)) {
+			PERROR("Failed to stat prepared stream file \"%s\"", stream_path);
+			return;
+		}
+
+		_must_truncate = stream_file_stat.st_size > 0;
+
+		chunk_status = lttng_index_file_create_from_trace_chunk_deferred(
+			_chunk,
+			_channel_path.c_str(),
+			_stream_name.c_str(),
+			_tracefile_size,
+			_tracefile_index,
+			CTF_INDEX_MAJOR,
+			CTF_INDEX_MINOR,
+			&_index_file,
+			&_index_file_created);
+		if (chunk_status != LTTNG_TRACE_CHUNK_STATUS_OK) {
+			DBG("Failed to prepare index file of stream \"%s\"", stream_path);
+			_index_file = nullptr;
+			_index_file_created = false;
+			return;
+		}
+
+		_opened = true;
+	}
+
+private:
+	/*
+	 * Close the files which were not taken and remove those created by the
+	 * task to not leave empty tracefiles behind.
+	 *
+	 * The task's lock must be held, unless it is being destroyed.
+	 */
+	void _release() noexcept
+	{
+		if (_fd >= 0 && close(_fd)) {
+			PERROR("Failed to close prepared stream file: stream_name=`%s`",
+			       _stream_name.c_str());
+		}
+
+		_fd = -1;
+		if (_index_file) {
+			lttng_index_file_put(_index_file);
+			_index_file = nullptr;
+		}
+
+		if (_stream_file_created &&
+		    lttng_trace_chunk_unlink_file(_chunk, _stream_path.c_str())) {
+			ERR("Failed to remove unused prepared stream file \"%s\"",
+			    _stream_path.c_str());
+		}
+
+		if (_index_file_created &&
+		    lttng_index_file_unlink_from_trace_chunk(_chunk,
+							     _channel_path.c_str(),
+							     _stream_name.c_str(),
+							     _tracefile_size,
+							     _tracefile_index)) {
+			ERR("Failed to remove unused prepared index file of stream \"%s\"",
+			    _stream_path.c_str());
+		}
+
+		_stream_file_created = false;
+		_index_file_created = false;
+		lttng_trace_chunk_put(_chunk);
+		_chunk = nullptr;
+		_opened = false;
+	}
+
+	lttng_trace_chunk *_chunk;
+	const std::string _channel_path;
+	const std::string _stream_name;
+	const std::uint64_t _tracefile_size;
+	const std::uint64_t _tracefile_index;
+
+	/* Protected by the task's lock. */
+	bool _opened = false;
+	bool _must_truncate = false;
+	bool _stream_file_created = false;
+	bool _index_file_created = false;
+	std::string _stream_path;
+	int _fd = -1;
+	lttng_index_file *_index_file = nullptr;
+};
+
+} /* namespace consumer */
+} /* namespace lttng */
+
+lttng::consumer::output_files_preparation::~output_files_preparation()
+{
+	discard();
+}
+
+void lttng::consumer::output_files_preparation::prepare(const lttng_consumer_stream& stream,
+							std::uint64_t tracefile_index) noexcept
+{
+	discard();
+
+	try {
+		_task = std::make_shared<output_files_opening_task>(stream, tracefile_index);
+		_scheduler.schedule(_task);
+	} catch (const std::exception& ex) {
+		/* Not fatal: the rotation opens the files itself. */
+		DBG("Failed to schedule the preparation of the next output files of stream: stream_name=`%s`, error=`%s`",
+		    stream.name,
+		    ex.what());
+		discard();
+	}
+}
+
+bool lttng::consumer::output_files_preparation::take(const lttng_consumer_stream& stream,
+						     std::uint64_t tracefile_index,
+						     int& fd,
+						     lttng_index_file *& index_file) noexcept
+{
+	bool taken;
+
+	if (!_task) {
+		return false;
+	}
+
+	taken = _task->take(stream.trace_chunk, tracefile_index, fd, index_file);
+	_task.reset();
+	return taken;
+}
+
+void lttng::consumer::output_files_preparation::discard() noexcept
+{
+	if (!_task) {
+		return;
+	}
+
+	_task->discard();
+	_task.reset();
+}
@@ -0,0 +1,85 @@
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ */
+
+#ifndef LTTNG_CONSUMER_OUTPUT_FILES_PREPARATION_HPP
+#define LTTNG_CONSUMER_OUTPUT_FILES_PREPARATION_HPP
+
+#include <common/scheduler.hpp>
+
+#include <cstdint>
+#include <memory>
+
+struct lttng_consumer_stream;
+struct lttng_index_file;
+
+namespace lttng {
+namespace consumer {
+
+class output_files_opening_task;
+
+/*
+ * Opens the output files (trace file and index file) of the next tracefile
+ * of a stream in the background, ahead of its next size-based tracefile
+ * rotation. The rotation then swaps the file descriptors rather than
+ * creating and opening the files, possibly through run-as, on the
+ * consumption path.
+ *
+ * A file which already exists, when the tracefiles wrap around, is only
+ * truncated by the rotation.
+ */
+class output_files_preparation {
+public:
+	explicit output_files_preparation(lttng::scheduling::scheduler& scheduler) noexcept :
+		_scheduler(scheduler)
+	{
+	}
+
+	output_files_preparation(const output_files_preparation&) = delete;
+	output_files_preparation(output_files_preparation&&) = delete;
+	output_files_preparation& operator=(const output_files_preparation&) = delete;
+	output_files_preparation& operator=(output_files_preparation&&) = delete;
+
+	~output_files_preparation();
+
+	/*
+	 * Start opening the output files of tracefile `tracefile_index` in the
+	 * current trace chunk of `stream`, discarding the files prepared so far.
+	 *
+	 * The stream lock must be held.
+	 */
+	void prepare(const lttng_consumer_stream& stream, std::uint64_t tracefile_index) noexcept;
+
+	/*
+	 * Take the output files prepared for tracefile `tracefile_index` in the
+	 * current trace chunk of `stream`. The files are truncated and the
+	 * header of the index file is written.
+	 *
+	 * Only waits if the opening task is running. A task which didn't start
+	 * yet is canceled and nothing is taken.
+	 *
+	 * Returns false if no such files are prepared: the caller must open them.
+	 */
+	bool take(const lttng_consumer_stream& stream,
+		  std::uint64_t tracefile_index,
+		  int& fd,
+		  lttng_index_file *& index_file) noexcept;
+
+	/*
+	 * Close the files prepared so far, removing those created by the
+	 * preparation, and release their trace chunk.
+	 */
+	void discard() noexcept;
+
+private:
+	lttng::scheduling::scheduler& _scheduler;
+	std::shared_ptr<output_files_opening_task> _task;
+};
+
+} /* namespace consumer */
+} /* namespace lttng */
+
+#endif /* LTTNG_CONSUMER_OUTPUT_FILES_PREPARATION_HPP */
@@ -67,6 +67,33 @@
 /* Default consumer paths */
 #define DEFAULT_CONSUMERD_RUNDIR "%s"
 
+/*
+ * Number of threads running the consumer's timer tasks (live, monitor and
+ * metadata switch timers), and its override environment variable. The tasks
+ * expiring together run concurrently so that a slow task (e.g. the live timer
+ * of a channel with many streams) doesn't delay the others.
+ */
+#define DEFAULT_CONSUMERD_TIMER_TASK_WORKER_COUNT     2
+#define DEFAULT_CONSUMERD_TIMER_TASK_WORKER_COUNT_ENV "LTTNG_CONSUMERD_TIMER_TASK_WORKER_COUNT"
+
+/*
+ * Maximal number of sub-buffers and bytes consumed from a ready data stream
+ * each time the data thread wakes up, and their override environment
+ * variables.
+ */
+#define DEFAULT_CONSUMERD_DRAIN_PACKET_BUDGET	  16
+#define DEFAULT_CONSUMERD_DRAIN_PACKET_BUDGET_ENV "LTTNG_CONSUMERD_DRAIN_PACKET_BUDGET"
+#define DEFAULT_CONSUMERD_DRAIN_BYTE_BUDGET	  (4 * 1024 * 1024)
+#define DEFAULT_CONSUMERD_DRAIN_BYTE_BUDGET_ENV	  "LTTNG_CONSUMERD_DRAIN_BYTE_BUDGET"
+
+/*
+ * Number of command connections established by the session daemon with each
+ * consumer daemon. The commands of a session are sent on a single connection;
+ * the consumer daemon handles the commands of different connections
+ * concurrently.
+ */
+#define DEFAULT_CONSUMERD_COMMAND_SOCKET_COUNT 4
+
 /* Kernel consumer path */
 #define DEFAULT_KCONSUMERD_PATH		 DEFAULT_CONSUMERD_RUNDIR "/kconsumerd"
 #define DEFAULT_KCONSUMERD_CMD_SOCK_PATH DEFAULT_KCONSUMERD_PATH "/command"
@@ -343,6 +370,22 @@
 /* Default runas worker name */
 #define DEFAULT_RUN_AS_WORKER_NAME "lttng-runas"
 
+/* Default number of runas workers and its override environment variable. */
+#define DEFAULT_RUN_AS_WORKER_COUNT	4
+#define DEFAULT_RUN_AS_WORKER_COUNT_ENV "LTTNG_RUN_AS_WORKER_COUNT"
+
+/* Default number of client command workers and its override environment variable. */
+#define DEFAULT_CLIENT_WORKER_COUNT	4
+#define DEFAULT_CLIENT_WORKER_COUNT_ENV "LTTNG_CLIENT_WORKER_COUNT"
+
+/*
+ * Delay (ms) after which the configuration changes of an active recording
+ * session are applied to the user space applications, and its override
+ * environment variable. 0 applies each change immediately.
+ */
+#define DEFAULT_APP_SYNC_DELAY	   0
+#define DEFAULT_APP_SYNC_DELAY_ENV "LTTNG_APP_SYNC_DELAY"
+
 /* Default LTTng MI XML namespace. */
 #define DEFAULT_LTTNG_MI_NAMESPACE "https://lttng.org/xml/ns/lttng-mi"
 
@@ -367,6 +410,7 @@
 #define DEFAULT_LTTNG_RELAYD_TCP_KEEP_ALIVE_ABORT_THRESHOLD_ENV \
 	"LTTNG_RELAYD_TCP_KEEP_ALIVE_ABORT_THRESHOLD"
 #define DEFAULT_LTTNG_RELAYD_DISALLOW_CLEAR_ENV "LTTNG_RELAYD_DISALLOW_CLEAR"
+#define DEFAULT_LTTNG_RELAYD_METADATA_FRAGMENTS_ENV "LTTNG_RELAYD_METADATA_FRAGMENTS"
 
 #define DEFAULT_LTTNG_RELAYD_WORKING_DIRECTORY_ENV "LTTNG_RELAYD_WORKING_DIRECTORY"
 
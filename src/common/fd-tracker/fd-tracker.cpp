@@ -26,6 +26,7 @@
 #include <urcu.h>
 #include <urcu/list.h>
 #include <urcu/rculfhash.h>
+#include <urcu/uatomic.h>
 
 /* Tracker lock must be taken by the user. */
 #define TRACKED_COUNT(tracker)                                                          \
@@ -56,17 +57,23 @@ struct fd_tracker {
 	} count;
 	unsigned int capacity;
 	struct {
+		/* Uses of the handles that are no longer tracked. */
 		uint64_t uses;
 		uint64_t misses;
 		/* Failures to suspend or restore fs handles. */
 		uint64_t errors;
 	} stats;
 	/*
-	 * The head of the active_handles list is always the least recently
-	 * used active handle. When an handle is used, it is removed from the
-	 * list and added to the end. When a file has to be suspended, the
-	 * first element in the list is "popped", suspended, and added to the
-	 * list of suspended handles.
+	 * The active_handles list approximates an LRU order using the CLOCK
+	 * (second chance) algorithm: the head of the list is the "hand" of the
+	 * clock.
+	 *
+	 * Using an active handle only sets its "referenced" bit, which does
+	 * not require the tracker's lock. When a file has to be suspended,
+	 * the handles at the head of the list are visited in turn: a
+	 * referenced handle has its bit cleared and is moved to the end of the
+	 * list while the first unreferenced handle is suspended and added to
+	 * the list of suspended handles.
 	 */
 	struct cds_list_head active_handles;
 	struct cds_list_head suspended_handles;
@@ -91,6 +98,11 @@ struct open_properties {
  * In this respect, it is not different from a regular file descriptor.
  *
  * The fs_handle lock always nests _within_ the tracker's lock.
+ *
+ * The `in_use` flag is claimed atomically, either by the user of the handle
+ * (get_fd/put_fd) or by the tracker while it suspends the handle. The user
+ * can thus use an active handle without acquiring any lock; the claim ensures
+ * its fd is not closed in the meantime.
  */
 struct fs_handle_tracked {
 	struct fs_handle parent;
@@ -105,7 +117,12 @@ struct fs_handle_tracked {
 	int fd;
 	/* inode number of the file at the time of the handle's creation. */
 	uint64_t ino;
-	bool in_use;
+	/* Accessed atomically. */
+	int in_use;
+	/* Set atomically when the handle is used, cleared by the tracker's clock. */
+	int referenced;
+	/* Accessed atomically; folded in the tracker's stats when closed. */
+	unsigned long uses;
 	/* Offset to which the file should be restored. */
 	off_t offset;
 	struct cds_list_head handles_list_node;
@@ -210,7 +227,7 @@ static void fs_handle_tracked_log(struct fs_handle_tracked *handle)
 		DBG_NO_LOC("    %s [active, fd %d%s]",
 			   path,
 			   handle->fd,
-			   handle->in_use ? ", in use" : "");
+			   uatomic_read(&handle->in_use) ? ", in use" : "");
 	} else {
 		DBG_NO_LOC("    %s [suspended]", path);
 	}
@@ -228,10 +245,11 @@ static int fs_handle_tracked_suspend(struct fs_handle_tracked *handle)
 	pthread_mutex_lock(&handle->lock);
 	lttng_inode_borrow_location(handle->inode, &node_directory_handle, &path);
 	LTTNG_ASSERT(handle->fd >= 0);
-	if (handle->in_use) {
+	if (uatomic_cmpxchg(&handle->in_use, 0, 1) != 0) {
 		/* This handle can't be suspended as it is currently in use. */
-		ret = -EAGAIN;
-		goto end;
+		handle->tracker->stats.errors++;
+		pthread_mutex_unlock(&handle->lock);
+		return -EAGAIN;
 	}
 
 	ret = lttng_directory_handle_stat(node_directory_handle, path, &fs_stat);
@@ -271,6 +289,10 @@ end:
 	if (ret) {
 		handle->tracker->stats.errors++;
 	}
+
+	/* Release the claim on the handle, publishing the new fd. */
+	cmm_smp_mb();
+	uatomic_set(&handle->in_use, 0);
 	pthread_mutex_unlock(&handle->lock);
 	return ret;
 }
@@ -397,11 +419,20 @@ error:
 void fd_tracker_log(struct fd_tracker *tracker)
 {
 	struct fs_handle_tracked *handle;
+	uint64_t uses;
 
 	pthread_mutex_lock(&tracker->lock);
+	uses = tracker->stats.uses;
+	cds_list_for_each_entry (handle, &tracker->active_handles, handles_list_node) {
+		uses += uatomic_read(&handle->uses);
+	}
+	cds_list_for_each_entry (handle, &tracker->suspended_handles, handles_list_node) {
+		uses += uatomic_read(&handle->uses);
+	}
+
 	DBG_NO_LOC("File descriptor tracker");
 	DBG_NO_LOC("  Stats:");
-	DBG_NO_LOC("    uses:            %" PRIu64, tracker->stats.uses);
+	DBG_NO_LOC("    uses:            %" PRIu64, uses);
 	DBG_NO_LOC("    misses:          %" PRIu64, tracker->stats.misses);
 	DBG_NO_LOC("    errors:          %" PRIu64, tracker->stats.errors);
 	DBG_NO_LOC("  Tracked:           %u", TRACKED_COUNT(tracker));
@@ -566,27 +597,37 @@ error_mutex_init:
 	goto end;
 }
 
-/* Caller must hold the tracker's lock. */
+/*
+ * Caller must hold the tracker's lock.
+ *
+ * Every active handle is visited at most twice: once to clear its
+ * "referenced" bit and once to attempt to suspend it.
+ */
 static int fd_tracker_suspend_handles(struct fd_tracker *tracker, unsigned int count)
 {
 	unsigned int left_to_close = count;
-	unsigned int attempts_left = tracker->count.suspendable.active;
-	struct fs_handle_tracked *handle, *tmp;
+	unsigned int visits_left = 2 * tracker->count.suspendable.active;
 
-	cds_list_for_each_entry_safe (handle, tmp, &tracker->active_handles, handles_list_node) {
+	while (left_to_close > 0 && visits_left > 0 &&
+	       !cds_list_empty(&tracker->active_handles)) {
 		int ret;
+		struct fs_handle_tracked *handle = cds_list_first_entry(
+			&tracker->active_handles, struct fs_handle_tracked, handles_list_node);
 
+		visits_left--;
 		fd_tracker_untrack(tracker, handle);
+		if (uatomic_read(&handle->referenced)) {
+			/* Give the handle a second chance. */
+			uatomic_set(&handle->referenced, 0);
+			fd_tracker_track(tracker, handle);
+			continue;
+		}
+
 		ret = fs_handle_tracked_suspend(handle);
 		fd_tracker_track(tracker, handle);
 		if (!ret) {
 			left_to_close--;
 		}
-		attempts_left--;
-
-		if (left_to_close == 0 || attempts_left == 0) {
-			break;
-		}
 	}
 	return left_to_close ? -EMFILE : 0;
 }
@@ -797,38 +838,59 @@ static int fs_handle_tracked_get_fd(struct fs_handle *_handle)
 		lttng::utils::container_of(_handle, &fs_handle_tracked::parent);
 
 	/*
-	 * TODO This should be optimized as it is a fairly hot path.
-	 * The fd-tracker's lock should only be taken when a fs_handle is
-	 * restored (slow path). On the fast path (fs_handle is active),
-	 * the only effect on the fd_tracker is marking the handle as the
-	 * most recently used. Currently, it is done by a call to the
-	 * track/untrack helpers, but it should be done atomically.
+	 * Fast path: the handle is active. Claiming the handle guarantees that
+	 * the tracker can't suspend it until it is released by put_fd().
+	 *
+	 * The claim can only fail if the tracker is suspending the handle, in
+	 * which case the slow path waits for the tracker's lock.
+	 */
+	if (uatomic_cmpxchg(&handle->in_use, 0, 1) == 0) {
+		if (handle->fd >= 0) {
+			ret = handle->fd;
+			goto mark_used;
+		}
+
+		/* The handle is suspended; release the claim and restore it. */
+		uatomic_set(&handle->in_use, 0);
+	}
+
+	/*
+	 * Slow path: the handle must be restored.
 	 *
 	 * Note that the lock's nesting order must still be respected here.
 	 * The handle's lock nests inside the tracker's lock.
 	 */
 	pthread_mutex_lock(&handle->tracker->lock);
 	pthread_mutex_lock(&handle->lock);
-	LTTNG_ASSERT(!handle->in_use);
+	ret = uatomic_cmpxchg(&handle->in_use, 0, 1);
+	LTTNG_ASSERT(ret == 0);
 
-	handle->tracker->stats.uses++;
 	if (handle->fd >= 0) {
+		/* A suspension attempt failed while the claim was attempted. */
 		ret = handle->fd;
-		/* Mark as most recently used. */
-		fd_tracker_untrack(handle->tracker, handle);
-		fd_tracker_track(handle->tracker, handle);
 	} else {
 		handle->tracker->stats.misses++;
 		ret = fd_tracker_restore_handle(handle->tracker, handle);
 		if (ret < 0) {
 			handle->tracker->stats.errors++;
-			goto end;
+			cmm_smp_mb();
+			uatomic_set(&handle->in_use, 0);
 		}
 	}
-	handle->in_use = true;
-end:
+
 	pthread_mutex_unlock(&handle->lock);
 	pthread_mutex_unlock(&handle->tracker->lock);
+	if (ret < 0) {
+		return ret;
+	}
+
+mark_used:
+	uatomic_inc(&handle->uses);
+	/* Avoid dirtying the cache line when the bit is already set. */
+	if (!uatomic_read(&handle->referenced)) {
+		uatomic_set(&handle->referenced, 1);
+	}
+
 	return ret;
 }
 
@@ -837,9 +899,9 @@ static void fs_handle_tracked_put_fd(struct fs_handle *_handle)
 	struct fs_handle_tracked *handle =
 		lttng::utils::container_of(_handle, &fs_handle_tracked::parent);
 
-	pthread_mutex_lock(&handle->lock);
-	handle->in_use = false;
-	pthread_mutex_unlock(&handle->lock);
+	/* Release the claim on the handle; the tracker may now suspend it. */
+	cmm_smp_mb();
+	uatomic_set(&handle->in_use, 0);
 }
 
 static int fs_handle_tracked_unlink(struct fs_handle *_handle)
@@ -895,6 +957,7 @@ static int fs_handle_tracked_close(struct fs_handle *_handle)
 		inode_directory_handle = lttng_inode_get_location_directory_handle(handle->inode);
 	}
 	fd_tracker_untrack(handle->tracker, handle);
+	handle->tracker->stats.uses += uatomic_read(&handle->uses);
 	if (handle->fd >= 0) {
 		/*
 		 * The return value of close() is not propagated as there
@@ -194,4 +194,7 @@ struct ir_op {
 	} u;
 };
 
+/* Free an IR node and its descendants. */
+void filter_free_ir_recursive(struct ir_op *op);
+
 #endif /* _FILTER_IR_H */
@@ -542,7 +542,7 @@ make_op_binary_bitwise_xor(struct ir_op *left, struct ir_op *right, enum ir_side
 	return make_op_binary_bitwise(AST_OP_BIT_XOR, "^", left, right, side);
 }
 
-static void filter_free_ir_recursive(struct ir_op *op)
+void filter_free_ir_recursive(struct ir_op *op)
 {
 	if (!op)
 		return;
@@ -0,0 +1,577 @@
+/*
+ * filter-visitor-ir-optimize.cpp
+ *
+ * LTTng filter IR optimization
+ *
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include "filter-ast.hpp"
+#include "filter-ir.hpp"
+#include "filter-parser.hpp"
+
+#include <common/compat/errno.hpp>
+#include <common/macros.hpp>
+
+#include <algorithm>
+#include <inttypes.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+/*
+ * The optimizations below must not change the outcome of a filter, including
+ * when the tracer's interpreter fails to evaluate an operand (e.g. a field
+ * compared to a literal of another type), in which case the event is
+ * discarded.
+ *
+ * Hence, an operand that is evaluated by the original expression is only
+ * removed when its result can't influence the outcome of the filter, whether
+ * its evaluation succeeds or not.
+ */
+
+static bool is_numeric_literal(const struct ir_op *node)
+{
+	return node->op == IR_OP_LOAD && node->data_type == IR_DATA_NUMERIC;
+}
+
+static bool is_float_literal(const struct ir_op *node)
+{
+	return node->op == IR_OP_LOAD && node->data_type == IR_DATA_FLOAT;
+}
+
+static bool is_arithmetic_literal(const struct ir_op *node)
+{
+	return is_numeric_literal(node) || is_float_literal(node);
+}
+
+static bool literal_is_true(const struct ir_op *node)
+{
+	return is_numeric_literal(node) ? node->u.load.u.num != 0 : node->u.load.u.flt != 0.0;
+}
+
+static bool is_comparison(enum op_type type)
+{
+	switch (type) {
+	case AST_OP_EQ:
+	case AST_OP_NE:
+	case AST_OP_GT:
+	case AST_OP_LT:
+	case AST_OP_GE:
+	case AST_OP_LE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* Operations which always evaluate to 0 or 1. */
+static bool is_boolean_valued(const struct ir_op *node)
+{
+	switch (node->op) {
+	case IR_OP_LOGICAL:
+		return true;
+	case IR_OP_BINARY:
+		return is_comparison(node->u.binary.type);
+	case IR_OP_UNARY:
+		return node->u.unary.type == AST_UNARY_NOT;
+	case IR_OP_LOAD:
+		return is_numeric_literal(node) &&
+			(node->u.load.u.num == 0 || node->u.load.u.num == 1);
+	default:
+		return false;
+	}
+}
+
+static struct ir_op *make_numeric_literal(int64_t value, enum ir_side side)
+{
+	struct ir_op *op;
+
+	op = zmalloc<ir_op>();
+	if (!op)
+		return nullptr;
+	op->op = IR_OP_LOAD;
+	op->data_type = IR_DATA_NUMERIC;
+	op->signedness = IR_SIGNED;
+	op->side = side;
+	op->u.load.u.num = value;
+	return op;
+}
+
+/*
+ * Replace `*nodep` by `replacement`, which takes its place (side) in the
+ * tree. `replacement` may be a descendant of `*nodep`, in which case it
+ * must have been detached from its parent beforehand.
+ */
+static void replace_node(struct ir_op **nodep, struct ir_op *replacement)
+{
+	replacement->side = (*nodep)->side;
+	filter_free_ir_recursive(*nodep);
+	*nodep = replacement;
+}
+
+static int replace_with_numeric_literal(struct ir_op **nodep, int64_t value)
+{
+	struct ir_op *literal;
+
+	literal = make_numeric_literal(value, (*nodep)->side);
+	if (!literal)
+		return -ENOMEM;
+
+	replace_node(nodep, literal);
+	return 0;
+}
+
+static int compare_literals(enum op_type type, const struct ir_op *left, const struct ir_op *right)
+{
+	if (is_numeric_literal(left) && is_numeric_literal(right)) {
+		const int64_t l = left->u.load.u.num, r = right->u.load.u.num;
+
+		switch (type) {
+		case AST_OP_EQ:
+			return l == r;
+		case AST_OP_NE:
+			return l != r;
+		case AST_OP_GT:
+			return l > r;
+		case AST_OP_LT:
+			return l < r;
+		case AST_OP_GE:
+			return l >= r;
+		case AST_OP_LE:
+			return l <= r;
+		default:
+			abort();
+		}
+	}
+
+	/* Mixed comparisons are performed on doubles, as done by the interpreter. */
+	const double l = is_numeric_literal(left) ? (double) left->u.load.u.num :
+						    left->u.load.u.flt;
+	const double r = is_numeric_literal(right) ? (double) right->u.load.u.num :
+						     right->u.load.u.flt;
+
+	switch (type) {
+	case AST_OP_EQ:
+		return l == r;
+	case AST_OP_NE:
+		return l != r;
+	case AST_OP_GT:
+		return l > r;
+	case AST_OP_LT:
+		return l < r;
+	case AST_OP_GE:
+		return l >= r;
+	case AST_OP_LE:
+		return l <= r;
+	default:
+		abort();
+	}
+}
+
+static int fold_unary(struct ir_op **nodep)
+{
+	struct ir_op *node = *nodep;
+	struct ir_op *child = node->u.unary.child;
+
+	if (is_arithmetic_literal(child)) {
+		switch (node->u.unary.type) {
+		case AST_UNARY_PLUS:
+			break;
+		case AST_UNARY_MINUS:
+			if (is_float_literal(child)) {
+				child->u.load.u.flt = -child->u.load.u.flt;
+			} else if (child->u.load.u.num != INT64_MIN) {
+				child->u.load.u.num = -child->u.load.u.num;
+			} else {
+				/* Leave the overflow to the interpreter. */
+				return 0;
+			}
+			break;
+		case AST_UNARY_NOT:
+			return replace_with_numeric_literal(nodep, !literal_is_true(child));
+		case AST_UNARY_BIT_NOT:
+			if (is_float_literal(child)) {
+				/* Rejected by the interpreter. */
+				return 0;
+			}
+
+			child->u.load.u.num = ~child->u.load.u.num;
+			break;
+		default:
+			return 0;
+		}
+
+		node->u.unary.child = nullptr;
+		replace_node(nodep, child);
+		return 0;
+	}
+
+	if (node->u.unary.type != AST_UNARY_NOT) {
+		return 0;
+	}
+
+	/* !!x is x when x is already a boolean. */
+	if (child->op == IR_OP_UNARY && child->u.unary.type == AST_UNARY_NOT &&
+	    is_boolean_valued(child->u.unary.child)) {
+		struct ir_op *grandchild = child->u.unary.child;
+
+		child->u.unary.child = nullptr;
+		replace_node(nodep, grandchild);
+		return 0;
+	}
+
+	/* !(a == b) is a != b, and vice versa. */
+	if (child->op == IR_OP_BINARY &&
+	    (child->u.binary.type == AST_OP_EQ || child->u.binary.type == AST_OP_NE)) {
+		child->u.binary.type = child->u.binary.type == AST_OP_EQ ? AST_OP_NE : AST_OP_EQ;
+		node->u.unary.child = nullptr;
+		replace_node(nodep, child);
+	}
+
+	return 0;
+}
+
+static int fold_binary(struct ir_op **nodep)
+{
+	struct ir_op *node = *nodep;
+	const struct ir_op *left = node->u.binary.left;
+	const struct ir_op *right = node->u.binary.right;
+
+	if (!is_arithmetic_literal(left) || !is_arithmetic_literal(right)) {
+		return 0;
+	}
+
+	if (is_comparison(node->u.binary.type)) {
+		return replace_with_numeric_literal(
+			nodep, compare_literals(node->u.binary.type, left, right));
+	}
+
+	if (!is_numeric_literal(left) || !is_numeric_literal(right)) {
+		return 0;
+	}
+
+	/* Shifts are left to the interpreter which validates the shift count. */
+	switch (node->u.binary.type) {
+	case AST_OP_BIT_AND:
+		return replace_with_numeric_literal(nodep,
+						    left->u.load.u.num & right->u.load.u.num);
+	case AST_OP_BIT_OR:
+		return replace_with_numeric_literal(nodep,
+						    left->u.load.u.num | right->u.load.u.num);
+	case AST_OP_BIT_XOR:
+		return replace_with_numeric_literal(nodep,
+						    left->u.load.u.num ^ right->u.load.u.num);
+	default:
+		return 0;
+	}
+}
+
+/*
+ * Eliminate the constant operands of a logical operation. The right operand
+ * is only eliminated when the left operand alone determines the result, since
+ * the left operand is always evaluated.
+ */
+static int fold_logical(struct ir_op **nodep)
+{
+	struct ir_op *node = *nodep;
+	struct ir_op *left = node->u.logical.left;
+	struct ir_op *right = node->u.logical.right;
+	const bool is_and = node->u.logical.type == AST_OP_AND;
+
+	if (is_arithmetic_literal(left)) {
+		if (literal_is_true(left) != is_and) {
+			/* `0 && x` and `1 || x`: x is never evaluated. */
+			return replace_with_numeric_literal(nodep, !is_and);
+		}
+
+		/* `1 && x` and `0 || x` evaluate to x as a boolean. */
+		if (is_boolean_valued(right)) {
+			node->u.logical.right = nullptr;
+			replace_node(nodep, right);
+		}
+
+		return 0;
+	}
+
+	/* `x && 1` and `x || 0` evaluate to x as a boolean. */
+	if (is_arithmetic_literal(right) && literal_is_true(right) == is_and &&
+	    is_boolean_valued(left)) {
+		node->u.logical.left = nullptr;
+		replace_node(nodep, left);
+	}
+
+	return 0;
+}
+
+/* Fold the constant sub-expressions of the tree, bottom-up. */
+static int fold_constants(struct ir_op **nodep)
+{
+	struct ir_op *node = *nodep;
+	int ret;
+
+	switch (node->op) {
+	case IR_OP_UNKNOWN:
+	default:
+		fprintf(stderr, "[error] %s: unknown op type\n", __func__);
+		return -EINVAL;
+
+	case IR_OP_ROOT:
+		ret = fold_constants(&node->u.root.child);
+		if (ret)
+			return ret;
+		node->data_type = node->u.root.child->data_type;
+		node->signedness = node->u.root.child->signedness;
+		return 0;
+	case IR_OP_LOAD:
+		return 0;
+	case IR_OP_UNARY:
+		ret = fold_constants(&node->u.unary.child);
+		if (ret)
+			return ret;
+		return fold_unary(nodep);
+	case IR_OP_BINARY:
+		ret = fold_constants(&node->u.binary.left);
+		if (ret)
+			return ret;
+		ret = fold_constants(&node->u.binary.right);
+		if (ret)
+			return ret;
+		return fold_binary(nodep);
+	case IR_OP_LOGICAL:
+		ret = fold_constants(&node->u.logical.left);
+		if (ret)
+			return ret;
+		ret = fold_constants(&node->u.logical.right);
+		if (ret)
+			return ret;
+		return fold_logical(nodep);
+	}
+}
+
+static unsigned int load_expression_cost(const struct ir_load_expression *expression)
+{
+	const struct ir_load_expression_op *op;
+	unsigned int cost = 0;
+
+	for (op = expression->child; op; op = op->next) {
+		switch (op->type) {
+		case IR_LOAD_EXPRESSION_GET_APP_CONTEXT_ROOT:
+			/* Application contexts are provided by callbacks. */
+			cost += 8;
+			break;
+		case IR_LOAD_EXPRESSION_GET_CONTEXT_ROOT:
+			cost += 2;
+			break;
+		default:
+			cost += 1;
+			break;
+		}
+	}
+
+	return cost;
+}
+
+/* Rough relative cost of the evaluation of an expression by the interpreter. */
+static unsigned int evaluation_cost(const struct ir_op *node)
+{
+	switch (node->op) {
+	case IR_OP_ROOT:
+		return evaluation_cost(node->u.root.child);
+	case IR_OP_LOAD:
+		switch (node->data_type) {
+		case IR_DATA_STRING:
+			/* The comparison of strings is accounted for by the comparison. */
+			return node->u.load.u.string.type == IR_LOAD_STRING_TYPE_GLOB_STAR ? 8 : 4;
+		case IR_DATA_FIELD_REF:
+			return 2;
+		case IR_DATA_GET_CONTEXT_REF:
+			return 3;
+		case IR_DATA_EXPRESSION:
+			return load_expression_cost(node->u.load.u.expression);
+		default:
+			return 0;
+		}
+	case IR_OP_UNARY:
+		return evaluation_cost(node->u.unary.child) + 1;
+	case IR_OP_BINARY:
+	case IR_OP_LOGICAL:
+		return evaluation_cost(node->u.binary.left) +
+			evaluation_cost(node->u.binary.right) + 1;
+	default:
+		return 0;
+	}
+}
+
+static size_t count_conjunction_operands(const struct ir_op *node)
+{
+	if (node->op != IR_OP_LOGICAL || node->u.logical.type != AST_OP_AND) {
+		return 1;
+	}
+
+	return count_conjunction_operands(node->u.logical.left) +
+		count_conjunction_operands(node->u.logical.right);
+}
+
+/*
+ * Detach the operands of a chain of `&&` and free the `&&` nodes. Storage for
+ * the operands must be reserved beforehand.
+ */
+static void collect_conjunction_operands(struct ir_op *node, std::vector<struct ir_op *>& operands)
+{
+	if (node->op != IR_OP_LOGICAL || node->u.logical.type != AST_OP_AND) {
+		operands.emplace_back(node);
+		return;
+	}
+
+	collect_conjunction_operands(node->u.logical.left, operands);
+	collect_conjunction_operands(node->u.logical.right, operands);
+	node->u.logical.left = nullptr;
+	node->u.logical.right = nullptr;
+	filter_free_ir_recursive(node);
+}
+
+static struct ir_op *make_logical_and(struct ir_op *left, struct ir_op *right, enum ir_side side)
+{
+	struct ir_op *op;
+
+	op = zmalloc<ir_op>();
+	if (!op)
+		return nullptr;
+	op->op = IR_OP_LOGICAL;
+	op->u.binary.type = AST_OP_AND;
+	op->u.binary.left = left;
+	op->u.binary.right = right;
+	op->data_type = IR_DATA_NUMERIC;
+	op->signedness = IR_SIGNED;
+	op->side = side;
+	left->side = IR_LEFT;
+	right->side = IR_LEFT;
+	return op;
+}
+
+/*
+ * Reorder the operands of the top-level conjunction of the filter so that the
+ * cheapest operands are evaluated first, and drop its constant operands.
+ *
+ * The event is discarded when any operand of the top-level conjunction is
+ * false or fails to evaluate, regardless of the order in which they are
+ * evaluated. This doesn't hold for the operands of a disjunction (nor for a
+ * conjunction nested in a negation or disjunction) since a failure to evaluate
+ * an operand can be masked by another operand being true. Those are left
+ * untouched.
+ */
+static int reorder_conjunction(struct ir_op *root)
+{
+	std::vector<struct ir_op *> operands;
+	struct ir_op *conjunction;
+	struct ir_op *constant_true_operand = nullptr;
+	bool is_constant_false = false;
+	const enum ir_side side = root->u.root.child->side;
+	int ret = 0;
+
+	if (root->u.root.child->op != IR_OP_LOGICAL ||
+	    root->u.root.child->u.logical.type != AST_OP_AND) {
+		return 0;
+	}
+
+	try {
+		operands.reserve(count_conjunction_operands(root->u.root.child));
+	} catch (const std::bad_alloc&) {
+		return -ENOMEM;
+	}
+
+	collect_conjunction_operands(root->u.root.child, operands);
+	root->u.root.child = nullptr;
+
+	/* Constant operands are dropped, which doesn't require additional storage. */
+	auto new_end = std::remove_if(operands.begin(), operands.end(), [&](struct ir_op *operand) {
+		if (!is_arithmetic_literal(operand)) {
+			return false;
+		}
+
+		is_constant_false |= !literal_is_true(operand);
+		if (!constant_true_operand) {
+			constant_true_operand = operand;
+		} else {
+			filter_free_ir_recursive(operand);
+		}
+
+		return true;
+	});
+	operands.erase(new_end, operands.end());
+
+	if (is_constant_false || operands.empty()) {
+		for (auto *operand : operands) {
+			filter_free_ir_recursive(operand);
+		}
+
+		filter_free_ir_recursive(constant_true_operand);
+		conjunction = make_numeric_literal(!is_constant_false, side);
+		if (!conjunction)
+			return -ENOMEM;
+		goto end;
+	}
+
+	if (operands.size() == 1 && !is_boolean_valued(operands[0]) && constant_true_operand) {
+		/* `x && 1` converts x to a boolean. */
+		operands.emplace_back(constant_true_operand);
+	} else {
+		filter_free_ir_recursive(constant_true_operand);
+	}
+
+	std::stable_sort(operands.begin(),
+			 operands.end(),
+			 [](const struct ir_op *a, const struct ir_op *b) {
+				 return evaluation_cost(a) < evaluation_cost(b);
+			 });
+
+	conjunction = operands[0];
+	for (size_t i = 1; i < operands.size(); i++) {
+		struct ir_op *new_conjunction = make_logical_and(conjunction, operands[i], side);
+
+		if (!new_conjunction) {
+			filter_free_ir_recursive(conjunction);
+			for (i++; i < operands.size(); i++) {
+				filter_free_ir_recursive(operands[i]);
+			}
+
+			return -ENOMEM;
+		}
+
+		conjunction = new_conjunction;
+	}
+
+end:
+	conjunction->side = side;
+	root->u.root.child = conjunction;
+	root->data_type = conjunction->data_type;
+	root->signedness = conjunction->signedness;
+	return ret;
+}
+
+/*
+ * Optimize the IR of a validated filter expression:
+ *   - constant folding of comparisons, unary and bitwise operations whose
+ *     operands are literals,
+ *   - elimination of the dead branches of logical operations,
+ *   - strength reduction of negated (in)equalities and double negations,
+ *   - reordering of the operands of the top-level conjunction by evaluation
+ *     cost.
+ */
+int filter_visitor_ir_optimize(struct filter_parser_ctx *ctx)
+{
+	int ret;
+
+	ret = fold_constants(&ctx->ir_root);
+	if (ret)
+		return ret;
+
+	return reorder_conjunction(ctx->ir_root);
+}
@@ -21,8 +21,45 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
-#define WRITE_FILE_FLAGS     (O_WRONLY | O_CREAT | O_TRUNC)
-#define READ_ONLY_FILE_FLAGS O_RDONLY
+#define WRITE_FILE_FLAGS	      LTTNG_INDEX_FILE_WRITE_FLAGS
+#define DEFERRED_WRITE_FILE_FLAGS (O_WRONLY | O_CREAT)
+#define READ_ONLY_FILE_FLAGS	      O_RDONLY
+
+int lttng_index_file_format_path(const char *channel_path,
+				 const char *stream_name,
+				 uint64_t stream_file_size,
+				 uint64_t stream_file_index,
+				 char *index_file_path,
+				 size_t index_file_path_len)
+{
+	int ret;
+	char index_directory_path[LTTNG_PATH_MAX];
+	const char *separator;
+
+	if (channel_path[0] == '\0') {
+		separator = "";
+	} else {
+		separator = "/";
+	}
+	ret = snprintf(index_directory_path,
+		       sizeof(index_directory_path),
+		       "%s%s" DEFAULT_INDEX_DIR,
+		       channel_path,
+		       separator);
+	if (ret < 0 || ret >= sizeof(index_directory_path)) {
+		ERR("Failed to format index directory path");
+		return -1;
+	}
+
+	ret = utils_stream_file_path(index_directory_path,
+				     stream_name,
+				     stream_file_size,
+				     stream_file_index,
+				     DEFAULT_INDEX_FILE_SUFFIX,
+				     index_file_path,
+				     index_file_path_len);
+	return ret ? -1 : 0;
+}
 
 static enum lttng_trace_chunk_status
 _lttng_index_file_create_from_trace_chunk(struct lttng_trace_chunk *chunk,
@@ -35,7 +72,8 @@ _lttng_index_file_create_from_trace_chunk(struct lttng_trace_chunk *chunk,
 					  bool unlink_existing_file,
 					  int flags,
 					  bool expect_no_file,
-					  struct lttng_index_file **file)
+					  struct lttng_index_file **file,
+					  bool *created)
 {
 	struct lttng_index_file *index_file;
 	enum lttng_trace_chunk_status chunk_status;
@@ -43,11 +81,9 @@ _lttng_index_file_create_from_trace_chunk(struct lttng_trace_chunk *chunk,
 	struct fs_handle *fs_handle = nullptr;
 	ssize_t size_ret;
 	struct ctf_packet_index_file_hdr hdr;
-	char index_directory_path[LTTNG_PATH_MAX];
 	char index_file_path[LTTNG_PATH_MAX];
-	const mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP;
+	const mode_t mode = LTTNG_INDEX_FILE_MODE;
 	const bool acquired_reference = lttng_trace_chunk_get(chunk);
-	const char *separator;
 
 	LTTNG_ASSERT(acquired_reference);
 
@@ -59,29 +95,12 @@ _lttng_index_file_create_from_trace_chunk(struct lttng_trace_chunk *chunk,
 	}
 
 	index_file->trace_chunk = chunk;
-	if (channel_path[0] == '\0') {
-		separator = "";
-	} else {
-		separator = "/";
-	}
-	ret = snprintf(index_directory_path,
-		       sizeof(index_directory_path),
-		       "%s%s" DEFAULT_INDEX_DIR,
-		       channel_path,
-		       separator);
-	if (ret < 0 || ret >= sizeof(index_directory_path)) {
-		ERR("Failed to format index directory path");
-		chunk_status = LTTNG_TRACE_CHUNK_STATUS_ERROR;
-		goto error;
-	}
-
-	ret = utils_stream_file_path(index_directory_path,
-				     stream_name,
-				     stream_file_size,
-				     stream_file_index,
-				     DEFAULT_INDEX_FILE_SUFFIX,
-				     index_file_path,
-				     sizeof(index_file_path));
+	ret = lttng_index_file_format_path(channel_path,
+					   stream_name,
+					   stream_file_size,
+					   stream_file_index,
+					   index_file_path,
+					   sizeof(index_file_path));
 	if (ret) {
 		chunk_status = LTTNG_TRACE_CHUNK_STATUS_ERROR;
 		goto error;
@@ -104,13 +123,30 @@ _lttng_index_file_create_from_trace_chunk(struct lttng_trace_chunk *chunk,
 		}
 	}
 
-	chunk_status = lttng_trace_chunk_open_fs_handle(
-		chunk, index_file_path, flags, mode, &fs_handle, expect_no_file);
+	if (flags == DEFERRED_WRITE_FILE_FLAGS) {
+		/*
+		 * Open an existing file first to let the caller know whether
+		 * the file was created, and remove it if it ends up unused.
+		 */
+		chunk_status = lttng_trace_chunk_open_fs_handle(
+			chunk, index_file_path, flags & ~O_CREAT, mode, &fs_handle, true);
+		*created = chunk_status == LTTNG_TRACE_CHUNK_STATUS_NO_FILE;
+		if (*created) {
+			chunk_status = lttng_trace_chunk_open_fs_handle(
+				chunk, index_file_path, flags, mode, &fs_handle, false);
+		}
+	} else {
+		chunk_status = lttng_trace_chunk_open_fs_handle(
+			chunk, index_file_path, flags, mode, &fs_handle, expect_no_file);
+	}
 	if (chunk_status != LTTNG_TRACE_CHUNK_STATUS_OK) {
 		goto error;
 	}
 
-	if (flags == WRITE_FILE_FLAGS) {
+	if (flags == DEFERRED_WRITE_FILE_FLAGS) {
+		/* The header is written by lttng_index_file_reset(). */
+		index_file->element_len = ctf_packet_index_len(index_major, index_minor);
+	} else if (flags == WRITE_FILE_FLAGS) {
 		ctf_packet_index_file_hdr_init(&hdr, index_major, index_minor);
 		size_ret = fs_handle_write(fs_handle, &hdr, sizeof(hdr));
 		if (size_ret < sizeof(hdr)) {
@@ -196,7 +232,90 @@ lttng_index_file_create_from_trace_chunk(struct lttng_trace_chunk *chunk,
 							 unlink_existing_file,
 							 WRITE_FILE_FLAGS,
 							 false,
-							 file);
+							 file,
+							 nullptr);
+}
+
+enum lttng_trace_chunk_status
+lttng_index_file_create_from_trace_chunk_deferred(struct lttng_trace_chunk *chunk,
+						  const char *channel_path,
+						  const char *stream_name,
+						  uint64_t stream_file_size,
+						  uint64_t stream_file_index,
+						  uint32_t index_major,
+						  uint32_t index_minor,
+						  struct lttng_index_file **file,
+						  bool *created)
+{
+	return _lttng_index_file_create_from_trace_chunk(chunk,
+							 channel_path,
+							 stream_name,
+							 stream_file_size,
+							 stream_file_index,
+							 index_major,
+							 index_minor,
+							 false,
+							 DEFERRED_WRITE_FILE_FLAGS,
+							 false,
+							 file,
+							 created);
+}
+
+/*
+ * Remove the index file of a stream's tracefile from a trace chunk.
+ *
+ * Return 0 on success, -1 on error.
+ */
+int lttng_index_file_unlink_from_trace_chunk(struct lttng_trace_chunk *chunk,
+					     const char *channel_path,
+					     const char *stream_name,
+					     uint64_t stream_file_size,
+					     uint64_t stream_file_index)
+{
+	char index_file_path[LTTNG_PATH_MAX];
+
+	if (lttng_index_file_format_path(channel_path,
+					 stream_name,
+					 stream_file_size,
+					 stream_file_index,
+					 index_file_path,
+					 sizeof(index_file_path))) {
+		return -1;
+	}
+
+	return lttng_trace_chunk_unlink_file(chunk, index_file_path) ==
+			LTTNG_TRACE_CHUNK_STATUS_OK ?
+		0 :
+		-1;
+}
+
+/*
+ * Truncate an index file opened by
+ * lttng_index_file_create_from_trace_chunk_deferred() and write its header.
+ *
+ * Return 0 on success, -1 on error.
+ */
+int lttng_index_file_reset(struct lttng_index_file *index_file)
+{
+	struct ctf_packet_index_file_hdr hdr;
+	ssize_t size_ret;
+
+	LTTNG_ASSERT(index_file);
+
+	if (fs_handle_truncate(index_file->file, 0) ||
+	    fs_handle_seek(index_file->file, 0, SEEK_SET) != 0) {
+		PERROR("Failed to truncate index file");
+		return -1;
+	}
+
+	ctf_packet_index_file_hdr_init(&hdr, index_file->major, index_file->minor);
+	size_ret = fs_handle_write(index_file->file, &hdr, sizeof(hdr));
+	if (size_ret < sizeof(hdr)) {
+		PERROR("Failed to write index header");
+		return -1;
+	}
+
+	return 0;
 }
 
 enum lttng_trace_chunk_status
@@ -220,7 +339,8 @@ lttng_index_file_create_from_trace_chunk_read_only(struct lttng_trace_chunk *chu
 							 false,
 							 READ_ONLY_FILE_FLAGS,
 							 expect_no_file,
-							 file);
+							 file,
+							 nullptr);
 }
 
 /*
@@ -15,9 +15,15 @@
 #include <common/fs-handle.hpp>
 #include <common/trace-chunk.hpp>
 
+#include <fcntl.h>
 #include <inttypes.h>
+#include <sys/stat.h>
 #include <urcu/ref.h>
 
+/* Flags and mode with which the index files are created for writing. */
+#define LTTNG_INDEX_FILE_WRITE_FLAGS (O_WRONLY | O_CREAT | O_TRUNC)
+#define LTTNG_INDEX_FILE_MODE	     (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP)
+
 struct lttng_index_file {
 	struct fs_handle *file;
 	uint32_t major;
@@ -42,6 +48,45 @@ lttng_index_file_create_from_trace_chunk(struct lttng_trace_chunk *chunk,
 					 bool unlink_existing_file,
 					 struct lttng_index_file **file);
 
+/*
+ * Open an index file for writing without truncating it nor writing its
+ * header, which is done by lttng_index_file_reset(). This allows the index
+ * file of the next tracefile to be opened ahead of a tracefile rotation.
+ *
+ * `created` is set to true if the file didn't exist, in which case the
+ * caller removes it with lttng_index_file_unlink_from_trace_chunk() if it
+ * ends up unused.
+ */
+enum lttng_trace_chunk_status
+lttng_index_file_create_from_trace_chunk_deferred(struct lttng_trace_chunk *chunk,
+						  const char *channel_path,
+						  const char *stream_name,
+						  uint64_t stream_file_size,
+						  uint64_t stream_file_index,
+						  uint32_t index_major,
+						  uint32_t index_minor,
+						  struct lttng_index_file **file,
+						  bool *created);
+int lttng_index_file_reset(struct lttng_index_file *index_file);
+
+/*
+ * Format the path, relative to the trace chunk, of the index file of a
+ * stream's tracefile.
+ *
+ * Return 0 on success, -1 on error.
+ */
+int lttng_index_file_format_path(const char *channel_path,
+				 const char *stream_name,
+				 uint64_t stream_file_size,
+				 uint64_t stream_file_index,
+				 char *index_file_path,
+				 size_t index_file_path_len);
+int lttng_index_file_unlink_from_trace_chunk(struct lttng_trace_chunk *chunk,
+					     const char *channel_path,
+					     const char *stream_name,
+					     uint64_t stream_file_size,
+					     uint64_t stream_file_index);
+
 enum lttng_trace_chunk_status
 lttng_index_file_create_from_trace_chunk_read_only(struct lttng_trace_chunk *chunk,
 						   const char *channel_path,
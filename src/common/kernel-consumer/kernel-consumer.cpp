@@ -587,6 +587,7 @@ int lttng_kconsumer_recv_cmd(struct lttng_consumer_local_data *ctx,
 			goto end_nosignal;
 		}
 		new_channel->nb_init_stream_left = msg.u.channel.nb_init_streams;
+		new_channel->output_files_scheduler = &ctx->output_files_scheduler;
 		switch (msg.u.channel.output) {
 		case LTTNG_EVENT_SPLICE:
 			new_channel->output = CONSUMER_CHANNEL_SPLICE;
@@ -1174,6 +1175,20 @@ int lttng_kconsumer_recv_cmd(struct lttng_consumer_local_data *ctx,
 
 		break;
 	}
+	case LTTNG_CONSUMER_GET_DRAIN_STATISTICS:
+	{
+		DBG("Kernel consumer get drain statistics command");
+
+		health_code_update();
+
+		/* Send back the statistics to session daemon */
+		if (consumer_send_drain_statistics(sock) < 0) {
+			PERROR("send drain statistics");
+			goto error_fatal;
+		}
+
+		break;
+	}
 	case LTTNG_CONSUMER_SET_CHANNEL_MONITOR_PIPE:
 	{
 		int channel_monitor_pipe;
@@ -11,20 +11,25 @@
 #include <common/error.hpp>
 #include <common/lttng-elf.hpp>
 #include <common/macros.hpp>
-#include <common/readwrite.hpp>
 
-#include <algorithm>
 #include <elf.h>
 #include <fcntl.h>
+#include <inttypes.h>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <string>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <unordered_map>
+#include <vector>
 
-#define BUF_LEN				4096
 #define TEXT_SECTION_NAME		".text"
 #define SYMBOL_TAB_SECTION_NAME		".symtab"
 #define STRING_TAB_SECTION_NAME		".strtab"
@@ -33,7 +38,7 @@
 #define NOTE_STAPSDT_SECTION_NAME	".note.stapsdt"
 #define NOTE_STAPSDT_NAME		"stapsdt"
 #define NOTE_STAPSDT_TYPE		3
-#define MAX_SECTION_DATA_SIZE		(512 * 1024 * 1024)
+#define ELF_INDEX_CACHE_SIZE		8
 
 #if BYTE_ORDER == LITTLE_ENDIAN
 #define NATIVE_ELF_ENDIANNESS ELFDATA2LSB
@@ -189,10 +194,100 @@ struct lttng_elf_sym {
 	uint64_t st_value;
 	uint64_t st_size;
 };
+
+/*
+ * Location of the .text section, used to convert the virtual addresses of
+ * functions and SDT probes to offsets in the binary file.
+ */
+struct lttng_elf_text_section {
+	bool found;
+	uint64_t offset;
+	uint64_t addr;
+	uint64_t size;
+};
+
+struct lttng_elf_sdt_probe {
+	uint64_t location;
+	uint64_t semaphore_location;
+};
+
+/*
+ * Index of the function symbols and SDT probes of a binary.
+ *
+ * Both indexes are built on their first use by a single pass over the
+ * corresponding sections. A binary is identified by its device, inode,
+ * modification time and size so that modified binaries are indexed anew.
+ */
+struct lttng_elf_index {
+	dev_t dev;
+	ino_t ino;
+	struct timespec mtime;
+	off_t size;
+
+	struct lttng_elf_text_section text_section;
+
+	bool symbols_indexed;
+	/* Address of function symbols, by name. The first occurrence of a name wins. */
+	std::unordered_map<std::string, uint64_t> function_addresses;
+
+	bool sdt_probes_indexed;
+	bool has_sdt_probe_section;
+	/* SDT probes, in note order, by "provider\0probe" key. */
+	std::unordered_map<std::string, std::vector<lttng_elf_sdt_probe>> sdt_probes;
+};
+
+/*
+ * Cache of the indexes of the most recently inspected binaries. Instrumenting
+ * many functions or probes of the same binary results in a lookup per
+ * location; only the first one has to parse the binary.
+ */
+class lttng_elf_index_cache {
+public:
+	/* Must be called with the lock held. */
+	lttng_elf_index *get(const struct stat& stat_buf)
+	{
+		for (auto it = _indexes.begin(); it != _indexes.end(); ++it) {
+			const auto& index = **it;
+
+			if (index.dev != stat_buf.st_dev || index.ino != stat_buf.st_ino ||
+			    index.size != stat_buf.st_size ||
+			    index.mtime.tv_sec != stat_buf.st_mtim.tv_sec ||
+			    index.mtime.tv_nsec != stat_buf.st_mtim.tv_nsec) {
+				continue;
+			}
+
+			/* Move to the front to keep the indexes in LRU order. */
+			_indexes.splice(_indexes.begin(), _indexes, it);
+			return _indexes.front().get();
+		}
+
+		std::unique_ptr<lttng_elf_index> new_index(new lttng_elf_index());
+
+		new_index->dev = stat_buf.st_dev;
+		new_index->ino = stat_buf.st_ino;
+		new_index->mtime = stat_buf.st_mtim;
+		new_index->size = stat_buf.st_size;
+
+		_indexes.emplace_front(std::move(new_index));
+		if (_indexes.size() > ELF_INDEX_CACHE_SIZE) {
+			_indexes.pop_back();
+		}
+
+		return _indexes.front().get();
+	}
+
+	std::mutex lock;
+
+private:
+	std::list<std::unique_ptr<lttng_elf_index>> _indexes;
+};
+
+lttng_elf_index_cache the_elf_index_cache;
 } /* namespace */
 
 struct lttng_elf {
-	int fd;
+	/* Read-only mapping of the whole binary. */
+	const char *data;
 	size_t file_size;
 	uint8_t bitness;
 	uint8_t endianness;
@@ -200,7 +295,7 @@ struct lttng_elf {
 	off_t section_names_offset;
 	/* Size in bytes of section names string table. */
 	size_t section_names_size;
-	struct lttng_elf_ehdr *ehdr;
+	struct lttng_elf_ehdr ehdr;
 };
 
 static inline int is_elf_32_bit(struct lttng_elf *elf)
@@ -213,29 +308,32 @@ static inline int is_elf_native_endian(struct lttng_elf *elf)
 	return elf->endianness == NATIVE_ELF_ENDIANNESS;
 }
 
+/*
+ * Check that the `size` bytes at `offset` are within the mapped binary.
+ */
+static inline bool lttng_elf_range_is_valid(struct lttng_elf *elf, uint64_t offset, uint64_t size)
+{
+	return offset <= elf->file_size && size <= elf->file_size - offset;
+}
+
 static int
 populate_section_header(struct lttng_elf *elf, struct lttng_elf_shdr *shdr, uint32_t index)
 {
 	int ret = 0;
-	off_t offset;
+	uint64_t offset;
 
 	/* Compute the offset of the section in the file */
-	offset = (off_t) elf->ehdr->e_shoff + (off_t) index * elf->ehdr->e_shentsize;
-
-	if (lseek(elf->fd, offset, SEEK_SET) < 0) {
-		PERROR("Error seeking to the beginning of ELF section header");
-		ret = -1;
-		goto error;
-	}
+	offset = elf->ehdr.e_shoff + (uint64_t) index * elf->ehdr.e_shentsize;
 
 	if (is_elf_32_bit(elf)) {
 		Elf32_Shdr elf_shdr;
 
-		if (lttng_read(elf->fd, &elf_shdr, sizeof(elf_shdr)) < sizeof(elf_shdr)) {
-			PERROR("Error reading ELF section header");
+		if (!lttng_elf_range_is_valid(elf, offset, sizeof(elf_shdr))) {
+			DBG("ELF section header is out of the bounds of the file");
 			ret = -1;
 			goto error;
 		}
+		memcpy(&elf_shdr, elf->data + offset, sizeof(elf_shdr));
 		if (!is_elf_native_endian(elf)) {
 			bswap_shdr(elf_shdr);
 		}
@@ -243,11 +341,12 @@ populate_section_header(struct lttng_elf *elf, struct lttng_elf_shdr *shdr, uint
 	} else {
 		Elf64_Shdr elf_shdr;
 
-		if (lttng_read(elf->fd, &elf_shdr, sizeof(elf_shdr)) < sizeof(elf_shdr)) {
-			PERROR("Error reading ELF section header");
+		if (!lttng_elf_range_is_valid(elf, offset, sizeof(elf_shdr))) {
+			DBG("ELF section header is out of the bounds of the file");
 			ret = -1;
 			goto error;
 		}
+		memcpy(&elf_shdr, elf->data + offset, sizeof(elf_shdr));
 		if (!is_elf_native_endian(elf)) {
 			bswap_shdr(elf_shdr);
 		}
@@ -262,16 +361,6 @@ static int populate_elf_header(struct lttng_elf *elf)
 {
 	int ret = 0;
 
-	/*
-	 * Move the read pointer back to the beginning to read the full header
-	 * and copy it in our structure.
-	 */
-	if (lseek(elf->fd, 0, SEEK_SET) < 0) {
-		PERROR("Error seeking to the beginning of the file");
-		ret = -1;
-		goto error;
-	}
-
 	/*
 	 * Use macros to set fields in the ELF header struct for both 32bit and
 	 * 64bit.
@@ -279,25 +368,27 @@ static int populate_elf_header(struct lttng_elf *elf)
 	if (is_elf_32_bit(elf)) {
 		Elf32_Ehdr elf_ehdr;
 
-		if (lttng_read(elf->fd, &elf_ehdr, sizeof(elf_ehdr)) < sizeof(elf_ehdr)) {
+		if (!lttng_elf_range_is_valid(elf, 0, sizeof(elf_ehdr))) {
 			ret = -1;
 			goto error;
 		}
+		memcpy(&elf_ehdr, elf->data, sizeof(elf_ehdr));
 		if (!is_elf_native_endian(elf)) {
 			bswap_ehdr(elf_ehdr);
 		}
-		copy_ehdr(elf_ehdr, *(elf->ehdr));
+		copy_ehdr(elf_ehdr, elf->ehdr);
 	} else {
 		Elf64_Ehdr elf_ehdr;
 
-		if (lttng_read(elf->fd, &elf_ehdr, sizeof(elf_ehdr)) < sizeof(elf_ehdr)) {
+		if (!lttng_elf_range_is_valid(elf, 0, sizeof(elf_ehdr))) {
 			ret = -1;
 			goto error;
 		}
+		memcpy(&elf_ehdr, elf->data, sizeof(elf_ehdr));
 		if (!is_elf_native_endian(elf)) {
 			bswap_ehdr(elf_ehdr);
 		}
-		copy_ehdr(elf_ehdr, *(elf->ehdr));
+		copy_ehdr(elf_ehdr, elf->ehdr);
 	}
 error:
 	return ret;
@@ -319,7 +410,7 @@ lttng_elf_get_section_hdr(struct lttng_elf *elf, uint16_t index, struct lttng_el
 		goto error;
 	}
 
-	if (index >= elf->ehdr->e_shnum) {
+	if (index >= elf->ehdr.e_shnum) {
 		ret = -1;
 		goto error;
 	}
@@ -339,111 +430,52 @@ error:
  * sh_name value) in bytes relative to the beginning of the section
  * names string table.
  *
- * If no name is found, NULL is returned.
+ * The returned name points into the mapping of the binary. If no name is
+ * found, NULL is returned.
  */
-static char *lttng_elf_get_section_name(struct lttng_elf *elf, off_t offset)
+static const char *lttng_elf_get_section_name(struct lttng_elf *elf, off_t offset)
 {
-	char *name = nullptr;
-	size_t name_length = 0, to_read; /* name_length does not include \0 */
+	const char *name;
 
 	if (!elf) {
-		goto error;
-	}
-
-	if (offset >= elf->section_names_size) {
-		goto error;
+		return nullptr;
 	}
 
-	if (lseek(elf->fd, elf->section_names_offset + offset, SEEK_SET) < 0) {
-		PERROR("Error seeking to the beginning of ELF string table section");
-		goto error;
+	if (offset < 0 || offset >= elf->section_names_size) {
+		return nullptr;
 	}
 
-	to_read = elf->section_names_size - offset;
+	name = elf->data + elf->section_names_offset + offset;
 
-	/* Find first \0 after or at current location, remember name_length. */
-	for (;;) {
-		char buf[BUF_LEN];
-		ssize_t read_len;
-		size_t i;
-
-		if (!to_read) {
-			goto error;
-		}
-		read_len = lttng_read(elf->fd, buf, std::min<size_t>(BUF_LEN, to_read));
-		if (read_len <= 0) {
-			PERROR("Error reading ELF string table section");
-			goto error;
-		}
-		for (i = 0; i < read_len; i++) {
-			if (buf[i] == '\0') {
-				name_length += i;
-				goto end;
-			}
-		}
-		name_length += read_len;
-		to_read -= read_len;
-	}
-end:
-	/*
-	 * We found the length of the section name, now seek back to the
-	 * beginning of the name and copy it in the newly allocated buffer.
-	 */
-	name = calloc<char>((name_length + 1)); /* + 1 for \0 */
-	if (!name) {
-		PERROR("Error allocating ELF section name buffer");
-		goto error;
-	}
-	if (lseek(elf->fd, elf->section_names_offset + offset, SEEK_SET) < 0) {
-		PERROR("Error seeking to the offset of the ELF section name");
-		goto error;
-	}
-	if (lttng_read(elf->fd, name, name_length + 1) < name_length + 1) {
-		PERROR("Error reading the ELF section name");
-		goto error;
+	/* The name must be terminated within the string table. */
+	if (!memchr(name, '\0', elf->section_names_size - offset)) {
+		DBG("Unterminated ELF section name");
+		return nullptr;
 	}
 
 	return name;
-
-error:
-	free(name);
-	return nullptr;
 }
 
 static int lttng_elf_validate_and_populate(struct lttng_elf *elf)
 {
 	uint8_t version;
-	uint8_t e_ident[EI_NIDENT];
-	uint8_t *magic_number = nullptr;
+	const uint8_t *e_ident;
+	const uint8_t *magic_number = nullptr;
 	int ret = 0;
 
-	if (elf->fd == -1) {
-		DBG("fd error");
-		ret = LTTNG_ERR_ELF_PARSING;
-		goto end;
-	}
-
 	/*
 	 * First read the magic number, endianness and version to later populate
 	 * the ELF header with the correct endianness and bitness.
 	 * (see elf.h)
 	 */
-
-	if (lseek(elf->fd, 0, SEEK_SET) < 0) {
-		PERROR("Error seeking the beginning of ELF file");
-		ret = LTTNG_ERR_ELF_PARSING;
-		goto end;
-	}
-	ret = lttng_read(elf->fd, e_ident, EI_NIDENT);
-	if (ret < EI_NIDENT) {
+	if (elf->file_size < EI_NIDENT) {
 		DBG("Error reading the ELF identification fields");
-		if (ret == -1) {
-			PERROR("Error reading the ELF identification fields");
-		}
 		ret = LTTNG_ERR_ELF_PARSING;
 		goto end;
 	}
 
+	e_ident = (const uint8_t *) elf->data;
+
 	/*
 	 * Copy fields used to check that the target file is in fact a valid ELF
 	 * file.
@@ -489,55 +521,34 @@ static int lttng_elf_validate_and_populate(struct lttng_elf *elf)
 		goto end;
 	}
 
-	elf->ehdr = zmalloc<lttng_elf_ehdr>();
-	if (!elf->ehdr) {
-		PERROR("Error allocation buffer for ELF header");
-		ret = LTTNG_ERR_NOMEM;
-		goto end;
-	}
-
 	/*
 	 * Copy the content of the elf header.
 	 */
 	ret = populate_elf_header(elf);
 	if (ret) {
 		DBG("Error reading ELF header,");
-		goto free_elf_error;
+		goto end;
 	}
 
-	goto end;
-
-free_elf_error:
-	free(elf->ehdr);
-	elf->ehdr = nullptr;
 end:
 	return ret;
 }
 
 /*
- * Create an instance of lttng_elf for the ELF file located at
- * `path`.
+ * Create an instance of lttng_elf mapping the ELF file referred to by `fd`,
+ * of which `stat_buf` is the status.
  *
  * Return a pointer to the instance on success, NULL on failure.
  */
-static struct lttng_elf *lttng_elf_create(int fd)
+static struct lttng_elf *lttng_elf_create(int fd, const struct stat& stat_buf)
 {
 	struct lttng_elf_shdr section_names_shdr;
 	struct lttng_elf *elf = nullptr;
+	void *data;
 	int ret;
-	struct stat stat_buf;
-
-	if (fd < 0) {
-		goto error;
-	}
 
-	ret = fstat(fd, &stat_buf);
-	if (ret) {
-		PERROR("Failed to determine size of elf file");
-		goto error;
-	}
-	if (!S_ISREG(stat_buf.st_mode)) {
-		ERR("Refusing to initialize lttng_elf from non-regular file");
+	if (stat_buf.st_size <= 0) {
+		ERR("Refusing to initialize lttng_elf from an empty file");
 		goto error;
 	}
 
@@ -548,36 +559,37 @@ static struct lttng_elf *lttng_elf_create(int fd)
 	}
 	elf->file_size = (size_t) stat_buf.st_size;
 
-	elf->fd = dup(fd);
-	if (elf->fd < 0) {
-		PERROR("Error duplicating file descriptor to binary");
+	data = mmap(nullptr, elf->file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED) {
+		PERROR("Error mapping binary");
 		goto error;
 	}
+	elf->data = (const char *) data;
 
 	ret = lttng_elf_validate_and_populate(elf);
 	if (ret) {
 		goto error;
 	}
 
-	ret = lttng_elf_get_section_hdr(elf, elf->ehdr->e_shstrndx, &section_names_shdr);
+	ret = lttng_elf_get_section_hdr(elf, elf->ehdr.e_shstrndx, &section_names_shdr);
 	if (ret) {
 		goto error;
 	}
 
+	if (!lttng_elf_range_is_valid(
+		    elf, section_names_shdr.sh_offset, section_names_shdr.sh_size)) {
+		DBG("ELF section names string table is out of the bounds of the file");
+		goto error;
+	}
+
 	elf->section_names_offset = section_names_shdr.sh_offset;
 	elf->section_names_size = section_names_shdr.sh_size;
 	return elf;
 
 error:
 	if (elf) {
-		if (elf->ehdr) {
-			free(elf->ehdr);
-		}
-		if (elf->fd >= 0) {
-			if (close(elf->fd)) {
-				PERROR("Error closing file descriptor in error path");
-				abort();
-			}
+		if (elf->data && munmap((void *) elf->data, elf->file_size)) {
+			PERROR("Error unmapping binary in error path");
 		}
 		free(elf);
 	}
@@ -593,10 +605,8 @@ static void lttng_elf_destroy(struct lttng_elf *elf)
 		return;
 	}
 
-	free(elf->ehdr);
-	if (close(elf->fd)) {
-		PERROR("Error closing file description in error path");
-		abort();
+	if (munmap((void *) elf->data, elf->file_size)) {
+		PERROR("Error unmapping binary");
 	}
 	free(elf);
 }
@@ -606,10 +616,9 @@ static int lttng_elf_get_section_hdr_by_name(struct lttng_elf *elf,
 					     struct lttng_elf_shdr *section_hdr)
 {
 	int i;
-	char *curr_section_name;
 
-	for (i = 0; i < elf->ehdr->e_shnum; ++i) {
-		bool name_equal;
+	for (i = 0; i < elf->ehdr.e_shnum; ++i) {
+		const char *curr_section_name;
 		const int ret = lttng_elf_get_section_hdr(elf, i, section_hdr);
 
 		if (ret) {
@@ -619,55 +628,50 @@ static int lttng_elf_get_section_hdr_by_name(struct lttng_elf *elf,
 		if (!curr_section_name) {
 			continue;
 		}
-		name_equal = strcmp(curr_section_name, section_name) == 0;
-		free(curr_section_name);
-		if (name_equal) {
+		if (strcmp(curr_section_name, section_name) == 0) {
 			return 0;
 		}
 	}
 	return LTTNG_ERR_ELF_PARSING;
 }
 
-static char *lttng_elf_get_section_data(struct lttng_elf *elf, struct lttng_elf_shdr *shdr)
+/*
+ * Return a pointer to the data of a section, within the mapping of the
+ * binary, or NULL if the section is out of the bounds of the file.
+ */
+static const char *lttng_elf_get_section_data(struct lttng_elf *elf,
+					      const struct lttng_elf_shdr *shdr)
 {
-	int ret;
-	off_t section_offset;
-	char *data;
-	size_t max_alloc_size;
-
 	if (!elf || !shdr) {
-		goto error;
+		return nullptr;
 	}
 
-	max_alloc_size = std::min<size_t>(MAX_SECTION_DATA_SIZE, elf->file_size);
-
-	section_offset = shdr->sh_offset;
-	if (lseek(elf->fd, section_offset, SEEK_SET) < 0) {
-		PERROR("Error seeking to section offset");
-		goto error;
+	if (!lttng_elf_range_is_valid(elf, shdr->sh_offset, shdr->sh_size)) {
+		ERR("ELF section is out of the bounds of the file: offset=%" PRIu64
+		    ", size=%" PRIu64 ", file size=%zu",
+		    shdr->sh_offset,
+		    shdr->sh_size,
+		    elf->file_size);
+		return nullptr;
 	}
 
-	if (shdr->sh_size > max_alloc_size) {
-		ERR("ELF section size exceeds maximal allowed size of %zu bytes", max_alloc_size);
-		goto error;
-	}
-	data = calloc<char>(shdr->sh_size);
-	if (!data) {
-		PERROR("Error allocating buffer for ELF section data");
-		goto error;
-	}
-	ret = lttng_read(elf->fd, data, shdr->sh_size);
-	if (ret == -1) {
-		PERROR("Error reading ELF section data");
-		goto free_error;
-	}
+	return elf->data + shdr->sh_offset;
+}
 
-	return data;
+static void lttng_elf_index_text_section(struct lttng_elf *elf, struct lttng_elf_index *index)
+{
+	struct lttng_elf_shdr text_section_hdr;
 
-free_error:
-	free(data);
-error:
-	return nullptr;
+	if (lttng_elf_get_section_hdr_by_name(elf, TEXT_SECTION_NAME, &text_section_hdr)) {
+		DBG("Text section not found in binary.");
+		index->text_section.found = false;
+		return;
+	}
+
+	index->text_section.found = true;
+	index->text_section.offset = text_section_hdr.sh_offset;
+	index->text_section.addr = text_section_hdr.sh_addr;
+	index->text_section.size = text_section_hdr.sh_size;
 }
 
 /*
@@ -677,91 +681,50 @@ error:
  *
  * Returns the offset on success or non-zero in case of failure.
  */
-static int lttng_elf_convert_addr_in_text_to_offset(struct lttng_elf *elf_handle,
-						    size_t addr,
+static int lttng_elf_convert_addr_in_text_to_offset(const struct lttng_elf_index *index,
+						    uint64_t addr,
 						    uint64_t *offset)
 {
-	int ret = 0;
-	off_t text_section_offset;
-	off_t text_section_addr_beg;
-	off_t text_section_addr_end;
-	off_t offset_in_section;
-	struct lttng_elf_shdr text_section_hdr;
-
-	if (!elf_handle) {
-		DBG("Invalid ELF handle.");
-		ret = LTTNG_ERR_ELF_PARSING;
-		goto error;
-	}
+	const struct lttng_elf_text_section *text_section = &index->text_section;
 
-	/* Get a pointer to the .text section header. */
-	ret = lttng_elf_get_section_hdr_by_name(elf_handle, TEXT_SECTION_NAME, &text_section_hdr);
-	if (ret) {
+	if (!text_section->found) {
 		DBG("Text section not found in binary.");
-		ret = LTTNG_ERR_ELF_PARSING;
-		goto error;
+		return LTTNG_ERR_ELF_PARSING;
 	}
 
-	text_section_offset = text_section_hdr.sh_offset;
-	text_section_addr_beg = text_section_hdr.sh_addr;
-	text_section_addr_end = text_section_addr_beg + text_section_hdr.sh_size;
-
 	/*
 	 * Verify that the address is within the .text section boundaries.
 	 */
-	if (addr < text_section_addr_beg || addr > text_section_addr_end) {
-		DBG("Address found is outside of the .text section addr=0x%zx, "
-		    ".text section=[0x%jd - 0x%jd].",
+	if (addr < text_section->addr || addr > text_section->addr + text_section->size) {
+		DBG("Address found is outside of the .text section addr=0x%" PRIx64 ", "
+		    ".text section=[0x%" PRIx64 " - 0x%" PRIx64 "].",
 		    addr,
-		    (intmax_t) text_section_addr_beg,
-		    (intmax_t) text_section_addr_end);
-		ret = LTTNG_ERR_ELF_PARSING;
-		goto error;
+		    text_section->addr,
+		    text_section->addr + text_section->size);
+		return LTTNG_ERR_ELF_PARSING;
 	}
 
-	offset_in_section = addr - text_section_addr_beg;
-
 	/*
 	 * Add the target offset in the text section to the offset of this text
 	 * section from the beginning of the binary file.
 	 */
-	*offset = text_section_offset + offset_in_section;
-
-error:
-	return ret;
+	*offset = text_section->offset + (addr - text_section->addr);
+	return 0;
 }
 
 /*
- * Compute the offset of a symbol from the begining of the ELF binary.
+ * Index the function symbols of a binary by name.
  *
- * On success, returns 0 offset parameter is set to the computed value
- * On failure, returns -1.
+ * Returns 0 on success, an LTTng error code on failure.
  */
-int lttng_elf_get_symbol_offset(int fd, char *symbol, uint64_t *offset)
+static int lttng_elf_index_symbols(struct lttng_elf *elf, struct lttng_elf_index *index)
 {
-	int ret = 0;
-	int sym_found = 0;
-	int sym_count = 0;
-	int sym_idx = 0;
-	uint64_t addr = 0;
-	char *curr_sym_str = nullptr;
-	char *symbol_table_data = nullptr;
-	char *string_table_data = nullptr;
-	const char *string_table_name = nullptr;
+	int ret;
+	uint64_t sym_count, sym_idx;
+	const char *symbol_table_data, *string_table_data;
+	const char *string_table_name;
 	struct lttng_elf_shdr symtab_hdr;
 	struct lttng_elf_shdr strtab_hdr;
-	struct lttng_elf *elf = nullptr;
-
-	if (!symbol || !offset) {
-		ret = LTTNG_ERR_ELF_PARSING;
-		goto end;
-	}
-
-	elf = lttng_elf_create(fd);
-	if (!elf) {
-		ret = LTTNG_ERR_ELF_PARSING;
-		goto end;
-	}
 
 	/*
 	 * The .symtab section might not exist on stripped binaries.
@@ -777,8 +740,7 @@ int lttng_elf_get_symbol_offset(int fd, char *symbol, uint64_t *offset)
 			elf, DYNAMIC_SYMBOL_TAB_SECTION_NAME, &symtab_hdr);
 		if (ret) {
 			DBG("Cannot get ELF Symbol Table nor Dynamic Symbol Table sections.");
-			ret = LTTNG_ERR_ELF_PARSING;
-			goto destroy_elf;
+			return LTTNG_ERR_ELF_PARSING;
 		}
 		string_table_name = DYNAMIC_STRING_TAB_SECTION_NAME;
 	} else {
@@ -789,30 +751,27 @@ int lttng_elf_get_symbol_offset(int fd, char *symbol, uint64_t *offset)
 	symbol_table_data = lttng_elf_get_section_data(elf, &symtab_hdr);
 	if (symbol_table_data == nullptr) {
 		DBG("Cannot get ELF Symbol Table data.");
-		ret = LTTNG_ERR_ELF_PARSING;
-		goto destroy_elf;
+		return LTTNG_ERR_ELF_PARSING;
 	}
 
 	/* Get the string table section header. */
 	ret = lttng_elf_get_section_hdr_by_name(elf, string_table_name, &strtab_hdr);
 	if (ret) {
 		DBG("Cannot get ELF string table section.");
-		goto free_symbol_table_data;
+		return ret;
 	}
 
 	/* Get the data associated with the string table section. */
 	string_table_data = lttng_elf_get_section_data(elf, &strtab_hdr);
 	if (string_table_data == nullptr) {
 		DBG("Cannot get ELF string table section data.");
-		ret = LTTNG_ERR_ELF_PARSING;
-		goto free_symbol_table_data;
+		return LTTNG_ERR_ELF_PARSING;
 	}
 
 	/* Get the number of symbol in the table for the iteration. */
 	if (symtab_hdr.sh_entsize == 0) {
 		DBG("Invalid ELF string table entry size.");
-		ret = LTTNG_ERR_ELF_PARSING;
-		goto free_string_table_data;
+		return LTTNG_ERR_ELF_PARSING;
 	}
 
 	sym_count = symtab_hdr.sh_size / symtab_hdr.sh_entsize;
@@ -820,13 +779,25 @@ int lttng_elf_get_symbol_offset(int fd, char *symbol, uint64_t *offset)
 	/* Loop over all symbol. */
 	for (sym_idx = 0; sym_idx < sym_count; sym_idx++) {
 		struct lttng_elf_sym curr_sym;
+		const char *curr_sym_str;
+		size_t curr_sym_str_len;
 
 		/* Get the symbol at the current index. */
 		if (is_elf_32_bit(elf)) {
-			const Elf32_Sym tmp = ((Elf32_Sym *) symbol_table_data)[sym_idx];
+			Elf32_Sym tmp;
+
+			if ((sym_idx + 1) * sizeof(tmp) > symtab_hdr.sh_size) {
+				break;
+			}
+			memcpy(&tmp, symbol_table_data + sym_idx * sizeof(tmp), sizeof(tmp));
 			copy_sym(tmp, curr_sym);
 		} else {
-			const Elf64_Sym tmp = ((Elf64_Sym *) symbol_table_data)[sym_idx];
+			Elf64_Sym tmp;
+
+			if ((sym_idx + 1) * sizeof(tmp) > symtab_hdr.sh_size) {
+				break;
+			}
+			memcpy(&tmp, symbol_table_data + sym_idx * sizeof(tmp), sizeof(tmp));
 			copy_sym(tmp, curr_sym);
 		}
 
@@ -834,16 +805,10 @@ int lttng_elf_get_symbol_offset(int fd, char *symbol, uint64_t *offset)
 		 * If the st_name field is zero, there is no string name for
 		 * this symbol; skip to the next symbol.
 		 */
-		if (curr_sym.st_name == 0) {
+		if (curr_sym.st_name == 0 || curr_sym.st_name >= strtab_hdr.sh_size) {
 			continue;
 		}
 
-		/*
-		 * Use the st_name field in the lttng_elf_sym struct to get offset of
-		 * the symbol's name from the beginning of the string table.
-		 */
-		curr_sym_str = string_table_data + curr_sym.st_name;
-
 		/*
 		 * If the current symbol is not a function; skip to the next symbol.
 		 */
@@ -853,128 +818,105 @@ int lttng_elf_get_symbol_offset(int fd, char *symbol, uint64_t *offset)
 		}
 
 		/*
-		 * Compare with the search symbol. If there is a match set the address
-		 * output parameter and return success.
+		 * Use the st_name field in the lttng_elf_sym struct to get offset of
+		 * the symbol's name from the beginning of the string table.
 		 */
-		if (strcmp(symbol, curr_sym_str) == 0) {
-			sym_found = 1;
-			addr = curr_sym.st_value;
-			break;
+		curr_sym_str = string_table_data + curr_sym.st_name;
+		curr_sym_str_len = strnlen(curr_sym_str, strtab_hdr.sh_size - curr_sym.st_name);
+		if (curr_sym_str_len == strtab_hdr.sh_size - curr_sym.st_name) {
+			DBG("Unterminated ELF symbol name");
+			continue;
 		}
-	}
 
-	if (!sym_found) {
-		DBG("Symbol not found.");
-		ret = LTTNG_ERR_ELF_PARSING;
-		goto free_string_table_data;
+		/* Keep the first symbol of a given name, as a linear search would. */
+		index->function_addresses.emplace(std::string(curr_sym_str, curr_sym_str_len),
+						  curr_sym.st_value);
 	}
 
-	/*
-	 * Use the virtual address of the symbol to compute the offset of this
-	 * symbol from the beginning of the executable file.
-	 */
-	ret = lttng_elf_convert_addr_in_text_to_offset(elf, addr, offset);
-	if (ret) {
-		DBG("Cannot convert addr to offset.");
-		goto free_string_table_data;
-	}
+	return 0;
+}
 
-free_string_table_data:
-	free(string_table_data);
-free_symbol_table_data:
-	free(symbol_table_data);
-destroy_elf:
-	lttng_elf_destroy(elf);
-end:
-	return ret;
+static std::string lttng_elf_sdt_probe_key(const char *provider_name, const char *probe_name)
+{
+	std::string key(provider_name);
+
+	key.push_back('\0');
+	key.append(probe_name);
+	return key;
 }
 
 /*
- * Compute the offsets of SDT probes from the begining of the ELF binary.
+ * Index the SDT probes of a binary by provider and probe name.
  *
- * On success, returns 0 and the nb_probes parameter is set to the number of
- * offsets found and the offsets parameter points to an array of offsets where
- * the SDT probes are.
- * On failure, returns -1.
+ * Returns 0 on success, an LTTng error code on failure.
  */
-int lttng_elf_get_sdt_probe_offsets(int fd,
-				    const char *provider_name,
-				    const char *probe_name,
-				    uint64_t **offsets,
-				    uint32_t *nb_probes)
+static int lttng_elf_index_sdt_probes(struct lttng_elf *elf, struct lttng_elf_index *index)
 {
-	int ret = 0, nb_match = 0;
+	int ret;
 	struct lttng_elf_shdr stap_note_section_hdr;
-	struct lttng_elf *elf = nullptr;
-	char *stap_note_section_data = nullptr;
-	char *curr_note_section_begin, *curr_data_ptr, *curr_probe, *curr_provider;
-	char *next_note_ptr;
-	uint32_t name_size, desc_size, note_type;
-	uint64_t curr_probe_location, curr_probe_offset, curr_semaphore_location;
-	uint64_t *probe_locs = nullptr, *new_probe_locs = nullptr;
-
-	if (!provider_name || !probe_name || !nb_probes || !offsets) {
-		DBG("Invalid arguments.");
-		ret = LTTNG_ERR_ELF_PARSING;
-		goto error;
-	}
-
-	elf = lttng_elf_create(fd);
-	if (!elf) {
-		DBG("Error allocation ELF.");
-		ret = LTTNG_ERR_ELF_PARSING;
-		goto error;
-	}
+	const char *stap_note_section_data;
+	const char *curr_data_ptr, *next_note_ptr, *note_section_end;
 
 	/* Get the stap note section header. */
 	ret = lttng_elf_get_section_hdr_by_name(
 		elf, NOTE_STAPSDT_SECTION_NAME, &stap_note_section_hdr);
 	if (ret) {
 		DBG("Cannot get ELF stap note section.");
-		goto destroy_elf_error;
+		index->has_sdt_probe_section = false;
+		return 0;
 	}
 
 	/* Get the data associated with the stap note section. */
 	stap_note_section_data = lttng_elf_get_section_data(elf, &stap_note_section_hdr);
 	if (stap_note_section_data == nullptr) {
 		DBG("Cannot get ELF stap note section data.");
-		ret = LTTNG_ERR_ELF_PARSING;
-		goto destroy_elf_error;
+		return LTTNG_ERR_ELF_PARSING;
 	}
 
+	index->has_sdt_probe_section = true;
 	next_note_ptr = stap_note_section_data;
-	curr_note_section_begin = stap_note_section_data;
+	note_section_end = stap_note_section_data + stap_note_section_hdr.sh_size;
+
+	/* Check if we have reached the end of the note section. */
+	while (next_note_ptr < note_section_end) {
+		uint32_t name_size, desc_size, note_type;
+		struct lttng_elf_sdt_probe probe;
+		const char *curr_provider, *curr_probe, *desc_end;
+		size_t curr_provider_len, curr_probe_len;
 
-	*offsets = nullptr;
-	while (true) {
 		curr_data_ptr = next_note_ptr;
-		/* Check if we have reached the end of the note section. */
-		if (curr_data_ptr >= curr_note_section_begin + stap_note_section_hdr.sh_size) {
-			*nb_probes = nb_match;
-			*offsets = probe_locs;
-			ret = 0;
-			break;
+		if ((size_t) (note_section_end - curr_data_ptr) < 3 * sizeof(uint32_t)) {
+			DBG("Truncated note in SDT probe descriptions section.");
+			return LTTNG_ERR_ELF_PARSING;
 		}
+
 		/* Get name size field. */
-		name_size = next_4bytes_boundary(*(uint32_t *) curr_data_ptr);
+		memcpy(&name_size, curr_data_ptr, sizeof(name_size));
+		name_size = next_4bytes_boundary(name_size);
 		curr_data_ptr += sizeof(uint32_t);
 
 		/* Sanity check; a zero name_size is reserved. */
 		if (name_size == 0) {
 			DBG("Invalid name size field in SDT probe descriptions"
 			    "section.");
-			ret = -1;
-			goto realloc_error;
+			return LTTNG_ERR_ELF_PARSING;
 		}
 
 		/* Get description size field. */
-		desc_size = next_4bytes_boundary(*(uint32_t *) curr_data_ptr);
+		memcpy(&desc_size, curr_data_ptr, sizeof(desc_size));
+		desc_size = next_4bytes_boundary(desc_size);
 		curr_data_ptr += sizeof(uint32_t);
 
 		/* Get type field. */
-		note_type = *(uint32_t *) curr_data_ptr;
+		memcpy(&note_type, curr_data_ptr, sizeof(note_type));
 		curr_data_ptr += sizeof(uint32_t);
 
+		if ((uint64_t) (note_section_end - curr_data_ptr) <
+		    (uint64_t) name_size + desc_size) {
+			DBG("Truncated note in SDT probe descriptions section.");
+			return LTTNG_ERR_ELF_PARSING;
+		}
+
 		/*
 		 * Move the pointer to the next note to be ready for the next
 		 * iteration. The current note is made of 3 unsigned 32bit
@@ -982,7 +924,7 @@ int lttng_elf_get_sdt_probe_offsets(int fd,
 		 * name and the descriptor. To move to the next note, we move
 		 * the pointer according to those values.
 		 */
-		next_note_ptr = next_note_ptr + (3 * sizeof(uint32_t)) + desc_size + name_size;
+		next_note_ptr = curr_data_ptr + name_size + desc_size;
 
 		/*
 		 * Move ptr to the end of the name string (we don't need it)
@@ -994,77 +936,267 @@ int lttng_elf_get_sdt_probe_offsets(int fd,
 		}
 
 		curr_data_ptr += name_size;
+		desc_end = curr_data_ptr + desc_size;
+		if (desc_size < 3 * sizeof(uint64_t)) {
+			DBG("Truncated SDT probe description.");
+			return LTTNG_ERR_ELF_PARSING;
+		}
 
 		/* Get probe location.  */
-		curr_probe_location = *(uint64_t *) curr_data_ptr;
+		memcpy(&probe.location, curr_data_ptr, sizeof(probe.location));
 		curr_data_ptr += sizeof(uint64_t);
 
 		/* Pass over the base. Not needed. */
 		curr_data_ptr += sizeof(uint64_t);
 
 		/* Get semaphore location. */
-		curr_semaphore_location = *(uint64_t *) curr_data_ptr;
+		memcpy(&probe.semaphore_location, curr_data_ptr, sizeof(probe.semaphore_location));
 		curr_data_ptr += sizeof(uint64_t);
+
 		/* Get provider name. */
 		curr_provider = curr_data_ptr;
-		curr_data_ptr += strlen(curr_provider) + 1;
+		curr_provider_len = strnlen(curr_provider, (size_t) (desc_end - curr_provider));
+		if (curr_provider_len == (size_t) (desc_end - curr_provider)) {
+			DBG("Unterminated SDT provider name.");
+			return LTTNG_ERR_ELF_PARSING;
+		}
+		curr_data_ptr += curr_provider_len + 1;
 
 		/* Get probe name. */
 		curr_probe = curr_data_ptr;
+		curr_probe_len = strnlen(curr_probe, (size_t) (desc_end - curr_probe));
+		if (curr_probe_len == (size_t) (desc_end - curr_probe)) {
+			DBG("Unterminated SDT probe name.");
+			return LTTNG_ERR_ELF_PARSING;
+		}
 
-		/* Check if the provider and probe name match */
-		if (strcmp(provider_name, curr_provider) == 0 &&
-		    strcmp(probe_name, curr_probe) == 0) {
-			int new_size;
-
-			/*
-			 * We currently don't support SDT probes with semaphores. Return
-			 * success as we found a matching probe but it's guarded by a
-			 * semaphore.
-			 */
-			if (curr_semaphore_location != 0) {
-				ret = LTTNG_ERR_SDT_PROBE_SEMAPHORE;
-				goto realloc_error;
-			}
+		index->sdt_probes[lttng_elf_sdt_probe_key(curr_provider, curr_probe)].emplace_back(
+			probe);
+	}
+
+	return 0;
+}
+
+/*
+ * Get the index of the binary referred to by `fd`, building the part of it
+ * which is needed on its first use.
+ *
+ * Must be called with the cache's lock held. Returns 0 on success, an LTTng
+ * error code on failure.
+ */
+static int lttng_elf_get_index(int fd,
+			       bool need_symbols,
+			       bool need_sdt_probes,
+			       struct lttng_elf_index **out_index)
+{
+	int ret = 0;
+	struct stat stat_buf;
+	struct lttng_elf_index *index;
+	struct lttng_elf *elf = nullptr;
+
+	if (fd < 0) {
+		return LTTNG_ERR_ELF_PARSING;
+	}
+
+	ret = fstat(fd, &stat_buf);
+	if (ret) {
+		PERROR("Failed to determine size of elf file");
+		return LTTNG_ERR_ELF_PARSING;
+	}
+	if (!S_ISREG(stat_buf.st_mode)) {
+		ERR("Refusing to initialize lttng_elf from non-regular file");
+		return LTTNG_ERR_ELF_PARSING;
+	}
+
+	try {
+		index = the_elf_index_cache.get(stat_buf);
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to allocate ELF index");
+		return LTTNG_ERR_NOMEM;
+	}
+
+	if ((!need_symbols || index->symbols_indexed) &&
+	    (!need_sdt_probes || index->sdt_probes_indexed)) {
+		goto end;
+	}
+
+	elf = lttng_elf_create(fd, stat_buf);
+	if (!elf) {
+		ret = LTTNG_ERR_ELF_PARSING;
+		goto end;
+	}
 
-			new_size = (++nb_match) * sizeof(uint64_t);
-
-			/*
-			 * Found a match with not semaphore, we need to copy the
-			 * probe_location to the output parameter.
-			 */
-			new_probe_locs = (uint64_t *) realloc(probe_locs, new_size);
-			if (!new_probe_locs) {
-				/* Error allocating a larger buffer */
-				DBG("Allocation error in SDT.");
-				ret = LTTNG_ERR_NOMEM;
-				goto realloc_error;
+	if (!index->symbols_indexed && !index->sdt_probes_indexed) {
+		lttng_elf_index_text_section(elf, index);
+	}
+
+	try {
+		if (need_symbols && !index->symbols_indexed) {
+			ret = lttng_elf_index_symbols(elf, index);
+			if (ret) {
+				index->function_addresses.clear();
+				goto end;
 			}
-			probe_locs = new_probe_locs;
-			new_probe_locs = nullptr;
-
-			/*
-			 * Use the virtual address of the probe to compute the offset of
-			 * this probe from the beginning of the executable file.
-			 */
-			ret = lttng_elf_convert_addr_in_text_to_offset(
-				elf, curr_probe_location, &curr_probe_offset);
+
+			index->symbols_indexed = true;
+		}
+
+		if (need_sdt_probes && !index->sdt_probes_indexed) {
+			ret = lttng_elf_index_sdt_probes(elf, index);
 			if (ret) {
-				DBG("Conversion error in SDT.");
-				goto realloc_error;
+				index->sdt_probes.clear();
+				goto end;
 			}
 
-			probe_locs[nb_match - 1] = curr_probe_offset;
+			index->sdt_probes_indexed = true;
 		}
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to allocate ELF index");
+		index->function_addresses.clear();
+		index->symbols_indexed = false;
+		index->sdt_probes.clear();
+		index->sdt_probes_indexed = false;
+		ret = LTTNG_ERR_NOMEM;
 	}
 
 end:
-	free(stap_note_section_data);
-destroy_elf_error:
 	lttng_elf_destroy(elf);
-error:
+	*out_index = index;
 	return ret;
-realloc_error:
+}
+
+/*
+ * Compute the offset of a symbol from the begining of the ELF binary.
+ *
+ * On success, returns 0 offset parameter is set to the computed value
+ * On failure, returns -1.
+ */
+int lttng_elf_get_symbol_offset(int fd, char *symbol, uint64_t *offset)
+{
+	int ret = 0;
+	struct lttng_elf_index *index;
+
+	if (!symbol || !offset) {
+		return LTTNG_ERR_ELF_PARSING;
+	}
+
+	const std::lock_guard<std::mutex> lock(the_elf_index_cache.lock);
+
+	ret = lttng_elf_get_index(fd, true, false, &index);
+	if (ret) {
+		return ret;
+	}
+
+	const auto it = index->function_addresses.find(symbol);
+	if (it == index->function_addresses.end()) {
+		DBG("Symbol not found.");
+		return LTTNG_ERR_ELF_PARSING;
+	}
+
+	/*
+	 * Use the virtual address of the symbol to compute the offset of this
+	 * symbol from the beginning of the executable file.
+	 */
+	ret = lttng_elf_convert_addr_in_text_to_offset(index, it->second, offset);
+	if (ret) {
+		DBG("Cannot convert addr to offset.");
+		return ret;
+	}
+
+	return 0;
+}
+
+/*
+ * Compute the offsets of SDT probes from the begining of the ELF binary.
+ *
+ * On success, returns 0 and the nb_probes parameter is set to the number of
+ * offsets found and the offsets parameter points to an array of offsets where
+ * the SDT probes are.
+ * On failure, returns -1.
+ */
+int lttng_elf_get_sdt_probe_offsets(int fd,
+				    const char *provider_name,
+				    const char *probe_name,
+				    uint64_t **offsets,
+				    uint32_t *nb_probes)
+{
+	int ret = 0;
+	uint32_t nb_match = 0;
+	uint64_t *probe_locs = nullptr;
+	struct lttng_elf_index *index;
+
+	if (!provider_name || !probe_name || !nb_probes || !offsets) {
+		DBG("Invalid arguments.");
+		return LTTNG_ERR_ELF_PARSING;
+	}
+
+	const std::lock_guard<std::mutex> lock(the_elf_index_cache.lock);
+
+	ret = lttng_elf_get_index(fd, false, true, &index);
+	if (ret) {
+		return ret;
+	}
+
+	if (!index->has_sdt_probe_section) {
+		DBG("Cannot get ELF stap note section.");
+		return LTTNG_ERR_ELF_PARSING;
+	}
+
+	*offsets = nullptr;
+
+	std::vector<lttng_elf_sdt_probe> *probes = nullptr;
+	try {
+		const auto it =
+			index->sdt_probes.find(lttng_elf_sdt_probe_key(provider_name, probe_name));
+
+		if (it != index->sdt_probes.end()) {
+			probes = &it->second;
+		}
+	} catch (const std::bad_alloc&) {
+		return LTTNG_ERR_NOMEM;
+	}
+
+	if (!probes) {
+		*nb_probes = 0;
+		return 0;
+	}
+
+	probe_locs = calloc<uint64_t>(probes->size());
+	if (!probe_locs) {
+		DBG("Allocation error in SDT.");
+		return LTTNG_ERR_NOMEM;
+	}
+
+	for (const auto& probe : *probes) {
+		/*
+		 * We currently don't support SDT probes with semaphores. Return
+		 * success as we found a matching probe but it's guarded by a
+		 * semaphore.
+		 */
+		if (probe.semaphore_location != 0) {
+			ret = LTTNG_ERR_SDT_PROBE_SEMAPHORE;
+			goto error;
+		}
+
+		/*
+		 * Use the virtual address of the probe to compute the offset of
+		 * this probe from the beginning of the executable file.
+		 */
+		ret = lttng_elf_convert_addr_in_text_to_offset(
+			index, probe.location, &probe_locs[nb_match]);
+		if (ret) {
+			DBG("Conversion error in SDT.");
+			goto error;
+		}
+
+		nb_match++;
+	}
+
+	*nb_probes = nb_match;
+	*offsets = probe_locs;
+	return 0;
+
+error:
 	free(probe_locs);
-	goto end;
+	return ret;
 }
@@ -0,0 +1,326 @@
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#include <common/lz4.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef HAVE_LIBLZ4
+#include <climits>
+#include <lz4.h>
+
+std::size_t lttng::lz4::compress_block(const char *src,
+				       std::size_t src_size,
+				       char *dst,
+				       std::size_t dst_capacity) noexcept
+{
+	if (src_size > LZ4_MAX_INPUT_SIZE) {
+		return 0;
+	}
+
+	const int capacity = dst_capacity < static_cast<std::size_t>(INT_MAX) ?
+		static_cast<int>(dst_capacity) :
+		INT_MAX;
+	const int ret = LZ4_compress_default(src, dst, static_cast<int>(src_size), capacity);
+
+	return ret > 0 ? static_cast<std::size_t>(ret) : 0;
+}
+
+bool lttng::lz4::decompress_block(const char *src,
+				  std::size_t src_size,
+				  char *dst,
+				  std::size_t dst_size) noexcept
+{
+	if (src_size > static_cast<std::size_t>(INT_MAX) ||
+	    dst_size > static_cast<std::size_t>(INT_MAX)) {
+		return false;
+	}
+
+	const int ret = LZ4_decompress_safe(
+		src, dst, static_cast<int>(src_size), static_cast<int>(dst_size));
+
+	return ret >= 0 && static_cast<std::size_t>(ret) == dst_size;
+}
+#else /* HAVE_LIBLZ4 */
+namespace {
+/* Constraints of the LZ4 block format. */
+constexpr std::size_t min_match_length = 4;
+/* The last five bytes of a block are always literals. */
+constexpr std::size_t last_literals_length = 5;
+/* The last match must start at least twelve bytes before the end of a block. */
+constexpr std::size_t match_start_limit = 12;
+constexpr std::size_t max_offset = 65535;
+constexpr unsigned int length_field_max = 15;
+
+constexpr unsigned int hash_table_bits = 12;
+
+std::uint32_t read_u32(const char *src) noexcept
+{
+	std::uint32_t value;
+
+	memcpy(&value, src, sizeof(value));
+	return value;
+}
+
+unsigned int hash_sequence(std::uint32_t sequence) noexcept
+{
+	return (sequence * UINT32_C(2654435761)) >> (32 - hash_table_bits);
+}
+
+class block_writer {
+public:
+	block_writer(char *dst, std::size_t capacity) noexcept : _dst(dst), _capacity(capacity)
+	{
+	}
+
+	bool write_sequence(const char *literals,
+			    std::size_t literals_length,
+			    std::size_t offset,
+			    std::size_t match_length) noexcept
+	{
+		const bool has_match = match_length != 0;
+		const std::size_t encoded_match_length =
+			has_match ? match_length - min_match_length : 0;
+		auto *token = _reserve(1);
+
+		if (!token) {
+			return false;
+		}
+
+		*token = static_cast<char>(
+			((literals_length < length_field_max ? literals_length : length_field_max)
+			 << 4) |
+			(encoded_match_length < length_field_max ? encoded_match_length :
+								   length_field_max));
+		if (!_write_length(literals_length)) {
+			return false;
+		}
+
+		auto *literals_dst = _reserve(literals_length);
+		if (!literals_dst) {
+			return false;
+		}
+
+		if (literals_length) {
+			memcpy(literals_dst, literals, literals_length);
+		}
+
+		if (!has_match) {
+			return true;
+		}
+
+		auto *offset_dst = _reserve(2);
+		if (!offset_dst) {
+			return false;
+		}
+
+		offset_dst[0] = static_cast<char>(offset & 0xff);
+		offset_dst[1] = static_cast<char>(offset >> 8);
+		return _write_length(encoded_match_length);
+	}
+
+	std::size_t size() const noexcept
+	{
+		return _size;
+	}
+
+private:
+	char *_reserve(std::size_t length) noexcept
+	{
+		if (length > _capacity - _size) {
+			return nullptr;
+		}
+
+		auto *position = _dst + _size;
+
+		_size += length;
+		return position;
+	}
+
+	/* Write the continuation bytes of a length which doesn't fit in its token field. */
+	bool _write_length(std::size_t length) noexcept
+	{
+		if (length < length_field_max) {
+			return true;
+		}
+
+		for (length -= length_field_max; length >= 255; length -= 255) {
+			if (!_write_byte(255)) {
+				return false;
+			}
+		}
+
+		return _write_byte(static_cast<unsigned char>(length));
+	}
+
+	bool _write_byte(unsigned char value) noexcept
+	{
+		auto *byte = _reserve(1);
+
+		if (!byte) {
+			return false;
+		}
+
+		*byte = static_cast<char>(value);
+		return true;
+	}
+
+	char *_dst;
+	std::size_t _capacity;
+	std::size_t _size = 0;
+};
+
+/*
+ * Read the continuation bytes of a length field. Returns false if the block is
+ * truncated or if the length exceeds `max_length`.
+ */
+bool read_length(const char *src,
+		 std::size_t src_size,
+		 std::size_t max_length,
+		 std::size_t& position,
+		 std::size_t& length) noexcept
+{
+	unsigned char byte;
+
+	do {
+		if (position >= src_size) {
+			return false;
+		}
+
+		byte = static_cast<unsigned char>(src[position++]);
+		length += byte;
+		if (length > max_length) {
+			return false;
+		}
+	} while (byte == 255);
+
+	return true;
+}
+} /* namespace */
+
+std::size_t lttng::lz4::compress_block(const char *src,
+				       std::size_t src_size,
+				       char *dst,
+				       std::size_t dst_capacity) noexcept
+{
+	block_writer writer(dst, dst_capacity);
+	std::size_t anchor = 0;
+
+	if (src_size > match_start_limit) {
+		/* Positions of the last sequences seen, indexed by their hash. */
+		std::uint32_t positions[1U << hash_table_bits] = {};
+		const std::size_t match_end_limit = src_size - last_literals_length;
+		std::size_t position = 1;
+
+		while (position < src_size - match_start_limit) {
+			const auto sequence = read_u32(src + position);
+			const auto hash = hash_sequence(sequence);
+			std::size_t candidate = positions[hash];
+
+			positions[hash] = static_cast<std::uint32_t>(position);
+			if (candidate >= position || position - candidate > max_offset ||
+			    read_u32(src + candidate) != sequence) {
+				position++;
+				continue;
+			}
+
+			/* Extend the match backwards over the pending literals. */
+			while (position > anchor && candidate > 0 &&
+			       src[position - 1] == src[candidate - 1]) {
+				position--;
+				candidate--;
+			}
+
+			std::size_t match_length = min_match_length;
+			while (position + match_length < match_end_limit &&
+			       src[position + match_length] == src[candidate + match_length]) {
+				match_length++;
+			}
+
+			if (!writer.write_sequence(src + anchor,
+						   position - anchor,
+						   position - candidate,
+						   match_length)) {
+				return 0;
+			}
+
+			position += match_length;
+			anchor = position;
+		}
+	}
+
+	if (!writer.write_sequence(src + anchor, src_size - anchor, 0, 0)) {
+		return 0;
+	}
+
+	return writer.size();
+}
+
+bool lttng::lz4::decompress_block(const char *src,
+				  std::size_t src_size,
+				  char *dst,
+				  std::size_t dst_size) noexcept
+{
+	std::size_t src_position = 0, dst_position = 0;
+
+	while (true) {
+		if (src_position >= src_size) {
+			return false;
+		}
+
+		const auto token = static_cast<unsigned char>(src[src_position++]);
+		std::size_t literals_length = token >> 4;
+
+		if (literals_length == length_field_max &&
+		    !read_length(src, src_size, dst_size, src_position, literals_length)) {
+			return false;
+		}
+
+		if (literals_length > src_size - src_position ||
+		    literals_length > dst_size - dst_position) {
+			return false;
+		}
+
+		memcpy(dst + dst_position, src + src_position, literals_length);
+		src_position += literals_length;
+		dst_position += literals_length;
+
+		if (src_position == src_size) {
+			/* The last sequence only holds literals. */
+			return dst_position == dst_size;
+		}
+
+		if (src_size - src_position < 2) {
+			return false;
+		}
+
+		const std::size_t offset = static_cast<unsigned char>(src[src_position]) |
+			(static_cast<unsigned char>(src[src_position + 1]) << 8);
+		src_position += 2;
+
+		std::size_t match_length = token & length_field_max;
+		if (match_length == length_field_max &&
+		    !read_length(src, src_size, dst_size, src_position, match_length)) {
+			return false;
+		}
+
+		match_length += min_match_length;
+		if (offset == 0 || offset > dst_position || match_length > dst_size - dst_position) {
+			return false;
+		}
+
+		/* The match may overlap the bytes it produces; copy it byte by byte. */
+		const char *match = dst + dst_position - offset;
+		for (std::size_t i = 0; i < match_length; i++) {
+			dst[dst_position + i] = match[i];
+		}
+
+		dst_position += match_length;
+	}
+}
+#endif /* HAVE_LIBLZ4 */
@@ -0,0 +1,42 @@
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#ifndef LTTNG_LZ4_H
+#define LTTNG_LZ4_H
+
+#include <cstddef>
+
+/*
+ * LZ4 block codec. The system's liblz4 is used when it was found at
+ * configuration time; an internal implementation is used otherwise.
+ */
+
+namespace lttng {
+namespace lz4 {
+
+/*
+ * Compress `src` in the LZ4 block format (no frame header nor checksum).
+ *
+ * Returns the size of the compressed block written to `dst`, or 0 if the
+ * block doesn't fit in `dst_capacity` bytes. Passing a capacity smaller than
+ * the source size hence only produces a block when compression is worthwhile.
+ */
+std::size_t
+compress_block(const char *src, std::size_t src_size, char *dst, std::size_t dst_capacity) noexcept;
+
+/*
+ * Decompress an LZ4 block which must expand to exactly `dst_size` bytes.
+ *
+ * The block is assumed to originate from an untrusted peer: all lengths and
+ * offsets are validated. Returns true on success.
+ */
+bool decompress_block(const char *src, std::size_t src_size, char *dst, std::size_t dst_size) noexcept;
+
+} /* namespace lz4 */
+} /* namespace lttng */
+
+#endif /* LTTNG_LZ4_H */
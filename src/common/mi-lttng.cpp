@@ -761,6 +761,15 @@ end:
 	return ret;
 }
 
+int mi_lttng_writer_flush(struct mi_writer *writer)
+{
+	if (!writer) {
+		return -EINVAL;
+	}
+
+	return config_writer_flush(writer->writer);
+}
+
 int mi_lttng_writer_command_open(struct mi_writer *writer, const char *command)
 {
 	int ret;
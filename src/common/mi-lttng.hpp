@@ -396,6 +396,17 @@ struct mi_writer *mi_lttng_writer_create(int fd_output, int mi_output_type);
  */
 int mi_lttng_writer_destroy(struct mi_writer *writer);
 
+/*
+ * Write the elements buffered by a machine interface writer to its output
+ * so that consumers of a long output can process it as it is produced.
+ *
+ * writer An instance of a machine interface writer.
+ *
+ * Returns zero if the buffered elements could be written. Negative values
+ * indicate an error.
+ */
+int mi_lttng_writer_flush(struct mi_writer *writer);
+
 /*
  * Open a command tag and add it's name node.
  *
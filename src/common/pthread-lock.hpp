@@ -9,7 +9,9 @@
 #define LTTNG_PTHREAD_LOCK_H
 
 #include <common/exception.hpp>
+#include <common/macros.hpp>
 
+#include <errno.h>
 #include <mutex>
 #include <pthread.h>
 
@@ -96,6 +98,188 @@ private:
 	std::lock_guard<details::mutex> _guard;
 };
 
+/*
+ * Reader-writer lock wrapping a pthread rwlock.
+ *
+ * The class satisfies the Mutex named requirements for exclusive ownership and provides the
+ * lock_shared(), try_lock_shared() and unlock_shared() members of the SharedMutex named
+ * requirements, which std::shared_mutex only offers as of C++17.
+ *
+ * Writers are preferred over readers where the C library allows it (glibc): a thread
+ * waiting to acquire the lock exclusively blocks the new shared acquisitions so that a
+ * steady stream of readers can't starve it. As a consequence, a thread that already
+ * owns the lock in shared mode must not acquire it in shared mode again.
+ */
+class rw_mutex {
+public:
+	rw_mutex()
+	{
+#if defined(__GLIBC__)
+		pthread_rwlockattr_t attr;
+		int ret = pthread_rwlockattr_init(&attr);
+
+		if (ret != 0) {
+			LTTNG_THROW_POSIX("Failed to initialize reader-writer lock attributes", ret);
+		}
+
+		ret = pthread_rwlockattr_setkind_np(&attr,
+						    PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+		if (ret == 0) {
+			ret = pthread_rwlock_init(&_rwlock, &attr);
+		}
+
+		(void) pthread_rwlockattr_destroy(&attr);
+		if (ret != 0) {
+			LTTNG_THROW_POSIX("Failed to initialize reader-writer lock", ret);
+		}
+#else
+		const auto ret = pthread_rwlock_init(&_rwlock, nullptr);
+
+		if (ret != 0) {
+			LTTNG_THROW_POSIX("Failed to initialize reader-writer lock", ret);
+		}
+#endif /* __GLIBC__ */
+	}
+
+	~rw_mutex()
+	{
+		(void) pthread_rwlock_destroy(&_rwlock);
+	}
+
+	rw_mutex(const rw_mutex&) = delete;
+	rw_mutex(rw_mutex&&) = delete;
+	rw_mutex& operator=(const rw_mutex&) = delete;
+	rw_mutex& operator=(rw_mutex&&) = delete;
+
+	void lock()
+	{
+		const auto ret = pthread_rwlock_wrlock(&_rwlock);
+
+		if (ret != 0) {
+			LTTNG_THROW_POSIX("Failed to lock reader-writer lock", ret);
+		}
+	}
+
+	bool try_lock()
+	{
+		const auto ret = pthread_rwlock_trywrlock(&_rwlock);
+
+		if (ret == 0) {
+			return true;
+		} else if (ret == EBUSY || ret == EDEADLK) {
+			return false;
+		} else {
+			LTTNG_THROW_POSIX("Failed to try to lock reader-writer lock", ret);
+		}
+	}
+
+	void unlock()
+	{
+		if (pthread_rwlock_unlock(&_rwlock) != 0) {
+			/*
+			 * Unlock cannot throw as it is called as part of unique_lock's destructor.
+			 */
+			abort();
+		}
+	}
+
+	void lock_shared()
+	{
+		const auto ret = pthread_rwlock_rdlock(&_rwlock);
+
+		if (ret != 0) {
+			LTTNG_THROW_POSIX("Failed to lock reader-writer lock in shared mode", ret);
+		}
+	}
+
+	bool try_lock_shared()
+	{
+		const auto ret = pthread_rwlock_tryrdlock(&_rwlock);
+
+		if (ret == 0) {
+			return true;
+		} else if (ret == EBUSY || ret == EAGAIN) {
+			return false;
+		} else {
+			LTTNG_THROW_POSIX("Failed to try to lock reader-writer lock in shared mode",
+					  ret);
+		}
+	}
+
+	void unlock_shared()
+	{
+		unlock();
+	}
+
+private:
+	pthread_rwlock_t _rwlock;
+};
+
+/*
+ * Provides the basic concept of std::shared_lock (C++14) for rw_mutex.
+ *
+ * When it owns `mutex`, the lock is held in shared mode until it is unlocked or
+ * until shared_lock's destruction. Like std::shared_lock, a default-constructed
+ * instance owns no lock and ownership can be transferred by moving.
+ */
+class shared_lock {
+public:
+	shared_lock() noexcept = default;
+	explicit shared_lock(rw_mutex& mutex) : _mutex(&mutex)
+	{
+		_mutex->lock_shared();
+		_owns = true;
+	}
+
+	~shared_lock()
+	{
+		if (_owns) {
+			_mutex->unlock_shared();
+		}
+	}
+
+	shared_lock(const shared_lock&) = delete;
+	shared_lock& operator=(const shared_lock&) = delete;
+
+	shared_lock(shared_lock&& other) noexcept : _mutex(other._mutex), _owns(other._owns)
+	{
+		other._mutex = nullptr;
+		other._owns = false;
+	}
+
+	shared_lock& operator=(shared_lock&& other) noexcept
+	{
+		if (this != &other) {
+			if (_owns) {
+				_mutex->unlock_shared();
+			}
+
+			_mutex = other._mutex;
+			_owns = other._owns;
+			other._mutex = nullptr;
+			other._owns = false;
+		}
+
+		return *this;
+	}
+
+	void unlock()
+	{
+		LTTNG_ASSERT(_owns);
+		_mutex->unlock_shared();
+		_owns = false;
+	}
+
+	bool owns_lock() const noexcept
+	{
+		return _owns;
+	}
+
+private:
+	rw_mutex *_mutex = nullptr;
+	bool _owns = false;
+};
+
 } /* namespace pthread */
 } /* namespace lttng */
 
@@ -17,12 +17,29 @@
 #include <common/string-utils/format.hpp>
 #include <common/trace-chunk.hpp>
 
+#include <algorithm>
 #include <inttypes.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 
+/*
+ * Maximal number of commands sent on a control socket before their replies
+ * are received. Bounding it guarantees that neither peer can block on a full
+ * socket buffer while the other is doing the same.
+ */
+#define RELAYD_MAX_PIPELINED_COMMAND_COUNT 64
+
+#ifdef MSG_MORE
+#define RELAYD_MSG_MORE MSG_MORE
+#else
+#define RELAYD_MSG_MORE 0
+#endif
+
 static bool relayd_supports_chunks(const struct lttcomm_relayd_sock *sock)
 {
 	if (sock->major > 2) {
@@ -78,7 +95,13 @@ static int send_command(lttcomm_relayd_sock& rsock,
 
 	/* Zeroed for now since not used. */
 	header.cmd_version = 0;
-	header.circuit_id = 0;
+
+	/*
+	 * The circuit ID is ignored by the relay daemon; it carries the
+	 * sequence number of the command to correlate pipelined commands
+	 * with their reply when debugging.
+	 */
+	header.circuit_id = htobe64(rsock.next_command_seq_num++);
 
 	/* Prepare buffer to send. */
 	memcpy(buf, &header, sizeof(header));
@@ -86,9 +109,10 @@ static int send_command(lttcomm_relayd_sock& rsock,
 		memcpy(buf + sizeof(header), data, size);
 	}
 
-	DBG3("Relayd sending command %s of size %" PRIu64,
+	DBG3("Relayd sending command %s of size %" PRIu64 " (seq num: %" PRIu64 ")",
 	     lttcomm_relayd_command_str(cmd),
-	     buf_size);
+	     buf_size,
+	     rsock.next_command_seq_num - 1);
 	ret = rsock.sock.ops->sendmsg(&rsock.sock, buf, buf_size, flags);
 	if (ret < 0) {
 		PERROR("Failed to send command %s of size %" PRIu64,
@@ -105,17 +129,12 @@ alloc_error:
 }
 
 /*
- * Receive reply data on socket. This MUST be call after send_command or else
- * could result in unexpected behavior(s).
+ * Receive data on the socket, without regard for the pending replies.
  */
-static int recv_reply(lttcomm_relayd_sock& rsock, void *data, size_t size)
+static int recv_data(lttcomm_relayd_sock& rsock, void *data, size_t size)
 {
 	int ret;
 
-	if (rsock.sock.fd < 0) {
-		return -ECONNRESET;
-	}
-
 	DBG3("Relayd waiting for reply of size %zu", size);
 
 	ret = rsock.sock.ops->recvmsg(&rsock.sock, data, size, 0);
@@ -138,6 +157,79 @@ error:
 	return ret;
 }
 
+/*
+ * Receive the generic replies of the commands that were pipelined without
+ * waiting for their reply.
+ *
+ * The replies to abandoned commands, which precede the others, are
+ * discarded. `pipelined_command_failed` is set if the relay daemon replied
+ * an error to one of the other commands.
+ *
+ * Return 0 if all pending replies were received, else a negative value.
+ */
+static int recv_pending_replies(lttcomm_relayd_sock& rsock, bool& pipelined_command_failed)
+{
+	if (rsock.sock.fd < 0) {
+		return -ECONNRESET;
+	}
+
+	while (rsock.abandoned_reply_count > 0 || rsock.pending_reply_count > 0) {
+		struct lttcomm_relayd_generic_reply reply;
+		const bool is_abandoned = rsock.abandoned_reply_count > 0;
+
+		if (recv_data(rsock, (void *) &reply, sizeof(reply)) < 0) {
+			rsock.abandoned_reply_count = 0;
+			rsock.pending_reply_count = 0;
+			return -1;
+		}
+
+		if (is_abandoned) {
+			rsock.abandoned_reply_count--;
+			continue;
+		}
+
+		rsock.pending_reply_count--;
+		reply.ret_code = be32toh(reply.ret_code);
+		if (reply.ret_code != LTTNG_OK) {
+			ERR("Relayd replied error %d to a pipelined command", reply.ret_code);
+			pipelined_command_failed = true;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Receive reply data on socket. This MUST be call after send_command or else
+ * could result in unexpected behavior(s).
+ *
+ * The replies to previously pipelined commands, which precede the reply
+ * to the last command, are received first. The reply to the last command
+ * is received even if one of them reported an error, to keep the socket
+ * in sync, but the error is returned.
+ */
+static int recv_reply(lttcomm_relayd_sock& rsock, void *data, size_t size)
+{
+	int ret;
+	bool pipelined_command_failed = false;
+
+	if (rsock.sock.fd < 0) {
+		return -ECONNRESET;
+	}
+
+	ret = recv_pending_replies(rsock, pipelined_command_failed);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = recv_data(rsock, data, size);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return pipelined_command_failed ? -1 : ret;
+}
+
 /*
  * Starting from 2.11, RELAYD_CREATE_SESSION payload (session_name,
  * hostname, and base_path) have no length restriction on the sender side.
@@ -765,6 +857,38 @@ error:
 	return ret;
 }
 
+int relayd_send_metadata_fragments(struct lttcomm_relayd_sock *rsock,
+				   lttng::relayd::metadata_fragment_store& store,
+				   uint64_t stream_id,
+				   const struct lttng_buffer_view *packet,
+				   uint32_t padding_size)
+{
+	int ret;
+	struct lttng_dynamic_buffer payload;
+
+	/* Code flow error. Safety net. */
+	LTTNG_ASSERT(rsock);
+	LTTNG_ASSERT(packet);
+
+	lttng_dynamic_buffer_init(&payload);
+	ret = lttng::relayd::encode_metadata_packet(
+		store, stream_id, *packet, padding_size, payload);
+	if (ret) {
+		ERR("Failed to encode metadata packet fragments: stream id = %" PRIu64, stream_id);
+		goto end;
+	}
+
+	DBG("Relayd sending metadata packet of size %zu as %zu bytes of fragments",
+	    packet->size,
+	    payload.size);
+
+	/* The relay daemon doesn't reply to metadata commands. */
+	ret = send_command(*rsock, RELAYD_SEND_METADATA_FRAGMENTS, payload.data, payload.size, 0);
+end:
+	lttng_dynamic_buffer_reset(&payload);
+	return ret;
+}
+
 /*
  * Connect to relay daemon with an allocated lttcomm_relayd_sock.
  */
@@ -785,6 +909,32 @@ int relayd_connect(struct lttcomm_relayd_sock *rsock)
 	return rsock->sock.ops->connect(&rsock->sock);
 }
 
+/*
+ * Tune a control socket for its request-reply traffic.
+ *
+ * Nagle's algorithm is disabled since the commands are small and their sender
+ * waits on their reply; the commands that can be batched are explicitly
+ * coalesced with MSG_MORE.
+ *
+ * Failing to set the options is not fatal as it only affects latency.
+ */
+void relayd_configure_control_socket(struct lttcomm_relayd_sock *rsock)
+{
+	int ret;
+	const int enable = 1;
+
+	LTTNG_ASSERT(rsock);
+
+	if (rsock->sock.proto != LTTCOMM_SOCK_TCP || rsock->sock.fd < 0) {
+		return;
+	}
+
+	ret = setsockopt(rsock->sock.fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+	if (ret < 0) {
+		PERROR("Failed to set TCP_NODELAY on relayd control socket %d", rsock->sock.fd);
+	}
+}
+
 /*
  * Close relayd socket with an allocated lttcomm_relayd_sock.
  *
@@ -1012,6 +1162,126 @@ error:
 	return ret;
 }
 
+/*
+ * Check on the relayd side whether data is pending for a set of streams.
+ *
+ * The data pending and quiescent control commands of up to
+ * RELAYD_MAX_PIPELINED_COMMAND_COUNT streams are sent before their replies
+ * are received, sparing a round-trip per stream.
+ *
+ * Return 0 if NOT pending, 1 if so and a negative value on error.
+ */
+int relayd_streams_data_pending(struct lttcomm_relayd_sock *rsock,
+				const struct relayd_stream_data_pending_query *queries,
+				size_t query_count)
+{
+	int ret = 0;
+	size_t chunk_begin;
+
+	/* Code flow error. Safety net. */
+	LTTNG_ASSERT(rsock);
+
+	DBG("Relayd data pending for %zu streams", query_count);
+
+	for (chunk_begin = 0; chunk_begin < query_count;
+	     chunk_begin += RELAYD_MAX_PIPELINED_COMMAND_COUNT) {
+		const size_t chunk_end =
+			std::min(query_count, chunk_begin + RELAYD_MAX_PIPELINED_COMMAND_COUNT);
+		bool is_pending = false;
+		bool command_failed = false;
+		size_t i;
+
+		/*
+		 * Receive the replies to previously pipelined commands first: the replies
+		 * to the queries of the chunk are then the only ones in flight if sending
+		 * the chunk fails.
+		 */
+		ret = recv_pending_replies(*rsock, command_failed);
+		if (ret < 0) {
+			goto error;
+		}
+
+		for (i = chunk_begin; i < chunk_end; i++) {
+			const auto& query = queries[i];
+			/* Let the kernel coalesce all commands of the chunk. */
+			const int flags = i + 1 < chunk_end ? RELAYD_MSG_MORE : 0;
+
+			if (query.is_metadata) {
+				struct lttcomm_relayd_quiescent_control msg = {};
+
+				msg.stream_id = htobe64(query.relay_stream_id);
+				ret = send_command(
+					*rsock, RELAYD_QUIESCENT_CONTROL, &msg, sizeof(msg), flags);
+			} else {
+				struct lttcomm_relayd_data_pending msg = {};
+
+				msg.stream_id = htobe64(query.relay_stream_id);
+				msg.last_net_seq_num = htobe64(query.last_net_seq_num);
+				ret = send_command(
+					*rsock, RELAYD_DATA_PENDING, &msg, sizeof(msg), flags);
+			}
+
+			if (ret < 0) {
+				/*
+				 * The queries of the chunk that were sent are still
+				 * answered by the relay daemon, possibly once the
+				 * commands held back by RELAYD_MSG_MORE are flushed by
+				 * the next one. Their replies are discarded when the
+				 * next reply is received; the unsent queries are not
+				 * accounted for.
+				 */
+				rsock->abandoned_reply_count += i - chunk_begin;
+				goto error;
+			}
+		}
+
+		/* All replies of the chunk are received to keep the socket in sync. */
+		for (i = chunk_begin; i < chunk_end; i++) {
+			const auto& query = queries[i];
+			struct lttcomm_relayd_generic_reply reply;
+
+			ret = recv_reply(*rsock, (void *) &reply, sizeof(reply));
+			if (ret < 0) {
+				goto error;
+			}
+
+			reply.ret_code = be32toh(reply.ret_code);
+			if (query.is_metadata) {
+				if (reply.ret_code != LTTNG_OK) {
+					ERR("Relayd quiescent control replied error %d",
+					    reply.ret_code);
+					command_failed = true;
+				}
+			} else {
+				if (reply.ret_code >= LTTNG_OK) {
+					ERR("Relayd data pending replied error %d",
+					    reply.ret_code);
+				}
+
+				DBG("Relayd data is %s pending for stream id %" PRIu64,
+				    reply.ret_code == 1 ? "" : "NOT",
+				    query.relay_stream_id);
+				is_pending |= reply.ret_code == 1;
+			}
+		}
+
+		if (command_failed) {
+			ret = -1;
+			goto error;
+		}
+
+		if (is_pending) {
+			ret = 1;
+			goto error;
+		}
+	}
+
+	ret = 0;
+
+error:
+	return ret;
+}
+
 /*
  * Begin a data pending command for a specific session id.
  */
@@ -1106,23 +1376,14 @@ error:
 	return ret;
 }
 
-/*
- * Send index to the relayd.
- */
-int relayd_send_index(lttcomm_relayd_sock& rsock,
-		      const ctf_packet_index& index,
-		      uint64_t relay_stream_id,
-		      uint64_t net_seq_num)
+static int send_index_command(lttcomm_relayd_sock& rsock,
+			      const ctf_packet_index& index,
+			      uint64_t relay_stream_id,
+			      uint64_t net_seq_num,
+			      int flags)
 {
 	int ret;
 	struct lttcomm_relayd_index msg;
-	struct lttcomm_relayd_generic_reply reply;
-
-	if (rsock.minor < 4) {
-		DBG("Not sending indexes before protocol 2.4");
-		ret = 0;
-		goto error;
-	}
 
 	DBG("Relayd sending index for stream ID %" PRIu64, relay_stream_id);
 
@@ -1149,29 +1410,91 @@ int relayd_send_index(lttcomm_relayd_sock& rsock,
 			   &msg,
 			   lttcomm_relayd_index_len(lttng_to_index_major(rsock.major, rsock.minor),
 						    lttng_to_index_minor(rsock.major, rsock.minor)),
-			   0);
+			   flags);
 	if (ret < 0) {
 		goto error;
 	}
 
-	/* Receive response */
-	ret = recv_reply(rsock, (void *) &reply, sizeof(reply));
-	if (ret < 0) {
-		goto error;
+	rsock.pending_reply_count++;
+	if (rsock.pending_reply_count >= RELAYD_MAX_PIPELINED_COMMAND_COUNT) {
+		bool pipelined_command_failed = false;
+
+		/* Receive the responses. */
+		ret = recv_pending_replies(rsock, pipelined_command_failed);
+		if (ret < 0 || pipelined_command_failed) {
+			ERR("Relayd send index replied error");
+			ret = -1;
+			goto error;
+		}
 	}
 
-	reply.ret_code = be32toh(reply.ret_code);
+	ret = 0;
 
-	/* Return session id or negative ret code. */
-	if (reply.ret_code != LTTNG_OK) {
-		ret = -1;
-		ERR("Relayd send index replied error %d", reply.ret_code);
-	} else {
-		/* Success */
-		ret = 0;
+error:
+	return ret;
+}
+
+/*
+ * Send index to the relayd.
+ *
+ * The reply is not waited for: indexes are sent once per packet and the
+ * relay daemon processes the commands of a control socket in order. The
+ * replies are received before that of the next command sent on the socket,
+ * or once RELAYD_MAX_PIPELINED_COMMAND_COUNT commands are awaiting a reply.
+ * Hence, an error replied to an index is reported by a later call.
+ */
+int relayd_send_index(lttcomm_relayd_sock& rsock,
+		      const ctf_packet_index& index,
+		      uint64_t relay_stream_id,
+		      uint64_t net_seq_num)
+{
+	if (rsock.minor < 4) {
+		DBG("Not sending indexes before protocol 2.4");
+		return 0;
 	}
 
-error:
+	return send_index_command(rsock, index, relay_stream_id, net_seq_num, 0);
+}
+
+/*
+ * Send a batch of indexes to the relayd.
+ *
+ * The index commands are coalesced by the kernel in as few segments as
+ * possible. As with relayd_send_index(), the replies are not waited for.
+ */
+int relayd_send_indexes(lttcomm_relayd_sock& rsock,
+			const struct relayd_index_entry *entries,
+			size_t entry_count)
+{
+	int ret = 0;
+	size_t i;
+
+	if (rsock.minor < 4) {
+		DBG("Not sending indexes before protocol 2.4");
+		goto end;
+	}
+
+	DBG("Relayd sending %zu indexes", entry_count);
+
+	for (i = 0; i < entry_count; i++) {
+		/*
+		 * The last command of the batch and the commands that are followed by
+		 * the reception of the pending replies must not be held back.
+		 */
+		const bool is_last_command = i + 1 == entry_count ||
+			rsock.pending_reply_count + 1 >= RELAYD_MAX_PIPELINED_COMMAND_COUNT;
+
+		ret = send_index_command(rsock,
+					 entries[i].index,
+					 entries[i].relay_stream_id,
+					 entries[i].net_seq_num,
+					 is_last_command ? 0 : RELAYD_MSG_MORE);
+		if (ret < 0) {
+			goto end;
+		}
+	}
+
+end:
 	return ret;
 }
 
@@ -9,6 +9,8 @@
 #define _RELAYD_H
 
 #include <common/dynamic-array.hpp>
+#include <common/buffer-view.hpp>
+#include <common/sessiond-comm/relayd-metadata-fragments.hpp>
 #include <common/sessiond-comm/relayd.hpp>
 #include <common/sessiond-comm/sessiond-comm.hpp>
 #include <common/trace-chunk.hpp>
@@ -27,8 +29,24 @@ struct relayd_stream_rotation_position {
 	uint64_t rotate_at_seq_num;
 };
 
+struct relayd_stream_data_pending_query {
+	uint64_t relay_stream_id;
+	/* Ignored for metadata streams. */
+	uint64_t last_net_seq_num;
+	/* Metadata streams are checked for a quiescent control socket. */
+	bool is_metadata;
+};
+
+struct relayd_index_entry {
+	/* Already in big endian. */
+	struct ctf_packet_index index;
+	uint64_t relay_stream_id;
+	uint64_t net_seq_num;
+};
+
 int relayd_connect(struct lttcomm_relayd_sock *sock);
 int relayd_close(struct lttcomm_relayd_sock *sock);
+void relayd_configure_control_socket(struct lttcomm_relayd_sock *sock);
 int relayd_create_session(struct lttcomm_relayd_sock *rsock,
 			  uint64_t *relayd_session_id,
 			  const char *session_name,
@@ -57,6 +75,15 @@ int relayd_send_close_stream(struct lttcomm_relayd_sock *sock,
 int relayd_version_check(struct lttcomm_relayd_sock *sock);
 int relayd_start_data(struct lttcomm_relayd_sock *sock);
 int relayd_send_metadata(struct lttcomm_relayd_sock *sock, size_t len);
+/*
+ * Send a complete metadata packet as fragments. Only supported by relay
+ * daemons advertising LTTCOMM_RELAYD_CONFIGURATION_FLAG_METADATA_FRAGMENTS.
+ */
+int relayd_send_metadata_fragments(struct lttcomm_relayd_sock *sock,
+				   lttng::relayd::metadata_fragment_store& store,
+				   uint64_t stream_id,
+				   const struct lttng_buffer_view *packet,
+				   uint32_t padding_size);
 int relayd_send_data_hdr(struct lttcomm_relayd_sock *sock,
 			 struct lttcomm_relayd_data_hdr *hdr,
 			 size_t size);
@@ -64,6 +91,10 @@ int relayd_data_pending(struct lttcomm_relayd_sock *sock,
 			uint64_t stream_id,
 			uint64_t last_net_seq_num);
 int relayd_quiescent_control(struct lttcomm_relayd_sock *sock, uint64_t metadata_stream_id);
+/* `queries` is an array of `query_count` relayd_stream_data_pending_query. */
+int relayd_streams_data_pending(struct lttcomm_relayd_sock *sock,
+				const struct relayd_stream_data_pending_query *queries,
+				size_t query_count);
 int relayd_begin_data_pending(struct lttcomm_relayd_sock *sock, uint64_t id);
 int relayd_end_data_pending(struct lttcomm_relayd_sock *sock,
 			    uint64_t id,
@@ -72,6 +103,10 @@ int relayd_send_index(lttcomm_relayd_sock& rsock,
 		      const ctf_packet_index& index,
 		      uint64_t relay_stream_id,
 		      uint64_t net_seq_num);
+/* `entries` is an array of `entry_count` relayd_index_entry. */
+int relayd_send_indexes(lttcomm_relayd_sock& rsock,
+			const struct relayd_index_entry *entries,
+			size_t entry_count);
 int relayd_reset_metadata(struct lttcomm_relayd_sock *rsock, uint64_t stream_id, uint64_t version);
 /* `positions` is an array of `stream_count` relayd_stream_rotation_position. */
 int relayd_rotate_streams(struct lttcomm_relayd_sock *sock,
@@ -29,6 +29,8 @@
 #include <fcntl.h>
 #include <grp.h>
 #include <limits.h>
+#include <list>
+#include <mutex>
 #include <pwd.h>
 #include <sched.h>
 #include <signal.h>
@@ -39,9 +41,24 @@
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #define GETPW_BUFFER_FALLBACK_SIZE 4096
 
+/* Upper bound of the run-as worker pool size. */
+#define RUN_AS_MAX_WORKER_COUNT 64
+
+/*
+ * Maximal number of files opened by a single batched open command. The
+ * resulting file descriptors are passed back in a single message.
+ */
+#define RUN_AS_OPEN_BATCH_MAX_FILE_COUNT (LTTCOMM_MAX_SEND_FDS < 64 ? LTTCOMM_MAX_SEND_FDS : 64)
+
+/* Number of compiled filter expressions kept by the filter bytecode cache. */
+#define RUN_AS_FILTER_BYTECODE_CACHE_SIZE 256
+
 enum run_as_cmd {
 	RUN_AS_MKDIR,
 	RUN_AS_MKDIRAT,
@@ -60,6 +77,8 @@ enum run_as_cmd {
 	RUN_AS_EXTRACT_ELF_SYMBOL_OFFSET,
 	RUN_AS_EXTRACT_SDT_PROBE_OFFSETS,
 	RUN_AS_GENERATE_FILTER_BYTECODE,
+	RUN_AS_OPEN_BATCH,
+	RUN_AS_OPENAT_BATCH,
 };
 
 namespace {
@@ -80,6 +99,22 @@ struct run_as_open_data {
 	mode_t mode;
 } LTTNG_PACKED;
 
+/*
+ * The names of the files to open are packed as `file_count` consecutive
+ * NUL-terminated strings in `file_names`. They are relative to `directory`,
+ * which is itself relative to `dirfd`. An empty `directory` means the files
+ * are opened directly relative to `dirfd`.
+ */
+struct run_as_open_batch_data {
+	int dirfd;
+	char directory[LTTNG_PATH_MAX];
+	mode_t directory_mode;
+	int flags;
+	mode_t mode;
+	uint32_t file_count;
+	char file_names[LTTNG_PATH_MAX];
+} LTTNG_PACKED;
+
 struct run_as_unlink_data {
 	int dirfd;
 	char path[LTTNG_PATH_MAX];
@@ -120,6 +155,11 @@ struct run_as_open_ret {
 	int fd;
 } LTTNG_PACKED;
 
+struct run_as_open_batch_ret {
+	uint32_t fd_count;
+	int fds[RUN_AS_OPEN_BATCH_MAX_FILE_COUNT];
+} LTTNG_PACKED;
+
 struct run_as_extract_elf_symbol_offset_ret {
 	uint64_t offset;
 } LTTNG_PACKED;
@@ -139,6 +179,7 @@ struct run_as_data {
 	union {
 		struct run_as_mkdir_data mkdir;
 		struct run_as_open_data open;
+		struct run_as_open_batch_data open_batch;
 		struct run_as_unlink_data unlink;
 		struct run_as_rmdir_data rmdir;
 		struct run_as_rename_data rename;
@@ -169,6 +210,7 @@ struct run_as_ret {
 	union {
 		int ret;
 		struct run_as_open_ret open;
+		struct run_as_open_batch_ret open_batch;
 		struct run_as_extract_elf_symbol_offset_ret extract_elf_symbol_offset;
 		struct run_as_extract_sdt_probe_offsets_ret extract_sdt_probe_offsets;
 		struct run_as_generate_filter_bytecode_ret generate_filter_bytecode;
@@ -330,6 +372,24 @@ const struct run_as_command_properties command_properties[] = {
 		.out_fd_count = 0,
 		.use_cwd_fd = false,
 	},
+	/*
+	 * The out_fd_count of batched open commands is an upper bound; the
+	 * actual count is carried by the reply (see command_out_fd_count()).
+	 */
+	{
+		.in_fds_offset = offsetof(struct run_as_data, u.open_batch.dirfd),
+		.out_fds_offset = offsetof(struct run_as_ret, u.open_batch.fds),
+		.in_fd_count = 1,
+		.out_fd_count = RUN_AS_OPEN_BATCH_MAX_FILE_COUNT,
+		.use_cwd_fd = true,
+	},
+	{
+		.in_fds_offset = offsetof(struct run_as_data, u.open_batch.dirfd),
+		.out_fds_offset = offsetof(struct run_as_ret, u.open_batch.fds),
+		.in_fd_count = 1,
+		.out_fd_count = RUN_AS_OPEN_BATCH_MAX_FILE_COUNT,
+		.use_cwd_fd = false,
+	},
 };
 
 struct run_as_worker_data {
@@ -338,9 +398,30 @@ struct run_as_worker_data {
 	char *procname;
 };
 
-/* Single global worker per process (for now). */
-run_as_worker_data *global_worker;
-/* Lock protecting the worker. */
+/*
+ * A worker of the pool along with the lock serializing the commands it
+ * executes. `worker` is NULL if the worker could not be (re)started.
+ */
+struct run_as_worker_slot {
+	pthread_mutex_t lock;
+	run_as_worker_data *worker;
+};
+
+/*
+ * Pool of run-as workers. Commands are sharded across the workers according
+ * to their target uid/gid so that unrelated users don't contend on the same
+ * worker. Since every worker can assume any identity, a command spills over
+ * to an idle worker when the one of its shard is busy.
+ */
+run_as_worker_slot worker_pool[RUN_AS_MAX_WORKER_COUNT];
+unsigned int worker_count;
+/* Name of the process, used to (re)start workers. */
+char *worker_procname;
+/*
+ * Lock protecting the creation and destruction of the pool. It also
+ * serializes the commands executed in-process when no worker is used since
+ * they alter the process' umask.
+ */
 pthread_mutex_t worker_lock = PTHREAD_MUTEX_INITIALIZER;
 } /* namespace */
 
@@ -445,6 +526,97 @@ end:
 	return ret_value->u.ret;
 }
 
+static int _open_batch(struct run_as_data *data, struct run_as_ret *ret_value)
+{
+	int ret = 0;
+	uint32_t i;
+	const char *file_name = data->u.open_batch.file_names;
+	const char *const file_names_end =
+		data->u.open_batch.file_names + sizeof(data->u.open_batch.file_names);
+	struct lttng_directory_handle *handle, *directory_handle = nullptr;
+
+	ret_value->u.open_batch.fd_count = 0;
+
+	if (data->u.open_batch.file_count > RUN_AS_OPEN_BATCH_MAX_FILE_COUNT) {
+		ret_value->_errno = EINVAL;
+		ret_value->_error = true;
+		return -1;
+	}
+
+	handle = lttng_directory_handle_create_from_dirfd(data->u.open_batch.dirfd);
+	if (!handle) {
+		ret_value->_errno = errno;
+		ret_value->_error = true;
+		return -1;
+	}
+
+	/* Ownership of dirfd is transferred to the handle. */
+	data->u.open_batch.dirfd = -1;
+
+	if (data->u.open_batch.directory[0] != '\0') {
+		/* Safe to call as we have transitioned to the requested uid/gid. */
+		ret = lttng_directory_handle_create_subdirectory_recursive(
+			handle, data->u.open_batch.directory, data->u.open_batch.directory_mode);
+		if (ret) {
+			goto error;
+		}
+
+		directory_handle = lttng_directory_handle_create_from_handle(
+			data->u.open_batch.directory, handle);
+		if (!directory_handle) {
+			goto error;
+		}
+	} else {
+		const bool got_reference = lttng_directory_handle_get(handle);
+
+		LTTNG_ASSERT(got_reference);
+		directory_handle = handle;
+	}
+
+	for (i = 0; i < data->u.open_batch.file_count; i++) {
+		int fd;
+		const size_t file_name_len = lttng_strnlen(file_name, file_names_end - file_name);
+
+		if (file_name + file_name_len == file_names_end) {
+			/* Unterminated file name. */
+			errno = EINVAL;
+			goto error;
+		}
+
+		fd = lttng_directory_handle_open_file(directory_handle,
+						      file_name,
+						      data->u.open_batch.flags,
+						      data->u.open_batch.mode);
+		if (fd < 0) {
+			goto error;
+		}
+
+		ret_value->u.open_batch.fds[ret_value->u.open_batch.fd_count++] = fd;
+		file_name += file_name_len + 1;
+	}
+
+	ret_value->_errno = 0;
+	ret_value->_error = false;
+end:
+	lttng_directory_handle_put(directory_handle);
+	lttng_directory_handle_put(handle);
+	return ret;
+
+error:
+	/* Either all files are opened or none are. */
+	ret_value->_errno = errno;
+	ret_value->_error = true;
+	for (i = 0; i < ret_value->u.open_batch.fd_count; i++) {
+		if (close(ret_value->u.open_batch.fds[i])) {
+			PERROR("Failed to close file descriptor opened by batched open command");
+		}
+	}
+
+	ret_value->u.open_batch.fd_count = 0;
+	ret = -1;
+	goto end;
+}
+
 static int _unlink(struct run_as_data *data, struct run_as_ret *ret_value)
 {
 	struct lttng_directory_handle *handle;
@@ -693,12 +865,31 @@ static run_as_fct run_as_enum_to_fct(enum run_as_cmd cmd)
 		return _extract_sdt_probe_offsets;
 	case RUN_AS_GENERATE_FILTER_BYTECODE:
 		return _generate_filter_bytecode;
+	case RUN_AS_OPEN_BATCH:
+	case RUN_AS_OPENAT_BATCH:
+		return _open_batch;
 	default:
 		ERR("Unknown command %d", (int) cmd);
 		return nullptr;
 	}
 }
 
+/*
+ * Batched commands return a variable number of file descriptors; the fixed
+ * count of the command's properties is only an upper bound.
+ */
+static unsigned int command_out_fd_count(enum run_as_cmd cmd, const struct run_as_ret *run_as_ret)
+{
+	switch (cmd) {
+	case RUN_AS_OPEN_BATCH:
+	case RUN_AS_OPENAT_BATCH:
+		LTTNG_ASSERT(run_as_ret->u.open_batch.fd_count <= COMMAND_OUT_FD_COUNT(cmd));
+		return run_as_ret->u.open_batch.fd_count;
+	default:
+		return COMMAND_OUT_FD_COUNT(cmd);
+	}
+}
+
 static int do_send_fds(int sock, const int *fds, unsigned int fd_count)
 {
 	ssize_t len;
@@ -775,19 +966,19 @@ send_fds_to_master(run_as_worker_data *worker, enum run_as_cmd cmd, struct run_a
 {
 	int ret = 0;
 	unsigned int i;
+	const unsigned int fd_count = command_out_fd_count(cmd, run_as_ret);
 
-	if (COMMAND_OUT_FD_COUNT(cmd) == 0) {
+	if (fd_count == 0) {
 		goto end;
 	}
 
-	ret = do_send_fds(
-		worker->sockpair[1], COMMAND_OUT_FDS(cmd, run_as_ret), COMMAND_OUT_FD_COUNT(cmd));
+	ret = do_send_fds(worker->sockpair[1], COMMAND_OUT_FDS(cmd, run_as_ret), fd_count);
 	if (ret < 0) {
 		PERROR("Failed to send file descriptor to master process");
 		goto end;
 	}
 
-	for (i = 0; i < COMMAND_OUT_FD_COUNT(cmd); i++) {
+	for (i = 0; i < fd_count; i++) {
 		const int fd = COMMAND_OUT_FDS(cmd, run_as_ret)[i];
 		if (fd >= 0) {
 			const int ret_close = close(fd);
@@ -806,13 +997,13 @@ static int recv_fds_from_worker(const run_as_worker_data *worker,
 				struct run_as_ret *run_as_ret)
 {
 	int ret = 0;
+	const unsigned int fd_count = command_out_fd_count(cmd, run_as_ret);
 
-	if (COMMAND_OUT_FD_COUNT(cmd) == 0) {
+	if (fd_count == 0) {
 		goto end;
 	}
 
-	ret = do_recv_fds(
-		worker->sockpair[0], COMMAND_OUT_FDS(cmd, run_as_ret), COMMAND_OUT_FD_COUNT(cmd));
+	ret = do_recv_fds(worker->sockpair[0], COMMAND_OUT_FDS(cmd, run_as_ret), fd_count);
 	if (ret < 0) {
 		PERROR("Failed to receive file descriptor from run-as worker");
 		ret = -1;
@@ -1387,7 +1578,8 @@ end:
 
 static int run_as_create_worker_no_lock(const char *procname,
 					post_fork_cleanup_cb clean_up_func,
-					void *clean_up_user_data)
+					void *clean_up_user_data,
+					run_as_worker_data **created_worker)
 {
 	pid_t pid;
 	int i, ret = 0;
@@ -1395,15 +1587,6 @@ static int run_as_create_worker_no_lock(const char *procname,
 	struct run_as_ret recvret;
 	run_as_worker_data *worker;
 
-	LTTNG_ASSERT(!global_worker);
-	if (!use_clone()) {
-		/*
-		 * Don't initialize a worker, all run_as tasks will be performed
-		 * in the current process.
-		 */
-		ret = 0;
-		goto end;
-	}
 	worker = zmalloc<run_as_worker_data>();
 	if (!worker) {
 		ret = -ENOMEM;
@@ -1488,7 +1671,7 @@ static int run_as_create_worker_no_lock(const char *procname,
 			ret = -1;
 			goto error_fork;
 		}
-		global_worker = worker;
+		*created_worker = worker;
 	}
 end:
 	return ret;
@@ -1511,10 +1694,8 @@ error_procname_alloc:
 	return ret;
 }
 
-static void run_as_destroy_worker_no_lock()
+static void run_as_destroy_worker_no_lock(run_as_worker_data *worker)
 {
-	run_as_worker_data *worker = global_worker;
-
 	DBG("Destroying run_as worker");
 	if (!worker) {
 		return;
@@ -1552,21 +1733,93 @@ static void run_as_destroy_worker_no_lock()
 	}
 	free(worker->procname);
 	free(worker);
-	global_worker = nullptr;
 }
 
-static int run_as_restart_worker(run_as_worker_data *worker)
+static void run_as_destroy_worker_pool_no_lock()
+{
+	unsigned int i;
+
+	for (i = 0; i < worker_count; i++) {
+		run_as_worker_slot *slot = &worker_pool[i];
+
+		pthread_mutex_lock(&slot->lock);
+		run_as_destroy_worker_no_lock(slot->worker);
+		slot->worker = nullptr;
+		pthread_mutex_unlock(&slot->lock);
+		(void) pthread_mutex_destroy(&slot->lock);
+	}
+
+	worker_count = 0;
+	free(worker_procname);
+	worker_procname = nullptr;
+}
+
+static int run_as_create_worker_pool_no_lock(const char *procname,
+					     post_fork_cleanup_cb clean_up_func,
+					     void *clean_up_user_data)
 {
 	int ret = 0;
-	char *procname = nullptr;
+	unsigned int i;
+	const auto requested_worker_count =
+		(unsigned int) utils_get_positive_env_value(DEFAULT_RUN_AS_WORKER_COUNT_ENV,
+							    DEFAULT_RUN_AS_WORKER_COUNT,
+							    RUN_AS_MAX_WORKER_COUNT);
+
+	LTTNG_ASSERT(worker_count == 0);
+	if (!use_clone()) {
+		/*
+		 * Don't initialize a worker, all run_as tasks will be performed
+		 * in the current process.
+		 */
+		goto end;
+	}
+
+	worker_procname = strdup(procname);
+	if (!worker_procname) {
+		ret = -ENOMEM;
+		goto end;
+	}
+
+	DBG("Creating run_as worker pool: worker count = %u", requested_worker_count);
+	for (i = 0; i < requested_worker_count; i++) {
+		run_as_worker_slot *slot = &worker_pool[i];
+
+		ret = pthread_mutex_init(&slot->lock, nullptr);
+		if (ret) {
+			PERROR("Failed to initialize run_as worker lock");
+			ret = -1;
+			goto error;
+		}
+
+		slot->worker = nullptr;
+		worker_count++;
+		ret = run_as_create_worker_no_lock(
+			procname, clean_up_func, clean_up_user_data, &slot->worker);
+		if (ret < 0) {
+			goto error;
+		}
+	}
 
-	procname = worker->procname;
+end:
+	return ret;
+error:
+	run_as_destroy_worker_pool_no_lock();
+	return ret;
+}
+
+/*
+ * Must be called with the slot's lock held.
+ */
+static int run_as_restart_worker(run_as_worker_slot *slot)
+{
+	int ret = 0;
 
 	/* Close socket to run_as worker process and clean up the zombie process */
-	run_as_destroy_worker_no_lock();
+	run_as_destroy_worker_no_lock(slot->worker);
+	slot->worker = nullptr;
 
 	/* Create a new run_as worker process*/
-	ret = run_as_create_worker_no_lock(procname, nullptr, nullptr);
+	ret = run_as_create_worker_no_lock(worker_procname, nullptr, nullptr, &slot->worker);
 	if (ret < 0) {
 		ERR("Restarting the worker process failed");
 		ret = -1;
@@ -1576,6 +1829,29 @@ err:
 	return ret;
 }
 
+/*
+ * Acquire the worker of the shard of the uid/gid pair, or any idle worker if
+ * it is busy. The acquired slot is returned locked.
+ */
+static run_as_worker_slot *acquire_worker_slot(uid_t uid, gid_t gid)
+{
+	unsigned int i;
+	const unsigned int shard_index =
+		(unsigned int) (((uint64_t) uid * 31 + (uint64_t) gid) % worker_count);
+
+	for (i = 0; i < worker_count; i++) {
+		run_as_worker_slot *slot = &worker_pool[(shard_index + i) % worker_count];
+
+		if (pthread_mutex_trylock(&slot->lock) == 0) {
+			return slot;
+		}
+	}
+
+	/* All workers are busy; wait for the shard's worker. */
+	pthread_mutex_lock(&worker_pool[shard_index].lock);
+	return &worker_pool[shard_index];
+}
+
 static int run_as(enum run_as_cmd cmd,
 		  struct run_as_data *data,
 		  struct run_as_ret *ret_value,
@@ -1584,13 +1860,28 @@ static int run_as(enum run_as_cmd cmd,
 {
 	int ret, saved_errno;
 
-	pthread_mutex_lock(&worker_lock);
 	if (use_clone()) {
+		run_as_worker_slot *slot;
+
 		DBG("Using run_as worker");
 
-		LTTNG_ASSERT(global_worker);
+		LTTNG_ASSERT(worker_count > 0);
+		slot = acquire_worker_slot(uid, gid);
 
-		ret = run_as_cmd(global_worker, cmd, data, ret_value, uid, gid);
+		if (!slot->worker) {
+			/* A previous restart of this worker failed; try again. */
+			ret = run_as_create_worker_no_lock(
+				worker_procname, nullptr, nullptr, &slot->worker);
+			if (ret < 0) {
+				ERR("Failed to restart worker process.");
+				ret_value->_errno = EIO;
+				ret_value->_error = true;
+				ret = -1;
+				goto unlock_slot;
+			}
+		}
+
+		ret = run_as_cmd(slot->worker, cmd, data, ret_value, uid, gid);
 		saved_errno = ret_value->_errno;
 
 		/*
@@ -1600,18 +1891,21 @@ static int run_as(enum run_as_cmd cmd,
 		if (ret == -1 && saved_errno == EIO) {
 			DBG("Socket closed unexpectedly... "
 			    "Restarting the worker process");
-			ret = run_as_restart_worker(global_worker);
+			ret = run_as_restart_worker(slot);
 			if (ret == -1) {
 				ERR("Failed to restart worker process.");
-				goto err;
+				goto unlock_slot;
 			}
 		}
+	unlock_slot:
+		pthread_mutex_unlock(&slot->lock);
 	} else {
 		DBG("Using run_as without worker");
+		pthread_mutex_lock(&worker_lock);
 		ret = run_as_noworker(cmd, data, ret_value, uid, gid);
+		pthread_mutex_unlock(&worker_lock);
 	}
-err:
-	pthread_mutex_unlock(&worker_lock);
+
 	return ret;
 }
 
@@ -1719,6 +2013,117 @@ error:
 	return ret;
 }
 
+int run_as_mkdirat_recursive_openat_batch(int dirfd,
+					  const char *directory,
+					  mode_t directory_mode,
+					  const char *const *file_names,
+					  unsigned int file_count,
+					  int flags,
+					  mode_t mode,
+					  uid_t uid,
+					  gid_t gid,
+					  int *fds)
+{
+	int ret = 0, saved_errno;
+	unsigned int opened_count = 0;
+
+	DBG3("mkdirat() recursive and openat() batch fd = %d%s, directory = %s, file count = %u, flags = %X, mode = %d, uid %d, gid %d",
+	     dirfd,
+	     dirfd == AT_FDCWD ? " (AT_FDCWD)" : "",
+	     directory ? directory : "(none)",
+	     file_count,
+	     flags,
+	     (int) mode,
+	     (int) uid,
+	     (int) gid);
+
+	/*
+	 * The files are opened in as few commands as possible; each command is
+	 * bounded by the number of file descriptors that can be passed in a
+	 * single message and by the size of its file name buffer.
+	 */
+	while (opened_count < file_count) {
+		struct run_as_data data = {};
+		struct run_as_ret run_as_ret = {};
+		size_t file_names_len = 0;
+		unsigned int i;
+
+		if (directory) {
+			ret = lttng_strncpy(data.u.open_batch.directory,
+					    directory,
+					    sizeof(data.u.open_batch.directory));
+			if (ret) {
+				ERR("Failed to copy directory argument of batched open command");
+				errno = ENAMETOOLONG;
+				goto error;
+			}
+		}
+
+		while (opened_count + data.u.open_batch.file_count < file_count &&
+		       data.u.open_batch.file_count < RUN_AS_OPEN_BATCH_MAX_FILE_COUNT) {
+			const char *file_name =
+				file_names[opened_count + data.u.open_batch.file_count];
+			const size_t file_name_size = strlen(file_name) + 1;
+
+			if (file_names_len + file_name_size >
+			    sizeof(data.u.open_batch.file_names)) {
+				break;
+			}
+
+			memcpy(data.u.open_batch.file_names + file_names_len,
+			       file_name,
+			       file_name_size);
+			file_names_len += file_name_size;
+			data.u.open_batch.file_count++;
+		}
+
+		if (data.u.open_batch.file_count == 0) {
+			ERR("File name too long for batched open command: name = `%s`",
+			    file_names[opened_count]);
+			errno = ENAMETOOLONG;
+			ret = -1;
+			goto error;
+		}
+
+		data.u.open_batch.dirfd = dirfd;
+		data.u.open_batch.directory_mode = directory_mode;
+		data.u.open_batch.flags = flags;
+		data.u.open_batch.mode = mode;
+		run_as(dirfd == AT_FDCWD ? RUN_AS_OPEN_BATCH : RUN_AS_OPENAT_BATCH,
+		       &data,
+		       &run_as_ret,
+		       uid,
+		       gid);
+		errno = run_as_ret._errno;
+		if (run_as_ret._error ||
+		    run_as_ret.u.open_batch.fd_count != data.u.open_batch.file_count) {
+			ret = -1;
+			goto error;
+		}
+
+		for (i = 0; i < run_as_ret.u.open_batch.fd_count; i++) {
+			fds[opened_count++] = run_as_ret.u.open_batch.fds[i];
+		}
+	}
+
+	return 0;
+
+error:
+	saved_errno = errno;
+
+	/* Either all files are opened or none are. */
+	for (unsigned int i = 0; i < opened_count; i++) {
+		if (close(fds[i])) {
+			PERROR("Failed to close file descriptor of batched open command");
+		}
+
+		fds[i] = -1;
+	}
+
+	errno = saved_errno;
+	return ret;
+}
+
 int run_as_unlink(const char *path, uid_t uid, gid_t gid)
 {
 	return run_as_unlinkat(AT_FDCWD, path, uid, gid);
@@ -1951,6 +2356,83 @@ error:
 	return ret;
 }
 
+namespace {
+/*
+ * Bytecode of the filter expressions compiled by the run-as workers, most
+ * recently used first.
+ *
+ * The bytecode only depends on the text of the filter expression, not on
+ * the credentials used to compile it. Hence, an expression is compiled once
+ * and the following event rules using the same expression reuse its
+ * bytecode.
+ */
+class filter_bytecode_cache {
+public:
+	/* Returns a copy of the bytecode of the expression, or nullptr if it is not cached. */
+	struct lttng_bytecode *get(const char *filter_expression)
+	{
+		const std::lock_guard<std::mutex> lock(_lock);
+		const auto it = _index.find(filter_expression);
+
+		if (it == _index.end()) {
+			return nullptr;
+		}
+
+		/* Move the entry to the front of the list. */
+		_entries.splice(_entries.begin(), _entries, it->second);
+
+		const auto& serialized_bytecode = it->second->second;
+		auto *bytecode = zmalloc<lttng_bytecode>(serialized_bytecode.size());
+		if (!bytecode) {
+			return nullptr;
+		}
+
+		memcpy(bytecode, serialized_bytecode.data(), serialized_bytecode.size());
+		return bytecode;
+	}
+
+	void add(const char *filter_expression, const struct lttng_bytecode& bytecode) noexcept
+	{
+		try {
+			const std::lock_guard<std::mutex> lock(_lock);
+			const char *raw_bytecode = reinterpret_cast<const char *>(&bytecode);
+
+			if (_index.find(filter_expression) != _index.end()) {
+				return;
+			}
+
+			_entries.emplace_front(
+				std::string(filter_expression),
+				std::vector<char>(raw_bytecode,
+						  raw_bytecode + sizeof(bytecode) + bytecode.len));
+			try {
+				_index.emplace(_entries.front().first, _entries.begin());
+			} catch (...) {
+				_entries.pop_front();
+				throw;
+			}
+
+			if (_entries.size() > RUN_AS_FILTER_BYTECODE_CACHE_SIZE) {
+				_index.erase(_entries.back().first);
+				_entries.pop_back();
+			}
+		} catch (const std::bad_alloc&) {
+			/* Not an error, the expression will be compiled again. */
+			DBG("Failed to allocate memory for filter bytecode cache entry");
+		}
+	}
+
+private:
+	using entry = std::pair<std::string, std::vector<char>>;
+
+	std::mutex _lock;
+	std::list<entry> _entries;
+	std::unordered_map<std::string, std::list<entry>::iterator> _index;
+};
+
+filter_bytecode_cache the_filter_bytecode_cache;
+} /* namespace */
+
 int run_as_generate_filter_bytecode(const char *filter_expression,
 				    const struct lttng_credentials *creds,
 				    struct lttng_bytecode **bytecode)
@@ -1968,18 +2450,26 @@ int run_as_generate_filter_bytecode(const char *filter_expression,
 	     (int) uid,
 	     (int) gid);
 
+	local_bytecode = the_filter_bytecode_cache.get(filter_expression);
+	if (local_bytecode) {
+		DBG3("Using cached bytecode of filter expression=\"%s\"", filter_expression);
+		*bytecode = local_bytecode;
+		ret = 0;
+		goto end;
+	}
+
 	ret = lttng_strncpy(data.u.generate_filter_bytecode.filter_expression,
 			    filter_expression,
 			    sizeof(data.u.generate_filter_bytecode.filter_expression));
 	if (ret) {
-		goto error;
+		goto end;
 	}
 
 	run_as(RUN_AS_GENERATE_FILTER_BYTECODE, &data, &run_as_ret, uid, gid);
 	errno = run_as_ret._errno;
 	if (run_as_ret._error) {
 		ret = -1;
-		goto error;
+		goto end;
 	}
 
 	view_bytecode =
@@ -1988,14 +2478,15 @@ int run_as_generate_filter_bytecode(const char *filter_expression,
 	local_bytecode = calloc<lttng_bytecode>(view_bytecode->len);
 	if (!local_bytecode) {
 		ret = -ENOMEM;
-		goto error;
+		goto end;
 	}
 
 	memcpy(local_bytecode,
 	       run_as_ret.u.generate_filter_bytecode.bytecode,
 	       sizeof(*local_bytecode) + view_bytecode->len);
+	the_filter_bytecode_cache.add(filter_expression, *local_bytecode);
 	*bytecode = local_bytecode;
-error:
+end:
 	return ret;
 }
 
@@ -2006,7 +2497,7 @@ int run_as_create_worker(const char *procname,
 	int ret;
 
 	pthread_mutex_lock(&worker_lock);
-	ret = run_as_create_worker_no_lock(procname, clean_up_func, clean_up_user_data);
+	ret = run_as_create_worker_pool_no_lock(procname, clean_up_func, clean_up_user_data);
 	pthread_mutex_unlock(&worker_lock);
 	return ret;
 }
@@ -2014,6 +2505,6 @@ int run_as_create_worker(const char *procname,
 void run_as_destroy_worker()
 {
 	pthread_mutex_lock(&worker_lock);
-	run_as_destroy_worker_no_lock();
+	run_as_destroy_worker_pool_no_lock();
 	pthread_mutex_unlock(&worker_lock);
 }
@@ -37,6 +37,25 @@ int run_as_mkdir(const char *path, mode_t mode, uid_t uid, gid_t gid);
 int run_as_mkdirat(int dirfd, const char *path, mode_t mode, uid_t uid, gid_t gid);
 int run_as_open(const char *path, int flags, mode_t mode, uid_t uid, gid_t gid);
 int run_as_openat(int dirfd, const char *filename, int flags, mode_t mode, uid_t uid, gid_t gid);
+/*
+ * Recursively create `directory` (relative to `dirfd`) and open the
+ * `file_count` files named by `file_names`, relative to that directory, in as
+ * few round trips to the run-as workers as possible. `directory` may be NULL
+ * to open the files directly relative to `dirfd`.
+ *
+ * On success, `fds` holds `file_count` file descriptors owned by the caller.
+ * On failure, -1 is returned, errno is set, and no file is left open.
+ */
+int run_as_mkdirat_recursive_openat_batch(int dirfd,
+					  const char *directory,
+					  mode_t directory_mode,
+					  const char *const *file_names,
+					  unsigned int file_count,
+					  int flags,
+					  mode_t mode,
+					  uid_t uid,
+					  gid_t gid,
+					  int *fds);
 int run_as_unlink(const char *path, uid_t uid, gid_t gid);
 int run_as_unlinkat(int dirfd, const char *filename, uid_t uid, gid_t gid);
 int run_as_rmdir(const char *path, uid_t uid, gid_t gid);
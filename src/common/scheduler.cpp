@@ -0,0 +1,283 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Jérémie Galarneau <jeremie.galarneau@efficios.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.0-only
+ */
+
+#include <common/error.hpp>
+#include <common/scheduler.hpp>
+
+#include <algorithm>
+
+namespace ls = lttng::scheduling;
+
+namespace {
+/* Index of the first bit set in `bits`, starting from `start_bit` and wrapping around. */
+unsigned int first_set_bit_from(std::uint64_t bits, unsigned int start_bit) noexcept
+{
+	LTTNG_ASSERT(bits);
+
+	const auto rotated_bits =
+		start_bit == 0 ? bits : (bits >> start_bit) | (bits << (64 - start_bit));
+
+	return (start_bit + __builtin_ctzll(rotated_bits)) % 64;
+}
+} /* namespace */
+
+void ls::scheduler::schedule(task::sptr task, absolute_time when_to_run)
+{
+	const std::lock_guard<std::mutex> lock(_mutex);
+
+	_schedule_no_lock(std::move(task), when_to_run);
+}
+
+void ls::scheduler::_schedule_no_lock(task::sptr task, absolute_time when_to_run)
+{
+	task->_set_next_scheduled_time(when_to_run);
+	_timer_wheel.insert(std::move(task));
+
+	if (_next_wake_up_time && *_next_wake_up_time <= when_to_run) {
+		/* The user of the scheduler will tick before the task's deadline. */
+		return;
+	}
+
+	_next_wake_up_time = when_to_run;
+	for (const auto& callback : _task_scheduled_callbacks) {
+		callback(when_to_run);
+	}
+}
+
+nonstd::optional<ls::duration_ns> ls::scheduler::tick(absolute_time current_time) noexcept
+{
+	std::vector<task::sptr> expired_tasks;
+
+	while (true) {
+		{
+			const std::lock_guard<std::mutex> lock(_mutex);
+
+			const auto time_until_next_task =
+				_take_expired_tasks_no_lock(current_time, expired_tasks);
+			if (expired_tasks.empty()) {
+				return time_until_next_task;
+			}
+		}
+
+		/*
+		 * The scheduler lock doesn't need to be held while the tasks are being run.
+		 */
+		for (auto& expired_task : expired_tasks) {
+			expired_task = _run_task(std::move(expired_task), current_time);
+		}
+
+		/*
+		 * Reschedule the periodic tasks as a batch. The task scheduled callbacks are not
+		 * invoked since the nearest deadline is returned to the caller.
+		 */
+		const std::lock_guard<std::mutex> lock(_mutex);
+		for (auto& task_to_reschedule : expired_tasks) {
+			if (!task_to_reschedule) {
+				continue;
+			}
+
+			const auto& periodic_task_to_schedule =
+				static_cast<const periodic_task&>(*task_to_reschedule);
+
+			task_to_reschedule->_set_next_scheduled_time(
+				current_time + periodic_task_to_schedule.period());
+			_timer_wheel.insert(std::move(task_to_reschedule));
+		}
+
+		expired_tasks.clear();
+	}
+}
+
+nonstd::optional<ls::duration_ns>
+ls::scheduler::take_expired_tasks(absolute_time current_time,
+				  std::vector<task::sptr>& expired_tasks)
+{
+	const std::lock_guard<std::mutex> lock(_mutex);
+
+	return _take_expired_tasks_no_lock(current_time, expired_tasks);
+}
+
+nonstd::optional<ls::duration_ns>
+ls::scheduler::_take_expired_tasks_no_lock(absolute_time current_time,
+					   std::vector<task::sptr>& expired_tasks)
+{
+	const auto first_expired_task_index = expired_tasks.size();
+
+	_last_tick = current_time;
+	_timer_wheel.advance(current_time, expired_tasks);
+	std::stable_sort(expired_tasks.begin() + first_expired_task_index,
+			 expired_tasks.end(),
+			 [](const task::sptr& a, const task::sptr& b) {
+				 return _deadline(*a) < _deadline(*b);
+			 });
+
+	_next_wake_up_time = _timer_wheel.next_deadline();
+	if (!_next_wake_up_time) {
+		return nonstd::nullopt;
+	}
+
+	return *_next_wake_up_time - current_time;
+}
+
+void ls::scheduler::run_expired_task(task::sptr task, absolute_time expiration_tick_time) noexcept
+{
+	auto task_to_reschedule = _run_task(std::move(task), expiration_tick_time);
+
+	if (!task_to_reschedule) {
+		return;
+	}
+
+	const auto& periodic_task_to_schedule =
+		static_cast<const periodic_task&>(*task_to_reschedule);
+	const auto when_to_run = expiration_tick_time + periodic_task_to_schedule.period();
+
+	const std::lock_guard<std::mutex> lock(_mutex);
+	_schedule_no_lock(std::move(task_to_reschedule), when_to_run);
+}
+
+ls::task::sptr ls::scheduler::_run_task(task::sptr task, absolute_time current_time) noexcept
+{
+	const auto time_before_task_run = std::chrono::steady_clock::now();
+	DBG_FMT("Running task: name=`{}`", task->_name);
+
+	task->run(current_time);
+
+	DBG_FMT("Task completed: duration={}",
+		std::chrono::steady_clock::now() - time_before_task_run);
+
+	return task->_must_be_rescheduled() ? std::move(task) : nullptr;
+}
+
+std::uint64_t ls::scheduler::timer_wheel::_to_ticks(absolute_time time) noexcept
+{
+	const auto time_ns = time.time_since_epoch().count();
+
+	return time_ns < 0 ? 0 : static_cast<std::uint64_t>(time_ns) >> resolution_shift;
+}
+
+void ls::scheduler::timer_wheel::insert(task::sptr task)
+{
+	const auto deadline_tick = _to_ticks(_deadline(*task));
+	unsigned int level = 0;
+	std::uint64_t position = _current_tick;
+
+	if (deadline_tick > _current_tick) {
+		/* Find the lowest level which spans the deadline. */
+		while (level < level_count - 1 &&
+		       (deadline_tick >> (level * slot_bits)) -
+				       (_current_tick >> (level * slot_bits)) >=
+			       slot_count) {
+			level++;
+		}
+
+		/*
+		 * Deadlines beyond the span of the wheel are placed in its last slot and
+		 * re-inserted when it is reached.
+		 */
+		const auto shift = level * slot_bits;
+		const auto last_position = (_current_tick >> shift) + slot_count - 1;
+
+		position = std::min(deadline_tick >> shift, last_position);
+	}
+
+	const auto slot = static_cast<unsigned int>(position % slot_count);
+
+	_slots[level][slot].emplace_back(std::move(task));
+	_occupied_slots[level] |= UINT64_C(1) << slot;
+}
+
+void ls::scheduler::timer_wheel::_take_slot(unsigned int level,
+					    unsigned int slot,
+					    std::vector<task::sptr>& tasks) noexcept
+{
+	auto& slot_tasks = _slots[level][slot];
+
+	std::move(slot_tasks.begin(), slot_tasks.end(), std::back_inserter(tasks));
+	/* Clearing the vector preserves its capacity for the next tasks of the slot. */
+	slot_tasks.clear();
+	_occupied_slots[level] &= ~(UINT64_C(1) << slot);
+}
+
+void ls::scheduler::timer_wheel::advance(absolute_time current_time,
+					 std::vector<task::sptr>& expired_tasks)
+{
+	const auto new_tick = std::max(_to_ticks(current_time), _current_tick);
+
+	_cascaded_tasks.clear();
+	for (unsigned int level = 0; level < level_count; level++) {
+		const auto shift = level * slot_bits;
+		/*
+		 * The current slot of the first level holds the tasks due during the current
+		 * tick. The current slot of the other levels was visited when it was reached.
+		 */
+		const auto first_position = (_current_tick >> shift) + (level == 0 ? 0 : 1);
+		const auto last_position = new_tick >> shift;
+
+		if (!_occupied_slots[level] || last_position < first_position) {
+			continue;
+		}
+
+		if (last_position - first_position >= slot_count - 1) {
+			/* All of the level's slots elapsed. */
+			for (unsigned int slot = 0; slot < slot_count; slot++) {
+				_take_slot(level, slot, _cascaded_tasks);
+			}
+
+			continue;
+		}
+
+		for (auto position = first_position; position <= last_position; position++) {
+			const auto slot = static_cast<unsigned int>(position % slot_count);
+
+			if (_occupied_slots[level] & (UINT64_C(1) << slot)) {
+				_take_slot(level, slot, _cascaded_tasks);
+			}
+		}
+	}
+
+	_current_tick = new_tick;
+
+	/* Collect the expired tasks and cascade the others to the appropriate level. */
+	for (auto& task : _cascaded_tasks) {
+		if (_deadline(*task) <= current_time) {
+			expired_tasks.emplace_back(std::move(task));
+		} else {
+			insert(std::move(task));
+		}
+	}
+
+	_cascaded_tasks.clear();
+}
+
+nonstd::optional<ls::absolute_time> ls::scheduler::timer_wheel::next_deadline() const noexcept
+{
+	nonstd::optional<absolute_time> nearest_deadline;
+
+	/*
+	 * The slots of a level hold increasing deadlines starting from the current position.
+	 * Hence, the nearest deadline of a level is held by its first non-empty slot.
+	 */
+	for (unsigned int level = 0; level < level_count; level++) {
+		if (!_occupied_slots[level]) {
+			continue;
+		}
+
+		const auto shift = level * slot_bits;
+		const auto first_position = (_current_tick >> shift) + (level == 0 ? 0 : 1);
+		const auto slot = first_set_bit_from(
+			_occupied_slots[level], static_cast<unsigned int>(first_position % slot_count));
+
+		for (const auto& task : _slots[level][slot]) {
+			const auto deadline = _deadline(*task);
+
+			if (!nearest_deadline || deadline < *nearest_deadline) {
+				nearest_deadline = deadline;
+			}
+		}
+	}
+
+	return nearest_deadline;
+}
@@ -1,9 +1,6 @@
 /*
  * SPDX-License-Identifier: LGPL-2.0-only
  *
- * Uses heap management code adapted from Babeltrace 2's prio-heap.c.
- *
- * SPDX-FileCopyrightText: 2011 Mathieu Desnoyers <mathieu.desnoyers@efficios.com>
  * SPDX-FileCopyrightText: 2025 Jérémie Galarneau <jeremie.galarneau@efficios.com>
  */
 
@@ -16,8 +13,11 @@
 
 #include <vendor/optional.hpp>
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <stddef.h>
@@ -84,8 +84,8 @@ public:
 		_canceled = true;
 
 		/*
-		 * _next_scheduled_time is left unchanged since the task may still be in the
-		 * scheduler's heap.
+		 * _next_scheduled_time is left unchanged since the task may still be in one
+		 * of the scheduler's timer wheel slots or in a batch of expired tasks.
 		 */
 	}
 
@@ -108,28 +108,35 @@ private:
 		return false;
 	}
 
+	/*
+	 * The scheduled time is read without acquiring the task's lock as the
+	 * scheduler consults it on every expiration.
+	 */
 	absolute_time _get_next_scheduled_time() const noexcept
 	{
-		const std::lock_guard<std::mutex> lock(_mutex);
+		const auto next_time_ns = _next_scheduled_time_ns.load(std::memory_order_acquire);
 
-		LTTNG_ASSERT(_next_scheduled_time.has_value());
-		return *_next_scheduled_time;
+		LTTNG_ASSERT(next_time_ns != _unscheduled_time_ns);
+		return absolute_time(duration_ns(next_time_ns));
 	}
 
 	void _set_next_scheduled_time(absolute_time next_time) noexcept
 	{
-		const std::lock_guard<std::mutex> lock(_mutex);
-
-		_next_scheduled_time = next_time;
+		_next_scheduled_time_ns.store(next_time.time_since_epoch().count(),
+					      std::memory_order_release);
 	}
 
+	static constexpr std::int64_t _unscheduled_time_ns =
+		std::numeric_limits<std::int64_t>::min();
+
 	/*
-	 * nullopt means not scheduled.
+	 * Nanoseconds since the epoch of the steady clock, _unscheduled_time_ns means not
+	 * scheduled.
 	 *
 	 * Don't access directly, use _get_next_scheduled_time() and
-	 * _set_next_scheduled_time() to ensure proper locking.
+	 * _set_next_scheduled_time().
 	 */
-	nonstd::optional<absolute_time> _next_scheduled_time;
+	std::atomic<std::int64_t> _next_scheduled_time_ns{ _unscheduled_time_ns };
 
 	const std::string _name{ "Anonymous" };
 };
@@ -210,18 +217,14 @@ public:
 	scheduler& operator=(const scheduler&) = delete;
 	scheduler& operator=(scheduler&&) = delete;
 
-	/* Schedule a "once" or periodic task in the future. */
-	void schedule(task::sptr task, absolute_time when_to_run = std::chrono::steady_clock::now())
-	{
-		const std::lock_guard<std::mutex> lock(_mutex);
-
-		for (const auto& callback : _task_scheduled_callbacks) {
-			callback(when_to_run);
-		}
-
-		task->_set_next_scheduled_time(when_to_run);
-		_task_heap.insert(std::move(task));
-	}
+	/*
+	 * Schedule a "once" or periodic task in the future.
+	 *
+	 * The task scheduled callbacks are only invoked when the task must run before the
+	 * nearest deadline known to the scheduler's user (i.e. returned by the last tick).
+	 */
+	void schedule(task::sptr task,
+		      absolute_time when_to_run = std::chrono::steady_clock::now());
 
 	/*
 	 * Run scheduled tasks that have expired as of the current time.
@@ -231,44 +234,22 @@ public:
 	 * - `nonstd::nullopt` if no tasks are currently scheduled.
 	 */
 	nonstd::optional<duration_ns>
-	tick(absolute_time current_time = std::chrono::steady_clock::now()) noexcept
-	{
-		_last_tick = current_time;
-
-		while (true) {
-			lttng::scheduling::task::sptr task_to_run = nullptr;
-
-			{
-				const std::lock_guard<std::mutex> lock(_mutex);
-
-				const auto candidate = _task_heap.peek();
-
-				/* If the task heap is empty, return no next task. */
-				if (candidate == nullptr) {
-					return nonstd::nullopt;
-				}
+	tick(absolute_time current_time = std::chrono::steady_clock::now()) noexcept;
 
-				if (candidate->_get_next_scheduled_time() > _last_tick) {
-					return candidate->_get_next_scheduled_time() - current_time;
-				}
-
-				/* The task is ready to run. */
-				task_to_run = _task_heap.pop();
-			}
-
-			/*
-			 * The scheduler lock doesn't need to be held while the task is being run.
-			 */
-
-			const auto time_before_task_run = std::chrono::steady_clock::now();
-			DBG_FMT("Running task: name=`{}`", task_to_run->_name);
-
-			_run_task(std::move(task_to_run));
+	/*
+	 * Remove the tasks that have expired as of the current time and append them to
+	 * `expired_tasks`, in the order of their deadline, without running them.
+	 *
+	 * The caller is responsible for running each of the expired tasks using
+	 * run_expired_task(), possibly from other threads.
+	 *
+	 * Returns the same value as tick(), not accounting for the expired tasks.
+	 */
+	nonstd::optional<duration_ns> take_expired_tasks(absolute_time current_time,
+							 std::vector<task::sptr>& expired_tasks);
 
-			DBG_FMT("Task completed: duration={}",
-				std::chrono::steady_clock::now() - time_before_task_run);
-		}
-	}
+	/* Run a task returned by take_expired_tasks() and reschedule it, if necessary. */
+	void run_expired_task(task::sptr task, absolute_time expiration_tick_time) noexcept;
 
 	void add_task_scheduled_callback(task_scheduled_callback callback) noexcept
 	{
@@ -277,120 +258,68 @@ public:
 	}
 
 private:
-	/* Run a task and reschedule it, if necessary. */
-	void _run_task(task::sptr task) noexcept
+	static absolute_time _deadline(const task& task) noexcept
 	{
-		task->run(_last_tick);
-		if (task->_must_be_rescheduled()) {
-			auto& periodic_task_to_schedule = static_cast<periodic_task&>(*task);
-
-			schedule(std::move(task), _last_tick + periodic_task_to_schedule.period());
-		}
+		return task._get_next_scheduled_time();
 	}
 
-	class task_heap {
-	public:
-		/* Insert task to schedule. */
-		void insert(task::sptr new_task)
-		{
-			/* Position starts at the last element. */
-			auto position = _tasks.size();
-
-			_tasks.resize(_tasks.size() + 1);
-
-			while (position > 0 &&
-			       _task_should_run_before(*new_task, *_tasks[_parent(position)])) {
-				/* Move parent down until we find the right spot. */
-				_tasks[position] = std::move(_tasks[_parent(position)]);
-				position = _parent(position);
-			}
-
-			_tasks[position] = std::move(new_task);
-		}
-
-		/* Peek at task with the nearest deadline. */
-		task *peek() const noexcept
-		{
-			return _tasks.empty() ? nullptr : _tasks.begin()->get();
-		}
-
-		/* Pop task with the nearest deadline. */
-		task::sptr pop() noexcept
-		{
-			switch (_tasks.size()) {
-			case 0:
-				return nullptr;
-			case 1:
-				const auto task = std::move(*_tasks.begin());
-
-				_tasks.clear();
-				return task;
-			}
-
-			const auto task = std::move(*_tasks.begin());
-			*_tasks.begin() = std::move(*(_tasks.end() - 1));
-			_tasks.resize(_tasks.size() - 1);
-			heapify(0);
-
-			return task;
-		}
-
-	private:
-		/* Heap internals. */
-		size_t _parent(const size_t i) const noexcept
-		{
-			return (i - 1) >> 1;
-		}
+	/* Run a task and return it if it must be rescheduled. */
+	static task::sptr _run_task(task::sptr task, absolute_time current_time) noexcept;
 
-		size_t _left(const size_t i) const noexcept
-		{
-			return (i << 1) + 1;
-		}
+	/* Scheduler lock must be held by the caller. */
+	void _schedule_no_lock(task::sptr task, absolute_time when_to_run);
+	nonstd::optional<duration_ns>
+	_take_expired_tasks_no_lock(absolute_time current_time,
+				    std::vector<task::sptr>& expired_tasks);
 
-		size_t _right(const size_t i) const noexcept
-		{
-			return (i << 1) + 2;
-		}
+	/*
+	 * Hierarchical timer wheel.
+	 *
+	 * Deadlines are bucketed in slots of 2^resolution_shift ns at the first level, each
+	 * subsequent level's slots covering the span of all the slots of the previous level.
+	 * Inserting a task is O(1) and expired tasks are collected in batches by visiting the
+	 * slots that elapsed since the last advance; tasks of a higher level are cascaded to
+	 * lower levels as their deadline approaches.
+	 *
+	 * The exact deadline of the tasks is checked when they are collected, so a slot's
+	 * tasks that are not due yet are simply re-inserted.
+	 */
+	class timer_wheel {
+	public:
+		void insert(task::sptr task);
 
-		bool _task_should_run_before(const task& a, const task& b) const noexcept
-		{
-			return a._get_next_scheduled_time() < b._get_next_scheduled_time();
-		}
+		/*
+		 * Move the tasks expired as of `current_time` to `expired_tasks`, in no
+		 * particular order.
+		 */
+		void advance(absolute_time current_time, std::vector<task::sptr>& expired_tasks);
 
-		void heapify(size_t i) noexcept
-		{
-			for (;;) {
-				const auto left_idx = _left(i);
-				const auto right_idx = _right(i);
-				size_t highest_prio_idx;
-
-				if (left_idx < _tasks.size() &&
-				    _task_should_run_before(*_tasks[left_idx], *_tasks[i])) {
-					highest_prio_idx = left_idx;
-				} else {
-					highest_prio_idx = i;
-				}
-
-				if (right_idx < _tasks.size() &&
-				    _task_should_run_before(*_tasks[right_idx],
-							    *_tasks[highest_prio_idx])) {
-					highest_prio_idx = right_idx;
-				}
-
-				if (highest_prio_idx == i) {
-					break;
-				}
-
-				std::swap(_tasks[i], _tasks[highest_prio_idx]);
-				i = highest_prio_idx;
-			}
-		}
+		/* Nearest deadline of the tasks in the wheel, if any. */
+		nonstd::optional<absolute_time> next_deadline() const noexcept;
 
-		std::vector<task::sptr> _tasks;
-	} _task_heap;
+	private:
+		static constexpr unsigned int resolution_shift = 20;
+		static constexpr unsigned int slot_bits = 6;
+		static constexpr unsigned int slot_count = 1U << slot_bits;
+		static constexpr unsigned int level_count = 4;
+
+		static std::uint64_t _to_ticks(absolute_time time) noexcept;
+		void _take_slot(unsigned int level,
+				unsigned int slot,
+				std::vector<task::sptr>& tasks) noexcept;
+
+		std::array<std::array<std::vector<task::sptr>, slot_count>, level_count> _slots;
+		/* One bit per non-empty slot of each level. */
+		std::array<std::uint64_t, level_count> _occupied_slots = {};
+		std::uint64_t _current_tick = 0;
+		/* Storage reused across calls to advance() to avoid allocations. */
+		std::vector<task::sptr> _cascaded_tasks;
+	} _timer_wheel;
 
 	/* Initialized to epoch. */
 	absolute_time _last_tick;
+	/* Nearest deadline returned by the last tick, if any. */
+	nonstd::optional<absolute_time> _next_wake_up_time;
 	std::mutex _mutex;
 	std::vector<task_scheduled_callback> _task_scheduled_callbacks;
 };
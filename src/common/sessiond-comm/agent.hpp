@@ -26,6 +26,15 @@ enum lttcomm_agent_command {
 	AGENT_CMD_REG_DONE = 4, /* End registration process. */
 	AGENT_CMD_APP_CTX_ENABLE = 5,
 	AGENT_CMD_APP_CTX_DISABLE = 6,
+	/*
+	 * Bulk commands, available since protocol version 2.1. Their payload
+	 * is a struct lttcomm_agent_bulk_hdr followed by `entry_count` entries
+	 * laid out as the payload of the equivalent single-entry command. They
+	 * are answered by a struct lttcomm_agent_bulk_reply_hdr followed by one
+	 * return code per entry.
+	 */
+	AGENT_CMD_ENABLE_BULK = 7,
+	AGENT_CMD_APP_CTX_ENABLE_BULK = 8,
 };
 
 /*
@@ -75,6 +84,22 @@ struct lttcomm_agent_generic_reply {
 	uint32_t ret_code;
 } LTTNG_PACKED;
 
+/*
+ * Bulk command payload header.
+ */
+struct lttcomm_agent_bulk_hdr {
+	uint32_t entry_count;
+} LTTNG_PACKED;
+
+/*
+ * Bulk command reply header. Followed by `entry_count` uint32_t return codes,
+ * one per entry of the command, in the order of the command's entries.
+ */
+struct lttcomm_agent_bulk_reply_hdr {
+	uint32_t ret_code;
+	uint32_t entry_count;
+} LTTNG_PACKED;
+
 /*
  * List command reply header.
  */
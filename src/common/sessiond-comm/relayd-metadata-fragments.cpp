@@ -0,0 +1,381 @@
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ */
+
+#include "relayd-metadata-fragments.hpp"
+#include "relayd.hpp"
+
+#include <common/compat/endian.hpp>
+#include <common/error.hpp>
+#include <common/lz4.hpp>
+
+#include <algorithm>
+#include <array>
+#include <new>
+#include <stddef.h>
+#include <string.h>
+
+namespace lr = lttng::relayd;
+
+namespace {
+/*
+ * Fragment boundaries are placed where a rolling hash of the last 64 bytes
+ * matches a mask, hence independently of the position of the content in the
+ * packet. On average, a boundary is found 512 bytes past the minimal fragment
+ * size.
+ */
+constexpr std::size_t min_fragment_size = 256;
+constexpr std::size_t max_fragment_size = 4096;
+constexpr unsigned int boundary_mask_bits = 9;
+constexpr std::size_t rolling_hash_window_size = 64;
+constexpr std::uint64_t boundary_mask = ((UINT64_C(1) << boundary_mask_bits) - 1)
+	<< (64 - boundary_mask_bits);
+
+static_assert(max_fragment_size <= LTTCOMM_RELAYD_METADATA_FRAGMENT_MAX_SIZE,
+	      "Metadata fragments must not exceed the maximal size of the protocol");
+
+std::uint64_t mix(std::uint64_t value) noexcept
+{
+	value = (value ^ (value >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+	value = (value ^ (value >> 27)) * UINT64_C(0x94d049bb133111eb);
+	return value ^ (value >> 31);
+}
+
+/* Random values associated to each byte value by the rolling hash. */
+const std::array<std::uint64_t, 256>& rolling_hash_table()
+{
+	static const auto table = [] {
+		std::array<std::uint64_t, 256> values;
+		std::uint64_t state = 0;
+
+		for (auto& value : values) {
+			state += UINT64_C(0x9e3779b97f4a7c15);
+			value = mix(state);
+		}
+
+		return values;
+	}();
+
+	return table;
+}
+
+std::size_t next_fragment_size(const char *data, std::size_t size) noexcept
+{
+	const auto& table = rolling_hash_table();
+	const auto limit = std::min(size, max_fragment_size);
+	std::uint64_t hash = 0;
+
+	if (size <= min_fragment_size) {
+		return size;
+	}
+
+	/* Only the last 64 bytes contribute to the hash. */
+	for (auto i = min_fragment_size - rolling_hash_window_size; i < limit; i++) {
+		hash = (hash << 1) + table[static_cast<unsigned char>(data[i])];
+		if (i >= min_fragment_size && !(hash & boundary_mask)) {
+			return i + 1;
+		}
+	}
+
+	return limit;
+}
+
+/*
+ * Non-cryptographic hash: the content of a fragment is compared with the
+ * stored fragment before being sent as a reference.
+ */
+std::uint64_t hash_fragment(const char *data, std::size_t size) noexcept
+{
+	std::uint64_t hash = mix(size);
+	std::size_t i;
+
+	for (i = 0; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+		std::uint64_t word;
+
+		memcpy(&word, data + i, sizeof(word));
+		hash = mix(hash ^ word);
+	}
+
+	if (i < size) {
+		std::uint64_t word = 0;
+
+		memcpy(&word, data + i, size - i);
+		hash = mix(hash ^ word);
+	}
+
+	return hash;
+}
+
+int append_fragment(struct lttng_dynamic_buffer& payload,
+		    enum lttcomm_relayd_metadata_fragment_type type,
+		    std::uint64_t hash,
+		    std::size_t size,
+		    const char *content,
+		    std::size_t encoded_size)
+{
+	struct lttcomm_relayd_metadata_fragment descriptor = {};
+
+	descriptor.type = (uint8_t) type;
+	descriptor.hash = htobe64(hash);
+	descriptor.size = htobe32((uint32_t) size);
+	descriptor.encoded_size = htobe32((uint32_t) encoded_size);
+	if (lttng_dynamic_buffer_append(&payload, &descriptor, sizeof(descriptor))) {
+		return -1;
+	}
+
+	return lttng_dynamic_buffer_append(&payload, content, encoded_size);
+}
+} /* namespace */
+
+const std::vector<char> *lr::metadata_fragment_store::find(std::uint64_t hash) const
+{
+	const auto it = _fragments.find(hash);
+
+	return it == _fragments.end() ? nullptr : &it->second;
+}
+
+void lr::metadata_fragment_store::add(std::uint64_t hash, const char *data, std::size_t size)
+{
+	LTTNG_ASSERT(size <= LTTCOMM_RELAYD_METADATA_FRAGMENT_MAX_SIZE);
+
+	if (_fragments.find(hash) != _fragments.end()) {
+		return;
+	}
+
+	_insertion_order.emplace_back(hash);
+	try {
+		_fragments.emplace(hash, std::vector<char>(data, data + size));
+	} catch (...) {
+		_insertion_order.pop_back();
+		throw;
+	}
+
+	_size += size;
+	/* The fragment that was just added is never evicted as it is smaller than the store. */
+	while (_size > LTTCOMM_RELAYD_METADATA_FRAGMENT_STORE_SIZE) {
+		const auto evicted = _fragments.find(_insertion_order.front());
+
+		_size -= evicted->second.size();
+		_fragments.erase(evicted);
+		_insertion_order.pop_front();
+	}
+}
+
+int lr::encode_metadata_packet(metadata_fragment_store& store,
+			       std::uint64_t stream_id,
+			       const struct lttng_buffer_view& packet,
+			       std::uint32_t padding_size,
+			       struct lttng_dynamic_buffer& payload)
+{
+	struct lttcomm_relayd_metadata_fragments_payload header = {};
+	const auto header_offset = payload.size;
+	std::uint32_t fragment_count = 0;
+	char compressed_fragment[max_fragment_size];
+	std::size_t fragment_size;
+
+	LTTNG_ASSERT(packet.size <= UINT32_MAX);
+
+	header.stream_id = htobe64(stream_id);
+	header.padding_size = htobe32(padding_size);
+	header.content_size = htobe32((uint32_t) packet.size);
+	if (lttng_dynamic_buffer_append(&payload, &header, sizeof(header))) {
+		return -1;
+	}
+
+	try {
+		for (std::size_t offset = 0; offset < packet.size; offset += fragment_size) {
+			const char *fragment = packet.data + offset;
+
+			fragment_size = next_fragment_size(fragment, packet.size - offset);
+
+			const auto hash = hash_fragment(fragment, fragment_size);
+			const auto *stored_fragment = store.find(hash);
+			int ret;
+
+			fragment_count++;
+			if (stored_fragment && stored_fragment->size() == fragment_size &&
+			    !memcmp(stored_fragment->data(), fragment, fragment_size)) {
+				ret = append_fragment(payload,
+						      LTTCOMM_RELAYD_METADATA_FRAGMENT_TYPE_REFERENCE,
+						      hash,
+						      fragment_size,
+						      nullptr,
+						      0);
+				if (ret) {
+					return -1;
+				}
+
+				continue;
+			}
+
+			/*
+			 * A fragment whose hash collides with a stored fragment is
+			 * sent, but isn't stored by either peer.
+			 */
+			store.add(hash, fragment, fragment_size);
+
+			/* Only use the compressed fragment if it is smaller. */
+			const auto compressed_size = lttng::lz4::compress_block(
+				fragment, fragment_size, compressed_fragment, fragment_size - 1);
+			if (compressed_size) {
+				ret = append_fragment(payload,
+						      LTTCOMM_RELAYD_METADATA_FRAGMENT_TYPE_LITERAL_LZ4,
+						      hash,
+						      fragment_size,
+						      compressed_fragment,
+						      compressed_size);
+			} else {
+				ret = append_fragment(payload,
+						      LTTCOMM_RELAYD_METADATA_FRAGMENT_TYPE_LITERAL,
+						      hash,
+						      fragment_size,
+						      fragment,
+						      fragment_size);
+			}
+
+			if (ret) {
+				return -1;
+			}
+		}
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to allocate metadata fragment");
+		return -1;
+	}
+
+	fragment_count = htobe32(fragment_count);
+	memcpy(payload.data + header_offset +
+		       offsetof(struct lttcomm_relayd_metadata_fragments_payload, fragment_count),
+	       &fragment_count,
+	       sizeof(fragment_count));
+	return 0;
+}
+
+int lr::decode_metadata_packet(metadata_fragment_store& store,
+			       const struct lttng_buffer_view& payload,
+			       std::uint64_t& stream_id,
+			       std::uint32_t& padding_size,
+			       struct lttng_dynamic_buffer& packet)
+{
+	struct lttcomm_relayd_metadata_fragments_payload header;
+	std::size_t offset = sizeof(header);
+
+	if (payload.size < sizeof(header)) {
+		ERR("Metadata fragments payload is smaller than its header: size = %zu",
+		    payload.size);
+		return -1;
+	}
+
+	memcpy(&header, payload.data, sizeof(header));
+	stream_id = be64toh(header.stream_id);
+	padding_size = be32toh(header.padding_size);
+	header.content_size = be32toh(header.content_size);
+	header.fragment_count = be32toh(header.fragment_count);
+
+	if (lttng_dynamic_buffer_set_size(&packet, 0)) {
+		return -1;
+	}
+
+	try {
+		for (std::uint32_t i = 0; i < header.fragment_count; i++) {
+			struct lttcomm_relayd_metadata_fragment descriptor;
+			const auto fragment_offset = packet.size;
+
+			if (payload.size - offset < sizeof(descriptor)) {
+				ERR("Truncated metadata fragment descriptor");
+				return -1;
+			}
+
+			memcpy(&descriptor, payload.data + offset, sizeof(descriptor));
+			offset += sizeof(descriptor);
+			descriptor.hash = be64toh(descriptor.hash);
+			descriptor.size = be32toh(descriptor.size);
+			descriptor.encoded_size = be32toh(descriptor.encoded_size);
+
+			if (descriptor.size == 0 ||
+			    descriptor.size > LTTCOMM_RELAYD_METADATA_FRAGMENT_MAX_SIZE ||
+			    descriptor.size > header.content_size - packet.size ||
+			    descriptor.encoded_size > payload.size - offset) {
+				ERR("Invalid metadata fragment size: size = %" PRIu32
+				    ", encoded size = %" PRIu32,
+				    descriptor.size,
+				    descriptor.encoded_size);
+				return -1;
+			}
+
+			const char *content = payload.data + offset;
+
+			switch (descriptor.type) {
+			case LTTCOMM_RELAYD_METADATA_FRAGMENT_TYPE_REFERENCE:
+			{
+				const auto *stored_fragment = store.find(descriptor.hash);
+
+				if (descriptor.encoded_size != 0 || !stored_fragment ||
+				    stored_fragment->size() != descriptor.size) {
+					ERR("Reference to unknown metadata fragment: hash = %" PRIx64,
+					    descriptor.hash);
+					return -1;
+				}
+
+				if (lttng_dynamic_buffer_append(
+					    &packet, stored_fragment->data(), descriptor.size)) {
+					return -1;
+				}
+
+				break;
+			}
+			case LTTCOMM_RELAYD_METADATA_FRAGMENT_TYPE_LITERAL:
+				if (descriptor.encoded_size != descriptor.size) {
+					ERR("Invalid literal metadata fragment size");
+					return -1;
+				}
+
+				if (lttng_dynamic_buffer_append(&packet, content, descriptor.size)) {
+					return -1;
+				}
+
+				store.add(descriptor.hash, content, descriptor.size);
+				break;
+			case LTTCOMM_RELAYD_METADATA_FRAGMENT_TYPE_LITERAL_LZ4:
+				if (lttng_dynamic_buffer_set_size(&packet,
+								  fragment_offset + descriptor.size)) {
+					return -1;
+				}
+
+				if (!lttng::lz4::decompress_block(content,
+								  descriptor.encoded_size,
+								  packet.data + fragment_offset,
+								  descriptor.size)) {
+					ERR("Invalid compressed metadata fragment");
+					return -1;
+				}
+
+				store.add(descriptor.hash,
+					  packet.data + fragment_offset,
+					  descriptor.size);
+				break;
+			default:
+				ERR("Unknown metadata fragment type: type = %u",
+				    (unsigned int) descriptor.type);
+				return -1;
+			}
+
+			offset += descriptor.encoded_size;
+		}
+	} catch (const std::bad_alloc&) {
+		ERR("Failed to allocate metadata fragment");
+		return -1;
+	}
+
+	if (offset != payload.size || packet.size != header.content_size) {
+		ERR("Metadata fragments don't match the announced packet size: content size = %" PRIu32
+		    ", decoded size = %zu",
+		    header.content_size,
+		    packet.size);
+		return -1;
+	}
+
+	return 0;
+}
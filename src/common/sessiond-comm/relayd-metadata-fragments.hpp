@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ */
+
+#ifndef LTTNG_RELAYD_METADATA_FRAGMENTS_H
+#define LTTNG_RELAYD_METADATA_FRAGMENTS_H
+
+#include <common/buffer-view.hpp>
+#include <common/dynamic-buffer.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Metadata packets sent with the RELAYD_SEND_METADATA_FRAGMENTS command are
+ * split in content-defined fragments: the fragment boundaries depend on the
+ * content of the metadata rather than on its position in the packet. Hence,
+ * the fragments of TSDL which is sent multiple times on a control connection
+ * (e.g. regenerated metadata, or the metadata of per-PID applications of a
+ * session) are identical and are only sent once; they are then referred to
+ * by their hash.
+ *
+ * The fragments that are sent are LZ4-compressed when it makes them smaller.
+ */
+
+namespace lttng {
+namespace relayd {
+
+/*
+ * Fragments known to both peers of a control connection. Both peers must
+ * apply the same sequence of additions so that their stores stay identical.
+ */
+class metadata_fragment_store {
+public:
+	/* Returns nullptr if no fragment with this hash is stored. */
+	const std::vector<char> *find(std::uint64_t hash) const;
+
+	/*
+	 * Does nothing if a fragment with the same hash is already stored.
+	 * Evicts the oldest fragments past LTTCOMM_RELAYD_METADATA_FRAGMENT_STORE_SIZE.
+	 */
+	void add(std::uint64_t hash, const char *data, std::size_t size);
+
+private:
+	std::unordered_map<std::uint64_t, std::vector<char>> _fragments;
+	std::deque<std::uint64_t> _insertion_order;
+	std::size_t _size = 0;
+};
+
+/*
+ * Append the payload of a RELAYD_SEND_METADATA_FRAGMENTS command to `payload`.
+ *
+ * Returns 0 on success, -1 on allocation failure. On failure, `store` no
+ * longer matches the store of the peer and the connection must be closed.
+ */
+int encode_metadata_packet(metadata_fragment_store& store,
+			   std::uint64_t stream_id,
+			   const struct lttng_buffer_view& packet,
+			   std::uint32_t padding_size,
+			   struct lttng_dynamic_buffer& payload);
+
+/*
+ * Decode the payload of a RELAYD_SEND_METADATA_FRAGMENTS command into
+ * `packet`, setting the stream id and padding size of the packet.
+ *
+ * Returns 0 on success, -1 if the payload is invalid or on allocation
+ * failure. On failure, the connection must be closed.
+ */
+int decode_metadata_packet(metadata_fragment_store& store,
+			   const struct lttng_buffer_view& payload,
+			   std::uint64_t& stream_id,
+			   std::uint32_t& padding_size,
+			   struct lttng_dynamic_buffer& packet);
+
+} /* namespace relayd */
+} /* namespace lttng */
+
+#endif /* LTTNG_RELAYD_METADATA_FRAGMENTS_H */
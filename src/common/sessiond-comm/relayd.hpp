@@ -22,7 +22,7 @@
 #include <stdint.h>
 
 #define RELAYD_VERSION_COMM_MAJOR VERSION_MAJOR
-#define RELAYD_VERSION_COMM_MINOR 14
+#define RELAYD_VERSION_COMM_MINOR 15
 
 #define RELAYD_COMM_LTTNG_HOST_NAME_MAX_2_4 64
 #define RELAYD_COMM_LTTNG_NAME_MAX_2_4	    255
@@ -120,6 +120,56 @@ struct lttcomm_relayd_metadata_payload {
 	char payload[];
 } LTTNG_PACKED;
 
+/*
+ * Largest fragment of a metadata packet sent with the
+ * RELAYD_SEND_METADATA_FRAGMENTS command.
+ */
+#define LTTCOMM_RELAYD_METADATA_FRAGMENT_MAX_SIZE (64 * 1024)
+
+/*
+ * Size of the metadata fragments stored by both peers of a control
+ * connection to resolve fragment references. Both peers evict the
+ * fragments in insertion order past this size, hence it is part of
+ * the protocol.
+ */
+#define LTTCOMM_RELAYD_METADATA_FRAGMENT_STORE_SIZE (2 * 1024 * 1024)
+
+enum lttcomm_relayd_metadata_fragment_type {
+	/* The fragment's content follows its descriptor. */
+	LTTCOMM_RELAYD_METADATA_FRAGMENT_TYPE_LITERAL = 0,
+	/* The fragment's content follows its descriptor as an LZ4 block. */
+	LTTCOMM_RELAYD_METADATA_FRAGMENT_TYPE_LITERAL_LZ4 = 1,
+	/* The fragment's content was previously sent on the connection. */
+	LTTCOMM_RELAYD_METADATA_FRAGMENT_TYPE_REFERENCE = 2,
+};
+
+/*
+ * Metadata packet sent as a sequence of fragments (RELAYD_SEND_METADATA_FRAGMENTS).
+ * The header is followed by `fragment_count` fragments, each made of a
+ * descriptor followed by `encoded_size` bytes.
+ *
+ * Literal fragments are added to the fragment store of both peers unless a
+ * fragment with the same hash is already stored.
+ */
+struct lttcomm_relayd_metadata_fragments_payload {
+	uint64_t stream_id;
+	uint32_t padding_size;
+	/* Size of the decoded metadata packet, excluding the padding. */
+	uint32_t content_size;
+	uint32_t fragment_count;
+	char fragments[];
+} LTTNG_PACKED;
+
+struct lttcomm_relayd_metadata_fragment {
+	/* enum lttcomm_relayd_metadata_fragment_type */
+	uint8_t type;
+	uint64_t hash;
+	/* Decoded size of the fragment. */
+	uint32_t size;
+	/* Size of the content following the descriptor, 0 for references. */
+	uint32_t encoded_size;
+} LTTNG_PACKED;
+
 /*
  * Used to indicate that a specific stream id can now be closed.
  */
@@ -339,6 +389,8 @@ struct lttcomm_relayd_trace_chunk_exists_reply {
 enum lttcomm_relayd_configuration_flag {
 	/* The relay daemon (2.12) is configured to allow clear operations. */
 	LTTCOMM_RELAYD_CONFIGURATION_FLAG_CLEAR_ALLOWED = (1 << 0),
+	/* The relay daemon accepts the RELAYD_SEND_METADATA_FRAGMENTS command. */
+	LTTCOMM_RELAYD_CONFIGURATION_FLAG_METADATA_FRAGMENTS = (1 << 1),
 };
 
 struct lttcomm_relayd_get_configuration {
@@ -566,3 +566,163 @@ int lttcomm_populate_sock_from_open_socket(struct lttcomm_sock *sock,
 end:
 	return ret;
 }
+
+static_assert(sizeof(lttcomm_session_msg::u) <= UINT16_MAX,
+	      "The command-specific fields must fit in a compact attribute");
+
+static int append_compact_attribute(struct lttng_dynamic_buffer *frame,
+				    enum lttcomm_session_compact_attribute_type type,
+				    const void *value,
+				    size_t length)
+{
+	struct lttcomm_session_compact_attribute attribute = {};
+
+	LTTNG_ASSERT(length <= UINT16_MAX);
+
+	attribute.type = (uint16_t) type;
+	attribute.length = (uint16_t) length;
+	if (lttng_dynamic_buffer_append(frame, &attribute, sizeof(attribute))) {
+		return -1;
+	}
+
+	return lttng_dynamic_buffer_append(frame, value, length);
+}
+
+int lttcomm_session_msg_to_compact(const struct lttcomm_session_msg *lsm,
+				   size_t payload_size,
+				   unsigned int fd_count,
+				   struct lttng_dynamic_buffer *frame)
+{
+	struct lttcomm_session_compact_msg header = {};
+	const size_t header_offset = frame->size;
+	const size_t session_name_len = strnlen(lsm->session.name, sizeof(lsm->session.name));
+	const char *command_fields = (const char *) &lsm->u;
+	size_t command_fields_len = sizeof(lsm->u);
+
+	LTTNG_ASSERT(payload_size <= LTTCOMM_SESSIOND_COMPACT_MAX_PAYLOAD_SIZE);
+
+	header.magic = LTTCOMM_SESSIOND_COMPACT_MAGIC;
+	header.cmd_type = lsm->cmd_type;
+	header.payload_size = (uint32_t) payload_size;
+	header.fd_count = fd_count;
+	if (lttng_dynamic_buffer_append(frame, &header, sizeof(header))) {
+		return -1;
+	}
+
+	if (session_name_len > 0 &&
+	    append_compact_attribute(frame,
+				     LTTCOMM_SESSION_COMPACT_ATTRIBUTE_SESSION_NAME,
+				     lsm->session.name,
+				     session_name_len)) {
+		return -1;
+	}
+
+	if (lsm->domain.type != 0 || lsm->domain.buf_type != 0 || lsm->domain.attr.pid != 0) {
+		struct lttcomm_session_compact_domain domain = {};
+
+		domain.type = (int32_t) lsm->domain.type;
+		domain.buf_type = (int32_t) lsm->domain.buf_type;
+		domain.pid = (int32_t) lsm->domain.attr.pid;
+		if (append_compact_attribute(frame,
+					     LTTCOMM_SESSION_COMPACT_ATTRIBUTE_DOMAIN,
+					     &domain,
+					     sizeof(domain))) {
+			return -1;
+		}
+	}
+
+	/* Only send the command-specific fields up to their last non-zero byte. */
+	while (command_fields_len > 0 && command_fields[command_fields_len - 1] == '\0') {
+		command_fields_len--;
+	}
+
+	if (command_fields_len > 0 &&
+	    append_compact_attribute(frame,
+				     LTTCOMM_SESSION_COMPACT_ATTRIBUTE_COMMAND_FIELDS,
+				     command_fields,
+				     command_fields_len)) {
+		return -1;
+	}
+
+	header.attributes_size = (uint32_t) (frame->size - header_offset - sizeof(header));
+	memcpy(frame->data + header_offset, &header, sizeof(header));
+	return 0;
+}
+
+int lttcomm_session_msg_from_compact(const struct lttcomm_session_compact_msg *header,
+				     const struct lttng_buffer_view *attributes,
+				     struct lttcomm_session_msg *lsm)
+{
+	size_t offset = 0;
+
+	memset(lsm, 0, sizeof(*lsm));
+	lsm->cmd_type = header->cmd_type;
+	lsm->fd_count = header->fd_count;
+
+	while (offset < attributes->size) {
+		struct lttcomm_session_compact_attribute attribute;
+
+		if (attributes->size - offset < sizeof(attribute)) {
+			ERR("Truncated compact client command attribute header");
+			return -1;
+		}
+
+		memcpy(&attribute, attributes->data + offset, sizeof(attribute));
+		offset += sizeof(attribute);
+		if (attribute.length > attributes->size - offset) {
+			ERR("Truncated compact client command attribute: type = %u, length = %u",
+			    (unsigned int) attribute.type,
+			    (unsigned int) attribute.length);
+			return -1;
+		}
+
+		const char *value = attributes->data + offset;
+
+		switch (attribute.type) {
+		case LTTCOMM_SESSION_COMPACT_ATTRIBUTE_SESSION_NAME:
+			/* Keep the null terminator. */
+			if (attribute.length >= sizeof(lsm->session.name)) {
+				ERR("Invalid session name length in compact client command: length = %u",
+				    (unsigned int) attribute.length);
+				return -1;
+			}
+
+			memcpy(lsm->session.name, value, attribute.length);
+			break;
+		case LTTCOMM_SESSION_COMPACT_ATTRIBUTE_DOMAIN:
+		{
+			struct lttcomm_session_compact_domain domain;
+
+			if (attribute.length != sizeof(domain)) {
+				ERR("Invalid domain length in compact client command: length = %u",
+				    (unsigned int) attribute.length);
+				return -1;
+			}
+
+			memcpy(&domain, value, sizeof(domain));
+			lsm->domain.type = (enum lttng_domain_type) domain.type;
+			lsm->domain.buf_type = (enum lttng_buffer_type) domain.buf_type;
+			lsm->domain.attr.pid = (pid_t) domain.pid;
+			break;
+		}
+		case LTTCOMM_SESSION_COMPACT_ATTRIBUTE_COMMAND_FIELDS:
+			if (attribute.length > sizeof(lsm->u)) {
+				ERR("Invalid command fields length in compact client command: length = %u",
+				    (unsigned int) attribute.length);
+				return -1;
+			}
+
+			memcpy(&lsm->u, value, attribute.length);
+			break;
+		default:
+			/* Attribute added by a newer client. */
+			DBG("Ignoring unknown compact client command attribute: type = %u",
+			    (unsigned int) attribute.type);
+			break;
+		}
+
+		offset += attribute.length;
+	}
+
+	return 0;
+}
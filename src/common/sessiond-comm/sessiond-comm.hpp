@@ -17,9 +17,11 @@
 #include "inet.hpp"
 #include "inet6.hpp"
 
+#include <common/buffer-view.hpp>
 #include <common/compat/socket.hpp>
 #include <common/compiler.hpp>
 #include <common/defaults.hpp>
+#include <common/dynamic-buffer.hpp>
 #include <common/macros.hpp>
 #include <common/optional.hpp>
 #include <common/unix.hpp>
@@ -96,6 +98,11 @@ enum lttcomm_sessiond_command {
 	LTTCOMM_SESSIOND_COMMAND_LIST_TRIGGERS,
 	LTTCOMM_SESSIOND_COMMAND_EXECUTE_ERROR_QUERY,
 	LTTCOMM_SESSIOND_COMMAND_KERNEL_TRACER_STATUS,
+	LTTCOMM_SESSIOND_COMMAND_LIST_EVENTS_PAGE,
+	LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_ADD_INCLUDE_VALUES,
+	LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_REMOVE_INCLUDE_VALUES,
+	LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_SET_INCLUDE_VALUES,
+	LTTCOMM_SESSIOND_COMMAND_NEGOTIATE_COMPACT_FRAMING,
 	LTTCOMM_SESSIOND_COMMAND_MAX,
 };
 
@@ -195,6 +202,16 @@ static inline const char *lttcomm_sessiond_command_str(enum lttcomm_sessiond_com
 		return "EXECUTE_ERROR_QUERY";
 	case LTTCOMM_SESSIOND_COMMAND_KERNEL_TRACER_STATUS:
 		return "KERNEL_TRACER_STATUS";
+	case LTTCOMM_SESSIOND_COMMAND_LIST_EVENTS_PAGE:
+		return "LIST_EVENTS_PAGE";
+	case LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_ADD_INCLUDE_VALUES:
+		return "PROCESS_ATTR_TRACKER_ADD_INCLUDE_VALUES";
+	case LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_REMOVE_INCLUDE_VALUES:
+		return "PROCESS_ATTR_TRACKER_REMOVE_INCLUDE_VALUES";
+	case LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_SET_INCLUDE_VALUES:
+		return "PROCESS_ATTR_TRACKER_SET_INCLUDE_VALUES";
+	case LTTCOMM_SESSIOND_COMMAND_NEGOTIATE_COMPACT_FRAMING:
+		return "NEGOTIATE_COMPACT_FRAMING";
 	default:
 		abort();
 	}
@@ -231,6 +248,12 @@ enum lttcomm_relayd_command {
 	RELAYD_TRACE_CHUNK_EXISTS = 21,
 	/* Get the current configuration of a relayd peer (2.12+) */
 	RELAYD_GET_CONFIGURATION = 22,
+	/*
+	 * Send a metadata packet as deduplicated and compressed fragments; only
+	 * sent to a relay daemon advertising
+	 * LTTCOMM_RELAYD_CONFIGURATION_FLAG_METADATA_FRAGMENTS.
+	 */
+	RELAYD_SEND_METADATA_FRAGMENTS = 23,
 
 	/* Feature branch specific commands start at 10000. */
 };
@@ -282,6 +305,8 @@ static inline const char *lttcomm_relayd_command_str(lttcomm_relayd_command cmd)
 		return "RELAYD_TRACE_CHUNK_EXISTS";
 	case RELAYD_GET_CONFIGURATION:
 		return "RELAYD_GET_CONFIGURATION";
+	case RELAYD_SEND_METADATA_FRAGMENTS:
+		return "RELAYD_SEND_METADATA_FRAGMENTS";
 	default:
 		abort();
 	}
@@ -390,6 +415,19 @@ struct lttcomm_relayd_sock {
 	struct lttcomm_sock sock;
 	uint32_t major;
 	uint32_t minor;
+	/* Sequence number tagging the next command sent on the socket. */
+	uint64_t next_command_seq_num;
+	/*
+	 * Number of generic replies to pipelined commands that have not been
+	 * received yet. They precede any other reply on the socket.
+	 */
+	uint32_t pending_reply_count;
+	/*
+	 * Number of replies to commands whose result is no longer awaited
+	 * since sending the rest of their batch failed. They precede the
+	 * pending replies and are discarded.
+	 */
+	uint32_t abandoned_reply_count;
 };
 
 struct lttcomm_net_family {
@@ -447,6 +485,9 @@ struct lttcomm_session_msg {
 		/* List */
 		struct {
 			char channel_name[LTTNG_SYMBOL_NAME_LEN];
+			/* Window of the listing, used by LIST_EVENTS_PAGE. */
+			uint32_t offset;
+			uint32_t max_count;
 		} LTTNG_PACKED list;
 		struct lttng_calibrate calibrate;
 		/* Used by the set_consumer_url and used by create_session also call */
@@ -487,6 +528,15 @@ struct lttcomm_session_msg {
 			 */
 			uint32_t name_len;
 		} LTTNG_PACKED process_attr_tracker_add_remove_include_value;
+		struct {
+			/* enum lttng_process_attr */
+			int32_t process_attr;
+			/*
+			 * A serialized set of process attribute values of
+			 * length 'values_len' follows.
+			 */
+			uint32_t values_len;
+		} LTTNG_PACKED process_attr_tracker_update_include_values;
 		struct {
 			/* enum lttng_process_attr */
 			int32_t process_attr;
@@ -537,6 +587,102 @@ struct lttcomm_session_msg {
 	uint32_t fd_count;
 } LTTNG_PACKED;
 
+/*
+ * Compact framing of the client commands.
+ *
+ * A client negotiates the compact framing of a connection by sending a
+ * NEGOTIATE_COMPACT_FRAMING command in the legacy framing (a complete
+ * lttcomm_session_msg). Session daemons which don't support it reply
+ * LTTNG_ERR_UND and close the connection, as for any command.
+ *
+ * Once the session daemon replies LTTNG_OK, the connection stays open and
+ * every subsequent command is sent as an lttcomm_session_compact_msg header
+ * followed by its attributes, its payload (the data that follows the
+ * lttcomm_session_msg in the legacy framing) and its file descriptors. The
+ * replies are unchanged.
+ *
+ * The commands of a connection are processed one at a time, in order, and
+ * the payload of a command is received by the worker processing it. Hence, a
+ * client may send several commands before reading their replies, which are
+ * sent in the same order.
+ *
+ * The largest commands register events and triggers, of which the filter
+ * expression and bytecode are bounded by LTTNG_FILTER_MAX_LEN. A command of
+ * which the payload exceeds LTTCOMM_SESSIOND_COMPACT_MAX_PAYLOAD_SIZE is sent
+ * on its own connection, in the legacy framing.
+ *
+ * The reply to a session destruction or clearing is deferred until the
+ * operation completes: such a command is the last one of a connection, which
+ * the session daemon closes after the reply.
+ */
+#define LTTCOMM_SESSIOND_COMPACT_MAGIC		     UINT32_C(0x4C434D53)
+#define LTTCOMM_SESSIOND_COMPACT_MAX_ATTRIBUTES_SIZE 65536
+#define LTTCOMM_SESSIOND_COMPACT_MAX_PAYLOAD_SIZE    (1024 * 1024)
+
+struct lttcomm_session_compact_msg {
+	/*
+	 * LTTCOMM_SESSIOND_COMPACT_MAGIC, which is never a valid command type
+	 * and thus distinguishes a compact header from an lttcomm_session_msg.
+	 */
+	uint32_t magic;
+	uint32_t cmd_type; /* enum lttcomm_sessiond_command */
+	/* Size of the attributes following this header. */
+	uint32_t attributes_size;
+	/* Size of the payload following the attributes. */
+	uint32_t payload_size;
+	/* Count of fds sent after the payload. */
+	uint32_t fd_count;
+} LTTNG_PACKED;
+
+/*
+ * The attributes of a command are a sequence of type-length-value entries.
+ * An omitted attribute is equivalent to zeroed fields of the legacy
+ * lttcomm_session_msg. Unknown attributes are ignored.
+ */
+enum lttcomm_session_compact_attribute_type {
+	/* Name of the target session, without its null terminator. */
+	LTTCOMM_SESSION_COMPACT_ATTRIBUTE_SESSION_NAME = 1,
+	/* A struct lttcomm_session_compact_domain. */
+	LTTCOMM_SESSION_COMPACT_ATTRIBUTE_DOMAIN = 2,
+	/*
+	 * Leading bytes of the command-specific fields (`u`) of the legacy
+	 * lttcomm_session_msg; the remaining bytes are zero.
+	 */
+	LTTCOMM_SESSION_COMPACT_ATTRIBUTE_COMMAND_FIELDS = 3,
+};
+
+struct lttcomm_session_compact_attribute {
+	uint16_t type; /* enum lttcomm_session_compact_attribute_type */
+	uint16_t length; /* Length of the value following this header. */
+} LTTNG_PACKED;
+
+struct lttcomm_session_compact_domain {
+	int32_t type; /* enum lttng_domain_type */
+	int32_t buf_type; /* enum lttng_buffer_type */
+	int32_t pid;
+} LTTNG_PACKED;
+
+/*
+ * Append the compact header and attributes of the command `lsm`, followed by
+ * a payload of `payload_size` bytes and `fd_count` fds, to `frame`.
+ *
+ * Returns 0 on success, -1 on allocation failure.
+ */
+int lttcomm_session_msg_to_compact(const struct lttcomm_session_msg *lsm,
+				   size_t payload_size,
+				   unsigned int fd_count,
+				   struct lttng_dynamic_buffer *frame);
+
+/*
+ * Rebuild the lttcomm_session_msg of a command from its compact header and
+ * attributes.
+ *
+ * Returns 0 on success, -1 if the attributes are invalid.
+ */
+int lttcomm_session_msg_from_compact(const struct lttcomm_session_compact_msg *header,
+				     const struct lttng_buffer_view *attributes,
+				     struct lttcomm_session_msg *lsm);
+
 #define LTTNG_FILTER_MAX_LEN		 65536
 #define LTTNG_SESSION_DESCRIPTOR_MAX_LEN 65536
 
@@ -632,6 +778,12 @@ struct lttcomm_lttng_output_id {
 	uint32_t id;
 } LTTNG_PACKED;
 
+/*
+ * Maximal number of channels created by a single ASK_CHANNELS_CREATION
+ * or GET_CHANNELS consumer command.
+ */
+#define LTTCOMM_CONSUMER_MAX_CHANNEL_BATCH 64
+
 /*
  * lttcomm_consumer_msg is the message sent from sessiond to consumerd
  * to either add a channel, add a stream, update a stream, or stop
@@ -732,6 +884,14 @@ struct lttcomm_consumer_msg {
 		struct {
 			uint64_t key;
 		} LTTNG_PACKED get_channel;
+		struct {
+			/* Number of ASK_CHANNEL_CREATION messages following this message. */
+			uint32_t count;
+		} LTTNG_PACKED ask_channels;
+		struct {
+			/* Number of channel keys (uint64_t) following this message. */
+			uint32_t count;
+		} LTTNG_PACKED get_channels;
 		struct {
 			uint64_t key;
 		} LTTNG_PACKED destroy_channel;
@@ -870,6 +1030,19 @@ struct lttcomm_consumer_status_channel {
 	unsigned int stream_count;
 } LTTNG_PACKED;
 
+/* Sub-buffers consumed by the data thread of a consumer daemon. */
+struct lttcomm_consumer_drain_statistics {
+	/* Wake-ups during which at least one sub-buffer was consumed. */
+	uint64_t wakeups;
+	uint64_t packets;
+	uint64_t bytes;
+	/* Largest number of sub-buffers and bytes consumed during a wake-up. */
+	uint64_t max_packets_per_wakeup;
+	uint64_t max_bytes_per_wakeup;
+	/* Stream reads stopped by a budget. */
+	uint64_t budget_exhaustions;
+} LTTNG_PACKED;
+
 struct lttcomm_consumer_close_trace_chunk_reply {
 	enum lttcomm_return_code ret_code;
 	uint32_t path_length;
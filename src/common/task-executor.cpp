@@ -8,7 +8,8 @@
 #include <common/task-executor.hpp>
 #include <common/urcu.hpp>
 
-lttng::scheduling::task_executor::task_executor(scheduler& scheduler) :
+lttng::scheduling::task_executor::task_executor(scheduler& scheduler,
+						 unsigned int worker_count) :
 	_scheduler(scheduler), _wake_eventfd(true)
 {
 	_scheduler.add_task_scheduled_callback(
@@ -49,6 +50,12 @@ lttng::scheduling::task_executor::task_executor(scheduler& scheduler) :
 			    }
 		    });
 
+	if (worker_count > 1) {
+		for (unsigned int i = 0; i < worker_count; i++) {
+			_workers.emplace_back(&task_executor::_run_worker, this, i);
+		}
+	}
+
 	_thread = std::thread(&task_executor::_run, this);
 	_launch_waiter.wait();
 }
@@ -73,7 +80,10 @@ void lttng::scheduling::task_executor::_run() noexcept
 	while (_is_active.load()) {
 		_poller.poll(lttng::poller::timeout_type::WAIT_FOREVER);
 
-		const auto next_task_delay = _scheduler.tick(std::chrono::steady_clock::now());
+		const auto current_time = std::chrono::steady_clock::now();
+		const auto next_task_delay = _workers.empty() ?
+			_scheduler.tick(current_time) :
+			_dispatch_expired_tasks(current_time);
 		if (next_task_delay) {
 			/* Arm the timerfd to wake up when the next task is due. */
 			_wake_timerfd.settime(*next_task_delay);
@@ -83,6 +93,62 @@ void lttng::scheduling::task_executor::_run() noexcept
 	DBG_FMT("Task executor thread exiting");
 }
 
+nonstd::optional<lttng::scheduling::duration_ns>
+lttng::scheduling::task_executor::_dispatch_expired_tasks(absolute_time current_time)
+{
+	const auto next_task_delay = _scheduler.take_expired_tasks(current_time, _dispatch_buffer);
+
+	if (_dispatch_buffer.empty()) {
+		return next_task_delay;
+	}
+
+	{
+		const std::lock_guard<std::mutex> lock(_expired_tasks_mutex);
+
+		for (auto& task_to_run : _dispatch_buffer) {
+			_expired_tasks.push_back({ std::move(task_to_run), current_time });
+		}
+	}
+
+	_dispatch_buffer.clear();
+	_expired_tasks_cv.notify_all();
+	return next_task_delay;
+}
+
+void lttng::scheduling::task_executor::_run_worker(unsigned int worker_id) noexcept
+{
+	const lttng::urcu::scoped_thread_registration rcu_thread_registration;
+
+	logger_set_thread_name("Timer task worker", true);
+	DBG_FMT("Task executor worker started: id={}", worker_id);
+
+	while (true) {
+		expired_task task;
+
+		{
+			std::unique_lock<std::mutex> lock(_expired_tasks_mutex);
+
+			_expired_tasks_cv.wait(lock, [this]() {
+				return _workers_quit || !_expired_tasks.empty();
+			});
+			if (_workers_quit) {
+				break;
+			}
+
+			task = std::move(_expired_tasks.front());
+			_expired_tasks.pop_front();
+		}
+
+		/*
+		 * A periodic task is only rescheduled once it has run; it can't be run
+		 * concurrently by two workers.
+		 */
+		_scheduler.run_expired_task(std::move(task.task_to_run), task.tick_time);
+	}
+
+	DBG_FMT("Task executor worker exiting: id={}", worker_id);
+}
+
 void lttng::scheduling::task_executor::_wake() noexcept
 {
 	if (_thread.get_id() == std::this_thread::get_id()) {
@@ -106,4 +172,19 @@ void lttng::scheduling::task_executor::stop()
 	/* Wake the thread to make sure it sees it should exit. */
 	_wake();
 	_thread.join();
+
+	{
+		const std::lock_guard<std::mutex> lock(_expired_tasks_mutex);
+
+		/* Tasks that were not run yet are dropped. */
+		_workers_quit = true;
+		_expired_tasks.clear();
+	}
+
+	_expired_tasks_cv.notify_all();
+	for (auto& worker : _workers) {
+		worker.join();
+	}
+
+	_workers.clear();
 }
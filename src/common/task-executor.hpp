@@ -14,14 +14,23 @@
 #include <common/waiter.hpp>
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <thread>
 #include <unistd.h>
+#include <vector>
 
 namespace lttng {
 namespace scheduling {
 class task_executor final {
 public:
-	explicit task_executor(scheduler& scheduler);
+	/*
+	 * With a single worker, the expired tasks are run by the executor's thread. Otherwise,
+	 * they are dispatched to a pool of `worker_count` threads so that a long-running task
+	 * doesn't delay the other expired tasks.
+	 */
+	explicit task_executor(scheduler& scheduler, unsigned int worker_count = 1);
 	~task_executor();
 
 	task_executor(const task_executor&) = delete;
@@ -38,8 +47,24 @@ private:
 	/* Wake up the thread (e.g., when a new task is scheduled) */
 	void _wake() noexcept;
 
+	/* Dispatch the expired tasks to the workers and return the time until the next task. */
+	nonstd::optional<duration_ns> _dispatch_expired_tasks(absolute_time current_time);
+	void _run_worker(unsigned int worker_id) noexcept;
+
+	struct expired_task {
+		task::sptr task_to_run;
+		absolute_time tick_time;
+	};
+
 	std::thread _thread;
 	scheduler& _scheduler;
+	std::vector<std::thread> _workers;
+	std::mutex _expired_tasks_mutex;
+	std::condition_variable _expired_tasks_cv;
+	std::deque<expired_task> _expired_tasks;
+	bool _workers_quit = false;
+	/* Storage reused across dispatches. */
+	std::vector<task::sptr> _dispatch_buffer;
 	std::atomic<bool> _is_active{ false };
 	lttng::eventfd _wake_eventfd;
 	lttng::timerfd _wake_timerfd;
@@ -67,6 +67,14 @@ struct chunk_credentials {
 	bool use_current_user;
 	struct lttng_credentials user;
 };
+
+/* File opened ahead of its use by lttng_trace_chunk_prepare_files(). */
+struct prepared_file {
+	char *path;
+	int fd;
+	int flags;
+	mode_t mode;
+};
 } /* namespace */
 
 /*
@@ -91,6 +99,11 @@ struct lttng_trace_chunk {
 	 * Array of paths (char *).
 	 */
 	struct lttng_dynamic_pointer_array files;
+	/*
+	 * Files created ahead of their use, not yet part of `files`.
+	 * Elements are of type 'struct prepared_file'.
+	 */
+	struct lttng_dynamic_array prepared_files;
 	/* Is contained within an lttng_trace_chunk_registry_element? */
 	bool in_registry_element;
 	bool name_overridden;
@@ -347,12 +360,25 @@ error:
 	return nullptr;
 }
 
+static void prepared_file_destroy(void *ptr)
+{
+	auto *file = static_cast<struct prepared_file *>(ptr);
+
+	if (file->fd >= 0 && close(file->fd)) {
+		PERROR("Failed to close prepared trace chunk file \"%s\"", file->path);
+	}
+
+	free(file->path);
+}
+
 static void lttng_trace_chunk_init(struct lttng_trace_chunk *chunk)
 {
 	urcu_ref_init(&chunk->ref);
 	pthread_mutex_init(&chunk->lock, nullptr);
 	lttng_dynamic_pointer_array_init(&chunk->top_level_directories, free);
 	lttng_dynamic_pointer_array_init(&chunk->files, free);
+	lttng_dynamic_array_init(
+		&chunk->prepared_files, sizeof(struct prepared_file), prepared_file_destroy);
 }
 
 static void lttng_trace_chunk_fini(struct lttng_trace_chunk *chunk)
@@ -371,6 +397,7 @@ static void lttng_trace_chunk_fini(struct lttng_trace_chunk *chunk)
 	chunk->path = nullptr;
 	lttng_dynamic_pointer_array_reset(&chunk->top_level_directories);
 	lttng_dynamic_pointer_array_reset(&chunk->files);
+	lttng_dynamic_array_reset(&chunk->prepared_files);
 	pthread_mutex_destroy(&chunk->lock);
 }
 
@@ -1289,6 +1316,168 @@ static void lttng_trace_chunk_remove_file(struct lttng_trace_chunk *chunk, const
 	LTTNG_ASSERT(!ret);
 }
 
+/*
+ * Take the file descriptor of a prepared file matching `path`, `flags` and
+ * `mode`. Returns -1 if no such file was prepared.
+ */
+static int
+take_prepared_file(struct lttng_trace_chunk *chunk, const char *path, int flags, mode_t mode)
+{
+	size_t i;
+
+	for (i = 0; i < lttng_dynamic_array_get_count(&chunk->prepared_files); i++) {
+		auto *file = static_cast<struct prepared_file *>(
+			lttng_dynamic_array_get_element(&chunk->prepared_files, i));
+		const int fd = file->fd;
+		int ret;
+
+		if (strcmp(file->path, path) != 0 || file->flags != flags || file->mode != mode) {
+			continue;
+		}
+
+		DBG("Using prepared trace chunk file \"%s\"", path);
+		file->fd = -1;
+		ret = lttng_dynamic_array_remove_element(&chunk->prepared_files, i);
+		LTTNG_ASSERT(!ret);
+		return fd;
+	}
+
+	return -1;
+}
+
+enum lttng_trace_chunk_status lttng_trace_chunk_prepare_files(struct lttng_trace_chunk *chunk,
+							      const char *directory,
+							      const char *const *file_paths,
+							      unsigned int file_count,
+							      int flags,
+							      mode_t mode)
+{
+	int ret;
+	unsigned int i;
+	enum lttng_trace_chunk_status status = LTTNG_TRACE_CHUNK_STATUS_OK;
+	const size_t directory_len = strlen(directory);
+	const char **file_names = nullptr;
+	int *fds = nullptr;
+
+	if (file_count == 0) {
+		return LTTNG_TRACE_CHUNK_STATUS_OK;
+	}
+
+	DBG("Preparing %u trace chunk files in directory \"%s\"", file_count, directory);
+	pthread_mutex_lock(&chunk->lock);
+	if (!chunk->credentials.is_set || !chunk->chunk_directory || chunk->fd_tracker) {
+		ERR("Attempted to prepare trace chunk files in directory \"%s\" of a chunk that can't create them",
+		    directory);
+		status = LTTNG_TRACE_CHUNK_STATUS_INVALID_OPERATION;
+		goto end;
+	}
+
+	file_names = calloc<const char *>(file_count);
+	fds = calloc<int>(file_count);
+	if (!file_names || !fds) {
+		ERR("Failed to allocate trace chunk file preparation arguments");
+		status = LTTNG_TRACE_CHUNK_STATUS_ERROR;
+		goto end;
+	}
+
+	/* The files are opened relative to `directory`. */
+	for (i = 0; i < file_count; i++) {
+		const char *file_name = file_paths[i];
+
+		if (strncmp(file_name, directory, directory_len) != 0) {
+			ERR("Trace chunk file \"%s\" is not within directory \"%s\"",
+			    file_name,
+			    directory);
+			status = LTTNG_TRACE_CHUNK_STATUS_INVALID_ARGUMENT;
+			goto end;
+		}
+
+		file_name += directory_len;
+		while (*file_name == '/') {
+			file_name++;
+		}
+
+		file_names[i] = file_name;
+	}
+
+	ret = lttng_directory_handle_create_subdirectory_recursive_open_files_as_user(
+		chunk->chunk_directory,
+		directory_len ? directory : nullptr,
+		DIR_CREATION_MODE,
+		file_names,
+		file_count,
+		flags,
+		mode,
+		chunk->credentials.value.use_current_user ? nullptr :
+							    &chunk->credentials.value.user,
+		fds);
+	if (ret) {
+		PERROR("Failed to prepare trace chunk files in directory \"%s\"", directory);
+		status = LTTNG_TRACE_CHUNK_STATUS_ERROR;
+		goto end;
+	}
+
+	for (i = 0; i < file_count; i++) {
+		struct prepared_file file = {
+			.path = strdup(file_paths[i]),
+			.fd = fds[i],
+			.flags = flags,
+			.mode = mode,
+		};
+
+		if (!file.path ||
+		    lttng_dynamic_array_add_element(&chunk->prepared_files, &file)) {
+			ERR("Failed to keep prepared trace chunk file \"%s\"", file_paths[i]);
+			/* Remaining files are opened through a regular open. */
+			free(file.path);
+			for (; i < file_count; i++) {
+				if (close(fds[i])) {
+					PERROR("Failed to close prepared trace chunk file");
+				}
+			}
+
+			status = LTTNG_TRACE_CHUNK_STATUS_ERROR;
+			break;
+		}
+	}
+end:
+	pthread_mutex_unlock(&chunk->lock);
+	free(file_names);
+	free(fds);
+	return status;
+}
+
+/*
+ * Remove the prepared files that were never used: they would otherwise be left
+ * as empty files in the chunk.
+ */
+static void lttng_trace_chunk_remove_prepared_files(struct lttng_trace_chunk *chunk)
+{
+	size_t i;
+
+	if (!chunk->chunk_directory) {
+		return;
+	}
+
+	for (i = 0; i < lttng_dynamic_array_get_count(&chunk->prepared_files); i++) {
+		const auto *file = static_cast<const struct prepared_file *>(
+			lttng_dynamic_array_get_element(&chunk->prepared_files, i));
+		const int ret = lttng_directory_handle_unlink_file_as_user(
+			chunk->chunk_directory,
+			file->path,
+			chunk->credentials.value.use_current_user ?
+				nullptr :
+				&chunk->credentials.value.user);
+
+		if (ret) {
+			PERROR("Failed to remove unused prepared trace chunk file \"%s\"",
+			       file->path);
+		}
+	}
+
+	lttng_dynamic_array_clear(&chunk->prepared_files);
+}
+
 static enum lttng_trace_chunk_status
 _lttng_trace_chunk_open_fs_handle_locked(struct lttng_trace_chunk *chunk,
 					 const char *file_path,
@@ -1327,13 +1516,17 @@ _lttng_trace_chunk_open_fs_handle_locked(struct lttng_trace_chunk *chunk,
 			chunk->fd_tracker, chunk->chunk_directory, file_path, flags, &mode);
 		ret = *out_handle ? 0 : -1;
 	} else {
-		ret = lttng_directory_handle_open_file_as_user(
-			chunk->chunk_directory,
-			file_path,
-			flags,
-			mode,
-			chunk->credentials.value.use_current_user ? nullptr :
-								    &chunk->credentials.value.user);
+		ret = take_prepared_file(chunk, file_path, flags, mode);
+		if (ret < 0) {
+			ret = lttng_directory_handle_open_file_as_user(
+				chunk->chunk_directory,
+				file_path,
+				flags,
+				mode,
+				chunk->credentials.value.use_current_user ?
+					nullptr :
+					&chunk->credentials.value.user);
+		}
 		if (ret >= 0) {
 			*out_handle =
 				fs_handle_untracked_create(chunk->chunk_directory, file_path, ret);
@@ -1794,6 +1987,7 @@ static void lttng_trace_chunk_release(struct urcu_ref *ref)
 {
 	struct lttng_trace_chunk *chunk = lttng::utils::container_of(ref, &lttng_trace_chunk::ref);
 
+	lttng_trace_chunk_remove_prepared_files(chunk);
 	if (chunk->close_command.is_set) {
 		chunk_command func =
 			close_command_get_post_release_func(chunk->close_command.value);
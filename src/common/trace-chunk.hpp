@@ -154,6 +154,25 @@ enum lttng_trace_chunk_status lttng_trace_chunk_open_fs_handle(struct lttng_trac
 							       struct fs_handle **out_handle,
 							       bool expect_no_file);
 
+/*
+ * Create the `file_count` files of `file_paths`, which are all within
+ * `directory`, in as few exchanges with the run-as workers as possible.
+ * `directory` is created if it doesn't exist.
+ *
+ * The files are kept open by the chunk and handed out by the next
+ * lttng_trace_chunk_open_file() or lttng_trace_chunk_open_fs_handle() of the
+ * same path, flags and mode. The prepared files that are never opened are
+ * removed when the chunk is released.
+ *
+ * Not supported by chunks using an fd-tracker.
+ */
+enum lttng_trace_chunk_status lttng_trace_chunk_prepare_files(struct lttng_trace_chunk *chunk,
+							      const char *directory,
+							      const char *const *file_paths,
+							      unsigned int file_count,
+							      int flags,
+							      mode_t mode);
+
 int lttng_trace_chunk_unlink_file(struct lttng_trace_chunk *chunk, const char *filename);
 
 enum lttng_trace_chunk_status
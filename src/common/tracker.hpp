@@ -35,8 +35,6 @@ struct lttng_process_attr_values {
 
 const char *lttng_process_attr_to_string(enum lttng_process_attr process_attr);
 
-struct lttng_process_attr_values *lttng_process_attr_values_create();
-
 /* Prefixed with '_' since the name conflicts with a public API. */
 unsigned int _lttng_process_attr_values_get_count(const struct lttng_process_attr_values *values);
 
@@ -52,8 +50,6 @@ ssize_t lttng_process_attr_values_create_from_buffer(enum lttng_domain_type doma
 						     const struct lttng_buffer_view *buffer_view,
 						     struct lttng_process_attr_values **_values);
 
-void lttng_process_attr_values_destroy(struct lttng_process_attr_values *values);
-
 struct process_attr_value *process_attr_value_copy(const struct process_attr_value *value);
 
 unsigned long process_attr_value_hash(const struct process_attr_value *a);
@@ -46,6 +46,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <urcu/list.h>
+#include <vector>
 
 #define INT_MAX_STR_LEN 12 /* includes \0 */
 
@@ -746,7 +747,7 @@ static int flush_channel(uint64_t chan_key)
 	 * short-lived app is traced in per-pid mode.
 	 */
 	if (channel->monitor_timer_task) {
-		channel->monitor_timer_task->run(std::chrono::steady_clock::now());
+		consumer_timer_monitor_sample(channel);
 	}
 error:
 	return ret;
@@ -1456,6 +1457,242 @@ end:
 	return ret_code;
 }
 
+/*
+ * Create a channel, with its streams and timers, from an ASK_CHANNEL_CREATION
+ * message and add it to the internal state. The created streams must ONLY be
+ * sent once the GET_CHANNEL command is received.
+ *
+ * Return the channel on success or else nullptr.
+ */
+static struct lttng_consumer_channel *create_channel(struct lttng_consumer_local_data *ctx,
+						     const struct lttcomm_consumer_msg& msg)
+{
+	int ret_ask_channel, ret_add_channel;
+	struct lttng_consumer_channel *channel;
+	struct lttng_ust_ctl_consumer_channel_attr attr;
+	const uint64_t chunk_id = msg.u.ask_channel.chunk_id.value;
+	const struct lttng_credentials buffer_credentials = {
+		.uid = LTTNG_OPTIONAL_INIT_VALUE(msg.u.ask_channel.buffer_credentials.uid),
+		.gid = LTTNG_OPTIONAL_INIT_VALUE(msg.u.ask_channel.buffer_credentials.gid),
+	};
+
+	/* Create a plain object and reserve a channel key. */
+	channel = consumer_allocate_channel(msg.u.ask_channel.key,
+					    msg.u.ask_channel.session_id,
+					    msg.u.ask_channel.chunk_id.is_set ? &chunk_id : nullptr,
+					    msg.u.ask_channel.pathname,
+					    msg.u.ask_channel.name,
+					    msg.u.ask_channel.relayd_id,
+					    (enum lttng_event_output) msg.u.ask_channel.output,
+					    msg.u.ask_channel.tracefile_size,
+					    msg.u.ask_channel.tracefile_count,
+					    msg.u.ask_channel.session_id_per_pid,
+					    msg.u.ask_channel.monitor,
+					    msg.u.ask_channel.live_timer_interval,
+					    msg.u.ask_channel.is_live,
+					    msg.u.ask_channel.root_shm_path,
+					    msg.u.ask_channel.shm_path);
+	if (!channel) {
+		goto error;
+	}
+
+	LTTNG_OPTIONAL_SET(&channel->buffer_credentials, buffer_credentials);
+	channel->output_files_scheduler = &ctx->output_files_scheduler;
+
+	/*
+	 * Assign UST application UID to the channel. This value is ignored for
+	 * per PID buffers. This is specific to UST thus setting this after the
+	 * allocation.
+	 */
+	channel->ust_app_uid = msg.u.ask_channel.ust_app_uid;
+
+	/* Build channel attributes from received message. */
+	attr.subbuf_size = msg.u.ask_channel.subbuf_size;
+	attr.num_subbuf = msg.u.ask_channel.num_subbuf;
+	attr.overwrite = msg.u.ask_channel.overwrite;
+	attr.switch_timer_interval = msg.u.ask_channel.switch_timer_interval;
+	attr.read_timer_interval = msg.u.ask_channel.read_timer_interval;
+	attr.chan_id = msg.u.ask_channel.chan_id;
+	memcpy(attr.uuid, msg.u.ask_channel.uuid, sizeof(attr.uuid));
+	attr.blocking_timeout = msg.u.ask_channel.blocking_timeout;
+
+	/* Match channel buffer type to the UST abi. */
+	switch (msg.u.ask_channel.output) {
+	case LTTNG_EVENT_MMAP:
+	default:
+		attr.output = LTTNG_UST_ABI_MMAP;
+		break;
+	}
+
+	/* Translate and save channel type. */
+	switch (msg.u.ask_channel.type) {
+	case LTTNG_UST_ABI_CHAN_PER_CPU:
+		/* fall-through */
+	case LTTNG_UST_ABI_CHAN_PER_CHANNEL:
+
+		if (msg.u.ask_channel.type == LTTNG_UST_ABI_CHAN_PER_CPU) {
+			channel->type = CONSUMER_CHANNEL_TYPE_DATA_PER_CPU;
+			attr.type = LTTNG_UST_ABI_CHAN_PER_CPU;
+		} else {
+			channel->type = CONSUMER_CHANNEL_TYPE_DATA_PER_CHANNEL;
+			attr.type = LTTNG_UST_ABI_CHAN_PER_CHANNEL;
+		}
+
+		/*
+		 * Set refcount to 1 for owner. Below, we will
+		 * pass ownership to the
+		 * consumer_thread_channel_poll() thread.
+		 */
+		channel->refcount = 1;
+		break;
+	case LTTNG_UST_ABI_CHAN_METADATA:
+		channel->type = CONSUMER_CHANNEL_TYPE_METADATA;
+		attr.type = LTTNG_UST_ABI_CHAN_METADATA;
+		break;
+	default:
+		abort();
+	};
+
+	health_code_update();
+
+	ret_ask_channel = ask_channel(ctx, channel, &attr);
+	if (ret_ask_channel < 0) {
+		goto error;
+	}
+
+	if (msg.u.ask_channel.type == LTTNG_UST_ABI_CHAN_METADATA) {
+		int ret_allocate;
+
+		ret_allocate = consumer_metadata_cache_allocate(channel);
+		if (ret_allocate < 0) {
+			ERR("Allocating metadata cache");
+			goto error;
+		}
+
+		consumer_timer_switch_start(channel,
+					    attr.switch_timer_interval,
+					    ctx->metadata_socket,
+					    ctx->consumer_error_socket,
+					    ctx->timer_task_scheduler);
+	} else {
+		int monitor_start_ret;
+
+		consumer_timer_live_start(channel,
+					  msg.u.ask_channel.live_timer_interval,
+					  ctx->timer_task_scheduler);
+		monitor_start_ret = consumer_timer_monitor_start(
+			channel,
+			msg.u.ask_channel.monitor_timer_interval,
+			ctx->timer_task_scheduler);
+		if (monitor_start_ret < 0) {
+			ERR("Starting channel monitoring timer failed");
+			goto error;
+		}
+	}
+
+	health_code_update();
+
+	/*
+	 * Add the channel to the internal state AFTER all streams were created
+	 * and successfully sent to session daemon. This way, all streams must
+	 * be ready before this channel is visible to the threads.
+	 * If add_channel succeeds, ownership of the channel is
+	 * passed to consumer_thread_channel_poll().
+	 */
+	ret_add_channel = add_channel(channel, ctx);
+	if (ret_add_channel < 0) {
+		if (msg.u.ask_channel.type == LTTNG_UST_ABI_CHAN_METADATA) {
+			if (channel->metadata_switch_timer_task) {
+				consumer_timer_switch_stop(channel);
+			}
+			consumer_metadata_cache_destroy(channel);
+		}
+		if (channel->live_timer_task) {
+			consumer_timer_live_stop(channel);
+		}
+		if (channel->monitor_timer_task) {
+			consumer_timer_monitor_stop(channel);
+		}
+		goto error;
+	}
+
+	return channel;
+
+error:
+	if (channel) {
+		consumer_del_channel(channel);
+	}
+
+	return nullptr;
+}
+
+/*
+ * Send a channel and its streams to the session daemon (and relayd, if
+ * applicable), then hand over the streams to the data thread.
+ *
+ * Return 0 if the status `ret_code` must be sent to the session daemon, 1 if
+ * the session daemon was already informed of the outcome, or a negative value
+ * if the communication with the session daemon is broken.
+ */
+static int get_channel(struct lttng_consumer_local_data *ctx,
+		       int sock,
+		       uint64_t key,
+		       enum lttcomm_return_code *ret_code)
+{
+	int ret, relayd_err = 0;
+	struct lttng_consumer_channel *found_channel;
+
+	found_channel = consumer_find_channel(key);
+	if (!found_channel) {
+		ERR("UST consumer get channel key %" PRIu64 " not found", key);
+		*ret_code = LTTCOMM_CONSUMERD_CHAN_NOT_FOUND;
+		return 0;
+	}
+
+	health_code_update();
+
+	/* Send the channel to sessiond (and relayd, if applicable). */
+	ret = send_channel_to_sessiond_and_relayd(sock, found_channel, ctx, &relayd_err);
+	if (ret < 0) {
+		if (relayd_err) {
+			/*
+			 * We were unable to send to the relayd the stream so avoid
+			 * sending back a fatal error to the thread since this is OK
+			 * and the consumer can continue its work. The above call
+			 * has sent the error status message to the sessiond.
+			 */
+			return 1;
+		}
+		/*
+		 * The communicaton was broken hence there is a bad state between
+		 * the consumer and sessiond so stop everything.
+		 */
+		return -1;
+	}
+
+	health_code_update();
+
+	/*
+	 * In no monitor mode, the streams ownership is kept inside the channel
+	 * so don't send them to the data thread.
+	 */
+	if (!found_channel->monitor) {
+		return 0;
+	}
+
+	ret = send_streams_to_thread(found_channel, ctx);
+	if (ret < 0) {
+		/*
+		 * If we are unable to send the stream to the thread, there is
+		 * a big problem so just stop everything.
+		 */
+		return -1;
+	}
+	/* List MUST be empty after or else it could be reused. */
+	LTTNG_ASSERT(cds_list_empty(&found_channel->streams.head));
+	return 0;
+}
+
 /*
  * Receive command from session daemon and process it.
  *
@@ -1583,231 +1820,136 @@ int lttng_ustconsumer_recv_cmd(struct lttng_consumer_local_data *ctx,
 	}
 	case LTTNG_CONSUMER_ASK_CHANNEL_CREATION:
 	{
-		int ret_ask_channel, ret_add_channel, ret_send;
-		struct lttng_ust_ctl_consumer_channel_attr attr;
-		const uint64_t chunk_id = msg.u.ask_channel.chunk_id.value;
-		const struct lttng_credentials buffer_credentials = {
-			.uid = LTTNG_OPTIONAL_INIT_VALUE(msg.u.ask_channel.buffer_credentials.uid),
-			.gid = LTTNG_OPTIONAL_INIT_VALUE(msg.u.ask_channel.buffer_credentials.gid),
-		};
+		int ret_send;
 
-		/* Create a plain object and reserve a channel key. */
-		channel = consumer_allocate_channel(
-			msg.u.ask_channel.key,
-			msg.u.ask_channel.session_id,
-			msg.u.ask_channel.chunk_id.is_set ? &chunk_id : nullptr,
-			msg.u.ask_channel.pathname,
-			msg.u.ask_channel.name,
-			msg.u.ask_channel.relayd_id,
-			(enum lttng_event_output) msg.u.ask_channel.output,
-			msg.u.ask_channel.tracefile_size,
-			msg.u.ask_channel.tracefile_count,
-			msg.u.ask_channel.session_id_per_pid,
-			msg.u.ask_channel.monitor,
-			msg.u.ask_channel.live_timer_interval,
-			msg.u.ask_channel.is_live,
-			msg.u.ask_channel.root_shm_path,
-			msg.u.ask_channel.shm_path);
+		channel = create_channel(ctx, msg);
 		if (!channel) {
 			goto end_channel_error;
 		}
 
-		LTTNG_OPTIONAL_SET(&channel->buffer_credentials, buffer_credentials);
-
 		/*
-		 * Assign UST application UID to the channel. This value is ignored for
-		 * per PID buffers. This is specific to UST thus setting this after the
-		 * allocation.
+		 * Channel and streams are now created. Inform the session daemon that
+		 * everything went well and should wait to receive the channel and
+		 * streams with ustctl API.
 		 */
-		channel->ust_app_uid = msg.u.ask_channel.ust_app_uid;
-
-		/* Build channel attributes from received message. */
-		attr.subbuf_size = msg.u.ask_channel.subbuf_size;
-		attr.num_subbuf = msg.u.ask_channel.num_subbuf;
-		attr.overwrite = msg.u.ask_channel.overwrite;
-		attr.switch_timer_interval = msg.u.ask_channel.switch_timer_interval;
-		attr.read_timer_interval = msg.u.ask_channel.read_timer_interval;
-		attr.chan_id = msg.u.ask_channel.chan_id;
-		memcpy(attr.uuid, msg.u.ask_channel.uuid, sizeof(attr.uuid));
-		attr.blocking_timeout = msg.u.ask_channel.blocking_timeout;
-
-		/* Match channel buffer type to the UST abi. */
-		switch (msg.u.ask_channel.output) {
-		case LTTNG_EVENT_MMAP:
-		default:
-			attr.output = LTTNG_UST_ABI_MMAP;
-			break;
-		}
-
-		/* Translate and save channel type. */
-		switch (msg.u.ask_channel.type) {
-		case LTTNG_UST_ABI_CHAN_PER_CPU:
-			/* fall-through */
-		case LTTNG_UST_ABI_CHAN_PER_CHANNEL:
-
-			if (msg.u.ask_channel.type == LTTNG_UST_ABI_CHAN_PER_CPU) {
-				channel->type = CONSUMER_CHANNEL_TYPE_DATA_PER_CPU;
-				attr.type = LTTNG_UST_ABI_CHAN_PER_CPU;
-			} else {
-				channel->type = CONSUMER_CHANNEL_TYPE_DATA_PER_CHANNEL;
-				attr.type = LTTNG_UST_ABI_CHAN_PER_CHANNEL;
-			}
-
+		ret_send = consumer_send_status_channel(sock, channel);
+		if (ret_send < 0) {
 			/*
-			 * Set refcount to 1 for owner. Below, we will
-			 * pass ownership to the
-			 * consumer_thread_channel_poll() thread.
+			 * There is probably a problem on the socket.
 			 */
-			channel->refcount = 1;
-			break;
-		case LTTNG_UST_ABI_CHAN_METADATA:
-			channel->type = CONSUMER_CHANNEL_TYPE_METADATA;
-			attr.type = LTTNG_UST_ABI_CHAN_METADATA;
-			break;
-		default:
-			abort();
 			goto error_fatal;
-		};
-
-		health_code_update();
-
-		ret_ask_channel = ask_channel(ctx, channel, &attr);
-		if (ret_ask_channel < 0) {
-			goto end_channel_error;
 		}
 
-		if (msg.u.ask_channel.type == LTTNG_UST_ABI_CHAN_METADATA) {
-			int ret_allocate;
+		break;
+	}
+	case LTTNG_CONSUMER_ASK_CHANNELS_CREATION:
+	{
+		const uint32_t count = msg.u.ask_channels.count;
+		std::vector<struct lttcomm_consumer_msg> channel_msgs;
+		ssize_t ret_recv;
 
-			ret_allocate = consumer_metadata_cache_allocate(channel);
-			if (ret_allocate < 0) {
-				ERR("Allocating metadata cache");
-				goto end_channel_error;
-			}
+		DBG("UST consumer asked to create %" PRIu32 " channels", count);
 
-			consumer_timer_switch_start(channel,
-						    attr.switch_timer_interval,
-						    ctx->metadata_socket,
-						    ctx->consumer_error_socket,
-						    ctx->timer_task_scheduler);
-		} else {
-			int monitor_start_ret;
-
-			consumer_timer_live_start(channel,
-						  msg.u.ask_channel.live_timer_interval,
-						  ctx->timer_task_scheduler);
-			monitor_start_ret = consumer_timer_monitor_start(
-				channel,
-				msg.u.ask_channel.monitor_timer_interval,
-				ctx->timer_task_scheduler);
-			if (monitor_start_ret < 0) {
-				ERR("Starting channel monitoring timer failed");
-				goto end_channel_error;
-			}
+		if (count == 0 || count > LTTCOMM_CONSUMER_MAX_CHANNEL_BATCH) {
+			ERR("Invalid number of channels to create: count = %" PRIu32, count);
+			goto error_fatal;
 		}
 
-		health_code_update();
+		try {
+			channel_msgs.resize(count);
+		} catch (const std::bad_alloc&) {
+			ERR("Failed to allocate channel creation messages");
+			goto error_fatal;
+		}
+
+		ret_recv = lttcomm_recv_unix_sock(
+			sock, channel_msgs.data(), count * sizeof(struct lttcomm_consumer_msg));
+		if (ret_recv != (ssize_t) (count * sizeof(struct lttcomm_consumer_msg))) {
+			ERR("Failed to receive channel creation messages");
+			goto error_fatal;
+		}
 
 		/*
-		 * Add the channel to the internal state AFTER all streams were created
-		 * and successfully sent to session daemon. This way, all streams must
-		 * be ready before this channel is visible to the threads.
-		 * If add_channel succeeds, ownership of the channel is
-		 * passed to consumer_thread_channel_poll().
+		 * One status is sent back per channel, in order, without waiting
+		 * for the session daemon: it only reads them once all channels
+		 * are created.
 		 */
-		ret_add_channel = add_channel(channel, ctx);
-		if (ret_add_channel < 0) {
-			if (msg.u.ask_channel.type == LTTNG_UST_ABI_CHAN_METADATA) {
-				if (channel->metadata_switch_timer_task) {
-					consumer_timer_switch_stop(channel);
-				}
-				consumer_metadata_cache_destroy(channel);
-			}
-			if (channel->live_timer_task) {
-				consumer_timer_live_stop(channel);
+		for (const auto& channel_msg : channel_msgs) {
+			struct lttng_consumer_channel *created_channel = nullptr;
+			int ret_send;
+
+			health_code_update();
+
+			if (channel_msg.cmd_type == LTTNG_CONSUMER_ASK_CHANNEL_CREATION) {
+				created_channel = create_channel(ctx, channel_msg);
+			} else {
+				ERR("Unexpected command in channel creation batch: cmd_type = %" PRIu32,
+				    channel_msg.cmd_type);
 			}
-			if (channel->monitor_timer_task) {
-				consumer_timer_monitor_stop(channel);
+
+			ret_send = consumer_send_status_channel(sock, created_channel);
+			if (ret_send < 0) {
+				goto error_fatal;
 			}
-			goto end_channel_error;
 		}
 
-		health_code_update();
+		goto end_nosignal;
+	}
+	case LTTNG_CONSUMER_GET_CHANNEL:
+	{
+		int ret;
 
-		/*
-		 * Channel and streams are now created. Inform the session daemon that
-		 * everything went well and should wait to receive the channel and
-		 * streams with ustctl API.
-		 */
-		ret_send = consumer_send_status_channel(sock, channel);
-		if (ret_send < 0) {
-			/*
-			 * There is probably a problem on the socket.
-			 */
+		ret = get_channel(ctx, sock, msg.u.get_channel.key, &ret_code);
+		if (ret < 0) {
 			goto error_fatal;
+		} else if (ret > 0) {
+			goto end_nosignal;
 		}
 
-		break;
+		goto end_msg_sessiond;
 	}
-	case LTTNG_CONSUMER_GET_CHANNEL:
+	case LTTNG_CONSUMER_GET_CHANNELS:
 	{
-		int ret, relayd_err = 0;
-		const uint64_t key = msg.u.get_channel.key;
-		struct lttng_consumer_channel *found_channel;
+		const uint32_t count = msg.u.get_channels.count;
+		std::vector<uint64_t> keys;
+		ssize_t ret_recv;
 
-		found_channel = consumer_find_channel(key);
-		if (!found_channel) {
-			ERR("UST consumer get channel key %" PRIu64 " not found", key);
-			ret_code = LTTCOMM_CONSUMERD_CHAN_NOT_FOUND;
-			goto end_get_channel;
+		if (count == 0 || count > LTTCOMM_CONSUMER_MAX_CHANNEL_BATCH) {
+			ERR("Invalid number of channels to get: count = %" PRIu32, count);
+			goto error_fatal;
 		}
 
-		health_code_update();
+		try {
+			keys.resize(count);
+		} catch (const std::bad_alloc&) {
+			ERR("Failed to allocate channel keys");
+			goto error_fatal;
+		}
 
-		/* Send the channel to sessiond (and relayd, if applicable). */
-		ret = send_channel_to_sessiond_and_relayd(sock, found_channel, ctx, &relayd_err);
-		if (ret < 0) {
-			if (relayd_err) {
-				/*
-				 * We were unable to send to the relayd the stream so avoid
-				 * sending back a fatal error to the thread since this is OK
-				 * and the consumer can continue its work. The above call
-				 * has sent the error status message to the sessiond.
-				 */
-				goto end_get_channel_nosignal;
-			}
-			/*
-			 * The communicaton was broken hence there is a bad state between
-			 * the consumer and sessiond so stop everything.
-			 */
-			goto error_get_channel_fatal;
+		ret_recv = lttcomm_recv_unix_sock(sock, keys.data(), count * sizeof(uint64_t));
+		if (ret_recv != (ssize_t) (count * sizeof(uint64_t))) {
+			ERR("Failed to receive channel keys");
+			goto error_fatal;
 		}
 
-		health_code_update();
+		/* The channels are sent back-to-back, as for successive GET_CHANNEL commands. */
+		for (const auto key : keys) {
+			enum lttcomm_return_code channel_ret_code = LTTCOMM_CONSUMERD_SUCCESS;
+			int ret;
 
-		/*
-		 * In no monitor mode, the streams ownership is kept inside the channel
-		 * so don't send them to the data thread.
-		 */
-		if (!found_channel->monitor) {
-			goto end_get_channel;
-		}
+			ret = get_channel(ctx, sock, key, &channel_ret_code);
+			if (ret < 0) {
+				goto error_fatal;
+			} else if (ret > 0) {
+				continue;
+			}
 
-		ret = send_streams_to_thread(found_channel, ctx);
-		if (ret < 0) {
-			/*
-			 * If we are unable to send the stream to the thread, there is
-			 * a big problem so just stop everything.
-			 */
-			goto error_get_channel_fatal;
+			ret = consumer_send_status_msg(sock, channel_ret_code);
+			if (ret < 0) {
+				goto error_fatal;
+			}
 		}
-		/* List MUST be empty after or else it could be reused. */
-		LTTNG_ASSERT(cds_list_empty(&found_channel->streams.head));
-	end_get_channel:
-		goto end_msg_sessiond;
-	error_get_channel_fatal:
-		goto error_fatal;
-	end_get_channel_nosignal:
+
 		goto end_nosignal;
 	}
 	case LTTNG_CONSUMER_DESTROY_CHANNEL:
@@ -2083,6 +2225,20 @@ int lttng_ustconsumer_recv_cmd(struct lttng_consumer_local_data *ctx,
 
 		break;
 	}
+	case LTTNG_CONSUMER_GET_DRAIN_STATISTICS:
+	{
+		DBG("UST consumer get drain statistics command");
+
+		health_code_update();
+
+		/* Send back the statistics to session daemon */
+		if (consumer_send_drain_statistics(sock) < 0) {
+			PERROR("send drain statistics");
+			goto error_fatal;
+		}
+
+		break;
+	}
 	case LTTNG_CONSUMER_SET_CHANNEL_MONITOR_PIPE:
 	{
 		int channel_monitor_pipe, ret_send, ret_set_channel_monitor_pipe;
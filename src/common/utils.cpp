@@ -1388,6 +1388,32 @@ end:
 	return ret;
 }
 
+unsigned long long utils_get_positive_env_value(const char *env_name,
+						unsigned long long default_value,
+						unsigned long long max_value)
+{
+	unsigned long long value;
+	const char *env_value = lttng_secure_getenv(env_name);
+
+	LTTNG_ASSERT(default_value > 0 && default_value <= max_value);
+
+	if (!env_value) {
+		return default_value;
+	}
+
+	if (utils_parse_unsigned_long_long(env_value, &value) || value == 0 ||
+	    value > max_value) {
+		WARN("Invalid value for environment variable %s: value = `%s`, valid range = [1, %llu], using default value %llu",
+		     env_name,
+		     env_value,
+		     max_value,
+		     default_value);
+		return default_value;
+	}
+
+	return value;
+}
+
 /*
  * Get the highest CPU id from a CPU mask.
  *
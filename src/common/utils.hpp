@@ -79,6 +79,17 @@ enum lttng_error_code utils_check_enough_available_memory(uint64_t num_bytes,
  */
 int utils_parse_unsigned_long_long(const char *str, unsigned long long *value);
 
+/*
+ * Get the value of the environment variable `env_name` as an unsigned integer
+ * in the range [1, `max_value`].
+ *
+ * Returns `default_value` if the variable is unset. If its value is not an
+ * integer in that range, a warning is logged and `default_value` is returned.
+ */
+unsigned long long utils_get_positive_env_value(const char *env_name,
+						unsigned long long default_value,
+						unsigned long long max_value);
+
 /*
  * Write a value to the given path and filename.
  *
@@ -17,6 +17,97 @@
 /* Copy helper functions. */
 void lttng_ctl_copy_lttng_domain(struct lttng_domain *dst, struct lttng_domain *src);
 
+/*
+ * Connection to the session daemon.
+ *
+ * Once the compact framing is negotiated, the commands are sent as a compact
+ * header followed by the non-empty fields of their lttcomm_session_msg (see
+ * sessiond-comm.hpp). The replies are unchanged.
+ */
+struct lttng_ctl_sessiond_connection {
+	int sock = -1;
+	bool compact_framing = false;
+};
+
+/*
+ * Ask the session daemon to switch the connection to the compact framing.
+ *
+ * Returns 0 on success, or else a negative lttng error code. On success, the
+ * compact framing is used if the session daemon supports it. Otherwise, the
+ * session daemon closed the connection and it must be re-established.
+ */
+int lttng_ctl_sessiond_connection_negotiate_compact_framing(
+	struct lttng_ctl_sessiond_connection *connection);
+
+/*
+ * Send a command on an established connection, without waiting for its
+ * reply. The arguments are the same as lttng_ctl_ask_sessiond_fds_varlen().
+ *
+ * Returns 0 on success or else a negative lttng error code, in which case the
+ * connection can't be used anymore.
+ */
+int lttng_ctl_sessiond_connection_send_fds_varlen(
+	const struct lttng_ctl_sessiond_connection *connection,
+	const struct lttcomm_session_msg *lsm,
+	const int *fds,
+	size_t nb_fd,
+	const void *vardata,
+	size_t vardata_len);
+
+/*
+ * Receive the reply to the oldest command sent on the connection whose reply
+ * isn't received yet. `*result` is set to what
+ * lttng_ctl_ask_sessiond_fds_varlen() returns.
+ *
+ * Returns 0 once the whole reply is received or else a negative lttng error
+ * code, in which case the connection can't be used anymore.
+ */
+int lttng_ctl_sessiond_connection_recv_reply_varlen(
+	const struct lttng_ctl_sessiond_connection *connection,
+	void **user_payload_buf,
+	void **user_cmd_header_buf,
+	size_t *user_cmd_header_len,
+	int *result);
+
+/* Same as lttng_ctl_sessiond_connection_send_fds_varlen() for a payload. */
+int lttng_ctl_sessiond_connection_send_payload(
+	const struct lttng_ctl_sessiond_connection *connection,
+	struct lttng_payload_view *message);
+
+/*
+ * Same as lttng_ctl_sessiond_connection_recv_reply_varlen(), `*result` being
+ * set to what lttng_ctl_ask_sessiond_payload() returns.
+ */
+int lttng_ctl_sessiond_connection_recv_reply_payload(
+	const struct lttng_ctl_sessiond_connection *connection,
+	struct lttng_payload *reply,
+	int *result);
+
+/*
+ * Session daemon connection used by the calling thread, set with
+ * lttng_set_session_daemon_connection(), or nullptr if each command uses its
+ * own connection.
+ */
+struct lttng_session_daemon_connection *lttng_ctl_get_session_daemon_connection();
+
+/* Same as lttng_ctl_ask_sessiond_fds_varlen(), on a session daemon connection. */
+int lttng_ctl_session_daemon_connection_ask_fds_varlen(
+	struct lttng_session_daemon_connection *connection,
+	struct lttcomm_session_msg *lsm,
+	const int *fds,
+	size_t nb_fd,
+	const void *vardata,
+	size_t vardata_len,
+	void **user_payload_buf,
+	void **user_cmd_header_buf,
+	size_t *user_cmd_header_len);
+
+/* Same as lttng_ctl_ask_sessiond_payload(), on a session daemon connection. */
+int lttng_ctl_session_daemon_connection_ask_payload(
+	struct lttng_session_daemon_connection *connection,
+	struct lttng_payload_view *message,
+	struct lttng_payload *reply);
+
 /*
  * Sends the lttcomm message to the session daemon and fills buf if the
  * returned data is not NULL.
@@ -66,13 +66,10 @@
 		(dst) = _tmp_domain;                               \
 	} while (0)
 
-/* Socket to session daemon for communication */
-static int sessiond_socket = -1;
 static char sessiond_sock_path[PATH_MAX];
 
 /* Variables */
 static char *tracing_group;
-static int connected;
 
 /* Global */
 
@@ -110,16 +107,24 @@ void lttng_ctl_copy_lttng_domain(struct lttng_domain *dst, struct lttng_domain *
 }
 
 /*
- * Send lttcomm_session_msg to the session daemon.
+ * Send lttcomm_session_msg to the session daemon, using the framing of the
+ * connection. `payload_size` and `fd_count` are the size of the data and the
+ * number of file descriptors sent after the message.
  *
  * On success, returns the number of bytes sent (>=0)
- * On error, returns -1
+ * On error, returns a negative lttng_error_code.
  */
-static int send_session_msg(struct lttcomm_session_msg *lsm)
+static int send_session_msg(const struct lttng_ctl_sessiond_connection *connection,
+			    const struct lttcomm_session_msg *lsm,
+			    size_t payload_size,
+			    size_t fd_count)
 {
 	int ret;
+	struct lttng_dynamic_buffer frame;
+
+	lttng_dynamic_buffer_init(&frame);
 
-	if (!connected) {
+	if (connection->sock < 0) {
 		ret = -LTTNG_ERR_NO_SESSIOND;
 		goto end;
 	}
@@ -128,13 +133,36 @@ static int send_session_msg(struct lttcomm_session_msg *lsm)
 	    lttcomm_sessiond_command_str((lttcomm_sessiond_command) lsm->cmd_type),
 	    lsm->cmd_type);
 
-	ret = lttcomm_send_creds_unix_sock(
-		sessiond_socket, lsm, sizeof(struct lttcomm_session_msg));
+	if (!connection->compact_framing) {
+		ret = lttcomm_send_creds_unix_sock(
+			connection->sock, lsm, sizeof(struct lttcomm_session_msg));
+		if (ret < 0) {
+			ret = -LTTNG_ERR_FATAL;
+		}
+
+		goto end;
+	}
+
+	if (payload_size > LTTCOMM_SESSIOND_COMPACT_MAX_PAYLOAD_SIZE ||
+	    fd_count > LTTCOMM_MAX_SEND_FDS) {
+		ret = -LTTNG_ERR_INVALID;
+		goto end;
+	}
+
+	ret = lttcomm_session_msg_to_compact(lsm, payload_size, (unsigned int) fd_count, &frame);
+	if (ret) {
+		ret = -LTTNG_ERR_NOMEM;
+		goto end;
+	}
+
+	/* The header and the attributes of the command are sent at once. */
+	ret = lttcomm_send_creds_unix_sock(connection->sock, frame.data, frame.size);
 	if (ret < 0) {
 		ret = -LTTNG_ERR_FATAL;
 	}
 
 end:
+	lttng_dynamic_buffer_reset(&frame);
 	return ret;
 }
 
@@ -144,11 +172,13 @@ end:
  * On success, returns the number of bytes sent (>=0)
  * On error, returns -1
  */
-static int send_session_varlen(const void *data, size_t len)
+static int send_session_varlen(const struct lttng_ctl_sessiond_connection *connection,
+			       const void *data,
+			       size_t len)
 {
 	int ret;
 
-	if (!connected) {
+	if (connection->sock < 0) {
 		ret = -LTTNG_ERR_NO_SESSIOND;
 		goto end;
 	}
@@ -158,7 +188,7 @@ static int send_session_varlen(const void *data, size_t len)
 		goto end;
 	}
 
-	ret = lttcomm_send_unix_sock(sessiond_socket, data, len);
+	ret = lttcomm_send_unix_sock(connection->sock, data, len);
 	if (ret < 0) {
 		ret = -LTTNG_ERR_FATAL;
 	}
@@ -173,11 +203,13 @@ end:
  * On success, returns the number of bytes sent (>=0)
  * On error, returns -1
  */
-static int send_session_fds(const int *fds, size_t nb_fd)
+static int send_session_fds(const struct lttng_ctl_sessiond_connection *connection,
+			    const int *fds,
+			    size_t nb_fd)
 {
 	int ret;
 
-	if (!connected) {
+	if (connection->sock < 0) {
 		ret = -LTTNG_ERR_NO_SESSIOND;
 		goto end;
 	}
@@ -187,7 +219,7 @@ static int send_session_fds(const int *fds, size_t nb_fd)
 		goto end;
 	}
 
-	ret = lttcomm_send_fds_unix_sock(sessiond_socket, fds, nb_fd);
+	ret = lttcomm_send_fds_unix_sock(connection->sock, fds, nb_fd);
 	if (ret < 0) {
 		ret = -LTTNG_ERR_FATAL;
 	}
@@ -202,18 +234,20 @@ end:
  * On success, returns the number of bytes received (>=0)
  * On error, returns a negative lttng_error_code.
  */
-static int recv_data_sessiond(void *buf, size_t len)
+static int recv_data_sessiond(const struct lttng_ctl_sessiond_connection *connection,
+			      void *buf,
+			      size_t len)
 {
 	int ret;
 
 	LTTNG_ASSERT(len > 0);
 
-	if (!connected) {
+	if (connection->sock < 0) {
 		ret = -LTTNG_ERR_NO_SESSIOND;
 		goto end;
 	}
 
-	ret = lttcomm_recv_unix_sock(sessiond_socket, buf, len);
+	ret = lttcomm_recv_unix_sock(connection->sock, buf, len);
 	if (ret < 0) {
 		ret = -LTTNG_ERR_FATAL;
 	} else if (ret == 0) {
@@ -230,7 +264,9 @@ end:
  * On success, returns the number of bytes received (>=0)
  * On error, returns a negative lttng_error_code.
  */
-static int recv_payload_sessiond(struct lttng_payload *payload, size_t len)
+static int recv_payload_sessiond(const struct lttng_ctl_sessiond_connection *connection,
+				 struct lttng_payload *payload,
+				 size_t len)
 {
 	int ret;
 	const size_t original_payload_size = payload->buffer.size;
@@ -241,7 +277,7 @@ static int recv_payload_sessiond(struct lttng_payload *payload, size_t len)
 		goto end;
 	}
 
-	ret = recv_data_sessiond(payload->buffer.data + original_payload_size, len);
+	ret = recv_data_sessiond(connection, payload->buffer.data + original_payload_size, len);
 end:
 	return ret;
 }
@@ -431,193 +467,330 @@ error:
 	return -1;
 }
 
-static void reset_global_sessiond_connection_state()
-{
-	sessiond_socket = -1;
-	connected = 0;
-}
-
 /*
  *  Clean disconnect from the session daemon.
  *
  *  On success, return 0. On error, return -1.
  */
-static int disconnect_sessiond()
+static int disconnect_sessiond(struct lttng_ctl_sessiond_connection *connection)
 {
 	int ret = 0;
 
-	if (connected) {
-		ret = lttcomm_close_unix_sock(sessiond_socket);
-		reset_global_sessiond_connection_state();
+	if (connection->sock >= 0) {
+		ret = lttcomm_close_unix_sock(connection->sock);
+		connection->sock = -1;
+		connection->compact_framing = false;
 	}
 
 	return ret;
 }
 
-static int recv_sessiond_optional_data(size_t len, void **user_buf, size_t *user_len)
+/*
+ * Receive optional data of the reply. `*buf` is set to nullptr if `len` is 0.
+ *
+ * On success, returns 0. On error, returns a negative lttng_error_code.
+ */
+static int recv_sessiond_optional_data(const struct lttng_ctl_sessiond_connection *connection,
+				       size_t len,
+				       char **buf)
 {
 	int ret = 0;
-	char *buf = nullptr;
 
-	if (len) {
-		if (!user_len) {
-			ret = -LTTNG_ERR_INVALID;
-			goto end;
-		}
-
-		buf = zmalloc<char>(len);
-		if (!buf) {
-			ret = -ENOMEM;
-			goto end;
-		}
-
-		ret = recv_data_sessiond(buf, len);
-		if (ret < 0) {
-			goto end;
-		}
-
-		if (!user_buf) {
-			ret = -LTTNG_ERR_INVALID;
-			goto end;
-		}
+	*buf = nullptr;
+	if (!len) {
+		goto end;
+	}
 
-		/* Move ownership of command header buffer to user. */
-		*user_buf = buf;
-		buf = nullptr;
-		*user_len = len;
-	} else {
-		/* No command header. */
-		if (user_len) {
-			*user_len = 0;
-		}
+	*buf = zmalloc<char>(len);
+	if (!*buf) {
+		ret = -LTTNG_ERR_NOMEM;
+		goto end;
+	}
 
-		if (user_buf) {
-			*user_buf = nullptr;
-		}
+	ret = recv_data_sessiond(connection, *buf, len);
+	if (ret < 0) {
+		free(*buf);
+		*buf = nullptr;
+		goto end;
 	}
 
+	ret = 0;
 end:
-	free(buf);
 	return ret;
 }
 
-/*
- * Ask the session daemon a specific command and put the data into buf.
- * Takes extra var. len. data and file descriptors as input to send to the
- * session daemon.
- *
- * Return size of data (only payload, not header) or a negative error code.
- */
-int lttng_ctl_ask_sessiond_fds_varlen(struct lttcomm_session_msg *lsm,
-				      const int *fds,
-				      size_t nb_fd,
-				      const void *vardata,
-				      size_t vardata_len,
-				      void **user_payload_buf,
-				      void **user_cmd_header_buf,
-				      size_t *user_cmd_header_len)
+int lttng_ctl_sessiond_connection_negotiate_compact_framing(
+	struct lttng_ctl_sessiond_connection *connection)
 {
 	int ret;
-	size_t payload_len;
+	struct lttcomm_session_msg lsm = {};
 	struct lttcomm_lttng_msg llm;
 
-	ret = connect_sessiond();
+	LTTNG_ASSERT(!connection->compact_framing);
+
+	/* The negotiation itself uses the legacy framing. */
+	lsm.cmd_type = LTTCOMM_SESSIOND_COMMAND_NEGOTIATE_COMPACT_FRAMING;
+	ret = send_session_msg(connection, &lsm, 0, 0);
 	if (ret < 0) {
-		ret = -LTTNG_ERR_NO_SESSIOND;
 		goto end;
-	} else {
-		sessiond_socket = ret;
-		connected = 1;
 	}
 
-	ret = send_session_msg(lsm);
+	ret = recv_data_sessiond(connection, &llm, sizeof(llm));
+	if (ret < 0) {
+		goto end;
+	}
+
+	switch (llm.ret_code) {
+	case LTTNG_OK:
+		connection->compact_framing = true;
+		break;
+	case LTTNG_ERR_UND:
+		/* Session daemon predating the compact framing. */
+		DBG("Session daemon doesn't support the compact framing of client commands");
+		break;
+	default:
+		if (llm.ret_code < LTTNG_OK || llm.ret_code >= LTTNG_ERR_NR) {
+			/* Invalid error code received. */
+			ret = -LTTNG_ERR_UNK;
+		} else {
+			ret = -llm.ret_code;
+		}
+
+		goto end;
+	}
+
+	ret = 0;
+
+end:
+	return ret;
+}
+
+int lttng_ctl_sessiond_connection_send_fds_varlen(
+	const struct lttng_ctl_sessiond_connection *connection,
+	const struct lttcomm_session_msg *lsm,
+	const int *fds,
+	size_t nb_fd,
+	const void *vardata,
+	size_t vardata_len)
+{
+	int ret;
+
+	ret = send_session_msg(connection, lsm, vardata ? vardata_len : 0, fds ? nb_fd : 0);
 	if (ret < 0) {
 		/* Ret value is a valid lttng error code. */
 		goto end;
 	}
 	/* Send var len data */
-	ret = send_session_varlen(vardata, vardata_len);
+	ret = send_session_varlen(connection, vardata, vardata_len);
 	if (ret < 0) {
 		/* Ret value is a valid lttng error code. */
 		goto end;
 	}
 
 	/* Send fds */
-	ret = send_session_fds(fds, nb_fd);
+	ret = send_session_fds(connection, fds, nb_fd);
 	if (ret < 0) {
 		/* Ret value is a valid lttng error code. */
 		goto end;
 	}
 
+	ret = 0;
+end:
+	return ret;
+}
+
+int lttng_ctl_sessiond_connection_recv_reply_varlen(
+	const struct lttng_ctl_sessiond_connection *connection,
+	void **user_payload_buf,
+	void **user_cmd_header_buf,
+	size_t *user_cmd_header_len,
+	int *result)
+{
+	int ret;
+	struct lttcomm_lttng_msg llm;
+	char *cmd_header_buf = nullptr, *payload_buf = nullptr;
+
 	/* Get header from data transmission */
-	ret = recv_data_sessiond(&llm, sizeof(llm));
+	ret = recv_data_sessiond(connection, &llm, sizeof(llm));
 	if (ret < 0) {
 		/* Ret value is a valid lttng error code. */
 		goto end;
 	}
 
-	/* Check error code if OK */
-	if (llm.ret_code != LTTNG_OK) {
-		ret = -llm.ret_code;
+	/*
+	 * The whole reply is received, even on error, to leave the connection
+	 * ready for the next reply.
+	 */
+	ret = recv_sessiond_optional_data(connection, llm.cmd_header_size, &cmd_header_buf);
+	if (ret < 0) {
 		goto end;
 	}
 
-	/* Get command header from data transmission */
-	ret = recv_sessiond_optional_data(
-		llm.cmd_header_size, user_cmd_header_buf, user_cmd_header_len);
+	ret = recv_sessiond_optional_data(connection, llm.data_size, &payload_buf);
 	if (ret < 0) {
 		goto end;
 	}
 
-	/* Get payload from data transmission */
-	ret = recv_sessiond_optional_data(llm.data_size, user_payload_buf, &payload_len);
-	if (ret < 0) {
+	ret = 0;
+
+	/* Check error code if OK */
+	if (llm.ret_code != LTTNG_OK) {
+		*result = -llm.ret_code;
+		goto end;
+	}
+
+	if ((cmd_header_buf && (!user_cmd_header_buf || !user_cmd_header_len)) ||
+	    (payload_buf && !user_payload_buf)) {
+		*result = -LTTNG_ERR_INVALID;
 		goto end;
 	}
 
-	ret = llm.data_size;
+	/* Move ownership of the command header and payload buffers to user. */
+	if (user_cmd_header_buf) {
+		*user_cmd_header_buf = cmd_header_buf;
+		cmd_header_buf = nullptr;
+	}
+
+	if (user_cmd_header_len) {
+		*user_cmd_header_len = llm.cmd_header_size;
+	}
+
+	if (user_payload_buf) {
+		*user_payload_buf = payload_buf;
+		payload_buf = nullptr;
+	}
+
+	*result = llm.data_size;
 
 end:
-	disconnect_sessiond();
+	free(cmd_header_buf);
+	free(payload_buf);
 	return ret;
 }
 
-int lttng_ctl_ask_sessiond_payload(struct lttng_payload_view *message, struct lttng_payload *reply)
+/*
+ * Ask the session daemon a specific command and put the data into buf.
+ * Takes extra var. len. data and file descriptors as input to send to the
+ * session daemon.
+ *
+ * Return size of data (only payload, not header) or a negative error code.
+ */
+int lttng_ctl_ask_sessiond_fds_varlen(struct lttcomm_session_msg *lsm,
+				      const int *fds,
+				      size_t nb_fd,
+				      const void *vardata,
+				      size_t vardata_len,
+				      void **user_payload_buf,
+				      void **user_cmd_header_buf,
+				      size_t *user_cmd_header_len)
 {
-	int ret;
-	struct lttcomm_lttng_msg llm;
-	const int fd_count = lttng_payload_view_get_fd_handle_count(message);
+	int ret, result;
+	struct lttng_ctl_sessiond_connection connection;
+	auto *session_daemon_connection = lttng_ctl_get_session_daemon_connection();
 
-	LTTNG_ASSERT(reply->buffer.size == 0);
-	LTTNG_ASSERT(lttng_dynamic_pointer_array_get_count(&reply->_fd_handles) == 0);
+	if (session_daemon_connection) {
+		return lttng_ctl_session_daemon_connection_ask_fds_varlen(session_daemon_connection,
+									  lsm,
+									  fds,
+									  nb_fd,
+									  vardata,
+									  vardata_len,
+									  user_payload_buf,
+									  user_cmd_header_buf,
+									  user_cmd_header_len);
+	}
 
+	/*
+	 * The connection only carries this command: negotiating the compact
+	 * framing would cost more than it saves.
+	 */
 	ret = connect_sessiond();
 	if (ret < 0) {
 		ret = -LTTNG_ERR_NO_SESSIOND;
 		goto end;
 	} else {
-		sessiond_socket = ret;
-		connected = 1;
+		connection.sock = ret;
 	}
 
-	/* Send command to session daemon */
-	ret = lttcomm_send_creds_unix_sock(
-		sessiond_socket, message->buffer.data, message->buffer.size);
+	ret = lttng_ctl_sessiond_connection_send_fds_varlen(
+		&connection, lsm, fds, nb_fd, vardata, vardata_len);
 	if (ret < 0) {
-		ret = -LTTNG_ERR_FATAL;
 		goto end;
 	}
 
+	ret = lttng_ctl_sessiond_connection_recv_reply_varlen(
+		&connection, user_payload_buf, user_cmd_header_buf, user_cmd_header_len, &result);
+	if (ret < 0) {
+		goto end;
+	}
+
+	ret = result;
+
+end:
+	disconnect_sessiond(&connection);
+	return ret;
+}
+
+int lttng_ctl_sessiond_connection_send_payload(
+	const struct lttng_ctl_sessiond_connection *connection,
+	struct lttng_payload_view *message)
+{
+	int ret;
+	const int fd_count = lttng_payload_view_get_fd_handle_count(message);
+	struct lttcomm_session_msg lsm;
+
+	LTTNG_ASSERT(message->buffer.size >= sizeof(lsm));
+
+	/* Send command to session daemon */
+	if (connection->compact_framing) {
+		memcpy(&lsm, message->buffer.data, sizeof(lsm));
+		ret = send_session_msg(
+			connection, &lsm, message->buffer.size - sizeof(lsm), fd_count);
+		if (ret < 0) {
+			goto end;
+		}
+
+		ret = send_session_varlen(connection,
+					  message->buffer.data + sizeof(lsm),
+					  message->buffer.size - sizeof(lsm));
+		if (ret < 0) {
+			goto end;
+		}
+	} else {
+		ret = lttcomm_send_creds_unix_sock(
+			connection->sock, message->buffer.data, message->buffer.size);
+		if (ret < 0) {
+			ret = -LTTNG_ERR_FATAL;
+			goto end;
+		}
+	}
+
 	if (fd_count > 0) {
-		ret = lttcomm_send_payload_view_fds_unix_sock(sessiond_socket, message);
+		ret = lttcomm_send_payload_view_fds_unix_sock(connection->sock, message);
 		if (ret < 0) {
 			ret = -LTTNG_ERR_FATAL;
 			goto end;
 		}
 	}
 
+	ret = 0;
+end:
+	return ret;
+}
+
+int lttng_ctl_sessiond_connection_recv_reply_payload(
+	const struct lttng_ctl_sessiond_connection *connection,
+	struct lttng_payload *reply,
+	int *result)
+{
+	int ret;
+	struct lttcomm_lttng_msg llm;
+
+	LTTNG_ASSERT(reply->buffer.size == 0);
+	LTTNG_ASSERT(lttng_dynamic_pointer_array_get_count(&reply->_fd_handles) == 0);
+
 	/* Get header from data transmission */
-	ret = recv_payload_sessiond(reply, sizeof(llm));
+	ret = recv_payload_sessiond(connection, reply, sizeof(llm));
 	if (ret < 0) {
 		/* Ret value is a valid lttng error code. */
 		goto end;
@@ -625,19 +798,12 @@ int lttng_ctl_ask_sessiond_payload(struct lttng_payload_view *message, struct lt
 
 	llm = *((typeof(llm) *) reply->buffer.data);
 
-	/* Check error code if OK */
-	if (llm.ret_code != LTTNG_OK) {
-		if (llm.ret_code < LTTNG_OK || llm.ret_code >= LTTNG_ERR_NR) {
-			/* Invalid error code received. */
-			ret = -LTTNG_ERR_UNK;
-		} else {
-			ret = -llm.ret_code;
-		}
-		goto end;
-	}
-
+	/*
+	 * The whole reply is received, even on error, to leave the connection
+	 * ready for the next reply.
+	 */
 	if (llm.cmd_header_size > 0) {
-		ret = recv_payload_sessiond(reply, llm.cmd_header_size);
+		ret = recv_payload_sessiond(connection, reply, llm.cmd_header_size);
 		if (ret < 0) {
 			goto end;
 		}
@@ -645,33 +811,81 @@ int lttng_ctl_ask_sessiond_payload(struct lttng_payload_view *message, struct lt
 
 	/* Get command header from data transmission */
 	if (llm.data_size > 0) {
-		ret = recv_payload_sessiond(reply, llm.data_size);
+		ret = recv_payload_sessiond(connection, reply, llm.data_size);
 		if (ret < 0) {
 			goto end;
 		}
 	}
 
 	if (llm.fd_count > 0) {
-		ret = lttcomm_recv_payload_fds_unix_sock(sessiond_socket, llm.fd_count, reply);
+		ret = lttcomm_recv_payload_fds_unix_sock(connection->sock, llm.fd_count, reply);
 		if (ret < 0) {
 			goto end;
 		}
 	}
 
+	ret = 0;
+
+	/* Check error code if OK */
+	if (llm.ret_code != LTTNG_OK) {
+		if (llm.ret_code < LTTNG_OK || llm.ret_code >= LTTNG_ERR_NR) {
+			/* Invalid error code received. */
+			*result = -LTTNG_ERR_UNK;
+		} else {
+			*result = -llm.ret_code;
+		}
+
+		goto end;
+	}
+
 	/* Don't return the llm header to the caller. */
 	memmove(reply->buffer.data,
 		reply->buffer.data + sizeof(llm),
 		reply->buffer.size - sizeof(llm));
-	ret = lttng_dynamic_buffer_set_size(&reply->buffer, reply->buffer.size - sizeof(llm));
-	if (ret) {
+	if (lttng_dynamic_buffer_set_size(&reply->buffer, reply->buffer.size - sizeof(llm))) {
 		/* Can't happen as size is reduced. */
 		abort();
 	}
 
-	ret = reply->buffer.size;
+	*result = reply->buffer.size;
+
+end:
+	return ret;
+}
+
+int lttng_ctl_ask_sessiond_payload(struct lttng_payload_view *message, struct lttng_payload *reply)
+{
+	int ret, result;
+	struct lttng_ctl_sessiond_connection connection;
+	auto *session_daemon_connection = lttng_ctl_get_session_daemon_connection();
+
+	if (session_daemon_connection) {
+		return lttng_ctl_session_daemon_connection_ask_payload(
+			session_daemon_connection, message, reply);
+	}
+
+	ret = connect_sessiond();
+	if (ret < 0) {
+		ret = -LTTNG_ERR_NO_SESSIOND;
+		goto end;
+	} else {
+		connection.sock = ret;
+	}
+
+	ret = lttng_ctl_sessiond_connection_send_payload(&connection, message);
+	if (ret < 0) {
+		goto end;
+	}
+
+	ret = lttng_ctl_sessiond_connection_recv_reply_payload(&connection, reply, &result);
+	if (ret < 0) {
+		goto end;
+	}
+
+	ret = result;
 
 end:
-	disconnect_sessiond();
+	disconnect_sessiond(&connection);
 	return ret;
 }
 
@@ -2411,14 +2625,20 @@ end:
 }
 
 /*
- * Ask the session daemon for all available events of a session channel.
+ * Ask the session daemon for the events of a session channel found in the
+ * window [offset, offset + max_count) of the listing. The window is ignored
+ * by LIST_EVENTS, which lists all the events of the channel.
+ *
  * Sets the contents of the events array.
  * Returns the number of lttng_event entries in events;
  * on error, returns a negative value.
  */
-int lttng_list_events(struct lttng_handle *handle,
-		      const char *channel_name,
-		      struct lttng_event **events)
+static int list_events(struct lttng_handle *handle,
+		       const char *channel_name,
+		       enum lttcomm_sessiond_command command,
+		       uint32_t offset,
+		       uint32_t max_count,
+		       struct lttng_event **events)
 {
 	int ret;
 	struct lttcomm_session_msg lsm = {};
@@ -2436,7 +2656,7 @@ int lttng_list_events(struct lttng_handle *handle,
 	}
 
 	/* Initialize command parameters. */
-	lsm.cmd_type = LTTCOMM_SESSIOND_COMMAND_LIST_EVENTS;
+	lsm.cmd_type = command;
 	ret = lttng_strncpy(lsm.session.name, handle->session_name, sizeof(lsm.session.name));
 	if (ret) {
 		ret = -LTTNG_ERR_INVALID;
@@ -2450,6 +2670,8 @@ int lttng_list_events(struct lttng_handle *handle,
 	}
 
 	COPY_DOMAIN_PACKED(lsm.domain, handle->domain);
+	lsm.u.list.offset = offset;
+	lsm.u.list.max_count = max_count;
 
 	/* Execute command against the session daemon. */
 	ret = lttng_ctl_ask_sessiond_payload(&lsm_view, &reply);
@@ -2496,6 +2718,54 @@ end:
 	return ret;
 }
 
+int lttng_list_events(struct lttng_handle *handle,
+		      const char *channel_name,
+		      struct lttng_event **events)
+{
+	return list_events(
+		handle, channel_name, LTTCOMM_SESSIOND_COMMAND_LIST_EVENTS, 0, 0, events);
+}
+
+int lttng_list_events_page(struct lttng_handle *handle,
+			   const char *channel_name,
+			   unsigned int offset,
+			   unsigned int max_count,
+			   struct lttng_event **event_rules)
+{
+	int ret;
+
+	if (max_count == 0 || !event_rules) {
+		ret = -LTTNG_ERR_INVALID;
+		goto end;
+	}
+
+	ret = list_events(handle,
+			  channel_name,
+			  LTTCOMM_SESSIOND_COMMAND_LIST_EVENTS_PAGE,
+			  offset,
+			  max_count,
+			  event_rules);
+	if (ret != -LTTNG_ERR_UND) {
+		goto end;
+	}
+
+	/*
+	 * Session daemons that predate paginated listings don't know the
+	 * command: report the complete listing as the first page and an
+	 * empty listing afterwards.
+	 */
+	if (offset > 0) {
+		*event_rules = nullptr;
+		ret = 0;
+		goto end;
+	}
+
+	ret = lttng_list_events(handle, channel_name, event_rules);
+
+end:
+	return ret;
+}
+
 /*
  * Sets the tracing_group variable with name.
  * This function allocates memory pointed to by tracing_group.
@@ -0,0 +1,308 @@
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only
+ *
+ */
+
+#define _LGPL_SOURCE
+#include "lttng-ctl-helper.hpp"
+
+#include <common/error.hpp>
+#include <common/payload-view.hpp>
+#include <common/payload.hpp>
+#include <common/sessiond-comm/sessiond-comm.hpp>
+#include <common/unix.hpp>
+
+#include <lttng/lttng.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <sys/socket.h>
+
+/*
+ * A single connection is shared by the threads using the session daemon
+ * connection. The commands are written one at a time and the session daemon
+ * replies to them in order: each command gets a ticket when it is sent and
+ * its thread waits for its turn to read its reply. Hence, several commands
+ * may be outstanding on the connection.
+ *
+ * When the connection fails, the commands of which the reply is awaited fail
+ * and the connection is re-established, on the next command, once their
+ * replies are accounted for. A command which couldn't be sent on the
+ * connection is sent again on its own connection.
+ *
+ * A session daemon that predates the compact framing handles a single command
+ * per connection. In that case, each command uses its own connection.
+ */
+struct lttng_session_daemon_connection {
+	/* Serializes the commands written on the connection. */
+	std::mutex send_lock;
+	/* Protects the members below. */
+	std::mutex lock;
+	/* Signaled when a reply is accounted for. */
+	std::condition_variable reply_turn;
+	struct lttng_ctl_sessiond_connection connection;
+	/* The connection must be re-established. */
+	bool broken = true;
+	/* The session daemon doesn't support the compact framing. */
+	bool one_shot_connections = false;
+	/* Ticket of the next command sent on the connection. */
+	std::uint64_t next_request_ticket = 0;
+	/* Ticket of the command of which to read the reply next. */
+	std::uint64_t next_reply_ticket = 0;
+};
+
+namespace {
+thread_local struct lttng_session_daemon_connection *thread_session_daemon_connection;
+
+void close_sessiond_connection(struct lttng_ctl_sessiond_connection& connection)
+{
+	if (connection.sock >= 0 && lttcomm_close_unix_sock(connection.sock)) {
+		PERROR("Failed to close session daemon connection");
+	}
+
+	connection.sock = -1;
+	connection.compact_framing = false;
+}
+
+/*
+ * Connect to the session daemon and negotiate the compact framing.
+ *
+ * Called with the send lock and the lock of the connection held, once no
+ * command is outstanding.
+ */
+int establish_connection(struct lttng_session_daemon_connection& shared)
+{
+	int ret;
+
+	close_sessiond_connection(shared.connection);
+
+	ret = connect_sessiond();
+	if (ret < 0) {
+		return -LTTNG_ERR_NO_SESSIOND;
+	}
+
+	shared.connection.sock = ret;
+	ret = lttng_ctl_sessiond_connection_negotiate_compact_framing(&shared.connection);
+	if (ret < 0) {
+		close_sessiond_connection(shared.connection);
+		return ret;
+	}
+
+	if (!shared.connection.compact_framing) {
+		/* The session daemon closed the connection. */
+		close_sessiond_connection(shared.connection);
+		shared.one_shot_connections = true;
+		return 0;
+	}
+
+	shared.broken = false;
+	return 0;
+}
+
+/*
+ * Wake up the threads blocked on the connection: their commands fail.
+ *
+ * Called with the lock of the connection held.
+ */
+void mark_broken(struct lttng_session_daemon_connection& shared)
+{
+	if (shared.broken) {
+		return;
+	}
+
+	DBG("Session daemon connection failed: sock = %d", shared.connection.sock);
+	shared.broken = true;
+	if (shutdown(shared.connection.sock, SHUT_RDWR)) {
+		PERROR("Failed to shut down session daemon connection");
+	}
+}
+
+template <typename SendFunction, typename RecvFunction>
+int ask_one_shot(const SendFunction& send, const RecvFunction& recv)
+{
+	struct lttng_ctl_sessiond_connection connection;
+	int ret, result;
+
+	ret = connect_sessiond();
+	if (ret < 0) {
+		return -LTTNG_ERR_NO_SESSIOND;
+	}
+
+	connection.sock = ret;
+	ret = send(connection);
+	if (ret >= 0) {
+		ret = recv(connection, result);
+	}
+
+	close_sessiond_connection(connection);
+	return ret < 0 ? ret : result;
+}
+
+/* A command too large for the compact framing uses its own connection. */
+bool fits_compact_framing(size_t payload_size, size_t fd_count)
+{
+	return payload_size <= LTTCOMM_SESSIOND_COMPACT_MAX_PAYLOAD_SIZE &&
+		fd_count <= LTTCOMM_MAX_SEND_FDS;
+}
+
+/*
+ * `send` writes the command on a connection and `recv` reads its reply,
+ * setting the result of the command. Both return a negative lttng error code
+ * if the connection failed.
+ */
+template <typename SendFunction, typename RecvFunction>
+int ask(struct lttng_session_daemon_connection& shared,
+	bool use_shared_connection,
+	const SendFunction& send,
+	const RecvFunction& recv)
+{
+	std::uint64_t ticket;
+	int ret, result = 0;
+	bool send_failed;
+
+	if (!use_shared_connection) {
+		return ask_one_shot(send, recv);
+	}
+
+	{
+		const std::lock_guard<std::mutex> send_guard(shared.send_lock);
+		std::unique_lock<std::mutex> guard(shared.lock);
+
+		/* The commands sent on a failed connection must complete first. */
+		shared.reply_turn.wait(guard, [&shared]() {
+			return !shared.broken ||
+				shared.next_request_ticket == shared.next_reply_ticket;
+		});
+
+		if (shared.broken && !shared.one_shot_connections) {
+			ret = establish_connection(shared);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		if (shared.one_shot_connections) {
+			guard.unlock();
+			return ask_one_shot(send, recv);
+		}
+
+		/* The connection isn't closed while a command is outstanding. */
+		ticket = shared.next_request_ticket++;
+		guard.unlock();
+
+		ret = send(shared.connection);
+		send_failed = ret < 0;
+		if (send_failed) {
+			guard.lock();
+			mark_broken(shared);
+		}
+	}
+
+	std::unique_lock<std::mutex> guard(shared.lock);
+
+	shared.reply_turn.wait(guard, [&shared, ticket]() {
+		return shared.next_reply_ticket == ticket;
+	});
+
+	if (ret >= 0 && shared.broken) {
+		ret = -LTTNG_ERR_NO_SESSIOND;
+	} else if (ret >= 0) {
+		guard.unlock();
+		ret = recv(shared.connection, result);
+		guard.lock();
+		if (ret < 0) {
+			mark_broken(shared);
+		}
+	}
+
+	shared.next_reply_ticket++;
+	shared.reply_turn.notify_all();
+	if (send_failed) {
+		/*
+		 * The session daemon doesn't process an incomplete command: send
+		 * it again on its own connection rather than failing because of
+		 * a connection which broke since the last command, for instance
+		 * when the session daemon was restarted.
+		 */
+		guard.unlock();
+		return ask_one_shot(send, recv);
+	}
+
+	return ret < 0 ? ret : result;
+}
+} /* namespace */
+
+struct lttng_session_daemon_connection *lttng_session_daemon_connection_create(void)
+{
+	return new (std::nothrow) lttng_session_daemon_connection;
+}
+
+void lttng_session_daemon_connection_destroy(struct lttng_session_daemon_connection *connection)
+{
+	if (!connection) {
+		return;
+	}
+
+	close_sessiond_connection(connection->connection);
+	delete connection;
+}
+
+void lttng_set_session_daemon_connection(struct lttng_session_daemon_connection *connection)
+{
+	thread_session_daemon_connection = connection;
+}
+
+struct lttng_session_daemon_connection *lttng_ctl_get_session_daemon_connection()
+{
+	return thread_session_daemon_connection;
+}
+
+int lttng_ctl_session_daemon_connection_ask_fds_varlen(
+	struct lttng_session_daemon_connection *connection,
+	struct lttcomm_session_msg *lsm,
+	const int *fds,
+	size_t nb_fd,
+	const void *vardata,
+	size_t vardata_len,
+	void **user_payload_buf,
+	void **user_cmd_header_buf,
+	size_t *user_cmd_header_len)
+{
+	return ask(
+		*connection,
+		fits_compact_framing(vardata_len, nb_fd),
+		[&](const lttng_ctl_sessiond_connection& sessiond_connection) {
+			return lttng_ctl_sessiond_connection_send_fds_varlen(
+				&sessiond_connection, lsm, fds, nb_fd, vardata, vardata_len);
+		},
+		[&](const lttng_ctl_sessiond_connection& sessiond_connection, int& result) {
+			return lttng_ctl_sessiond_connection_recv_reply_varlen(&sessiond_connection,
+									       user_payload_buf,
+									       user_cmd_header_buf,
+									       user_cmd_header_len,
+									       &result);
+		});
+}
+
+int lttng_ctl_session_daemon_connection_ask_payload(
+	struct lttng_session_daemon_connection *connection,
+	struct lttng_payload_view *message,
+	struct lttng_payload *reply)
+{
+	return ask(
+		*connection,
+		fits_compact_framing(message->buffer.size - sizeof(struct lttcomm_session_msg),
+				     lttng_payload_view_get_fd_handle_count(message)),
+		[&](const lttng_ctl_sessiond_connection& sessiond_connection) {
+			return lttng_ctl_sessiond_connection_send_payload(&sessiond_connection,
+									  message);
+		},
+		[&](const lttng_ctl_sessiond_connection& sessiond_connection, int& result) {
+			return lttng_ctl_sessiond_connection_recv_reply_payload(
+				&sessiond_connection, reply, &result);
+		});
+}
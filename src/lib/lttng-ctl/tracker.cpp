@@ -426,6 +426,135 @@ end:
 	return status;
 }
 
+static enum lttng_process_attr_tracker_handle_status
+process_attr_tracker_handle_update_inclusion_set(
+	const struct lttng_process_attr_tracker_handle *tracker,
+	enum lttcomm_sessiond_command command,
+	const struct lttng_process_attr_values *values,
+	struct lttng_process_attr_values **changed_values)
+{
+	char *reply = nullptr;
+	int reply_ret, ret;
+	enum lttng_process_attr_tracker_handle_status status =
+		LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK;
+	struct lttcomm_session_msg lsm = {
+		.cmd_type = command,
+		.session = {},
+		.domain = {},
+		.u = {},
+		.fd_count = 0,
+	};
+	struct lttng_dynamic_buffer payload;
+	struct lttng_buffer_view changed_values_view;
+	ssize_t changed_values_ret;
+
+	lttng_dynamic_buffer_init(&payload);
+	if (!tracker || !values) {
+		status = LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_INVALID;
+		goto end;
+	}
+
+	ret = lttng_strncpy(lsm.session.name, tracker->session_name, sizeof(lsm.session.name));
+	if (ret) {
+		status = LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_INVALID;
+		goto end;
+	}
+
+	ret = lttng_process_attr_values_serialize(values, &payload);
+	if (ret) {
+		status = LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_ERROR;
+		goto end;
+	}
+
+	lsm.domain.type = tracker->domain;
+	lsm.u.process_attr_tracker_update_include_values.process_attr =
+		(int32_t) tracker->process_attr;
+	lsm.u.process_attr_tracker_update_include_values.values_len = (uint32_t) payload.size;
+
+	reply_ret = lttng_ctl_ask_sessiond_varlen_no_cmd_header(
+		&lsm, payload.data, payload.size, (void **) &reply);
+	if (reply_ret < 0) {
+		switch (-reply_ret) {
+		case LTTNG_ERR_SESSION_NOT_EXIST:
+			status = LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_SESSION_DOES_NOT_EXIST;
+			break;
+		case LTTNG_ERR_PROCESS_ATTR_TRACKER_INVALID_TRACKING_POLICY:
+			status = LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_INVALID_TRACKING_POLICY;
+			break;
+		case LTTNG_ERR_USER_NOT_FOUND:
+			status = LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_USER_NOT_FOUND;
+			break;
+		case LTTNG_ERR_GROUP_NOT_FOUND:
+			status = LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_GROUP_NOT_FOUND;
+			break;
+		case LTTNG_ERR_INVALID:
+			status = LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_INVALID;
+			break;
+		default:
+			status = LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_ERROR;
+			break;
+		}
+		goto end;
+	}
+
+	if (!changed_values) {
+		goto end;
+	}
+
+	/* The values that were effectively added or removed are returned. */
+	changed_values_view = lttng_buffer_view_init(reply, 0, reply_ret);
+	if (!changed_values_view.data) {
+		status = LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_COMMUNICATION_ERROR;
+		goto end;
+	}
+
+	changed_values_ret = lttng_process_attr_values_create_from_buffer(
+		tracker->domain, tracker->process_attr, &changed_values_view, changed_values);
+	if (changed_values_ret < 0) {
+		status = LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_COMMUNICATION_ERROR;
+		goto end;
+	}
+end:
+	lttng_dynamic_buffer_reset(&payload);
+	free(reply);
+	return status;
+}
+
+enum lttng_process_attr_tracker_handle_status lttng_process_attr_tracker_handle_add_values(
+	const struct lttng_process_attr_tracker_handle *tracker,
+	const struct lttng_process_attr_values *values,
+	struct lttng_process_attr_values **added_values)
+{
+	return process_attr_tracker_handle_update_inclusion_set(
+		tracker,
+		LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_ADD_INCLUDE_VALUES,
+		values,
+		added_values);
+}
+
+enum lttng_process_attr_tracker_handle_status lttng_process_attr_tracker_handle_remove_values(
+	const struct lttng_process_attr_tracker_handle *tracker,
+	const struct lttng_process_attr_values *values,
+	struct lttng_process_attr_values **removed_values)
+{
+	return process_attr_tracker_handle_update_inclusion_set(
+		tracker,
+		LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_REMOVE_INCLUDE_VALUES,
+		values,
+		removed_values);
+}
+
+enum lttng_process_attr_tracker_handle_status lttng_process_attr_tracker_handle_set_inclusion_set(
+	const struct lttng_process_attr_tracker_handle *tracker,
+	const struct lttng_process_attr_values *values)
+{
+	return process_attr_tracker_handle_update_inclusion_set(
+		tracker,
+		LTTCOMM_SESSIOND_COMMAND_PROCESS_ATTR_TRACKER_SET_INCLUDE_VALUES,
+		values,
+		nullptr);
+}
+
 enum lttng_process_attr_values_status
 lttng_process_attr_values_get_count(const struct lttng_process_attr_values *values,
 				    unsigned int *count)
@@ -503,6 +632,71 @@ DEFINE_LTTNG_PROCESS_ATTR_VALUES_GETTER(gid, gid_t, GID);
 DEFINE_LTTNG_PROCESS_ATTR_VALUES_GETTER(user_name, const char *, USER_NAME);
 DEFINE_LTTNG_PROCESS_ATTR_VALUES_GETTER(group_name, const char *, GROUP_NAME);
 
+/* Takes ownership of `value`. */
+static enum lttng_process_attr_values_status
+process_attr_values_append(struct lttng_process_attr_values *values,
+			   struct process_attr_value *value)
+{
+	if (lttng_dynamic_pointer_array_add_pointer(&values->array, value)) {
+		process_attr_value_destroy(value);
+		return LTTNG_PROCESS_ATTR_VALUES_STATUS_ERROR;
+	}
+
+	return LTTNG_PROCESS_ATTR_VALUES_STATUS_OK;
+}
+
+#define DEFINE_LTTNG_PROCESS_ATTR_VALUES_INTEGRAL_ADDER(                                       \
+	value_type_name, value_type, value_type_enum)                                          \
+	enum lttng_process_attr_values_status lttng_process_attr_values_add_##value_type_name( \
+		struct lttng_process_attr_values *values, value_type in_value)                 \
+	{                                                                                      \
+		struct process_attr_value *value;                                              \
+                                                                                               \
+		if (!values) {                                                                 \
+			return LTTNG_PROCESS_ATTR_VALUES_STATUS_INVALID;                       \
+		}                                                                              \
+                                                                                               \
+		value = zmalloc<process_attr_value>();                                         \
+		if (!value) {                                                                  \
+			return LTTNG_PROCESS_ATTR_VALUES_STATUS_ERROR;                         \
+		}                                                                              \
+                                                                                               \
+		value->type = LTTNG_PROCESS_ATTR_VALUE_TYPE_##value_type_enum;                 \
+		value->value.value_type_name = in_value;                                       \
+		return process_attr_values_append(values, value);                              \
+	}
+
+#define DEFINE_LTTNG_PROCESS_ATTR_VALUES_NAME_ADDER(value_type_name, value_type_enum)          \
+	enum lttng_process_attr_values_status lttng_process_attr_values_add_##value_type_name( \
+		struct lttng_process_attr_values *values, const char *name)                    \
+	{                                                                                      \
+		struct process_attr_value *value;                                              \
+                                                                                               \
+		if (!values || !name) {                                                        \
+			return LTTNG_PROCESS_ATTR_VALUES_STATUS_INVALID;                       \
+		}                                                                              \
+                                                                                               \
+		value = zmalloc<process_attr_value>();                                         \
+		if (!value) {                                                                  \
+			return LTTNG_PROCESS_ATTR_VALUES_STATUS_ERROR;                         \
+		}                                                                              \
+                                                                                               \
+		value->type = LTTNG_PROCESS_ATTR_VALUE_TYPE_##value_type_enum;                 \
+		value->value.value_type_name = strdup(name);                                   \
+		if (!value->value.value_type_name) {                                           \
+			free(value);                                                           \
+			return LTTNG_PROCESS_ATTR_VALUES_STATUS_ERROR;                         \
+		}                                                                              \
+                                                                                               \
+		return process_attr_values_append(values, value);                              \
+	}
+
+DEFINE_LTTNG_PROCESS_ATTR_VALUES_INTEGRAL_ADDER(pid, pid_t, PID);
+DEFINE_LTTNG_PROCESS_ATTR_VALUES_INTEGRAL_ADDER(uid, uid_t, UID);
+DEFINE_LTTNG_PROCESS_ATTR_VALUES_INTEGRAL_ADDER(gid, gid_t, GID);
+DEFINE_LTTNG_PROCESS_ATTR_VALUES_NAME_ADDER(user_name, USER_NAME);
+DEFINE_LTTNG_PROCESS_ATTR_VALUES_NAME_ADDER(group_name, GROUP_NAME);
+
 static enum lttng_error_code
 handle_status_to_error_code(enum lttng_process_attr_tracker_handle_status handle_status)
 {
@@ -0,0 +1,99 @@
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ */
+
+#include <common/error.hpp>
+#include <common/sessiond-comm/sessiond-comm.hpp>
+#include <common/unix.hpp>
+
+#include <lttng/lttng-error.h>
+
+#include <string.h>
+#include <tap/tap.h>
+#include <unistd.h>
+
+#define NUM_TESTS 4
+
+/* For error.h */
+int lttng_opt_quiet = 1;
+int lttng_opt_verbose;
+int lttng_opt_mi;
+
+namespace {
+/*
+ * Send a command to the session daemon on its own connection and return the
+ * reply's return code, or -1 if no reply was received.
+ */
+int send_command(const char *sock_path, uint32_t cmd_type, const char *session_name)
+{
+	int ret = -1;
+	ssize_t len;
+	struct lttcomm_session_msg lsm = {};
+	struct lttcomm_lttng_msg reply = {};
+	const int sock = lttcomm_connect_unix_sock(sock_path);
+
+	if (sock < 0) {
+		diag("Failed to connect to the session daemon: path = `%s`", sock_path);
+		return -1;
+	}
+
+	lsm.cmd_type = cmd_type;
+	if (session_name) {
+		strncpy(lsm.session.name, session_name, sizeof(lsm.session.name) - 1);
+	}
+
+	len = lttcomm_send_creds_unix_sock(sock, &lsm, sizeof(lsm));
+	if (len != sizeof(lsm)) {
+		diag("Failed to send command to the session daemon");
+		goto end;
+	}
+
+	len = lttcomm_recv_unix_sock(sock, &reply, sizeof(reply));
+	if (len != sizeof(reply)) {
+		diag("Failed to receive the reply of the session daemon");
+		goto end;
+	}
+
+	ret = (int) reply.ret_code;
+end:
+	if (close(sock)) {
+		diag("Failed to close the session daemon connection");
+	}
+
+	return ret;
+}
+} /* namespace */
+
+int main(int argc, char **argv)
+{
+	int ret;
+
+	plan_tests(NUM_TESTS);
+
+	if (argc < 2) {
+		diag("Usage: invalid_command SESSIOND_SOCKET_PATH");
+		goto end;
+	}
+
+	ret = send_command(argv[1], LTTCOMM_SESSIOND_COMMAND_MAX, nullptr);
+	ok(ret == LTTNG_ERR_UND, "First out-of-range command is rejected: ret = %d", ret);
+
+	ret = send_command(argv[1], UINT32_MAX, nullptr);
+	ok(ret == LTTNG_ERR_UND, "Largest out-of-range command is rejected: ret = %d", ret);
+
+	ret = send_command(argv[1], LTTCOMM_SESSIOND_COMMAND_MIN, nullptr);
+	ok(ret == LTTNG_ERR_UND, "Command below the valid range is rejected: ret = %d", ret);
+
+	/* The session daemon must outlive the processing of the rejected commands. */
+	ret = send_command(argv[1],
+			   LTTCOMM_SESSIOND_COMMAND_START_TRACE,
+			   "invalid_command_missing_session");
+	ok(ret == LTTNG_ERR_SESS_NOT_FOUND,
+	   "Session daemon still processes commands after the rejected ones: ret = %d",
+	   ret);
+end:
+	return exit_status();
+}
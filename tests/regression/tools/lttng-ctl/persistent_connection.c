@@ -0,0 +1,259 @@
+/*
+ * persistent_connection.c
+ *
+ * Tests of the persistent session daemon connection shared by several
+ * threads.
+ *
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include <lttng/lttng.h>
+
+#include <inttypes.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <tap/tap.h>
+#include <utils.h>
+
+#define THREAD_COUNT	 8
+#define ITERATION_COUNT	 50
+#define NUM_TESTS	 (2 + 2 * THREAD_COUNT)
+#define SESSION_NAME_LEN 64
+#define BASE_PERIOD_US	 UINT64_C(1000000000)
+
+struct command_thread {
+	pthread_t thread;
+	struct lttng_session_daemon_connection *connection;
+	const char *trace_path;
+	unsigned int round;
+	unsigned int id;
+	bool started;
+	bool success;
+};
+
+/* Check that the only rotation schedule of a session has the expected period. */
+static bool has_periodic_schedule(const char *session_name, uint64_t expected_period_us)
+{
+	bool matches = false;
+	int ret;
+	unsigned int count;
+	uint64_t period_us;
+	struct lttng_rotation_schedules *schedules = NULL;
+	const struct lttng_rotation_schedule *schedule;
+
+	ret = lttng_session_list_rotation_schedules(session_name, &schedules);
+	if (ret != LTTNG_OK) {
+		diag("Failed to list the rotation schedules of session `%s`: %s",
+		     session_name,
+		     lttng_strerror(-ret));
+		goto end;
+	}
+
+	if (lttng_rotation_schedules_get_count(schedules, &count) != LTTNG_ROTATION_STATUS_OK ||
+	    count != 1) {
+		diag("Unexpected rotation schedule count for session `%s`", session_name);
+		goto end;
+	}
+
+	schedule = lttng_rotation_schedules_get_at_index(schedules, 0);
+	if (!schedule ||
+	    lttng_rotation_schedule_periodic_get_period(schedule, &period_us) !=
+		    LTTNG_ROTATION_STATUS_OK) {
+		diag("Failed to get the rotation schedule period of session `%s`", session_name);
+		goto end;
+	}
+
+	matches = period_us == expected_period_us;
+	if (!matches) {
+		diag("Reply doesn't match the command: session = `%s`, period = %" PRIu64
+		     " us, expected period = %" PRIu64 " us",
+		     session_name,
+		     period_us,
+		     expected_period_us);
+	}
+
+end:
+	lttng_rotation_schedules_destroy(schedules);
+	return matches;
+}
+
+/*
+ * Each iteration sends commands of which the replies are specific to the
+ * thread and iteration: a wrong pairing of the replies with the commands,
+ * on the shared connection, makes them mismatch.
+ */
+static bool send_commands(const struct command_thread *thread, const char *session_name)
+{
+	bool success = false;
+	int ret;
+	unsigned int i;
+	char missing_session_name[SESSION_NAME_LEN];
+	struct lttng_rotation_schedule *schedule = lttng_rotation_schedule_periodic_create();
+
+	if (!schedule) {
+		diag("Failed to create periodic rotation schedule");
+		goto end;
+	}
+
+	snprintf(missing_session_name,
+		 sizeof(missing_session_name),
+		 "persistent_connection_missing_%u_%u",
+		 thread->round,
+		 thread->id);
+
+	for (i = 0; i < ITERATION_COUNT; i++) {
+		const uint64_t period_us = BASE_PERIOD_US * (thread->id + 1) + i;
+		enum lttng_rotation_status status;
+
+		if (lttng_rotation_schedule_periodic_set_period(schedule, period_us) !=
+		    LTTNG_ROTATION_STATUS_OK) {
+			diag("Failed to set the period of the rotation schedule");
+			goto end;
+		}
+
+		status = lttng_session_add_rotation_schedule(session_name, schedule);
+		if (status != LTTNG_ROTATION_STATUS_OK) {
+			diag("Failed to add rotation schedule to session `%s`", session_name);
+			goto end;
+		}
+
+		if (!has_periodic_schedule(session_name, period_us)) {
+			goto end;
+		}
+
+		/* An error reply interleaved with the successful ones. */
+		ret = lttng_start_tracing(missing_session_name);
+		if (ret != -LTTNG_ERR_SESS_NOT_FOUND) {
+			diag("Unexpected reply to the start of a missing session: ret = %d", ret);
+			goto end;
+		}
+
+		status = lttng_session_remove_rotation_schedule(session_name, schedule);
+		if (status != LTTNG_ROTATION_STATUS_OK) {
+			diag("Failed to remove rotation schedule of session `%s`", session_name);
+			goto end;
+		}
+	}
+
+	success = true;
+end:
+	lttng_rotation_schedule_destroy(schedule);
+	return success;
+}
+
+static void *command_thread_func(void *data)
+{
+	int ret;
+	struct command_thread *thread = (struct command_thread *) data;
+	char session_name[SESSION_NAME_LEN];
+	char session_path[PATH_MAX];
+
+	lttng_set_session_daemon_connection(thread->connection);
+
+	snprintf(session_name,
+		 sizeof(session_name),
+		 "persistent_connection_%u_%u",
+		 thread->round,
+		 thread->id);
+	snprintf(session_path, sizeof(session_path), "%s/%s", thread->trace_path, session_name);
+
+	ret = lttng_create_session(session_name, session_path);
+	if (ret) {
+		diag("Failed to create session `%s`: %s", session_name, lttng_strerror(ret));
+		return NULL;
+	}
+
+	thread->success = send_commands(thread, session_name);
+
+	ret = lttng_destroy_session(session_name);
+	if (ret) {
+		diag("Failed to destroy session `%s`: %s", session_name, lttng_strerror(ret));
+		thread->success = false;
+	}
+
+	return NULL;
+}
+
+/* Send commands from several threads sharing `connection`. */
+static void test_concurrent_commands(struct lttng_session_daemon_connection *connection,
+				     const char *trace_path,
+				     unsigned int round)
+{
+	unsigned int i;
+	struct command_thread threads[THREAD_COUNT] = {};
+
+	for (i = 0; i < THREAD_COUNT; i++) {
+		threads[i].connection = connection;
+		threads[i].trace_path = trace_path;
+		threads[i].round = round;
+		threads[i].id = i;
+		threads[i].started = !pthread_create(
+			&threads[i].thread, NULL, command_thread_func, &threads[i]);
+		if (!threads[i].started) {
+			diag("Failed to create command thread %u", i);
+		}
+	}
+
+	for (i = 0; i < THREAD_COUNT; i++) {
+		if (threads[i].started && pthread_join(threads[i].thread, NULL)) {
+			diag("Failed to join command thread %u", i);
+			threads[i].success = false;
+		}
+
+		ok(threads[i].success,
+		   "Replies to the concurrent commands of thread %u match the commands (round %u)",
+		   i,
+		   round);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+	struct lttng_session_daemon_connection *connection;
+	struct lttng_session *sessions = NULL;
+
+	plan_tests(NUM_TESTS);
+
+	if (argc < 4) {
+		diag("Usage: persistent_connection TRACE_PATH READY_FILE RESTARTED_FILE");
+		goto end;
+	}
+
+	/* Writing to the connection after the session daemon exited fails with EPIPE. */
+	signal(SIGPIPE, SIG_IGN);
+
+	connection = lttng_session_daemon_connection_create();
+	ok(connection, "Persistent session daemon connection created");
+	if (!connection) {
+		goto end;
+	}
+
+	lttng_set_session_daemon_connection(connection);
+	test_concurrent_commands(connection, argv[1], 0);
+
+	/* Break the connection: the test script restarts the session daemon. */
+	if (create_file(argv[2]) || wait_on_file(argv[3])) {
+		diag("Failed to synchronize with the restart of the session daemon");
+	}
+
+	ret = lttng_list_sessions(&sessions);
+	ok(ret == 0,
+	   "Command falls back to its own connection once the persistent connection broke");
+	free(sessions);
+
+	test_concurrent_commands(connection, argv[1], 1);
+
+	lttng_set_session_daemon_connection(NULL);
+	lttng_session_daemon_connection_destroy(connection);
+end:
+	return exit_status();
+}
@@ -0,0 +1,319 @@
+/*
+ * bulk_tracker_api.c
+ *
+ * Tests for the process attribute tracker inclusion set bulk update API
+ *
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include <lttng/lttng.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <tap/tap.h>
+#include <unistd.h>
+
+#define NUM_TESTS 32
+
+const char *session_name;
+
+/* Build a set of process ID values; returns NULL on error. */
+static struct lttng_process_attr_values *create_pid_values(const pid_t *pids, unsigned int count)
+{
+	unsigned int i;
+	struct lttng_process_attr_values *values = lttng_process_attr_values_create();
+
+	if (!values) {
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (lttng_process_attr_values_add_pid(values, pids[i]) !=
+		    LTTNG_PROCESS_ATTR_VALUES_STATUS_OK) {
+			lttng_process_attr_values_destroy(values);
+			values = NULL;
+			goto end;
+		}
+	}
+end:
+	return values;
+}
+
+static bool values_contain_pid(const struct lttng_process_attr_values *values, pid_t pid)
+{
+	unsigned int count, i;
+
+	if (lttng_process_attr_values_get_count(values, &count) !=
+	    LTTNG_PROCESS_ATTR_VALUES_STATUS_OK) {
+		return false;
+	}
+
+	for (i = 0; i < count; i++) {
+		pid_t value;
+
+		if (lttng_process_attr_values_get_pid_at_index(values, i, &value) !=
+		    LTTNG_PROCESS_ATTR_VALUES_STATUS_OK) {
+			return false;
+		}
+
+		if (value == pid) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Check that a set of process ID values contains exactly the expected
+ * process IDs, in any order.
+ */
+static bool pid_values_equal(const struct lttng_process_attr_values *values,
+			     const pid_t *expected_pids,
+			     unsigned int expected_count)
+{
+	unsigned int count, i;
+
+	if (!values ||
+	    lttng_process_attr_values_get_count(values, &count) !=
+		    LTTNG_PROCESS_ATTR_VALUES_STATUS_OK) {
+		diag("Failed to get the count of process attribute values");
+		return false;
+	}
+
+	if (count != expected_count) {
+		diag("Unexpected value count: expected %u, got %u", expected_count, count);
+		return false;
+	}
+
+	for (i = 0; i < expected_count; i++) {
+		if (!values_contain_pid(values, expected_pids[i])) {
+			diag("Process ID %d is missing", (int) expected_pids[i]);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Check the inclusion set of a tracker against the expected process IDs. */
+static bool inclusion_set_equal(struct lttng_process_attr_tracker_handle *tracker,
+				const pid_t *expected_pids,
+				unsigned int expected_count)
+{
+	const struct lttng_process_attr_values *values;
+
+	if (lttng_process_attr_tracker_handle_get_inclusion_set(tracker, &values) !=
+	    LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK) {
+		diag("Failed to get the tracker's inclusion set");
+		return false;
+	}
+
+	return pid_values_equal(values, expected_pids, expected_count);
+}
+
+static void test_add_values(struct lttng_process_attr_tracker_handle *tracker)
+{
+	const pid_t pids[] = { 10, 20, 30, 20 };
+	const pid_t expected_pids[] = { 10, 20, 30 };
+	const pid_t overlapping_pids[] = { 20, 40 };
+	const pid_t expected_added_pids[] = { 40 };
+	const pid_t expected_final_pids[] = { 10, 20, 30, 40 };
+	struct lttng_process_attr_values *values = create_pid_values(pids, 4);
+	struct lttng_process_attr_values *overlapping_values =
+		create_pid_values(overlapping_pids, 2);
+	struct lttng_process_attr_values *added_values = NULL;
+	enum lttng_process_attr_tracker_handle_status status;
+
+	status = lttng_process_attr_tracker_handle_set_tracking_policy(
+		tracker, LTTNG_TRACKING_POLICY_INCLUDE_SET);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK,
+	   "Set the tracking policy to the inclusion set");
+	ok(inclusion_set_equal(tracker, NULL, 0), "Inclusion set is initially empty");
+
+	status = lttng_process_attr_tracker_handle_add_values(tracker, values, &added_values);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK,
+	   "Add a set of values containing a duplicate");
+	ok(pid_values_equal(added_values, expected_pids, 3),
+	   "Duplicate value is only reported as added once");
+	ok(inclusion_set_equal(tracker, expected_pids, 3), "Inclusion set contains the added values");
+	lttng_process_attr_values_destroy(added_values);
+	added_values = NULL;
+
+	status = lttng_process_attr_tracker_handle_add_values(
+		tracker, overlapping_values, &added_values);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK,
+	   "Add a set of values overlapping the inclusion set");
+	ok(pid_values_equal(added_values, expected_added_pids, 1),
+	   "Only the values that were not tracked are reported as added");
+	ok(inclusion_set_equal(tracker, expected_final_pids, 4),
+	   "Inclusion set contains the union of both sets");
+
+	lttng_process_attr_values_destroy(added_values);
+	lttng_process_attr_values_destroy(overlapping_values);
+	lttng_process_attr_values_destroy(values);
+}
+
+static void test_remove_values(struct lttng_process_attr_tracker_handle *tracker)
+{
+	const pid_t pids[] = { 10, 50 };
+	const pid_t expected_removed_pids[] = { 10 };
+	const pid_t expected_pids[] = { 20, 30, 40 };
+	struct lttng_process_attr_values *values = create_pid_values(pids, 2);
+	struct lttng_process_attr_values *removed_values = NULL;
+	enum lttng_process_attr_tracker_handle_status status;
+
+	status = lttng_process_attr_tracker_handle_remove_values(tracker, values, &removed_values);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK,
+	   "Remove a set of values, some of which are not tracked");
+	ok(pid_values_equal(removed_values, expected_removed_pids, 1),
+	   "Only the tracked values are reported as removed");
+	ok(inclusion_set_equal(tracker, expected_pids, 3),
+	   "Removed values are no longer part of the inclusion set");
+
+	status = lttng_process_attr_tracker_handle_remove_values(tracker, values, NULL);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK,
+	   "Removing values that are not tracked succeeds");
+	ok(inclusion_set_equal(tracker, expected_pids, 3), "Inclusion set is unchanged");
+
+	lttng_process_attr_values_destroy(removed_values);
+	lttng_process_attr_values_destroy(values);
+}
+
+static void test_set_inclusion_set(struct lttng_process_attr_tracker_handle *tracker)
+{
+	const pid_t pids[] = { 30, 60, 60 };
+	const pid_t expected_pids[] = { 30, 60 };
+	struct lttng_process_attr_values *values = create_pid_values(pids, 3);
+	struct lttng_process_attr_values *empty_values = lttng_process_attr_values_create();
+	enum lttng_process_attr_tracker_handle_status status;
+
+	status = lttng_process_attr_tracker_handle_set_inclusion_set(tracker, values);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK,
+	   "Replace the inclusion set with a partially overlapping set");
+	ok(inclusion_set_equal(tracker, expected_pids, 2),
+	   "Inclusion set only contains the new values");
+
+	status = lttng_process_attr_tracker_handle_set_inclusion_set(tracker, values);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK,
+	   "Replace the inclusion set with an identical set");
+	ok(inclusion_set_equal(tracker, expected_pids, 2), "Inclusion set is unchanged");
+
+	status = lttng_process_attr_tracker_handle_set_inclusion_set(tracker, empty_values);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK,
+	   "Replace the inclusion set with an empty set");
+	ok(inclusion_set_equal(tracker, NULL, 0), "Inclusion set is empty");
+
+	lttng_process_attr_values_destroy(empty_values);
+	lttng_process_attr_values_destroy(values);
+}
+
+static void test_policy_transitions(struct lttng_process_attr_tracker_handle *tracker)
+{
+	const pid_t pids[] = { 70, 80 };
+	struct lttng_process_attr_values *values = create_pid_values(pids, 2);
+	enum lttng_process_attr_tracker_handle_status status;
+	enum lttng_tracking_policy policy;
+
+	status = lttng_process_attr_tracker_handle_set_inclusion_set(tracker, values);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK,
+	   "Populate the inclusion set before changing the policy");
+
+	status = lttng_process_attr_tracker_handle_set_tracking_policy(tracker,
+								      LTTNG_TRACKING_POLICY_INCLUDE_ALL);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK,
+	   "Set the tracking policy to include all");
+
+	status = lttng_process_attr_tracker_handle_add_values(tracker, values, NULL);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_INVALID_TRACKING_POLICY,
+	   "Adding values is refused when all processes are included");
+	status = lttng_process_attr_tracker_handle_remove_values(tracker, values, NULL);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_INVALID_TRACKING_POLICY,
+	   "Removing values is refused when all processes are included");
+	status = lttng_process_attr_tracker_handle_set_inclusion_set(tracker, values);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_INVALID_TRACKING_POLICY,
+	   "Replacing the inclusion set is refused when all processes are included");
+
+	status = lttng_process_attr_tracker_handle_get_tracking_policy(tracker, &policy);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK &&
+		   policy == LTTNG_TRACKING_POLICY_INCLUDE_ALL,
+	   "Refused updates leave the tracking policy unchanged");
+
+	status = lttng_process_attr_tracker_handle_set_tracking_policy(
+		tracker, LTTNG_TRACKING_POLICY_INCLUDE_SET);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK,
+	   "Set the tracking policy back to the inclusion set");
+	ok(inclusion_set_equal(tracker, NULL, 0),
+	   "Inclusion set is empty after including all processes");
+
+	lttng_process_attr_values_destroy(values);
+}
+
+static void test_unknown_user_name(struct lttng_process_attr_tracker_handle *tracker)
+{
+	struct lttng_process_attr_values *values = lttng_process_attr_values_create();
+	const struct lttng_process_attr_values *inclusion_set;
+	enum lttng_process_attr_tracker_handle_status status;
+	unsigned int count = 1;
+
+	lttng_process_attr_values_add_uid(values, getuid());
+	lttng_process_attr_values_add_user_name(values, "lttng_unexisting_user");
+
+	status = lttng_process_attr_tracker_handle_set_tracking_policy(
+		tracker, LTTNG_TRACKING_POLICY_INCLUDE_SET);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK,
+	   "Set the user ID tracking policy to the inclusion set");
+
+	status = lttng_process_attr_tracker_handle_add_values(tracker, values, NULL);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_USER_NOT_FOUND,
+	   "Adding an unknown user name fails");
+
+	status = lttng_process_attr_tracker_handle_get_inclusion_set(tracker, &inclusion_set);
+	ok(status == LTTNG_PROCESS_ATTR_TRACKER_HANDLE_STATUS_OK &&
+		   lttng_process_attr_values_get_count(inclusion_set, &count) ==
+			   LTTNG_PROCESS_ATTR_VALUES_STATUS_OK &&
+		   count == 0,
+	   "Failed update leaves the inclusion set unchanged");
+
+	lttng_process_attr_values_destroy(values);
+}
+
+int main(int argc, char **argv)
+{
+	enum lttng_error_code ret_code;
+	struct lttng_process_attr_tracker_handle *vpid_tracker = NULL;
+	struct lttng_process_attr_tracker_handle *vuid_tracker = NULL;
+
+	plan_tests(NUM_TESTS);
+
+	if (argc < 2) {
+		diag("Usage: bulk_tracker_api SESSION_NAME");
+		goto end;
+	}
+
+	session_name = argv[1];
+
+	ret_code = lttng_session_get_tracker_handle(
+		session_name, LTTNG_DOMAIN_UST, LTTNG_PROCESS_ATTR_VIRTUAL_PROCESS_ID, &vpid_tracker);
+	ok(ret_code == LTTNG_OK, "Get the virtual process ID tracker handle");
+	ret_code = lttng_session_get_tracker_handle(
+		session_name, LTTNG_DOMAIN_UST, LTTNG_PROCESS_ATTR_VIRTUAL_USER_ID, &vuid_tracker);
+	ok(ret_code == LTTNG_OK, "Get the virtual user ID tracker handle");
+	if (!vpid_tracker || !vuid_tracker) {
+		goto end;
+	}
+
+	test_add_values(vpid_tracker);
+	test_remove_values(vpid_tracker);
+	test_set_inclusion_set(vpid_tracker);
+	test_policy_transitions(vpid_tracker);
+	test_unknown_user_name(vuid_tracker);
+end:
+	lttng_process_attr_tracker_handle_destroy(vuid_tracker);
+	lttng_process_attr_tracker_handle_destroy(vpid_tracker);
+	return exit_status();
+}
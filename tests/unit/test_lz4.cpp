@@ -0,0 +1,229 @@
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ */
+
+#include <common/lz4.hpp>
+
+#include <stdint.h>
+#include <string.h>
+#include <tap/tap.h>
+#include <vector>
+
+#define NUM_TESTS 23
+
+/* For error.h */
+int lttng_opt_quiet = 1;
+int lttng_opt_verbose;
+int lttng_opt_mi;
+
+namespace {
+const char guard_byte = 0x5a;
+
+/* Size of the buffer able to hold the compressed block of any input. */
+std::size_t compress_bound(std::size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+/* Repetitive text, similar to TSDL metadata. */
+std::vector<char> make_text(std::size_t size)
+{
+	static const char pattern[] =
+		"event {\n\tname = \"tp:event\";\n\tid = 42;\n\tstream_id = 0;\n"
+		"\tfields := struct {\n\t\tinteger { size = 32; align = 8; } _field;\n\t};\n};\n";
+	std::vector<char> text;
+
+	text.reserve(size);
+	for (std::size_t i = 0; i < size; i++) {
+		text.push_back(pattern[i % (sizeof(pattern) - 1)]);
+	}
+
+	return text;
+}
+
+/* Incompressible content. */
+std::vector<char> make_random(std::size_t size)
+{
+	std::vector<char> data;
+	uint32_t state = 0x12345678;
+
+	data.reserve(size);
+	for (std::size_t i = 0; i < size; i++) {
+		state = state * 1103515245 + 12345;
+		data.push_back(static_cast<char>(state >> 24));
+	}
+
+	return data;
+}
+
+std::vector<char> compress(const std::vector<char>& data)
+{
+	std::vector<char> block(compress_bound(data.size()));
+	const auto size =
+		lttng::lz4::compress_block(data.data(), data.size(), block.data(), block.size());
+
+	block.resize(size);
+	return block;
+}
+
+bool decompresses_to(const std::vector<char>& block, const std::vector<char>& expected)
+{
+	std::vector<char> data(expected.size() + 1, guard_byte);
+
+	if (!lttng::lz4::decompress_block(
+		    block.data(), block.size(), data.data(), expected.size())) {
+		return false;
+	}
+
+	return (expected.empty() || !memcmp(data.data(), expected.data(), expected.size())) &&
+		data[expected.size()] == guard_byte;
+}
+
+bool round_trips(const std::vector<char>& data)
+{
+	const auto block = compress(data);
+
+	return !block.empty() && decompresses_to(block, data);
+}
+
+bool decompress_fails(const std::vector<char>& block, std::size_t dst_size)
+{
+	std::vector<char> data(dst_size + 1, guard_byte);
+
+	return !lttng::lz4::decompress_block(block.data(), block.size(), data.data(), dst_size) &&
+		data[dst_size] == guard_byte;
+}
+
+/*
+ * One literal followed by a four byte match at `offset` and twelve final
+ * literals. The block expands to seventeen bytes.
+ */
+std::vector<char> make_match_block(uint16_t offset)
+{
+	std::vector<char> block = { 0x10, 'a', static_cast<char>(offset & 0xff),
+				    static_cast<char>(offset >> 8), static_cast<char>(0xc0) };
+	const char final_literals[] = "0123456789ab";
+
+	block.insert(block.end(), final_literals, final_literals + 12);
+	return block;
+}
+
+void test_round_trip()
+{
+	const auto text = make_text(4096);
+	const std::vector<char> run(10000, 'x');
+
+	ok(round_trips({}), "Empty input round-trips");
+	ok(round_trips({ 'a' }), "Single byte round-trips");
+	ok(round_trips(make_text(12)), "Input too short to hold a match round-trips");
+	ok(round_trips(text), "Text round-trips");
+	ok(compress(text).size() < text.size(), "Text is compressed");
+	ok(round_trips(make_random(4096)), "Incompressible input round-trips");
+	ok(round_trips(run), "Run of identical bytes (overlapping match) round-trips");
+}
+
+void test_output_limit()
+{
+	const auto text = make_text(4096);
+	const auto block = compress(text);
+	std::vector<char> dst(block.size() + 1, guard_byte);
+	std::size_t size;
+
+	size = lttng::lz4::compress_block(text.data(), text.size(), dst.data(), block.size());
+	ok(size == block.size() && !memcmp(dst.data(), block.data(), block.size()),
+	   "Block fitting exactly in the output buffer is produced");
+
+	dst.assign(block.size() + 1, guard_byte);
+	size = lttng::lz4::compress_block(text.data(), text.size(), dst.data(), block.size() - 1);
+	ok(size == 0, "Block exceeding the output buffer by one byte is not produced");
+	ok(dst[block.size() - 1] == guard_byte && dst[block.size()] == guard_byte,
+	   "Compression doesn't write past the output buffer");
+
+	ok(decompress_fails(block, text.size() - 1),
+	   "Decompression into a buffer one byte too small fails without overflowing it");
+	ok(decompress_fails(block, text.size() + 1),
+	   "Decompression of a block shorter than the expected size fails");
+}
+
+void test_truncated_input()
+{
+	const auto text_block = compress(make_text(4096));
+	const auto random_block = compress(make_random(512));
+	bool all_failed = true;
+
+	for (std::size_t size = 0; size < text_block.size(); size++) {
+		const std::vector<char> prefix(text_block.begin(), text_block.begin() + size);
+
+		all_failed &= decompress_fails(prefix, 4096);
+	}
+
+	ok(all_failed, "Every truncation of a compressed block is rejected");
+
+	all_failed = true;
+	for (std::size_t size = 0; size < random_block.size(); size++) {
+		const std::vector<char> prefix(random_block.begin(), random_block.begin() + size);
+
+		all_failed &= decompress_fails(prefix, 512);
+	}
+
+	ok(all_failed, "Every truncation of a literal block is rejected");
+	ok(decompress_fails({}, 0), "Empty block is rejected");
+}
+
+void test_offset_before_start()
+{
+	std::vector<char> expected = { 'a', 'a', 'a', 'a', 'a' };
+	const char final_literals[] = "0123456789ab";
+
+	expected.insert(expected.end(), final_literals, final_literals + 12);
+	ok(decompresses_to(make_match_block(1), expected), "Match within the output is copied");
+	ok(decompress_fails(make_match_block(2), 17),
+	   "Match offset one byte before the start of the output is rejected");
+	ok(decompress_fails(make_match_block(UINT16_MAX), 17),
+	   "Maximal match offset before the start of the output is rejected");
+}
+
+void test_length_overflow()
+{
+	std::vector<char> block;
+
+	block = { static_cast<char>(0xf0) };
+	block.insert(block.end(), 100, static_cast<char>(0xff));
+	block.push_back(0);
+	ok(decompress_fails(block, 64), "Literal length exceeding the output is rejected");
+
+	block = { static_cast<char>(0xf0), static_cast<char>(0xff), static_cast<char>(0xff) };
+	ok(decompress_fails(block, 64), "Truncated literal length is rejected");
+
+	block = { 0x50, 'a', 'b', 'c' };
+	ok(decompress_fails(block, 5), "Literal length exceeding the input is rejected");
+
+	block = { static_cast<char>(0xf0) };
+	block.insert(block.end(), 70000, static_cast<char>(0xff));
+	block.push_back(0);
+	ok(decompress_fails(block, 1 << 20),
+	   "Literal length continuation exceeding the output is rejected");
+
+	block = make_match_block(1);
+	block[0] = 0x1f;
+	block.insert(block.begin() + 4, 100, static_cast<char>(0xff));
+	block.insert(block.begin() + 104, 1, 0);
+	ok(decompress_fails(block, 17), "Match length exceeding the output is rejected");
+}
+} /* namespace */
+
+int main()
+{
+	plan_tests(NUM_TESTS);
+
+	test_round_trip();
+	test_output_limit();
+	test_truncated_input();
+	test_offset_before_start();
+	test_length_overflow();
+
+	return exit_status();
+}
@@ -0,0 +1,454 @@
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ */
+
+#include <common/dynamic-array.hpp>
+#include <common/macros.hpp>
+#include <common/tracker.hpp>
+
+#include <bin/lttng-sessiond/tracker.hpp>
+
+#include <lttng/tracker.h>
+
+#include <algorithm>
+#include <iterator>
+#include <stdlib.h>
+#include <string.h>
+#include <tap/tap.h>
+#include <vector>
+
+/* Number of TAP tests in this file */
+#define NUM_TESTS 38
+
+#ifdef HAVE_LIBLTTNG_UST_CTL
+#include <lttng/lttng-export.h>
+#include <lttng/ust-sigbus.h>
+LTTNG_EXPORT DEFINE_LTTNG_UST_SIGBUS_STATE();
+#endif
+
+namespace {
+using id_set = lttng::sessiond::process_attr_id_set;
+
+std::vector<id_set::id> get_ids(const id_set& set)
+{
+	std::vector<id_set::id> ids;
+
+	set.for_each([&ids](id_set::id id) { ids.emplace_back(id); });
+	return ids;
+}
+
+std::vector<id_set::id> make_range(id_set::id first, id_set::id count, id_set::id stride = 1)
+{
+	std::vector<id_set::id> ids;
+
+	for (id_set::id i = 0; i < count; i++) {
+		ids.emplace_back(first + i * stride);
+	}
+
+	return ids;
+}
+
+void append_pid(struct lttng_process_attr_values *values, pid_t pid)
+{
+	auto *value = zmalloc<process_attr_value>();
+
+	LTTNG_ASSERT(value);
+	value->type = LTTNG_PROCESS_ATTR_VALUE_TYPE_PID;
+	value->value.pid = pid;
+	LTTNG_ASSERT(!lttng_dynamic_pointer_array_add_pointer(&values->array, value));
+}
+
+void append_user_name(struct lttng_process_attr_values *values, const char *name)
+{
+	auto *value = zmalloc<process_attr_value>();
+
+	LTTNG_ASSERT(value);
+	value->type = LTTNG_PROCESS_ATTR_VALUE_TYPE_USER_NAME;
+	value->value.user_name = strdup(name);
+	LTTNG_ASSERT(value->value.user_name);
+	LTTNG_ASSERT(!lttng_dynamic_pointer_array_add_pointer(&values->array, value));
+}
+
+struct lttng_process_attr_values *make_pids(const std::vector<pid_t>& pids)
+{
+	auto *values = lttng_process_attr_values_create();
+
+	LTTNG_ASSERT(values);
+	for (const auto pid : pids) {
+		append_pid(values, pid);
+	}
+
+	return values;
+}
+
+/* Sorted PIDs of a set of values; the other types of values are ignored. */
+std::vector<pid_t> get_pids(const struct lttng_process_attr_values *values)
+{
+	std::vector<pid_t> pids;
+
+	for (unsigned int i = 0; i < _lttng_process_attr_values_get_count(values); i++) {
+		const auto *value = lttng_process_attr_tracker_values_get_at_index(values, i);
+
+		if (value->type == LTTNG_PROCESS_ATTR_VALUE_TYPE_PID) {
+			pids.emplace_back(value->value.pid);
+		}
+	}
+
+	std::sort(pids.begin(), pids.end());
+	return pids;
+}
+
+std::vector<pid_t> get_tracker_pids(const struct process_attr_tracker *tracker)
+{
+	struct lttng_process_attr_values *values = nullptr;
+	std::vector<pid_t> pids;
+
+	if (process_attr_tracker_get_inclusion_set(tracker, &values) ==
+	    PROCESS_ATTR_TRACKER_STATUS_OK) {
+		pids = get_pids(values);
+		lttng_process_attr_values_destroy(values);
+	}
+
+	return pids;
+}
+
+enum process_attr_tracker_status
+update_tracker(struct process_attr_tracker *tracker,
+	       enum process_attr_tracker_inclusion_set_operation operation,
+	       const std::vector<pid_t>& pids,
+	       std::vector<pid_t> *added_pids = nullptr,
+	       std::vector<pid_t> *removed_pids = nullptr)
+{
+	struct lttng_process_attr_values *values = make_pids(pids);
+	struct lttng_process_attr_values *added_values = nullptr;
+	struct lttng_process_attr_values *removed_values = nullptr;
+
+	const auto status = process_attr_tracker_inclusion_set_update(
+		tracker, operation, values, &added_values, &removed_values);
+	if (status == PROCESS_ATTR_TRACKER_STATUS_OK) {
+		if (added_pids) {
+			*added_pids = get_pids(added_values);
+		}
+
+		if (removed_pids) {
+			*removed_pids = get_pids(removed_values);
+		}
+	}
+
+	lttng_process_attr_values_destroy(values);
+	lttng_process_attr_values_destroy(added_values);
+	lttng_process_attr_values_destroy(removed_values);
+	return status;
+}
+
+void test_id_set_insert_erase()
+{
+	id_set set;
+
+	ok(set.insert(42) && set.insert(7) && set.size() == 2, "Insert values in an empty set");
+	ok(!set.insert(42) && set.size() == 2, "Inserting a duplicate value is ignored");
+	ok(set.contains(7) && set.contains(42) && !set.contains(8),
+	   "Set contains the inserted values only");
+	ok(get_ids(set) == std::vector<id_set::id>({ 7, 42 }),
+	   "Values are visited in increasing order");
+	ok(set.erase(7) && !set.erase(7) && set.size() == 1,
+	   "Erasing a value only succeeds if it is part of the set");
+
+	set.clear();
+	ok(set.size() == 0 && !set.contains(42) && get_ids(set).empty(), "Clear empties the set");
+}
+
+void test_id_set_bulk_duplicates()
+{
+	id_set set;
+
+	set.insert(std::vector<id_set::id>({ 5, 3, 5, 1, 3, 3 }));
+	ok(get_ids(set) == std::vector<id_set::id>({ 1, 3, 5 }) && set.size() == 3,
+	   "Duplicates within a bulk insertion are ignored");
+
+	set.insert(std::vector<id_set::id>({ 3, 4, 1 }));
+	ok(get_ids(set) == std::vector<id_set::id>({ 1, 3, 4, 5 }) && set.size() == 4,
+	   "Bulk insertion of values already in the set only adds the new ones");
+
+	set.erase(std::vector<id_set::id>({ 4, 4, 9, 1 }));
+	ok(get_ids(set) == std::vector<id_set::id>({ 3, 5 }) && set.size() == 2,
+	   "Bulk erasure ignores duplicates and missing values");
+
+	set.insert(std::vector<id_set::id>());
+	set.erase(std::vector<id_set::id>());
+	ok(get_ids(set) == std::vector<id_set::id>({ 3, 5 }),
+	   "Empty bulk updates leave the set unchanged");
+}
+
+void test_id_set_dense()
+{
+	id_set set;
+	const auto dense_ids = make_range(1000, 4096);
+
+	/* Large enough and dense enough to be stored as a bitmap. */
+	set.insert(dense_ids);
+	ok(set.size() == dense_ids.size() && get_ids(set) == dense_ids,
+	   "Dense set contains all of its values, in order");
+	ok(!set.contains(999) && !set.contains(1000 + 4096) && set.contains(1000) &&
+		   set.contains(1000 + 4095),
+	   "Dense set doesn't contain the values surrounding its range");
+
+	ok(!set.insert(2000) && set.size() == dense_ids.size(),
+	   "Inserting a duplicate value in a dense set is ignored");
+
+	/* Extending the range downwards and upwards. */
+	ok(set.insert(900) && set.insert(5200) && set.contains(900) && set.contains(5200) &&
+		   set.size() == dense_ids.size() + 2,
+	   "Values can be inserted around the range of a dense set");
+
+	ok(set.erase(900) && set.erase(5200) && !set.erase(900) &&
+		   get_ids(set) == dense_ids,
+	   "Values can be erased at both ends of a dense set");
+
+	/* A far value makes the set sparse again. */
+	ok(set.insert(4000000000U) && set.contains(4000000000U) &&
+		   set.size() == dense_ids.size() + 1 && set.contains(1000),
+	   "Inserting a far value in a dense set keeps all values");
+
+	ok(set.erase(4000000000U) && get_ids(set) == dense_ids,
+	   "Erasing the far value restores the dense set");
+}
+
+void test_id_set_dense_to_sparse()
+{
+	id_set set;
+	const auto dense_ids = make_range(0, 1024);
+	const auto sparse_ids = make_range(0, 11, 97);
+
+	set.insert(dense_ids);
+
+	/* Erase all values but every 97th one. */
+	std::vector<id_set::id> erased_ids;
+
+	std::set_difference(dense_ids.begin(),
+			    dense_ids.end(),
+			    sparse_ids.begin(),
+			    sparse_ids.end(),
+			    std::back_inserter(erased_ids));
+	set.erase(erased_ids);
+	ok(get_ids(set) == sparse_ids && set.size() == sparse_ids.size(),
+	   "Erasing most values of a dense set keeps the remaining ones");
+
+	/* Erase the remaining values one by one. */
+	bool all_erased = true;
+
+	for (const auto id : sparse_ids) {
+		all_erased &= set.erase(id);
+	}
+
+	ok(all_erased && set.size() == 0 && get_ids(set).empty(),
+	   "Erasing all values one by one empties the set");
+
+	/* A set that is grown one value at a time is equivalent to a bulk insertion. */
+	for (const auto id : dense_ids) {
+		set.insert(id);
+	}
+
+	ok(get_ids(set) == dense_ids, "Inserting dense values one by one keeps all values");
+}
+
+void test_tracker_policy_transitions()
+{
+	auto *tracker = process_attr_tracker_create();
+	struct lttng_process_attr_values *values = nullptr;
+
+	LTTNG_ASSERT(tracker);
+	ok(process_attr_tracker_get_tracking_policy(tracker) == LTTNG_TRACKING_POLICY_INCLUDE_ALL,
+	   "A new tracker includes all processes");
+	ok(update_tracker(tracker, PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_ADD, { 1 }) ==
+		   PROCESS_ATTR_TRACKER_STATUS_INVALID_TRACKING_POLICY,
+	   "Updating the inclusion set of an include-all tracker is refused");
+	ok(process_attr_tracker_get_inclusion_set(tracker, &values) ==
+		   PROCESS_ATTR_TRACKER_STATUS_INVALID_TRACKING_POLICY,
+	   "An include-all tracker has no inclusion set");
+
+	ok(process_attr_tracker_set_tracking_policy(tracker, LTTNG_TRACKING_POLICY_INCLUDE_SET) ==
+			   0 &&
+		   get_tracker_pids(tracker).empty(),
+	   "Switching to the include-set policy starts with an empty set");
+	ok(update_tracker(tracker, PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_ADD, { 1, 2 }) ==
+			   PROCESS_ATTR_TRACKER_STATUS_OK &&
+		   get_tracker_pids(tracker) == std::vector<pid_t>({ 1, 2 }),
+	   "Values are added to the inclusion set");
+
+	ok(process_attr_tracker_set_tracking_policy(tracker, LTTNG_TRACKING_POLICY_INCLUDE_SET) ==
+			   0 &&
+		   get_tracker_pids(tracker) == std::vector<pid_t>({ 1, 2 }),
+	   "Setting the current policy again keeps the inclusion set");
+
+	ok(process_attr_tracker_set_tracking_policy(tracker, LTTNG_TRACKING_POLICY_EXCLUDE_ALL) ==
+			   0 &&
+		   update_tracker(tracker, PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_REMOVE, { 1 }) ==
+			   PROCESS_ATTR_TRACKER_STATUS_INVALID_TRACKING_POLICY,
+	   "Updating the inclusion set of an exclude-all tracker is refused");
+
+	ok(process_attr_tracker_set_tracking_policy(tracker, LTTNG_TRACKING_POLICY_INCLUDE_SET) ==
+			   0 &&
+		   get_tracker_pids(tracker).empty(),
+	   "The inclusion set is cleared by a transition through exclude-all");
+
+	ok(update_tracker(tracker, PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_ADD, { 3 }) ==
+			   PROCESS_ATTR_TRACKER_STATUS_OK &&
+		   process_attr_tracker_set_tracking_policy(tracker,
+							    LTTNG_TRACKING_POLICY_INCLUDE_ALL) == 0 &&
+		   process_attr_tracker_set_tracking_policy(tracker,
+							    LTTNG_TRACKING_POLICY_INCLUDE_SET) == 0 &&
+		   get_tracker_pids(tracker).empty(),
+	   "The inclusion set is cleared by a transition through include-all");
+
+	process_attr_tracker_destroy(tracker);
+}
+
+void test_tracker_bulk_updates()
+{
+	auto *tracker = process_attr_tracker_create();
+	std::vector<pid_t> added, removed;
+
+	LTTNG_ASSERT(tracker);
+	LTTNG_ASSERT(process_attr_tracker_set_tracking_policy(
+			     tracker, LTTNG_TRACKING_POLICY_INCLUDE_SET) == 0);
+
+	ok(update_tracker(tracker,
+			  PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_ADD,
+			  { 10, 20, 10, 30, 20 },
+			  &added,
+			  &removed) == PROCESS_ATTR_TRACKER_STATUS_OK &&
+		   added == std::vector<pid_t>({ 10, 20, 30 }) && removed.empty(),
+	   "Adding values with duplicates reports each added value once");
+
+	ok(update_tracker(tracker,
+			  PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_ADD,
+			  { 20, 40 },
+			  &added,
+			  &removed) == PROCESS_ATTR_TRACKER_STATUS_OK &&
+		   added == std::vector<pid_t>({ 40 }) && removed.empty() &&
+		   get_tracker_pids(tracker) == std::vector<pid_t>({ 10, 20, 30, 40 }),
+	   "Adding values already in the inclusion set only reports the new ones");
+
+	ok(update_tracker(tracker,
+			  PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_REMOVE,
+			  { 30, 50, 30 },
+			  &added,
+			  &removed) == PROCESS_ATTR_TRACKER_STATUS_OK &&
+		   added.empty() && removed == std::vector<pid_t>({ 30 }) &&
+		   get_tracker_pids(tracker) == std::vector<pid_t>({ 10, 20, 40 }),
+	   "Removing values only reports the values that were in the inclusion set");
+
+	ok(update_tracker(tracker,
+			  PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_REPLACE,
+			  { 40, 60, 10, 60 },
+			  &added,
+			  &removed) == PROCESS_ATTR_TRACKER_STATUS_OK &&
+		   added == std::vector<pid_t>({ 60 }) && removed == std::vector<pid_t>({ 20 }) &&
+		   get_tracker_pids(tracker) == std::vector<pid_t>({ 10, 40, 60 }),
+	   "Replacing the inclusion set reports the difference with the previous set");
+
+	ok(update_tracker(tracker,
+			  PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_REPLACE,
+			  {},
+			  &added,
+			  &removed) == PROCESS_ATTR_TRACKER_STATUS_OK &&
+		   added.empty() && removed == std::vector<pid_t>({ 10, 40, 60 }) &&
+		   get_tracker_pids(tracker).empty(),
+	   "Replacing the inclusion set by an empty set removes all values");
+
+	process_attr_tracker_destroy(tracker);
+}
+
+void test_tracker_revert_update()
+{
+	auto *tracker = process_attr_tracker_create();
+	auto *values = make_pids({ 2, 3, 4 });
+	struct lttng_process_attr_values *added_values = nullptr;
+	struct lttng_process_attr_values *removed_values = nullptr;
+
+	LTTNG_ASSERT(tracker);
+	LTTNG_ASSERT(process_attr_tracker_set_tracking_policy(
+			     tracker, LTTNG_TRACKING_POLICY_INCLUDE_SET) == 0);
+	LTTNG_ASSERT(update_tracker(tracker,
+				    PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_ADD,
+				    { 1, 2 }) == PROCESS_ATTR_TRACKER_STATUS_OK);
+
+	ok(process_attr_tracker_inclusion_set_update(
+		   tracker,
+		   PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_REPLACE,
+		   values,
+		   &added_values,
+		   &removed_values) == PROCESS_ATTR_TRACKER_STATUS_OK &&
+		   get_tracker_pids(tracker) == std::vector<pid_t>({ 2, 3, 4 }),
+	   "Replace the inclusion set before reverting the update");
+
+	ok(process_attr_tracker_inclusion_set_revert_update(
+		   tracker, added_values, removed_values) == PROCESS_ATTR_TRACKER_STATUS_OK &&
+		   get_tracker_pids(tracker) == std::vector<pid_t>({ 1, 2 }),
+	   "Reverting an update restores the previous inclusion set");
+
+	lttng_process_attr_values_destroy(values);
+	lttng_process_attr_values_destroy(added_values);
+	lttng_process_attr_values_destroy(removed_values);
+	process_attr_tracker_destroy(tracker);
+}
+
+void test_tracker_names()
+{
+	auto *tracker = process_attr_tracker_create();
+	auto *values = lttng_process_attr_values_create();
+	struct lttng_process_attr_values *added_values = nullptr;
+	struct lttng_process_attr_values *inclusion_set = nullptr;
+
+	LTTNG_ASSERT(tracker);
+	LTTNG_ASSERT(values);
+	LTTNG_ASSERT(process_attr_tracker_set_tracking_policy(
+			     tracker, LTTNG_TRACKING_POLICY_INCLUDE_SET) == 0);
+
+	append_user_name(values, "bob");
+	append_user_name(values, "alice");
+	append_user_name(values, "bob");
+	append_pid(values, 12);
+
+	ok(process_attr_tracker_inclusion_set_update(tracker,
+						     PROCESS_ATTR_TRACKER_INCLUSION_SET_OPERATION_ADD,
+						     values,
+						     &added_values,
+						     nullptr) == PROCESS_ATTR_TRACKER_STATUS_OK &&
+		   _lttng_process_attr_values_get_count(added_values) == 3,
+	   "Adding names with duplicates reports each added value once");
+
+	ok(process_attr_tracker_get_inclusion_set(tracker, &inclusion_set) ==
+			   PROCESS_ATTR_TRACKER_STATUS_OK &&
+		   _lttng_process_attr_values_get_count(inclusion_set) == 3 &&
+		   get_pids(inclusion_set) == std::vector<pid_t>({ 12 }),
+	   "Inclusion set contains the PID and both user names");
+
+	lttng_process_attr_values_destroy(values);
+	lttng_process_attr_values_destroy(added_values);
+	lttng_process_attr_values_destroy(inclusion_set);
+	process_attr_tracker_destroy(tracker);
+}
+} /* namespace */
+
+int main()
+{
+	plan_tests(NUM_TESTS);
+
+	diag("Process attribute tracker unit tests");
+
+	test_id_set_insert_erase();
+	test_id_set_bulk_duplicates();
+	test_id_set_dense();
+	test_id_set_dense_to_sparse();
+	test_tracker_policy_transitions();
+	test_tracker_bulk_updates();
+	test_tracker_revert_update();
+	test_tracker_names();
+
+	return exit_status();
+}
@@ -0,0 +1,202 @@
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ */
+
+#include "live-session-list.hpp"
+#include "session.hpp"
+
+#include <common/compat/endian.hpp>
+
+#include <algorithm>
+#include <stdint.h>
+#include <string.h>
+#include <tap/tap.h>
+#include <urcu.h>
+
+#define NUM_TESTS 19
+
+/* Must match the limit of the live session list. */
+#define MAX_REMOVALS 4096
+
+/* For error.h */
+int lttng_opt_quiet = 1;
+int lttng_opt_verbose;
+int lttng_opt_mi;
+
+namespace {
+void add_session(uint64_t id, uint32_t stream_count)
+{
+	struct relay_session session = {};
+
+	session.id = id;
+	session.live_timer = 1000;
+	session.stream_count = stream_count;
+	strcpy(session.session_name, "session");
+	strcpy(session.hostname, "host");
+	live_session_list_add(&session);
+}
+
+/* Returns the listed descriptor of a session, or nullptr if it is not listed. */
+const struct lttng_viewer_session *find_session(const struct live_session_list_copy& copy,
+						uint64_t id)
+{
+	const auto it = std::find_if(copy.sessions.begin(),
+				     copy.sessions.end(),
+				     [id](const struct lttng_viewer_session& session) {
+					     return be64toh(session.id) == id;
+				     });
+
+	return it == copy.sessions.end() ? nullptr : &*it;
+}
+
+bool is_removed(const struct live_session_list_copy& copy, uint64_t id)
+{
+	return std::find(copy.removed_session_ids.begin(),
+			 copy.removed_session_ids.end(),
+			 htobe64(id)) != copy.removed_session_ids.end();
+}
+
+void test_snapshot()
+{
+	struct live_session_list_copy copy;
+	const struct lttng_viewer_session *session;
+	uint64_t version;
+
+	add_session(1, 2);
+	add_session(2, 0);
+	ok(live_session_list_get(&copy) == 0 && copy.is_full && copy.sessions.size() == 2,
+	   "Added sessions are listed");
+
+	session = find_session(copy, 1);
+	ok(session && be32toh(session->streams) == 2 && be32toh(session->live_timer) == 1000 &&
+		   be32toh(session->clients) == 0 && !strcmp(session->session_name, "session") &&
+		   !strcmp(session->hostname, "host"),
+	   "Descriptors are listed in the byte order of the live protocol");
+
+	version = copy.version;
+	live_session_list_set_stream_count(1, 2);
+	live_session_list_set_viewer_attached(3, true);
+	ok(live_session_list_get(&copy) == 0 && copy.version == version,
+	   "Unchanged and unlisted sessions don't change the version of the list");
+
+	live_session_list_set_stream_count(1, 3);
+	live_session_list_set_stream_count(1, 4);
+	live_session_list_set_viewer_attached(2, true);
+	ok(live_session_list_get(&copy) == 0 && copy.version == version + 3,
+	   "Every change increments the version of the list");
+
+	session = find_session(copy, 1);
+	ok(session && be32toh(session->streams) == 4,
+	   "Snapshot reflects the last of successive changes");
+	session = find_session(copy, 2);
+	ok(session && be32toh(session->clients) == 1, "Snapshot reflects viewer attachment");
+}
+
+void test_changes()
+{
+	struct live_session_list_copy copy;
+	uint64_t version;
+
+	ok(live_session_list_get_changes(0, &copy) == 0 && copy.is_full &&
+		   copy.sessions.size() == 2,
+	   "Changes since version 0 are all the listed sessions");
+
+	version = copy.version;
+	ok(live_session_list_get_changes(version, &copy) == 0 && !copy.is_full &&
+		   copy.version == version && copy.sessions.empty() &&
+		   copy.removed_session_ids.empty(),
+	   "No changes since the current version");
+
+	live_session_list_set_stream_count(2, 1);
+	add_session(3, 0);
+	live_session_list_remove(1);
+	ok(live_session_list_get_changes(version, &copy) == 0 && !copy.is_full &&
+		   copy.version == version + 3,
+	   "Changes since a known version are incremental");
+	ok(copy.sessions.size() == 2 && find_session(copy, 2) && find_session(copy, 3),
+	   "Modified and added sessions are reported");
+	ok(copy.removed_session_ids.size() == 1 && is_removed(copy, 1),
+	   "Removed session is reported");
+
+	ok(live_session_list_get_changes(version + 2, &copy) == 0 && !copy.is_full &&
+		   copy.sessions.empty() && copy.removed_session_ids.size() == 1,
+	   "Only the changes after the requested version are reported");
+
+	ok(live_session_list_get_changes(version + 4, &copy) == 0 && copy.is_full &&
+		   copy.sessions.size() == 2 && copy.removed_session_ids.empty(),
+	   "Changes since a future version resynchronize the viewer");
+}
+
+void test_removal_window()
+{
+	struct live_session_list_copy copy;
+	uint64_t version;
+	uint64_t id;
+
+	if (live_session_list_get(&copy)) {
+		diag("Failed to list the sessions");
+	}
+
+	/* Fill the removal window, one removal per session. */
+	version = copy.version;
+	for (id = 100; id < 100 + MAX_REMOVALS - 1; id++) {
+		add_session(id, 0);
+		live_session_list_remove(id);
+	}
+
+	ok(live_session_list_get_changes(version, &copy) == 0 && !copy.is_full &&
+		   copy.removed_session_ids.size() == MAX_REMOVALS - 1 &&
+		   is_removed(copy, 100) && is_removed(copy, id - 1),
+	   "Removals within the window are reported");
+
+	add_session(id, 0);
+	live_session_list_remove(id);
+	ok(live_session_list_get_changes(version, &copy) == 0 && !copy.is_full &&
+		   copy.removed_session_ids.size() == MAX_REMOVALS && is_removed(copy, id),
+	   "Removals filling the window are reported");
+
+	id++;
+	add_session(id, 0);
+	live_session_list_remove(id);
+	ok(live_session_list_get_changes(version, &copy) == 0 && copy.is_full &&
+		   copy.sessions.size() == 2 && copy.removed_session_ids.empty(),
+	   "Changes spanning a dropped removal resynchronize the viewer");
+
+	ok(live_session_list_get_changes(copy.version - 1, &copy) == 0 && !copy.is_full &&
+		   copy.sessions.empty() && copy.removed_session_ids.size() == 1 &&
+		   is_removed(copy, id),
+	   "Changes since a version within the window remain incremental");
+}
+
+void test_destroy()
+{
+	struct live_session_list_copy copy;
+
+	/* Leave a change unpublished. */
+	live_session_list_set_stream_count(2, 8);
+	live_session_list_destroy();
+	ok(live_session_list_get(&copy) == -1, "Destroyed list isn't published again");
+	ok(live_session_list_get_changes(0, &copy) == -1,
+	   "Changes of a destroyed list can't be listed");
+}
+} /* namespace */
+
+int main()
+{
+	plan_tests(NUM_TESTS);
+
+	rcu_register_thread();
+
+	test_snapshot();
+	test_changes();
+	test_removal_window();
+	test_destroy();
+
+	rcu_barrier();
+	rcu_unregister_thread();
+
+	return exit_status();
+}
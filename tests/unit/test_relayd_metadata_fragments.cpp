@@ -0,0 +1,200 @@
+/*
+ * SPDX-FileCopyrightText: 2025 EfficiOS Inc.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ */
+
+#include <common/buffer-view.hpp>
+#include <common/compat/endian.hpp>
+#include <common/dynamic-buffer.hpp>
+#include <common/sessiond-comm/relayd-metadata-fragments.hpp>
+#include <common/sessiond-comm/relayd.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <tap/tap.h>
+
+#define NUM_TESTS 11
+
+/* For error.h */
+int lttng_opt_quiet = 1;
+int lttng_opt_verbose;
+int lttng_opt_mi;
+
+namespace {
+const uint64_t stream_id = 42;
+const uint32_t padding_size = 128;
+
+std::string make_metadata(std::size_t event_count)
+{
+	std::string metadata = "/* CTF 1.8 */\n\ntrace {\n\tmajor = 1;\n\tminor = 8;\n};\n\n";
+
+	for (std::size_t i = 0; i < event_count; i++) {
+		metadata += "event {\n\tname = \"tp:event_" + std::to_string(i) +
+			"\";\n\tid = " + std::to_string(i) +
+			";\n\tstream_id = 0;\n\tfields := struct {\n"
+			"\t\tinteger { size = 32; align = 8; signed = 1; } _value;\n\t};\n};\n\n";
+	}
+
+	return metadata;
+}
+
+std::string make_random(std::size_t size)
+{
+	std::string data;
+	uint32_t state = 0x12345678;
+
+	data.reserve(size);
+	for (std::size_t i = 0; i < size; i++) {
+		state = state * 1103515245 + 12345;
+		data.push_back(static_cast<char>(state >> 24));
+	}
+
+	return data;
+}
+
+/* Dynamic buffer released when going out of scope. */
+struct scoped_buffer {
+	scoped_buffer()
+	{
+		lttng_dynamic_buffer_init(&buffer);
+	}
+
+	~scoped_buffer()
+	{
+		lttng_dynamic_buffer_reset(&buffer);
+	}
+
+	scoped_buffer(const scoped_buffer&) = delete;
+	scoped_buffer& operator=(const scoped_buffer&) = delete;
+
+	struct lttng_buffer_view view(std::size_t size) const
+	{
+		return lttng_buffer_view_init(buffer.data, 0, size);
+	}
+
+	struct lttng_buffer_view view() const
+	{
+		return view(buffer.size);
+	}
+
+	struct lttng_dynamic_buffer buffer;
+};
+
+int encode(lttng::relayd::metadata_fragment_store& store,
+	   const std::string& packet,
+	   scoped_buffer& payload)
+{
+	const auto packet_view = lttng_buffer_view_init(packet.data(), 0, packet.size());
+
+	return lttng::relayd::encode_metadata_packet(
+		store, stream_id, packet_view, padding_size, payload.buffer);
+}
+
+/* Decode a payload and check that it matches `expected`. */
+bool decodes_to(lttng::relayd::metadata_fragment_store& store,
+		const struct lttng_buffer_view& payload,
+		const std::string& expected)
+{
+	scoped_buffer packet;
+	uint64_t decoded_stream_id;
+	uint32_t decoded_padding_size;
+
+	if (lttng::relayd::decode_metadata_packet(
+		    store, payload, decoded_stream_id, decoded_padding_size, packet.buffer)) {
+		return false;
+	}
+
+	return decoded_stream_id == stream_id && decoded_padding_size == padding_size &&
+		packet.buffer.size == expected.size() &&
+		!memcmp(packet.buffer.data, expected.data(), expected.size());
+}
+
+bool decode_fails(const struct lttng_buffer_view& payload)
+{
+	lttng::relayd::metadata_fragment_store store;
+	scoped_buffer packet;
+	uint64_t decoded_stream_id;
+	uint32_t decoded_padding_size;
+
+	return lttng::relayd::decode_metadata_packet(
+		       store, payload, decoded_stream_id, decoded_padding_size, packet.buffer) !=
+		0;
+}
+
+void test_round_trip()
+{
+	lttng::relayd::metadata_fragment_store sender_store, receiver_store;
+	const auto metadata = make_metadata(64);
+	const auto random_data = make_random(16384);
+	scoped_buffer first_payload, second_payload, random_payload;
+
+	ok(encode(sender_store, metadata, first_payload) == 0, "Metadata packet is encoded");
+	ok(first_payload.buffer.size < metadata.size(), "Metadata fragments are compressed");
+	ok(decodes_to(receiver_store, first_payload.view(), metadata),
+	   "Metadata packet round-trips");
+
+	ok(encode(sender_store, metadata, second_payload) == 0,
+	   "Metadata packet is encoded a second time");
+	ok(second_payload.buffer.size < first_payload.buffer.size / 4,
+	   "Fragments sent previously are sent as references");
+	ok(decodes_to(receiver_store, second_payload.view(), metadata),
+	   "Metadata packet made of references round-trips");
+
+	ok(encode(sender_store, random_data, random_payload) == 0 &&
+		   decodes_to(receiver_store, random_payload.view(), random_data),
+	   "Incompressible packet round-trips");
+}
+
+void test_invalid_payloads()
+{
+	lttng::relayd::metadata_fragment_store sender_store;
+	const auto metadata = make_metadata(16);
+	scoped_buffer payload, references_payload;
+	bool all_failed = true;
+
+	if (encode(sender_store, metadata, payload) ||
+	    encode(sender_store, metadata, references_payload)) {
+		diag("Failed to encode metadata packet");
+	}
+
+	for (std::size_t size = 0; size < payload.buffer.size; size++) {
+		all_failed &= decode_fails(payload.view(size));
+	}
+
+	ok(all_failed, "Every truncation of a payload is rejected");
+
+	lttng_dynamic_buffer_append(&payload.buffer, "", 1);
+	ok(decode_fails(payload.view()), "Payload with trailing data is rejected");
+	lttng_dynamic_buffer_set_size(&payload.buffer, payload.buffer.size - 1);
+
+	ok(decode_fails(references_payload.view()), "Reference to an unknown fragment is rejected");
+
+	/* Announce a larger decoded size for the first fragment. */
+	struct lttcomm_relayd_metadata_fragment descriptor;
+	const auto descriptor_offset = sizeof(struct lttcomm_relayd_metadata_fragments_payload);
+
+	memcpy(&descriptor, payload.buffer.data + descriptor_offset, sizeof(descriptor));
+	if (descriptor.type != LTTCOMM_RELAYD_METADATA_FRAGMENT_TYPE_LITERAL_LZ4) {
+		diag("First fragment is not compressed");
+	}
+
+	descriptor.size = htobe32(be32toh(descriptor.size) + 1);
+	memcpy(payload.buffer.data + descriptor_offset, &descriptor, sizeof(descriptor));
+	ok(decode_fails(payload.view()),
+	   "Compressed fragment not expanding to its announced size is rejected");
+}
+} /* namespace */
+
+int main()
+{
+	plan_tests(NUM_TESTS);
+
+	test_round_trip();
+	test_invalid_payloads();
+
+	return exit_status();
+}
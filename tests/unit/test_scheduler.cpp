@@ -10,6 +10,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <memory>
 #include <random>
 #include <tap/tap.h>
@@ -226,6 +227,37 @@ void test_lots_of_tasks_ran_in_order()
 	}
 }
 
+void test_far_tasks_ran_on_deadline()
+{
+	lttng::scheduling::scheduler scheduler;
+	std::array<bool, 4> tasks_ran = { false };
+	/* Deadlines spanning the levels of the scheduler's timer wheel. */
+	const std::array<lttng::scheduling::absolute_time, 4> deadlines = {
+		lttng::scheduling::absolute_time(std::chrono::milliseconds(3)),
+		lttng::scheduling::absolute_time(std::chrono::seconds(2)),
+		lttng::scheduling::absolute_time(std::chrono::minutes(5)),
+		lttng::scheduling::absolute_time(std::chrono::hours(24 * 10)),
+	};
+
+	for (unsigned int i = 0; i < tasks_ran.size(); i++) {
+		scheduler.schedule(std::make_shared<task_once>(tasks_ran[i]), deadlines[i]);
+	}
+
+	for (unsigned int i = 0; i < tasks_ran.size(); i++) {
+		const auto tick_ret =
+			scheduler.tick(deadlines[i] - lttng::scheduling::duration_ns(1));
+
+		ok(!tasks_ran[i] && tick_ret == lttng::scheduling::duration_ns(1),
+		   "Task %u not ran 1 ns before its deadline",
+		   i);
+
+		scheduler.tick(deadlines[i]);
+		ok(tasks_ran[i] && (i + 1 == tasks_ran.size() || !tasks_ran[i + 1]),
+		   "Task %u ran on its deadline, before the next task",
+		   i);
+	}
+}
+
 } /* namespace once_scheduling */
 
 namespace periodic_scheduling {
@@ -251,7 +283,7 @@ private:
 class periodic_task_die_after_3 : public lttng::scheduling::periodic_task {
 public:
 	periodic_task_die_after_3(lttng::scheduling::duration_ns period_ns,
-				  unsigned int& value_to_increment) :
+				  std::atomic<unsigned int>& value_to_increment) :
 		lttng::scheduling::periodic_task(period_ns),
 		_value_to_increment{ value_to_increment }
 	{
@@ -259,16 +291,18 @@ public:
 
 	void _run([[maybe_unused]] lttng::scheduling::absolute_time current_time) noexcept override
 	{
-		/* Indicate that task ran. */
-		_value_to_increment++;
-		if (_value_to_increment == 3) {
+		/*
+		 * Indicate that task ran. The task may run on the workers of an
+		 * executor, concurrently with the test reading the count.
+		 */
+		if (++_value_to_increment == 3) {
 			/* This task should no longer run. */
 			_cancel_no_lock();
 		}
 	}
 
 private:
-	unsigned int& _value_to_increment;
+	std::atomic<unsigned int>& _value_to_increment;
 };
 
 void test_task_not_ran_before_deadline()
@@ -344,7 +378,7 @@ void test_task_rescheduled()
 void test_task_die()
 {
 	lttng::scheduling::scheduler scheduler;
-	unsigned int task_run_count = 0;
+	std::atomic<unsigned int> task_run_count{ 0 };
 
 	/* Run every 100 ns. */
 	auto my_task = std::make_shared<periodic_task_die_after_3>(
@@ -380,7 +414,7 @@ void test_task_die()
 {
 	lttng::scheduling::scheduler scheduler;
 	lttng::scheduling::task_executor executor(scheduler);
-	unsigned int task_run_count = 0;
+	std::atomic<unsigned int> task_run_count{ 0 };
 
 	auto my_task = std::make_shared<periodic_scheduling::periodic_task_die_after_3>(
 		lttng::scheduling::duration_ns(std::chrono::milliseconds(100)), task_run_count);
@@ -395,12 +429,33 @@ void test_task_die()
 	   "Periodic task scheduled to run only three times only ran three times by task executor");
 }
 
+void test_task_die_workers()
+{
+	lttng::scheduling::scheduler scheduler;
+	lttng::scheduling::task_executor executor(scheduler, 2);
+	std::atomic<unsigned int> task_run_count{ 0 };
+
+	auto my_task = std::make_shared<periodic_scheduling::periodic_task_die_after_3>(
+		lttng::scheduling::duration_ns(std::chrono::milliseconds(100)), task_run_count);
+
+	scheduler.schedule(my_task, std::chrono::steady_clock::now() + my_task->period());
+
+	while (!my_task->canceled()) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	executor.stop();
+	ok(task_run_count == 3,
+	   "Periodic task scheduled to run only three times only ran three times by task executor "
+	   "workers");
+}
+
 } /* namespace task_execution */
 } /* namespace */
 
 int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
 {
-	plan_tests(46);
+	plan_tests(55);
 
 	once_scheduling::test_task_not_ran_immediately();
 	once_scheduling::test_task_not_ran_before_deadline();
@@ -411,6 +466,7 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
 	once_scheduling::test_tasks_all_ran_after_deadline();
 	once_scheduling::test_tasks_some_ran_after_tick();
 	once_scheduling::test_lots_of_tasks_ran_in_order();
+	once_scheduling::test_far_tasks_ran_on_deadline();
 
 	periodic_scheduling::test_task_second_run_not_before_deadline();
 	periodic_scheduling::test_task_not_ran_before_deadline();
@@ -420,6 +476,7 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
 
 	task_execution::test_stop();
 	task_execution::test_task_die();
+	task_execution::test_task_die_workers();
 
 	return exit_status();
 }
\ No newline at end of file